@@ -98,6 +98,7 @@ namespace ed
         hitTest(true);
         enableAutoExpand(true, false);
         customMinSize(0, 250);
+        continuousRedraw(true); // histogram data arrives asynchronously
     }
 
     void ImageHistogramWidget::addHistogram(const base::RefPtr<ImageHistogramData>& data, base::Color color, base::StringView<char> caption)
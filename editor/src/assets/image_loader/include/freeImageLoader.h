@@ -34,7 +34,7 @@ namespace base
 
             //-
 
-            FreeImageLoadedData(void* object);
+            FreeImageLoadedData(void* object, uint64_t reservedMemory);
             ~FreeImageLoadedData();
 
             // get view of the whole data
@@ -42,12 +42,28 @@ namespace base
 
         protected:
             void* object = nullptr;
+            uint64_t reservedMemory = 0; // part of the decoding budget held by this image
         };
 
         /// load a image using the free image library
+        /// NOTE: safe to call from many fibers at once, the decoding waits if the memory held by other decoded images exceeds the decoding budget
         extern ASSETS_IMAGE_LOADER_API RefPtr<FreeImageLoadedData> LoadImageWithFreeImage(const void* data, uint64_t dataSize);
 
         ///---
 
+        /// stats of the image decoding
+        struct ASSETS_IMAGE_LOADER_API FreeImageDecodingStats
+        {
+            uint32_t numImagesDecoded = 0; // total number of images decoded so far
+            uint32_t numImagesWaited = 0; // number of images that had to wait for memory budget
+            uint64_t memoryInUse = 0; // memory currently held by decoded images
+            uint64_t memoryPeak = 0; // max memory held by decoded images at the same time
+        };
+
+        /// get stats of the image decoding
+        extern ASSETS_IMAGE_LOADER_API FreeImageDecodingStats GetFreeImageDecodingStats();
+
+        ///---
+
     } // image
 } // base
\ No newline at end of file
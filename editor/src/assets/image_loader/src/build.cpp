@@ -3,7 +3,7 @@
 * Written by Tomasz Jonarski (RexDex)
 * Source code licensed under LGPL 3.0 license
 *
-* [# dependency: base_image #]
+* [# dependency: base_image, base_fibers, base_app #]
 * [# privatelib: freeimage #]
 * [# devonly #]
 ***/
@@ -14,6 +14,8 @@
 #include "base/resources/include/resourceCookingInterface.h"
 #include "base/resources/include/resource.h"
 #include "base/io/include/ioFileHandle.h"
+#include "base/system/include/thread.h"
+#include "base/system/include/timedScope.h"
 
 #include <freeimage/FreeImage.h>
 
@@ -21,6 +23,9 @@ namespace base
 {
     namespace image
     {
+        base::ConfigProperty<int> cvImageDecodingMemoryBudgetMB("Editor.ImageImport", "DecodingMemoryBudgetMB", 2048);
+        base::ConfigProperty<int> cvImageDecodingMaxWaitTimeMS("Editor.ImageImport", "DecodingMaxWaitTimeMS", 10000);
+
         namespace loader
         {
             static unsigned DLL_CALLCONV ReadProc(void *buffer, unsigned size, unsigned count, fi_handle handle)
@@ -307,55 +312,103 @@ namespace base
             return "UNKNONW";
         }
 
-        static void SwapRedBlue(FIBITMAP* bitmap)
+        template< typename T, uint32_t N >
+        static void FlipAndSwapRedBlueRows(uint8_t* rowA, uint8_t* rowB, uint32_t width, bool swapRedBlue)
         {
-            auto width = FreeImage_GetWidth(bitmap);
-            auto height = FreeImage_GetHeight(bitmap);
-            auto pitch = FreeImage_GetPitch(bitmap);
-            auto bpp = FreeImage_GetBPP(bitmap);
-            auto type = FreeImage_GetImageType(bitmap);
+            auto* a = (T*)rowA;
+            auto* b = (T*)rowB;
 
-            for (uint32_t i=0; i<height; ++i)
+            // middle row of an image with odd height, only the swap is needed
+            if (a == b)
             {
-                if (type == FIT_BITMAP && bpp == 24)
-                {
-                    auto ptr  = (uint8_t*)FreeImage_GetScanLine(bitmap, i);
-                    for (uint32_t x = 0; x < width; x++, ptr += 3)
-                        std::swap(ptr[0], ptr[2]);
-                }
-                else if (type == FIT_BITMAP && bpp == 32)
-                {
-                    auto ptr  = (uint8_t*)FreeImage_GetScanLine(bitmap, i);
-                    for (uint32_t x = 0; x < width; x++, ptr += 4)
-                        std::swap(ptr[0], ptr[2]);
-                }
-                else if (type == FIT_RGB16)
-                {
-                    auto ptr  = (uint16_t*)FreeImage_GetScanLine(bitmap, i);
-                    for (uint32_t x = 0; x < width; x++, ptr += 3)
-                        std::swap(ptr[0], ptr[2]);
-                }
-                else if (type == FIT_RGBA16)
-                {
-                    auto ptr  = (uint16_t*)FreeImage_GetScanLine(bitmap, i);
-                    for (uint32_t x = 0; x < width; x++, ptr += 4)
-                        std::swap(ptr[0], ptr[2]);
-                }
-                else if (type == FIT_RGBF)
+                if (swapRedBlue)
+                    for (uint32_t x = 0; x < width; x++, a += N)
+                        std::swap(a[0], a[2]);
+                return;
+            }
+
+            for (uint32_t x = 0; x < width; x++, a += N, b += N)
+            {
+                T temp[N];
+                for (uint32_t i = 0; i < N; ++i)
+                    temp[i] = a[i];
+
+                for (uint32_t i = 0; i < N; ++i)
+                    a[i] = b[i];
+                for (uint32_t i = 0; i < N; ++i)
+                    b[i] = temp[i];
+
+                if (swapRedBlue)
                 {
-                    auto ptr  = (float*)FreeImage_GetScanLine(bitmap, i);
-                    for (uint32_t x = 0; x < width; x++, ptr += 3)
-                        std::swap(ptr[0], ptr[2]);
+                    std::swap(a[0], a[2]);
+                    std::swap(b[0], b[2]);
                 }
-                else if (type == FIT_RGBAF)
+            }
+        }
+
+        static void FlipAndSwapRedBlueRows(uint8_t* rowA, uint8_t* rowB, uint32_t width, uint32_t pitch, uint32_t bpp, FREE_IMAGE_TYPE type, bool swapRedBlue)
+        {
+            if (type == FIT_BITMAP && bpp == 24)
+                FlipAndSwapRedBlueRows<uint8_t, 3>(rowA, rowB, width, swapRedBlue);
+            else if (type == FIT_BITMAP && bpp == 32)
+                FlipAndSwapRedBlueRows<uint8_t, 4>(rowA, rowB, width, swapRedBlue);
+            else if (type == FIT_RGB16)
+                FlipAndSwapRedBlueRows<uint16_t, 3>(rowA, rowB, width, swapRedBlue);
+            else if (type == FIT_RGBA16)
+                FlipAndSwapRedBlueRows<uint16_t, 4>(rowA, rowB, width, swapRedBlue);
+            else if (type == FIT_RGBF)
+                FlipAndSwapRedBlueRows<float, 3>(rowA, rowB, width, swapRedBlue);
+            else if (type == FIT_RGBAF)
+                FlipAndSwapRedBlueRows<float, 4>(rowA, rowB, width, swapRedBlue);
+            else if (rowA != rowB)
+                std::swap_ranges(rowA, rowA + pitch, rowB);
+        }
+
+        static const uint64_t MIN_BYTES_FOR_PARALLEL_FLIP = 1U << 20;
+        static const uint64_t BYTES_PER_FLIP_JOB = 1U << 18;
+
+        // flip the image vertically and swap the red/blue channels in one pass over the memory, large images are processed in row bands in parallel
+        static void FlipAndSwapRedBlue(FIBITMAP* bitmap, bool swapRedBlue)
+        {
+            PC_SCOPE_LVL2(FlipAndSwapRedBlue);
+
+            const auto width = FreeImage_GetWidth(bitmap);
+            const auto height = FreeImage_GetHeight(bitmap);
+            const auto pitch = FreeImage_GetPitch(bitmap);
+            const auto bpp = FreeImage_GetBPP(bitmap);
+            const auto type = FreeImage_GetImageType(bitmap);
+            auto* bits = (uint8_t*)FreeImage_GetBits(bitmap);
+
+            // pairs of rows to exchange, including the middle row for odd heights
+            const auto numPairs = (height + 1) / 2;
+            if (!numPairs || !bits)
+                return;
+
+            auto processPairs = [=](uint32_t firstPair, uint32_t numPairsToProcess)
+            {
+                for (uint32_t y = firstPair; y < firstPair + numPairsToProcess; ++y)
                 {
-                    auto ptr  = (float*)FreeImage_GetScanLine(bitmap, i);
-                    for (uint32_t x = 0; x < width; x++, ptr += 4)
-                        std::swap(ptr[0], ptr[2]);
+                    auto* rowA = bits + (uint64_t)y * pitch;
+                    auto* rowB = bits + (uint64_t)(height - 1 - y) * pitch;
+                    FlipAndSwapRedBlueRows(rowA, rowB, width, pitch, bpp, type, swapRedBlue);
                 }
+            };
+
+            if ((uint64_t)pitch * height < MIN_BYTES_FOR_PARALLEL_FLIP)
+            {
+                processPairs(0, numPairs);
+                return;
             }
-        }
 
+            // each pair touches two rows
+            const auto pairsPerJob = (uint32_t)std::max<uint64_t>(1, BYTES_PER_FLIP_JOB / (2 * (uint64_t)pitch));
+            const auto numJobs = (numPairs + pairsPerJob - 1) / pairsPerJob;
+            RunFiberLoop("FreeImageFlip", numJobs, -1, [pairsPerJob, numPairs, &processPairs](uint32_t jobIndex)
+                {
+                    const auto firstPair = jobIndex * pairsPerJob;
+                    processPairs(firstPair, std::min<uint32_t>(pairsPerJob, numPairs - firstPair));
+                });
+        }
 
         static bool ConvertFormat(FIBITMAP* bitmap, base::image::PixelFormat& outFormat, uint8_t& outNumChannels)
         {
@@ -424,23 +477,84 @@ namespace base
 
         static bool FormatSupported(FIBITMAP* bitmap)
         {
-            base::image::PixelFormat format;
+            base::image::PixelFormat format = base::image::PixelFormat::Uint8_Norm;
             uint8_t channes = 0;
             return ConvertFormat(bitmap, format, channes);
         }
 
         //---
 
-        FreeImageLoadedData::FreeImageLoadedData(void* object_)
+        static SpinLock GDecodingLock;
+        static FreeImageDecodingStats GDecodingStats;
+
+        static bool TryReserveDecodingMemory(uint64_t size)
+        {
+            auto lock = CreateLock(GDecodingLock);
+
+            // always allow at least one image to be decoded, even if it's bigger than the whole budget
+            const auto budget = (uint64_t)std::max<int>(0, cvImageDecodingMemoryBudgetMB.get()) << 20;
+            if (GDecodingStats.memoryInUse > 0 && GDecodingStats.memoryInUse + size > budget)
+                return false;
+
+            GDecodingStats.memoryInUse += size;
+            GDecodingStats.memoryPeak = std::max<uint64_t>(GDecodingStats.memoryPeak, GDecodingStats.memoryInUse);
+            return true;
+        }
+
+        static void ReserveDecodingMemory(uint64_t size)
+        {
+            if (TryReserveDecodingMemory(size))
+                return;
+
+            {
+                auto lock = CreateLock(GDecodingLock);
+                GDecodingStats.numImagesWaited += 1;
+            }
+
+            // wait for other images to be released, give up after some time since the images we are waiting for may be held by the same job that is waiting
+            ScopeTimer timer;
+            while (!TryReserveDecodingMemory(size))
+            {
+                if (timer.milisecondsElapsed() > cvImageDecodingMaxWaitTimeMS.get())
+                {
+                    TRACE_WARNING("Image decoding memory budget exceeded for too long, decoding {} over the budget", MemSize(size));
+
+                    auto lock = CreateLock(GDecodingLock);
+                    GDecodingStats.memoryInUse += size;
+                    GDecodingStats.memoryPeak = std::max<uint64_t>(GDecodingStats.memoryPeak, GDecodingStats.memoryInUse);
+                    return;
+                }
+
+                if (Fibers::GetInstance().isMainFiber())
+                    base::Sleep(1);
+                else
+                    Fibers::GetInstance().yield();
+            }
+        }
+
+        static void ReleaseDecodingMemory(uint64_t size)
+        {
+            auto lock = CreateLock(GDecodingLock);
+            DEBUG_CHECK_EX(GDecodingStats.memoryInUse >= size, "Releasing more decoding memory than reserved");
+            GDecodingStats.memoryInUse -= std::min<uint64_t>(size, GDecodingStats.memoryInUse);
+        }
+
+        FreeImageDecodingStats GetFreeImageDecodingStats()
+        {
+            auto lock = CreateLock(GDecodingLock);
+            return GDecodingStats;
+        }
+
+        //---
+
+        FreeImageLoadedData::FreeImageLoadedData(void* object_, uint64_t reservedMemory_)
             : object(object_)
+            , reservedMemory(reservedMemory_)
         {
             auto dib = (FIBITMAP*)object_;
 
             ConvertFormat(dib, format, channels);
 
-            if (format != base::image::PixelFormat::Float16_Raw && format != base::image::PixelFormat::Float32_Raw)
-                SwapRedBlue(dib);
-
             data = FreeImage_GetBits(dib);
             width = FreeImage_GetWidth(dib);
             height = FreeImage_GetHeight(dib);
@@ -455,6 +569,12 @@ namespace base
                 FreeImage_Unload((FIBITMAP*)object);
                 object = nullptr;
             }
+
+            if (reservedMemory)
+            {
+                ReleaseDecodingMemory(reservedMemory);
+                reservedMemory = 0;
+            }
         }
 
         static void FreeImageOutput(FREE_IMAGE_FORMAT fif, const char* msg)
@@ -465,17 +585,30 @@ namespace base
 
         static void InitFreeImage()
         {
-            static bool initialized = false;
-            if (!initialized)
+            static SpinLock initLock;
+            static std::atomic<bool> initialized(false);
+            if (!initialized.load())
             {
-                FreeImage_Initialise();
-                FreeImage_SetOutputMessage(&FreeImageOutput);
-                initialized = true;
+                auto lock = CreateLock(initLock);
+                if (!initialized.load())
+                {
+                    FreeImage_Initialise();
+                    FreeImage_SetOutputMessage(&FreeImageOutput);
+                    initialized = true;
+                }
             }
         }
 
+        // estimate the memory needed for the decoded pixels, FIBITMAP with no pixels still knows its size
+        static uint64_t EstimateDecodedSize(FIBITMAP* header)
+        {
+            return (uint64_t)FreeImage_GetPitch(header) * FreeImage_GetHeight(header);
+        }
+
         RefPtr<FreeImageLoadedData> LoadImageWithFreeImage(const void* data, uint64_t dataSize)
         {
+            PC_SCOPE_LVL2(LoadImageWithFreeImage);
+
             InitFreeImage();
 
             // get the extension of the file we are importing from
@@ -496,9 +629,9 @@ namespace base
             io.tell_proc = memory::TellProc;
             io.seek_proc = memory::SeekProc;
 
-            // load the image
+            // read only the header first so we know how much memory the decoded image will need, not all plugins support this so we may get the full image right away
             memoryState.m_pos = 0;
-            auto* dib = FreeImage_LoadFromHandle(format, &io, (fi_handle)&memoryState);
+            auto* dib = FreeImage_LoadFromHandle(format, &io, (fi_handle)&memoryState, FIF_LOAD_NOPIXELS);
             if (!dib)
                 return nullptr;
 
@@ -509,11 +642,49 @@ namespace base
                 return nullptr;
             }
 
-            // flip the image
-            FreeImage_FlipVertical(dib);
+            // wait for the memory budget
+            const auto decodedSize = EstimateDecodedSize(dib);
+            ReserveDecodingMemory(decodedSize);
+
+            // decode the pixels
+            if (!FreeImage_HasPixels(dib))
+            {
+                FreeImage_Unload(dib);
+
+                memoryState.m_pos = 0;
+                dib = FreeImage_LoadFromHandle(format, &io, (fi_handle)&memoryState);
+                if (!dib)
+                {
+                    ReleaseDecodingMemory(decodedSize);
+                    return nullptr;
+                }
+            }
+
+            {
+                auto lock = CreateLock(GDecodingLock);
+                GDecodingStats.numImagesDecoded += 1;
+            }
+
+            // flip the image and convert from BGR to RGB (float images are already RGB)
+            {
+                base::image::PixelFormat pixelFormat = base::image::PixelFormat::Uint8_Norm;
+                uint8_t pixelChannels = 0;
+
+                // the decoded image may be of different type than the header told us (not all plugins support loading only the header)
+                if (!ConvertFormat(dib, pixelFormat, pixelChannels))
+                {
+                    TRACE_ERROR("FreeImage: unsupported image type {} ({} bits)", GetTypeName(FreeImage_GetImageType(dib)), FreeImage_GetBPP(dib));
+                    FreeImage_Unload(dib);
+                    ReleaseDecodingMemory(decodedSize);
+                    return nullptr;
+                }
+
+                const auto swapRedBlue = (pixelFormat != base::image::PixelFormat::Float16_Raw && pixelFormat != base::image::PixelFormat::Float32_Raw);
+                FlipAndSwapRedBlue(dib, swapRedBlue);
+            }
 
-            // create a wrapper
-            return base::CreateSharedPtr<FreeImageLoadedData>(dib);
+            // create a wrapper, it will release the reserved memory
+            return base::CreateSharedPtr<FreeImageLoadedData>(dib, decodedSize);
         }
 
         ImageView FreeImageLoadedData::view() const
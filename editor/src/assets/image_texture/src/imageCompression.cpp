@@ -656,9 +656,18 @@ namespace rendering
             return m_canceled;
         }
 
+        ~BlockCompressor()
+        {
+            wait();
+        }
+
         void wait()
         {
-            Fibers::GetInstance().waitForCounterAndRelease(m_finishCounter);
+            if (!m_finished)
+            {
+                Fibers::GetInstance().waitForCounterAndRelease(m_finishCounter);
+                m_finished = true;
+            }
         }
 
     protected:
@@ -800,6 +809,7 @@ namespace rendering
 
     private:
         bool m_canceled = false;
+        bool m_finished = false;
 
         base::IProgressTracker& m_progress;
         uint32_t m_blockWidth;
@@ -1050,8 +1060,13 @@ namespace rendering
 
 
         // create mipmap chain
+        // NOTE: compression of each mip runs in the background while the next mip is downsampled, the source images must stay alive until all compression is done
         base::Array<TempMip> mips;
         mips.reserve(mipCount);
+        base::Array<base::image::ImagePtr> mipSourceImages;
+        mipSourceImages.reserve(mipCount);
+        base::Array<base::UniquePtr<BlockCompressor>> compressors;
+        compressors.reserve(mipCount);
         for (uint32_t i = 0; i < mipCount; ++i)
         {
             auto& mip = mips.emplaceBack();
@@ -1081,15 +1096,20 @@ namespace rendering
                     return nullptr;
                 }
                  
-                BlockCompressor compressor(i, mipCount, uncomressedImageView, compressedFormat, squishFlags, masking, mip.data.data(), progress);
-                compressor.wait(); // TODO: we can process multiple mipmaps at the same time easily
+                compressors.pushBack(base::CreateUniquePtr<BlockCompressor>(i, mipCount, uncomressedImageView, compressedFormat, squishFlags, masking, mip.data.data(), progress));
             }
 
             // update mip
             mip.mip.dataSize = mip.data.size();
 
-            // downsample the image
+            // last mip, nothing more to downsample
+            if (i == mipCount - 1)
+                break;
+
+            // downsample the image, the current mip may still be read by the compression
             progress.reportProgress(base::TempString("Downsampling to mip {}", i + 1));
+            if (tempImage)
+                mipSourceImages.pushBack(tempImage);
             uncomressedImageView = DownsampleImage(uncomressedImageView, tempImage, masking, mipMode, colorSpace, hasPremultipliedAlpha);
             if (uncomressedImageView.empty())
             {
@@ -1098,6 +1118,14 @@ namespace rendering
             }
         }
 
+        // wait for the compression of all mips to finish
+        for (const auto& compressor : compressors)
+        {
+            compressor->wait();
+            if (compressor->canceled())
+                return nullptr;
+        }
+
         //--
 
         // final assemble
@@ -5,6 +5,8 @@
 ***/
 
 #include "build.h"
+#include "cookWorkerFarm.h"
+#include "cookingLogCapture.h"
 
 #include "base/app/include/command.h"
 #include "base/app/include/commandline.h"
@@ -14,6 +16,7 @@
 #include "base/resources/include/resourceBinaryLoader.h"
 #include "base/resources/include/resourceMetadata.h"
 #include "base/object/include/nativeFileReader.h"
+#include "base/object/include/memoryReader.h"
 #include "base/cooking/include/cooker.h"
 #include "base/cooking/include/backgroundBakeService.h"
 #include "base/cooking/include/cookerSaveThread.h"
@@ -21,11 +24,21 @@
 #include "base/io/include/absolutePathBuilder.h"
 #include "base/io/include/ioSystem.h"
 #include "base/containers/include/stringBuilder.h"
+#include "base/fibers/include/fiberWaitList.h"
 
 namespace bcc
 {
     //--
 
+    // stop cooking if that many files failed, something must be very wrong
+    static const uint32_t MAX_FAILED_FILES = 100;
+
+    //--
+
+    /// cook all resources reachable from the seed files into the output directory
+    /// usage: bcc cook -outDir=<folder> [-jobs=N] [-cookProcesses=N] [-cookTimeout=seconds] [-verboseLogs] [-keepAllLogs]
+    /// NOTE: with -cookProcesses the actual cooking is done in N separate worker processes (see CommandCookWorker), otherwise it's done in-process
+    /// NOTE: the in-process cooking runs on -jobs worker fibers, each cook captures its log with its own local log sink (CookingLogCapture), the fiber scheduler keeps the local sinks per job so they don't mix
     class CommandCook : public base::app::ICommand
     {
         RTTI_DECLARE_VIRTUAL_CLASS(CommandCook, base::app::ICommand);
@@ -44,14 +57,19 @@ namespace bcc
 
         //--
 
-        struct PendingCookingEntry
+        /// node of the cooking graph, single resource to cook (or check if up to date) and the resources it references
+        /// NOTE: cooked files reference other resources only by path so there's no cooking order, all discovered nodes can be processed in parallel
+        struct CookingNode : public base::IReferencable
         {
             base::res::ResourceKey key;
-            base::res::ResourcePtr alreadyLoadedResource;
+            base::Array<base::res::ResourceKey> dependencies;
         };
 
         bool processSeedFiles();
-        void processSingleSeedFile(const base::res::ResourceKey& key);
+        void queueNode(const base::res::ResourceKey& key);
+        void startWorker_NoLock();
+        void processPendingNodes();
+        void processNode(CookingNode& node);
 
         bool assembleCookedOutputPath(const base::res::ResourceKey& key, base::SpecificClassType<base::res::IResource> cookedClass, io::AbsolutePath& outPath) const;
 
@@ -60,26 +78,34 @@ namespace bcc
 
         bool checkDependenciesUpToDate(const base::res::Metadata& deps) const;
 
-        bool cookFile(const base::res::ResourceKey& key, base::SpecificClassType<base::res::IResource> cookedClass, io::AbsolutePath& outPath, base::Array<PendingCookingEntry>& outCookingQueue);
-        void queueDependencies(const base::res::IResource& object, base::Array<PendingCookingEntry>& outCookingQueue);
-        void queueDependencies(const io::AbsolutePath& cookedFile, base::Array<PendingCookingEntry>& outCookingQueue);
+        bool cookFile(const base::res::ResourceKey& key, base::SpecificClassType<base::res::IResource> cookedClass, io::AbsolutePath& outPath, base::Array<base::res::ResourceKey>& outDependencies);
+        void collectDependencies(const base::res::IResource& object, base::Array<base::res::ResourceKey>& outDependencies) const;
+        void collectDependencies(const io::AbsolutePath& cookedFile, base::Array<base::res::ResourceKey>& outDependencies) const;
+        void collectDependencies(base::stream::IBinaryReader& cookedFileReader, base::Array<base::res::ResourceKey>& outDependencies) const;
 
-        base::HashSet<base::res::ResourceKey> m_allCollectedFiles;
+        base::HashMap<base::res::ResourceKey, base::RefPtr<CookingNode>> m_nodes; // all discovered resources, each one is processed only once
+        base::Array<base::RefPtr<CookingNode>> m_pendingNodes; // discovered but not yet processed, most recent first so we go depth first
         base::HashSet<base::res::ResourceKey> m_allCookedFiles;
-        base::HashSet<base::res::ResourceKey> m_allSeenFile;
-
-        uint32_t m_cookFileIndex = 0;
-        uint32_t m_numTotalVisited = 0;
-        uint32_t m_numTotalUpToDate = 0;
-        uint32_t m_numTotalCopied = 0;
-        uint32_t m_numTotalCooked = 0;
-        uint32_t m_numTotalFailed = 0;
+        uint32_t m_numDependencies = 0;
+        uint32_t m_numWorkers = 0;
+        uint32_t m_maxWorkers = 1;
+        double m_totalWorkerTime = 0.0;
+        base::SpinLock m_graphLock;
+        base::fibers::WaitList m_workersWaitList;
+
+        std::atomic<uint32_t> m_cookFileIndex = 0;
+        std::atomic<uint32_t> m_numTotalVisited = 0;
+        std::atomic<uint32_t> m_numTotalUpToDate = 0;
+        std::atomic<uint32_t> m_numTotalCopied = 0;
+        std::atomic<uint32_t> m_numTotalCooked = 0;
+        std::atomic<uint32_t> m_numTotalFailed = 0;
 
         bool m_captureLogs = true;
         bool m_discardCookedLogs = true;
 
         base::UniquePtr<base::cooker::Cooker> m_cooker;
         base::UniquePtr<base::cooker::CookerSaveThread> m_saveThread;
+        base::UniquePtr<CookWorkerFarm> m_workerFarm; // if set the files are cooked in separate processes
         base::res::IResourceLoader* m_loader = nullptr;
 
         //--
@@ -103,7 +129,17 @@ namespace bcc
         m_captureLogs = !commandline.hasParam("verboseLogs");
         m_discardCookedLogs = !commandline.hasParam("keepAllLogs");
 
+        // by default cook on all fiber worker threads
+        const auto defaultNumWorkers = std::max<uint32_t>(1, Fibers::GetInstance().workerThreadCount());
+        m_maxWorkers = std::max<int>(1, commandline.singleValueInt("jobs", defaultNumWorkers));
+
+        // optionally cook in separate processes, that's independent from the number of workers that visit the files
+        const auto numCookProcesses = std::max<int>(0, commandline.singleValueInt("cookProcesses", 0));
+        if (numCookProcesses > 0)
+            m_maxWorkers = std::max<uint32_t>(m_maxWorkers, numCookProcesses); // make sure we can keep all processes busy
+
         TRACE_INFO("Cooking output directory: '{}'", m_outputDir);
+        TRACE_INFO("Cooking with {} workers", m_maxWorkers);
 
         //--
 
@@ -124,6 +160,18 @@ namespace bcc
         m_cooker.create(*m_loader->queryUncookedDepot(), m_loader, nullptr, true /* final cooker */);
         m_saveThread.create();
 
+        if (numCookProcesses > 0)
+        {
+            m_workerFarm.create();
+            if (!m_workerFarm->start(numCookProcesses, commandline))
+            {
+                TRACE_ERROR("Failed to start {} cook worker processes", numCookProcesses);
+                return false;
+            }
+
+            TRACE_INFO("Cooking in {} worker processes", numCookProcesses);
+        }
+
         //--
 
         auto backgroundBacking = base::GetService<base::cooker::BackgroundBaker>();
@@ -135,12 +183,15 @@ namespace bcc
         if (!collectSeedFiles())
             return false;
 
-        if (!processSeedFiles())
+        const auto seedFilesProcessed = processSeedFiles();
+        m_workerFarm.reset();
+
+        if (!seedFilesProcessed)
             return false;
 
         //--
 
-        TRACE_INFO("Total {} files processed", m_allCollectedFiles.size());
+        TRACE_INFO("Total {} files processed", m_nodes.size());
         return true;
     }
 
@@ -191,7 +242,6 @@ namespace bcc
                     auto key = base::res::ResourceKey(path, cls);
                     TRACE_INFO("Collected static resource '{}'", key);
                     m_seedFiles.insert(key);
-                    m_allCollectedFiles.insert(key);
                 }
             }
         }
@@ -220,10 +270,7 @@ namespace bcc
                             {
                                 const auto fileKey = base::res::ResourceKey(base::res::ResourcePath(depotPath), fileInfo.resourceClass);
                                 if (m_seedFiles.insert(fileKey))
-                                {
-                                    m_allCollectedFiles.insert(fileKey);
                                     numAdded += 1;
-                                }
                             }
                             else
                             {
@@ -250,103 +297,159 @@ namespace bcc
 
     bool CommandCook::processSeedFiles()
     {
-        for (uint32_t i = 0; i<m_seedFiles.size(); ++i)
-        {
-            const auto& seedFilePath = m_seedFiles.keys()[i];
-            TRACE_INFO("Processing seed file {}/{}: {}", i + 1, m_seedFiles.size(), seedFilePath.path());
+        ScopeTimer timer;
 
-            processSingleSeedFile(seedFilePath);
+        // seed files are the roots of the graph, the rest of it is discovered as we process the files
+        for (const auto& seedFileKey : m_seedFiles.keys())
+            queueNode(seedFileKey);
 
-            if (m_numTotalFailed > 100)
-            {
-                // something is really wrong
-                TRACE_ERROR("More than 100 files failed cooking, something must be VERY wrong. Stopping now.");
-                return false;
-            }
-        }
+        // wait for the workers, NOTE: this also waits for the workers started for newly discovered files
+        m_workersWaitList.sync();
 
         TRACE_INFO("Finished processing {} seed files.", m_seedFiles.size());
-        TRACE_INFO("Visited {} files, {} up to date, {} copied, {} cooked and {} failed", m_numTotalVisited, m_numTotalUpToDate, m_numTotalCopied, m_numTotalCooked, m_numTotalFailed);
+        TRACE_INFO("Visited {} files, {} up to date, {} copied, {} cooked and {} failed", m_numTotalVisited.load(), m_numTotalUpToDate.load(), m_numTotalCopied.load(), m_numTotalCooked.load(), m_numTotalFailed.load());
 
         m_saveThread->waitUntilDone();
 
+        // report the throughput, NOTE: worker time includes the time spent waiting for loading and I/O so the utilization is an upper bound
+        const auto totalTime = timer.timeElapsed();
+        if (totalTime > 0.0)
+        {
+            const auto filesPerMinute = (m_numTotalVisited.load() * 60.0) / totalTime;
+            const auto utilization = (100.0 * m_totalWorkerTime) / (totalTime * m_maxWorkers);
+            TRACE_INFO("Processed {} files with {} dependencies in {}: {} files/min, {}% utilization of {} workers", m_nodes.size(), m_numDependencies, timer, Prec(filesPerMinute, 1), Prec(utilization, 1), m_maxWorkers);
+        }
+
+        if (m_workerFarm)
+            TRACE_INFO("Cooked in {} worker processes, {} restarts", m_workerFarm->numWorkers(), m_workerFarm->numRestarts());
+
+        if (m_numTotalFailed > MAX_FAILED_FILES)
+        {
+            // something is really wrong
+            TRACE_ERROR("More than {} files failed cooking, something must be VERY wrong. Stopped.", MAX_FAILED_FILES);
+            return false;
+        }
+
         return m_numTotalFailed == 0;
     }
 
-    void CommandCook::processSingleSeedFile(const base::res::ResourceKey& seedFileKey)
+    void CommandCook::queueNode(const base::res::ResourceKey& key)
     {
-        bool valid = true;
+        auto lock = CreateLock(m_graphLock);
 
-        base::Array<PendingCookingEntry> cookingQueue;
-        ScopeTimer cookingTimer;
+        // each resource is processed only once, no matter how many other resources reference it
+        if (m_nodes.contains(key))
+            return;
 
-        auto& rootEntry = cookingQueue.emplaceBack();
-        rootEntry.key = seedFileKey;
+        auto node = base::CreateSharedPtr<CookingNode>();
+        node->key = key;
+        m_nodes[key] = node;
+        m_pendingNodes.pushBack(node);
 
-        uint32_t localProcessed = 0;
-        while (!cookingQueue.empty())
+        // the running workers will pick up the node eventually, start new one only if we are below the limit
+        if (m_numWorkers < m_maxWorkers)
+            startWorker_NoLock();
+    }
+
+    void CommandCook::startWorker_NoLock()
+    {
+        m_numWorkers += 1;
+
+        auto signal = Fibers::GetInstance().createCounter("CookWorker", 1);
+        m_workersWaitList.pushFence(signal);
+
+        RunChildFiber("CookWorker") << [this, signal](FIBER_FUNC)
         {
-            // get entry to cook
-            auto topEntry = std::move(cookingQueue.back());
-            cookingQueue.popBack();
-            localProcessed += 1;
-            m_numTotalVisited += 1;
-
-            // prevent this file from being recooked second time this session
-            if (!m_allSeenFile.insert(topEntry.key))
-                continue;
+            processPendingNodes();
+            Fibers::GetInstance().signalCounter(signal);
+        };
+    }
 
-            /// check if can cook this file at all
-            SpecificClassType<res::IResource> cookedClass;
-            if (!m_cooker->canCook(topEntry.key, cookedClass))
+    void CommandCook::processPendingNodes()
+    {
+        for (;;)
+        {
+            // get next node to process, finish the worker if there's nothing left
+            base::RefPtr<CookingNode> node;
             {
-                TRACE_WARNING("Resource '{}' is not cookable and will be skipped. Why is it referenced though?");
-                continue;
+                auto lock = CreateLock(m_graphLock);
+                if (m_pendingNodes.empty() || m_numTotalFailed > MAX_FAILED_FILES)
+                {
+                    m_numWorkers -= 1;
+                    return;
+                }
+
+                node = m_pendingNodes.back();
+                m_pendingNodes.popBack();
             }
 
-            // assemble cooked output path - cooked file will be stored there
-            base::io::AbsolutePath cookedFilePath;
-            if (!assembleCookedOutputPath(topEntry.key, cookedClass, cookedFilePath))
+            ScopeTimer nodeTimer;
+            processNode(*node);
+
+            // add the dependencies to the graph
             {
-                TRACE_WARNING("Resource '{}' is not cookable (no valid cooked extension)");
-                continue;
+                auto lock = CreateLock(m_graphLock);
+                m_totalWorkerTime += nodeTimer.timeElapsed();
+                m_numDependencies += node->dependencies.size();
             }
 
-            // evaluate dirty state of the file, especially if we can skip cooking it :)
-            // first, target file must exist to have any chance of skipping the cook :)
-            if (IO::GetInstance().fileExists(cookedFilePath))
+            for (const auto& dependencyKey : node->dependencies)
+                queueNode(dependencyKey);
+        }
+    }
+
+    void CommandCook::processNode(CookingNode& node)
+    {
+        m_numTotalVisited += 1;
+
+        /// check if can cook this file at all
+        SpecificClassType<res::IResource> cookedClass;
+        if (!m_cooker->canCook(node.key, cookedClass))
+        {
+            TRACE_WARNING("Resource '{}' is not cookable and will be skipped. Why is it referenced though?", node.key);
+            return;
+        }
+
+        // assemble cooked output path - cooked file will be stored there
+        base::io::AbsolutePath cookedFilePath;
+        if (!assembleCookedOutputPath(node.key, cookedClass, cookedFilePath))
+        {
+            TRACE_WARNING("Resource '{}' is not cookable (no valid cooked extension)", node.key);
+            return;
+        }
+
+        // evaluate dirty state of the file, especially if we can skip cooking it :)
+        // first, target file must exist to have any chance of skipping the cook :)
+        if (IO::GetInstance().fileExists(cookedFilePath))
+        {
+            // load the source dependencies of the file (metadata)
+            auto metadata = loadFileMetadata(cookedFilePath);
+            if (metadata)
             {
-                // load the source dependencies of the file (metadata)
-                auto metadata = loadFileMetadata(cookedFilePath);
-                if (metadata)
+                // if all our dependencies check out then we don't have to cook that file
+                if (checkDependenciesUpToDate(*metadata))
                 {
-                    // if all our dependencies check out then we don't have to cook that file
-                    if (checkDependenciesUpToDate(*metadata))
-                    {
-                        // we can skip this file but make sure the loading dependencies are cooked
-                        queueDependencies(cookedFilePath, cookingQueue);
-                        m_numTotalUpToDate += 1;
-                        continue;;
-                    }
+                    // we can skip this file but make sure the loading dependencies are cooked
+                    collectDependencies(cookedFilePath, node.dependencies);
+                    m_numTotalUpToDate += 1;
+                    return;
                 }
-                else
-                {
-                    TRACE_WARNING("Failed to load metadata for output file '{}'. It might be corrupted, recooking.", topEntry.key);
-                }
-            }
-
-            // cook the file
-            if (cookFile(topEntry.key, cookedClass, cookedFilePath, cookingQueue))
-            {
-                m_numTotalCooked += 1;
             }
             else
             {
-                m_numTotalFailed += 1;
+                TRACE_WARNING("Failed to load metadata for output file '{}'. It might be corrupted, recooking.", node.key);
             }
         }
 
-        TRACE_INFO("Processed {} source files for seed file '{}' in {}", localProcessed, seedFileKey, cookingTimer);
+        // cook the file
+        if (cookFile(node.key, cookedClass, cookedFilePath, node.dependencies))
+        {
+            m_numTotalCooked += 1;
+        }
+        else
+        {
+            m_numTotalFailed += 1;
+        }
     }
 
     bool CommandCook::checkDependenciesUpToDate(const base::res::Metadata& deps) const
@@ -449,11 +552,10 @@ namespace bcc
 
     //--
 
-    void CommandCook::queueDependencies(const base::res::IResource& object, base::Array<PendingCookingEntry>& outCookingQueue)
+    void CommandCook::collectDependencies(const base::res::IResource& object, base::Array<base::res::ResourceKey>& outDependencies) const
     {
         base::HashSet<res::ResourceKey> referencedResources;
 
-        base::ScopeTimer timer;
         {
             base::InplaceArray<const IObject*, 1> objects;
             objects.pushBack(&object);
@@ -465,104 +567,67 @@ namespace bcc
             TRACE_INFO("Found {} referenced resources, adding them to cook list", referencedResources.size());
 
             for (const auto& key : referencedResources)
-            {
-                if (m_allCollectedFiles.insert(key))
-                {
-                    TRACE_INFO("Added '{}' to cooking queue", key);
-                    auto& outEntry = outCookingQueue.emplaceBack();
-                    outEntry.key = key;
-                }
-            }
+                outDependencies.pushBack(key);
         }
     }
 
-    void CommandCook::queueDependencies(const io::AbsolutePath& cookedFilePath, base::Array<PendingCookingEntry>& outCookingQueue)
+    void CommandCook::collectDependencies(const io::AbsolutePath& cookedFilePath, base::Array<base::res::ResourceKey>& outDependencies) const
     {
         auto fileReader = IO::GetInstance().openForReading(cookedFilePath);
         if (fileReader)
         {
-            auto loader = base::CreateSharedPtr<base::res::binary::BinaryLoader>();
-
-            base::InplaceArray<base::stream::LoadingDependency, 100> dependencies;
-
             base::stream::NativeFileReader reader(*fileReader);
-            if (loader->extractLoadingDependencies(reader, true, dependencies))
-            {
-                TRACE_INFO("Loaded {} existing dependencies from '{}'", dependencies.size(), cookedFilePath);
-
-                for (const auto& entry : dependencies)
-                {
-                    auto& outEntry = outCookingQueue.emplaceBack();
-                    outEntry.key = base::res::ResourceKey(base::res::ResourcePath(entry.resourceDepotPath), entry.resourceClass.cast<base::res::IResource>());
-                }
-            }
+            collectDependencies(reader, outDependencies);
         }
     }
 
-    class CookingLogCapture : public base::logging::LocalLogSink
+    void CommandCook::collectDependencies(base::stream::IBinaryReader& cookedFileReader, base::Array<base::res::ResourceKey>& outDependencies) const
     {
-    public:
-        CookingLogCapture(const io::AbsolutePath& outPath, bool captureFully)
-            : m_fullyCaptured(captureFully)
-        {
-            m_logFilePath = outPath.addExtension(".log");
-            m_logOutput = IO::GetInstance().openForWriting(m_logFilePath);
-        }
+        auto loader = base::CreateSharedPtr<base::res::binary::BinaryLoader>();
 
-        void discardLog()
+        base::InplaceArray<base::stream::LoadingDependency, 100> dependencies;
+        if (loader->extractLoadingDependencies(cookedFileReader, true, dependencies))
         {
-            if (m_logOutput)
-                m_logOutput.reset();
+            TRACE_INFO("Loaded {} existing dependencies", dependencies.size());
 
-            IO::GetInstance().deleteFile(m_logFilePath);
+            for (const auto& entry : dependencies)
+                outDependencies.emplaceBack(base::res::ResourcePath(entry.resourceDepotPath), entry.resourceClass.cast<base::res::IResource>());
         }
+    }
 
-        virtual bool print(base::logging::OutputLevel level, const char* file, uint32_t line, const char* context, const char* text) override
+    bool CommandCook::cookFile(const base::res::ResourceKey& key, base::SpecificClassType<base::res::IResource> cookedClass, io::AbsolutePath& outPath, base::Array<base::res::ResourceKey>& outDependencies)
+    {
+        // do not cook files more than once, also promote the resource key to it's true class, ie ITexture:lena.png -> StaticTexture:lena.png
+        const auto cookKey = base::res::ResourceKey(key.path(), cookedClass);
         {
-            if (m_logOutput)
-            {
-                base::StringBuilder str;
-
-                switch (level)
-                {
-                case base::logging::OutputLevel::Error:; str.appendf("!!!! ERROR: "); break;
-                case base::logging::OutputLevel::Warning:; str.appendf("! WARNING: "); break;
-                }
-
-                str.append(text);
-                str.append("\n");
-
-                if (m_logOutput->writeSync(str.c_str(), str.length()) != str.length())
-                    m_logOutput.reset();
-            }
-
-            return m_fullyCaptured; // consume
+            auto lock = CreateLock(m_graphLock);
+            if (!m_allCookedFiles.insert(cookKey))
+                return true;
         }
 
-        virtual ~CookingLogCapture()
+        // print header
+        TRACE_INFO("Cooking file {}: {}", m_cookFileIndex++, key);
+        // TODO: break on file
+
+        // cook in one of the worker processes, we get the file content ready to save
+        if (m_workerFarm)
         {
-            m_logOutput.reset();
-        }
+            auto cookedData = m_workerFarm->cook(cookKey, outPath);
+            if (!cookedData)
+            {
+                TRACE_ERROR("Failed to cook file '{}'", cookKey.path());
+                return false;
+            }
 
-    private:
-        base::io::FileHandlePtr m_logOutput;
-        base::io::AbsolutePath m_logFilePath;
-        bool m_fullyCaptured;
-    };
+            base::stream::MemoryReader cookedDataReader(cookedData);
+            collectDependencies(cookedDataReader, outDependencies);
 
-    bool CommandCook::cookFile(const base::res::ResourceKey& key, base::SpecificClassType<base::res::IResource> cookedClass, io::AbsolutePath& outPath, base::Array<PendingCookingEntry>& outCookingQueue)
-    {
-        // do not cook files more than once, also promote the resource key to it's true class, ie ITexture:lena.png -> StaticTexture:lena.png
-        const auto cookKey = base::res::ResourceKey(key.path(), cookedClass);
-        if (!m_allCookedFiles.insert(cookKey))
+            m_saveThread->scheduleSave(cookedData, outPath);
             return true;
-
-        // print header
-        TRACE_INFO("Cooking file {}: {}", m_cookFileIndex, key);
-        m_cookFileIndex += 1;
-        // TODO: break on file
+        }
 
         // capture all log output, we are only interested in success/failure
+        // NOTE: the capture is mounted only for this worker's fiber, the fiber scheduler detaches it when the cook yields or waits so other workers don't log into it
         base::res::ResourcePtr cookedFile;
         {
             CookingLogCapture logCapture(outPath, m_captureLogs);
@@ -580,7 +645,7 @@ namespace bcc
         }
 
         // gather resources used for this resource
-        queueDependencies(*cookedFile, outCookingQueue);
+        collectDependencies(*cookedFile, outDependencies);
 
         // add to save queue
         m_saveThread->scheduleSave(cookedFile, outPath);
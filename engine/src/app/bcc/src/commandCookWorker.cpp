@@ -0,0 +1,223 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "cookWorkerProtocol.h"
+#include "cookingLogCapture.h"
+
+#include "base/app/include/command.h"
+#include "base/app/include/commandline.h"
+#include "base/resources/include/resourceLoadingService.h"
+#include "base/resources/include/resourceBinarySaver.h"
+#include "base/object/include/memoryWriter.h"
+#include "base/cooking/include/cooker.h"
+#include "base/cooking/include/backgroundBakeService.h"
+#include "base/containers/include/uniquePtr.h"
+
+namespace bcc
+{
+    //--
+
+    /// worker process for the "cook" command, started by it when the cooking is distributed to multiple processes (-cookProcesses=N)
+    /// receives the files to cook over a pipe and sends back the cooked content, saving is done by the master
+    /// usage (internal): bcc cookWorker -jobPipe=<name> -resultPipe=<name> [-idleTimeout=<seconds>]
+    class CommandCookWorker : public base::app::ICommand
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(CommandCookWorker, base::app::ICommand);
+
+    public:
+        virtual bool run(const base::app::CommandLine& commandline) override final;
+
+    private:
+        base::UniquePtr<base::cooker::Cooker> m_cooker;
+
+        bool m_captureLogs = true;
+        bool m_discardCookedLogs = true;
+
+        base::Buffer cookFile(const base::Buffer& request) const;
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(CommandCookWorker);
+        RTTI_METADATA(base::app::CommandNameMetadata).name("cookWorker");
+    RTTI_END_TYPE();
+
+    //--
+
+    bool CommandCookWorker::run(const base::app::CommandLine& commandline)
+    {
+        const auto& jobPipeName = commandline.singleValue("jobPipe");
+        const auto& resultPipeName = commandline.singleValue("resultPipe");
+        if (jobPipeName.empty() || resultPipeName.empty())
+        {
+            TRACE_ERROR("Missing required arguments -jobPipe and -resultPipe, this command is only started by the 'cook' command");
+            return false;
+        }
+
+        m_captureLogs = !commandline.hasParam("verboseLogs");
+        m_discardCookedLogs = !commandline.hasParam("keepAllLogs");
+
+        // the master normally tells us to quit, the timeout is there so we don't linger if it died
+        const auto idleTimeout = std::max<int>(1, commandline.singleValueInt("idleTimeout", 600));
+
+        //--
+
+        auto loadingService = base::GetService<base::res::LoadingService>();
+        if (!loadingService || !loadingService->loader() || !loadingService->loader()->queryUncookedDepot())
+        {
+            TRACE_ERROR("Resource loading service does not have uncooked depot attached, cooking won't be possible.");
+            return false;
+        }
+
+        auto* loader = loadingService->loader();
+        m_cooker.create(*loader->queryUncookedDepot(), loader, nullptr, true /* final cooker */);
+
+        auto backgroundBacking = base::GetService<base::cooker::BackgroundBaker>();
+        if (backgroundBacking)
+            backgroundBacking->enabled(false);
+
+        //--
+
+        base::UniquePtr<base::process::IPipeReader> jobPipe(base::process::IPipeReader::Open(jobPipeName.c_str()));
+        base::UniquePtr<base::process::IPipeWriter> resultPipe(base::process::IPipeWriter::Open(resultPipeName.c_str()));
+        if (!jobPipe || !resultPipe)
+        {
+            TRACE_ERROR("Unable to connect to the cooking master");
+            return false;
+        }
+
+        //--
+
+        uint32_t numCooked = 0;
+        uint32_t numFailed = 0;
+        auto idleTimeoutTime = base::NativeTimePoint::Now() + (double)idleTimeout;
+
+        CookWorkerMessageReader messages;
+        uint8_t readBuffer[64 * 1024];
+
+        for (;;)
+        {
+            if (!jobPipe->isOpened() || messages.corrupted())
+            {
+                TRACE_ERROR("Lost connection with the cooking master");
+                return false;
+            }
+
+            // get data from the master
+            const auto numRead = jobPipe->read(readBuffer, sizeof(readBuffer));
+            if (!numRead)
+            {
+                if (idleTimeoutTime.reached())
+                {
+                    TRACE_WARNING("No jobs from the cooking master for {}s, exiting", idleTimeout);
+                    return false;
+                }
+
+                base::Sleep(1);
+                continue;
+            }
+
+            messages.push(readBuffer, numRead);
+
+            // process all complete messages
+            CookWorkerMessageHeader header;
+            base::Buffer payload;
+            while (messages.pop(header, payload))
+            {
+                if (header.type == CookWorkerMessageType::Quit)
+                {
+                    TRACE_INFO("Cook worker finished, {} files cooked, {} failed", numCooked, numFailed);
+                    return true;
+                }
+
+                if (header.type != CookWorkerMessageType::CookRequest)
+                    continue;
+
+                bool sent = false;
+                if (auto cookedData = cookFile(payload))
+                {
+                    numCooked += 1;
+                    sent = SendCookWorkerMessage(*resultPipe, CookWorkerMessageType::CookResult, header.jobId, cookedData.data(), cookedData.size());
+                }
+                else
+                {
+                    numFailed += 1;
+                    sent = SendCookWorkerMessage(*resultPipe, CookWorkerMessageType::CookFailed, header.jobId);
+                }
+
+                if (!sent)
+                {
+                    TRACE_ERROR("Lost connection with the cooking master");
+                    return false;
+                }
+            }
+
+            idleTimeoutTime = base::NativeTimePoint::Now() + (double)idleTimeout;
+        }
+    }
+
+    base::Buffer CommandCookWorker::cookFile(const base::Buffer& request) const
+    {
+        // request contains the resource key and the output path, both zero terminated
+        const auto* keyText = (const char*)request.data();
+        const auto keyLength = request ? strnlen(keyText, request.size()) : 0;
+        if (keyLength + 1 >= request.size())
+        {
+            TRACE_ERROR("Invalid cook request");
+            return nullptr;
+        }
+
+        const auto* pathText = keyText + keyLength + 1;
+        const auto pathLength = strnlen(pathText, request.size() - keyLength - 1);
+        if (keyLength + 1 + pathLength + 1 > request.size())
+        {
+            TRACE_ERROR("Invalid cook request");
+            return nullptr;
+        }
+
+        base::res::ResourceKey key;
+        if (!base::res::ResourceKey::Parse(base::StringView<char>(keyText, keyText + keyLength), key) || key.empty())
+        {
+            TRACE_ERROR("Invalid resource key '{}' in cook request", keyText);
+            return nullptr;
+        }
+
+        const auto outPath = base::io::AbsolutePath::Build(base::UTF16StringBuf(pathText, pathLength));
+
+        TRACE_INFO("Cooking file {}", key);
+
+        // capture all log output, we are only interested in success/failure
+        base::res::ResourcePtr cookedFile;
+        {
+            CookingLogCapture logCapture(outPath, m_captureLogs);
+            cookedFile = m_cooker->cook(key);
+
+            if (m_discardCookedLogs && cookedFile)
+                logCapture.discardLog();
+        }
+
+        if (!cookedFile)
+        {
+            TRACE_ERROR("Failed to cook file '{}'", key.path());
+            return nullptr;
+        }
+
+        // serialize the same way the file will be saved
+        base::stream::MemoryWriter writer;
+        auto binarySaver = base::CreateSharedPtr<base::res::binary::BinarySaver>();
+        base::stream::SavingContext savingContext(cookedFile);
+        savingContext.m_contextName = base::TempString("{}", outPath);
+        if (!binarySaver->saveObjects(writer, savingContext))
+        {
+            TRACE_ERROR("Failed to serialize cooked file '{}'", key.path());
+            return nullptr;
+        }
+
+        return writer.extractData();
+    }
+
+    //--
+
+} // bcc
@@ -0,0 +1,127 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+
+#include "base/app/include/command.h"
+#include "base/app/include/commandline.h"
+#include "base/io/include/ioSystem.h"
+#include "base/image/include/imageView.h"
+#include "base/system/include/timedScope.h"
+
+#include "assets/image_loader/include/freeImageLoader.h"
+#include "assets/image_texture/include/imageCompression.h"
+
+namespace bcc
+{
+    //--
+
+    /// measure throughput of the texture import pipeline (decode + optional compression) on a folder with images
+    /// usage: bcc imageimport -dir=<folder> [-pattern=*.png] [-jobs=N] [-compress]
+    class CommandImageImport : public base::app::ICommand
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(CommandImageImport, base::app::ICommand);
+
+    public:
+        virtual bool run(const base::app::CommandLine& commandline) override final;
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(CommandImageImport);
+        RTTI_METADATA(base::app::CommandNameMetadata).name("imageimport");
+    RTTI_END_TYPE();
+
+    //--
+
+    bool CommandImageImport::run(const base::app::CommandLine& commandline)
+    {
+        const auto dir = base::io::AbsolutePath::BuildAsDir(commandline.singleValueUTF16("dir"));
+        if (dir.empty())
+        {
+            TRACE_ERROR("Missing required argument -dir");
+            return false;
+        }
+
+        auto pattern = commandline.singleValueUTF16("pattern");
+        if (pattern.empty())
+            pattern = L"*.*";
+
+        base::Array<base::io::AbsolutePath> files;
+        IO::GetInstance().findFiles(dir, pattern, files, true);
+        if (files.empty())
+        {
+            TRACE_ERROR("No images found in '{}'", dir);
+            return false;
+        }
+
+        const auto numJobs = std::max<int>(1, commandline.singleValueInt("jobs", Fibers::GetInstance().workerThreadCount()));
+        const auto compress = commandline.hasParam("compress");
+        TRACE_INFO("Importing {} images from '{}' using {} jobs{}", files.size(), dir, numJobs, compress ? " (with compression)" : "");
+
+        std::atomic<uint32_t> nextFileIndex(0);
+        std::atomic<uint32_t> numImported(0);
+        std::atomic<uint32_t> numFailed(0);
+        std::atomic<uint64_t> numPixels(0);
+        std::atomic<uint64_t> numSourceBytes(0);
+
+        base::ScopeTimer timer;
+
+        // each job pulls files from the shared list until it runs out, the decoder keeps the memory in check
+        RunFiberLoop("ImageImport", numJobs, -1, [&](uint32_t jobIndex)
+            {
+                for (;;)
+                {
+                    const auto fileIndex = nextFileIndex++;
+                    if (fileIndex >= files.size())
+                        break;
+
+                    const auto& path = files[fileIndex];
+                    const auto content = IO::GetInstance().loadIntoMemoryForReading(path);
+                    if (!content)
+                    {
+                        TRACE_WARNING("Unable to load '{}'", path);
+                        numFailed += 1;
+                        continue;
+                    }
+
+                    numSourceBytes += content.size();
+
+                    auto loadedImage = base::image::LoadImageWithFreeImage(content.data(), content.size());
+                    if (!loadedImage)
+                    {
+                        TRACE_WARNING("Unable to decode '{}'", path);
+                        numFailed += 1;
+                        continue;
+                    }
+
+                    if (compress)
+                    {
+                        rendering::ImageCompressionSettings settings;
+                        if (!rendering::CompressImage(loadedImage->view(), settings, base::IProgressTracker::DevNull()))
+                        {
+                            TRACE_WARNING("Unable to compress '{}'", path);
+                            numFailed += 1;
+                            continue;
+                        }
+                    }
+
+                    numPixels += (uint64_t)loadedImage->width * loadedImage->height;
+                    numImported += 1;
+                }
+            });
+
+        const auto totalTime = timer.timeElapsed();
+        const auto megaPixels = numPixels.load() / 1000000.0;
+        const auto stats = base::image::GetFreeImageDecodingStats();
+
+        TRACE_INFO("Imported {} images ({} failed), {} of source data, {} MPix in {}", numImported.load(), numFailed.load(), MemSize(numSourceBytes.load()), Prec(megaPixels, 1), TimeInterval(totalTime));
+        TRACE_INFO("Throughput: {} images/s, {} MPix/s", Prec(numImported.load() / std::max(totalTime, 0.001), 1), Prec(megaPixels / std::max(totalTime, 0.001), 1));
+        TRACE_INFO("Decoding memory peak: {}, {} images waited for the memory budget", MemSize(stats.memoryPeak), stats.numImagesWaited);
+        return numFailed.load() == 0;
+    }
+
+    //--
+
+} // bcc
@@ -0,0 +1,334 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "cookWorkerFarm.h"
+
+#include "base/io/include/ioSystem.h"
+
+namespace bcc
+{
+    //--
+
+    // how many times we try to cook a file that crashes the workers before giving up on it
+    static const uint32_t MAX_COOK_ATTEMPTS = 3;
+
+    // how often we check if the worker processes are still alive
+    static const uint32_t MONITOR_INTERVAL_MS = 100;
+
+    // default time a worker has to cook a single file before it's considered hung, big files may take a while
+    static const uint32_t DEFAULT_JOB_TIMEOUT_SECONDS = 600;
+
+    //--
+
+    void CookWorkerFarm::Worker::processData(const void* data, uint32_t dataSize)
+    {
+        messages.push(data, dataSize);
+
+        CookWorkerMessageHeader header;
+        base::Buffer payload;
+        while (messages.pop(header, payload))
+        {
+            auto lock = CreateLock(jobLock);
+
+            // results for jobs we no longer wait for are ignored (ie. the worker was considered dead)
+            if (jobState != JobState::Pending || header.jobId != jobId)
+                continue;
+
+            if (header.type == CookWorkerMessageType::CookResult && payload)
+                finishJob_NoLock(JobState::Finished, payload);
+            else
+                finishJob_NoLock(JobState::Failed, nullptr);
+        }
+
+        // we can't resynchronize with the worker, consider it dead, it will be restarted
+        if (messages.corrupted())
+        {
+            auto lock = CreateLock(jobLock);
+            if (jobState == JobState::Pending)
+                finishJob_NoLock(JobState::Crashed, nullptr);
+        }
+    }
+
+    void CookWorkerFarm::Worker::finishJob_NoLock(JobState state, const base::Buffer& result)
+    {
+        ASSERT(jobState == JobState::Pending);
+        jobState = state;
+        jobResult = result;
+        Fibers::GetInstance().signalCounter(jobSignal);
+    }
+
+    //--
+
+    CookWorkerFarm::CookWorkerFarm()
+    {}
+
+    CookWorkerFarm::~CookWorkerFarm()
+    {
+        m_monitorThreadRequestExit = 1;
+        m_monitorThread.close();
+
+        for (auto* worker : m_workers)
+        {
+            stopWorker(*worker, true);
+            MemDelete(worker);
+        }
+
+        m_workers.clear();
+    }
+
+    bool CookWorkerFarm::start(uint32_t numWorkers, const base::app::CommandLine& commandline)
+    {
+        ASSERT_EX(m_workers.empty(), "Cook workers already started");
+
+        m_jobTimeout = std::max<int>(1, commandline.singleValueInt("cookTimeout", DEFAULT_JOB_TIMEOUT_SECONDS));
+
+        // the workers must see the same depot and use the same settings as we do
+        for (const auto& param : commandline.params())
+        {
+            if (param.value.empty())
+                m_forwardedArguments.emplaceBack(base::UTF16StringBuf(base::TempString("-{}", param.name).c_str()));
+            else
+                m_forwardedArguments.emplaceBack(base::UTF16StringBuf(base::TempString("-{}=\"{}\"", param.name, param.value).c_str()));
+        }
+
+        for (uint32_t i = 0; i < numWorkers; ++i)
+        {
+            auto* worker = MemNew(Worker);
+            worker->farm = this;
+            worker->index = i;
+            m_workers.pushBack(worker);
+
+            if (!startWorker(*worker))
+            {
+                TRACE_ERROR("Failed to start cook worker {}", i);
+                return false;
+            }
+
+            m_freeWorkers.pushBack(worker);
+        }
+
+        // start the thread that watches for crashed workers
+        base::ThreadSetup setup;
+        setup.m_priority = base::ThreadPriority::AboveNormal;
+        setup.m_name = "CookWorkerMonitor";
+        setup.m_function = [this]() { monitorWorkers(); };
+        m_monitorThread.init(setup);
+
+        TRACE_INFO("Started {} cook worker processes", numWorkers);
+        return true;
+    }
+
+    bool CookWorkerFarm::startWorker(Worker& worker)
+    {
+        // the reading end must exist before the worker can open the writing end
+        worker.messages.reset();
+        worker.resultPipe.reset(base::process::IPipeReader::Create(&worker));
+        worker.jobPipe.reset(base::process::IPipeWriter::Create());
+        if (!worker.resultPipe || !worker.jobPipe)
+        {
+            TRACE_ERROR("Failed to create communication pipes for cook worker {}", worker.index);
+            return false;
+        }
+
+        // run ourselves as the worker
+        base::process::ProcessSetup setup;
+        setup.m_processPath = IO::GetInstance().systemPath(base::io::PathCategory::ExecutableFile).toString();
+        setup.m_showWindow = false;
+        setup.m_arguments.emplaceBack(base::UTF16StringBuf(L"cookWorker"));
+        setup.m_arguments.pushBack(m_forwardedArguments.typedData(), m_forwardedArguments.size());
+        setup.m_arguments.emplaceBack(base::UTF16StringBuf(base::TempString("-jobPipe={}", worker.jobPipe->name()).c_str()));
+        setup.m_arguments.emplaceBack(base::UTF16StringBuf(base::TempString("-resultPipe={}", worker.resultPipe->name()).c_str()));
+
+        auto* process = base::process::IProcess::Create(setup);
+        if (!process)
+        {
+            TRACE_ERROR("Failed to start process for cook worker {}", worker.index);
+            return false;
+        }
+
+        auto lock = CreateLock(worker.jobLock);
+        worker.process.reset(process);
+        return true;
+    }
+
+    void CookWorkerFarm::stopWorker(Worker& worker, bool graceful)
+    {
+        if (graceful && worker.jobPipe)
+            SendCookWorkerMessage(*worker.jobPipe, CookWorkerMessageType::Quit, 0);
+
+        // take the process away from the monitor thread, NOTE: destroying the process object waits for it a little and kills it if it does not exit
+        base::UniquePtr<base::process::IProcess> process;
+        {
+            auto lock = CreateLock(worker.jobLock);
+            process = std::move(worker.process);
+        }
+
+        process.reset();
+        worker.jobPipe.reset();
+        worker.resultPipe.reset();
+    }
+
+    //--
+
+    CookWorkerFarm::Worker* CookWorkerFarm::acquireWorker()
+    {
+        WorkerWaiter waiter;
+
+        {
+            auto lock = CreateLock(m_lock);
+            if (!m_freeWorkers.empty())
+            {
+                auto* worker = m_freeWorkers.back();
+                m_freeWorkers.popBack();
+                return worker;
+            }
+
+            waiter.signal = Fibers::GetInstance().createCounter("CookWorkerWait", 1);
+            m_waiters.push(&waiter);
+        }
+
+        // the worker is handed directly to us by whoever releases it
+        Fibers::GetInstance().waitForCounterAndRelease(waiter.signal);
+        ASSERT(waiter.worker != nullptr);
+        return waiter.worker;
+    }
+
+    void CookWorkerFarm::releaseWorker(Worker* worker)
+    {
+        WorkerWaiter* waiter = nullptr;
+
+        {
+            auto lock = CreateLock(m_lock);
+            if (m_waiters.empty())
+            {
+                m_freeWorkers.pushBack(worker);
+                return;
+            }
+
+            waiter = m_waiters.top();
+            m_waiters.pop();
+            waiter->worker = worker;
+        }
+
+        Fibers::GetInstance().signalCounter(waiter->signal);
+    }
+
+    //--
+
+    base::Buffer CookWorkerFarm::cook(const base::res::ResourceKey& key, const base::io::AbsolutePath& outPath)
+    {
+        // prepare the request: resource key and the output path, both zero terminated
+        base::Array<uint8_t> request;
+        {
+            // NOTE: full class name is used, the short names are not always known to the parser
+            const base::StringBuf keyText = base::TempString("{}${}", key.cls()->name(), key.path());
+            const auto pathText = outPath.ansi_str();
+            memcpy(request.allocateUninitialized(keyText.length() + 1), keyText.c_str(), keyText.length() + 1);
+            memcpy(request.allocateUninitialized(pathText.length() + 1), pathText.c_str(), pathText.length() + 1);
+        }
+
+        for (uint32_t attempt = 1; attempt <= MAX_COOK_ATTEMPTS; ++attempt)
+        {
+            auto* worker = acquireWorker();
+
+            // setup the job
+            base::fibers::WaitCounter jobSignal;
+            uint32_t jobId = 0;
+            {
+                auto lock = CreateLock(worker->jobLock);
+                jobId = m_nextJobId++;
+                jobSignal = Fibers::GetInstance().createCounter("CookWorkerJob", 1);
+
+                worker->jobId = jobId;
+                worker->jobSignal = jobSignal;
+                worker->jobState = JobState::Pending;
+                worker->jobDeadline = base::NativeTimePoint::Now() + m_jobTimeout;
+                worker->jobResult.reset();
+
+                // worker that failed to restart
+                if (!worker->process)
+                    worker->finishJob_NoLock(JobState::Crashed, nullptr);
+            }
+
+            // send it, the pipe can only be lost if the worker is gone
+            if (worker->jobPipe && !SendCookWorkerMessage(*worker->jobPipe, CookWorkerMessageType::CookRequest, jobId, request.data(), request.size()))
+            {
+                auto lock = CreateLock(worker->jobLock);
+                if (worker->jobState == JobState::Pending)
+                    worker->finishJob_NoLock(JobState::Crashed, nullptr);
+            }
+
+            // wait for the result (or the crash)
+            Fibers::GetInstance().waitForCounterAndRelease(jobSignal);
+
+            JobState state = JobState::None;
+            base::Buffer result;
+            {
+                auto lock = CreateLock(worker->jobLock);
+                state = worker->jobState;
+                result = std::move(worker->jobResult);
+                worker->jobState = JobState::None;
+            }
+
+            if (state != JobState::Crashed && state != JobState::TimedOut)
+            {
+                releaseWorker(worker);
+                return (state == JobState::Finished) ? result : nullptr;
+            }
+
+            // restart the worker, the next attempt may land on a different one
+            if (state == JobState::TimedOut)
+                TRACE_ERROR("Cook worker {} did not finish cooking '{}' in {}s, it was killed, restarting it", worker->index, key, m_jobTimeout);
+            else
+                TRACE_WARNING("Cook worker {} crashed while cooking '{}' (attempt {}/{}), restarting it", worker->index, key, attempt, MAX_COOK_ATTEMPTS);
+            stopWorker(*worker, false);
+            if (!startWorker(*worker))
+                TRACE_ERROR("Failed to restart cook worker {}", worker->index);
+            m_numRestarts += 1;
+            releaseWorker(worker);
+
+            // a file that hangs the cooker will most likely hang it again, don't block another worker for that long
+            if (state == JobState::TimedOut)
+                return nullptr;
+        }
+
+        TRACE_ERROR("Cooking '{}' crashed the workers {} times, giving up", key, MAX_COOK_ATTEMPTS);
+        return nullptr;
+    }
+
+    //--
+
+    void CookWorkerFarm::monitorWorkers()
+    {
+        while (!m_monitorThreadRequestExit)
+        {
+            base::Sleep(MONITOR_INTERVAL_MS);
+
+            // we only care about the workers that have a job, the idle ones are checked when they get one
+            for (auto* worker : m_workers)
+            {
+                auto lock = CreateLock(worker->jobLock);
+                if (worker->jobState != JobState::Pending)
+                    continue;
+
+                if (!worker->process || !worker->process->isRunning())
+                {
+                    worker->finishJob_NoLock(JobState::Crashed, nullptr);
+                }
+                else if (worker->jobDeadline.reached())
+                {
+                    // kill the hung worker, that also unblocks the cooking fiber if it's stuck writing to the full job pipe, the worker is restarted by it
+                    worker->process->terminate();
+                    worker->finishJob_NoLock(JobState::TimedOut, nullptr);
+                }
+            }
+        }
+    }
+
+    //--
+
+} // bcc
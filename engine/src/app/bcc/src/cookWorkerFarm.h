@@ -0,0 +1,112 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "cookWorkerProtocol.h"
+
+#include "base/process/include/process.h"
+#include "base/app/include/commandline.h"
+#include "base/resources/include/resourcePath.h"
+#include "base/io/include/absolutePath.h"
+#include "base/containers/include/uniquePtr.h"
+#include "base/containers/include/queue.h"
+#include "base/fibers/include/fiberSystem.h"
+
+namespace bcc
+{
+    //--
+
+    /// farm of local worker processes (bcc cookWorker) the cooking can be offloaded to
+    /// each worker cooks one file at a time so the heavy cookers that are not thread safe (or need a lot of memory) run fully isolated
+    /// a worker that crashes is restarted and the file it was cooking is retried on it
+    /// a worker that does not finish the job in time (-cookTimeout=<seconds>) is considered hung, it's killed and restarted, the file is not retried
+    class CookWorkerFarm : public base::NoCopy
+    {
+    public:
+        CookWorkerFarm();
+        ~CookWorkerFarm(); // tells the workers to quit
+
+        /// start the worker processes, the params from our commandline are forwarded to them so they see the same depot and settings
+        bool start(uint32_t numWorkers, const base::app::CommandLine& commandline);
+
+        /// cook file in the first free worker process, returns the cooked file content (ready to save) or empty buffer if the cooking failed
+        /// NOTE: waits for a free worker if all of them are busy
+        CAN_YIELD base::Buffer cook(const base::res::ResourceKey& key, const base::io::AbsolutePath& outPath);
+
+        //--
+
+        /// number of worker processes
+        INLINE uint32_t numWorkers() const { return m_workers.size(); }
+
+        /// number of times we had to restart a worker process
+        INLINE uint32_t numRestarts() const { return m_numRestarts.load(); }
+
+    private:
+        enum class JobState : uint8_t
+        {
+            None,
+            Pending, // sent to the worker, waiting for the result
+            Finished, // cooked data received
+            Failed, // worker reported the file failed to cook
+            Crashed, // worker process is gone
+            TimedOut, // worker did not finish the job in time and was killed
+        };
+
+        struct Worker : public base::process::IOutputCallback
+        {
+            CookWorkerFarm* farm = nullptr;
+            uint32_t index = 0;
+
+            base::UniquePtr<base::process::IPipeReader> resultPipe;
+            base::UniquePtr<base::process::IPipeWriter> jobPipe;
+            base::UniquePtr<base::process::IProcess> process;
+            CookWorkerMessageReader messages; // only accessed on the pipe reading thread
+
+            base::SpinLock jobLock; // guards the job state, the result is delivered on the pipe thread and the crashes are detected on the monitor thread
+            uint32_t jobId = 0;
+            JobState jobState = JobState::None;
+            base::NativeTimePoint jobDeadline; // worker is considered hung if it does not finish the job till then
+            base::fibers::WaitCounter jobSignal;
+            base::Buffer jobResult;
+
+            virtual void processData(const void* data, uint32_t dataSize) override final;
+            void finishJob_NoLock(JobState state, const base::Buffer& result);
+        };
+
+        struct WorkerWaiter
+        {
+            base::fibers::WaitCounter signal;
+            Worker* worker = nullptr;
+        };
+
+        base::Array<Worker*> m_workers;
+        base::Array<base::UTF16StringBuf> m_forwardedArguments;
+
+        base::SpinLock m_lock;
+        base::Array<Worker*> m_freeWorkers;
+        base::Queue<WorkerWaiter*> m_waiters; // fibers waiting for a free worker, served in order
+
+        base::Thread m_monitorThread;
+        std::atomic<uint32_t> m_monitorThreadRequestExit = 0;
+
+        double m_jobTimeout = 0.0; // seconds
+
+        std::atomic<uint32_t> m_nextJobId = 1;
+        std::atomic<uint32_t> m_numRestarts = 0;
+
+        bool startWorker(Worker& worker);
+        void stopWorker(Worker& worker, bool graceful);
+
+        CAN_YIELD Worker* acquireWorker();
+        void releaseWorker(Worker* worker);
+
+        void monitorWorkers();
+    };
+
+    //--
+
+} // bcc
@@ -0,0 +1,117 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "cookWorkerProtocol.h"
+
+namespace bcc
+{
+    //--
+
+    static bool WriteAll(base::process::IPipeWriter& pipe, const void* data, uint32_t size)
+    {
+        auto* writePtr = (const uint8_t*)data;
+        while (size > 0)
+        {
+            if (!pipe.isOpened())
+                return false;
+
+            // the pipe is non blocking, wait for the other side to catch up
+            // NOTE: inside a fiber job we yield so the fiber thread can run other jobs in the meantime, outside of fibers we just sleep
+            const auto written = pipe.write(writePtr, size);
+            if (!written)
+            {
+                if (Fibers::GetInstance().currentJobID())
+                    Fibers::GetInstance().yield();
+                else
+                    base::Sleep(1);
+                continue;
+            }
+
+            writePtr += written;
+            size -= written;
+        }
+
+        return true;
+    }
+
+    bool SendCookWorkerMessage(base::process::IPipeWriter& pipe, CookWorkerMessageType type, uint32_t jobId, const void* payload, uint32_t payloadSize)
+    {
+        CookWorkerMessageHeader header;
+        header.type = type;
+        header.jobId = jobId;
+        header.size = payloadSize;
+
+        if (!WriteAll(pipe, &header, sizeof(header)))
+            return false;
+
+        return WriteAll(pipe, payload, payloadSize);
+    }
+
+    //--
+
+    void CookWorkerMessageReader::push(const void* data, uint32_t size)
+    {
+        // compact the consumed data before we grow the buffer
+        if (m_readOffset > 0)
+        {
+            const auto remaining = m_data.size() - m_readOffset;
+            memmove(m_data.data(), m_data.data() + m_readOffset, remaining);
+            m_data.resize(remaining);
+            m_readOffset = 0;
+        }
+
+        auto* writePtr = m_data.allocateUninitialized(size);
+        memcpy(writePtr, data, size);
+    }
+
+    bool CookWorkerMessageReader::pop(CookWorkerMessageHeader& outHeader, base::Buffer& outPayload)
+    {
+        if (m_corrupted)
+            return false;
+
+        const auto available = m_data.size() - m_readOffset;
+        if (available < sizeof(CookWorkerMessageHeader))
+            return false;
+
+        memcpy(&outHeader, m_data.data() + m_readOffset, sizeof(CookWorkerMessageHeader));
+        if (outHeader.magic != CookWorkerMessageHeader::MAGIC)
+        {
+            TRACE_ERROR("Invalid data received from cook worker pipe");
+            m_corrupted = true;
+            return false;
+        }
+
+        // wait for the whole payload
+        if (available - sizeof(CookWorkerMessageHeader) < outHeader.size)
+            return false;
+
+        outPayload.reset();
+        if (outHeader.size)
+        {
+            outPayload = base::Buffer::Create(POOL_TEMP, outHeader.size, 0, m_data.data() + m_readOffset + sizeof(CookWorkerMessageHeader));
+            if (!outPayload)
+            {
+                TRACE_ERROR("Unable to allocate {} for message from cook worker", MemSize(outHeader.size));
+                m_corrupted = true;
+                return false;
+            }
+        }
+
+        m_readOffset += sizeof(CookWorkerMessageHeader) + outHeader.size;
+        return true;
+    }
+
+    void CookWorkerMessageReader::reset()
+    {
+        m_data.reset();
+        m_readOffset = 0;
+        m_corrupted = false;
+    }
+
+    //--
+
+} // bcc
@@ -0,0 +1,69 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "base/process/include/pipe.h"
+
+namespace bcc
+{
+    //--
+
+    /// type of message exchanged between the cooking master and the cook worker processes
+    enum class CookWorkerMessageType : uint32_t
+    {
+        CookRequest = 1, // master -> worker: cook a file, payload: resource key and the output path (zero terminated UTF8 texts)
+        CookResult = 2, // worker -> master: file was cooked, payload: cooked file content (as it should be saved)
+        CookFailed = 3, // worker -> master: file failed to cook, no payload
+        Quit = 4, // master -> worker: no more jobs, exit
+    };
+
+#pragma pack(push)
+#pragma pack(4)
+    struct CookWorkerMessageHeader
+    {
+        static const uint32_t MAGIC = 0x4B4F4F43; // 'COOK'
+
+        uint32_t magic = MAGIC;
+        CookWorkerMessageType type = CookWorkerMessageType::Quit;
+        uint32_t jobId = 0;
+        uint32_t size = 0; // size of the payload that follows the header
+    };
+#pragma pack(pop)
+
+    //--
+
+    /// send message over the pipe, waits if the pipe is full (yields when called from a fiber)
+    /// NOTE: returns false if the pipe got closed, the other side is gone in that case
+    extern bool SendCookWorkerMessage(base::process::IPipeWriter& pipe, CookWorkerMessageType type, uint32_t jobId, const void* payload = nullptr, uint32_t payloadSize = 0);
+
+    //--
+
+    /// reassembles the messages from the data received from the pipe (the data arrives in arbitrary chunks)
+    class CookWorkerMessageReader : public base::NoCopy
+    {
+    public:
+        /// add received data
+        void push(const void* data, uint32_t size);
+
+        /// extract next complete message, returns false if there's none (yet)
+        bool pop(CookWorkerMessageHeader& outHeader, base::Buffer& outPayload);
+
+        /// did we receive anything that does not look like our protocol ? there's no way to recover from that
+        INLINE bool corrupted() const { return m_corrupted; }
+
+        /// drop all received data
+        void reset();
+
+    private:
+        base::Array<uint8_t> m_data;
+        uint32_t m_readOffset = 0;
+        bool m_corrupted = false;
+    };
+
+    //--
+
+} // bcc
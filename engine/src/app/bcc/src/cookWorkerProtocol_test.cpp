@@ -0,0 +1,229 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "cookWorkerProtocol.h"
+
+#include "base/test/include/gtest/gtest.h"
+
+DECLARE_TEST_FILE(CookWorkerProtocol);
+
+using namespace bcc;
+
+namespace test
+{
+    // serialize message the same way SendCookWorkerMessage puts it into the pipe
+    static void WriteMessage(base::Array<uint8_t>& outData, CookWorkerMessageType type, uint32_t jobId, const void* payload, uint32_t payloadSize)
+    {
+        CookWorkerMessageHeader header;
+        header.type = type;
+        header.jobId = jobId;
+        header.size = payloadSize;
+
+        memcpy(outData.allocateUninitialized(sizeof(header)), &header, sizeof(header));
+        if (payloadSize)
+            memcpy(outData.allocateUninitialized(payloadSize), payload, payloadSize);
+    }
+
+    static void WriteMessage(base::Array<uint8_t>& outData, CookWorkerMessageType type, uint32_t jobId, const char* text)
+    {
+        WriteMessage(outData, type, jobId, text, strlen(text) + 1);
+    }
+
+    static bool PayloadEquals(const base::Buffer& payload, const char* text)
+    {
+        const auto length = strlen(text) + 1;
+        return payload.size() == length && 0 == memcmp(payload.data(), text, length);
+    }
+
+} // test
+
+TEST(CookWorkerProtocol, EmptyReaderHasNoMessages)
+{
+    CookWorkerMessageReader reader;
+
+    CookWorkerMessageHeader header;
+    base::Buffer payload;
+    EXPECT_FALSE(reader.pop(header, payload));
+    EXPECT_FALSE(reader.corrupted());
+}
+
+TEST(CookWorkerProtocol, MessageWithoutPayload)
+{
+    base::Array<uint8_t> data;
+    test::WriteMessage(data, CookWorkerMessageType::Quit, 0, nullptr, 0);
+
+    CookWorkerMessageReader reader;
+    reader.push(data.data(), data.size());
+
+    CookWorkerMessageHeader header;
+    base::Buffer payload;
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(CookWorkerMessageType::Quit, header.type);
+    EXPECT_EQ(0, header.size);
+    EXPECT_FALSE(payload);
+
+    EXPECT_FALSE(reader.pop(header, payload));
+    EXPECT_FALSE(reader.corrupted());
+}
+
+TEST(CookWorkerProtocol, MessageSplitIntoSingleBytes)
+{
+    base::Array<uint8_t> data;
+    test::WriteMessage(data, CookWorkerMessageType::CookResult, 42, "cooked data");
+
+    CookWorkerMessageReader reader;
+
+    CookWorkerMessageHeader header;
+    base::Buffer payload;
+    for (uint32_t i = 0; i < data.size() - 1; ++i)
+    {
+        reader.push(data.data() + i, 1);
+        ASSERT_FALSE(reader.pop(header, payload)) << "Message popped after " << (i + 1) << " bytes out of " << data.size();
+    }
+
+    reader.push(data.data() + data.size() - 1, 1);
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(CookWorkerMessageType::CookResult, header.type);
+    EXPECT_EQ(42, header.jobId);
+    EXPECT_TRUE(test::PayloadEquals(payload, "cooked data"));
+
+    EXPECT_FALSE(reader.pop(header, payload));
+    EXPECT_FALSE(reader.corrupted());
+}
+
+TEST(CookWorkerProtocol, MessageSplitInsideHeaderAndPayload)
+{
+    base::Array<uint8_t> data;
+    test::WriteMessage(data, CookWorkerMessageType::CookRequest, 7, "engine/textures/test.png");
+
+    CookWorkerMessageReader reader;
+
+    CookWorkerMessageHeader header;
+    base::Buffer payload;
+
+    // part of the header
+    reader.push(data.data(), 5);
+    EXPECT_FALSE(reader.pop(header, payload));
+
+    // rest of the header and part of the payload
+    reader.push(data.data() + 5, sizeof(CookWorkerMessageHeader) + 3 - 5);
+    EXPECT_FALSE(reader.pop(header, payload));
+
+    // rest of the payload
+    reader.push(data.data() + sizeof(CookWorkerMessageHeader) + 3, data.size() - sizeof(CookWorkerMessageHeader) - 3);
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(CookWorkerMessageType::CookRequest, header.type);
+    EXPECT_EQ(7, header.jobId);
+    EXPECT_TRUE(test::PayloadEquals(payload, "engine/textures/test.png"));
+    EXPECT_FALSE(reader.corrupted());
+}
+
+TEST(CookWorkerProtocol, CoalescedMessages)
+{
+    base::Array<uint8_t> data;
+    test::WriteMessage(data, CookWorkerMessageType::CookResult, 1, "first");
+    test::WriteMessage(data, CookWorkerMessageType::CookFailed, 2, nullptr, 0);
+    test::WriteMessage(data, CookWorkerMessageType::CookResult, 3, "third");
+
+    CookWorkerMessageReader reader;
+    reader.push(data.data(), data.size());
+
+    CookWorkerMessageHeader header;
+    base::Buffer payload;
+
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(1, header.jobId);
+    EXPECT_TRUE(test::PayloadEquals(payload, "first"));
+
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(2, header.jobId);
+    EXPECT_EQ(CookWorkerMessageType::CookFailed, header.type);
+    EXPECT_FALSE(payload);
+
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(3, header.jobId);
+    EXPECT_TRUE(test::PayloadEquals(payload, "third"));
+
+    EXPECT_FALSE(reader.pop(header, payload));
+    EXPECT_FALSE(reader.corrupted());
+}
+
+TEST(CookWorkerProtocol, CoalescedMessagesInArbitraryChunks)
+{
+    static const uint32_t NUM_MESSAGES = 100;
+
+    base::Array<uint8_t> data;
+    for (uint32_t i = 0; i < NUM_MESSAGES; ++i)
+        test::WriteMessage(data, CookWorkerMessageType::CookResult, i + 1, base::TempString("message {}", i).c_str());
+
+    CookWorkerMessageReader reader;
+
+    CookWorkerMessageHeader header;
+    base::Buffer payload;
+
+    // the chunks end at random places: in the headers, in the payloads and between the messages
+    uint32_t numReceived = 0;
+    uint32_t offset = 0;
+    uint32_t seed = 12345;
+    while (offset < data.size())
+    {
+        seed = seed * 1103515245 + 12345;
+        const auto chunkSize = std::min<uint32_t>(1 + (seed >> 16) % 64, data.size() - offset);
+        reader.push(data.data() + offset, chunkSize);
+        offset += chunkSize;
+
+        while (reader.pop(header, payload))
+        {
+            ASSERT_LT(numReceived, NUM_MESSAGES);
+            EXPECT_EQ(numReceived + 1, header.jobId);
+            EXPECT_TRUE(test::PayloadEquals(payload, base::TempString("message {}", numReceived).c_str()));
+            numReceived += 1;
+        }
+    }
+
+    EXPECT_EQ(NUM_MESSAGES, numReceived);
+    EXPECT_FALSE(reader.corrupted());
+}
+
+TEST(CookWorkerProtocol, InvalidMagicCorruptsReader)
+{
+    base::Array<uint8_t> data;
+    test::WriteMessage(data, CookWorkerMessageType::CookResult, 1, "valid");
+
+    const auto badHeaderOffset = data.size();
+    test::WriteMessage(data, CookWorkerMessageType::CookResult, 2, "invalid");
+    data[badHeaderOffset] ^= 0xFF;
+
+    CookWorkerMessageReader reader;
+    reader.push(data.data(), data.size());
+
+    // messages before the bad data are still received
+    CookWorkerMessageHeader header;
+    base::Buffer payload;
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(1, header.jobId);
+    EXPECT_FALSE(reader.corrupted());
+
+    EXPECT_FALSE(reader.pop(header, payload));
+    EXPECT_TRUE(reader.corrupted());
+
+    // no recovery, even if valid data follows
+    base::Array<uint8_t> moreData;
+    test::WriteMessage(moreData, CookWorkerMessageType::CookResult, 3, "more");
+    reader.push(moreData.data(), moreData.size());
+    EXPECT_FALSE(reader.pop(header, payload));
+    EXPECT_TRUE(reader.corrupted());
+
+    // until reset
+    reader.reset();
+    EXPECT_FALSE(reader.corrupted());
+    reader.push(moreData.data(), moreData.size());
+    ASSERT_TRUE(reader.pop(header, payload));
+    EXPECT_EQ(3, header.jobId);
+}
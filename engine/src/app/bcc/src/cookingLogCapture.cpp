@@ -0,0 +1,61 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "cookingLogCapture.h"
+
+#include "base/io/include/ioSystem.h"
+#include "base/containers/include/stringBuilder.h"
+
+namespace bcc
+{
+    //--
+
+    CookingLogCapture::CookingLogCapture(const base::io::AbsolutePath& outPath, bool captureFully)
+        : m_fullyCaptured(captureFully)
+    {
+        m_logFilePath = outPath.addExtension(".log");
+        m_logOutput = IO::GetInstance().openForWriting(m_logFilePath);
+    }
+
+    CookingLogCapture::~CookingLogCapture()
+    {
+        m_logOutput.reset();
+    }
+
+    void CookingLogCapture::discardLog()
+    {
+        if (m_logOutput)
+            m_logOutput.reset();
+
+        IO::GetInstance().deleteFile(m_logFilePath);
+    }
+
+    bool CookingLogCapture::print(base::logging::OutputLevel level, const char* file, uint32_t line, const char* context, const char* text)
+    {
+        if (m_logOutput)
+        {
+            base::StringBuilder str;
+
+            switch (level)
+            {
+            case base::logging::OutputLevel::Error:; str.appendf("!!!! ERROR: "); break;
+            case base::logging::OutputLevel::Warning:; str.appendf("! WARNING: "); break;
+            }
+
+            str.append(text);
+            str.append("\n");
+
+            if (m_logOutput->writeSync(str.c_str(), str.length()) != str.length())
+                m_logOutput.reset();
+        }
+
+        return m_fullyCaptured; // consume
+    }
+
+    //--
+
+} // bcc
@@ -0,0 +1,37 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "base/io/include/absolutePath.h"
+#include "base/io/include/ioFileHandle.h"
+
+namespace bcc
+{
+    //--
+
+    /// captures the log output produced while cooking a single file into a "<cooked file>.log" file next to the output
+    /// NOTE: the local sink stays with the fiber job that created it (the scheduler detaches it on yield and wait) so several files can be cooked in parallel, each with its own capture
+    class CookingLogCapture : public base::logging::LocalLogSink
+    {
+    public:
+        CookingLogCapture(const base::io::AbsolutePath& outPath, bool captureFully);
+        virtual ~CookingLogCapture();
+
+        /// close and delete the log file, used when there was nothing interesting in it
+        void discardLog();
+
+        virtual bool print(base::logging::OutputLevel level, const char* file, uint32_t line, const char* context, const char* text) override;
+
+    private:
+        base::io::FileHandlePtr m_logOutput;
+        base::io::AbsolutePath m_logFilePath;
+        bool m_fullyCaptured;
+    };
+
+    //--
+
+} // bcc
@@ -117,6 +117,40 @@ namespace base
 
         //--
 
+        // Service metadata to specify on what threads the service can be initialized and updated
+        // by default services are initialized on fiber workers (as soon as the services they depend on are initialized) and updated on the main thread
+        class BASE_APP_API ServiceThreadingMetadata : public rtti::IMetadata
+        {
+            RTTI_DECLARE_VIRTUAL_CLASS(ServiceThreadingMetadata, rtti::IMetadata);
+
+        public:
+            ServiceThreadingMetadata();
+
+            // service must be initialized on the main thread, ie. it creates windows or the rendering context
+            INLINE ServiceThreadingMetadata& mainThreadInit()
+            {
+                m_mainThreadInit = true;
+                return *this;
+            }
+
+            // service's onSyncUpdate does not touch other services and can run on a fiber worker in parallel with other updates
+            // NOTE: the order specified with TickBeforeMetadata/TickAfterMetadata is still respected
+            INLINE ServiceThreadingMetadata& parallelUpdate()
+            {
+                m_parallelUpdate = true;
+                return *this;
+            }
+
+            INLINE bool isMainThreadInit() const { return m_mainThreadInit; }
+            INLINE bool isParallelUpdate() const { return m_parallelUpdate; }
+
+        private:
+            bool m_mainThreadInit = false;
+            bool m_parallelUpdate = false;
+        };
+
+        //--
+
         // application service, created with the application, accessible via the app handle
         // app->GetService<DepotService>()->LoadResource, 
         // app->GetService<RendererService>()->CreateFrame, etc
@@ -136,6 +170,8 @@ namespace base
 
             /// application is initializing, service can perform a self contained initialization that does not depend on any other service
             /// service can emit background initialization jobs (like connecting to remote server) that can continue once we enter next application state
+            /// NOTE: called on a fiber worker, possibly in parallel with other services, unless the service requires the main thread (see ServiceThreadingMetadata)
+            /// NOTE: only the services we declare dependency on (DependsOnServiceMetadata) are guaranteed to be initialized at this point
             virtual ServiceInitializationResult onInitializeService(const CommandLine& cmdLine) = 0;
 
             /// application is shutting down, last chance for cleanup
@@ -143,7 +179,7 @@ namespace base
             /// note: this function MAY be called while the background initialization jobs are processing
             virtual void onShutdownService() = 0;
 
-            /// update service, called from main platform thread every tick
+            /// update service, called from main platform thread every tick (or on a fiber worker if the service allows parallel update)
             /// simulated games are GUARANTEED not to have any async update at this time
             /// this is the safest place in the whole universe ;)
             virtual void onSyncUpdate() = 0;
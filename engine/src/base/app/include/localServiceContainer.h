@@ -26,6 +26,17 @@ namespace base
             DECLARE_SINGLETON(LocalServiceContainer);
 
         public:
+            typedef Array<ILocalService*> TRawServices;
+
+            /// services that can be updated at the same time, groups are updated one after another
+            struct TickGroup
+            {
+                TRawServices serialServices; // updated on the main thread, in order
+                TRawServices parallelServices; // updated on fiber workers, in parallel with the serial ones
+            };
+
+            typedef Array<TickGroup> TTickGroups;
+
             ///--
 
             /// initialize all local services, fails if any of the service initialization fails hard
@@ -70,9 +81,12 @@ namespace base
             typedef Array< RefPtr<ILocalService> > TServices;
             TServices m_services; // all services registered in the app
 
-            typedef Array<ILocalService*> TRawServices;
             TRawServices m_tickList; // list of services to tick (in the order of the updates)
 
+            TTickGroups m_tickGroups; // services that must tick in order end up in different groups, empty if nothing can tick in parallel
+
+            SpinLock m_servicesLock; // services are attached from multiple fibers during initialization
+
             //---
 
             LocalServiceContainer();
@@ -81,7 +95,10 @@ namespace base
 
             //---
 
-            /// attach service to the application
+            /// reserve the service map slots for given service class (and its base classes)
+            void reserveServiceSlots(ClassType serviceClass);
+
+            /// attach service to the application, NOTE: the slots must be reserved
             void attachService(const RefPtr<ILocalService>& service);
         };
 
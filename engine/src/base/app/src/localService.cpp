@@ -40,6 +40,14 @@ namespace base
 
         ///---
 
+        RTTI_BEGIN_TYPE_CLASS(ServiceThreadingMetadata);
+        RTTI_END_TYPE();
+
+        ServiceThreadingMetadata::ServiceThreadingMetadata()
+        {}
+
+        ///---
+
         RTTI_BEGIN_TYPE_ABSTRACT_CLASS(ILocalService);
         RTTI_END_TYPE();
 
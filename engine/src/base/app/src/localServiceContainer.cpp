@@ -10,13 +10,17 @@
 #include "application.h"
 #include "localService.h"
 #include "localServiceContainer.h"
+#include "localServiceScheduler.h"
+#include "configService.h"
 #include "commandline.h"
 
 #include "base/object/include/objectObserver.h"
 #include "base/object/include/rttiClassType.h"
 #include "base/object/include/rttiMetadata.h"
 #include "base/containers/include/queue.h"
+#include "base/fibers/include/fiberSystem.h"
 #include "base/memory/include/poolStats.h"
+#include "base/memory/include/frameArena.h"
 
 namespace base
 {
@@ -28,24 +32,38 @@ namespace base
         LocalServiceContainer::LocalServiceContainer()
         {}
 
-        void LocalServiceContainer::attachService(const RefPtr<ILocalService>& service)
+        void LocalServiceContainer::reserveServiceSlots(ClassType serviceClass)
         {
-            ASSERT(service.get() != nullptr);
-
-            // keep alive
-            m_services.pushBack(service);
-
             // map (can be at multiple slots)
             auto rootServiceClass = ILocalService::GetStaticClass();
-            auto serviceClass = service->cls();
             while (serviceClass != rootServiceClass)
             {
                 ASSERT(serviceClass->userIndex() == -1);
 
                 auto serviceId = m_serviceMap.size();
                 const_cast<base::rtti::IClassType*>(serviceClass.ptr())->assignUserIndex((short)serviceId); // TEMP HACK
-                m_serviceMap.pushBack(service.get());
+                m_serviceMap.pushBack(nullptr);
+
+                serviceClass = serviceClass->baseClass();
+            }
+        }
+
+        void LocalServiceContainer::attachService(const RefPtr<ILocalService>& service)
+        {
+            ASSERT(service.get() != nullptr);
+
+            auto lock = CreateLock(m_servicesLock);
 
+            // keep alive, NOTE: services are attached in the order they start initializing so the dependencies are always before us
+            m_services.pushBack(service);
+
+            // map (can be at multiple slots), the slots are reserved up front so the map can be read while we write it
+            auto rootServiceClass = ILocalService::GetStaticClass();
+            auto serviceClass = service->cls();
+            while (serviceClass != rootServiceClass)
+            {
+                ASSERT(serviceClass->userIndex() != -1);
+                m_serviceMap[serviceClass->userIndex()] = service.get();
                 serviceClass = serviceClass->baseClass();
             }
         }
@@ -77,6 +95,8 @@ namespace base
 
                 // we may have crashed, put a log
                 TRACE_INFO("All services closed");
+                m_tickGroups.clear();
+                m_tickList.clear();
                 m_services.clear();
 
                 // check if service pointer was released properly - it's illegal to hold onto those
@@ -104,39 +124,28 @@ namespace base
             // reset per frame memory stats
             base::mem::PoolStats::GetInstance().resetFrameStatistics();
 
+            // start new frame in the arena for per-frame temporaries, releases the memory of the oldest frame
+            base::mem::FrameArena::GetDefaultArena().advanceFrame();
+
             // process all global events that we may have pending
             // TODO: consider making this UI only
             base::IObjectObserver::DispatchPendingEvents();
 
             // update the sync part of all the service
-            for (auto service  : m_tickList)
-                service->onSyncUpdate();
+            if (m_tickGroups.empty())
+            {
+                for (auto service  : m_tickList)
+                    service->onSyncUpdate();
+            }
+            else
+            {
+                helper::UpdateTickGroups(m_tickGroups);
+            }
         }
 
         namespace helper
         {
-            struct ServiceInfo
-            {
-                ClassType m_class;
-                Array<ServiceInfo*> m_dependsOnInit;
-                Array<ServiceInfo*> m_tickBefore;
-                Array<ServiceInfo*> m_tickAfter;
-
-                Array<ServiceInfo*> m_adj; // temp
-                
-                RefPtr<ILocalService> m_service;
-
-                int m_depth;
-
-                INLINE ServiceInfo()
-                    : m_class(nullptr)
-                    , m_depth(0)
-                {}
-            };
-
-            typedef HashMap<ClassType, ServiceInfo*> ServicesGraph;
-
-            static ServiceInfo* CreateClassEntry(ClassType classType, ServicesGraph& table)
+            ServiceInfo* CreateClassEntry(ClassType classType, ServicesGraph& table)
             {
                 ServiceInfo* info = nullptr;
                 if (table.find(classType, info))
@@ -155,11 +164,55 @@ namespace base
                         info->m_dependsOnInit.pushBack(CreateClassEntry(refClassType, table));
                 }
 
-                // TODO: extract other types of dependencies
+                // threading requirements
+                if (auto threading = classType->findMetadata<ServiceThreadingMetadata>())
+                {
+                    info->m_mainThreadInit = threading->isMainThreadInit();
+                    info->m_parallelUpdate = threading->isParallelUpdate();
+                }
 
                 return info;
             }
 
+            void LinkTickDependencies(ServicesGraph& graph)
+            {
+                // NOTE: ticking dependencies do not pull services into the graph, we only order the ones we have
+                for (auto service : graph.values())
+                {
+                    if (auto classList = service->m_class->findMetadata<TickBeforeMetadata>())
+                    {
+                        for (auto refClassType : classList->classes())
+                        {
+                            ServiceInfo* refService = nullptr;
+                            if (graph.find(refClassType, refService))
+                                service->m_tickBefore.pushBackUnique(refService);
+                        }
+                    }
+
+                    if (auto classList = service->m_class->findMetadata<TickAfterMetadata>())
+                    {
+                        for (auto refClassType : classList->classes())
+                        {
+                            ServiceInfo* refService = nullptr;
+                            if (graph.find(refClassType, refService))
+                                service->m_tickAfter.pushBackUnique(refService);
+                        }
+                    }
+                }
+            }
+
+            static void AddImplicitDependencies(ServicesGraph& graph)
+            {
+                // all services read their settings from the config, it must be loaded before any of them initializes
+                ServiceInfo* configService = nullptr;
+                if (graph.find(config::ConfigService::GetStaticClass(), configService))
+                {
+                    for (auto service : graph.values())
+                        if (service != configService)
+                            service->m_dependsOnInit.pushBackUnique(configService);
+                }
+            }
+
             void ExtractServiceClasses(ServicesGraph& outClasses)
             {
                 // enumerate service classes
@@ -174,8 +227,6 @@ namespace base
                     CreateClassEntry(serviceClass, outClasses);
             }
 
-            typedef Array<ServiceInfo*> ServiceOrderTable;
-
             bool TopologicalSort(const ServicesGraph& graph, ServiceOrderTable& outOrder)
             {
                 // reset depth
@@ -292,6 +343,88 @@ namespace base
                 return true;
             }
 
+            //--
+
+            bool GenerateTickingGroups(const ServiceOrderTable& tickOrder, Array<uint32_t>& outGroupIndices)
+            {
+                // NOTE: the adjacency still contains the ticking dependencies (services that must tick before given service)
+                HashMap<const ServiceInfo*, uint32_t> groupIndices;
+                bool hasParallelServices = false;
+                for (auto service : tickOrder)
+                {
+                    uint32_t groupIndex = 0;
+                    for (auto dep : service->m_adj)
+                        if (const auto* depGroupIndex = groupIndices.find(dep))
+                            groupIndex = std::max<uint32_t>(groupIndex, *depGroupIndex + 1);
+
+                    groupIndices[service] = groupIndex;
+                    outGroupIndices.pushBack(groupIndex);
+
+                    if (service->m_service && service->m_parallelUpdate)
+                        hasParallelServices = true;
+                }
+
+                return hasParallelServices;
+            }
+
+            bool BuildTickGroups(const ServiceOrderTable& tickOrder, LocalServiceContainer::TTickGroups& outGroups)
+            {
+                outGroups.reset();
+
+                Array<uint32_t> tickGroupIndices;
+                if (!GenerateTickingGroups(tickOrder, tickGroupIndices))
+                    return false;
+
+                for (uint32_t i = 0; i < tickOrder.size(); ++i)
+                {
+                    const auto* entry = tickOrder[i];
+                    if (!entry->m_service)
+                        continue;
+
+                    const auto groupIndex = tickGroupIndices[i];
+                    if (groupIndex >= outGroups.size())
+                        outGroups.resize(groupIndex + 1);
+
+                    auto& group = outGroups[groupIndex];
+                    if (entry->m_parallelUpdate)
+                        group.parallelServices.pushBack(entry->m_service.get());
+                    else
+                        group.serialServices.pushBack(entry->m_service.get());
+                }
+
+                return true;
+            }
+
+            void UpdateServiceGroup(const Array<ILocalService*>& serialServices, const Array<ILocalService*>& parallelServices)
+            {
+                const auto numParallelServices = parallelServices.size();
+
+                fibers::WaitCounter parallelUpdateDone;
+                if (numParallelServices)
+                {
+                    const auto* parallelServicesPtr = &parallelServices;
+                    parallelUpdateDone = Fibers::GetInstance().createCounter("ServiceUpdate", numParallelServices);
+                    RunChildFiber("ServiceUpdate").invocations(numParallelServices) << [parallelServicesPtr, parallelUpdateDone](FIBER_FUNC)
+                    {
+                        (*parallelServicesPtr)[index]->onSyncUpdate();
+                        Fibers::GetInstance().signalCounter(parallelUpdateDone);
+                    };
+                }
+
+                for (auto service : serialServices)
+                    service->onSyncUpdate();
+
+                if (numParallelServices)
+                    Fibers::GetInstance().waitForCounterAndRelease(parallelUpdateDone);
+            }
+
+            void UpdateTickGroups(const LocalServiceContainer::TTickGroups& groups)
+            {
+                // groups are updated in order, services in a group don't depend on each other
+                for (const auto& group : groups)
+                    UpdateServiceGroup(group.serialServices, group.parallelServices);
+            }
+
         } // helper
 
         bool LocalServiceContainer::init(const CommandLine& commandline)
@@ -320,6 +453,9 @@ namespace base
                 helper::ExtractServiceClasses(serviceGraph);
             }
 
+            helper::LinkTickDependencies(serviceGraph);
+            helper::AddImplicitDependencies(serviceGraph);
+
             // generate initialization order
             {
                 helper::ServiceOrderTable initOrder;
@@ -337,44 +473,62 @@ namespace base
                     return true;
                 }
 
-                // initialize the services
+                // reserve the service slots up front, services are looked up (without locking) while other services are being initialized
                 for (auto& info : initOrder)
-                {
-                    TRACE_SPAM("Initializing service '{}'", info->m_class->name());
+                    reserveServiceSlots(info->m_class);
 
-                    ScopeTimer initTime;
-
-                    // create service
-                    auto servicePtr = info->m_class.create<ILocalService>();
-                    ASSERT(servicePtr);
-                    attachService(servicePtr);
-
-                    // initialize
-                    auto ret = servicePtr->onInitializeService(commandline);
-                    if (ret == ServiceInitializationResult::Finished)
-                    {
-                        TRACE_INFO("Service '{}' initialized in {}", info->m_class->name(), TimeInterval(initTime.timeElapsed()));
-                        info->m_service = servicePtr;
-                    }
-                    else if (ret == ServiceInitializationResult::Silenced)
-                    {
-                        servicePtr->onShutdownService();
-                        TRACE_INFO("Service '{}' failed to initialize and will be disabled", info->m_class->name());
-                    }
-                    else if (ret == ServiceInitializationResult::FatalError)
+                // initialize the services, NOTE: -serialServiceInit initializes everything on the main thread (still in dependency order), useful for debugging
+                const auto allowParallelInit = !commandline.hasParam("serialServiceInit");
+                helper::ServiceInitScheduler initScheduler(initOrder, allowParallelInit, [this, &commandline](helper::ServiceInfo* info)
                     {
-                        servicePtr->onShutdownService();
-                        TRACE_ERROR("Service '{}' failed to initialize", info->m_class->name());
-                        return false;
-                    }
+                        TRACE_SPAM("Initializing service '{}'", info->m_class->name());
+
+                        ScopeTimer initTime;
+
+                        // create service
+                        auto servicePtr = info->m_class.create<ILocalService>();
+                        ASSERT(servicePtr);
+                        attachService(servicePtr);
+
+                        // initialize
+                        auto ret = servicePtr->onInitializeService(commandline);
+                        if (ret == ServiceInitializationResult::Finished)
+                        {
+                            TRACE_INFO("Service '{}' initialized in {}", info->m_class->name(), TimeInterval(initTime.timeElapsed()));
+                            info->m_service = servicePtr;
+                        }
+                        else if (ret == ServiceInitializationResult::Silenced)
+                        {
+                            servicePtr->onShutdownService();
+                            TRACE_INFO("Service '{}' failed to initialize and will be disabled", info->m_class->name());
+                        }
+                        else if (ret == ServiceInitializationResult::FatalError)
+                        {
+                            servicePtr->onShutdownService();
+                            TRACE_ERROR("Service '{}' failed to initialize", info->m_class->name());
+                        }
+
+                        return ret;
+                    });
+
+                if (!initScheduler.run())
+                {
+                    initOrder.clearPtr();
+                    return false;
                 }
 
+                initScheduler.printCriticalPath();
+
                 // assemble the final tick list
                 m_tickList.reserve(tickOrder.size());
                 for (auto& entry : tickOrder)
                     if (entry->m_service)
                         m_tickList.pushBack(entry->m_service.get());
 
+                // assemble the groups of services that can tick in parallel
+                if (helper::BuildTickGroups(tickOrder, m_tickGroups))
+                    TRACE_INFO("Services will be updated in {} groups", m_tickGroups.size());
+
                 // cleanup lists
                 //tickOrder.clearPtr();
                 initOrder.clearPtr();
@@ -0,0 +1,303 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "localService.h"
+#include "localServiceScheduler.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/system/include/thread.h"
+#include "base/system/include/scopeLock.h"
+
+DECLARE_TEST_FILE(LocalServiceContainer);
+
+using namespace base;
+
+namespace tests
+{
+    // NOTE: the test service classes are abstract so they are never picked up as real services, they only carry the metadata
+
+    class ServiceTestRoot : public app::ILocalService
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(ServiceTestRoot, app::ILocalService);
+    };
+
+    RTTI_BEGIN_TYPE_ABSTRACT_CLASS(ServiceTestRoot);
+    RTTI_END_TYPE();
+
+    class ServiceTestWorker : public app::ILocalService
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(ServiceTestWorker, app::ILocalService);
+    };
+
+    RTTI_BEGIN_TYPE_ABSTRACT_CLASS(ServiceTestWorker);
+        RTTI_METADATA(app::DependsOnServiceMetadata).dependsOn<ServiceTestRoot>();
+        RTTI_METADATA(app::TickBeforeMetadata).tickBefore<ServiceTestRoot>();
+        RTTI_METADATA(app::ServiceThreadingMetadata).parallelUpdate();
+    RTTI_END_TYPE();
+
+    class ServiceTestMainThread : public app::ILocalService
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(ServiceTestMainThread, app::ILocalService);
+    };
+
+    RTTI_BEGIN_TYPE_ABSTRACT_CLASS(ServiceTestMainThread);
+        RTTI_METADATA(app::DependsOnServiceMetadata).dependsOn<ServiceTestRoot>();
+        RTTI_METADATA(app::ServiceThreadingMetadata).mainThreadInit().parallelUpdate();
+    RTTI_END_TYPE();
+
+    class ServiceTestLeaf : public app::ILocalService
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(ServiceTestLeaf, app::ILocalService);
+    };
+
+    RTTI_BEGIN_TYPE_ABSTRACT_CLASS(ServiceTestLeaf);
+        RTTI_METADATA(app::DependsOnServiceMetadata).dependsOn<ServiceTestWorker>().dependsOn<ServiceTestMainThread>();
+        RTTI_METADATA(app::TickBeforeMetadata).tickBefore<ServiceTestWorker>();
+    RTTI_END_TYPE();
+
+    //--
+
+    /// what happened to which service and on what thread
+    class ServiceEventRecorder : public NoCopy
+    {
+    public:
+        struct Event
+        {
+            StringBuf name;
+            ThreadID thread = 0;
+        };
+
+        void record(StringView<char> name)
+        {
+            auto lock = CreateLock(m_lock);
+            auto& entry = m_events.emplaceBack();
+            entry.name = StringBuf(name);
+            entry.thread = GetCurrentThreadID();
+        }
+
+        int index(const char* name) const
+        {
+            auto lock = CreateLock(m_lock);
+            for (uint32_t i = 0; i < m_events.size(); ++i)
+                if (m_events[i].name == StringView<char>(name))
+                    return i;
+            return -1;
+        }
+
+        ThreadID thread(const char* name) const
+        {
+            const auto i = index(name);
+
+            auto lock = CreateLock(m_lock);
+            return (i != -1) ? m_events[i].thread : 0;
+        }
+
+        uint32_t size() const
+        {
+            auto lock = CreateLock(m_lock);
+            return m_events.size();
+        }
+
+    private:
+        mutable SpinLock m_lock;
+        Array<Event> m_events;
+    };
+
+    /// service instance that records its updates
+    /// NOTE: not registered in RTTI so it's never created as a real service
+    class RecordingService : public app::ILocalService
+    {
+    public:
+        RecordingService(ServiceEventRecorder& recorder, ClassType serviceClass)
+            : m_recorder(recorder)
+            , m_name(serviceClass->name().c_str())
+        {}
+
+        virtual app::ServiceInitializationResult onInitializeService(const app::CommandLine& cmdLine) override
+        {
+            return app::ServiceInitializationResult::Finished;
+        }
+
+        virtual void onShutdownService() override
+        {
+        }
+
+        virtual void onSyncUpdate() override
+        {
+            // give the services that are not ordered with us a chance to run at the same time
+            Sleep(1);
+            m_recorder.record(m_name);
+        }
+
+    private:
+        ServiceEventRecorder& m_recorder;
+        StringBuf m_name;
+    };
+
+    static const char* Name(ClassType serviceClass)
+    {
+        return serviceClass->name().c_str();
+    }
+
+    static void ReleaseGraph(app::helper::ServicesGraph& graph)
+    {
+        for (auto* info : graph.values())
+            MemDelete(info);
+        graph.clear();
+    }
+
+    static void BuildGraph(app::helper::ServicesGraph& graph)
+    {
+        // dependencies are pulled in by the leaf service
+        app::helper::CreateClassEntry(ServiceTestLeaf::GetStaticClass(), graph);
+        app::helper::LinkTickDependencies(graph);
+    }
+
+    static bool InitServices(app::helper::ServicesGraph& graph, bool allowParallel, ServiceEventRecorder& recorder, ClassType failingService = nullptr)
+    {
+        app::helper::ServiceOrderTable order;
+        if (!app::helper::GenerateInitializationOrder(graph, order))
+            return false;
+
+        app::helper::ServiceInitScheduler scheduler(order, allowParallel, [&recorder, failingService](app::helper::ServiceInfo* info)
+            {
+                // all the dependencies must have finished initializing
+                for (auto* dep : info->m_dependsOnInit)
+                    EXPECT_NE(-1, recorder.index(Name(dep->m_class))) << Name(info->m_class) << " initialized before " << Name(dep->m_class);
+
+                Sleep(1);
+                recorder.record(Name(info->m_class));
+
+                if (info->m_class == failingService)
+                    return app::ServiceInitializationResult::FatalError;
+                return app::ServiceInitializationResult::Finished;
+            });
+
+        return scheduler.run();
+    }
+
+} // tests
+
+TEST(LocalServiceContainer, DependenciesArePulledIntoGraph)
+{
+    app::helper::ServicesGraph graph;
+    tests::BuildGraph(graph);
+
+    EXPECT_EQ(4, graph.size());
+
+    app::helper::ServiceInfo* info = nullptr;
+    ASSERT_TRUE(graph.find(tests::ServiceTestMainThread::GetStaticClass(), info));
+    EXPECT_TRUE(info->m_mainThreadInit);
+    EXPECT_TRUE(info->m_parallelUpdate);
+
+    ASSERT_TRUE(graph.find(tests::ServiceTestRoot::GetStaticClass(), info));
+    EXPECT_FALSE(info->m_mainThreadInit);
+    EXPECT_FALSE(info->m_parallelUpdate);
+
+    tests::ReleaseGraph(graph);
+}
+
+TEST(LocalServiceContainer, InitRespectsDependencies)
+{
+    app::helper::ServicesGraph graph;
+    tests::BuildGraph(graph);
+
+    tests::ServiceEventRecorder recorder;
+    EXPECT_TRUE(tests::InitServices(graph, true, recorder));
+    ASSERT_EQ(4, recorder.size());
+
+    const auto root = recorder.index(tests::Name(tests::ServiceTestRoot::GetStaticClass()));
+    const auto worker = recorder.index(tests::Name(tests::ServiceTestWorker::GetStaticClass()));
+    const auto mainThread = recorder.index(tests::Name(tests::ServiceTestMainThread::GetStaticClass()));
+    const auto leaf = recorder.index(tests::Name(tests::ServiceTestLeaf::GetStaticClass()));
+    EXPECT_EQ(0, root);
+    EXPECT_LT(root, worker);
+    EXPECT_LT(root, mainThread);
+    EXPECT_EQ(3, leaf);
+
+    // service that requires the main thread is initialized on the thread that runs the initialization
+    EXPECT_EQ(GetCurrentThreadID(), recorder.thread(tests::Name(tests::ServiceTestMainThread::GetStaticClass())));
+
+    tests::ReleaseGraph(graph);
+}
+
+TEST(LocalServiceContainer, SerialInitRunsOnCallingThread)
+{
+    app::helper::ServicesGraph graph;
+    tests::BuildGraph(graph);
+
+    tests::ServiceEventRecorder recorder;
+    EXPECT_TRUE(tests::InitServices(graph, false, recorder));
+    ASSERT_EQ(4, recorder.size());
+
+    for (auto* info : graph.values())
+        EXPECT_EQ(GetCurrentThreadID(), recorder.thread(tests::Name(info->m_class))) << tests::Name(info->m_class);
+
+    tests::ReleaseGraph(graph);
+}
+
+TEST(LocalServiceContainer, FatalErrorStopsDependentServices)
+{
+    app::helper::ServicesGraph graph;
+    tests::BuildGraph(graph);
+
+    tests::ServiceEventRecorder recorder;
+    EXPECT_FALSE(tests::InitServices(graph, true, recorder, tests::ServiceTestWorker::GetStaticClass()));
+
+    EXPECT_NE(-1, recorder.index(tests::Name(tests::ServiceTestWorker::GetStaticClass())));
+    EXPECT_EQ(-1, recorder.index(tests::Name(tests::ServiceTestLeaf::GetStaticClass())));
+
+    tests::ReleaseGraph(graph);
+}
+
+TEST(LocalServiceContainer, UpdateGroupsRespectTickOrder)
+{
+    app::helper::ServicesGraph graph;
+    tests::BuildGraph(graph);
+
+    tests::ServiceEventRecorder recorder;
+    for (auto* info : graph.values())
+        info->m_service = CreateSharedPtr<tests::RecordingService>(recorder, info->m_class);
+
+    app::helper::ServiceOrderTable tickOrder;
+    ASSERT_TRUE(app::helper::GenerateTickingOrder(graph, tickOrder));
+
+    // the groups are built and updated the same way the container does it
+    app::LocalServiceContainer::TTickGroups groups;
+    ASSERT_TRUE(app::helper::BuildTickGroups(tickOrder, groups));
+
+    // root -> worker -> leaf must tick in order, the main thread service is not ordered with anything
+    ASSERT_EQ(3, groups.size());
+    EXPECT_EQ(1, groups[0].serialServices.size()); // root
+    EXPECT_EQ(1, groups[0].parallelServices.size()); // main thread
+    EXPECT_EQ(0, groups[1].serialServices.size());
+    EXPECT_EQ(1, groups[1].parallelServices.size()); // worker
+    EXPECT_EQ(1, groups[2].serialServices.size()); // leaf
+    EXPECT_EQ(0, groups[2].parallelServices.size());
+
+    app::helper::UpdateTickGroups(groups);
+
+    // every service updated once, all of the parallel updates are finished when the group is done
+    ASSERT_EQ(4, recorder.size());
+    const auto root = recorder.index(tests::Name(tests::ServiceTestRoot::GetStaticClass()));
+    const auto worker = recorder.index(tests::Name(tests::ServiceTestWorker::GetStaticClass()));
+    const auto mainThread = recorder.index(tests::Name(tests::ServiceTestMainThread::GetStaticClass()));
+    const auto leaf = recorder.index(tests::Name(tests::ServiceTestLeaf::GetStaticClass()));
+    EXPECT_LT(root, worker);
+    EXPECT_LT(mainThread, worker);
+    EXPECT_LT(worker, leaf);
+
+    // services that don't allow parallel update are updated on the calling thread
+    EXPECT_EQ(GetCurrentThreadID(), recorder.thread(tests::Name(tests::ServiceTestRoot::GetStaticClass())));
+    EXPECT_EQ(GetCurrentThreadID(), recorder.thread(tests::Name(tests::ServiceTestLeaf::GetStaticClass())));
+
+    for (auto* info : graph.values())
+        info->m_service.reset();
+    tests::ReleaseGraph(graph);
+}
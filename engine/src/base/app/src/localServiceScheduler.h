@@ -0,0 +1,245 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: services #]
+***/
+
+#pragma once
+
+#include "localService.h"
+#include "localServiceContainer.h"
+
+#include "base/containers/include/hashMap.h"
+#include "base/containers/include/queue.h"
+#include "base/fibers/include/fiberSystem.h"
+#include "base/system/include/semaphoreCounter.h"
+#include "base/system/include/timedScope.h"
+
+// NOTE: internal to the LocalServiceContainer, exposed only for the tests
+
+namespace base
+{
+    namespace app
+    {
+        namespace helper
+        {
+            struct ServiceInfo
+            {
+                ClassType m_class;
+                Array<ServiceInfo*> m_dependsOnInit;
+                Array<ServiceInfo*> m_tickBefore;
+                Array<ServiceInfo*> m_tickAfter;
+
+                Array<ServiceInfo*> m_adj; // temp
+                
+                RefPtr<ILocalService> m_service;
+
+                int m_depth;
+
+                bool m_mainThreadInit = false;
+                bool m_parallelUpdate = false;
+
+                // initialization state
+                Array<ServiceInfo*> m_dependents; // services that wait for us to initialize
+                uint32_t m_numPendingDependencies = 0;
+                ServiceInfo* m_criticalDependency = nullptr; // dependency that finished last, we could not start before it
+                double m_initStart = 0.0;
+                double m_initEnd = 0.0;
+
+                INLINE ServiceInfo()
+                    : m_class(nullptr)
+                    , m_depth(0)
+                {}
+            };
+
+            typedef HashMap<ClassType, ServiceInfo*> ServicesGraph;
+
+            typedef Array<ServiceInfo*> ServiceOrderTable;
+
+            /// get (or create) the graph entry for the service class, the services it depends on are added to the graph as well
+            extern ServiceInfo* CreateClassEntry(ClassType classType, ServicesGraph& table);
+
+            /// link the tick before/after requirements of the services in the graph, services that are not in the graph are ignored
+            extern void LinkTickDependencies(ServicesGraph& graph);
+
+            /// order the services so the ones they depend on are initialized first, returns false if there are cycles
+            extern bool GenerateInitializationOrder(const ServicesGraph& graph, ServiceOrderTable& outTable);
+
+            /// order the services according to their tick before/after requirements, returns false if there are cycles
+            /// NOTE: the adjacency of the services is left with the ticking dependencies
+            extern bool GenerateTickingOrder(const ServicesGraph& graph, ServiceOrderTable& outTable);
+
+            /// group the services so the ones that don't have to tick in order can tick in parallel, returns false if there's nothing to tick in parallel
+            /// NOTE: must be called right after GenerateTickingOrder
+            extern bool GenerateTickingGroups(const ServiceOrderTable& tickOrder, Array<uint32_t>& outGroupIndices);
+
+            /// group the services with a service instance so the ones that don't have to tick in order are updated together, returns false if there's nothing to tick in parallel
+            /// NOTE: must be called right after GenerateTickingOrder
+            extern bool BuildTickGroups(const ServiceOrderTable& tickOrder, LocalServiceContainer::TTickGroups& outGroups);
+
+            /// update one group of services, the parallel ones are updated on fiber workers while the serial ones are updated (in order) on the calling thread
+            extern void UpdateServiceGroup(const Array<ILocalService*>& serialServices, const Array<ILocalService*>& parallelServices);
+
+            /// update all groups of services, one after another
+            extern void UpdateTickGroups(const LocalServiceContainer::TTickGroups& groups);
+
+            //--
+
+            /// runs the initialization of the services, each service starts as soon as all services it depends on are initialized
+            /// services are initialized on fiber workers unless they require the main thread, the main thread waits for them (and runs the main thread ones)
+            class ServiceInitScheduler : public NoCopy
+            {
+            public:
+                typedef std::function<ServiceInitializationResult(ServiceInfo* info)> TInitFunc;
+
+                ServiceInitScheduler(const ServiceOrderTable& order, bool allowParallel, const TInitFunc& initFunc)
+                    : m_order(order)
+                    , m_initFunc(initFunc)
+                    , m_allowParallel(allowParallel)
+                    , m_wakeUp(0, INT_MAX)
+                {
+                    for (auto service : order)
+                    {
+                        service->m_numPendingDependencies = service->m_dependsOnInit.size();
+                        for (auto dep : service->m_dependsOnInit)
+                            dep->m_dependents.pushBack(service);
+                    }
+                }
+
+                /// initialize all services, returns false if any of them failed fatally
+                bool run()
+                {
+                    {
+                        auto lock = CreateLock(m_lock);
+                        for (auto service : m_order)
+                            if (service->m_numPendingDependencies == 0)
+                                dispatch_NoLock(service);
+                    }
+
+                    for (;;)
+                    {
+                        ServiceInfo* mainThreadService = nullptr;
+                        {
+                            auto lock = CreateLock(m_lock);
+                            if (!m_mainThreadQueue.empty())
+                            {
+                                mainThreadService = m_mainThreadQueue.top();
+                                m_mainThreadQueue.pop();
+                            }
+                            else if (m_numInFlight == 0)
+                            {
+                                break;
+                            }
+                        }
+
+                        if (mainThreadService)
+                            runService(mainThreadService);
+                        else
+                            m_wakeUp.wait();
+                    }
+
+                    // NOTE: after a fatal error the services that depend on the failed one are never started
+                    return !m_fatalError && (m_numFinished == m_order.size());
+                }
+
+                /// print the chain of services that determined the total initialization time
+                void printCriticalPath() const
+                {
+                    double totalInitTime = 0.0;
+                    const ServiceInfo* lastService = nullptr;
+                    for (auto service : m_order)
+                    {
+                        totalInitTime += service->m_initEnd - service->m_initStart;
+                        if (!lastService || service->m_initEnd > lastService->m_initEnd)
+                            lastService = service;
+                    }
+
+                    InplaceArray<const ServiceInfo*, 32> criticalPath;
+                    for (auto service = lastService; service; service = service->m_criticalDependency)
+                        criticalPath.pushBack(service);
+
+                    TRACE_INFO("Service initialization took {} in total ({} when initialized one by one), critical path:", 
+                        TimeInterval(lastService ? lastService->m_initEnd : 0.0), TimeInterval(totalInitTime));
+
+                    for (int i = (int)criticalPath.size() - 1; i >= 0; --i)
+                    {
+                        const auto* service = criticalPath[i];
+                        TRACE_INFO("  '{}': started at {}, initialized in {}{}", service->m_class->name(), 
+                            TimeInterval(service->m_initStart), TimeInterval(service->m_initEnd - service->m_initStart), service->m_mainThreadInit ? " (main thread)" : "");
+                    }
+                }
+
+            private:
+                const ServiceOrderTable& m_order;
+                TInitFunc m_initFunc;
+                bool m_allowParallel = true;
+
+                ScopeTimer m_timer;
+
+                SpinLock m_lock;
+                Queue<ServiceInfo*> m_mainThreadQueue;
+                uint32_t m_numInFlight = 0; // dispatched but not yet finished
+                uint32_t m_numFinished = 0;
+                bool m_fatalError = false;
+
+                Semaphore m_wakeUp; // main thread waits on it for services to finish or for main thread work
+
+                void dispatch_NoLock(ServiceInfo* service)
+                {
+                    // remember what we were waiting for
+                    for (auto dep : service->m_dependsOnInit)
+                        if (!service->m_criticalDependency || dep->m_initEnd > service->m_criticalDependency->m_initEnd)
+                            service->m_criticalDependency = dep;
+
+                    m_numInFlight += 1;
+
+                    if (service->m_mainThreadInit || !m_allowParallel)
+                    {
+                        m_mainThreadQueue.push(service);
+                        m_wakeUp.release(1);
+                    }
+                    else
+                    {
+                        RunFiber("InitService") << [this, service](FIBER_FUNC)
+                        {
+                            runService(service);
+                        };
+                    }
+                }
+
+                void runService(ServiceInfo* service)
+                {
+                    service->m_initStart = m_timer.timeElapsed();
+                    const auto ret = m_initFunc(service);
+
+                    {
+                        auto lock = CreateLock(m_lock);
+                        service->m_initEnd = m_timer.timeElapsed();
+                        m_numInFlight -= 1;
+                        m_numFinished += 1;
+
+                        if (ret == ServiceInitializationResult::FatalError)
+                            m_fatalError = true;
+
+                        // start the services that were waiting for us, NOTE: service that got silenced still counts as initialized
+                        if (!m_fatalError)
+                        {
+                            for (auto dependent : service->m_dependents)
+                                if (0 == --dependent->m_numPendingDependencies)
+                                    dispatch_NoLock(dependent);
+                        }
+
+                        // NOTE: wake up the main thread while still holding the lock, once the lock is released the main thread may see nothing in flight
+                        // and leave run() - the scheduler lives on its stack so we can't touch it after that
+                        m_wakeUp.release(1);
+                    }
+                }
+            };
+
+            //--
+
+        } // helper
+    } // app
+} // base
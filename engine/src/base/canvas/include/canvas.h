@@ -13,6 +13,7 @@
 #include "base/containers/include/inplaceArray.h"
 #include "base/containers/include/pagedBuffer.h"
 #include "base/memory/include/linearAllocator.h"
+#include "base/system/include/spinLock.h"
 
 namespace base
 {
@@ -25,6 +26,12 @@ namespace base
         {
         public:
             Canvas(uint32_t width, uint32_t height, GlyphCache* glyphCache = nullptr /* uses the shared cache*/, float pixelOffsetX =0.0f, float pixelOffsetY=0.0f, float pixelScale=1.0f);
+
+            // create a segment canvas that can be used to record part of the content of the owner canvas on a different thread
+            // segment has the same size and pixel placement as the owner and starts with owner's current scissor rect and alpha
+            // NOTE: when done the segment must be merged back into owner with append(), custom payloads are allocated directly in the owner
+            explicit Canvas(Canvas* segmentOwner);
+
             ~Canvas();
 
             // get width of the currently bound target to the geometry collector
@@ -49,6 +56,9 @@ namespace base
             // get mask of all used glyph cache pages
             INLINE uint64_t glyphCachePageMask() const { return m_glyphCachePageMask; }
 
+            // get the canvas this segment is recording for, NULL for normal canvas
+            INLINE Canvas* segmentOwner() const { return m_segmentOwner; }
+
 #pragma pack(push)
 #pragma pack(1)
             struct Vertex
@@ -280,6 +290,10 @@ namespace base
             /// place raw geometry data in canvas, paint it whole specific render style
             void place(const RenderStyle& style, const RawGeometry& geometry, uint16_t customDrawer = 0, const void* customPayload = nullptr, CompositeOperation op = CompositeOperation::SourceOver, float alpha = 1.0f);
 
+            /// append content of other canvas (usually a segment recorded on other thread) after everything that is already in this canvas
+            /// NOTE: vertices, indices, params and batches are rebased, batches are kept contiguous so the renderer can merge them with existing ones
+            void append(const Canvas& other);
+
             //----
 
             // render quad for custom style
@@ -330,6 +344,8 @@ namespace base
             uint32_t m_numBatchedCulled = 0;
             uint32_t m_numGeometriesCulled = 0;
 
+            Canvas* m_segmentOwner = nullptr;
+
             Array<int> m_styleMapping;
 
             uint64_t m_glyphCachePageMask;
@@ -356,6 +372,7 @@ namespace base
             PagedBuffer<ImageRef> m_images;
 
             mem::LinearAllocator m_customPayloadData;
+            SpinLock m_customPayloadLock; // segments recorded on other threads allocate payloads here
 
             HashMap<RenderStyleWithAlpha, uint32_t> m_paramsMap;
 
@@ -79,6 +79,15 @@ namespace base
             updateScissorRect();
         }
 
+        Canvas::Canvas(Canvas* segmentOwner)
+            : Canvas(segmentOwner->m_width, segmentOwner->m_height, nullptr, segmentOwner->m_pixelOffset.x, segmentOwner->m_pixelOffset.y, segmentOwner->m_pixelScale)
+        {
+            m_segmentOwner = segmentOwner;
+            m_alpha = segmentOwner->m_alpha;
+            m_scissorRect = segmentOwner->m_scissorRect;
+            updateScissorRect();
+        }
+
         Canvas::~Canvas()
         {
             releaseImageReferences();
@@ -345,6 +354,55 @@ namespace base
             updateScissorRect();
         }
 
+        void Canvas::append(const Canvas& other)
+        {
+            DEBUG_CHECK_EX(&other != this, "Cannot append canvas to itself");
+            DEBUG_CHECK_EX(!other.m_segmentOwner || other.m_segmentOwner == this, "Segment can only be appended to its owner");
+
+            const auto baseParamsIndex = (uint32_t)m_params.size();
+            const auto baseVertexIndex = (uint32_t)m_vertices.size();
+            const auto baseIndex = (uint32_t)m_indices.size();
+
+            // params, image references must point to our own image list
+            other.m_params.forEach([this](const Params& srcParams)
+                {
+                    auto* params = m_params.allocSingle();
+                    *params = srcParams;
+
+                    if (srcParams.imageRef)
+                        params->imageRef = packImageRef(srcParams.imageRef->imagePtr, srcParams.imageRef->imageNeedsWrapping);
+                });
+
+            // vertices, only the params index must be moved
+            {
+                const auto paramsOffset = (float)baseParamsIndex;
+                other.m_vertices.forEach([this, paramsOffset](const Vertex& srcVertex)
+                    {
+                        auto* v = m_vertices.allocSingle();
+                        *v = srcVertex;
+                        v->paramsId += paramsOffset;
+                    });
+            }
+
+            // indices
+            other.m_indices.forEach([this, baseVertexIndex](const uint32_t& srcIndex)
+                {
+                    *m_indices.allocSingle() = srcIndex + baseVertexIndex;
+                });
+
+            // batches
+            other.m_batches.forEach([this, baseIndex](const Batch& srcBatch)
+                {
+                    auto* batch = m_batches.allocSingle();
+                    *batch = srcBatch;
+                    batch->fristIndex += baseIndex;
+                });
+
+            m_glyphCachePageMask |= other.m_glyphCachePageMask;
+            m_numGeometriesCulled += other.m_numGeometriesCulled;
+            m_numBatchedCulled += other.m_numBatchedCulled;
+        }
+
         //---
 
         void Canvas::transformBounds(const Vector2& localMin, const Vector2& localMax, Vector2& globalMin, Vector2& globalMax) const
@@ -488,7 +546,16 @@ namespace base
 
         void* Canvas::uploadCustomPayloadData(const void* data, uint32_t size)
         {
-            void* ret = m_customPayloadData.alloc(size, 16);
+            // segments store the payloads in the owner so they live as long as the final merged content
+            if (m_segmentOwner)
+                return m_segmentOwner->uploadCustomPayloadData(data, size);
+
+            void* ret = nullptr;
+            {
+                auto lock = CreateLock(m_customPayloadLock);
+                ret = m_customPayloadData.alloc(size, 16);
+            }
+
             if (data)
                 memcpy(ret, data, size);
             return ret;
@@ -1067,7 +1134,7 @@ namespace base
 
         void Canvas::renderGlyphs(const RenderGroup& group)
         {
-            static LocalGlyphCache localCache;
+            static thread_local LocalGlyphCache localCache; // segments may be recorded on many threads at once
 
             // pack the glyphs into glyphs cache, group the glyphs by the glyphs page needed
             base::Color color = base::Color::WHITE;
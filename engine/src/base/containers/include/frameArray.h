@@ -0,0 +1,40 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: containers\dynamic #]
+***/
+
+#pragma once
+
+#include "array.h"
+#include "arrayIterator.h"
+#include "base/memory/include/frameArena.h"
+
+namespace base
+{
+
+    //---
+
+    /// array with the initial buffer allocated from the frame arena, usually used for per-frame temporaries
+    /// if the array grows above the initial capacity it moves to the normal heap memory, just like the InplaceArray
+    /// NOTE: the array must not be used after the frame it was created in expires (see FrameArena::numFrames)
+    template < class T >
+    class FrameArray : public Array<T>
+    {
+    public:
+        FrameArray(uint32_t capacity, mem::FrameArena& arena = mem::FrameArena::GetDefaultArena());
+        FrameArray(const T* ptr, uint32_t size, mem::FrameArena& arena = mem::FrameArena::GetDefaultArena()); // makes a copy of the data
+        FrameArray(const FrameArray<T>& other) = delete;
+
+        FrameArray& operator=(const Array<T>& other);
+        FrameArray& operator=(Array<T>&& other);
+        FrameArray& operator=(const FrameArray<T>& other) = delete;
+    };
+
+    //---
+
+} // base
+
+#include "frameArray.inl"
@@ -0,0 +1,43 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: containers\dynamic #]
+***/
+
+#pragma once
+
+namespace base
+{
+
+    template < class T >
+    INLINE FrameArray<T>::FrameArray(uint32_t capacity, mem::FrameArena& arena)
+        : Array<T>(arena.allocArray<T>(capacity), capacity, InplaceArrayData)
+    {}
+
+	template < class T >
+	INLINE FrameArray<T>::FrameArray(const T* ptr, uint32_t size, mem::FrameArena& arena)
+		: Array<T>(arena.allocArray<T>(size), size, InplaceArrayData)
+	{
+		auto data  = this->allocateUninitialized(size);
+		std::uninitialized_copy_n(ptr, size, data);
+	}
+
+	//--
+
+	template < class T >
+	INLINE FrameArray<T>& FrameArray<T>::operator=(const Array<T>& other)
+	{
+		Array<T>::operator=(other);
+		return *this;
+	}
+
+	template < class T >
+	INLINE FrameArray<T>& FrameArray<T>::operator=(Array<T>&& other)
+	{
+		Array<T>::operator=(other);
+		return *this;
+	}
+
+} // base
@@ -42,6 +42,9 @@ namespace base
         // get top element of the queue (the one that will be popped next)
         INLINE const T& top() const;
 
+        // get element at given position from the top of the queue (0 is the top)
+        INLINE const T& peek(uint32_t index) const;
+
         // pop top
         INLINE void pop();
 
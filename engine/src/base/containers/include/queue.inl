@@ -112,6 +112,13 @@ namespace base
         return m_elements[m_tail];
     }
 
+    template<class T, typename Container>
+    INLINE const T& Queue<T, Container>::peek(uint32_t index) const
+    {
+        DEBUG_CHECK(index < size());
+        return m_elements[(m_tail + index) % m_elements.size()];
+    }
+
     template<class T, typename Container>
     INLINE void Queue<T, Container>::pop()
     {
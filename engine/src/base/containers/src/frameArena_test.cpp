@@ -0,0 +1,231 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/memory/include/frameArena.h"
+#include "base/memory/include/poolStats.h"
+#include "base/containers/include/frameArray.h"
+#include "base/system/include/thread.h"
+
+#include <vector>
+
+DECLARE_TEST_FILE(FrameArena);
+
+using namespace base;
+using namespace base::mem;
+
+TEST(FrameArena, AllocatesAligned)
+{
+    FrameArena arena(POOL_TEMP, 3, 4096);
+
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        const auto align = 1U << (i % 7);
+        auto* ptr = (uint8_t*)arena.alloc(1 + (i % 100), align);
+        ASSERT_NE(nullptr, ptr);
+        EXPECT_EQ(0, (uint64_t)ptr % align);
+        memset(ptr, 0x42, 1 + (i % 100));
+    }
+
+    arena.advanceFrame();
+    EXPECT_EQ(1000, arena.lastFrameStats().numAllocations);
+    EXPECT_LT(0, arena.lastFrameStats().numPages);
+}
+
+TEST(FrameArena, LargeAllocations)
+{
+    FrameArena arena(POOL_TEMP, 3, 4096);
+
+    auto* ptr = (uint8_t*)arena.alloc(100000, 16);
+    ASSERT_NE(nullptr, ptr);
+    memset(ptr, 0x42, 100000);
+
+    arena.advanceFrame();
+    EXPECT_EQ(1, arena.lastFrameStats().numLargeAllocations);
+}
+
+TEST(FrameArena, MemoryIsReleasedAfterAllFramesExpire)
+{
+    FrameArena arena(POOL_TEMP, 3, 4096);
+
+    const auto firstFrame = arena.frameIndex();
+    for (uint32_t i = 0; i < 100; ++i)
+        arena.alloc(1000, 8);
+
+    const auto numPages = arena.pageAllocator().numPages();
+    EXPECT_LT(0, numPages);
+
+    // frame is still alive for the next two frames
+    arena.advanceFrame();
+    arena.advanceFrame();
+    EXPECT_TRUE(arena.isFrameAlive(firstFrame));
+    EXPECT_EQ(numPages, arena.pageAllocator().numPages());
+
+    arena.advanceFrame();
+    EXPECT_FALSE(arena.isFrameAlive(firstFrame));
+    EXPECT_EQ(0, arena.pageAllocator().numPages());
+}
+
+#ifndef BUILD_RELEASE
+TEST(FrameArena, ExpiredMemoryIsPoisoned)
+{
+    FrameArena arena(POOL_TEMP, 2, 4096);
+
+    auto* ptr = (uint8_t*)arena.alloc(256, 16);
+    memset(ptr, 0x42, 256);
+
+    // pages are kept by the page allocator so we can still peek at the memory
+    arena.advanceFrame();
+    EXPECT_EQ(0x42, ptr[128]);
+    arena.advanceFrame();
+    EXPECT_EQ(0xDD, ptr[128]);
+}
+#endif
+
+TEST(FrameArena, FrameArrayUsesArenaMemory)
+{
+    FrameArena arena(POOL_TEMP, 3, 4096);
+
+    FrameArray<int> arr(100, arena);
+    for (int i = 0; i < 100; ++i)
+        arr.pushBack(i);
+
+    EXPECT_FALSE(arr.isLocal());
+    EXPECT_LT(0, arena.pageAllocator().numPages());
+
+    // growing above the initial capacity moves the array to the heap
+    arr.pushBack(100);
+    EXPECT_TRUE(arr.isLocal());
+    EXPECT_EQ(101, arr.size());
+    EXPECT_EQ(50, arr[50]);
+}
+
+TEST(FrameArena, STLAllocator)
+{
+    FrameArena arena(POOL_TEMP, 3, 4096);
+
+    std::vector<int, FrameAllocator<int>> arr{ FrameAllocator<int>(arena) };
+    for (int i = 0; i < 10000; ++i)
+        arr.push_back(i);
+
+    EXPECT_EQ(10000, arr.size());
+    EXPECT_EQ(5000, arr[5000]);
+    EXPECT_LT(0, arena.pageAllocator().numPages());
+}
+
+TEST(FrameArena, AllocateOnManyThreads)
+{
+    static const uint32_t NUM_THREADS = 8;
+    static const uint32_t NUM_ALLOCS = 10000;
+
+    FrameArena arena(POOL_TEMP, 3, 4096);
+
+    {
+        Array<Thread> threads;
+        threads.resize(NUM_THREADS);
+
+        for (uint32_t i = 0; i < NUM_THREADS; ++i)
+        {
+            ThreadSetup setup;
+            setup.m_name = "FrameArenaTestThread";
+            setup.m_function = [&arena, i]()
+            {
+                for (uint32_t j = 0; j < NUM_ALLOCS; ++j)
+                {
+                    auto* ptr = (uint32_t*)arena.alloc(sizeof(uint32_t) * 4, 16);
+                    ptr[0] = i;
+                    ptr[3] = j;
+                }
+            };
+
+            threads[i].init(setup);
+        }
+
+        for (auto& thread : threads)
+            thread.close();
+    }
+
+    arena.advanceFrame();
+    EXPECT_EQ(NUM_THREADS * NUM_ALLOCS, arena.lastFrameStats().numAllocations);
+}
+
+namespace tests
+{
+    // same layout as the scene culling entries (rendering::scene::SceneObjectCullingEntry)
+    struct CullingEntry
+    {
+        const void* proxy = nullptr;
+        uint32_t cameraMask = 0;
+        uint16_t distance = 0;
+    };
+
+    static uint32_t CountFrameHeapAllocations()
+    {
+        PoolStatsData stats[256];
+        uint32_t numPools = 0;
+        PoolStats::GetInstance().allStats(ARRAY_COUNT(stats), stats, numPools);
+
+        uint32_t numAllocs = 0;
+        for (uint32_t i = 0; i < numPools; ++i)
+            numAllocs += stats[i].m_lastFrameAllocs;
+        return numAllocs;
+    }
+
+} // tests
+
+TEST(FrameArena, CullingResultsHeapAllocationsPerFrame)
+{
+    static const uint32_t NUM_FRAMES = 10;
+
+    // same page size as the default arena
+    FrameArena arena(POOL_TEMP, 3);
+
+    for (uint32_t numObjects : { 100u, 1000u, 10000u })
+    {
+        uint32_t arrayAllocs = 0;
+        uint32_t arenaAllocs = 0;
+        for (uint32_t frame = 0; frame < NUM_FRAMES; ++frame)
+        {
+            // visible objects collected into a growing array, the way the culling worked before the frame arena
+            PoolStats::GetInstance().resetFrameStatistics();
+            {
+                Array<tests::CullingEntry> visibleObjects;
+                for (uint32_t i = 0; i < numObjects; ++i)
+                    visibleObjects.emplaceBack().cameraMask = 1;
+            }
+            const auto frameArrayAllocs = tests::CountFrameHeapAllocations();
+
+            // visible objects written into a list allocated for the worst case in the frame arena
+            PoolStats::GetInstance().resetFrameStatistics();
+            {
+                auto* visibleObjects = arena.allocArray<tests::CullingEntry>(numObjects);
+                for (uint32_t i = 0; i < numObjects; ++i)
+                    visibleObjects[i].cameraMask = 1;
+            }
+            arena.advanceFrame();
+            const auto frameArenaAllocs = tests::CountFrameHeapAllocations();
+
+            // the arena allocates its pages in the first frames, count only the frames after all frame slots were used
+            if (frame >= arena.numFrames())
+            {
+                arrayAllocs += frameArrayAllocs;
+                arenaAllocs += frameArenaAllocs;
+            }
+        }
+
+        const auto numCountedFrames = NUM_FRAMES - arena.numFrames();
+        TRACE_INFO("Culling {} objects: {} heap allocations per frame with growing array, {} with frame arena", numObjects, arrayAllocs / numCountedFrames, arenaAllocs / numCountedFrames);
+
+        // lists bigger than half of the page are allocated from the pool, one allocation per frame, the rest comes from the reused arena pages
+        EXPECT_LT(arenaAllocs, arrayAllocs);
+        if (numObjects * sizeof(tests::CullingEntry) > arena.pageAllocator().pageSize() / 2)
+            EXPECT_GE(numCountedFrames, arenaAllocs);
+    }
+}
@@ -0,0 +1,195 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/memory/include/pageAllocator.h"
+#include "base/system/include/thread.h"
+#include "base/system/include/timedScope.h"
+
+DECLARE_TEST_FILE(PageAllocator);
+
+using namespace base;
+using namespace base::mem;
+
+TEST(PageAllocator, AllocateAndFree)
+{
+    PageAllocator allocator(POOL_TEMP, 4096, 0, 16);
+    EXPECT_EQ(0, allocator.numPages());
+
+    Array<void*> pages;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        auto* page = allocator.allocatePage();
+        ASSERT_NE(nullptr, page);
+        memset(page, i & 255, allocator.pageSize());
+        pages.pushBack(page);
+    }
+
+    EXPECT_EQ(100, allocator.numPages());
+    EXPECT_GE(allocator.maxPages(), 1);
+
+    for (auto* page : pages)
+        allocator.freePage(page);
+
+    EXPECT_EQ(0, allocator.numPages());
+
+    // only the requested number of free pages is kept after the thread caches are flushed
+    allocator.releaseFreePages(16);
+    EXPECT_LE(allocator.numFreePages(), 16);
+}
+
+TEST(PageAllocator, PreallocatedPagesAreReused)
+{
+    PageAllocator allocator(POOL_TEMP, 4096, 8, 0);
+    EXPECT_EQ(8, allocator.numFreePages());
+
+    auto* page = allocator.allocatePage();
+    EXPECT_EQ(1, allocator.numPages());
+    allocator.freePage(page);
+
+    // preallocated pages are never released
+    allocator.releaseFreePages(0);
+    EXPECT_EQ(8, allocator.numFreePages());
+}
+
+TEST(PageAllocator, PagesFromRuns)
+{
+    PageAllocator allocator(POOL_TEMP, 4096, 0, 0, 16);
+    EXPECT_EQ(16, allocator.pagesPerRun());
+
+    auto* page = allocator.allocatePage();
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, allocator.numPages());
+
+    // rest of the run is available as free pages
+    EXPECT_EQ(15, allocator.numFreePages());
+
+    // once all pages are free the whole run can go back to the system
+    allocator.freePage(page);
+    allocator.releaseFreePages(0);
+    EXPECT_EQ(0, allocator.numFreePages());
+}
+
+TEST(PageAllocator, RunIsKeptWhileAnyPageIsUsed)
+{
+    PageAllocator allocator(POOL_TEMP, 4096, 0, 0, 8);
+
+    Array<void*> pages;
+    for (uint32_t i = 0; i < 64; ++i)
+        pages.pushBack(allocator.allocatePage());
+
+    auto* usedPage = pages[37];
+    for (auto* page : pages)
+        if (page != usedPage)
+            allocator.freePage(page);
+
+    // only the run with the used page is kept
+    allocator.releaseFreePages(0);
+    EXPECT_EQ(1, allocator.numPages());
+    EXPECT_EQ(7, allocator.numFreePages());
+
+    allocator.freePage(usedPage);
+    allocator.releaseFreePages(0);
+    EXPECT_EQ(0, allocator.numFreePages());
+}
+
+TEST(PageAllocator, FreeRunsAboveRetainLimitAreReleased)
+{
+    PageAllocator allocator(POOL_TEMP, 65536, 0, 64, 32);
+
+    Array<void*> pages;
+    for (uint32_t i = 0; i < 2000; ++i)
+        pages.pushBack(allocator.allocatePage());
+
+    for (auto* page : pages)
+        allocator.freePage(page);
+
+    // whole runs are released so we may keep a bit less than asked for but never more
+    allocator.releaseFreePages(64);
+    EXPECT_LE(allocator.numFreePages(), 64);
+    EXPECT_GT(allocator.numFreePages(), 64 - 32);
+}
+
+TEST(PageAllocator, FreeOnOtherThread)
+{
+    static const uint32_t NUM_PAGES = 1000;
+
+    PageAllocator allocator(POOL_TEMP, 4096, 0, 64, 8);
+
+    Array<void*> pages;
+    {
+        Thread thread;
+
+        ThreadSetup setup;
+        setup.m_name = "PageAllocatorTestThread";
+        setup.m_function = [&allocator, &pages]()
+        {
+            for (uint32_t i = 0; i < NUM_PAGES; ++i)
+                pages.pushBack(allocator.allocatePage());
+        };
+
+        thread.init(setup);
+        thread.close();
+    }
+
+    EXPECT_EQ(NUM_PAGES, allocator.numPages());
+
+    for (auto* page : pages)
+        allocator.freePage(page);
+
+    EXPECT_EQ(0, allocator.numPages());
+}
+
+TEST(PageAllocator, DISABLED_ContentionBenchmark)
+{
+    static const uint32_t NUM_OPERATIONS = 100000;
+    static const uint32_t NUM_ALIVE = 16;
+
+    for (uint32_t numThreads = 1; numThreads <= 64; numThreads *= 2)
+    {
+        auto& allocator = PageAllocator::GetDefaultAllocator(POOL_TEMP);
+
+        ScopeTimer timer;
+        {
+            Array<Thread> threads;
+            threads.resize(numThreads);
+
+            for (auto& thread : threads)
+            {
+                ThreadSetup setup;
+                setup.m_name = "PageAllocatorBenchmarkThread";
+                setup.m_function = [&allocator]()
+                {
+                    // short lived pages, like the command buffers and the per-frame allocators
+                    void* alive[NUM_ALIVE] = {};
+                    for (uint32_t i = 0; i < NUM_OPERATIONS; ++i)
+                    {
+                        auto& slot = alive[i % NUM_ALIVE];
+                        if (slot)
+                            allocator.freePage(slot);
+                        slot = allocator.allocatePage();
+                    }
+
+                    for (auto* page : alive)
+                        allocator.freePage(page);
+                };
+
+                thread.init(setup);
+            }
+
+            for (auto& thread : threads)
+                thread.close();
+        }
+
+        const auto time = timer.timeElapsed();
+        TRACE_INFO("{} threads, {} page alloc/free per thread in {} ({} ops/s), {} pages max", numThreads, NUM_OPERATIONS, TimeInterval(time),
+            (uint64_t)((numThreads * NUM_OPERATIONS) / std::max(time, 0.000001)), allocator.maxPages());
+    }
+}
@@ -10,6 +10,10 @@
 
 #include "base/test/include/gtest/gtest.h"
 #include "base/memory/include/structurePool.h"
+#include "base/memory/include/concurrentStructurePool.h"
+#include "base/system/include/thread.h"
+#include "base/system/include/scopeLock.h"
+#include "base/system/include/timedScope.h"
 
 DECLARE_TEST_FILE(StructurePool);
 
@@ -87,3 +91,185 @@ TEST(StructurePool, AlignedElement)
     pool.free(elem);
 }
 
+TEST(ConcurrentStructurePool, AllocatesMultiple)
+{
+    ConcurrentStructurePool<test::SmallData> pool;
+    EXPECT_EQ(0, pool.size());
+
+    Array<test::SmallData*> elems;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        auto* elem = pool.create();
+        memset(elem, i & 255, sizeof(test::SmallData));
+        elems.pushBack(elem);
+    }
+
+    EXPECT_EQ(1000, pool.size());
+
+    // all different
+    auto sorted = elems;
+    std::sort(sorted.begin(), sorted.end());
+    for (uint32_t i = 1; i < sorted.size(); ++i)
+        EXPECT_NE(sorted[i - 1], sorted[i]);
+
+    for (auto* elem : elems)
+        pool.free(elem);
+    EXPECT_EQ(0, pool.size());
+}
+
+TEST(ConcurrentStructurePool, AlignedElement)
+{
+    ConcurrentStructurePool<test::AlignedElement> pool;
+
+    auto elem = pool.create();
+    EXPECT_EQ(0, ((uint64_t)elem) & 255);
+
+    pool.free(elem);
+}
+
+TEST(ConcurrentStructurePool, FreeOnOtherThread)
+{
+    static const uint32_t NUM_THREADS = 4;
+    static const uint32_t NUM_ELEMENTS = 10000;
+
+    ConcurrentStructurePool<test::SmallData> pool;
+
+    // each thread allocates elements and frees the ones allocated by the previous thread
+    Array<test::SmallData*> elements[NUM_THREADS];
+    {
+        Array<Thread> threads;
+        threads.resize(NUM_THREADS);
+
+        for (uint32_t i = 0; i < NUM_THREADS; ++i)
+        {
+            ThreadSetup setup;
+            setup.m_name = "PoolTestThread";
+            setup.m_function = [&pool, &elements, i]()
+            {
+                for (uint32_t j = 0; j < NUM_ELEMENTS; ++j)
+                {
+                    auto* elem = pool.create();
+                    memset(elem, i, sizeof(test::SmallData));
+                    elements[i].pushBack(elem);
+                }
+            };
+
+            threads[i].init(setup);
+        }
+
+        for (auto& thread : threads)
+            thread.close();
+    }
+
+    EXPECT_EQ(NUM_THREADS * NUM_ELEMENTS, pool.size());
+
+    for (uint32_t i = 0; i < NUM_THREADS; ++i)
+        for (auto* elem : elements[i])
+            EXPECT_EQ(i, elem->m_data[0]);
+
+    {
+        Array<Thread> threads;
+        threads.resize(NUM_THREADS);
+
+        for (uint32_t i = 0; i < NUM_THREADS; ++i)
+        {
+            ThreadSetup setup;
+            setup.m_name = "PoolTestThread";
+            setup.m_function = [&pool, &elements, i]()
+            {
+                for (auto* elem : elements[(i + 1) % NUM_THREADS])
+                    pool.free(elem);
+            };
+
+            threads[i].init(setup);
+        }
+
+        for (auto& thread : threads)
+            thread.close();
+    }
+
+    EXPECT_EQ(0, pool.size());
+}
+
+namespace test
+{
+    template< typename Func >
+    static double RunOnThreads(uint32_t numThreads, const Func& func)
+    {
+        ScopeTimer timer;
+
+        Array<Thread> threads;
+        threads.resize(numThreads);
+
+        for (auto& thread : threads)
+        {
+            ThreadSetup setup;
+            setup.m_name = "PoolBenchmarkThread";
+            setup.m_function = func;
+            thread.init(setup);
+        }
+
+        for (auto& thread : threads)
+            thread.close();
+
+        return timer.timeElapsed();
+    }
+
+} // test
+
+TEST(ConcurrentStructurePool, DISABLED_ContentionBenchmark)
+{
+    static const uint32_t NUM_OPERATIONS = 1000000;
+    static const uint32_t NUM_ALIVE = 256;
+
+    for (uint32_t numThreads = 1; numThreads <= 64; numThreads *= 2)
+    {
+        // classic pool guarded by a lock
+        double lockedTime = 0.0;
+        {
+            StructurePool<test::SmallData> pool;
+            SpinLock lock;
+
+            lockedTime = test::RunOnThreads(numThreads, [&pool, &lock]()
+                {
+                    test::SmallData* alive[NUM_ALIVE] = {};
+                    for (uint32_t i = 0; i < NUM_OPERATIONS; ++i)
+                    {
+                        auto lockGuard = CreateLock(lock);
+                        auto& slot = alive[i % NUM_ALIVE];
+                        if (slot)
+                            pool.free(slot);
+                        slot = pool.create();
+                    }
+
+                    auto lockGuard = CreateLock(lock);
+                    for (auto* elem : alive)
+                        pool.free(elem);
+                });
+        }
+
+        double concurrentTime = 0.0;
+        {
+            ConcurrentStructurePool<test::SmallData> pool;
+
+            concurrentTime = test::RunOnThreads(numThreads, [&pool]()
+                {
+                    test::SmallData* alive[NUM_ALIVE] = {};
+                    for (uint32_t i = 0; i < NUM_OPERATIONS; ++i)
+                    {
+                        auto& slot = alive[i % NUM_ALIVE];
+                        if (slot)
+                            pool.free(slot);
+                        slot = pool.create();
+                    }
+
+                    for (auto* elem : alive)
+                        pool.free(elem);
+                });
+
+            EXPECT_EQ(0, pool.size());
+        }
+
+        TRACE_INFO("{} threads, {} alloc/free per thread: locked pool {}, concurrent pool {}", numThreads, NUM_OPERATIONS, TimeInterval(lockedTime), TimeInterval(concurrentTime));
+    }
+}
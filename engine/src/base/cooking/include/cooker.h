@@ -81,7 +81,7 @@ namespace base
             bool findBestCooker(const res::ResourceKey& key, CookableClass& outBestCooker) const;
 
             res::ResourcePtr cookUsingCooker(res::ResourceKey key, const res::ResourceMountPoint& mountPoint, const CookableClass& recipe) const;
-            //Cooker::Result cookFromTextFormat(res::ResourceKey key, const res::ResourceMountPoint& mountPoint) const;
+            res::ResourcePtr cookFromTextFormat(res::ResourceKey key, const res::ResourceMountPoint& mountPoint, const CookableClass& recipe) const;
 
 
         };
@@ -65,6 +65,7 @@ namespace base
 
             UniquePtr<DependencyTracker> m_depTracker;
 
+            SpinLock m_pendingReloadLock; // protects the queue and set, taken before the cache locks
             Queue<res::ResourceKey> m_pendingReloadQueue;
             HashSet<res::ResourceKey> m_pendingReloadSet;
 
@@ -33,15 +33,19 @@ namespace base
             /// schedule new content for saving
             bool scheduleSave(const res::ResourcePtr& data, const io::AbsolutePath& path);
 
+            /// schedule already serialized content for saving, the data is written as is
+            bool scheduleSave(const Buffer& data, const io::AbsolutePath& path);
+
         private:
             struct SaveJob : public NoCopy
             {
                 res::ResourcePtr unsavedResource;
+                Buffer unsavedData; // serialized content, used if there's no resource
                 io::AbsolutePath absoultePath;
             };
 
             Queue<SaveJob*> m_saveJobQueue;
-            res::ResourcePtr m_saveCurrentResource;
+            SaveJob* m_saveCurrentJob = nullptr;
             SpinLock m_saveQueueLock;
 
             Semaphore m_saveThreadSemaphore;
@@ -52,7 +56,7 @@ namespace base
             ///--
 
             void processSavingThread();
-            bool saveSingleFile(const res::ResourcePtr& data, const io::AbsolutePath& path);
+            bool saveSingleFile(const SaveJob& job);
         };
 
         //--
@@ -16,6 +16,7 @@
 #include "base/object/include/nativeFileReader.h"
 #include "base/object/include/memoryReader.h"
 #include "base/io/include/ioSystem.h"
+#include "base/io/include/timestamp.h"
 #include "base/resources/include/resource.h"
 
 namespace base
@@ -322,6 +323,11 @@ namespace base
                 {
                     return cookUsingCooker(key, mountPoint, info);
                 }
+                else if (info.targetResourceClass)
+                {
+                    // text resources are cooked by loading them, the cooked file is saved in the binary format
+                    return cookFromTextFormat(key, mountPoint, info);
+                }
                 else
                 {
                     TRACE_ERROR("No cooker found for resource '{}'", key);
@@ -364,36 +370,45 @@ namespace base
             return nullptr;
         }
 
-        /*Cooker::Result Cooker::cookFromTextFormat(res::ResourceKey key, const res::ResourceMountPoint& mountPoint) const
+        res::ResourcePtr Cooker::cookFromTextFormat(res::ResourceKey key, const res::ResourceMountPoint& mountPoint, const CookableClass& recipe) const
         {
-            const auto filePath = key.path().view();
+            ASSERT(recipe.cookerClass == nullptr);
+            ASSERT(recipe.targetResourceClass != nullptr);
+
+            const auto filePath = key.path().path();
 
             uint64_t fileSize = 0;
             io::TimeStamp fileTimestamp;
             if (!m_depot.queryFileInfo(filePath, nullptr, &fileSize, &fileTimestamp))
-                return Cooker::Result();
+            {
+                TRACE_ERROR("Unable to query information about '{}'", filePath);
+                return nullptr;
+            }
 
-            if (auto content = m_depot.createFileReader(filePath))
+            auto content = m_depot.createFileReader(filePath);
+            if (!content)
             {
-                stream::NativeFileReader fileReader(*content);
+                TRACE_ERROR("Unable to open '{}' for reading", filePath);
+                return nullptr;
+            }
 
-                if (auto data = res::LoadUncached(key.path().view(), key.cls(), fileReader, m_loader))
-                {
-                    Cooker::Result result;
-                    result.data = data;
-                    result.metadata = base::CreateSharedPtr<res::Metadata>();
+            // load the text, references are resolved relative to the mount point the same way as in the editor
+            stream::NativeFileReader fileReader(*content);
+            auto cookedResource = res::LoadUncached(filePath, recipe.targetResourceClass, fileReader, m_loader, nullptr, mountPoint);
+            if (!cookedResource)
+                return nullptr;
 
-                    auto& mainDep = result.metadata->sourceDependencies.emplaceBack();
-                    mainDep.size = fileReader.size();
-                    mainDep.sourcePath = base::StringBuf(key.path());
-                    mainDep.timestamp = fileTimestamp.value();
+            auto metadata = base::CreateSharedPtr<res::Metadata>();
+            metadata->resourceClassVersion = cookedResource->cls()->findMetadataRef<base::res::ResourceDataVersionMetadata>().version();
 
-                    return result;
-                }
-            }
+            auto& mainDep = metadata->sourceDependencies.emplaceBack();
+            mainDep.sourcePath = StringBuf(filePath);
+            mainDep.size = fileSize;
+            mainDep.timestamp = fileTimestamp.value();
 
-            return Cooker::Result();
-        }*/
+            cookedResource->metadata(metadata);
+            return cookedResource;
+        }
 
         //--
 
@@ -116,7 +116,7 @@ namespace base
 
                 // update reload queue
                 {
-                    auto lock = CreateLock(m_lock);
+                    auto lock = CreateLock(m_pendingReloadLock);
                     for (const auto& key : changedFiles)
                     {
                         // already in reloading queue
@@ -127,9 +127,7 @@ namespace base
                         }
 
                         // check if already have a file
-                        RefWeakPtr<LoadingJob> loadingJobWeak;
-                        m_loadingJobs.find(key, loadingJobWeak);
-                        if (auto loadingJob = loadingJobWeak.lock())
+                        if (isResourceLoading(key))
                         {
                             TRACE_INFO("File '{}' was changed while loaded, file will be reloaded once loading is done");
                             if (m_pendingReloadSet.insert(key))
@@ -138,9 +136,7 @@ namespace base
                         }
 
                         // already loaded ?
-                        RefWeakPtr<res::IResource> loadedResourceWeak;
-                        m_loadedResources.find(key, loadedResourceWeak);
-                        if (auto loadedResource = loadedResourceWeak.lock())
+                        if (auto loadedResource = findLoadedResource(key))
                         {
                             TRACE_INFO("Resource '{}' flagged for reloading", key);
                             if (m_pendingReloadSet.insert(key))
@@ -171,19 +167,12 @@ namespace base
                 }
 
                 // get the current resource
-                res::ResourceHandle loadedResource;
-                {
-                    RefWeakPtr<res::IResource> loadedResourceWeak;
-                    m_loadedResources.find(key, loadedResourceWeak);
-                    loadedResource = loadedResourceWeak.lock();
-                }
+                auto loadedResource = findLoadedResource(key);
 
                 // resource is not loaded, reload may not needed
                 if (!loadedResource)
                 {
-                    RefWeakPtr<LoadingJob> loadingJobWeak;
-                    m_loadingJobs.find(key, loadingJobWeak);
-                    if (auto loadingJob = loadingJobWeak.lock())
+                    if (isResourceLoading(key))
                     {
                         // we are loading this resource, retry in future
                         TRACE_INFO("Resource '{}' scheduled for reload is still loading", key);
@@ -209,7 +198,7 @@ namespace base
 
         void ResourceLoaderCooker::startReloading()
         {
-            auto lock = CreateLock(m_lock);
+            auto lock = CreateLock(m_pendingReloadLock);
 
             // pick first resource from the reload queue
             if (auto nextResourceToReload = pickupNextResourceForReloading_NoLock())
@@ -268,10 +257,7 @@ namespace base
                 outNewResource = m_reloadedResource;
 
                 if (m_reloadedResource)
-                {
-                    auto lock = CreateLock(m_lock);
-                    m_loadedResources[m_resourceBeingReloadedKey] = m_reloadedResource;
-                }
+                    replaceLoadedResource(m_resourceBeingReloadedKey, m_reloadedResource);
 
                 m_resourceBeingReloadedKey = res::ResourceKey();
                 m_reloadedResource.reset();
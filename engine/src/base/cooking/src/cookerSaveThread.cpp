@@ -68,7 +68,7 @@ namespace base
                 {
                     auto saveLock = CreateLock(m_saveQueueLock);
                     queueSize = m_saveJobQueue.size();
-                    if (m_saveJobQueue.empty() && !m_saveCurrentResource)
+                    if (m_saveJobQueue.empty() && !m_saveCurrentJob)
                         break;
                 }
 
@@ -108,8 +108,30 @@ namespace base
             return true;
         }
 
-        bool CookerSaveThread::saveSingleFile(const res::ResourcePtr& data, const io::AbsolutePath& path)
+        bool CookerSaveThread::scheduleSave(const Buffer& data, const io::AbsolutePath& path)
         {
+            DEBUG_CHECK_EX(!path.empty(), "Invalid path");
+            DEBUG_CHECK_EX(data, "Invalid data to save");
+
+            // add to queue
+            {
+                auto saveLock = CreateLock(m_saveQueueLock);
+
+                auto job = MemNew(SaveJob);
+                job->absoultePath = path;
+                job->unsavedData = data;
+                m_saveJobQueue.push(job);
+            }
+
+            // wakeup thread
+            m_saveThreadSemaphore.release(1);
+            return true;
+        }
+
+        bool CookerSaveThread::saveSingleFile(const SaveJob& job)
+        {
+            const auto& path = job.absoultePath;
+
             // delete temp file, we keep them after failed save for inspection
             auto tempFilePath = path.addExtension(".out");
             IO::GetInstance().deleteFile(tempFilePath);
@@ -123,15 +145,27 @@ namespace base
                     return false;
                 }
 
-                // serialize
-                auto binarySaver = base::CreateSharedPtr<res::binary::BinarySaver>();
-                stream::NativeFileWriter tempFileWriter(tempWriter);
-                stream::SavingContext savingContext(data);
-                savingContext.m_contextName = base::TempString("{}", path);
-                if (!binarySaver->saveObjects(tempFileWriter, savingContext))
+                if (job.unsavedResource)
                 {
-                    TRACE_ERROR("Failed to save '{}'", tempFilePath);
-                    return false;
+                    // serialize
+                    auto binarySaver = base::CreateSharedPtr<res::binary::BinarySaver>();
+                    stream::NativeFileWriter tempFileWriter(tempWriter);
+                    stream::SavingContext savingContext(job.unsavedResource);
+                    savingContext.m_contextName = base::TempString("{}", path);
+                    if (!binarySaver->saveObjects(tempFileWriter, savingContext))
+                    {
+                        TRACE_ERROR("Failed to save '{}'", tempFilePath);
+                        return false;
+                    }
+                }
+                else
+                {
+                    // already serialized
+                    if (tempWriter->writeSync(job.unsavedData.data(), job.unsavedData.size()) != job.unsavedData.size())
+                    {
+                        TRACE_ERROR("Failed to write {} to '{}'", MemSize(job.unsavedData.size()), tempFilePath);
+                        return false;
+                    }
                 }
             }
 
@@ -161,33 +195,31 @@ namespace base
                 m_saveThreadSemaphore.wait(100);
 
                 // get a file from list
-                base::io::AbsolutePath path;
-                base::res::ResourcePtr ptr;
+                SaveJob* job = nullptr;
                 {
                     auto lock = CreateLock(m_saveQueueLock);
                     if (m_saveJobQueue.empty())
                         continue;
 
-                    auto* job = m_saveJobQueue.top();
-                    ptr = job->unsavedResource;
-                    path = job->absoultePath;
-                    m_saveCurrentResource = job->unsavedResource;
+                    job = m_saveJobQueue.top();
+                    m_saveCurrentJob = job;
                     m_saveJobQueue.pop();
-                    MemDelete(job);
                 }
 
                 // save to disk directly
                 {
                     base::ScopeTimer saveTimer;
-                    bool saved = saveSingleFile(ptr, path);
-                    TRACE_INFO("{} {} in {}", saved ? "Saved" : "Failed to save", path, saveTimer);
+                    bool saved = saveSingleFile(*job);
+                    TRACE_INFO("{} {} in {}", saved ? "Saved" : "Failed to save", job->absoultePath, saveTimer);
                 }
                 
                 // unset guard
                 {
                     auto lock = CreateLock(m_saveQueueLock);
-                    m_saveCurrentResource = nullptr;
+                    m_saveCurrentJob = nullptr;
                 }
+
+                MemDelete(job);
             }
 
             TRACE_INFO("Cooker saved thread finished after {}, saved {} file(s), {}, there are {} outstanding jobs in queue", 
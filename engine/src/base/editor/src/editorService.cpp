@@ -36,6 +36,7 @@ namespace ed
 
     RTTI_BEGIN_TYPE_CLASS(Editor);
         RTTI_METADATA(app::DependsOnServiceMetadata).dependsOn<res::LoadingService>();
+        RTTI_METADATA(app::ServiceThreadingMetadata).mainThreadInit(); // creates the UI
     RTTI_END_TYPE();
 
     Editor::Editor()
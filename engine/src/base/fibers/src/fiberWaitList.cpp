@@ -49,7 +49,7 @@ namespace base
 
 		void WaitList::pushFence(WaitCounter fence)
 		{
-			if (fence.empty())
+			if (!fence.empty())
 			{
 				auto lock = base::CreateLock(m_lock);
 				m_fences.pushBack(fence);
@@ -0,0 +1,146 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: shapes #]
+***/
+
+#pragma once
+
+namespace base
+{
+    namespace shape
+    {
+
+        /// ray for the dynamic tree queries
+        struct DynamicTreeRay
+        {
+            Vector3 origin;
+            Vector3 direction; // normalized
+            float maxLength = VERY_LARGE_FLOAT;
+        };
+
+        /// box moved along a direction for the dynamic tree queries
+        struct DynamicTreeSweep
+        {
+            Box box;
+            Vector3 direction; // normalized
+            float maxLength = VERY_LARGE_FLOAT;
+        };
+
+        /// closest hit found by the ray/sweep query
+        struct DynamicTreeHit
+        {
+            uint32_t proxy = INDEX_MAX; // INDEX_MAX if nothing was hit
+            float distance = 0.0f;
+        };
+
+        /// dynamic bounding volume hierarchy of boxes, used as a broad phase for objects that move
+        /// NOTE: boxes are kept enlarged ("fat") in the tree so small movements don't modify it, box that leaves its fat box is re-inserted and the tree is rebalanced with rotations
+        /// NOTE: modifications are single threaded, queries don't modify the tree and can run in parallel as long as nothing is moved
+        class BASE_GEOMETRY_API DynamicTree : public NoCopy
+        {
+        public:
+            DynamicTree(float margin = 0.1f, float displacementMultiplier = 2.0f);
+            ~DynamicTree();
+
+            /// get number of proxies in the tree
+            INLINE uint32_t numProxies() const { return m_numProxies; }
+
+            /// get height of the tree, 0 for empty tree or tree with single proxy
+            INLINE uint32_t height() const { return (m_root != INDEX_MAX) ? m_nodes[m_root].height : 0; }
+
+            /// get the exact box of the proxy, as last set
+            INLINE const Box& box(uint32_t proxy) const { return m_nodes[proxy].tightBox; }
+
+            /// get the enlarged box of the proxy, as stored in the tree
+            INLINE const Box& fatBox(uint32_t proxy) const { return m_nodes[proxy].box; }
+
+            /// get user data of the proxy
+            INLINE uint64_t userData(uint32_t proxy) const { return m_nodes[proxy].userData; }
+
+            ///---
+
+            /// remove all proxies
+            void clear();
+
+            /// add a proxy for given box, returns the proxy ID (stable until the proxy is destroyed)
+            uint32_t createProxy(const Box& box, uint64_t userData = 0);
+
+            /// remove proxy from the tree
+            void destroyProxy(uint32_t proxy);
+
+            /// update box of the proxy, displacement is used to predict the movement and enlarge the fat box in that direction
+            /// NOTE: the tree is only modified if the box leaves its fat box (or the fat box became too big), returns true in that case
+            bool moveProxy(uint32_t proxy, const Box& box, const Vector3& displacement = Vector3::ZERO());
+
+            ///---
+
+            /// visit all proxies which boxes overlap given box, return true from the function to stop
+            typedef std::function<bool(uint32_t proxy)> TOverlapFunc;
+            void queryOverlap(const Box& box, const TOverlapFunc& func) const;
+
+            /// called for every proxy which box is hit, should return the distance of the hit with the real shape or negative value to ignore the proxy
+            typedef std::function<float(uint32_t proxy, float boxDistance)> THitFunc;
+
+            /// find the closest proxy hit by the ray
+            DynamicTreeHit castRay(const DynamicTreeRay& ray, const THitFunc& hitFunc = nullptr) const;
+
+            /// find the closest proxy hit by the moving box
+            DynamicTreeHit castBox(const DynamicTreeSweep& sweep, const THitFunc& hitFunc = nullptr) const;
+
+            ///---
+
+            /// find closest hit for each of the rays, tested against the proxy boxes, queries are spread across fibers
+            void castRays(const DynamicTreeRay* rays, uint32_t numRays, DynamicTreeHit* outHits) const;
+
+            /// find closest hit for each of the moving boxes, tested against the proxy boxes, queries are spread across fibers
+            void castBoxes(const DynamicTreeSweep* sweeps, uint32_t numSweeps, DynamicTreeHit* outHits) const;
+
+            /// collect proxies overlapping each of the boxes (one output array per box), queries are spread across fibers
+            void queryOverlaps(const Box* boxes, uint32_t numBoxes, Array<uint32_t>* outProxies) const;
+
+            ///---
+
+            /// check the internal consistency of the tree, slow, for testing
+            bool validate() const;
+
+        private:
+            struct Node
+            {
+                Box box; // fat box for leaves, bounds of children for the rest
+                Box tightBox; // leaves only
+                uint64_t userData = 0; // leaves only
+                uint32_t parent = INDEX_MAX; // next free node for nodes on the free list
+                uint32_t child1 = INDEX_MAX;
+                uint32_t child2 = INDEX_MAX;
+                int height = 0; // 0 for leaves, -1 for free nodes
+
+                INLINE bool isLeaf() const { return child1 == INDEX_MAX; }
+            };
+
+            Array<Node> m_nodes;
+            uint32_t m_root = INDEX_MAX;
+            uint32_t m_freeNode = INDEX_MAX;
+            uint32_t m_numProxies = 0;
+
+            float m_margin = 0.1f;
+            float m_displacementMultiplier = 2.0f;
+
+            uint32_t allocNode();
+            void freeNode(uint32_t index);
+
+            void insertLeaf(uint32_t leaf);
+            void removeLeaf(uint32_t leaf);
+            void refitAncestors(uint32_t index);
+            uint32_t balance(uint32_t index);
+
+            Box fattenBox(const Box& box, const Vector3& displacement) const;
+
+            DynamicTreeHit castInternal(const Vector3& origin, const Vector3& direction, float maxLength, const Vector3& extents, const THitFunc& hitFunc) const;
+            uint32_t validateNode(uint32_t index, uint32_t parent, bool& outValid) const;
+        };
+
+    } // shape
+} // base
@@ -0,0 +1,675 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: shapes #]
+***/
+
+#include "build.h"
+#include "shapeDynamicTree.h"
+
+#include "base/containers/include/inplaceArray.h"
+#include "base/fibers/include/fiberSystem.h"
+
+namespace base
+{
+    namespace shape
+    {
+
+        //---
+
+        // number of queries processed by single fiber job in the batched queries
+        static const uint32_t QUERIES_PER_JOB = 64;
+
+        static INLINE Box MergeBoxes(const Box& a, const Box& b)
+        {
+            return Box(Min(a.min, b.min), Max(a.max, b.max));
+        }
+
+        static INLINE float SurfaceArea(const Box& box)
+        {
+            const auto size = box.size();
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        static INLINE float SafeInverse(float x)
+        {
+            // big but finite so 0*inv stays 0 and the slab test does not produce NaNs for axis parallel rays
+            if (x > 1e-20f || x < -1e-20f)
+                return 1.0f / x;
+            return (x >= 0.0f) ? 1e30f : -1e30f;
+        }
+
+        static INLINE bool IntersectRayBox(const Vector3& origin, const Vector3& invDir, const Box& box, const Vector3& extents, float maxLength, float& outEnter)
+        {
+            float tx1 = (box.min.x - extents.x - origin.x) * invDir.x;
+            float tx2 = (box.max.x + extents.x - origin.x) * invDir.x;
+            float tmin = std::min(tx1, tx2);
+            float tmax = std::max(tx1, tx2);
+
+            float ty1 = (box.min.y - extents.y - origin.y) * invDir.y;
+            float ty2 = (box.max.y + extents.y - origin.y) * invDir.y;
+            tmin = std::max(tmin, std::min(ty1, ty2));
+            tmax = std::min(tmax, std::max(ty1, ty2));
+
+            float tz1 = (box.min.z - extents.z - origin.z) * invDir.z;
+            float tz2 = (box.max.z + extents.z - origin.z) * invDir.z;
+            tmin = std::max(tmin, std::min(tz1, tz2));
+            tmax = std::min(tmax, std::max(tz1, tz2));
+
+            // starting inside the box counts as hit at distance 0
+            tmin = std::max(tmin, 0.0f);
+            if (tmin > tmax || tmin > maxLength)
+                return false;
+
+            outEnter = tmin;
+            return true;
+        }
+
+        //---
+
+        DynamicTree::DynamicTree(float margin /*= 0.1f*/, float displacementMultiplier /*= 2.0f*/)
+            : m_margin(margin)
+            , m_displacementMultiplier(displacementMultiplier)
+        {}
+
+        DynamicTree::~DynamicTree()
+        {}
+
+        void DynamicTree::clear()
+        {
+            m_nodes.reset();
+            m_root = INDEX_MAX;
+            m_freeNode = INDEX_MAX;
+            m_numProxies = 0;
+        }
+
+        uint32_t DynamicTree::allocNode()
+        {
+            if (m_freeNode != INDEX_MAX)
+            {
+                const auto index = m_freeNode;
+                m_freeNode = m_nodes[index].parent;
+                m_nodes[index] = Node();
+                return index;
+            }
+
+            m_nodes.emplaceBack();
+            return m_nodes.lastValidIndex();
+        }
+
+        void DynamicTree::freeNode(uint32_t index)
+        {
+            auto& node = m_nodes[index];
+            node.parent = m_freeNode;
+            node.child1 = INDEX_MAX;
+            node.child2 = INDEX_MAX;
+            node.height = -1;
+            m_freeNode = index;
+        }
+
+        Box DynamicTree::fattenBox(const Box& box, const Vector3& displacement) const
+        {
+            auto fat = box.extruded(m_margin);
+
+            // predict the movement so the box stays in the tree longer
+            const auto delta = displacement * m_displacementMultiplier;
+            if (delta.x < 0.0f) fat.min.x += delta.x; else fat.max.x += delta.x;
+            if (delta.y < 0.0f) fat.min.y += delta.y; else fat.max.y += delta.y;
+            if (delta.z < 0.0f) fat.min.z += delta.z; else fat.max.z += delta.z;
+
+            return fat;
+        }
+
+        uint32_t DynamicTree::createProxy(const Box& box, uint64_t userData)
+        {
+            const auto proxy = allocNode();
+
+            auto& node = m_nodes[proxy];
+            node.tightBox = box;
+            node.box = fattenBox(box, Vector3::ZERO());
+            node.userData = userData;
+            node.height = 0;
+
+            insertLeaf(proxy);
+            m_numProxies += 1;
+            return proxy;
+        }
+
+        void DynamicTree::destroyProxy(uint32_t proxy)
+        {
+            DEBUG_CHECK_EX(proxy < m_nodes.size() && m_nodes[proxy].height == 0, "Invalid proxy");
+
+            removeLeaf(proxy);
+            freeNode(proxy);
+            m_numProxies -= 1;
+        }
+
+        bool DynamicTree::moveProxy(uint32_t proxy, const Box& box, const Vector3& displacement)
+        {
+            DEBUG_CHECK_EX(proxy < m_nodes.size() && m_nodes[proxy].height == 0, "Invalid proxy");
+
+            m_nodes[proxy].tightBox = box;
+
+            const auto fatBox = fattenBox(box, displacement);
+
+            // still inside the fat box, tree does not change unless the fat box is much bigger than needed (ie. object stopped after moving fast)
+            const auto& treeBox = m_nodes[proxy].box;
+            if (treeBox.contains(box))
+            {
+                const auto hugeBox = fatBox.extruded(4.0f * m_margin);
+                if (hugeBox.contains(treeBox))
+                    return false;
+            }
+
+            removeLeaf(proxy);
+            m_nodes[proxy].box = fatBox;
+            insertLeaf(proxy);
+            return true;
+        }
+
+        //---
+
+        void DynamicTree::insertLeaf(uint32_t leaf)
+        {
+            if (m_root == INDEX_MAX)
+            {
+                m_root = leaf;
+                m_nodes[leaf].parent = INDEX_MAX;
+                return;
+            }
+
+            // find the best sibling using the surface area heuristic
+            const auto leafBox = m_nodes[leaf].box;
+            auto index = m_root;
+            while (!m_nodes[index].isLeaf())
+            {
+                const auto& node = m_nodes[index];
+
+                const auto area = SurfaceArea(node.box);
+                const auto combinedArea = SurfaceArea(MergeBoxes(node.box, leafBox));
+
+                // cost of creating a new parent for this node and the new leaf
+                const auto cost = 2.0f * combinedArea;
+
+                // minimum cost of pushing the leaf further down the tree
+                const auto inheritanceCost = 2.0f * (combinedArea - area);
+
+                const auto& child1 = m_nodes[node.child1];
+                auto cost1 = SurfaceArea(MergeBoxes(child1.box, leafBox)) + inheritanceCost;
+                if (!child1.isLeaf())
+                    cost1 -= SurfaceArea(child1.box);
+
+                const auto& child2 = m_nodes[node.child2];
+                auto cost2 = SurfaceArea(MergeBoxes(child2.box, leafBox)) + inheritanceCost;
+                if (!child2.isLeaf())
+                    cost2 -= SurfaceArea(child2.box);
+
+                if (cost < cost1 && cost < cost2)
+                    break;
+
+                index = (cost1 < cost2) ? node.child1 : node.child2;
+            }
+
+            // create new parent for the sibling and the leaf
+            const auto sibling = index;
+            const auto oldParent = m_nodes[sibling].parent;
+            const auto newParent = allocNode();
+            {
+                auto& parentNode = m_nodes[newParent];
+                parentNode.parent = oldParent;
+                parentNode.box = MergeBoxes(leafBox, m_nodes[sibling].box);
+                parentNode.height = m_nodes[sibling].height + 1;
+                parentNode.child1 = sibling;
+                parentNode.child2 = leaf;
+            }
+
+            if (oldParent != INDEX_MAX)
+            {
+                auto& oldParentNode = m_nodes[oldParent];
+                if (oldParentNode.child1 == sibling)
+                    oldParentNode.child1 = newParent;
+                else
+                    oldParentNode.child2 = newParent;
+            }
+            else
+            {
+                m_root = newParent;
+            }
+
+            m_nodes[sibling].parent = newParent;
+            m_nodes[leaf].parent = newParent;
+
+            refitAncestors(newParent);
+        }
+
+        void DynamicTree::removeLeaf(uint32_t leaf)
+        {
+            if (leaf == m_root)
+            {
+                m_root = INDEX_MAX;
+                return;
+            }
+
+            const auto parent = m_nodes[leaf].parent;
+            const auto grandParent = m_nodes[parent].parent;
+            const auto sibling = (m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+            // sibling takes place of the parent
+            if (grandParent != INDEX_MAX)
+            {
+                auto& grandParentNode = m_nodes[grandParent];
+                if (grandParentNode.child1 == parent)
+                    grandParentNode.child1 = sibling;
+                else
+                    grandParentNode.child2 = sibling;
+
+                m_nodes[sibling].parent = grandParent;
+                freeNode(parent);
+
+                refitAncestors(grandParent);
+            }
+            else
+            {
+                m_root = sibling;
+                m_nodes[sibling].parent = INDEX_MAX;
+                freeNode(parent);
+            }
+
+            m_nodes[leaf].parent = INDEX_MAX;
+        }
+
+        void DynamicTree::refitAncestors(uint32_t index)
+        {
+            while (index != INDEX_MAX)
+            {
+                index = balance(index);
+
+                auto& node = m_nodes[index];
+                const auto& child1 = m_nodes[node.child1];
+                const auto& child2 = m_nodes[node.child2];
+
+                node.height = 1 + std::max(child1.height, child2.height);
+                node.box = MergeBoxes(child1.box, child2.box);
+
+                index = node.parent;
+            }
+        }
+
+        uint32_t DynamicTree::balance(uint32_t iA)
+        {
+            auto& A = m_nodes[iA];
+            if (A.isLeaf() || A.height < 2)
+                return iA;
+
+            const auto iB = A.child1;
+            const auto iC = A.child2;
+            auto& B = m_nodes[iB];
+            auto& C = m_nodes[iC];
+
+            const auto balance = C.height - B.height;
+
+            // rotate C up
+            if (balance > 1)
+            {
+                const auto iF = C.child1;
+                const auto iG = C.child2;
+                auto& F = m_nodes[iF];
+                auto& G = m_nodes[iG];
+
+                C.child1 = iA;
+                C.parent = A.parent;
+                A.parent = iC;
+
+                if (C.parent != INDEX_MAX)
+                {
+                    auto& parentNode = m_nodes[C.parent];
+                    if (parentNode.child1 == iA)
+                        parentNode.child1 = iC;
+                    else
+                        parentNode.child2 = iC;
+                }
+                else
+                {
+                    m_root = iC;
+                }
+
+                if (F.height > G.height)
+                {
+                    C.child2 = iF;
+                    A.child2 = iG;
+                    G.parent = iA;
+                    A.box = MergeBoxes(B.box, G.box);
+                    C.box = MergeBoxes(A.box, F.box);
+                    A.height = 1 + std::max(B.height, G.height);
+                    C.height = 1 + std::max(A.height, F.height);
+                }
+                else
+                {
+                    C.child2 = iG;
+                    A.child2 = iF;
+                    F.parent = iA;
+                    A.box = MergeBoxes(B.box, F.box);
+                    C.box = MergeBoxes(A.box, G.box);
+                    A.height = 1 + std::max(B.height, F.height);
+                    C.height = 1 + std::max(A.height, G.height);
+                }
+
+                return iC;
+            }
+
+            // rotate B up
+            if (balance < -1)
+            {
+                const auto iD = B.child1;
+                const auto iE = B.child2;
+                auto& D = m_nodes[iD];
+                auto& E = m_nodes[iE];
+
+                B.child1 = iA;
+                B.parent = A.parent;
+                A.parent = iB;
+
+                if (B.parent != INDEX_MAX)
+                {
+                    auto& parentNode = m_nodes[B.parent];
+                    if (parentNode.child1 == iA)
+                        parentNode.child1 = iB;
+                    else
+                        parentNode.child2 = iB;
+                }
+                else
+                {
+                    m_root = iB;
+                }
+
+                if (D.height > E.height)
+                {
+                    B.child2 = iD;
+                    A.child1 = iE;
+                    E.parent = iA;
+                    A.box = MergeBoxes(C.box, E.box);
+                    B.box = MergeBoxes(A.box, D.box);
+                    A.height = 1 + std::max(C.height, E.height);
+                    B.height = 1 + std::max(A.height, D.height);
+                }
+                else
+                {
+                    B.child2 = iE;
+                    A.child1 = iD;
+                    D.parent = iA;
+                    A.box = MergeBoxes(C.box, D.box);
+                    B.box = MergeBoxes(A.box, E.box);
+                    A.height = 1 + std::max(C.height, D.height);
+                    B.height = 1 + std::max(A.height, E.height);
+                }
+
+                return iB;
+            }
+
+            return iA;
+        }
+
+        //---
+
+        void DynamicTree::queryOverlap(const Box& box, const TOverlapFunc& func) const
+        {
+            if (m_root == INDEX_MAX)
+                return;
+
+            InplaceArray<uint32_t, 128> stack;
+            stack.pushBack(m_root);
+
+            while (!stack.empty())
+            {
+                const auto index = stack.back();
+                stack.popBack();
+
+                const auto& node = m_nodes[index];
+
+                if (!node.box.touches(box))
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    // fat box is only for the tree, report only what really overlaps
+                    if (node.tightBox.touches(box))
+                        if (func(index))
+                            return;
+                }
+                else
+                {
+                    stack.pushBack(node.child1);
+                    stack.pushBack(node.child2);
+                }
+            }
+        }
+
+        DynamicTreeHit DynamicTree::castInternal(const Vector3& origin, const Vector3& direction, float maxLength, const Vector3& extents, const THitFunc& hitFunc) const
+        {
+            DynamicTreeHit ret;
+            if (m_root == INDEX_MAX)
+                return ret;
+
+            const Vector3 invDir(SafeInverse(direction.x), SafeInverse(direction.y), SafeInverse(direction.z));
+
+            struct StackEntry
+            {
+                uint32_t node;
+                float enter;
+            };
+
+            float closest = maxLength;
+
+            float rootEnter = 0.0f;
+            if (!IntersectRayBox(origin, invDir, m_nodes[m_root].box, extents, closest, rootEnter))
+                return ret;
+
+            InplaceArray<StackEntry, 128> stack;
+            stack.pushBack({ m_root, rootEnter });
+
+            while (!stack.empty())
+            {
+                const auto entry = stack.back();
+                stack.popBack();
+
+                // something closer was found after this node was visited
+                if (entry.enter > closest)
+                    continue;
+
+                const auto& node = m_nodes[entry.node];
+                if (node.isLeaf())
+                {
+                    float boxDistance = 0.0f;
+                    if (!IntersectRayBox(origin, invDir, node.tightBox, extents, closest, boxDistance))
+                        continue;
+
+                    const auto distance = hitFunc ? hitFunc(entry.node, boxDistance) : boxDistance;
+                    if (distance >= 0.0f && distance <= closest)
+                    {
+                        closest = distance;
+                        ret.proxy = entry.node;
+                        ret.distance = distance;
+                    }
+                }
+                else
+                {
+                    float enter1 = 0.0f, enter2 = 0.0f;
+                    const auto hit1 = IntersectRayBox(origin, invDir, m_nodes[node.child1].box, extents, closest, enter1);
+                    const auto hit2 = IntersectRayBox(origin, invDir, m_nodes[node.child2].box, extents, closest, enter2);
+
+                    // visit the closer child first so the distance is clipped sooner
+                    if (hit1 && hit2)
+                    {
+                        if (enter1 < enter2)
+                        {
+                            stack.pushBack({ node.child2, enter2 });
+                            stack.pushBack({ node.child1, enter1 });
+                        }
+                        else
+                        {
+                            stack.pushBack({ node.child1, enter1 });
+                            stack.pushBack({ node.child2, enter2 });
+                        }
+                    }
+                    else if (hit1)
+                    {
+                        stack.pushBack({ node.child1, enter1 });
+                    }
+                    else if (hit2)
+                    {
+                        stack.pushBack({ node.child2, enter2 });
+                    }
+                }
+            }
+
+            return ret;
+        }
+
+        DynamicTreeHit DynamicTree::castRay(const DynamicTreeRay& ray, const THitFunc& hitFunc) const
+        {
+            return castInternal(ray.origin, ray.direction, ray.maxLength, Vector3::ZERO(), hitFunc);
+        }
+
+        DynamicTreeHit DynamicTree::castBox(const DynamicTreeSweep& sweep, const THitFunc& hitFunc) const
+        {
+            // sweeping a box against a box is the same as casting the center against box enlarged by the extents
+            return castInternal(sweep.box.center(), sweep.direction, sweep.maxLength, sweep.box.extents(), hitFunc);
+        }
+
+        //---
+
+        void DynamicTree::castRays(const DynamicTreeRay* rays, uint32_t numRays, DynamicTreeHit* outHits) const
+        {
+            PC_SCOPE_LVL1(DynamicTreeCastRays);
+
+            const auto numJobs = (numRays + QUERIES_PER_JOB - 1) / QUERIES_PER_JOB;
+            const auto func = [this, rays, numRays, outHits](uint32_t jobIndex)
+            {
+                const auto first = jobIndex * QUERIES_PER_JOB;
+                const auto last = std::min(first + QUERIES_PER_JOB, numRays);
+                for (uint32_t i = first; i < last; ++i)
+                    outHits[i] = castRay(rays[i]);
+            };
+
+            if (numJobs > 1)
+                RunFiberLoop("DynamicTreeCastRays", numJobs, -1, func);
+            else if (numJobs == 1)
+                func(0);
+        }
+
+        void DynamicTree::castBoxes(const DynamicTreeSweep* sweeps, uint32_t numSweeps, DynamicTreeHit* outHits) const
+        {
+            PC_SCOPE_LVL1(DynamicTreeCastBoxes);
+
+            const auto numJobs = (numSweeps + QUERIES_PER_JOB - 1) / QUERIES_PER_JOB;
+            const auto func = [this, sweeps, numSweeps, outHits](uint32_t jobIndex)
+            {
+                const auto first = jobIndex * QUERIES_PER_JOB;
+                const auto last = std::min(first + QUERIES_PER_JOB, numSweeps);
+                for (uint32_t i = first; i < last; ++i)
+                    outHits[i] = castBox(sweeps[i]);
+            };
+
+            if (numJobs > 1)
+                RunFiberLoop("DynamicTreeCastBoxes", numJobs, -1, func);
+            else if (numJobs == 1)
+                func(0);
+        }
+
+        void DynamicTree::queryOverlaps(const Box* boxes, uint32_t numBoxes, Array<uint32_t>* outProxies) const
+        {
+            PC_SCOPE_LVL1(DynamicTreeQueryOverlaps);
+
+            const auto numJobs = (numBoxes + QUERIES_PER_JOB - 1) / QUERIES_PER_JOB;
+            const auto func = [this, boxes, numBoxes, outProxies](uint32_t jobIndex)
+            {
+                const auto first = jobIndex * QUERIES_PER_JOB;
+                const auto last = std::min(first + QUERIES_PER_JOB, numBoxes);
+                for (uint32_t i = first; i < last; ++i)
+                {
+                    auto& output = outProxies[i];
+                    output.reset();
+                    queryOverlap(boxes[i], [&output](uint32_t proxy) { output.pushBack(proxy); return false; });
+                }
+            };
+
+            if (numJobs > 1)
+                RunFiberLoop("DynamicTreeQueryOverlaps", numJobs, -1, func);
+            else if (numJobs == 1)
+                func(0);
+        }
+
+        //---
+
+        uint32_t DynamicTree::validateNode(uint32_t index, uint32_t parent, bool& outValid) const
+        {
+            const auto& node = m_nodes[index];
+            if (node.parent != parent)
+            {
+                TRACE_ERROR("DynamicTree: node {} has invalid parent {}, expected {}", index, node.parent, parent);
+                outValid = false;
+            }
+
+            if (node.isLeaf())
+            {
+                if (node.height != 0 || node.child2 != INDEX_MAX)
+                {
+                    TRACE_ERROR("DynamicTree: leaf {} has invalid structure", index);
+                    outValid = false;
+                }
+
+                if (!node.box.contains(node.tightBox))
+                {
+                    TRACE_ERROR("DynamicTree: leaf {} fat box does not contain the proxy box", index);
+                    outValid = false;
+                }
+
+                return 1;
+            }
+
+            const auto& child1 = m_nodes[node.child1];
+            const auto& child2 = m_nodes[node.child2];
+
+            if (node.height != 1 + std::max(child1.height, child2.height))
+            {
+                TRACE_ERROR("DynamicTree: node {} has invalid height", index);
+                outValid = false;
+            }
+
+            if (std::abs(child1.height - child2.height) > 1)
+            {
+                TRACE_ERROR("DynamicTree: node {} is not balanced", index);
+                outValid = false;
+            }
+
+            if (!node.box.contains(child1.box) || !node.box.contains(child2.box))
+            {
+                TRACE_ERROR("DynamicTree: node {} box does not contain the children", index);
+                outValid = false;
+            }
+
+            return validateNode(node.child1, index, outValid) + validateNode(node.child2, index, outValid);
+        }
+
+        bool DynamicTree::validate() const
+        {
+            if (m_root == INDEX_MAX)
+                return m_numProxies == 0;
+
+            bool valid = true;
+            const auto numLeaves = validateNode(m_root, INDEX_MAX, valid);
+            if (numLeaves != m_numProxies)
+            {
+                TRACE_ERROR("DynamicTree: found {} leaves but there are {} proxies", numLeaves, m_numProxies);
+                valid = false;
+            }
+
+            return valid;
+        }
+
+        //---
+
+    } // shape
+} // base
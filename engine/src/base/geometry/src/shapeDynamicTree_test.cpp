@@ -0,0 +1,376 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "shapeDynamicTree.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/math/include/randomFast.h"
+#include "base/system/include/timedScope.h"
+
+DECLARE_TEST_FILE(DynamicTree);
+
+using namespace base;
+
+namespace tests
+{
+    static Vector3 RandomPoint(FastGenerator& rand, float range)
+    {
+        return Vector3((rand.nextFloat() * 2.0f - 1.0f) * range, (rand.nextFloat() * 2.0f - 1.0f) * range, (rand.nextFloat() * 2.0f - 1.0f) * range);
+    }
+
+    static Box RandomBox(FastGenerator& rand, float range, float maxSize)
+    {
+        const auto center = RandomPoint(rand, range);
+        const auto halfSize = Vector3(0.1f + rand.nextFloat() * maxSize, 0.1f + rand.nextFloat() * maxSize, 0.1f + rand.nextFloat() * maxSize);
+        return Box(center - halfSize, center + halfSize);
+    }
+
+    static Vector3 RandomDirection(FastGenerator& rand)
+    {
+        auto dir = RandomPoint(rand, 1.0f);
+        if (dir.length() < 0.001f)
+            dir = Vector3::EX();
+        return dir.normalized();
+    }
+
+    // reference results computed without the tree
+    static void CollectOverlapsBruteForce(const Array<Box>& boxes, const Array<uint32_t>& proxies, const Box& query, Array<uint32_t>& outProxies)
+    {
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+            if (proxies[i] != INDEX_MAX && boxes[i].touches(query))
+                outProxies.pushBack(proxies[i]);
+    }
+
+    static float CastRayBruteForce(const Array<Box>& boxes, const Array<uint32_t>& proxies, const shape::DynamicTreeRay& ray)
+    {
+        float closest = -1.0f;
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            if (proxies[i] == INDEX_MAX)
+                continue;
+
+            float distance = 0.0f;
+            if (boxes[i].contains(ray.origin))
+            {
+                closest = 0.0f;
+                continue;
+            }
+
+            // box faces
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const auto dir = ray.direction[axis];
+                if (dir == 0.0f)
+                    continue;
+
+                const auto plane = (dir > 0.0f) ? boxes[i].min[axis] : boxes[i].max[axis];
+                distance = (plane - ray.origin[axis]) / dir;
+                if (distance < 0.0f || distance > ray.maxLength)
+                    continue;
+
+                const auto pos = ray.origin + ray.direction * distance;
+                if (boxes[i].extruded(0.001f).contains(pos) && (closest < 0.0f || distance < closest))
+                    closest = distance;
+            }
+        }
+
+        return closest;
+    }
+
+} // tests
+
+TEST(DynamicTree, Empty)
+{
+    shape::DynamicTree tree;
+    EXPECT_EQ(0, tree.numProxies());
+    EXPECT_TRUE(tree.validate());
+
+    shape::DynamicTreeRay ray;
+    ray.direction = Vector3::EX();
+    EXPECT_EQ(INDEX_MAX, tree.castRay(ray).proxy);
+
+    uint32_t numFound = 0;
+    tree.queryOverlap(Box(Vector3(-100, -100, -100), Vector3(100, 100, 100)), [&numFound](uint32_t) { numFound += 1; return false; });
+    EXPECT_EQ(0, numFound);
+}
+
+TEST(DynamicTree, CreateDestroyKeepsTreeValid)
+{
+    FastGenerator rand;
+
+    shape::DynamicTree tree;
+    Array<uint32_t> proxies;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        proxies.pushBack(tree.createProxy(tests::RandomBox(rand, 100.0f, 2.0f), i));
+        EXPECT_EQ(i, tree.userData(proxies.back()));
+    }
+
+    EXPECT_EQ(1000, tree.numProxies());
+    EXPECT_TRUE(tree.validate());
+
+    // balanced tree, with some slack for the rotations being local
+    EXPECT_LE(tree.height(), 30);
+
+    for (uint32_t i = 0; i < proxies.size(); i += 2)
+        tree.destroyProxy(proxies[i]);
+
+    EXPECT_EQ(500, tree.numProxies());
+    EXPECT_TRUE(tree.validate());
+
+    // freed proxies are reused
+    for (uint32_t i = 0; i < 500; ++i)
+        EXPECT_LT(tree.createProxy(tests::RandomBox(rand, 100.0f, 2.0f)), 2000);
+
+    EXPECT_TRUE(tree.validate());
+
+    tree.clear();
+    EXPECT_EQ(0, tree.numProxies());
+    EXPECT_TRUE(tree.validate());
+}
+
+TEST(DynamicTree, SmallMovesDoNotModifyTree)
+{
+    shape::DynamicTree tree(0.5f);
+
+    const auto box = Box(Vector3(-1, -1, -1), Vector3(1, 1, 1));
+    const auto proxy = tree.createProxy(box);
+
+    // moves inside the margin only update the exact box
+    EXPECT_FALSE(tree.moveProxy(proxy, box + Vector3(0.2f, 0.0f, 0.0f)));
+    EXPECT_EQ(box + Vector3(0.2f, 0.0f, 0.0f), tree.box(proxy));
+
+    // moves outside of it reinsert the proxy, with the fat box extended in the direction of the movement
+    const auto displacement = Vector3(5.0f, 0.0f, 0.0f);
+    EXPECT_TRUE(tree.moveProxy(proxy, box + displacement, displacement));
+    EXPECT_TRUE(tree.fatBox(proxy).contains(box + displacement * 2.0f));
+    EXPECT_TRUE(tree.validate());
+}
+
+TEST(DynamicTree, OverlapMatchesBruteForce)
+{
+    FastGenerator rand;
+
+    shape::DynamicTree tree;
+    Array<Box> boxes;
+    Array<uint32_t> proxies;
+    for (uint32_t i = 0; i < 2000; ++i)
+    {
+        boxes.pushBack(tests::RandomBox(rand, 100.0f, 3.0f));
+        proxies.pushBack(tree.createProxy(boxes.back()));
+    }
+
+    // move some around and remove some
+    for (uint32_t i = 0; i < boxes.size(); i += 3)
+    {
+        const auto delta = tests::RandomPoint(rand, 5.0f);
+        boxes[i] = boxes[i] + delta;
+        tree.moveProxy(proxies[i], boxes[i], delta);
+    }
+
+    for (uint32_t i = 1; i < boxes.size(); i += 7)
+    {
+        tree.destroyProxy(proxies[i]);
+        proxies[i] = INDEX_MAX;
+    }
+
+    ASSERT_TRUE(tree.validate());
+
+    Array<Box> queries;
+    for (uint32_t i = 0; i < 200; ++i)
+        queries.pushBack(tests::RandomBox(rand, 100.0f, 10.0f));
+
+    Array<Array<uint32_t>> batchedResults;
+    batchedResults.resize(queries.size());
+    tree.queryOverlaps(queries.typedData(), queries.size(), batchedResults.typedData());
+
+    for (uint32_t i = 0; i < queries.size(); ++i)
+    {
+        Array<uint32_t> expected;
+        tests::CollectOverlapsBruteForce(boxes, proxies, queries[i], expected);
+
+        Array<uint32_t> found;
+        tree.queryOverlap(queries[i], [&found](uint32_t proxy) { found.pushBack(proxy); return false; });
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        std::sort(batchedResults[i].begin(), batchedResults[i].end());
+
+        EXPECT_EQ(expected, found);
+        EXPECT_EQ(expected, batchedResults[i]);
+    }
+}
+
+TEST(DynamicTree, RayMatchesBruteForce)
+{
+    FastGenerator rand;
+
+    shape::DynamicTree tree;
+    Array<Box> boxes;
+    Array<uint32_t> proxies;
+    for (uint32_t i = 0; i < 2000; ++i)
+    {
+        boxes.pushBack(tests::RandomBox(rand, 100.0f, 3.0f));
+        proxies.pushBack(tree.createProxy(boxes.back()));
+    }
+
+    Array<shape::DynamicTreeRay> rays;
+    for (uint32_t i = 0; i < 500; ++i)
+    {
+        auto& ray = rays.emplaceBack();
+        ray.origin = tests::RandomPoint(rand, 120.0f);
+        ray.direction = tests::RandomDirection(rand);
+        ray.maxLength = (i & 1) ? 50.0f : VERY_LARGE_FLOAT;
+    }
+
+    // axis aligned rays take the special path in the slab test
+    {
+        auto& ray = rays.emplaceBack();
+        ray.origin = Vector3(-150.0f, 0.0f, 0.0f);
+        ray.direction = Vector3::EX();
+    }
+
+    Array<shape::DynamicTreeHit> batchedHits;
+    batchedHits.resize(rays.size());
+    tree.castRays(rays.typedData(), rays.size(), batchedHits.typedData());
+
+    for (uint32_t i = 0; i < rays.size(); ++i)
+    {
+        const auto expected = tests::CastRayBruteForce(boxes, proxies, rays[i]);
+        const auto hit = tree.castRay(rays[i]);
+
+        if (expected < 0.0f)
+        {
+            EXPECT_EQ(INDEX_MAX, hit.proxy);
+            EXPECT_EQ(INDEX_MAX, batchedHits[i].proxy);
+        }
+        else
+        {
+            ASSERT_NE(INDEX_MAX, hit.proxy);
+            EXPECT_NEAR(expected, hit.distance, 0.01f);
+            EXPECT_EQ(hit.proxy, batchedHits[i].proxy);
+        }
+    }
+}
+
+TEST(DynamicTree, SweepHitsBoxInTheWay)
+{
+    shape::DynamicTree tree;
+    const auto wall = tree.createProxy(Box(Vector3(10, -5, -5), Vector3(11, 5, 5)));
+    tree.createProxy(Box(Vector3(20, -5, -5), Vector3(21, 5, 5)));
+
+    shape::DynamicTreeSweep sweep;
+    sweep.box = Box(Vector3(-1, -1, -1), Vector3(1, 1, 1));
+    sweep.direction = Vector3::EX();
+
+    const auto hit = tree.castBox(sweep);
+    EXPECT_EQ(wall, hit.proxy);
+    EXPECT_NEAR(9.0f, hit.distance, 0.001f);
+
+    // box passes above the wall
+    sweep.box = sweep.box + Vector3(0, 0, 7);
+    EXPECT_EQ(INDEX_MAX, tree.castBox(sweep).proxy);
+
+    // custom filter can skip proxies
+    sweep.box = sweep.box - Vector3(0, 0, 7);
+    const auto filteredHit = tree.castBox(sweep, [wall](uint32_t proxy, float distance) { return (proxy == wall) ? -1.0f : distance; });
+    EXPECT_NE(wall, filteredHit.proxy);
+    EXPECT_NEAR(19.0f, filteredHit.distance, 0.001f);
+}
+
+TEST(DynamicTree, DISABLED_MovingBoxesBenchmark)
+{
+    static const uint32_t NUM_BOXES = 100000;
+    static const uint32_t NUM_QUERIES = 10000;
+    static const uint32_t NUM_FRAMES = 100;
+    static const float WORLD_SIZE = 1000.0f;
+
+    FastGenerator rand;
+
+    shape::DynamicTree tree;
+    Array<Box> boxes;
+    Array<Vector3> velocities;
+    Array<uint32_t> proxies;
+    boxes.reserve(NUM_BOXES);
+    velocities.reserve(NUM_BOXES);
+    proxies.reserve(NUM_BOXES);
+
+    {
+        ScopeTimer timer;
+        for (uint32_t i = 0; i < NUM_BOXES; ++i)
+        {
+            boxes.pushBack(tests::RandomBox(rand, WORLD_SIZE, 2.0f));
+            velocities.pushBack(tests::RandomPoint(rand, 0.2f));
+            proxies.pushBack(tree.createProxy(boxes.back(), i));
+        }
+
+        TRACE_INFO("Inserted {} boxes in {}, tree height {}", NUM_BOXES, TimeInterval(timer.timeElapsed()), tree.height());
+    }
+
+    Array<shape::DynamicTreeRay> rays;
+    Array<Box> queryBoxes;
+    Array<shape::DynamicTreeHit> hits;
+    Array<Array<uint32_t>> overlaps;
+    rays.resize(NUM_QUERIES);
+    queryBoxes.resize(NUM_QUERIES);
+    hits.resize(NUM_QUERIES);
+    overlaps.resize(NUM_QUERIES);
+
+    double moveTime = 0.0;
+    double rayTime = 0.0;
+    double overlapTime = 0.0;
+    uint64_t numReinserted = 0;
+    uint64_t numHits = 0;
+    uint64_t numOverlaps = 0;
+
+    for (uint32_t frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        {
+            ScopeTimer timer;
+            for (uint32_t i = 0; i < NUM_BOXES; ++i)
+            {
+                boxes[i] = boxes[i] + velocities[i];
+                numReinserted += tree.moveProxy(proxies[i], boxes[i], velocities[i]);
+            }
+            moveTime += timer.timeElapsed();
+        }
+
+        for (uint32_t i = 0; i < NUM_QUERIES; ++i)
+        {
+            rays[i].origin = tests::RandomPoint(rand, WORLD_SIZE);
+            rays[i].direction = tests::RandomDirection(rand);
+            rays[i].maxLength = 100.0f;
+            queryBoxes[i] = tests::RandomBox(rand, WORLD_SIZE, 10.0f);
+        }
+
+        {
+            ScopeTimer timer;
+            tree.castRays(rays.typedData(), NUM_QUERIES, hits.typedData());
+            rayTime += timer.timeElapsed();
+        }
+
+        {
+            ScopeTimer timer;
+            tree.queryOverlaps(queryBoxes.typedData(), NUM_QUERIES, overlaps.typedData());
+            overlapTime += timer.timeElapsed();
+        }
+
+        for (uint32_t i = 0; i < NUM_QUERIES; ++i)
+        {
+            numHits += (hits[i].proxy != INDEX_MAX);
+            numOverlaps += overlaps[i].size();
+        }
+    }
+
+    TRACE_INFO("Moved {} boxes per frame in {} per frame, {} reinserts per frame, tree height {}", NUM_BOXES, TimeInterval(moveTime / NUM_FRAMES), numReinserted / NUM_FRAMES, tree.height());
+    TRACE_INFO("Cast {} rays per frame in {} per frame, {} hits per frame", NUM_QUERIES, TimeInterval(rayTime / NUM_FRAMES), numHits / NUM_FRAMES);
+    TRACE_INFO("Tested {} boxes per frame in {} per frame, {} overlaps per frame", NUM_QUERIES, TimeInterval(overlapTime / NUM_FRAMES), numOverlaps / NUM_FRAMES);
+
+    EXPECT_TRUE(tree.validate());
+}
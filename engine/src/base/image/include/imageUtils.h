@@ -72,10 +72,10 @@ namespace base
         ///----------------------------
 
         /// Unpack image into a floating point array
-        extern BASE_IMAGE_API void UnpackIntoFloats(const ImageView& src, const ImageView& dest);
+        extern BASE_IMAGE_API void UnpackIntoFloats(const ImageView& src, const ImageView& dest, ColorSpace space = ColorSpace::Linear);
 
         /// Pack image into from floating point array
-        extern BASE_IMAGE_API void PackFromFloats(const ImageView& src, const ImageView& dest);
+        extern BASE_IMAGE_API void PackFromFloats(const ImageView& src, const ImageView& dest, ColorSpace space = ColorSpace::Linear);
 
         ///----------------------------
 
@@ -107,6 +107,15 @@ namespace base
 
         ///----------------------------
 
+        /// Enable/disable the vectorized and multi-threaded paths of the image processing functions (enabled by default)
+        /// NOTE: results are bit exact with the scalar paths, the switch exists for testing and profiling
+        extern BASE_IMAGE_API void EnableFastImageKernels(bool enabled);
+
+        /// Are the vectorized and multi-threaded paths enabled ?
+        extern BASE_IMAGE_API bool AreFastImageKernelsEnabled();
+
+        ///----------------------------
+
     } // image
 } // base
 
@@ -0,0 +1,405 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: image #]
+***/
+
+#include "build.h"
+#pragma hdrstop
+
+#include "imageKernels.h"
+
+namespace base
+{
+    namespace image
+    {
+        namespace prv
+        {
+
+            ///----------------------------
+
+            // constants from Float16Helper, replicated here since they are private there
+            static const int F16_Shift = 13;
+            static const int F16_ShiftSign = 16;
+            static const int32_t F16_InfN = 0x7F800000; // flt32 infinity
+            static const int32_t F16_MaxN = 0x477FE000; // max flt16 normal as a flt32
+            static const int32_t F16_MinN = 0x38800000; // min flt16 normal as a flt32
+            static const int32_t F16_SignN = (int32_t)0x80000000; // flt32 sign bit
+            static const int32_t F16_InfC = F16_InfN >> F16_Shift;
+            static const int32_t F16_NanN = (F16_InfC + 1) << F16_Shift; // minimum flt16 nan as a flt32
+            static const int32_t F16_MaxC = F16_MaxN >> F16_Shift;
+            static const int32_t F16_MinC = F16_MinN >> F16_Shift;
+            static const int32_t F16_SignC = F16_SignN >> F16_ShiftSign; // flt16 sign bit
+            static const int32_t F16_MulN = 0x52000000; // (1 << 23) / minN
+            static const int32_t F16_MulC = 0x33800000; // minN / (1 << (23 - shift))
+            static const int32_t F16_SubC = 0x003FF; // max flt32 subnormal down shifted
+            static const int32_t F16_NorC = 0x00400; // min flt32 normal down shifted
+            static const int32_t F16_MaxD = F16_InfC - F16_MaxC - 1;
+            static const int32_t F16_MinD = F16_MinC - F16_SubC - 1;
+
+            ///----------------------------
+
+            static INLINE void AlphaWeightPixelScalar(const float* a, const float* b, float* dest)
+            {
+                const auto weight = a[3] + b[3];
+                if (weight > 0.00001f)
+                {
+                    const auto inv = 1.0f / weight;
+                    dest[0] = ((a[0] * a[3]) + (b[0] * b[3])) * inv;
+                    dest[1] = ((a[1] * a[3]) + (b[1] * b[3])) * inv;
+                    dest[2] = ((a[2] * a[3]) + (b[2] * b[3])) * inv;
+                    dest[3] = weight * 0.5f;
+                }
+                else
+                {
+                    dest[0] = 0.0f;
+                    dest[1] = 0.0f;
+                    dest[2] = 0.0f;
+                    dest[3] = 0.0f;
+                }
+            }
+
+#ifdef PLATFORM_SSE2
+
+            static INLINE __m128i Select(__m128i mask, __m128i a, __m128i b)
+            {
+                return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+            }
+
+            // float -> int32 with the (int)(scale * (double)x) semantic of the scalar code
+            static INLINE __m128i ScaleTruncateDouble(__m128 v, __m128d scale)
+            {
+                const auto lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(v), scale));
+                const auto hi = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), scale));
+                return _mm_unpacklo_epi64(lo, hi);
+            }
+
+            // keep the lower 16 bits of each element (as the (uint16_t) cast does) and pack them
+            static INLINE __m128i Narrow16(__m128i a, __m128i b)
+            {
+                a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+                b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+                return _mm_packs_epi32(a, b);
+            }
+
+            static INLINE __m128 DecompressHalf(__m128i v)
+            {
+                auto sign = _mm_and_si128(v, _mm_set1_epi32(F16_SignC));
+                v = _mm_xor_si128(v, sign);
+                sign = _mm_slli_epi32(sign, F16_ShiftSign);
+
+                const auto subMask = _mm_cmpgt_epi32(v, _mm_set1_epi32(F16_SubC));
+                v = Select(subMask, _mm_add_epi32(v, _mm_set1_epi32(F16_MinD)), v);
+
+                const auto maxMask = _mm_cmpgt_epi32(v, _mm_set1_epi32(F16_MaxC));
+                v = Select(maxMask, _mm_add_epi32(v, _mm_set1_epi32(F16_MaxD)), v);
+
+                const auto s = _mm_castps_si128(_mm_mul_ps(_mm_castsi128_ps(_mm_set1_epi32(F16_MulC)), _mm_cvtepi32_ps(v)));
+                const auto norMask = _mm_cmpgt_epi32(_mm_set1_epi32(F16_NorC), v);
+                v = _mm_slli_epi32(v, F16_Shift);
+                v = Select(norMask, s, v);
+                return _mm_castsi128_ps(_mm_or_si128(v, sign));
+            }
+
+            static INLINE __m128i CompressHalf(__m128 f)
+            {
+                auto v = _mm_castps_si128(f);
+                auto sign = _mm_and_si128(v, _mm_set1_epi32(F16_SignN));
+                v = _mm_xor_si128(v, sign);
+                sign = _mm_srli_epi32(sign, F16_ShiftSign);
+
+                const auto s = _mm_cvttps_epi32(_mm_mul_ps(_mm_castsi128_ps(_mm_set1_epi32(F16_MulN)), _mm_castsi128_ps(v)));
+                v = Select(_mm_cmpgt_epi32(_mm_set1_epi32(F16_MinN), v), s, v);
+
+                const auto infMask = _mm_and_si128(_mm_cmpgt_epi32(_mm_set1_epi32(F16_InfN), v), _mm_cmpgt_epi32(v, _mm_set1_epi32(F16_MaxN)));
+                v = Select(infMask, _mm_set1_epi32(F16_InfN), v);
+
+                const auto nanMask = _mm_and_si128(_mm_cmpgt_epi32(_mm_set1_epi32(F16_NanN), v), _mm_cmpgt_epi32(v, _mm_set1_epi32(F16_InfN)));
+                v = Select(nanMask, _mm_set1_epi32(F16_NanN), v);
+
+                v = _mm_srli_epi32(v, F16_Shift);
+                v = Select(_mm_cmpgt_epi32(v, _mm_set1_epi32(F16_MaxC)), _mm_sub_epi32(v, _mm_set1_epi32(F16_MaxD)), v);
+                v = Select(_mm_cmpgt_epi32(v, _mm_set1_epi32(F16_SubC)), _mm_sub_epi32(v, _mm_set1_epi32(F16_MinD)), v);
+                return _mm_or_si128(v, sign);
+            }
+
+            static INLINE __m128 AlphaWeightPixel(__m128 pa, __m128 pb)
+            {
+                const auto aa = _mm_shuffle_ps(pa, pa, _MM_SHUFFLE(3, 3, 3, 3));
+                const auto ab = _mm_shuffle_ps(pb, pb, _MM_SHUFFLE(3, 3, 3, 3));
+
+                const auto weight = _mm_add_ps(aa, ab);
+                const auto color = _mm_add_ps(_mm_mul_ps(pa, aa), _mm_mul_ps(pb, ab));
+                const auto scaledColor = _mm_mul_ps(color, _mm_div_ps(_mm_set1_ps(1.0f), weight));
+                const auto scaledWeight = _mm_mul_ps(weight, _mm_set1_ps(0.5f));
+
+                // rgb is weighted by alpha, alpha itself is averaged, everything is zeroed if there's no weight
+                const auto alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+                const auto ret = _mm_or_ps(_mm_andnot_ps(alphaLane, scaledColor), _mm_and_ps(alphaLane, scaledWeight));
+                return _mm_and_ps(ret, _mm_cmpgt_ps(weight, _mm_set1_ps(0.00001f)));
+            }
+
+#endif
+
+            ///----------------------------
+
+            void UnpackLineUint8(const uint8_t* src, float* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                const auto zero = _mm_setzero_si128();
+                const auto scale = _mm_set1_ps(255.0f);
+                for (; i + 16 <= count; i += 16)
+                {
+                    const auto bytes = _mm_loadu_si128((const __m128i*)(src + i));
+                    const auto lo = _mm_unpacklo_epi8(bytes, zero);
+                    const auto hi = _mm_unpackhi_epi8(bytes, zero);
+                    _mm_storeu_ps(dest + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+                    _mm_storeu_ps(dest + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+                    _mm_storeu_ps(dest + i + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+                    _mm_storeu_ps(dest + i + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = src[i] / 255.0f;
+            }
+
+            void UnpackLineUint16(const uint16_t* src, float* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                const auto zero = _mm_setzero_si128();
+                const auto scale = _mm_set1_ps(65535.0f);
+                for (; i + 8 <= count; i += 8)
+                {
+                    const auto words = _mm_loadu_si128((const __m128i*)(src + i));
+                    _mm_storeu_ps(dest + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), scale));
+                    _mm_storeu_ps(dest + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), scale));
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = src[i] / 65535.0f;
+            }
+
+            void UnpackLineFloat16(const uint16_t* src, float* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                const auto zero = _mm_setzero_si128();
+                for (; i + 8 <= count; i += 8)
+                {
+                    const auto words = _mm_loadu_si128((const __m128i*)(src + i));
+                    _mm_storeu_ps(dest + i + 0, DecompressHalf(_mm_unpacklo_epi16(words, zero)));
+                    _mm_storeu_ps(dest + i + 4, DecompressHalf(_mm_unpackhi_epi16(words, zero)));
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = Float16Helper::Decompress(src[i]);
+            }
+
+            ///----------------------------
+
+            void PackLineUint8(const float* src, uint8_t* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                const auto scale = _mm_set1_pd(255.0);
+                for (; i + 16 <= count; i += 16)
+                {
+                    const auto a = ScaleTruncateDouble(_mm_loadu_ps(src + i + 0), scale);
+                    const auto b = ScaleTruncateDouble(_mm_loadu_ps(src + i + 4), scale);
+                    const auto c = ScaleTruncateDouble(_mm_loadu_ps(src + i + 8), scale);
+                    const auto d = ScaleTruncateDouble(_mm_loadu_ps(src + i + 12), scale);
+
+                    // saturation in both packs gives exactly the clamp to 0-255
+                    const auto bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                    _mm_storeu_si128((__m128i*)(dest + i), bytes);
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = (uint8_t)std::clamp<int>((int)(255.0 * src[i]), 0, 255);
+            }
+
+            void PackLineUint16(const float* src, uint16_t* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                const auto scale = _mm_set1_pd(65535.0);
+                const auto zero = _mm_setzero_si128();
+                const auto maxValue = _mm_set1_epi32(65535);
+                const auto bias32 = _mm_set1_epi32(32768);
+                const auto bias16 = _mm_set1_epi16((short)0x8000);
+                for (; i + 8 <= count; i += 8)
+                {
+                    auto a = ScaleTruncateDouble(_mm_loadu_ps(src + i + 0), scale);
+                    auto b = ScaleTruncateDouble(_mm_loadu_ps(src + i + 4), scale);
+
+                    a = _mm_and_si128(a, _mm_cmpgt_epi32(a, zero));
+                    b = _mm_and_si128(b, _mm_cmpgt_epi32(b, zero));
+                    a = Select(_mm_cmpgt_epi32(a, maxValue), maxValue, a);
+                    b = Select(_mm_cmpgt_epi32(b, maxValue), maxValue, b);
+
+                    // no unsigned 32->16 pack in SSE2, bias the values into the signed range
+                    const auto words = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32)), bias16);
+                    _mm_storeu_si128((__m128i*)(dest + i), words);
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = (uint16_t)std::clamp<int>((int)(65535.0 * src[i]), 0, 65535);
+            }
+
+            void PackLineFloat16(const float* src, uint16_t* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                for (; i + 8 <= count; i += 8)
+                {
+                    const auto a = CompressHalf(_mm_loadu_ps(src + i + 0));
+                    const auto b = CompressHalf(_mm_loadu_ps(src + i + 4));
+                    _mm_storeu_si128((__m128i*)(dest + i), Narrow16(a, b));
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = Float16Helper::Compress(src[i]);
+            }
+
+            void PackLineLookup65536(const float* src, uint8_t* dest, uint32_t count, const uint8_t* table)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                const auto scale = _mm_set1_pd(65536.0);
+                const auto zero = _mm_setzero_si128();
+                const auto maxValue = _mm_set1_epi32(65536);
+                for (; i + 4 <= count; i += 4)
+                {
+                    auto a = ScaleTruncateDouble(_mm_loadu_ps(src + i), scale);
+                    a = _mm_and_si128(a, _mm_cmpgt_epi32(a, zero));
+                    a = Select(_mm_cmpgt_epi32(a, maxValue), maxValue, a);
+
+                    // no gather in SSE2, the table lookup itself stays scalar
+                    alignas(16) int32_t index[4];
+                    _mm_store_si128((__m128i*)index, a);
+                    dest[i + 0] = table[index[0]];
+                    dest[i + 1] = table[index[1]];
+                    dest[i + 2] = table[index[2]];
+                    dest[i + 3] = table[index[3]];
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = table[std::clamp<int>((int)(65536.0 * src[i]), 0, 65536)];
+            }
+
+            ///----------------------------
+
+            void DownsampleLineAverage(const float* a, const float* b, float* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                const auto half = _mm_set1_ps(0.5f);
+                for (; i + 8 <= count; i += 8)
+                {
+                    _mm_storeu_ps(dest + i + 0, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(a + i + 0), _mm_loadu_ps(b + i + 0)), half));
+                    _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)), half));
+                }
+#endif
+
+                for (; i < count; ++i)
+                    dest[i] = (a[i] + b[i]) * 0.5f;
+            }
+
+            void DownsampleLineAlphaWeight(const float* a, const float* b, float* dest, uint32_t count)
+            {
+                uint32_t i = 0;
+
+#ifdef PLATFORM_SSE2
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_ps(dest + i, AlphaWeightPixel(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#endif
+
+                for (; i < count; i += 4)
+                    AlphaWeightPixelScalar(a + i, b + i, dest + i);
+            }
+
+            void DownsampleLinePairs(const float* src, float* dest, uint32_t destPixelCount, uint32_t channels, bool alphaWeight)
+            {
+                uint32_t i = 0;
+
+                if (alphaWeight)
+                {
+                    DEBUG_CHECK_EX(channels == 4, "Alpha weighting requires RGBA pixels");
+
+#ifdef PLATFORM_SSE2
+                    for (; i < destPixelCount; ++i)
+                        _mm_storeu_ps(dest + i * 4, AlphaWeightPixel(_mm_loadu_ps(src + i * 8), _mm_loadu_ps(src + i * 8 + 4)));
+#endif
+
+                    for (; i < destPixelCount; ++i)
+                        AlphaWeightPixelScalar(src + i * 8, src + i * 8 + 4, dest + i * 4);
+                    return;
+                }
+
+#ifdef PLATFORM_SSE2
+                const auto half = _mm_set1_ps(0.5f);
+                if (channels == 4)
+                {
+                    for (; i < destPixelCount; ++i)
+                        _mm_storeu_ps(dest + i * 4, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(src + i * 8), _mm_loadu_ps(src + i * 8 + 4)), half));
+                }
+                else if (channels == 2)
+                {
+                    // [a0 a1 b0 b1] [c0 c1 d0 d1] -> [a b c d] + [a b c d]
+                    for (; i + 2 <= destPixelCount; i += 2)
+                    {
+                        const auto v0 = _mm_loadu_ps(src + i * 4);
+                        const auto v1 = _mm_loadu_ps(src + i * 4 + 4);
+                        const auto first = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 0, 1, 0));
+                        const auto second = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 2, 3, 2));
+                        _mm_storeu_ps(dest + i * 2, _mm_mul_ps(_mm_add_ps(first, second), half));
+                    }
+                }
+                else if (channels == 1)
+                {
+                    // even/odd split
+                    for (; i + 4 <= destPixelCount; i += 4)
+                    {
+                        const auto v0 = _mm_loadu_ps(src + i * 2);
+                        const auto v1 = _mm_loadu_ps(src + i * 2 + 4);
+                        const auto even = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+                        const auto odd = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+                        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_add_ps(even, odd), half));
+                    }
+                }
+#endif
+
+                for (; i < destPixelCount; ++i)
+                {
+                    const auto* a = src + (i * 2) * channels;
+                    const auto* b = a + channels;
+                    auto* write = dest + i * channels;
+                    for (uint32_t j = 0; j < channels; ++j)
+                        write[j] = (a[j] + b[j]) * 0.5f;
+                }
+            }
+
+            ///----------------------------
+
+        } // prv
+    } // image
+} // base
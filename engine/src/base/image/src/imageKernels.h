@@ -0,0 +1,58 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: image #]
+***/
+
+#pragma once
+
+namespace base
+{
+    namespace image
+    {
+        namespace prv
+        {
+
+            ///----------------------------
+
+            // Vectorized line kernels used by the image utilities
+            // NOTE: all kernels work on "count" of scalar elements (not pixels) and produce results that are bit exact with the scalar code
+            // NOTE: the scalar code in imageUtils.cpp is the reference, any change there must be reflected here
+
+            /// uint8 -> float, x / 255.0f
+            extern void UnpackLineUint8(const uint8_t* src, float* dest, uint32_t count);
+
+            /// uint16 -> float, x / 65535.0f
+            extern void UnpackLineUint16(const uint16_t* src, float* dest, uint32_t count);
+
+            /// half -> float, same bit-twiddling as Float16Helper::Decompress
+            extern void UnpackLineFloat16(const uint16_t* src, float* dest, uint32_t count);
+
+            /// float -> uint8, clamp((int)(255.0 * x), 0, 255)
+            extern void PackLineUint8(const float* src, uint8_t* dest, uint32_t count);
+
+            /// float -> uint16, clamp((int)(65535.0 * x), 0, 65535)
+            extern void PackLineUint16(const float* src, uint16_t* dest, uint32_t count);
+
+            /// float -> half, same bit-twiddling as Float16Helper::Compress
+            extern void PackLineFloat16(const float* src, uint16_t* dest, uint32_t count);
+
+            /// float -> uint8 through a lookup table indexed with clamp((int)(65536.0 * x), 0, 65536)
+            extern void PackLineLookup65536(const float* src, uint8_t* dest, uint32_t count, const uint8_t* table);
+
+            /// (a + b) * 0.5
+            extern void DownsampleLineAverage(const float* a, const float* b, float* dest, uint32_t count);
+
+            /// RGBA pixels averaged with weights from the alpha channel, count must be a multiple of 4
+            extern void DownsampleLineAlphaWeight(const float* a, const float* b, float* dest, uint32_t count);
+
+            /// merge pairs of neighbouring pixels in a single row, source must have 2*destPixelCount pixels
+            extern void DownsampleLinePairs(const float* src, float* dest, uint32_t destPixelCount, uint32_t channels, bool alphaWeight);
+
+            ///----------------------------
+
+        } // prv
+    } // image
+} // base
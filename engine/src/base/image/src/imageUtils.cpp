@@ -11,6 +11,9 @@
 
 #include "imageUtils.h"
 #include "imageView.h"
+#include "imageKernels.h"
+
+#include "base/fibers/include/fiberSystem.h"
 
 namespace base
 {
@@ -18,6 +21,50 @@ namespace base
     {
         //--
 
+        static std::atomic<bool> GFastImageKernels(true);
+
+        void EnableFastImageKernels(bool enabled)
+        {
+            GFastImageKernels = enabled;
+        }
+
+        bool AreFastImageKernelsEnabled()
+        {
+            return GFastImageKernels;
+        }
+
+        // images smaller than this (in elements) are not worth distributing to other fibers
+        static const uint64_t MIN_ELEMENTS_FOR_PARALLEL_PROCESSING = 1U << 18;
+
+        // target amount of elements processed by single job
+        static const uint64_t ELEMENTS_PER_JOB = 1U << 16;
+
+        typedef std::function<void(uint32_t firstRow, uint32_t numRows)> TRowRangeFunction;
+
+        // process all rows of an image (in all slices), rows are numbered as z*height+y
+        // for big images the rows are split into ranges and processed on fibers
+        static void ProcessRowRanges(const char* name, uint32_t numRows, uint64_t rowElementCount, const TRowRangeFunction& func)
+        {
+            if (!numRows)
+                return;
+
+            if (!GFastImageKernels || numRows < 2 || (numRows * rowElementCount) < MIN_ELEMENTS_FOR_PARALLEL_PROCESSING)
+            {
+                func(0, numRows);
+                return;
+            }
+
+            const auto rowsPerJob = (uint32_t)std::max<uint64_t>(1, ELEMENTS_PER_JOB / std::max<uint64_t>(1, rowElementCount));
+            const auto numJobs = (numRows + rowsPerJob - 1) / rowsPerJob;
+            RunFiberLoop(name, numJobs, -1, [rowsPerJob, numRows, &func](uint32_t jobIndex)
+                {
+                    const auto firstRow = jobIndex * rowsPerJob;
+                    func(firstRow, std::min<uint32_t>(rowsPerJob, numRows - firstRow));
+                });
+        }
+
+        //--
+
         template< typename T >
         static void ConvertChannelsLineWorker(const T* readPtr, uint8_t srcChannelCount, T* writePtr, uint8_t destChannelCount, uint32_t width, const T* defaultPtr)
         {
@@ -167,24 +214,17 @@ namespace base
             DEBUG_CHECK(src.height() == dest.height());
             DEBUG_CHECK(src.depth() == dest.depth());
 
-            auto readPtr  = (const uint8_t*)src.data();
-            auto writePtr  = (uint8_t*)dest.data();
-
-            for (uint32_t z = 0; z < dest.depth(); ++z)
-            {
-                auto sliceReadPtr  = readPtr;
-                auto sliceWritePtr  = writePtr;
-
-                for (uint32_t y = 0; y < dest.height(); ++y)
+            const auto height = dest.height();
+            const auto rowElementCount = dest.width() * std::max(src.channels(), dest.channels());
+            ProcessRowRanges("ConvertChannels", height * dest.depth(), rowElementCount, [&src, &dest, defaults, height](uint32_t firstRow, uint32_t numRows)
                 {
-                    ConvertChannelsLine(src.format(), readPtr, src.channels(), writePtr, dest.channels(), dest.width(), defaults);
-                    readPtr += src.rowPitch();
-                    writePtr += dest.rowPitch();
-                }
-
-                readPtr = sliceReadPtr + src.slicePitch();
-                writePtr = sliceWritePtr + dest.slicePitch();
-            }
+                    for (uint32_t row = firstRow; row < firstRow + numRows; ++row)
+                    {
+                        const auto y = row % height;
+                        const auto z = row / height;
+                        ConvertChannelsLine(src.format(), src.pixelPtr(0, y, z), src.channels(), (void*)dest.pixelPtr(0, y, z), dest.channels(), dest.width(), defaults);
+                    }
+                });
         }
 
         //---
@@ -607,6 +647,46 @@ namespace base
             }
         }
 
+        // can we unpack given format with the line kernels ?
+        static bool CanUnpackRowsFast(PixelFormat format, ColorSpace space)
+        {
+            if (space == ColorSpace::Linear)
+                return true;
+
+            if (space == ColorSpace::SRGB || space == ColorSpace::HDR)
+                return format == PixelFormat::Uint8_Norm || format == PixelFormat::Uint16_Norm;
+
+            return false;
+        }
+
+        static void UnpackRowFast(PixelFormat format, ColorSpace space, const void* src, float* dest, uint32_t count)
+        {
+            if (space == ColorSpace::SRGB)
+            {
+                if (format == PixelFormat::Uint8_Norm)
+                {
+                    const auto* read = (const uint8_t*)src;
+                    for (uint32_t i = 0; i < count; ++i)
+                        dest[i] = GColorLookup.Uint8SrgbToLinear[read[i]];
+                }
+                else if (format == PixelFormat::Uint16_Norm)
+                {
+                    const auto* read = (const uint16_t*)src;
+                    for (uint32_t i = 0; i < count; ++i)
+                        dest[i] = GColorLookup.Uint16SrgbToLinear[read[i]];
+                }
+                return;
+            }
+
+            switch (format)
+            {
+                case PixelFormat::Uint8_Norm: prv::UnpackLineUint8((const uint8_t*)src, dest, count); break;
+                case PixelFormat::Uint16_Norm: prv::UnpackLineUint16((const uint16_t*)src, dest, count); break;
+                case PixelFormat::Float16_Raw: prv::UnpackLineFloat16((const uint16_t*)src, dest, count); break;
+                case PixelFormat::Float32_Raw: memcpy(dest, src, count * sizeof(float)); break;
+            }
+        }
+
         void UnpackIntoFloats(const ImageView& src, const ImageView& dest, ColorSpace space)
         {
             DEBUG_CHECK_EX(dest.width() == src.width(), "Invalid destination width");
@@ -617,6 +697,22 @@ namespace base
             DEBUG_CHECK_EX(dest.rowPitch() == dest.width() * dest.pixelPitch(), "Destination row pitch must be native (no gaps)");
             DEBUG_CHECK_EX(dest.slicePitch() == dest.width() * dest.height() * dest.pixelPitch(), "Destination slice pitch must be native (no gaps)");
 
+            // whole rows can be processed at once if pixels are tightly packed
+            if (GFastImageKernels && src.pixelPitch() == PixelPitchForFormat(src.format(), src.channels()) && CanUnpackRowsFast(src.format(), space))
+            {
+                const auto height = src.height();
+                const auto rowElementCount = src.width() * src.channels();
+                ProcessRowRanges("UnpackIntoFloats", height * src.depth(), rowElementCount, [&src, &dest, space, height, rowElementCount](uint32_t firstRow, uint32_t numRows)
+                    {
+                        for (uint32_t row = firstRow; row < firstRow + numRows; ++row)
+                        {
+                            auto* writePtr = (float*)dest.data() + (uint64_t)row * rowElementCount;
+                            UnpackRowFast(src.format(), space, src.pixelPtr(0, row % height, row / height), writePtr, rowElementCount);
+                        }
+                    });
+                return;
+            }
+
             if (space == ColorSpace::SRGB)
             {
                 switch (dest.channels())
@@ -727,6 +823,39 @@ namespace base
             }
         }
 
+        // can we pack given format with the line kernels ?
+        static bool CanPackRowsFast(PixelFormat format, ColorSpace space)
+        {
+            if (space == ColorSpace::Linear)
+                return true;
+
+            if (space == ColorSpace::SRGB)
+                return format == PixelFormat::Uint8_Norm;
+
+            if (space == ColorSpace::HDR)
+                return format == PixelFormat::Uint8_Norm || format == PixelFormat::Uint16_Norm;
+
+            return false;
+        }
+
+        static void PackRowFast(PixelFormat format, ColorSpace space, const float* src, void* dest, uint32_t count)
+        {
+            if (space == ColorSpace::SRGB)
+            {
+                DEBUG_CHECK(format == PixelFormat::Uint8_Norm);
+                prv::PackLineLookup65536(src, (uint8_t*)dest, count, GColorLookup.Uint8LinearToSrgb);
+                return;
+            }
+
+            switch (format)
+            {
+                case PixelFormat::Uint8_Norm: prv::PackLineUint8(src, (uint8_t*)dest, count); break;
+                case PixelFormat::Uint16_Norm: prv::PackLineUint16(src, (uint16_t*)dest, count); break;
+                case PixelFormat::Float16_Raw: prv::PackLineFloat16(src, (uint16_t*)dest, count); break;
+                case PixelFormat::Float32_Raw: memcpy(dest, src, count * sizeof(float)); break;
+            }
+        }
+
         void PackFromFloats(const ImageView& src, const ImageView& dest, ColorSpace space)
         {
             DEBUG_CHECK_EX(dest.width() == src.width(), "Invalid destination width");
@@ -737,6 +866,22 @@ namespace base
             DEBUG_CHECK_EX(src.rowPitch() == src.width() * src.pixelPitch(), "Source row pitch must be native (no gaps)");
             DEBUG_CHECK_EX(src.slicePitch() == src.width() * src.height() * src.pixelPitch(), "Source slice pitch must be native (no gaps)");
 
+            // whole rows can be processed at once if pixels are tightly packed
+            if (GFastImageKernels && dest.pixelPitch() == PixelPitchForFormat(dest.format(), dest.channels()) && CanPackRowsFast(dest.format(), space))
+            {
+                const auto height = dest.height();
+                const auto rowElementCount = dest.width() * dest.channels();
+                ProcessRowRanges("PackFromFloats", height * dest.depth(), rowElementCount, [&src, &dest, space, height, rowElementCount](uint32_t firstRow, uint32_t numRows)
+                    {
+                        for (uint32_t row = firstRow; row < firstRow + numRows; ++row)
+                        {
+                            const auto* readPtr = (const float*)src.data() + (uint64_t)row * rowElementCount;
+                            PackRowFast(dest.format(), space, readPtr, (void*)dest.pixelPtr(0, row % height, row / height), rowElementCount);
+                        }
+                    });
+                return;
+            }
+
             if (space == ColorSpace::SRGB)
             {
                 switch (dest.channels())
@@ -773,6 +918,16 @@ namespace base
 
         void DownsampleStream(const float* base, const float* extra, float* write, uint32_t count, DownsampleMode mode)
         {
+            // the vectorized versions are bit exact but are only used when whole pixels are processed
+            if (GFastImageKernels && (mode == DownsampleMode::Average || (count % 4) == 0))
+            {
+                if (mode == DownsampleMode::AverageWithAlphaWeight)
+                    prv::DownsampleLineAlphaWeight(base, extra, write, count);
+                else
+                    prv::DownsampleLineAverage(base, extra, write, count);
+                return;
+            }
+
             auto* baseEnd = base + count;
 
             if (mode == DownsampleMode::Average)
@@ -960,6 +1115,89 @@ namespace base
             return ImageView(data.format(), data.channels(), data.data(), newWidth, data.height(), data.depth(), data.pixelPitch(), newRowPitch, newSlicePitch);
         }
 
+        // downsample image row by row, each output row is computed from up to 4 source rows that are unpacked, merged and packed without going through a full size temporary image
+        // NOTE: the merge order (Z, then Y, then X) is the same as in the DownsampleZ/Y/X path so the results are identical
+        static void DownsampleRows(const ImageView& src, const ImageView& dest, DownsampleMode mode, ColorSpace space)
+        {
+            const auto channels = src.channels();
+            const auto srcRowElementCount = src.width() * channels;
+            const auto destRowElementCount = dest.width() * channels;
+            const auto mergeZ = src.depth() >= 2;
+            const auto mergeY = src.height() >= 2;
+            const auto mergeX = src.width() >= 2;
+            const auto alphaWeight = (mode == DownsampleMode::AverageWithAlphaWeight);
+            const auto destHeight = dest.height();
+
+            ProcessRowRanges("Downsample", destHeight * dest.depth(), srcRowElementCount * (mergeY ? 2 : 1) * (mergeZ ? 2 : 1), 
+                [&src, &dest, space, channels, srcRowElementCount, destRowElementCount, mergeX, mergeY, mergeZ, alphaWeight, destHeight](uint32_t firstRow, uint32_t numRows)
+                {
+                    base::Array<float> temp;
+                    temp.resize(srcRowElementCount * 4 + destRowElementCount);
+
+                    float* rows[4] = { temp.data(), temp.data() + srcRowElementCount, temp.data() + srcRowElementCount * 2, temp.data() + srcRowElementCount * 3 };
+                    auto* destRow = temp.data() + srcRowElementCount * 4;
+
+                    auto merge = [alphaWeight](const float* a, const float* b, float* write, uint32_t count)
+                    {
+                        if (alphaWeight)
+                            prv::DownsampleLineAlphaWeight(a, b, write, count);
+                        else
+                            prv::DownsampleLineAverage(a, b, write, count);
+                    };
+
+                    auto unpack = [&src, space, &rows](uint32_t index, uint32_t y, uint32_t z)
+                    {
+                        const auto srcRow = ImageView(src.format(), src.channels(), src.pixelPtr(0, y, z), src.width(), src.pixelPitch());
+                        const auto tempRow = ImageView(NATIVE_LAYOUT, PixelFormat::Float32_Raw, src.channels(), rows[index], src.width());
+                        UnpackIntoFloats(srcRow, tempRow, space);
+                    };
+
+                    for (uint32_t row = firstRow; row < firstRow + numRows; ++row)
+                    {
+                        const auto y = row % destHeight;
+                        const auto z = row / destHeight;
+                        const auto srcY = mergeY ? (y * 2) : y;
+                        const auto srcZ = mergeZ ? (z * 2) : z;
+
+                        // load source rows
+                        unpack(0, srcY, srcZ);
+                        if (mergeY)
+                            unpack(1, srcY + 1, srcZ);
+                        if (mergeZ)
+                        {
+                            unpack(2, srcY, srcZ + 1);
+                            if (mergeY)
+                                unpack(3, srcY + 1, srcZ + 1);
+                        }
+
+                        // merge slices
+                        if (mergeZ)
+                        {
+                            merge(rows[0], rows[2], rows[0], srcRowElementCount);
+                            if (mergeY)
+                                merge(rows[1], rows[3], rows[1], srcRowElementCount);
+                        }
+
+                        // merge rows
+                        if (mergeY)
+                            merge(rows[0], rows[1], rows[0], srcRowElementCount);
+
+                        // merge pixels
+                        const float* finalRow = rows[0];
+                        if (mergeX)
+                        {
+                            prv::DownsampleLinePairs(rows[0], destRow, dest.width(), channels, alphaWeight);
+                            finalRow = destRow;
+                        }
+
+                        // store
+                        const auto finalView = ImageView(NATIVE_LAYOUT, PixelFormat::Float32_Raw, channels, finalRow, dest.width());
+                        const auto destView = ImageView(dest.format(), dest.channels(), dest.pixelPtr(0, y, z), dest.width(), dest.pixelPitch());
+                        PackFromFloats(finalView, destView, space);
+                    }
+                });
+        }
+
         void Downsample(const ImageView& src, const ImageView& dest, DownsampleMode mode, ColorSpace space)
         {
             DEBUG_CHECK_EX(dest.width() == std::max<uint32_t>(1, src.width() / 2), "Invalid destination width");
@@ -971,6 +1209,18 @@ namespace base
             if (src.empty() || dest.empty())
                 return;
 
+            PC_SCOPE_LVL2(ImageDownsample);
+
+            if (mode == DownsampleMode::AverageWithAlphaWeight && src.channels() != 4)
+                mode = DownsampleMode::Average;
+
+            // the premultiplied mode is a plain average on RGBA data
+            if (GFastImageKernels && (mode == DownsampleMode::Average || src.channels() == 4))
+            {
+                DownsampleRows(src, dest, mode, space);
+                return;
+            }
+
             // prepare temporary storage
             base::Array<float> tempData;
 
@@ -9,12 +9,186 @@
 #include "build.h"
 
 #include "base/test/include/gtest/gtest.h"
+#include "base/system/include/timedScope.h"
 
 #include "image.h"
+#include "imageView.h"
+#include "imageUtils.h"
 
 DECLARE_TEST_FILE(Images);
 
+using namespace base;
+using namespace base::image;
+
 TEST(Image, CreateEmpty)
 {
 
-}
\ No newline at end of file
+}
+
+//--
+
+namespace helper
+{
+    static const PixelFormat TEST_FORMATS[] = { PixelFormat::Uint8_Norm, PixelFormat::Uint16_Norm, PixelFormat::Float16_Raw, PixelFormat::Float32_Raw };
+    static const ColorSpace TEST_SPACES[] = { ColorSpace::Linear, ColorSpace::SRGB, ColorSpace::HDR };
+
+    struct TestImage
+    {
+        Array<uint8_t> data;
+        ImageView view;
+
+        TestImage(PixelFormat format, uint8_t channels, uint32_t width, uint32_t height, uint32_t depth, uint64_t seed = 0)
+        {
+            const auto pixelPitch = PixelPitchForFormat(format, channels);
+            data.resize(pixelPitch * width * height * depth);
+            view = ImageView(NATIVE_LAYOUT, format, channels, data.data(), width, height, depth);
+
+            // fill with values in the -0.25 - 1.25 range, out of range values test the clamping
+            if (format == PixelFormat::Float32_Raw || format == PixelFormat::Float16_Raw)
+            {
+                const auto count = width * height * depth * channels;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    const auto val = ((StatelessNextUint64(seed) >> 40) / (float)0xFFFFFF) * 1.5f - 0.25f;
+                    if (format == PixelFormat::Float32_Raw)
+                        ((float*)data.data())[i] = val;
+                    else
+                        ((uint16_t*)data.data())[i] = Float16Helper::Compress(val);
+                }
+            }
+            else
+            {
+                for (auto& val : data)
+                    val = (uint8_t)StatelessNextUint64(seed);
+            }
+        }
+
+        bool operator==(const TestImage& other) const
+        {
+            return data.size() == other.data.size() && 0 == memcmp(data.data(), other.data.data(), data.dataSize());
+        }
+    };
+
+    // run the same operation with and without the fast image kernels
+    template< typename Func >
+    static void RunBothPaths(const Func& func)
+    {
+        EnableFastImageKernels(false);
+        func(false);
+        EnableFastImageKernels(true);
+        func(true);
+    }
+
+} // helper
+
+TEST(ImageKernels, UnpackIsBitExact)
+{
+    for (auto format : helper::TEST_FORMATS)
+    {
+        for (auto space : helper::TEST_SPACES)
+        {
+            for (uint8_t channels = 1; channels <= 4; ++channels)
+            {
+                helper::TestImage src(format, channels, 37, 19, 3, channels);
+                helper::TestImage scalar(PixelFormat::Float32_Raw, channels, 37, 19, 3);
+                helper::TestImage fast(PixelFormat::Float32_Raw, channels, 37, 19, 3);
+
+                helper::RunBothPaths([&](bool useFast) { UnpackIntoFloats(src.view, useFast ? fast.view : scalar.view, space); });
+                EXPECT_TRUE(scalar == fast) << "Format " << (int)format << ", space " << (int)space << ", channels " << (int)channels;
+            }
+        }
+    }
+}
+
+TEST(ImageKernels, PackIsBitExact)
+{
+    for (auto format : helper::TEST_FORMATS)
+    {
+        for (auto space : helper::TEST_SPACES)
+        {
+            for (uint8_t channels = 1; channels <= 4; ++channels)
+            {
+                helper::TestImage src(PixelFormat::Float32_Raw, channels, 37, 19, 3, channels);
+                helper::TestImage scalar(format, channels, 37, 19, 3);
+                helper::TestImage fast(format, channels, 37, 19, 3);
+
+                helper::RunBothPaths([&](bool useFast) { PackFromFloats(src.view, useFast ? fast.view : scalar.view, space); });
+                EXPECT_TRUE(scalar == fast) << "Format " << (int)format << ", space " << (int)space << ", channels " << (int)channels;
+            }
+        }
+    }
+}
+
+TEST(ImageKernels, DownsampleIsBitExact)
+{
+    static const uint32_t TEST_SIZES[][3] = { {1,1,1}, {9,1,1}, {1,9,1}, {7,5,1}, {64,64,1}, {5,9,3}, {8,8,4}, {600,500,1} };
+    static const DownsampleMode TEST_MODES[] = { DownsampleMode::Average, DownsampleMode::AverageWithAlphaWeight, DownsampleMode::AverageWithPremultipliedAlphaWeight };
+
+    for (auto format : helper::TEST_FORMATS)
+    {
+        for (auto space : helper::TEST_SPACES)
+        {
+            for (uint8_t channels = 1; channels <= 4; ++channels)
+            {
+                for (auto mode : TEST_MODES)
+                {
+                    // premultiplied alpha is only meaningful (and supported) for RGBA
+                    if (mode == DownsampleMode::AverageWithPremultipliedAlphaWeight && channels != 4)
+                        continue;
+
+                    for (const auto* size : TEST_SIZES)
+                    {
+                        const auto destWidth = std::max<uint32_t>(1, size[0] / 2);
+                        const auto destHeight = std::max<uint32_t>(1, size[1] / 2);
+                        const auto destDepth = std::max<uint32_t>(1, size[2] / 2);
+
+                        helper::TestImage src(format, channels, size[0], size[1], size[2], size[0] * channels);
+                        helper::TestImage scalar(format, channels, destWidth, destHeight, destDepth);
+                        helper::TestImage fast(format, channels, destWidth, destHeight, destDepth);
+
+                        helper::RunBothPaths([&](bool useFast) { Downsample(src.view, useFast ? fast.view : scalar.view, mode, space); });
+                        EXPECT_TRUE(scalar == fast) << "Format " << (int)format << ", space " << (int)space << ", channels " << (int)channels << ", mode " << (int)mode << ", size " << size[0] << "x" << size[1] << "x" << size[2];
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(ImageKernels, ConvertChannelsIsBitExact)
+{
+    for (auto format : helper::TEST_FORMATS)
+    {
+        for (uint8_t srcChannels = 1; srcChannels <= 4; ++srcChannels)
+        {
+            for (uint8_t destChannels = 1; destChannels <= 4; ++destChannels)
+            {
+                helper::TestImage src(format, srcChannels, 700, 400, 1, srcChannels);
+                helper::TestImage scalar(format, destChannels, 700, 400, 1);
+                helper::TestImage fast(format, destChannels, 700, 400, 1);
+
+                helper::RunBothPaths([&](bool useFast) { ConvertChannels(src.view, useFast ? fast.view : scalar.view); });
+                EXPECT_TRUE(scalar == fast) << "Format " << (int)format << ", channels " << (int)srcChannels << "->" << (int)destChannels;
+            }
+        }
+    }
+}
+
+TEST(ImageKernels, DISABLED_DownsampleBenchmark)
+{
+    for (uint32_t size : { 4096, 8192 })
+    {
+        helper::TestImage src(PixelFormat::Uint8_Norm, 4, size, size, 1);
+        helper::TestImage dest(PixelFormat::Uint8_Norm, 4, size / 2, size / 2, 1);
+
+        for (auto space : { ColorSpace::Linear, ColorSpace::SRGB })
+        {
+            helper::RunBothPaths([&](bool useFast)
+                {
+                    ScopeTimer timer;
+                    Downsample(src.view, dest.view, DownsampleMode::AverageWithAlphaWeight, space);
+                    TRACE_INFO("Downsample {}x{} RGBA8 (space {}, {}): {}ms", size, size, (int)space, useFast ? "fast" : "scalar", timer.milisecondsElapsed());
+                });
+        }
+    }
+}
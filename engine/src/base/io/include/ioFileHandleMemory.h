@@ -22,6 +22,7 @@ namespace base
         public:
             MemoryReaderFileHandle(const void* memory, uint64_t size, const StringBuf& origin = StringBuf::EMPTY());
             MemoryReaderFileHandle(const Buffer& buffer, const StringBuf& origin = StringBuf::EMPTY());
+            MemoryReaderFileHandle(const Buffer& buffer, uint64_t offset, uint64_t size, const StringBuf& origin = StringBuf::EMPTY()); // view of part of the buffer, whole buffer is kept alive
             virtual ~MemoryReaderFileHandle();
 
             //----
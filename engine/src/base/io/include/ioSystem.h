@@ -60,8 +60,10 @@ namespace base
 
             //--
 
-            // create a READ ONLY memory mapped buffer view of a file
-            Buffer openMemoryMappedForReading(AbsolutePathView absoluteFilePath);
+            // create a READ ONLY memory mapped buffer view of a file, optionally only of a range of it (zero size maps up to the end of the file)
+            // NOTE: pages are loaded on first access, nothing is read up front and the memory is not taken from any pool
+            // NOTE: the view has the same alignment as the offset in the file
+            Buffer openMemoryMappedForReading(AbsolutePathView absoluteFilePath, uint64_t offset = 0, uint64_t size = 0);
 
             // load file content into a buffer
             Buffer loadIntoMemoryForReading(AbsolutePathView absoluteFilePath);
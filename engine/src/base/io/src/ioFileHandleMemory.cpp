@@ -31,6 +31,16 @@ namespace base
             , m_buffer(buffer)
         {}
 
+        MemoryReaderFileHandle::MemoryReaderFileHandle(const Buffer& buffer, uint64_t offset, uint64_t size, const StringBuf& origin /*= StringBuf::EMPTY()*/)
+            : m_data(buffer.data() + offset)
+            , m_size(size)
+            , m_pos(0)
+            , m_origin(origin)
+            , m_buffer(buffer)
+        {
+            DEBUG_CHECK_EX(offset + size <= buffer.size(), "View is outside the buffer");
+        }
+
         MemoryReaderFileHandle::~MemoryReaderFileHandle()
         {}
 
@@ -62,9 +62,9 @@ namespace base
             return m_handler->loadIntoMemoryForReading(absoluteFilePath);
         }
         
-        Buffer System::openMemoryMappedForReading(AbsolutePathView absoluteFilePath)
+        Buffer System::openMemoryMappedForReading(AbsolutePathView absoluteFilePath, uint64_t offset, uint64_t size)
         {
-            return m_handler->openMemoryMappedForReading(absoluteFilePath);
+            return m_handler->openMemoryMappedForReading(absoluteFilePath, offset, size);
         }
 
         bool System::fileSize(AbsolutePathView absoluteFilePath, uint64_t& outFileSize)
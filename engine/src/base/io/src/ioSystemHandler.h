@@ -39,8 +39,8 @@ namespace base
                 // load file content into a buffer
                 virtual Buffer loadIntoMemoryForReading(AbsolutePathView absoluteFilePath) = 0;
 
-                // open a read only memory mapped access to file
-                virtual Buffer openMemoryMappedForReading(AbsolutePathView absoluteFilePath) = 0;
+                // open a read only memory mapped access to a range of the file, zero size maps up to the end of the file
+                virtual Buffer openMemoryMappedForReading(AbsolutePathView absoluteFilePath, uint64_t offset, uint64_t size) = 0;
 
                 //! Get file size, returns 0 if file does not exist (we are not interested in empty file either)
                 virtual bool fileSize(AbsolutePathView absoluteFilePath, uint64_t& outFileSize) = 0;
@@ -228,10 +228,78 @@ namespace base
                 return CreateSharedPtr<WinFileHandle>(handle, INVALID_HANDLE_VALUE, StringBuf(absoluteFilePath), true, true, false, m_asyncDispatcher.get());
             }
 
-            Buffer WinIOSystem::openMemoryMappedForReading(AbsolutePathView absoluteFilePath)
+            // views can only start at the allocation granularity boundary (usually 64KB)
+            static uint64_t FileViewGranularity()
             {
-                // TODO: right now just read into memory buffer
-                return loadIntoMemoryForReading(absoluteFilePath);
+                static uint64_t granularity = []() {
+                    SYSTEM_INFO info;
+                    GetSystemInfo(&info);
+                    return (uint64_t)info.dwAllocationGranularity;
+                }();
+
+                return granularity;
+            }
+
+            static void UnmapFileView(mem::PoolID pool, void* memory, uint64_t size)
+            {
+                // the buffer may point inside the view if the mapped range was not aligned, the view itself always starts at the granularity boundary
+                const auto viewBase = (uint64_t)memory & ~(FileViewGranularity() - 1);
+                UnmapViewOfFile((void*)viewBase);
+            }
+
+            Buffer WinIOSystem::openMemoryMappedForReading(AbsolutePathView absoluteFilePath, uint64_t offset, uint64_t size)
+            {
+                TempPathStringBuffer cstr(absoluteFilePath);
+
+                HANDLE hHandle = CreateFileW(cstr, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+                if (hHandle == INVALID_HANDLE_VALUE)
+                {
+                    TRACE_ERROR("Failed to create reading handle for '{}'", absoluteFilePath);
+                    return nullptr;
+                }
+
+                uint64_t fileSize = 0;
+                if (!GetFileSizeEx(hHandle, (PLARGE_INTEGER)&fileSize) || !fileSize)
+                {
+                    TRACE_ERROR("Unable to get size of file '{}'", absoluteFilePath);
+                    CloseHandle(hHandle);
+                    return nullptr;
+                }
+
+                if (!size && offset < fileSize)
+                    size = fileSize - offset;
+
+                if (!size || offset + size > fileSize)
+                {
+                    TRACE_ERROR("Unable to map range {}-{} of file '{}' with size {}", offset, offset + size, absoluteFilePath, fileSize);
+                    CloseHandle(hHandle);
+                    return nullptr;
+                }
+
+                HANDLE hMapping = CreateFileMappingW(hHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (hMapping == NULL)
+                {
+                    TRACE_ERROR("Failed to create file mapping for '{}'", absoluteFilePath);
+                    CloseHandle(hHandle);
+                    return nullptr;
+                }
+
+                // map from the granularity boundary, the returned buffer starts at the requested offset
+                const auto viewOffset = offset & ~(FileViewGranularity() - 1);
+                const auto viewSize = (offset - viewOffset) + size;
+
+                // NOTE: the view keeps the mapping alive, handles are not needed once it's created
+                auto* view = (uint8_t*)MapViewOfFile(hMapping, FILE_MAP_READ, (DWORD)(viewOffset >> 32), (DWORD)(viewOffset & 0xFFFFFFFF), (SIZE_T)viewSize);
+                CloseHandle(hMapping);
+                CloseHandle(hHandle);
+
+                if (!view)
+                {
+                    TRACE_ERROR("Failed to map view of file '{}'", absoluteFilePath);
+                    return nullptr;
+                }
+
+                return Buffer::CreateExternal(POOL_IO, size, view + (offset - viewOffset), &UnmapFileView);
             }
 
             Buffer WinIOSystem::loadIntoMemoryForReading(AbsolutePathView absoluteFilePath)
@@ -33,7 +33,7 @@ namespace base
                 virtual FileHandlePtr openForReadingAndWriting(AbsolutePathView absoluteFilePath, bool resetContent = false) override final;
 
                 virtual Buffer loadIntoMemoryForReading(AbsolutePathView absoluteFilePath) override final;
-                virtual Buffer openMemoryMappedForReading(AbsolutePathView absoluteFilePath) override final;
+                virtual Buffer openMemoryMappedForReading(AbsolutePathView absoluteFilePath, uint64_t offset, uint64_t size) override final;
 
                 virtual bool fileSize(AbsolutePathView absoluteFilePath, uint64_t& outFileSize) override final;
                 virtual bool fileTimeStamp(AbsolutePathView absoluteFilePath, class TimeStamp& outTimeStamp, uint64_t* outFileSize) override final;
@@ -0,0 +1,112 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: allocator\pools #]
+***/
+
+#pragma once
+
+#include "base/system/include/algorithms.h"
+#include "base/system/include/spinLock.h"
+#include "poolID.h"
+
+namespace base
+{
+    namespace mem
+    {
+
+        //---
+
+        /// A pool for elements of constant size that can be used from many threads at once
+        /// Each thread keeps a small cache of free elements, elements are exchanged with other threads in batches via a lock-free stack
+        /// NOTE: memory is never returned to the system until the pool is destroyed
+        class BASE_MEMORY_API ConcurrentStructurePoolBase : public NoCopy
+        {
+        public:
+            ConcurrentStructurePoolBase(PoolID poolId, uint32_t elementSize, uint32_t elementAlignment, uint32_t elementsPerBlock = 0); // 0-auto
+            ~ConcurrentStructurePoolBase(); // asserts if all elements are not freed
+
+            // elements allocated at the moment
+            uint32_t size() const;
+
+            // size of single element
+            INLINE uint32_t elementSize() const { return m_elementSize; }
+
+            // alignment of single element
+            INLINE uint32_t elementAlignment() const { return m_elementAlignment; }
+
+            //--
+
+            // allocate single element
+            void* alloc();
+
+            // free single element, can be called on different thread than the element was allocated on
+            void free(void* ptr);
+
+            //--
+
+        private:
+            struct FreeElement
+            {
+                FreeElement* next; // next element in the batch
+                FreeElement* nextBatch; // next batch in the shared stack, valid only for the first element of the batch
+            };
+
+            struct BlockHeader
+            {
+                BlockHeader* next = nullptr;
+            };
+
+            // free elements owned by one thread, only the owning thread (or threads sharing the slot) touch it
+            TYPE_ALIGN(64, struct) ThreadCache
+            {
+                SpinLock lock;
+                FreeElement* freeElements = nullptr;
+                uint32_t numFreeElements = 0;
+                std::atomic<int> numAllocatedElements = 0; // elements may be freed on different thread than allocated so this may go negative
+            };
+
+            PoolID m_poolId;
+
+            uint32_t m_elementSize = 0;
+            uint32_t m_elementAlignment = 0;
+            uint32_t m_elementsPerBlock = 0;
+            uint32_t m_blockHeaderSize = 0;
+
+            ThreadCache* m_threadCaches = nullptr;
+
+            std::atomic<uint64_t> m_freeBatches = 0; // lock free stack of full batches, pointer + ABA tag
+
+            SpinLock m_blockLock; // only when allocating new blocks
+            BlockHeader* m_blocks = nullptr;
+
+            FreeElement* popBatch();
+            void pushBatch(FreeElement* batch);
+            FreeElement* allocateBlock();
+        };
+
+        //---
+
+        // concurrent structure pool for type "T"
+        template< typename T >
+        class ConcurrentStructurePool : public ConcurrentStructurePoolBase
+        {
+        public:
+            INLINE ConcurrentStructurePool(PoolID poolId = POOL_TEMP, uint32_t elementsPerBlock = 0);
+
+            // allocate single element, will call constructor
+            template<typename... Args>
+            INLINE T* create(Args&& ... args);
+
+            // release single element
+            INLINE void free(T* ptr);
+        };
+
+        //---
+
+    } // mem
+} // base
+
+#include "concurrentStructurePool.inl"
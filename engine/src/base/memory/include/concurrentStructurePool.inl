@@ -0,0 +1,41 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: allocator\pools #]
+***/
+
+#pragma once
+
+namespace base
+{
+    namespace mem
+    {
+
+        //---
+
+        template<typename T>
+        INLINE ConcurrentStructurePool<T>::ConcurrentStructurePool(mem::PoolID pool, uint32_t elementsPerBlock)
+            : ConcurrentStructurePoolBase(pool, sizeof(T), alignof(T), elementsPerBlock)
+        {}
+
+        template<typename T>
+        template<typename... Args >
+        INLINE T* ConcurrentStructurePool<T>::create(Args&& ... args)
+        {
+            void* mem = ConcurrentStructurePoolBase::alloc();
+            return new (mem) T(std::forward< Args >(args)...);
+        }
+
+        template<typename T>
+        INLINE void ConcurrentStructurePool<T>::free(T* ptr)
+        {
+            ((T*)ptr)->~T();
+            ConcurrentStructurePoolBase::free(ptr);
+        }
+
+        //---
+
+    } // mem
+} // base
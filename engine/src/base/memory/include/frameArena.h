@@ -0,0 +1,167 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: allocator\pages #]
+***/
+
+#pragma once
+
+#include "pageAllocator.h"
+
+namespace base
+{
+    namespace mem
+    {
+        ///--
+
+        /// statistics of a single frame of the frame arena
+        struct FrameArenaStats
+        {
+            uint32_t numAllocations = 0; // number of allocations done in the frame
+            uint32_t numLargeAllocations = 0; // number of allocations that did not fit in a page and were allocated from the pool
+            uint32_t numPages = 0; // number of pages used by the frame
+            uint64_t totalUsedMemory = 0; // size of the memory allocated in the frame
+        };
+
+        /// Frame scoped memory arena for the per-frame temporaries (culling results, fragment lists, temporary arrays, etc)
+        /// Memory is allocated linearly from per-thread segments and is never freed individually, all memory allocated during a frame is released at once
+        /// The arena is N-buffered - memory allocated in a frame stays valid until N-1 more frames are started, so it can be safely passed to the rendering of the previous frames
+        /// NOTE: allocation is thread safe, advancing the frame should happen at the sync point of the frame (see LocalServiceContainer::update)
+        /// NOTE: in non-release builds the memory of the expired frames is filled with a pattern so use of expired memory is easy to spot
+        class BASE_MEMORY_API FrameArena : public base::NoCopy
+        {
+        public:
+            static const uint32_t DEFAULT_NUM_FRAMES = 3;
+            static const uint32_t MAX_NUM_FRAMES = 8;
+
+            FrameArena(PoolID pool = POOL_TEMP, uint32_t numFrames = DEFAULT_NUM_FRAMES, uint32_t pageSize = 65536);
+            ~FrameArena(); // releases all memory, even the one from the frames that are still alive
+
+            /// get the memory pool
+            INLINE PoolID poolID() const { return m_poolId; }
+
+            /// get number of frames memory stays valid for
+            INLINE uint32_t numFrames() const { return m_numFrames; }
+
+            /// get the index of the current frame, incremented with each advanceFrame()
+            INLINE uint64_t frameIndex() const { return m_frameIndex.load(std::memory_order_acquire); }
+
+            /// get the statistics of the last finished frame
+            INLINE const FrameArenaStats& lastFrameStats() const { return m_lastFrameStats; }
+
+            /// get the page allocator used by the arena
+            INLINE PageAllocator& pageAllocator() { return m_pageAllocator; }
+
+            /// is memory allocated in given frame still valid ?
+            INLINE bool isFrameAlive(uint64_t frameIndex) const { return frameIndex + m_numFrames > this->frameIndex(); }
+
+            //--
+
+            /// allocate memory in current frame, thread safe
+            /// NOTE: allocations larger than half of the page are allocated from the pool but are still released with the frame
+            void* alloc(uint64_t size, uint32_t align);
+
+            /// allocate uninitialized memory for an array of elements in current frame
+            /// NOTE: there's no cleanup, only trivially destructible types (or types we don't care to destroy) should be placed here
+            template< typename T >
+            INLINE T* allocArray(uint32_t count)
+            {
+                return count ? (T*)alloc(sizeof(T) * (uint64_t)count, alignof(T)) : nullptr;
+            }
+
+            /// allocate memory for an object in current frame, the destructor is never called
+            template< typename T, typename... Args >
+            INLINE T* createNoCleanup(Args&& ... args)
+            {
+                void* mem = alloc(sizeof(T), alignof(T));
+                return new (mem) T(std::forward< Args >(args)...);
+            }
+
+            //--
+
+            /// start new frame, the memory of the oldest frame is released and the frame is reused
+            /// NOTE: should be called from one thread only
+            void advanceFrame();
+
+            //--
+
+            /// get the arena used for the engine wide per-frame temporaries, advanced by the application every frame
+            static FrameArena& GetDefaultArena();
+
+        private:
+            struct PageHeader
+            {
+                PageHeader* next = nullptr;
+            };
+
+            struct LargeBlockHeader
+            {
+                LargeBlockHeader* next = nullptr;
+                uint64_t size = 0;
+            };
+
+            TYPE_ALIGN(64, struct) Segment
+            {
+                SpinLock lock;
+                uint8_t* cur = nullptr;
+                uint8_t* end = nullptr;
+                PageHeader* pages = nullptr;
+                LargeBlockHeader* largeBlocks = nullptr;
+                FrameArenaStats stats;
+            };
+
+            PoolID m_poolId;
+            uint32_t m_numFrames = 0;
+            uint32_t m_pageSize = 0;
+            uint32_t m_pageHeaderSize = 0;
+
+            PageAllocator m_pageAllocator;
+
+            Segment* m_segments = nullptr; // m_numFrames * prv::NUM_THREAD_CACHE_SLOTS
+
+            std::atomic<uint64_t> m_frameIndex = 0;
+            FrameArenaStats m_lastFrameStats;
+
+            INLINE Segment* frameSegments(uint64_t frameIndex) const;
+
+            void* allocLarge(Segment& segment, uint64_t size, uint32_t align);
+            void releaseFrame(uint64_t frameIndex, FrameArenaStats& outStats);
+        };
+
+        ///--
+
+        /// STL compatible allocator that allocates from the frame arena, memory is never freed directly, it's released with the frame
+        /// ie. std::vector<int, FrameAllocator<int>> temp(FrameAllocator<int>(arena));
+        template< typename T >
+        class FrameAllocator
+        {
+        public:
+            typedef T value_type;
+
+            INLINE FrameAllocator() : m_arena(&FrameArena::GetDefaultArena()) {}
+            INLINE explicit FrameAllocator(FrameArena& arena) : m_arena(&arena) {}
+
+            template< typename U >
+            INLINE FrameAllocator(const FrameAllocator<U>& other) : m_arena(&other.arena()) {}
+
+            INLINE FrameArena& arena() const { return *m_arena; }
+
+            INLINE T* allocate(size_t count) { return (T*)m_arena->alloc(sizeof(T) * (uint64_t)count, alignof(T)); }
+            INLINE void deallocate(T*, size_t) {} // released with the frame
+
+            template< typename U >
+            INLINE bool operator==(const FrameAllocator<U>& other) const { return m_arena == &other.arena(); }
+
+            template< typename U >
+            INLINE bool operator!=(const FrameAllocator<U>& other) const { return m_arena != &other.arena(); }
+
+        private:
+            FrameArena* m_arena = nullptr;
+        };
+
+        ///--
+
+    } // mem
+} // base
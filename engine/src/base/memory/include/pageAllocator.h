@@ -21,11 +21,12 @@ namespace base
         /// NOTE: allocated pages must be returned to the same allocator
         /// NOTE: allocator is NOT tracking all it's pages - if you don't return it then it will leak, use PageCollection for tracking
         /// NOTE: pages are ALWAYS allocated from system memory, not from allocator!
+        /// NOTE: each thread keeps a small cache of free pages, pages are moved between the thread caches and the shared free lists in batches
         class BASE_MEMORY_API PageAllocator : public base::NoCopy
         {
         public:
             PageAllocator();
-            PageAllocator(PoolID pool, uint32_t pageSize, uint32_t preallocatedPages, uint32_t freePagesToKeep);
+            PageAllocator(PoolID pool, uint32_t pageSize, uint32_t preallocatedPages, uint32_t freePagesToKeep, uint32_t pagesPerRun = 1);
             ~PageAllocator(); // asserts if we destroy allocator while there are still pages in use
 
             //! is this allocator initialized ?
@@ -37,25 +38,32 @@ namespace base
             //! get size of single page, NOTE: this may be aligned to system page size (usually 4KB)
             INLINE uint32_t pageSize() const { return m_pageSize; }
 
-            //! get number of pages allocated so far
-            INLINE uint32_t numPages() const { return m_numPages; }
+            //! get number of pages in use at the moment
+            uint32_t numPages() const;
 
-            ///! get maximum number of pages ever allocated
+            ///! get maximum number of pages ever allocated (as seen when pages are moved between the thread caches and the allocator)
             INLINE uint32_t maxPages() const { return m_maxPages; }
 
-            //! get number of free pages at the moment
-            INLINE uint32_t numFreePages() const { return m_numFreePages; }
+            //! get number of free pages at the moment, including pages cached by threads
+            uint32_t numFreePages() const;
 
-            ///! get maximum number of free pages ever seen
+            ///! get maximum number of free pages ever seen in the shared free lists
             INLINE uint32_t maxFreePages() const { return m_maxFreePages; }
 
+            ///! get number of pages allocated from the system at once, 1 if pages are allocated one by one
+            INLINE uint32_t pagesPerRun() const { return m_pagesPerRun; }
+
             ///! get number of maximum free pages we want to retain, all additional pages will be freed
             INLINE uint32_t maxFreePagesToRetain() const { return m_maxFreePagesToRetain; }
 
             //---
 
             //! initialize page allocator 
-            void initialize(PoolID pool = POOL_TEMP, uint32_t pageSize = 65536, uint32_t preallocatedPages = 0, uint32_t freePagesToKeep = INDEX_MAX); // NOTE: page size will be usually aligned to the minimal system page size, like 4KB
+            //! NOTE: page size will be usually aligned to the minimal system page size, like 4KB
+            //! NOTE: with pagesPerRun > 1 pages are allocated from the system in runs (using large pages if the run is big enough), fewer system calls and TLB misses
+            //! NOTE: a run can only be returned to the system once all of its pages are free so a single long lived page keeps the whole run alive, the freePagesToKeep is respected only up to that
+            //! pools with scattered long lived pages should use pagesPerRun = 1 so the free pages above the limit are always released
+            void initialize(PoolID pool = POOL_TEMP, uint32_t pageSize = 65536, uint32_t preallocatedPages = 0, uint32_t freePagesToKeep = INDEX_MAX, uint32_t pagesPerRun = 1);
 
             //---
 
@@ -73,6 +81,7 @@ namespace base
             void retainCount(uint32_t retain);
 
             //! release free pages, keep only the indicated number
+            //! NOTE: pages cached by threads are returned to the allocator first, pages from runs are released only with the whole run (when all its pages are free)
             void releaseFreePages(uint32_t retain=0);
 
             //---
@@ -88,22 +97,69 @@ namespace base
                 FreePage* next = nullptr;
             };
 
-            SpinLock m_lock; // allocating a page
+            // free pages owned by one thread, only the owning thread (or threads sharing the slot) touch it
+            TYPE_ALIGN(64, struct) ThreadCache
+            {
+                SpinLock lock;
+                FreePage* freePages = nullptr;
+                std::atomic<uint32_t> numFreePages = 0;
+                std::atomic<int> numAllocatedPages = 0; // pages may be freed on different thread than allocated so this may go negative
+            };
+
+            // memory allocated from the system for a run of pages
+            struct PageRun
+            {
+                uint8_t* memory = nullptr;
+                uint64_t size = 0;
+                uint32_t numFreePages = 0; // pages of this run in the shared free list
+                bool released = false;
+            };
+
+            // run unlinked from the allocator that is waiting to be returned to the system, stored in the run's memory
+            struct ReleasedRun
+            {
+                ReleasedRun* next = nullptr;
+                uint64_t size = 0;
+            };
+
+            SpinLock m_lock; // shared free lists
 
             uint32_t m_pageSize = 0;
             FreePage* m_outstandingFreePageList = nullptr;
             FreePage* m_preallocatedFreePageList = nullptr;
             
             PoolID m_poolID;
-            uint32_t m_numPages = 0;
             uint32_t m_maxPages = 0;
-            uint32_t m_numFreePages = 0;
+            uint32_t m_numFreePages = 0; // in the shared lists
             uint32_t m_maxFreePages = 0;
 
             uint8_t* m_preallocatedMemoryStart = nullptr;
             uint8_t* m_preallocatedMemoryEnd = nullptr;            
 
             uint32_t m_maxFreePagesToRetain = 0;
+
+            uint32_t m_pagesPerRun = 1;
+            PageRun* m_runs = nullptr; // sorted by the memory address
+            uint32_t m_numRuns = 0;
+            uint32_t m_maxRuns = 0;
+            uint32_t m_numFreeRuns = 0; // runs with all pages in the shared free list
+
+            ThreadCache* m_threadCaches = nullptr;
+            uint32_t m_threadCacheCapacity = 0; // max free pages in single thread cache
+            uint32_t m_threadCacheBatch = 1; // number of pages moved between thread cache and shared list at once
+
+            FreePage* popSharedPage();
+            void pushSharedPage(FreePage* page);
+
+            FreePage* allocateSystemPages(uint32_t count);
+            PageRun* findRun(const void* page) const;
+            void insertRun(uint8_t* memory, uint64_t size);
+            ReleasedRun* unlinkFreeRuns(uint32_t retain);
+            void freeRuns(ReleasedRun* runs);
+            void* refillThreadCache(ThreadCache& cache);
+            void returnPages(FreePage* pages);
+            void flushThreadCaches();
+            void updateMaxPages();
         };
 
     } // mem
@@ -0,0 +1,243 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: allocator\pool #]
+***/
+
+#include "build.h"
+#include "concurrentStructurePool.h"
+#include "threadCacheInternal.h"
+
+#include "base/system/include/scopeLock.h"
+
+namespace base
+{
+    namespace mem
+    {
+
+        //---
+
+        // number of elements moved between thread caches at once
+        static const uint32_t ELEMENTS_PER_BATCH = 32;
+
+        // size of memory block we want to allocate if number of elements was not specified
+        static const uint32_t DEFAULT_BLOCK_SIZE = 16384;
+
+        // pointers are 48 bit, rest of the stack head is used for the tag that protects us from ABA
+        static_assert(sizeof(void*) == 8, "Tagged batch stack requires 64-bit pointers");
+        static const uint64_t BATCH_POINTER_MASK = (1ULL << 48) - 1;
+        static const uint32_t BATCH_TAG_SHIFT = 48;
+
+        static INLINE uint64_t PackBatchHead(const void* ptr, uint64_t tag)
+        {
+            DEBUG_CHECK_EX(((uint64_t)ptr & ~BATCH_POINTER_MASK) == 0, "Pointer does not fit in 48 bits");
+            return ((uint64_t)ptr & BATCH_POINTER_MASK) | (tag << BATCH_TAG_SHIFT);
+        }
+
+        //---
+
+        ConcurrentStructurePoolBase::ConcurrentStructurePoolBase(PoolID poolId, uint32_t elementSize, uint32_t elementAlignment, uint32_t elementsPerBlock)
+            : m_poolId(poolId)
+        {
+            // free elements are used to link the free lists
+            m_elementAlignment = std::max<uint32_t>(elementAlignment, alignof(FreeElement));
+            m_elementSize = Align<uint32_t>(std::max<uint32_t>(elementSize, sizeof(FreeElement)), m_elementAlignment);
+
+            // blocks are always split into full batches
+            if (elementsPerBlock == 0)
+                elementsPerBlock = DEFAULT_BLOCK_SIZE / m_elementSize;
+            m_elementsPerBlock = Align<uint32_t>(std::max<uint32_t>(elementsPerBlock, ELEMENTS_PER_BATCH), ELEMENTS_PER_BATCH);
+            m_blockHeaderSize = Align<uint32_t>(sizeof(BlockHeader), m_elementAlignment);
+
+            m_threadCaches = (ThreadCache*)AllocateBlock(m_poolId, sizeof(ThreadCache) * prv::NUM_THREAD_CACHE_SLOTS, alignof(ThreadCache));
+            for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                new (m_threadCaches + i) ThreadCache();
+        }
+
+        ConcurrentStructurePoolBase::~ConcurrentStructurePoolBase()
+        {
+            DEBUG_CHECK_EX(size() == 0, "There are still some elements allocated from structure pool");
+
+            while (m_blocks)
+            {
+                auto* block = m_blocks;
+                m_blocks = block->next;
+                FreeBlock(block);
+            }
+
+            for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                m_threadCaches[i].~ThreadCache();
+
+            FreeBlock(m_threadCaches);
+        }
+
+        uint32_t ConcurrentStructurePoolBase::size() const
+        {
+            int numAllocated = 0;
+            for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                numAllocated += m_threadCaches[i].numAllocatedElements.load(std::memory_order_relaxed);
+
+            return (uint32_t)std::max<int>(0, numAllocated);
+        }
+
+        //---
+
+        ConcurrentStructurePoolBase::FreeElement* ConcurrentStructurePoolBase::popBatch()
+        {
+            auto head = m_freeBatches.load(std::memory_order_acquire);
+            for (;;)
+            {
+                auto* batch = (FreeElement*)(head & BATCH_POINTER_MASK);
+                if (!batch)
+                    return nullptr;
+
+                // NOTE: the batch may be taken by other thread before we swap, memory is still valid (blocks are never freed) and the tag will make the swap fail
+                const auto newHead = PackBatchHead(batch->nextBatch, (head >> BATCH_TAG_SHIFT) + 1);
+                if (m_freeBatches.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+                    return batch;
+            }
+        }
+
+        void ConcurrentStructurePoolBase::pushBatch(FreeElement* batch)
+        {
+            auto head = m_freeBatches.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                batch->nextBatch = (FreeElement*)(head & BATCH_POINTER_MASK);
+
+                const auto newHead = PackBatchHead(batch, (head >> BATCH_TAG_SHIFT) + 1);
+                if (m_freeBatches.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed))
+                    return;
+            }
+        }
+
+        ConcurrentStructurePoolBase::FreeElement* ConcurrentStructurePoolBase::allocateBlock()
+        {
+            const auto blockSize = m_blockHeaderSize + (uint64_t)m_elementSize * m_elementsPerBlock;
+            auto* block = (BlockHeader*)AllocateBlock(m_poolId, blockSize, std::max<uint32_t>(m_elementAlignment, alignof(BlockHeader)));
+            if (!block) // out of memory
+                return nullptr;
+
+            {
+                auto lock = CreateLock(m_blockLock);
+                block->next = m_blocks;
+                m_blocks = block;
+            }
+
+            // split the block into batches, first one is for the caller, rest is shared
+            auto* firstElement = (uint8_t*)block + m_blockHeaderSize;
+            const auto numBatches = m_elementsPerBlock / ELEMENTS_PER_BATCH;
+
+            FreeElement* ret = nullptr;
+            for (uint32_t batchIndex = 0; batchIndex < numBatches; ++batchIndex)
+            {
+                FreeElement* batch = nullptr;
+                for (int i = ELEMENTS_PER_BATCH - 1; i >= 0; --i)
+                {
+                    auto* element = (FreeElement*)(firstElement + (uint64_t)m_elementSize * (batchIndex * ELEMENTS_PER_BATCH + i));
+                    element->next = batch;
+                    element->nextBatch = nullptr;
+                    batch = element;
+                }
+
+                if (batchIndex == 0)
+                    ret = batch;
+                else
+                    pushBatch(batch);
+            }
+
+            return ret;
+        }
+
+        //---
+
+        void* ConcurrentStructurePoolBase::alloc()
+        {
+            auto& cache = m_threadCaches[prv::GetThreadCacheSlot()];
+
+            // allocate from the thread cache
+            {
+                auto lock = CreateLock(cache.lock);
+                cache.numAllocatedElements.store(cache.numAllocatedElements.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+                if (auto* element = cache.freeElements)
+                {
+                    cache.freeElements = element->next;
+                    cache.numFreeElements -= 1;
+                    return element;
+                }
+            }
+
+            // get a batch of elements freed by other threads or allocate a new block
+            auto* batch = popBatch();
+            if (!batch)
+                batch = allocateBlock();
+
+            {
+                auto lock = CreateLock(cache.lock);
+
+                if (!batch) // out of memory
+                {
+                    cache.numAllocatedElements.store(cache.numAllocatedElements.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                // first element is for the caller, rest goes to the thread cache
+                if (auto* rest = batch->next)
+                {
+                    if (cache.freeElements)
+                    {
+                        auto* last = rest;
+                        while (last->next)
+                            last = last->next;
+                        last->next = cache.freeElements;
+                    }
+
+                    cache.freeElements = rest;
+                    cache.numFreeElements += ELEMENTS_PER_BATCH - 1;
+                }
+            }
+
+            return batch;
+        }
+
+        void ConcurrentStructurePoolBase::free(void* ptr)
+        {
+            DEBUG_CHECK_EX(ptr != nullptr, "Freeing null is not legal in structure pool");
+
+            // put the element in the cache of this thread, if there are too many elements share a batch of them with other threads
+            FreeElement* batch = nullptr;
+            {
+                auto& cache = m_threadCaches[prv::GetThreadCacheSlot()];
+                auto lock = CreateLock(cache.lock);
+                cache.numAllocatedElements.store(cache.numAllocatedElements.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+
+                auto* element = (FreeElement*)ptr;
+                element->next = cache.freeElements;
+                cache.freeElements = element;
+                cache.numFreeElements += 1;
+
+                if (cache.numFreeElements >= 2 * ELEMENTS_PER_BATCH)
+                {
+                    batch = cache.freeElements;
+
+                    auto* last = batch;
+                    for (uint32_t i = 1; i < ELEMENTS_PER_BATCH; ++i)
+                        last = last->next;
+
+                    cache.freeElements = last->next;
+                    cache.numFreeElements -= ELEMENTS_PER_BATCH;
+                    last->next = nullptr;
+                }
+            }
+
+            if (batch)
+                pushBatch(batch);
+        }
+
+        //---
+
+    } // mem
+} // base
@@ -0,0 +1,234 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: allocator\pages #]
+***/
+
+#include "build.h"
+#include "frameArena.h"
+#include "threadCacheInternal.h"
+
+#include "base/system/include/scopeLock.h"
+
+namespace base
+{
+    namespace mem
+    {
+
+        //--
+
+        // pattern used to fill the memory of expired frames
+        static const uint8_t EXPIRED_FRAME_MEMORY_PATTERN = 0xDD;
+
+        // number of pages we want to keep around, enough for few frames of a heavy scene
+        static const uint32_t FRAME_PAGES_TO_KEEP = 256;
+
+        // number of pages allocated from system at once
+        static const uint32_t FRAME_PAGES_PER_RUN = 16;
+
+        //--
+
+        FrameArena::FrameArena(PoolID pool /*= POOL_TEMP*/, uint32_t numFrames /*= DEFAULT_NUM_FRAMES*/, uint32_t pageSize /*= 65536*/)
+            : m_poolId(pool)
+            , m_numFrames(std::clamp<uint32_t>(numFrames, 2, (uint32_t)MAX_NUM_FRAMES))
+        {
+            m_pageAllocator.initialize(pool, pageSize, 0, FRAME_PAGES_TO_KEEP, FRAME_PAGES_PER_RUN);
+            m_pageSize = m_pageAllocator.pageSize();
+            m_pageHeaderSize = Align<uint32_t>(sizeof(PageHeader), 16);
+
+            const auto numSegments = m_numFrames * prv::NUM_THREAD_CACHE_SLOTS;
+            m_segments = (Segment*)AllocateBlock(m_poolId, sizeof(Segment) * numSegments, alignof(Segment));
+            for (uint32_t i = 0; i < numSegments; ++i)
+                new (m_segments + i) Segment();
+        }
+
+        FrameArena::~FrameArena()
+        {
+            FrameArenaStats stats;
+            for (uint32_t i = 0; i < m_numFrames; ++i)
+                releaseFrame(i, stats);
+
+            const auto numSegments = m_numFrames * prv::NUM_THREAD_CACHE_SLOTS;
+            for (uint32_t i = 0; i < numSegments; ++i)
+                m_segments[i].~Segment();
+
+            FreeBlock(m_segments);
+        }
+
+        INLINE FrameArena::Segment* FrameArena::frameSegments(uint64_t frameIndex) const
+        {
+            return m_segments + (frameIndex % m_numFrames) * prv::NUM_THREAD_CACHE_SLOTS;
+        }
+
+        //--
+
+        void* FrameArena::alloc(uint64_t size, uint32_t align)
+        {
+            align = std::max<uint32_t>(align, 1);
+
+            auto& segment = frameSegments(frameIndex())[prv::GetThreadCacheSlot()];
+            auto lock = CreateLock(segment.lock);
+
+            segment.stats.numAllocations += 1;
+            segment.stats.totalUsedMemory += size;
+
+            // big allocations would waste most of the page, allocate them directly
+            if (size > (m_pageSize - m_pageHeaderSize) / 2)
+                return allocLarge(segment, size, align);
+
+            // allocate from current page
+            auto* ptr = AlignPtr(segment.cur, align);
+            if (ptr + size > segment.end)
+            {
+                auto* page = (PageHeader*)m_pageAllocator.allocatePage();
+                if (!page) // out of memory
+                    return nullptr;
+
+                page->next = segment.pages;
+                segment.pages = page;
+                segment.stats.numPages += 1;
+
+                segment.cur = (uint8_t*)page + m_pageHeaderSize;
+                segment.end = (uint8_t*)page + m_pageSize;
+
+                ptr = AlignPtr(segment.cur, align);
+                DEBUG_CHECK_EX(ptr + size <= segment.end, "Allocation does not fit in a fresh page");
+            }
+
+            segment.cur = ptr + size;
+            return ptr;
+        }
+
+        void* FrameArena::allocLarge(Segment& segment, uint64_t size, uint32_t align)
+        {
+            const auto headerSize = Align<uint64_t>(sizeof(LargeBlockHeader), align);
+            auto* block = (LargeBlockHeader*)AllocateBlock(m_poolId, headerSize + size, std::max<uint32_t>(align, alignof(LargeBlockHeader)));
+            if (!block) // out of memory
+                return nullptr;
+
+            block->next = segment.largeBlocks;
+            block->size = size;
+            segment.largeBlocks = block;
+            segment.stats.numLargeAllocations += 1;
+
+            return (uint8_t*)block + headerSize;
+        }
+
+        //--
+
+        void FrameArena::releaseFrame(uint64_t frameIndex, FrameArenaStats& outStats)
+        {
+            auto* segments = frameSegments(frameIndex);
+            for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+            {
+                auto& segment = segments[i];
+
+                PageHeader* pages = nullptr;
+                LargeBlockHeader* largeBlocks = nullptr;
+
+                {
+                    auto lock = CreateLock(segment.lock);
+
+                    outStats.numAllocations += segment.stats.numAllocations;
+                    outStats.numLargeAllocations += segment.stats.numLargeAllocations;
+                    outStats.numPages += segment.stats.numPages;
+                    outStats.totalUsedMemory += segment.stats.totalUsedMemory;
+
+                    pages = segment.pages;
+                    largeBlocks = segment.largeBlocks;
+
+                    segment.cur = nullptr;
+                    segment.end = nullptr;
+                    segment.pages = nullptr;
+                    segment.largeBlocks = nullptr;
+                    segment.stats = FrameArenaStats();
+                }
+
+                while (pages)
+                {
+                    auto* page = pages;
+                    pages = page->next;
+
+#ifndef BUILD_RELEASE
+                    memset(page, EXPIRED_FRAME_MEMORY_PATTERN, m_pageSize);
+#endif
+                    m_pageAllocator.freePage(page);
+                }
+
+                while (largeBlocks)
+                {
+                    auto* block = largeBlocks;
+                    largeBlocks = block->next;
+
+#ifndef BUILD_RELEASE
+                    memset(block + 1, EXPIRED_FRAME_MEMORY_PATTERN, block->size);
+#endif
+                    FreeBlock(block);
+                }
+            }
+        }
+
+        void FrameArena::advanceFrame()
+        {
+            PC_SCOPE_LVL1(AdvanceFrameArena);
+
+            // collect stats of the frame that just finished, it stays alive for the next frames
+            {
+                FrameArenaStats stats;
+
+                auto* segments = frameSegments(frameIndex());
+                for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                {
+                    auto& segment = segments[i];
+                    auto lock = CreateLock(segment.lock);
+
+                    stats.numAllocations += segment.stats.numAllocations;
+                    stats.numLargeAllocations += segment.stats.numLargeAllocations;
+                    stats.numPages += segment.stats.numPages;
+                    stats.totalUsedMemory += segment.stats.totalUsedMemory;
+                }
+
+                m_lastFrameStats = stats;
+            }
+
+            // the frame we are entering was used N frames ago, it has expired
+            const auto newFrameIndex = frameIndex() + 1;
+
+            FrameArenaStats expiredStats;
+            releaseFrame(newFrameIndex, expiredStats);
+
+            m_frameIndex.store(newFrameIndex, std::memory_order_release);
+        }
+
+        //--
+
+        namespace helper
+        {
+            class DefaultFrameArena : public ISingleton
+            {
+                DECLARE_SINGLETON(DefaultFrameArena);
+
+            public:
+                INLINE FrameArena& arena() { return m_arena; }
+
+            private:
+                FrameArena m_arena;
+
+                virtual void deinit() override
+                {
+                }
+            };
+
+        } // helper
+
+        FrameArena& FrameArena::GetDefaultArena()
+        {
+            return helper::DefaultFrameArena::GetInstance().arena();
+        }
+
+        //--
+
+    } // mem
+} // base
@@ -9,6 +9,7 @@
 #include "build.h"
 #include "pageAllocator.h"
 #include "poolStatsInternal.h"
+#include "threadCacheInternal.h"
 
 #include "base/system/include/scopeLock.h"
 
@@ -25,21 +26,58 @@ namespace base
 
         //--
 
+        // run size from which we ask the system for large pages
+        static const uint64_t LARGE_PAGE_RUN_SIZE = 2ULL << 20;
+
+        // amount of memory in free pages we want to keep in each thread cache
+        static const uint32_t THREAD_CACHE_MEMORY_SIZE = 512U << 10;
+
+        static INLINE bool IsPageInRange(const void* page, const uint8_t* start, const uint8_t* end)
+        {
+            return (const uint8_t*)page >= start && (const uint8_t*)page < end;
+        }
+
+        //--
+
         PageAllocator::PageAllocator()
         {
         }
 
-        PageAllocator::PageAllocator(PoolID pool, uint32_t pageSize, uint32_t preallocatedPages, uint32_t freePagesToKeep)
+        PageAllocator::PageAllocator(PoolID pool, uint32_t pageSize, uint32_t preallocatedPages, uint32_t freePagesToKeep, uint32_t pagesPerRun)
         {
-            initialize(pool, pageSize, preallocatedPages, freePagesToKeep);
+            initialize(pool, pageSize, preallocatedPages, freePagesToKeep, pagesPerRun);
         }
 
         PageAllocator::~PageAllocator()
         {
-            ASSERT_EX(m_numPages == 0, "Releasing page allocator with pages still allocated from it :(");
+            ASSERT_EX(numPages() == 0, "Releasing page allocator with pages still allocated from it :(");
 
             uint64_t totalFreedMemory = 0;
 
+            // get back all the pages cached by threads
+            if (m_threadCaches)
+                flushThreadCaches();
+
+            // free pages that were allocated one by one, pages from runs and preallocated memory are freed in whole
+            if (m_pagesPerRun <= 1)
+            {
+                while (auto* page = popSharedPage())
+                    if (!IsPageInRange(page, m_preallocatedMemoryStart, m_preallocatedMemoryEnd))
+                        AFreeSystemMemory(page, m_pageSize);
+            }
+
+            if (m_runs)
+            {
+                for (uint32_t i = 0; i < m_numRuns; ++i)
+                {
+                    AFreeSystemMemory(m_runs[i].memory, m_runs[i].size);
+                    totalFreedMemory += m_runs[i].size;
+                }
+
+                FreeBlock(m_runs);
+                m_runs = nullptr;
+            }
+
             if (m_preallocatedMemoryStart)
             {
                 const auto preallocatedMemorySize = (m_preallocatedMemoryEnd - m_preallocatedMemoryStart);
@@ -48,17 +86,19 @@ namespace base
                 totalFreedMemory += preallocatedMemorySize;
             }
 
-            while (m_outstandingFreePageList)
+            if (m_threadCaches)
             {
-                auto* next = m_outstandingFreePageList;
-                AFreeSystemMemory(m_outstandingFreePageList, m_pageSize);
-                m_outstandingFreePageList = next;
+                for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                    m_threadCaches[i].~ThreadCache();
+
+                FreeBlock(m_threadCaches);
+                m_threadCaches = nullptr;
             }
 
             prv::TheInternalPoolStats.notifyFree(m_poolID, totalFreedMemory);
         }
 
-        void PageAllocator::initialize(PoolID pool /*= POOL_TEMP*/, uint32_t pageSize /*= 65536*/, uint32_t preallocatedPages /*= 0*/, uint32_t freePagesToKeep /*= INDEX_MAX*/)
+        void PageAllocator::initialize(PoolID pool /*= POOL_TEMP*/, uint32_t pageSize /*= 65536*/, uint32_t preallocatedPages /*= 0*/, uint32_t freePagesToKeep /*= INDEX_MAX*/, uint32_t pagesPerRun /*= 1*/)
         {
             ASSERT_EX(m_pageSize == 0, "Page allocator already initialized");
 
@@ -68,13 +108,25 @@ namespace base
             m_pageSize = Align<uint32_t>(pageSize, systemPageSize);
             m_maxFreePagesToRetain = freePagesToKeep;
             m_poolID = pool;
+            m_pagesPerRun = std::max<uint32_t>(1, pagesPerRun);
+
+            // setup thread caches, each thread keeps few free pages so most of the allocations don't touch the shared lists
+            m_threadCacheCapacity = std::clamp<uint32_t>(THREAD_CACHE_MEMORY_SIZE / m_pageSize, 2, 32);
+#ifdef PROTECT_FREE_PAGES
+            m_threadCacheCapacity = 0; // all free pages must be in the shared lists to be protected
+#endif
+            m_threadCacheBatch = std::max<uint32_t>(1, m_threadCacheCapacity / 2);
+
+            m_threadCaches = (ThreadCache*)AllocateBlock(m_poolID, sizeof(ThreadCache) * prv::NUM_THREAD_CACHE_SLOTS, alignof(ThreadCache));
+            for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                new (m_threadCaches + i) ThreadCache();
 
             // preallocate some memory for free pages
             // NOTE: those pages will never be released
             if (preallocatedPages)
             {
                 const auto memorySize = (uint64_t)m_pageSize * (uint64_t)preallocatedPages; // we may have > 4GB in pages...
-                const auto largePages = false;// memorySize >= (256ULL << 20); // arbitrary choice..
+                const auto largePages = memorySize >= LARGE_PAGE_RUN_SIZE;
                 m_preallocatedMemoryStart = (uint8_t*)AAllocSystemMemory(memorySize, largePages);
                 m_preallocatedMemoryEnd = m_preallocatedMemoryStart + memorySize;
 
@@ -109,127 +161,473 @@ namespace base
             }
         }
 
-        void* PageAllocator::allocatePage()
+        uint32_t PageAllocator::numPages() const
+        {
+            int numAllocated = 0;
+            if (m_threadCaches)
+                for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                    numAllocated += m_threadCaches[i].numAllocatedPages.load(std::memory_order_relaxed);
+
+            return (uint32_t)std::max<int>(0, numAllocated);
+        }
+
+        uint32_t PageAllocator::numFreePages() const
+        {
+            uint32_t numFree = m_numFreePages;
+            if (m_threadCaches)
+                for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+                    numFree += m_threadCaches[i].numFreePages.load(std::memory_order_relaxed);
+
+            return numFree;
+        }
+
+        //--
+
+        PageAllocator::FreePage* PageAllocator::popSharedPage()
         {
-            // try to allocate from free list
+            // preffer preallocated pool as it's not going away
+            if (auto* page = m_preallocatedFreePageList)
             {
-                auto lock = CreateLock(m_lock);
+                DEBUG_CHECK(m_numFreePages > 0);
+                m_numFreePages -= 1;
 
-                // use a free page if we can, preffer preallocated pool as it's not going away
-                if (auto* page = m_preallocatedFreePageList)
-                {
-                    DEBUG_CHECK(m_numFreePages > 0);
-                    m_numFreePages -= 1;
-                    m_numPages += 1; // if we have a page from a free list we can't use more memory than max
+#ifdef PROTECT_FREE_PAGES
+                DWORD oldProtect;
+                VirtualProtect(page, m_pageSize, PAGE_READWRITE, &oldProtect);
+#endif
 
+                m_preallocatedFreePageList = m_preallocatedFreePageList->next;
 #ifdef PROTECT_FREE_PAGES
-                    DWORD oldProtect;
-                    VirtualProtect(page, m_pageSize, PAGE_READWRITE, &oldProtect);
+                memset(page, 0xCC, m_pageSize);
 #endif
 
-                    m_preallocatedFreePageList = m_preallocatedFreePageList->next;
+                return page;
+            }
+            else if (auto* page = m_outstandingFreePageList)
+            {
+                DEBUG_CHECK(m_numFreePages > 0);
+                m_numFreePages -= 1;
+
 #ifdef PROTECT_FREE_PAGES
-                    memset(page, 0xCC, m_pageSize);
+                DWORD oldProtect;
+                VirtualProtect(page, m_pageSize, PAGE_READWRITE, &oldProtect);
+#endif
+                m_outstandingFreePageList = m_outstandingFreePageList->next;
+#ifdef PROTECT_FREE_PAGES
+                memset(page, 0xDD, m_pageSize);
 #endif
 
-                    return page;
-                }
-                else if (auto* page = m_outstandingFreePageList)
+                if (m_pagesPerRun > 1)
                 {
-                    DEBUG_CHECK(m_numFreePages > 0);
-                    m_numFreePages -= 1;
-                    m_numPages += 1; // if we have a page from a free list we can't use more memory than max
+                    auto* run = findRun(page);
+                    DEBUG_CHECK_EX(run != nullptr, "Free page is not from any run");
+                    if (run->numFreePages-- == m_pagesPerRun)
+                        m_numFreeRuns -= 1;
+                }
+
+                return page;
+            }
 
+            return nullptr;
+        }
+
+        void PageAllocator::pushSharedPage(FreePage* page)
+        {
 #ifdef PROTECT_FREE_PAGES
-                    DWORD oldProtect;
-                    VirtualProtect(page, m_pageSize, PAGE_READWRITE, &oldProtect);
+            memset(page, 0xAA, m_pageSize);
 #endif
-                    m_outstandingFreePageList = m_outstandingFreePageList->next;
+
+            if (IsPageInRange(page, m_preallocatedMemoryStart, m_preallocatedMemoryEnd))
+            {
+                page->next = m_preallocatedFreePageList;
+                m_preallocatedFreePageList = page;
+            }
+            else
+            {
+                page->next = m_outstandingFreePageList;
+                m_outstandingFreePageList = page;
+
+                if (m_pagesPerRun > 1)
+                {
+                    auto* run = findRun(page);
+                    DEBUG_CHECK_EX(run != nullptr, "Freed page is not from any run");
+                    if (++run->numFreePages == m_pagesPerRun)
+                        m_numFreeRuns += 1;
+                }
+            }
+
 #ifdef PROTECT_FREE_PAGES
-                    memset(page, 0xDD, m_pageSize);
+            DWORD oldProtect;
+            VirtualProtect(page, m_pageSize, PAGE_NOACCESS, &oldProtect);
 #endif
-                    return page;
-                }
 
-                // we will allocate a new page
-                m_numPages += 1;
-                m_maxPages = std::max<uint32_t>(m_maxPages, m_numPages);
+            m_numFreePages += 1;
+            m_maxFreePages = std::max<uint32_t>(m_maxFreePages, m_numFreePages);
+        }
+
+        PageAllocator::FreePage* PageAllocator::allocateSystemPages(uint32_t count)
+        {
+            // pages allocated one by one
+            if (m_pagesPerRun <= 1)
+            {
+                auto* page = (FreePage*)AAllocSystemMemory(m_pageSize, false);
+                if (page)
+                    page->next = nullptr;
+                return page;
             }
 
-            // no pages in free list, allocate a new one from system memory
-            void* systemPage = AAllocSystemMemory(m_pageSize, false);
-            DEBUG_CHECK_EX(nullptr != systemPage, "Out of memory");
-            if (nullptr == systemPage)
+            // allocate whole run of pages at once, big runs get the large pages
+            const auto runSize = (uint64_t)m_pageSize * (uint64_t)m_pagesPerRun;
+            auto* runMemory = (uint8_t*)AAllocSystemMemory(runSize, runSize >= LARGE_PAGE_RUN_SIZE);
+            if (!runMemory)
+                return nullptr;
+
+            prv::TheInternalPoolStats.notifyAllocation(m_poolID, runSize);
+
+            // the table of runs is grown outside of the lock, retry if some other thread was faster
+            PageRun* newRuns = nullptr;
+            uint32_t newMaxRuns = 0;
+
+            FreePage* ret = nullptr;
+            for (;;)
             {
-                // revert stats, should not matter since we will crash soon :P
                 {
                     auto lock = CreateLock(m_lock);
-                    m_numPages -= 1;
-                    TRACE_ERROR("Out of memory when allocating page in page allocator, pool {}, num pages: {}, page size: {}", m_poolID.name(), m_numPages, m_pageSize);
+
+                    if (m_numRuns == m_maxRuns && newMaxRuns > m_maxRuns)
+                    {
+                        if (m_numRuns)
+                            memcpy(newRuns, m_runs, sizeof(PageRun) * m_numRuns);
+
+                        std::swap(m_runs, newRuns); // old table is freed below
+                        m_maxRuns = newMaxRuns;
+                    }
+
+                    if (m_numRuns < m_maxRuns)
+                    {
+                        insertRun(runMemory, runSize);
+
+                        // pages we don't give to the caller go the shared list
+                        for (uint32_t i = 0; i < m_pagesPerRun; ++i)
+                        {
+                            auto* page = (FreePage*)(runMemory + (uint64_t)m_pageSize * i);
+                            if (i < count)
+                            {
+                                page->next = ret;
+                                ret = page;
+                            }
+                            else
+                            {
+                                pushSharedPage(page);
+                            }
+                        }
+
+                        break;
+                    }
+
+                    newMaxRuns = std::max<uint32_t>(16, m_maxRuns * 2);
                 }
 
+                if (newRuns)
+                    FreeBlock(newRuns);
+                newRuns = (PageRun*)AllocateBlock(m_poolID, sizeof(PageRun) * newMaxRuns, alignof(PageRun));
+            }
+
+            if (newRuns)
+                FreeBlock(newRuns);
+
+            return ret;
+        }
+
+        PageAllocator::PageRun* PageAllocator::findRun(const void* page) const
+        {
+            // last run that starts before the page
+            auto* run = std::upper_bound(m_runs, m_runs + m_numRuns, (const uint8_t*)page, [](const uint8_t* ptr, const PageRun& run) { return ptr < run.memory; });
+            if (run == m_runs)
+                return nullptr;
+
+            run -= 1;
+            return IsPageInRange(page, run->memory, run->memory + run->size) ? run : nullptr;
+        }
+
+        void PageAllocator::insertRun(uint8_t* memory, uint64_t size)
+        {
+            DEBUG_CHECK_EX(m_numRuns < m_maxRuns, "No space for the run");
+
+            auto* run = std::upper_bound(m_runs, m_runs + m_numRuns, memory, [](const uint8_t* ptr, const PageRun& run) { return ptr < run.memory; });
+            memmove(run + 1, run, sizeof(PageRun) * (m_runs + m_numRuns - run));
+            m_numRuns += 1;
+
+            *run = PageRun();
+            run->memory = memory;
+            run->size = size;
+        }
+
+        PageAllocator::ReleasedRun* PageAllocator::unlinkFreeRuns(uint32_t retain)
+        {
+            // only whole runs can be released and only as many as it takes to get down to the retained number of free pages
+            if (!m_numFreeRuns || m_numFreePages <= retain)
                 return nullptr;
+
+            auto numRunsToRelease = std::min<uint32_t>(m_numFreeRuns, (m_numFreePages - retain) / m_pagesPerRun);
+            if (!numRunsToRelease)
+                return nullptr;
+
+            for (uint32_t i = 0; i < m_numRuns && numRunsToRelease; ++i)
+            {
+                auto& run = m_runs[i];
+                if (run.numFreePages == m_pagesPerRun)
+                {
+                    run.released = true;
+                    numRunsToRelease -= 1;
+                }
+            }
+
+            // remove pages of the released runs from the free list
+            auto** prevPtr = &m_outstandingFreePageList;
+            while (auto* page = *prevPtr)
+            {
+                if (findRun(page)->released)
+                {
+                    *prevPtr = page->next;
+                    m_numFreePages -= 1;
+                }
+                else
+                {
+                    prevPtr = &page->next;
+                }
+            }
+
+            // remove the runs from the table, nothing uses the memory of released runs so the list is stored there
+            ReleasedRun* ret = nullptr;
+            uint32_t numRuns = 0;
+            for (uint32_t i = 0; i < m_numRuns; ++i)
+            {
+                const auto& run = m_runs[i];
+                if (run.released)
+                {
+                    auto* releasedRun = (ReleasedRun*)run.memory;
+                    releasedRun->next = ret;
+                    releasedRun->size = run.size;
+                    ret = releasedRun;
+                    m_numFreeRuns -= 1;
+                }
+                else
+                {
+                    m_runs[numRuns++] = run;
+                }
             }
 
-            return systemPage;
+            m_numRuns = numRuns;
+            return ret;
         }
 
-        void PageAllocator::freePage(void* page)
+        void PageAllocator::freeRuns(ReleasedRun* runs)
         {
-            DEBUG_CHECK_EX(page != nullptr, "Trying to free null page");
+            uint64_t totalFreedMemory = 0;
+            while (runs)
+            {
+                auto* run = runs;
+                runs = run->next;
 
-            // if page is NOT part of initial preallocation consider freeing it
-            bool preallocatedPage = false;
-            if ((uint8_t*)page >= m_preallocatedMemoryStart && (uint8_t*)page < m_preallocatedMemoryEnd)
-                preallocatedPage = true;
+                const auto size = run->size;
+                AFreeSystemMemory(run, size);
+                totalFreedMemory += size;
+            }
 
-            // decide if we should free the page completely or just put it in the free list
-            bool releasePageToSystem = false;
+            if (totalFreedMemory)
+                prv::TheInternalPoolStats.notifyFree(m_poolID, totalFreedMemory);
+        }
+
+        void* PageAllocator::refillThreadCache(ThreadCache& cache)
+        {
+            // grab a batch of free pages from the shared lists
+            FreePage* pages = nullptr;
             {
                 auto lock = CreateLock(m_lock);
-                DEBUG_CHECK(m_numPages > 0);
-                //DEBUG_CHECK(m_numFreePages <= m_maxFreePagesToRetain);
+                for (uint32_t i = 0; i < m_threadCacheBatch; ++i)
+                {
+                    auto* page = popSharedPage();
+                    if (!page)
+                        break;
 
-                m_numPages -= 1;
+                    page->next = pages;
+                    pages = page;
+                }
+            }
 
-#ifdef PROTECT_FREE_PAGES
-                memset(page, 0xAA, m_pageSize);
-#endif
-                if (preallocatedPage)
+            // no free pages, allocate new ones from system memory
+            if (!pages)
+            {
+                pages = allocateSystemPages(m_threadCacheBatch);
+                if (!pages)
+                    return nullptr;
+            }
+
+            // first page is for the caller, rest is kept in the thread cache
+            auto* ret = pages;
+            if (auto* rest = pages->next)
+            {
+                auto lock = CreateLock(cache.lock);
+
+                uint32_t numCached = cache.numFreePages.load(std::memory_order_relaxed);
+                while (rest)
                 {
-                    auto* freePage = (FreePage*)page;
-                    freePage->next = m_preallocatedFreePageList;
-                    m_preallocatedFreePageList = freePage;
+                    auto* next = rest->next;
+                    rest->next = cache.freePages;
+                    cache.freePages = rest;
+                    numCached += 1;
+                    rest = next;
+                }
 
-#ifdef PROTECT_FREE_PAGES
-                    DWORD oldProtect;
-                    VirtualProtect(freePage, m_pageSize, PAGE_NOACCESS, &oldProtect);
-#endif
-                    m_numFreePages += 1;
-                    m_maxFreePages = std::max<uint32_t>(m_maxFreePages, m_numFreePages);
+                cache.numFreePages.store(numCached, std::memory_order_relaxed);
+            }
+
+            updateMaxPages();
+            return ret;
+        }
+
+        void PageAllocator::returnPages(FreePage* pages)
+        {
+            FreePage* pagesToRelease = nullptr;
+            ReleasedRun* runsToRelease = nullptr;
+
+            // decide if we should free the page completely or just put it in the free list
+            {
+                auto lock = CreateLock(m_lock);
+                while (pages)
+                {
+                    auto* next = pages->next;
+
+                    // if page is NOT part of initial preallocation or a run consider freeing it
+                    if (m_pagesPerRun > 1 || m_numFreePages < m_maxFreePagesToRetain || IsPageInRange(pages, m_preallocatedMemoryStart, m_preallocatedMemoryEnd))
+                    {
+                        pushSharedPage(pages);
+                    }
+                    else
+                    {
+                        pages->next = pagesToRelease;
+                        pagesToRelease = pages;
+                    }
+
+                    pages = next;
                 }
-                else if (m_numFreePages < m_maxFreePagesToRetain)
+
+                // pages from runs can only be released with the whole run
+                if (m_pagesPerRun > 1)
+                    runsToRelease = unlinkFreeRuns(m_maxFreePagesToRetain);
+            }
+
+            freeRuns(runsToRelease);
+
+            // release the pages completely
+            while (pagesToRelease)
+            {
+                auto* page = pagesToRelease;
+                pagesToRelease = pagesToRelease->next;
+                AFreeSystemMemory(page, m_pageSize);
+            }
+        }
+
+        void PageAllocator::flushThreadCaches()
+        {
+            for (uint32_t i = 0; i < prv::NUM_THREAD_CACHE_SLOTS; ++i)
+            {
+                auto& cache = m_threadCaches[i];
+
+                FreePage* pages = nullptr;
                 {
-                    auto* freePage = (FreePage*)page;
-                    freePage->next = m_outstandingFreePageList;
-                    m_outstandingFreePageList = freePage;
+                    auto lock = CreateLock(cache.lock);
+                    pages = cache.freePages;
+                    cache.freePages = nullptr;
+                    cache.numFreePages.store(0, std::memory_order_relaxed);
+                }
 
-#ifdef PROTECT_FREE_PAGES
-                    DWORD oldProtect;
-                    VirtualProtect(freePage, m_pageSize, PAGE_NOACCESS, &oldProtect);
-#endif
-                    m_numFreePages += 1;
-                    m_maxFreePages = std::max<uint32_t>(m_maxFreePages, m_numFreePages);
+                if (pages)
+                    returnPages(pages);
+            }
+        }
+
+        void PageAllocator::updateMaxPages()
+        {
+            const auto numInUse = numPages();
+
+            auto lock = CreateLock(m_lock);
+            m_maxPages = std::max<uint32_t>(m_maxPages, numInUse);
+        }
+
+        //--
+
+        void* PageAllocator::allocatePage()
+        {
+            DEBUG_CHECK_EX(m_threadCaches != nullptr, "Page allocator not initialized");
+
+            // use a free page cached by this thread if we can
+            auto& cache = m_threadCaches[prv::GetThreadCacheSlot()];
+            {
+                auto lock = CreateLock(cache.lock);
+                cache.numAllocatedPages.store(cache.numAllocatedPages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+                if (auto* page = cache.freePages)
+                {
+                    cache.freePages = page->next;
+                    cache.numFreePages.store(cache.numFreePages.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+                    return page;
                 }
-                else
+            }
+
+            // get more pages to the cache
+            auto* page = refillThreadCache(cache);
+            DEBUG_CHECK_EX(nullptr != page, "Out of memory");
+            if (nullptr == page)
+            {
+                // revert stats, should not matter since we will crash soon :P
                 {
-                    releasePageToSystem = true;
+                    auto lock = CreateLock(cache.lock);
+                    cache.numAllocatedPages.store(cache.numAllocatedPages.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
                 }
+
+                TRACE_ERROR("Out of memory when allocating page in page allocator, pool {}, num pages: {}, page size: {}", m_poolID.name(), numPages(), m_pageSize);
+                return nullptr;
             }
 
-            // release the page completely
-            if (releasePageToSystem)
-                AFreeSystemMemory(page, m_pageSize);
+            return page;
+        }
+
+        void PageAllocator::freePage(void* page)
+        {
+            DEBUG_CHECK_EX(page != nullptr, "Trying to free null page");
+
+            // put the page in the cache of this thread, if there are too many pages there move some back to the shared lists
+            FreePage* pagesToReturn = nullptr;
+            {
+                auto& cache = m_threadCaches[prv::GetThreadCacheSlot()];
+                auto lock = CreateLock(cache.lock);
+                cache.numAllocatedPages.store(cache.numAllocatedPages.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+
+                auto* freePage = (FreePage*)page;
+                freePage->next = cache.freePages;
+                cache.freePages = freePage;
+
+                auto numCached = cache.numFreePages.load(std::memory_order_relaxed) + 1;
+                if (numCached > m_threadCacheCapacity)
+                {
+                    pagesToReturn = cache.freePages;
+
+                    auto* last = pagesToReturn;
+                    for (uint32_t i = 1; i < m_threadCacheBatch; ++i)
+                        last = last->next;
+
+                    cache.freePages = last->next;
+                    last->next = nullptr;
+                    numCached -= m_threadCacheBatch;
+                }
+
+                cache.numFreePages.store(numCached, std::memory_order_relaxed);
+            }
+
+            if (pagesToReturn)
+                returnPages(pagesToReturn);
         }
 
         void PageAllocator::retainCount(uint32_t retain)
@@ -244,6 +642,22 @@ namespace base
 
         void PageAllocator::releaseFreePages(uint32_t retain /*= 0*/)
         {
+            if (m_threadCaches)
+                flushThreadCaches();
+
+            // pages from runs are freed with the whole run
+            if (m_pagesPerRun > 1)
+            {
+                ReleasedRun* runsToRelease = nullptr;
+                {
+                    auto lock = CreateLock(m_lock);
+                    runsToRelease = unlinkFreeRuns(retain);
+                }
+
+                freeRuns(runsToRelease);
+                return;
+            }
+
             FreePage* pageListToFree = nullptr;
 
             // unlink pages we want to free
@@ -259,6 +673,8 @@ namespace base
 
                     page = next;
                 }
+
+                m_outstandingFreePageList = page;
             }
 
             // free pages to system
@@ -281,19 +697,27 @@ namespace base
             public:
                 PageAllocator& getAllocataor(PoolID pool)
                 {
-                    auto lock = CreateLock(m_lock);
-
                     auto& allocator = m_allocators[pool.value()];
-                    if (!allocator.initialized())
+
+                    // lock only for the initialization, this is called for every page
+                    if (!m_initialized[pool.value()].load(std::memory_order_acquire))
                     {
-                        uint32_t pageSize = 64 * 1024;
-                        uint32_t preallocatedPages = 0;
-                        uint32_t freePagesToKeep = 64;
+                        auto lock = CreateLock(m_lock);
+
+                        if (!allocator.initialized())
+                        {
+                            uint32_t pageSize = 64 * 1024;
+                            uint32_t preallocatedPages = 0;
+                            uint32_t freePagesToKeep = 64;
+                            uint32_t pagesPerRun = 32; // 2MB runs, released back to the system once all their pages are free
+
+                            if (pool.value() == POOL_TEMP)
+                                preallocatedPages = 256;  // 16 MB of temp pages
 
-                        if (pool.value() == POOL_TEMP)
-                            preallocatedPages = 256;  // 16 MB of temp pages
+                            allocator.initialize(pool, pageSize, preallocatedPages, freePagesToKeep, pagesPerRun);
+                        }
 
-                        allocator.initialize(pool, pageSize, preallocatedPages, freePagesToKeep);
+                        m_initialized[pool.value()].store(true, std::memory_order_release);
                     }
 
                     return allocator;
@@ -301,6 +725,7 @@ namespace base
 
             private:
                 PageAllocator m_allocators[256];
+                std::atomic<bool> m_initialized[256] = {};
                 SpinLock m_lock;
 
                 virtual void deinit() override
@@ -136,6 +136,12 @@ namespace base
             {
                 FATAL_ERROR(TempString("System allocation of {} bytes failed, reason: {}", size, errno));
             }
+
+#ifdef MADV_HUGEPAGE
+            // ask for transparent huge pages, this is only a hint so there's nothing to fall back from
+            if (largePages)
+                madvise(ret, allocSize, MADV_HUGEPAGE);
+#endif
 #else
     #error "Implement this"
 #endif
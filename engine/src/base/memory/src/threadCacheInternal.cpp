@@ -0,0 +1,31 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: allocator #]
+***/
+
+#include "build.h"
+#include "threadCacheInternal.h"
+
+namespace base
+{
+    namespace mem
+    {
+        namespace prv
+        {
+
+            static std::atomic<uint32_t> GNextThreadCacheSlot = 0;
+            static TYPE_TLS uint32_t GThreadCacheSlot = INDEX_MAX;
+
+            uint32_t GetThreadCacheSlot()
+            {
+                if (GThreadCacheSlot == INDEX_MAX)
+                    GThreadCacheSlot = GNextThreadCacheSlot++ % NUM_THREAD_CACHE_SLOTS;
+                return GThreadCacheSlot;
+            }
+
+        } // prv
+    } // mem
+} // base
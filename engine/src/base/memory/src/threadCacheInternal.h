@@ -0,0 +1,27 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: allocator #]
+***/
+
+#pragma once
+
+namespace base
+{
+    namespace mem
+    {
+        namespace prv
+        {
+
+            /// number of per-thread cache slots in the allocators that keep thread caches
+            static const uint32_t NUM_THREAD_CACHE_SLOTS = 64;
+
+            /// get the cache slot of the calling thread
+            /// NOTE: threads get consecutive slots so there's no sharing until we have more than NUM_THREAD_CACHE_SLOTS threads
+            extern uint32_t GetThreadCacheSlot();
+
+        } // prv
+    } // mem
+} // base
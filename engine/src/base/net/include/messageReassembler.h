@@ -36,24 +36,41 @@ namespace base
             virtual ReassemblerResult tryParseMessage(const uint8_t* messageData, uint32_t messageDataSize) const = 0;
         };
 
+        /// reassembler statistics, mostly to see how much data we had to copy
+        struct MessageReassemblerStats
+        {
+            uint64_t numBytesPushed = 0; // total data pushed into the reassembler
+            uint64_t numBytesCopied = 0; // data that had to be copied into the internal storage (messages split between pushes)
+            uint64_t numMessagesDirect = 0; // messages returned directly from the pushed data, without any copy
+            uint64_t numMessagesCopied = 0; // messages that had to be reassembled in the internal storage
+            uint32_t numStorageAllocations = 0; // number of times the internal storage had to be (re)allocated
+        };
+
         /// helper class for reassembling data coming from the network stream (usually TCP) into packets/messages
+        /// NOTE: the pushed data is NOT copied unless needed - messages fully contained in the pushed data are returned directly from it,
+        /// only the data of messages that are split between pushes is gathered in the internal storage
         class BASE_NET_API MessageReassembler : public NoCopy
         {
         public:
             MessageReassembler(IMessageReassemblerInspector* inspector, uint32_t initialStorageSize = 1024, uint32_t maxStorageSize = 100U << 20, uint32_t maxHeaderSize = 10 << 10);
             ~MessageReassembler();
 
-            /// push new data into storage
+            /// push new data for reassembly
+            /// NOTE: the data is referenced, not copied, it must stay valid until reassemble() returns something else than ReassemblerResult::Valid
             /// NOTE: pushing to much data without any active header will cause a channel corruption situation
             /// NOTE: returns false on serious errors
             bool pushData(const void* data, uint32_t dataSize);
 
             /// process the currently stored data, try to assemble messages of of them
             /// If we have a valid message a ReassemblerResult::Valid will be returned with the message data passed via outMessageData/outMessageSize
-            /// ReassemblerResult::NeedsMore is returned if we need more data to do something
+            /// NOTE: returned message data may point directly into the pushed data and is only valid until the next call
+            /// ReassemblerResult::NeedsMore is returned if we need more data to do something, at this point the pushed data is no longer referenced
             /// Watch out for ReassemblerResult::Corruption that will be called if we have ANY problems with the connection
             ReassemblerResult reassemble(const uint8_t*& outMessageData, uint32_t& outMessageSize);
 
+            /// get the statistics
+            INLINE const MessageReassemblerStats& stats() const { return m_stats; }
+
         private:
             IMessageReassemblerInspector* m_inspector;
 
@@ -63,6 +80,11 @@ namespace base
             uint32_t m_storageCapacity;
             uint32_t m_storagePos;
 
+            // data pushed by the user that was not yet processed, not owned by us
+            const uint8_t* m_externalPtr;
+            uint32_t m_externalSize;
+            uint32_t m_externalPos;
+
             // if known this is the expected size of the message we are waiting for
             uint32_t m_expectedMessageSize;
 
@@ -76,8 +98,23 @@ namespace base
             const uint32_t m_maxStorageSize;
             const uint32_t m_maxHeaderSize;
 
+            // stats
+            MessageReassemblerStats m_stats;
+
             // put us in the error state
             void fatalError(StringView<char> reason);
+
+            // make sure we have space for given amount of data in the storage
+            bool reserveStorage(uint32_t additionalSize);
+
+            // copy up to given amount of the unprocessed pushed data into the storage
+            bool copyExternalData(uint32_t maxSize);
+
+            // parse header from given data, sets the expected message size
+            ReassemblerResult parseHeader(const uint8_t* data, uint32_t dataSize);
+
+            // validate the full message
+            ReassemblerResult parseMessage(const uint8_t* data, const uint8_t*& outMessageData, uint32_t& outMessageSize);
         };
 
     } // net
@@ -29,8 +29,16 @@ namespace base
         public:
             virtual ~IMessageReplicatorDataSink();
 
-            /// sink data, we assume that we are the only sender thus we may see fragmented calls instead of going "atomic"
-            virtual void sendMessage(const void* data, uint32_t size) = 0;
+            /// sink message composed from multiple parts (ie. header + payload), parts should be sent as one message without merging them first
+            /// NOTE: the parts are only valid for the duration of the call
+            virtual void sendMessage(const socket::BlockPart* parts, uint32_t numParts) = 0;
+
+            /// sink single message
+            INLINE void sendMessage(const void* data, uint32_t size)
+            {
+                socket::BlockPart part(data, size);
+                sendMessage(&part, 1);
+            }
         };
 
         //--
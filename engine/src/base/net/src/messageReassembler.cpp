@@ -23,8 +23,14 @@ namespace base
 
         static const uint32_t MIN_CAPACITY = 1024;
 
+        // how much data we move into the storage at once while trying to find a header that was split between pushes
+        static const uint32_t HEADER_COPY_STEP = 64;
+
         MessageReassembler::MessageReassembler(IMessageReassemblerInspector* inspector, uint32_t initialStorageSize /*= 1024*/, uint32_t maxStorageSize /*= 100U << 20*/, uint32_t maxHeaderSize /*= 10 << 10*/)
             : m_inspector(inspector)
+            , m_externalPtr(nullptr)
+            , m_externalSize(0)
+            , m_externalPos(0)
             , m_maxStorageSize(maxStorageSize)
             , m_maxHeaderSize(maxHeaderSize)
             , m_expectedMessageSize(0)
@@ -34,7 +40,8 @@ namespace base
             // create initial storage
             m_storageCapacity = std::max<uint32_t>(MIN_CAPACITY, initialStorageSize);
             m_storagePos = 0;
-            m_storagePtr = (uint8_t*) MemAlloc(POOL_NEW, initialStorageSize, 1);
+            m_storagePtr = (uint8_t*) MemAlloc(POOL_NET, m_storageCapacity, 1);
+            m_stats.numStorageAllocations += 1;
         }
 
         MessageReassembler::~MessageReassembler()
@@ -53,6 +60,10 @@ namespace base
                 TRACE_ERROR("NetCorruption: {}", reason);
                 m_corrupted = true;
 
+                m_externalPtr = nullptr;
+                m_externalSize = 0;
+                m_externalPos = 0;
+
                 if (m_storagePtr)
                 {
                     MemFree(m_storagePtr);
@@ -61,54 +72,155 @@ namespace base
             }
         }
 
+        bool MessageReassembler::reserveStorage(uint32_t additionalSize)
+        {
+            // everything was consumed, start from the beginning
+            if (m_readPos == m_storagePos)
+            {
+                m_readPos = 0;
+                m_storagePos = 0;
+            }
+
+            // do we have enough storage space ?
+            if (m_storagePos + additionalSize <= m_storageCapacity)
+                return true;
+
+            // try to GC space that was already freed
+            if (m_readPos > 0)
+            {
+                auto validRemainingDataSize = m_storagePos - m_readPos;
+                memmove(m_storagePtr, m_storagePtr + m_readPos, validRemainingDataSize);
+                m_stats.numBytesCopied += validRemainingDataSize;
+                m_storagePos = validRemainingDataSize;
+                m_readPos = 0;
+
+                if (m_storagePos + additionalSize <= m_storageCapacity)
+                    return true;
+            }
+
+            // we won't ever fit
+            const auto requiredSize = (uint64_t)m_storagePos + additionalSize;
+            if (requiredSize > m_maxStorageSize)
+            {
+                fatalError(TempString("To much data in the unprocessed buffer {} (limit is {})", MemSize(requiredSize), MemSize(m_maxStorageSize)));
+                return false;
+            }
+
+            // calculate required size, in proper steps
+            uint64_t newCapacity = m_storageCapacity * 2ULL;
+            while (requiredSize > newCapacity)
+                newCapacity *= 2;
+            newCapacity = std::max<uint64_t>(requiredSize, std::min<uint64_t>(newCapacity, m_maxStorageSize));
+
+            // allocate new buffer, may fail (we can handle really large data here)
+            auto newBuffer = (uint8_t*) MemRealloc(POOL_NET, m_storagePtr, newCapacity, 1);
+            if (!newBuffer)
+            {
+                fatalError(TempString("Out of memory while trying to resize storage to {}", MemSize(newCapacity)));
+                return false;
+            }
+
+            m_storagePtr = newBuffer;
+            m_storageCapacity = (uint32_t)newCapacity;
+            m_stats.numStorageAllocations += 1;
+            return true;
+        }
+
+        bool MessageReassembler::copyExternalData(uint32_t maxSize)
+        {
+            const auto copySize = std::min<uint32_t>(maxSize, m_externalSize - m_externalPos);
+            if (copySize > 0)
+            {
+                if (!reserveStorage(copySize))
+                    return false;
+
+                memcpy(m_storagePtr + m_storagePos, m_externalPtr + m_externalPos, copySize);
+                m_storagePos += copySize;
+                m_externalPos += copySize;
+                m_stats.numBytesCopied += copySize;
+            }
+
+            return true;
+        }
+
         bool MessageReassembler::pushData(const void* data, uint32_t dataSize)
         {
             // oh well
             if (m_corrupted)
                 return false;
 
-            // we won't ever fit
-            if (m_storagePos + dataSize > m_maxStorageSize)
-            {
-                fatalError(TempString("To much data in the unprocessed buffer {} (limit is {})", MemSize(m_storagePos + dataSize), MemSize(m_maxStorageSize)));
+            // we were not given a chance to process all of the previous data, we can't keep referencing it
+            if (!copyExternalData(m_externalSize - m_externalPos))
                 return false;
-            }
 
-            // do we have enough storage space ?
-            if (m_storagePos + dataSize > m_storageCapacity)
+            // reference the new data, it will be copied only if needed
+            m_externalPtr = (const uint8_t*)data;
+            m_externalSize = dataSize;
+            m_externalPos = 0;
+            m_stats.numBytesPushed += dataSize;
+            return true;
+        }
+
+        ReassemblerResult MessageReassembler::parseHeader(const uint8_t* data, uint32_t dataSize)
+        {
+            uint32_t messageSize = 0;
+            switch (m_inspector->tryParseHeader(data, dataSize, messageSize))
             {
-                // try to GC space that was already freed
-                if (m_readPos > 0)
+                case ReassemblerResult::Valid:
                 {
-                    auto validRemainingDataSize  = m_storagePos - m_readPos;
-                    memmove(m_storagePtr, m_storagePtr + m_readPos, validRemainingDataSize);
-                    m_storagePos = validRemainingDataSize;
-                    m_readPos = 0;
-                }
+                    ASSERT_EX(messageSize != 0, "Message can't be empty");
+
+                    // we will never be able to reassemble such message
+                    if (messageSize > m_maxStorageSize)
+                    {
+                        fatalError(TempString("Message size {} is over the limit {}", MemSize(messageSize), MemSize(m_maxStorageSize)));
+                        return ReassemblerResult::Corruption;
+                    }
 
-                // calculate required size, in proper steps
-                uint32_t newCapacity = m_storageCapacity * 2;
-                while (m_storagePos + dataSize > m_storageCapacity)
-                    newCapacity *= 2;
+                    // we got a header in the data
+                    m_expectedMessageSize = messageSize;
+                    return ReassemblerResult::Valid;
+                }
 
-                // allocate new buffer, may fail (we can handle really large data here)
-                auto newBuffer  = MemRealloc(POOL_NET, m_storagePtr, newCapacity, 1);
-                if (!newBuffer)
+                case ReassemblerResult::NeedsMore:
                 {
-                    fatalError(TempString("Out of memory while trying to resize storage to {}", MemSize(newCapacity)));
+                    // hold on a minute, check if the header size even makes sense
+                    if (dataSize > m_maxHeaderSize)
+                    {
+                        fatalError("Header not found");
+                        return ReassemblerResult::Corruption;
+                    }
 
-                    MemFree(m_storagePtr);
-                    m_storagePtr = nullptr;
+                    return ReassemblerResult::NeedsMore;
+                }
+            }
 
-                    m_corrupted = true;
-                    return false;
+            // we got a header in the data
+            fatalError("Header corruption detected");
+            return ReassemblerResult::Corruption;
+        }
+
+        ReassemblerResult MessageReassembler::parseMessage(const uint8_t* data, const uint8_t*& outMessageData, uint32_t& outMessageSize)
+        {
+            switch (m_inspector->tryParseMessage(data, m_expectedMessageSize))
+            {
+                case ReassemblerResult::Valid:
+                {
+                    outMessageData = data;
+                    outMessageSize = m_expectedMessageSize;
+                    m_expectedMessageSize = 0;
+                    return ReassemblerResult::Valid;
+                }
+
+                case ReassemblerResult::NeedsMore:
+                {
+                    fatalError("Message size reported in header was invalid");
+                    return ReassemblerResult::Corruption;
                 }
             }
 
-            // append data
-            memcpy(m_storagePtr + m_storagePos, data, dataSize);
-            m_storagePos += dataSize;
-            return true;
+            fatalError("Message corruption detected");
+            return ReassemblerResult::Corruption;
         }
 
         ReassemblerResult MessageReassembler::reassemble(const uint8_t*& outMessageData, uint32_t& outMessageSize)
@@ -117,75 +229,85 @@ namespace base
             if (m_corrupted)
                 return ReassemblerResult::Corruption;
 
-            // if we don't have a header try to establish one
-            if (0 == m_expectedMessageSize)
+            // finish the message that was split between pushes, this requires the data to be moved to the storage so it's continuous
+            if (m_readPos < m_storagePos)
             {
-                uint32_t messageSize = 0;
-                switch (m_inspector->tryParseHeader(m_storagePtr + m_readPos, m_storagePos - m_readPos, messageSize))
+                // if we don't have a header try to establish one, move only as much data as needed
+                while (0 == m_expectedMessageSize)
                 {
-                    case ReassemblerResult::Valid:
+                    const auto ret = parseHeader(m_storagePtr + m_readPos, m_storagePos - m_readPos);
+                    if (ret == ReassemblerResult::Corruption)
+                        return ret;
+
+                    if (ret == ReassemblerResult::NeedsMore)
                     {
-                        ASSERT_EX(messageSize != 0, "Message can't be empty");
+                        if (m_externalPos == m_externalSize)
+                            return ReassemblerResult::NeedsMore;
 
-                        // we got a header in the data
-                        m_expectedMessageSize = messageSize;
-                        break;
+                        if (!copyExternalData(HEADER_COPY_STEP))
+                            return ReassemblerResult::Corruption;
                     }
+                }
 
-                    case ReassemblerResult::NeedsMore:
-                    {
-                        // hold on a minute, check if the header size even makes sense
-                        if (m_storagePos > m_maxHeaderSize)
-                        {
-                            fatalError("Header not found");
-                            return ReassemblerResult::Corruption;
-                        }
+                // copy the rest of the message, we may still not have all of it
+                const auto storedSize = m_storagePos - m_readPos;
+                if (storedSize < m_expectedMessageSize)
+                {
+                    if (!copyExternalData(m_expectedMessageSize - storedSize))
+                        return ReassemblerResult::Corruption;
 
+                    if (m_storagePos - m_readPos < m_expectedMessageSize)
                         return ReassemblerResult::NeedsMore;
-                    }
+                }
 
-                    case ReassemblerResult::Corruption:
-                    default:
-                    {
-                        // we got a header in the data
-                        fatalError("Header corruption detected");
+                const auto ret = parseMessage(m_storagePtr + m_readPos, outMessageData, outMessageSize);
+                if (ret == ReassemblerResult::Valid)
+                {
+                    m_readPos += outMessageSize;
+                    m_stats.numMessagesCopied += 1;
+                }
+
+                return ret;
+            }
+
+            // nothing is stored, work directly on the pushed data
+            const auto* data = m_externalPtr + m_externalPos;
+            const auto dataSize = m_externalSize - m_externalPos;
+
+            // if we don't have a header try to establish one
+            if (0 == m_expectedMessageSize)
+            {
+                const auto ret = parseHeader(data, dataSize);
+                if (ret == ReassemblerResult::Corruption)
+                    return ret;
+
+                // keep the partial header for later
+                if (ret == ReassemblerResult::NeedsMore)
+                {
+                    if (!copyExternalData(dataSize))
                         return ReassemblerResult::Corruption;
-                    }
+                    return ReassemblerResult::NeedsMore;
                 }
             }
 
-            // if we have enough data for a message than process it
+            // whole message is in the pushed data, return it directly
             ASSERT(m_expectedMessageSize > 0);
-            if (m_storagePos >= (m_readPos + m_expectedMessageSize))
+            if (dataSize >= m_expectedMessageSize)
             {
-                switch (m_inspector->tryParseMessage(m_storagePtr + m_readPos, m_expectedMessageSize))
+                const auto ret = parseMessage(data, outMessageData, outMessageSize);
+                if (ret == ReassemblerResult::Valid)
                 {
-                    case ReassemblerResult::Valid:
-                    {
-                        outMessageData = m_storagePtr + m_readPos;
-                        outMessageSize = m_expectedMessageSize;
-                        m_readPos += m_expectedMessageSize;
-                        m_expectedMessageSize = 0;
-                        return ReassemblerResult::Valid;
-                    }
-
-                    case ReassemblerResult::NeedsMore:
-                    {
-                        fatalError("Message size reported in header was invalid");
-                        return ReassemblerResult::NeedsMore;
-                    }
-
-                    case ReassemblerResult::Corruption:
-                    default:
-                    {
-                        // we got a header in the data
-                        fatalError("Message corruption detected");
-                        return ReassemblerResult::Corruption;
-                    }
+                    m_externalPos += outMessageSize;
+                    m_stats.numMessagesDirect += 1;
                 }
+
+                return ret;
             }
 
-            // we need more data
+            // we need more data, keep the partial message in the storage, reserve space for the whole message upfront
+            if (!reserveStorage(m_expectedMessageSize) || !copyExternalData(dataSize))
+                return ReassemblerResult::Corruption;
+
             return ReassemblerResult::NeedsMore;
         }
 
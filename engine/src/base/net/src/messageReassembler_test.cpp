@@ -8,6 +8,7 @@
 
 #include "build.h"
 #include "base/test/include/gtest/gtest.h"
+#include "base/system/include/timedScope.h"
 
 #include "messageReassembler.h"
 
@@ -52,6 +53,82 @@ namespace test
         }
     };
 
+    static uint32_t NextRandom(uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)(state >> 33);
+    }
+
+    // messages with the size stored in the first 4 bytes and payload that depends on the size
+    class SizePrefixedParser : public IMessageReassemblerInspector
+    {
+    public:
+        mutable uint32_t m_numMessagesParser = 0;
+
+        virtual ReassemblerResult tryParseHeader(const uint8_t* currentData, uint32_t currentDataSize, uint32_t& outTotalMessageSize) const override final
+        {
+            if (currentDataSize < sizeof(uint32_t))
+                return ReassemblerResult::NeedsMore;
+
+            memcpy(&outTotalMessageSize, currentData, sizeof(uint32_t));
+            return outTotalMessageSize >= sizeof(uint32_t) ? ReassemblerResult::Valid : ReassemblerResult::Corruption;
+        }
+
+        virtual ReassemblerResult tryParseMessage(const uint8_t* messageData, uint32_t messageDataSize) const override final
+        {
+            for (uint32_t i = sizeof(uint32_t); i < messageDataSize; ++i)
+                if (messageData[i] != (uint8_t)(i + messageDataSize))
+                    return ReassemblerResult::Corruption;
+
+            m_numMessagesParser += 1;
+            return ReassemblerResult::Valid;
+        }
+
+        static void BuildStream(uint32_t numMessages, uint32_t maxMessageSize, uint64_t seed, Array<uint8_t>& outStream)
+        {
+            for (uint32_t i = 0; i < numMessages; ++i)
+            {
+                const auto size = (uint32_t)sizeof(uint32_t) + (uint32_t)(NextRandom(seed) % maxMessageSize);
+                auto* ptr = outStream.allocateUninitialized(size);
+                memcpy(ptr, &size, sizeof(uint32_t));
+                for (uint32_t j = sizeof(uint32_t); j < size; ++j)
+                    ptr[j] = (uint8_t)(j + size);
+            }
+        }
+    };
+
+    // push the stream in random chunks, each chunk is in a temporary buffer that gets trashed after all messages were processed
+    static bool ReassembleStream(MessageReassembler& dut, const Array<uint8_t>& stream, uint32_t maxChunkSize, uint64_t seed)
+    {
+        Array<uint8_t> chunk;
+        chunk.resize(maxChunkSize);
+
+        uint32_t pos = 0;
+        while (pos < stream.size())
+        {
+            const auto chunkSize = std::min<uint32_t>(stream.size() - pos, 1 + (NextRandom(seed) % maxChunkSize));
+            memcpy(chunk.data(), stream.data() + pos, chunkSize);
+            pos += chunkSize;
+
+            if (!dut.pushData(chunk.data(), chunkSize))
+                return false;
+
+            for (;;)
+            {
+                const uint8_t* messagePtr = nullptr;
+                uint32_t messageSize = 0;
+                auto ret = dut.reassemble(messagePtr, messageSize);
+                if (ret == ReassemblerResult::NeedsMore)
+                    break;
+                if (ret == ReassemblerResult::Corruption)
+                    return false;
+            }
+
+            memset(chunk.data(), 0xCD, chunkSize);
+        }
+
+        return true;
+    }
 
 } // test
 
@@ -205,3 +282,62 @@ TEST(MessageReassembler, ManyMessagesFromLargeData)
     ASSERT_EQ(numMessages, parser.m_numMessagesParser);
 }
 
+TEST(MessageReassembler, RandomChunks)
+{
+    Array<uint8_t> stream;
+    test::SizePrefixedParser::BuildStream(2000, 3000, 1, stream);
+
+    for (uint32_t maxChunkSize : { 1u, 3u, 100u, 1500u, 65536u, stream.size() })
+    {
+        test::SizePrefixedParser parser;
+        MessageReassembler dut(&parser);
+
+        ASSERT_TRUE(test::ReassembleStream(dut, stream, maxChunkSize, maxChunkSize));
+        EXPECT_EQ(2000, parser.m_numMessagesParser) << "Chunk size " << maxChunkSize;
+        EXPECT_EQ(2000, dut.stats().numMessagesDirect + dut.stats().numMessagesCopied) << "Chunk size " << maxChunkSize;
+        EXPECT_EQ(stream.size(), dut.stats().numBytesPushed) << "Chunk size " << maxChunkSize;
+    }
+}
+
+TEST(MessageReassembler, WholeMessagesAreNotCopied)
+{
+    Array<uint8_t> stream;
+    test::SizePrefixedParser::BuildStream(100, 500, 2, stream);
+
+    test::SizePrefixedParser parser;
+    MessageReassembler dut(&parser);
+    dut.pushData(stream.data(), stream.dataSize());
+
+    const uint8_t* messagePtr = nullptr;
+    uint32_t messageSize = 0;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        ASSERT_EQ(ReassemblerResult::Valid, dut.reassemble(messagePtr, messageSize));
+        ASSERT_TRUE(messagePtr >= stream.data() && messagePtr + messageSize <= stream.data() + stream.size());
+    }
+
+    ASSERT_EQ(ReassemblerResult::NeedsMore, dut.reassemble(messagePtr, messageSize));
+    EXPECT_EQ(100, dut.stats().numMessagesDirect);
+    EXPECT_EQ(0, dut.stats().numBytesCopied);
+}
+
+TEST(MessageReassembler, DISABLED_Throughput)
+{
+    Array<uint8_t> stream;
+    test::SizePrefixedParser::BuildStream(200000, 2000, 3, stream);
+
+    for (uint32_t maxChunkSize : { 1500u, 16384u, 65536u })
+    {
+        test::SizePrefixedParser parser;
+        MessageReassembler dut(&parser);
+
+        ScopeTimer timer;
+        ASSERT_TRUE(test::ReassembleStream(dut, stream, maxChunkSize, maxChunkSize));
+        const auto time = timer.timeElapsed();
+
+        const auto& stats = dut.stats();
+        TRACE_INFO("Reassembled {} messages ({}) in chunks up to {}: {}/s, {} direct, {} copied, {} of data copied, {} allocations",
+            parser.m_numMessagesParser, MemSize(stats.numBytesPushed), maxChunkSize, MemSize(stats.numBytesPushed / std::max(time, 0.0001)),
+            stats.numMessagesDirect, stats.numMessagesCopied, MemSize(stats.numBytesCopied), stats.numStorageAllocations);
+    }
+}
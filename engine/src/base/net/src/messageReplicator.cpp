@@ -13,7 +13,6 @@
 #include "messageObjectRepository.h"
 #include "messagePool.h"
 
-#include "base/socket/include/blockBuilder.h"
 #include "base/replication/include/replicationBitReader.h"
 #include "base/replication/include/replicationBitWriter.h"
 #include "base/replication/include/replicationDataModel.h"
@@ -132,14 +131,11 @@ namespace base
 
             virtual void reportNewString(const replication::DataMappedID id, StringView<char> txt) override final
             {
-                socket::BlockBuilder msg;
-
                 StringUpdateHeader header;
                 header.m_id = id;
-                msg.write(&header, sizeof(header));
-                msg.write(txt.data(), txt.length());
 
-                m_sink->sendMessage(msg.data(), msg.size());
+                const socket::BlockPart parts[2] = { socket::BlockPart(&header, sizeof(header)), socket::BlockPart(txt.data(), txt.length()) };
+                m_sink->sendMessage(parts, 2);
             }
 
             virtual void reportNewPath(const replication::DataMappedID id, const replication::DataMappedID textId, const replication::DataMappedID parentPathId) override final
@@ -202,24 +198,20 @@ namespace base
             replication::BitWriter bitWriter;
             dataModel->encodeFromNativeData(data, knowledgeUpdater, bitWriter);
 
-            // build and send packet
+            // send packet
             {
-                // make a packet
-                socket::BlockBuilder msg;
-
                 // write data header
                 CallHeader header;
                 header.m_messageTypeId = messageTypeId;
                 header.m_objectId = targetObjectId;
-                msg.write(&header, sizeof(header));
-                msg.write(bitWriter.data(), bitWriter.byteSize());
 
-                // push to sink for actual sending
-                dataSink->sendMessage(msg.data(), msg.size());
+                // push to sink for actual sending, the encoded data is passed directly without merging it with the header first
+                const socket::BlockPart parts[2] = { socket::BlockPart(&header, sizeof(header)), socket::BlockPart(bitWriter.data(), bitWriter.byteSize()) };
+                dataSink->sendMessage(parts, 2);
 
                 // update internal stats
                 auto lock  = CreateLock(m_statsLock);
-                m_stats.countSentMessage(dataType, msg.size());
+                m_stats.countSentMessage(dataType, sizeof(header) + bitWriter.byteSize());
             }
         }
 
@@ -159,7 +159,7 @@ namespace base
                     {
                         auto header  = (const TcpMessageTransportHeader*) messageData;
 
-                        TRACE_INFO("TcpMessageClient: reassembled message, size {} from '{}'", header->m_length, m_client.remoteAddress());
+                        TRACE_SPAM("TcpMessageClient: reassembled message, size {} from '{}'", header->m_length, m_client.remoteAddress());
 
                         TcpMessageExecutorForwarder executor(*m_executor, *m_pool, *m_objects);
                         m_replicator->processMessageData(messageData + sizeof(TcpMessageTransportHeader), header->m_length - sizeof(TcpMessageTransportHeader), &executor);
@@ -170,6 +170,7 @@ namespace base
                     {
                         TRACE_ERROR("TcpMessageClient: Fatal error on message reassembly from '{}'", m_client.remoteAddress());
                         m_fatalError = true;
+                        needsMore = false;
                         break;
                     }
                 }
@@ -85,18 +85,36 @@ namespace base
             , m_id(id)
         {}
 
-        void TcpMessageServerReplicatorDataSink::sendMessage(const void* data, uint32_t size)
+        static const uint32_t MAX_MESSAGE_PARTS = 8;
+
+        static uint32_t PrepareTransportParts(const socket::BlockPart* parts, uint32_t numParts, TcpMessageTransportHeader& outHeader, socket::BlockPart* outParts)
         {
-            TcpMessageTransportHeader header;
-            header.m_magic = 0xF00D;
-            header.m_length = sizeof(header) + size;
+            ASSERT_EX(numParts < MAX_MESSAGE_PARTS, "To many message parts");
 
+            uint32_t size = 0;
             CRC32 crc;
-            crc.append(data, size);
-            header.m_checksum = (uint16_t)crc.crc();
-            m_server.send(m_id, &header, sizeof(header));
+            for (uint32_t i = 0; i < numParts; ++i)
+            {
+                crc.append(parts[i].dataPtr, parts[i].size);
+                size += parts[i].size;
+                outParts[i + 1] = parts[i];
+            }
+
+            outHeader.m_magic = 0xF00D;
+            outHeader.m_length = sizeof(outHeader) + size;
+            outHeader.m_checksum = (uint16_t)crc.crc();
+            outParts[0] = socket::BlockPart(&outHeader, sizeof(outHeader));
+            return numParts + 1;
+        }
+
+        void TcpMessageServerReplicatorDataSink::sendMessage(const socket::BlockPart* parts, uint32_t numParts)
+        {
+            TcpMessageTransportHeader header;
+            socket::BlockPart transportParts[MAX_MESSAGE_PARTS];
+            const auto numTransportParts = PrepareTransportParts(parts, numParts, header, transportParts);
 
-            m_server.send(m_id, data, size);
+            // header and payload go out as one message so they can't get interleaved with messages sent from other threads
+            m_server.send(m_id, transportParts, numTransportParts);
         }
 
         //--
@@ -105,18 +123,13 @@ namespace base
             : m_client(client)
         {}
 
-        void TcpMessageClientReplicatorDataSink::sendMessage(const void* data, uint32_t size)
+        void TcpMessageClientReplicatorDataSink::sendMessage(const socket::BlockPart* parts, uint32_t numParts)
         {
             TcpMessageTransportHeader header;
-            header.m_magic = 0xF00D;
-            header.m_length = sizeof(header) + size;
-
-            CRC32 crc;
-            crc.append(data, size);
-            header.m_checksum = (uint16_t)crc.crc();
-            m_client.send(&header, sizeof(header));
+            socket::BlockPart transportParts[MAX_MESSAGE_PARTS];
+            const auto numTransportParts = PrepareTransportParts(parts, numParts, header, transportParts);
 
-            m_client.send(data, size);
+            m_client.send(transportParts, numTransportParts);
         }
 
         //--
@@ -89,7 +89,8 @@ namespace base
         public:
             TcpMessageServerReplicatorDataSink(socket::tcp::Server& server, const socket::ConnectionID id);
 
-            virtual void sendMessage(const void* data, uint32_t size) override final;
+            using IMessageReplicatorDataSink::sendMessage;
+            virtual void sendMessage(const socket::BlockPart* parts, uint32_t numParts) override final;
 
         private:
             socket::tcp::Server& m_server;
@@ -103,7 +104,8 @@ namespace base
         public:
             TcpMessageClientReplicatorDataSink(socket::tcp::Client& client);
 
-            virtual void sendMessage(const void* data, uint32_t size) override final;
+            using IMessageReplicatorDataSink::sendMessage;
+            virtual void sendMessage(const socket::BlockPart* parts, uint32_t numParts) override final;
 
         private:
             socket::tcp::Client& m_client;
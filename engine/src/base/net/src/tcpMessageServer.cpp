@@ -186,7 +186,7 @@ namespace base
                         {
                             auto header  = (const TcpMessageTransportHeader*) messageData;
 
-                            TRACE_INFO("TcpMessageServer: reassembled message, size {} from '{}'", header->m_length, info->m_address);
+                            TRACE_SPAM("TcpMessageServer: reassembled message, size {} from '{}'", header->m_length, info->m_address);
 
                             TcpMessageExecutorForwarder executor(info->m_executor, *m_pool, *m_objects);
                             info->m_replicator.processMessageData(messageData + sizeof(TcpMessageTransportHeader), header->m_length - sizeof(TcpMessageTransportHeader), &executor);
@@ -197,6 +197,7 @@ namespace base
                         {
                             TRACE_ERROR("TcpMessageServer: Fatal error on message reassembly from '{}'", info->m_address);
                             info->m_fatalError = true;
+                            needsMore = false;
                             break;
                         }
                     }
@@ -15,12 +15,16 @@
 #include "base/system/include/mutex.h"
 #include "base/system/include/atomic.h"
 #include "base/containers/include/hashMap.h"
-#include "base/system/include/simpleStructurePool.h"
+#include "base/containers/include/inplaceArray.h"
 
 namespace base
 {
 
     /// Global list of all objects that derive from IObject
+    /// The registry is split into shards (by object ID) that are locked separately so objects can be created on many threads without contending on a single lock
+    /// Within a shard the objects are kept in per-class lists so visiting objects of a class does not have to look at all of the objects
+    /// NOTE: class of the object is not yet known when it's registered (we are in the IObject constructor) so objects are moved to their class lists lazily, when they are visited by iterateObjectsOfClass
+    /// the class is only read from objects we hold a strong reference to, never under the shard lock
     class BASE_OBJECT_API ObjectGlobalRegistry : public ISingleton
     {
         DECLARE_SINGLETON(ObjectGlobalRegistry);
@@ -35,16 +39,21 @@ namespace base
 
         ///---
 
+        /// find a live object by its ID, returns null if there's no such object (or it's being destroyed)
+        ObjectPtr findObject(ObjectID id);
+
+        ///---
+
         /// visit all objects with a function on EACH OBJECT, do I have to say it will be slow ? :) 
-        /// NOTE: registry is locked during this update 
+        /// NOTE: objects are collected first, the function is called outside the registry lock
         bool iterateAllObjects(const std::function<bool(IObject*)>& enumFunc);
 
-        /// visit all objects of specific class with a function, still slow
-        /// NOTE: registry is locked during this update 
+        /// visit all objects of specific class with a function, only objects from the lists of the matching classes are visited
+        /// NOTE: objects are collected first, the function is called outside the registry lock
         bool iterateObjectsOfClass(ClassType objectClass, const std::function<bool(IObject*)>& enumFunc);
 
-        /// visit all objects of specific class with a function, still slow
-        /// NOTE: registry is locked during this update 
+        /// visit all objects of specific class with a function, only objects from the lists of the matching classes are visited
+        /// NOTE: objects are collected first, the function is called outside the registry lock
         template< typename T >
         INLINE bool iterateObjectsOfClass(const std::function<bool(T*)>& enumFunc)
         {
@@ -55,33 +64,81 @@ namespace base
 
     protected:
         // register object in the registry
-        void registerObject(uint32_t id, IObject* object);
+        void registerObject(ObjectID id, IObject* object);
 
         // unregister object from the registry
-        void unregisterObject(uint32_t id, IObject* object);
+        void unregisterObject(ObjectID id, IObject* object);
 
         //--
 
-        static const uint32_t MAX_BUCKETS = 16 * 1024;
+        static const uint32_t NUM_SHARDS = 64;
+        static const uint32_t MIN_BUCKETS_PER_SHARD = 256;
+        static const uint32_t ENTRIES_PER_PAGE = 1024;
+
+        struct ObjectEntry;
+
+        struct EntryList
+        {
+            ClassType objectClass; // empty for the list of objects that were not yet assigned to a class
+            ObjectEntry* head = nullptr;
+            uint32_t count = 0;
+        };
 
         struct ObjectEntry
         {
-            uint32_t id = 0;
+            ObjectID id = 0;
             ObjectWeakPtr ptr;
-            ObjectEntry* nextBucket = nullptr;
-            ObjectEntry* nextAll = nullptr;
-            ObjectEntry* prevAll = nullptr;
+            EntryList* list = nullptr;
+            ObjectEntry* nextBucket = nullptr; // also used to link free entries
+            ObjectEntry* nextInList = nullptr;
+            ObjectEntry* prevInList = nullptr;
         };
 
-        SpinLock m_objectsLock;
-        ObjectEntry* m_objectListHead = nullptr;
-        ObjectEntry* m_objectListTail = nullptr;
+        struct Shard
+        {
+            SpinLock lock;
+            Array<ObjectEntry*> buckets; // grows with the number of objects so the chains stay short
+            uint32_t numEntries = 0;
+            ObjectEntry* freeEntries = nullptr;
+            EntryList unclassifiedEntries;
+            Array<EntryList*> classLists;
+            HashMap<ClassType, EntryList*> classListMap;
+            Array<ObjectEntry*> pages;
+        };
 
-        SimpleStructurePool<ObjectEntry> m_objectEntryPool;
-        ObjectEntry* m_objectHashBuckets[MAX_BUCKETS];
+        Shard m_shards[NUM_SHARDS];
 
         std::atomic<uint32_t> m_objectCount = 0;
 
+        //--
+
+        struct PendingObject
+        {
+            ObjectID id = 0;
+            IObject* object = nullptr;
+        };
+
+        struct ClassifiedObject
+        {
+            ObjectID id = 0;
+            ObjectWeakPtr ptr;
+            ClassType objectClass; // class of the list the object was found on (empty for new objects) or the actual class of the object
+
+            INLINE ClassifiedObject() {}
+            INLINE ClassifiedObject(ObjectID id_, const ObjectWeakPtr& ptr_, ClassType objectClass_) : id(id_), ptr(ptr_), objectClass(objectClass_) {}
+        };
+
+        void registerObjects(const PendingObject* objects, uint32_t count);
+
+        static void LinkEntry(EntryList* list, ObjectEntry* entry);
+        static void UnlinkEntry(ObjectEntry* entry);
+
+        ObjectEntry* allocEntry(Shard& shard);
+        void insertEntry(Shard& shard, ObjectID id, IObject* object);
+        ObjectEntry** findEntry(Shard& shard, ObjectID id) const;
+        void growBuckets(Shard& shard);
+        EntryList* classList(Shard& shard, ClassType objectClass);
+        void classifyEntries(Array<ClassifiedObject>& objects);
 
         //--
 
@@ -90,7 +147,33 @@ namespace base
         //-
 
         friend class IObject;
+        friend class ObjectRegistrationBatch;
     };
 
-} // base
+    //--
+
+    /// groups the registration of objects created on the current thread, the objects are added to the registry in one go when the scope ends (or the batch gets big)
+    /// used when a lot of objects are created at once (ie. when loading) so the shard locks are taken once per batch and not once per object
+    /// NOTE: objects from the batch are not visible in the registry until it's flushed so the scope must be short and must NOT span any fiber yields
+    class BASE_OBJECT_API ObjectRegistrationBatch : public NoCopy
+    {
+    public:
+        ObjectRegistrationBatch();
+        ~ObjectRegistrationBatch();
+
+        // add all pending objects to the registry
+        void flush();
+
+    private:
+        static const uint32_t MAX_PENDING_OBJECTS = 1024;
+
+        ObjectRegistrationBatch* m_outerBatch = nullptr;
+        InplaceArray<ObjectGlobalRegistry::PendingObject, 64> m_pendingObjects;
 
+        void add(ObjectID id, IObject* object);
+        bool remove(ObjectID id);
+
+        friend class ObjectGlobalRegistry;
+    };
+
+} // base
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "base/containers/include/array.h"
+#include "base/io/include/absolutePath.h"
 
 namespace base
 {
@@ -58,7 +59,9 @@ namespace base
             // Context name for reporting any loading errors, usually a full absolute path of the file being loaded 
             StringBuf m_contextName;
 
-            // TODO: buffer restoration context
+            // Absolute path of the loaded file, when set the buffers stored uncompressed in a binary file are memory mapped from it instead of being read into memory
+            // NOTE: the buffers must be at the same offsets in the file as in the stream we are loading from
+            io::AbsolutePath m_mappedBuffersFilePath;
 
             LoadingContext();
         };
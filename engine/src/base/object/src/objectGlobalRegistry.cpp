@@ -18,10 +18,15 @@ namespace base
 {
     ///--
 
+    // batch collecting the objects registered on current thread, see ObjectRegistrationBatch
+    static TYPE_TLS ObjectRegistrationBatch* GCurrentRegistrationBatch = nullptr;
+
+    ///--
+
     ObjectGlobalRegistry::ObjectGlobalRegistry()
-        : m_objectEntryPool(65536 / sizeof(ObjectEntry))
     {
-        memset(m_objectHashBuckets, 0, sizeof(m_objectHashBuckets));
+        for (auto& shard : m_shards)
+            shard.buckets.resizeWith(MIN_BUCKETS_PER_SHARD, nullptr);
     }
 
     void ObjectGlobalRegistry::deinit()
@@ -29,21 +34,201 @@ namespace base
         
     }
 
+    //--
+
+    void ObjectGlobalRegistry::LinkEntry(EntryList* list, ObjectEntry* entry)
+    {
+        entry->list = list;
+        entry->prevInList = nullptr;
+        entry->nextInList = list->head;
+
+        if (list->head)
+            list->head->prevInList = entry;
+
+        list->head = entry;
+        list->count += 1;
+    }
+
+    void ObjectGlobalRegistry::UnlinkEntry(ObjectEntry* entry)
+    {
+        auto* list = entry->list;
+        DEBUG_CHECK(list != nullptr);
+
+        if (entry->nextInList)
+            entry->nextInList->prevInList = entry->prevInList;
+
+        if (entry->prevInList)
+        {
+            entry->prevInList->nextInList = entry->nextInList;
+        }
+        else
+        {
+            DEBUG_CHECK(list->head == entry);
+            list->head = entry->nextInList;
+        }
+
+        list->count -= 1;
+        entry->list = nullptr;
+        entry->nextInList = nullptr;
+        entry->prevInList = nullptr;
+    }
+
+    ObjectGlobalRegistry::ObjectEntry* ObjectGlobalRegistry::allocEntry(Shard& shard)
+    {
+        // entries are never returned to the system, the pages are reused as objects come and go
+        if (!shard.freeEntries)
+        {
+            auto* page = new ObjectEntry[ENTRIES_PER_PAGE];
+            shard.pages.pushBack(page);
+
+            for (uint32_t i = 0; i < ENTRIES_PER_PAGE; ++i)
+            {
+                page[i].nextBucket = shard.freeEntries;
+                shard.freeEntries = &page[i];
+            }
+        }
+
+        auto* entry = shard.freeEntries;
+        shard.freeEntries = entry->nextBucket;
+        entry->nextBucket = nullptr;
+        return entry;
+    }
+
+    ObjectGlobalRegistry::ObjectEntry** ObjectGlobalRegistry::findEntry(Shard& shard, ObjectID id) const
+    {
+        // IDs are sequential and the low bits select the shard so the rest is well distributed
+        const auto bucketIndex = (id / NUM_SHARDS) & (shard.buckets.size() - 1);
+
+        auto* prevLink = &shard.buckets[bucketIndex];
+        while (*prevLink)
+        {
+            if ((*prevLink)->id == id)
+                return prevLink;
+            prevLink = &(*prevLink)->nextBucket;
+        }
+
+        return nullptr;
+    }
+
+    void ObjectGlobalRegistry::growBuckets(Shard& shard)
+    {
+        Array<ObjectEntry*> newBuckets;
+        newBuckets.resizeWith(shard.buckets.size() * 2, nullptr);
+
+        const auto mask = newBuckets.size() - 1;
+        for (auto* entry : shard.buckets)
+        {
+            while (entry)
+            {
+                auto* next = entry->nextBucket;
+                auto& bucket = newBuckets[(entry->id / NUM_SHARDS) & mask];
+                entry->nextBucket = bucket;
+                bucket = entry;
+                entry = next;
+            }
+        }
+
+        shard.buckets = std::move(newBuckets);
+    }
+
+    void ObjectGlobalRegistry::insertEntry(Shard& shard, ObjectID id, IObject* object)
+    {
+        // keep the chains short
+        if (shard.numEntries >= shard.buckets.size() * 2)
+            growBuckets(shard);
+
+        auto* entry = allocEntry(shard);
+        entry->id = id;
+        entry->ptr = object;
+
+        // we are still in the IObject constructor so we don't know the class of the object yet
+        LinkEntry(&shard.unclassifiedEntries, entry);
+
+        auto& bucket = shard.buckets[(id / NUM_SHARDS) & (shard.buckets.size() - 1)];
+        entry->nextBucket = bucket;
+        bucket = entry;
+
+        shard.numEntries += 1;
+        m_objectCount += 1;
+    }
+
+    ObjectGlobalRegistry::EntryList* ObjectGlobalRegistry::classList(Shard& shard, ClassType objectClass)
+    {
+        EntryList* list = nullptr;
+        if (!shard.classListMap.find(objectClass, list))
+        {
+            list = MemNew(EntryList);
+            list->objectClass = objectClass;
+            shard.classLists.pushBack(list);
+            shard.classListMap[objectClass] = list;
+        }
+
+        return list;
+    }
+
+    void ObjectGlobalRegistry::classifyEntries(Array<ClassifiedObject>& objects)
+    {
+        // lock each shard only once
+        std::sort(objects.begin(), objects.end(), [](const ClassifiedObject& a, const ClassifiedObject& b) { return (a.id % NUM_SHARDS) < (b.id % NUM_SHARDS); });
+
+        uint32_t index = 0;
+        while (index < objects.size())
+        {
+            auto& shard = m_shards[objects[index].id % NUM_SHARDS];
+            auto lock = CreateLock(shard.lock);
+
+            for (; index < objects.size() && &m_shards[objects[index].id % NUM_SHARDS] == &shard; ++index)
+            {
+                const auto& object = objects[index];
+
+                // object may have been destroyed (and unregistered) since we saw it
+                auto** entryLink = findEntry(shard, object.id);
+                if (!entryLink || (*entryLink)->ptr != object.ptr)
+                    continue;
+
+                auto* entry = *entryLink;
+                if (entry->list->objectClass != object.objectClass)
+                {
+                    UnlinkEntry(entry);
+                    LinkEntry(classList(shard, object.objectClass), entry);
+                }
+            }
+        }
+    }
+
+    //--
+
+    ObjectPtr ObjectGlobalRegistry::findObject(ObjectID id)
+    {
+        ObjectWeakPtr ptr;
+
+        {
+            auto& shard = m_shards[id % NUM_SHARDS];
+            auto lock = CreateLock(shard.lock);
+
+            if (auto** entry = findEntry(shard, id))
+                ptr = (*entry)->ptr;
+        }
+
+        return ptr.lock();
+    }
+
     bool ObjectGlobalRegistry::iterateAllObjects(const std::function<bool(IObject*)>& enumFunc)
     {
         base::Array<ObjectWeakPtr> allObjects;
+        allObjects.reserve(m_objectCount);
 
         // extract objects
+        for (auto& shard : m_shards)
         {
-            auto lock = CreateLock(m_objectsLock);
-            allObjects.reserve(m_objectCount);
+            auto lock = CreateLock(shard.lock);
 
-            auto cur = m_objectListTail;
-            while (cur)
-            {
-                allObjects.pushBack(cur->ptr);
-                cur = cur->prevAll;
-            }
+            for (auto* entry = shard.unclassifiedEntries.head; entry; entry = entry->nextInList)
+                allObjects.pushBack(entry->ptr);
+
+            for (auto* list : shard.classLists)
+                for (auto* entry = list->head; entry; entry = entry->nextInList)
+                    allObjects.pushBack(entry->ptr);
         }
 
         // run enumerator
@@ -57,112 +242,195 @@ namespace base
 
     bool ObjectGlobalRegistry::iterateObjectsOfClass(ClassType objectClass, const std::function<bool(IObject*)>& enumFunc)
     {
-        auto lock = CreateLock(m_objectsLock);
+        base::Array<ClassifiedObject> classObjects;
 
-        auto cur = m_objectListTail;
-        while (cur)
+        // extract objects from the lists of the matching classes
+        // new objects and objects that were assigned to a base class of the one we are looking for are extracted as well, they may turn out to be of our class
+        // NOTE: the class can't be read here, the objects may be in the middle of construction or destruction, it's read once we hold a strong reference
+        for (auto& shard : m_shards)
         {
-            if (auto obj = cur->ptr.lock())
+            auto lock = CreateLock(shard.lock);
+
+            for (auto* entry = shard.unclassifiedEntries.head; entry; entry = entry->nextInList)
+                classObjects.emplaceBack(entry->id, entry->ptr, nullptr);
+
+            for (auto* list : shard.classLists)
+                if (list->objectClass->is(objectClass) || objectClass->is(list->objectClass))
+                    for (auto* entry = list->head; entry; entry = entry->nextInList)
+                        classObjects.emplaceBack(entry->id, entry->ptr, list->objectClass);
+        }
+
+        // run enumerator, remember objects that are on a wrong list
+        base::Array<ClassifiedObject> reclassifiedObjects;
+        bool found = false;
+        for (auto& classObject : classObjects)
+        {
+            if (auto obj = classObject.ptr.lock())
+            {
+                const auto actualClass = obj->cls();
+                if (actualClass != classObject.objectClass)
+                    reclassifiedObjects.emplaceBack(classObject.id, classObject.ptr, actualClass);
+
                 if (obj->is(objectClass))
+                {
                     if (enumFunc(obj))
-                        return true;
-
-            cur = cur->prevAll;
+                    {
+                        found = true;
+                        break;
+                    }
+                }
+            }
         }
 
-        return false;
+        // move the objects to the lists of their classes so they are not checked again
+        // NOTE: an object caught during construction may be assigned to a base class, it will be rechecked when the list of that base class is visited
+        classifyEntries(reclassifiedObjects);
+        return found;
     }
 
-    void ObjectGlobalRegistry::registerObject(uint32_t id, IObject* object)
-    {
-        auto lock = CreateLock(m_objectsLock);
-
-        // allocate entry
-        m_objectCount += 1;
-        auto* entry = m_objectEntryPool.alloc();
-        memset(entry, 0, sizeof(ObjectEntry));
-        entry->id = id;
-        entry->ptr = object;
-        entry->nextAll = nullptr;
-        entry->prevAll= nullptr;
-        entry->nextBucket  = nullptr;
+    //--
 
-        // link in the global list
-        if (m_objectListHead != nullptr)
+    void ObjectGlobalRegistry::registerObject(ObjectID id, IObject* object)
+    {
+        // object will be registered together with the rest of the batch
+        if (auto* batch = GCurrentRegistrationBatch)
         {
-            m_objectListHead->prevAll = entry;
-            entry->nextAll = m_objectListHead;
+            batch->add(id, object);
+            return;
         }
-        else
+
+        auto& shard = m_shards[id % NUM_SHARDS];
+        auto lock = CreateLock(shard.lock);
+        insertEntry(shard, id, object);
+    }
+
+    void ObjectGlobalRegistry::registerObjects(const PendingObject* objects, uint32_t count)
+    {
+        // order the objects by shard so each shard is locked only once
+        uint32_t shardOffsets[NUM_SHARDS + 1];
+        memset(shardOffsets, 0, sizeof(shardOffsets));
+        for (uint32_t i = 0; i < count; ++i)
+            shardOffsets[(objects[i].id % NUM_SHARDS) + 1] += 1;
+        for (uint32_t i = 1; i <= NUM_SHARDS; ++i)
+            shardOffsets[i] += shardOffsets[i - 1];
+
+        InplaceArray<PendingObject, 256> sortedObjects;
+        sortedObjects.resize(count);
         {
-            m_objectListTail = entry;
+            uint32_t writeOffsets[NUM_SHARDS];
+            memcpy(writeOffsets, shardOffsets, sizeof(writeOffsets));
+            for (uint32_t i = 0; i < count; ++i)
+                sortedObjects[writeOffsets[objects[i].id % NUM_SHARDS]++] = objects[i];
         }
 
-        m_objectListHead = entry;
+        for (uint32_t shardIndex = 0; shardIndex < NUM_SHARDS; ++shardIndex)
+        {
+            const auto first = shardOffsets[shardIndex];
+            const auto last = shardOffsets[shardIndex + 1];
+            if (first == last)
+                continue;
 
-        // add entry to the hash buckets
-        const auto bucketIndex = id % MAX_BUCKETS;
-        entry->nextBucket = m_objectHashBuckets[bucketIndex];
-        m_objectHashBuckets[bucketIndex] = entry;
+            auto& shard = m_shards[shardIndex];
+            auto lock = CreateLock(shard.lock);
+            for (uint32_t i = first; i < last; ++i)
+                insertEntry(shard, sortedObjects[i].id, sortedObjects[i].object);
+        }
     }
 
-    void ObjectGlobalRegistry::unregisterObject(uint32_t id, IObject* object)
+    void ObjectGlobalRegistry::unregisterObject(ObjectID id, IObject* object)
     {
-        auto lock = CreateLock(m_objectsLock);
+        // object was created and destroyed before the batch was flushed
+        if (auto* batch = GCurrentRegistrationBatch)
+            if (batch->remove(id))
+                return;
+
+        auto& shard = m_shards[id % NUM_SHARDS];
+        auto lock = CreateLock(shard.lock);
 
         // locate the entry
-        const auto bucketIndex = id % MAX_BUCKETS;
-        auto* prevLink = &m_objectHashBuckets[bucketIndex];
-        auto* curEntry = m_objectHashBuckets[bucketIndex];
-        while (curEntry)
-        {
-            if (curEntry->id == id)
-                break;
-            prevLink = &curEntry->nextBucket;
-            curEntry = curEntry->nextBucket;
-        }
+        auto** entryLink = findEntry(shard, id);
 
         // object was not registered
-        DEBUG_CHECK_EX(curEntry != nullptr, TempString("Object ID {} not found in global registry", id));
-        if (curEntry == nullptr)
+        DEBUG_CHECK_EX(entryLink != nullptr, TempString("Object ID {} not found in global registry", id));
+        if (entryLink == nullptr)
             return;
 
+        auto* curEntry = *entryLink;
+
         // verify the object
         DEBUG_CHECK_EX(curEntry->ptr.expired() || curEntry->ptr == object, TempString("Object ID {} is different that previoulsy registered", id));
 
-        // remove from hash bucket
-        *prevLink = curEntry->nextBucket;
+        // remove from hash bucket and the object list
+        *entryLink = curEntry->nextBucket;
+        UnlinkEntry(curEntry);
+
+        // release entry for reuse
+        curEntry->ptr.reset();
+        curEntry->id = 0;
+        curEntry->nextBucket = shard.freeEntries;
+        shard.freeEntries = curEntry;
+
+        shard.numEntries -= 1;
+        m_objectCount -= 1;
+    }
 
-        // remove from object list
-        if (curEntry->nextAll)
+    //--
+
+    ObjectRegistrationBatch::ObjectRegistrationBatch()
+    {
+        // nested batches just add to the outer one
+        m_outerBatch = GCurrentRegistrationBatch;
+        if (!m_outerBatch)
+            GCurrentRegistrationBatch = this;
+    }
+
+    ObjectRegistrationBatch::~ObjectRegistrationBatch()
+    {
+        if (!m_outerBatch)
         {
-            DEBUG_CHECK(curEntry != m_objectListTail);
-            curEntry->nextAll->prevAll = curEntry->prevAll;
+            flush();
+            GCurrentRegistrationBatch = nullptr;
         }
-        else
+    }
+
+    void ObjectRegistrationBatch::flush()
+    {
+        if (m_outerBatch)
         {
-            DEBUG_CHECK(curEntry == m_objectListTail);
-            m_objectListTail = curEntry->prevAll;
+            m_outerBatch->flush();
         }
-
-        if (curEntry->prevAll)
+        else if (!m_pendingObjects.empty())
         {
-            DEBUG_CHECK(curEntry != m_objectListHead);
-            curEntry->prevAll->nextAll = curEntry->nextAll;
+            ObjectGlobalRegistry::GetInstance().registerObjects(m_pendingObjects.typedData(), m_pendingObjects.size());
+            m_pendingObjects.clear();
         }
-        else
+    }
+
+    void ObjectRegistrationBatch::add(ObjectID id, IObject* object)
+    {
+        auto& entry = m_pendingObjects.emplaceBack();
+        entry.id = id;
+        entry.object = object;
+
+        if (m_pendingObjects.size() >= MAX_PENDING_OBJECTS)
+            flush();
+    }
+
+    bool ObjectRegistrationBatch::remove(ObjectID id)
+    {
+        // recently created objects are more likely to be destroyed
+        for (int i = (int)m_pendingObjects.size() - 1; i >= 0; --i)
         {
-            DEBUG_CHECK(curEntry == m_objectListHead);
-            m_objectListHead = curEntry->nextAll;
+            if (m_pendingObjects[i].id == id)
+            {
+                m_pendingObjects.eraseUnordered(i);
+                return true;
+            }
         }
 
-        // release entry to memory pool
-        curEntry->ptr.reset();
-        m_objectEntryPool.release(curEntry);
-        m_objectCount -= 1;
+        return false;
     }
 
     //--
 
 } // base
-
@@ -0,0 +1,206 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "object.h"
+#include "objectGlobalRegistry.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/system/include/thread.h"
+#include "base/system/include/timedScope.h"
+
+DECLARE_TEST_FILE(ObjectGlobalRegistry);
+
+using namespace base;
+
+namespace tests
+{
+    class RegistryTestObject : public IObject
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(RegistryTestObject, IObject);
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(RegistryTestObject);
+    RTTI_END_TYPE();
+
+    class RegistryTestDerivedObject : public RegistryTestObject
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(RegistryTestDerivedObject, RegistryTestObject);
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(RegistryTestDerivedObject);
+    RTTI_END_TYPE();
+
+    class RegistryTestOtherObject : public IObject
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(RegistryTestOtherObject, IObject);
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(RegistryTestOtherObject);
+    RTTI_END_TYPE();
+
+    static uint32_t CountObjectsOfClass(ClassType objectClass)
+    {
+        uint32_t count = 0;
+        ObjectGlobalRegistry::GetInstance().iterateObjectsOfClass(objectClass, [&count](IObject*) { count += 1; return false; });
+        return count;
+    }
+
+} // tests
+
+TEST(ObjectGlobalRegistry, FindObjectByID)
+{
+    auto obj = CreateSharedPtr<tests::RegistryTestObject>();
+    const auto id = obj->id();
+
+    EXPECT_EQ(obj.get(), ObjectGlobalRegistry::GetInstance().findObject(id).get());
+
+    obj.reset();
+    EXPECT_FALSE(ObjectGlobalRegistry::GetInstance().findObject(id));
+}
+
+TEST(ObjectGlobalRegistry, IterateObjectsOfClass)
+{
+    Array<ObjectPtr> objects;
+    for (uint32_t i = 0; i < 10; ++i)
+        objects.pushBack(CreateSharedPtr<tests::RegistryTestObject>());
+    for (uint32_t i = 0; i < 5; ++i)
+        objects.pushBack(CreateSharedPtr<tests::RegistryTestDerivedObject>());
+    for (uint32_t i = 0; i < 3; ++i)
+        objects.pushBack(CreateSharedPtr<tests::RegistryTestOtherObject>());
+
+    EXPECT_EQ(15, tests::CountObjectsOfClass(tests::RegistryTestObject::GetStaticClass()));
+    EXPECT_EQ(5, tests::CountObjectsOfClass(tests::RegistryTestDerivedObject::GetStaticClass()));
+    EXPECT_EQ(3, tests::CountObjectsOfClass(tests::RegistryTestOtherObject::GetStaticClass()));
+
+    // visiting again must give the same result after the objects were assigned to their classes
+    EXPECT_EQ(15, tests::CountObjectsOfClass(tests::RegistryTestObject::GetStaticClass()));
+
+    objects.reset();
+    EXPECT_EQ(0, tests::CountObjectsOfClass(tests::RegistryTestObject::GetStaticClass()));
+    EXPECT_EQ(0, tests::CountObjectsOfClass(tests::RegistryTestOtherObject::GetStaticClass()));
+}
+
+TEST(ObjectGlobalRegistry, IterateWhileObjectsAreCreatedAndDestroyed)
+{
+    static const uint32_t NUM_KEPT_OBJECTS = 100;
+    static const uint32_t NUM_THREADS = 4;
+    static const uint32_t NUM_ITERATIONS = 200;
+
+    Array<ObjectPtr> keptObjects;
+    for (uint32_t i = 0; i < NUM_KEPT_OBJECTS; ++i)
+        keptObjects.pushBack(CreateSharedPtr<tests::RegistryTestObject>());
+
+    // objects are constantly created and destroyed on other threads while we visit them
+    std::atomic<uint32_t> requestExit = 0;
+    Array<Thread> threads;
+    threads.resize(NUM_THREADS);
+    for (auto& thread : threads)
+    {
+        ThreadSetup setup;
+        setup.m_name = "RegistryChurnThread";
+        setup.m_function = [&requestExit]()
+        {
+            while (!requestExit)
+            {
+                auto derived = CreateSharedPtr<tests::RegistryTestDerivedObject>();
+                auto other = CreateSharedPtr<tests::RegistryTestOtherObject>();
+            }
+        };
+
+        thread.init(setup);
+    }
+
+    uint32_t numInvalidObjects = 0;
+    uint32_t numMissingObjects = 0;
+    for (uint32_t i = 0; i < NUM_ITERATIONS; ++i)
+    {
+        uint32_t numKeptObjects = 0;
+        ObjectGlobalRegistry::GetInstance().iterateObjectsOfClass(tests::RegistryTestObject::GetStaticClass(), [&](IObject* obj)
+            {
+                if (!obj->is<tests::RegistryTestObject>())
+                    numInvalidObjects += 1;
+                else if (obj->cls() == tests::RegistryTestObject::GetStaticClass())
+                    numKeptObjects += 1;
+                return false;
+            });
+
+        if (numKeptObjects != NUM_KEPT_OBJECTS)
+            numMissingObjects += 1;
+    }
+
+    requestExit = 1;
+    for (auto& thread : threads)
+        thread.close();
+
+    EXPECT_EQ(0, numInvalidObjects);
+    EXPECT_EQ(0, numMissingObjects);
+    EXPECT_EQ(NUM_KEPT_OBJECTS, tests::CountObjectsOfClass(tests::RegistryTestObject::GetStaticClass()));
+}
+
+TEST(ObjectGlobalRegistry, RegistrationBatch)
+{
+    const auto initialCount = ObjectGlobalRegistry::GetInstance().totalObjectCount();
+
+    Array<ObjectPtr> objects;
+    {
+        ObjectRegistrationBatch batch;
+
+        for (uint32_t i = 0; i < 3000; ++i)
+            objects.pushBack(CreateSharedPtr<tests::RegistryTestObject>());
+
+        // objects destroyed before the batch is flushed never reach the registry
+        CreateSharedPtr<tests::RegistryTestOtherObject>().reset();
+    }
+
+    EXPECT_EQ(initialCount + 3000, ObjectGlobalRegistry::GetInstance().totalObjectCount());
+    EXPECT_EQ(3000, tests::CountObjectsOfClass(tests::RegistryTestObject::GetStaticClass()));
+    EXPECT_EQ(0, tests::CountObjectsOfClass(tests::RegistryTestOtherObject::GetStaticClass()));
+
+    for (const auto& obj : objects)
+        EXPECT_EQ(obj.get(), ObjectGlobalRegistry::GetInstance().findObject(obj->id()).get());
+
+    objects.reset();
+    EXPECT_EQ(initialCount, ObjectGlobalRegistry::GetInstance().totalObjectCount());
+}
+
+TEST(ObjectGlobalRegistry, DISABLED_CreateDestroyBenchmark)
+{
+    static const uint32_t NUM_OBJECTS = 10000000;
+    static const uint32_t NUM_OBJECTS_ALIVE = 1000;
+
+    const auto numThreads = std::max<uint32_t>(1, GetNumberOfCores());
+    const auto objectsPerThread = NUM_OBJECTS / numThreads;
+
+    ScopeTimer timer;
+    {
+        Array<Thread> threads;
+        threads.resize(numThreads);
+
+        for (auto& thread : threads)
+        {
+            ThreadSetup setup;
+            setup.m_name = "RegistryBenchmarkThread";
+            setup.m_function = [objectsPerThread]()
+            {
+                // keep some objects alive so the registry is not empty all the time
+                ObjectPtr aliveObjects[NUM_OBJECTS_ALIVE];
+                for (uint32_t i = 0; i < objectsPerThread; ++i)
+                    aliveObjects[i % NUM_OBJECTS_ALIVE] = CreateSharedPtr<tests::RegistryTestObject>();
+            };
+
+            thread.init(setup);
+        }
+
+        for (auto& thread : threads)
+            thread.close();
+    }
+
+    TRACE_INFO("Created and destroyed {} objects on {} threads in {}", objectsPerThread * numThreads, numThreads, TimeInterval(timer.timeElapsed()));
+    EXPECT_EQ(0, tests::CountObjectsOfClass(tests::RegistryTestObject::GetStaticClass()));
+}
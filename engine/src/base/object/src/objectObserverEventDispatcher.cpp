@@ -18,78 +18,133 @@ namespace base
 {
     ///--
 
+    mem::PoolID POOL_OBJECT_EVENTS("Engine.ObjectEvents");
+
+    ///--
+
+    ObjectObserverEventDispatcher::FrameEvents::FrameEvents()
+        : pathStorage(POOL_OBJECT_EVENTS)
+    {
+        objects.reserve(256);
+        events.reserve(1024);
+    }
+
+    void ObjectObserverEventDispatcher::FrameEvents::reset()
+    {
+        // NOTE: this releases the references to objects
+        objects.reset();
+        events.reset();
+        objectMap.reset();
+        eventMap.reset();
+
+        // NOTE: pages go back to the page allocator so it's cheap, still, don't do it when nothing was stored
+        if (numStoredPaths)
+        {
+            pathStorage.clear();
+            numStoredPaths = 0;
+        }
+    }
+
+    StringView<char> ObjectObserverEventDispatcher::FrameEvents::storePath(StringView<char> path)
+    {
+        if (path.empty())
+            return StringView<char>();
+
+        numStoredPaths += 1;
+
+        const auto* text = pathStorage.strcpy(path.data(), path.length());
+        return StringView<char>(text, text + path.length());
+    }
+
+    ///--
+
     ObjectObserverEventDispatcher::ObjectObserverEventDispatcher()
     {
-        m_objects.reserve(16*1024);
-        m_pendingEventsSwap.reserve(1024);
-        m_pendingEvents.reserve(1024);
+        m_postFrame = &m_frames[0];
+        m_dispatchFrame = &m_frames[1];
+
+        for (auto& shard : m_listenerShards)
+            shard.objects.reserve(1024);
     }
 
     void ObjectObserverEventDispatcher::deinit()
     {
+        for (auto& shard : m_listenerShards)
         {
-            ScopeLock<Mutex> lock(m_objectsLock);
-            m_objects.clearPtr();
+            ScopeLock<SpinLock> lock(shard.lock);
+            shard.objects.clearPtr();
         }
 
         {
             ScopeLock<SpinLock> lock(m_pendingEventsLock);
-            m_pendingEvents.clear();
-            m_pendingEventsSwap.clear();
+            m_frames[0].reset();
+            m_frames[1].reset();
         }
     }
 
     void ObjectObserverEventDispatcher::discardPendingEvents()
     {
         ScopeLock<SpinLock> lock(m_pendingEventsLock);
-        m_pendingEvents.clear();
+        m_postFrame->reset();
     }
 
     void ObjectObserverEventDispatcher::processPendingEvents()
     {
-        // get the events to send
+        PC_SCOPE_LVL1(DispatchObjectEvents);
+
+        ScopeLock<Mutex> dispatchLock(m_dispatchLock);
+
+        // events posted from within the callbacks are dispatched in the next frame
+        if (m_dispatching)
+            return;
+
+        // get the events to send, new events will be posted to the other frame
         m_pendingEventsLock.acquire();
-        std::swap(m_pendingEventsSwap, m_pendingEvents); // the "Swap" will now contain the events
+        std::swap(m_postFrame, m_dispatchFrame);
         m_pendingEventsLock.release();
 
-        ScopeLock<Mutex> lock(m_objectsLock);
+        m_dispatching = true;
 
-        // send events
-        for (auto& event : m_pendingEventsSwap)
+        // send events, all events of given object are delivered to one listener before moving to the next one
+        const auto& frame = *m_dispatchFrame;
+        for (const auto& object : frame.objects)
         {
-            // find the target
-            ObjectInfo* info = nullptr;
-            if (m_objects.find(event.objectId, info))
+            // snapshot the listeners, the shard is locked only for the copy so listeners can (un)register from the callbacks
             {
-                // call the event
-                bool hasEmptyListeners = false;
-                auto numListeners = info->listeners.size();
-                for (uint32_t i=0; i<numListeners; ++i)
-                {
-                    auto listener  = info->listeners[i];
-                    if (listener)
-                    {
-                        listener->onObjectChangedEvent(event.eventID, event.object.get(), event.path.view(), event.data);
-                    }
-                    else
-                    {
-                        hasEmptyListeners = true;
-                    }
-                }
+                auto& shard = listenerShard(object.objectId);
+                ScopeLock<SpinLock> lock(shard.lock);
 
-                // some listeners were removed, compact the list
-                // NOTE: the list may be purged which will mean that the nobody is listening for the events on this object any more
-                if (hasEmptyListeners)
-                    info->listeners.remove(nullptr);
+                ObjectInfo* info = nullptr;
+                if (!shard.objects.find(object.objectId, info))
+                    continue;
 
-                // no listeners for this object, remove it from the list
-                if (info->listeners.empty())
-                    m_objects.remove(event.objectId);
+                m_dispatchListeners.reset();
+                m_dispatchListeners.pushBack(info->listeners.typedData(), info->listeners.size());
+            }
+
+            m_dispatchObjectId = object.objectId;
+
+            for (uint32_t i = 0; i < m_dispatchListeners.size(); ++i)
+            {
+                for (auto eventIndex = object.firstEvent; eventIndex != INDEX_MAX; eventIndex = frame.events[eventIndex].nextEvent)
+                {
+                    // listener may get unregistered by any of the calls
+                    auto* listener = m_dispatchListeners[i];
+                    if (!listener)
+                        break;
+
+                    const auto& event = frame.events[eventIndex];
+                    listener->onObjectChangedEvent(event.eventID, object.object.get(), event.path, event.data);
+                }
             }
         }
 
+        m_dispatchListeners.reset();
+        m_dispatchObjectId = 0;
+        m_dispatching = false;
+
         // reset the event list without freeing the memory
-        m_pendingEventsSwap.reset();
+        m_dispatchFrame->reset();
     }
 
     uint32_t ObjectObserverEventDispatcher::registerListener(const IObject* ptr, IObjectObserver* listener)
@@ -97,17 +152,17 @@ namespace base
          // only non-empty objects are tracked
         if (ptr)
         {
-            ScopeLock<Mutex> lock(m_objectsLock);
+            auto& shard = listenerShard(ptr->id());
+            ScopeLock<SpinLock> lock(shard.lock);
 
             // get container for given object
             ObjectInfo* info = nullptr;
-            if (!m_objects.find(ptr->id(), info))
+            if (!shard.objects.find(ptr->id(), info))
             {
                 // create container
                 info = MemNew(ObjectInfo);
                 info->listeners.reserve(2);
-                info->ptr = ptr;
-                m_objects.set(ptr->id(), info);
+                shard.objects.set(ptr->id(), info);
             }
 
             // register listener
@@ -126,23 +181,37 @@ namespace base
     {
         if (0 != objectId)
         {
-            ScopeLock<Mutex> lock(m_objectsLock);
+            // wait for the dispatch running on other thread to finish, listener may be deleted right after we return
+            ScopeLock<Mutex> dispatchLock(m_dispatchLock);
 
-            // get container for given object
-            // NOTE: if container does not exist the listener was not registered :)
-            ObjectInfo* info = nullptr;
-            if (m_objects.find(objectId, info))
             {
-                // null the entry
-                for (auto & entry : info->listeners)
+                auto& shard = listenerShard(objectId);
+                ScopeLock<SpinLock> lock(shard.lock);
+
+                // get container for given object
+                // NOTE: if container does not exist the listener was not registered :)
+                ObjectInfo* info = nullptr;
+                if (shard.objects.find(objectId, info))
                 {
-                    if (entry == listener)
-                    {
+                    if (info->listeners.remove(listener))
                         listener->removeTrackingReference();
-                        entry = nullptr;
+
+                    // no listeners for this object, remove it from the list
+                    if (info->listeners.empty())
+                    {
+                        shard.objects.remove(objectId);
+                        MemDelete(info);
                     }
                 }
             }
+
+            // unregistered from within the callback, make sure the listener is not called any more
+            if (m_dispatching && m_dispatchObjectId == objectId)
+            {
+                for (auto& entry : m_dispatchListeners)
+                    if (entry == listener)
+                        entry = nullptr;
+            }
         }
     }
 
@@ -151,16 +220,56 @@ namespace base
         // only valid sources are tracked
         if (0 != objectId && obj)
         {
+            const auto eventKey = path.calcCRC64(((uint64_t)objectId << 32) | eventID.index());
+
             ScopeLock<SpinLock> lock(m_pendingEventsLock);
+            auto& frame = *m_postFrame;
+
+            // same event was already posted for this object and path in this frame, just update the data
+            uint32_t eventIndex = INDEX_MAX;
+            const auto eventKeyMapped = frame.eventMap.find(eventKey, eventIndex);
+            if (eventKeyMapped)
+            {
+                auto& existingEvent = frame.events[eventIndex];
+                if (existingEvent.objectId == objectId && existingEvent.eventID == eventID && existingEvent.path == path)
+                {
+                    existingEvent.data = std::move(eventData);
+                    return;
+                }
+            }
+
+            // get the entry for the object, it's kept alive until the events are delivered
+            uint32_t objectIndex = INDEX_MAX;
+            if (!frame.objectMap.find(objectId, objectIndex))
+            {
+                objectIndex = frame.objects.size();
+                frame.objectMap[objectId] = objectIndex;
+
+                auto& objectInfo = frame.objects.emplaceBack();
+                objectInfo.objectId = objectId;
+                objectInfo.object = AddRef(obj);
+            }
 
             // post event to the table
-            auto &eventInfo = m_pendingEvents.emplaceBack();
+            eventIndex = frame.events.size();
+            auto& eventInfo = frame.events.emplaceBack();
             eventInfo.eventID = eventID;
             eventInfo.objectId = objectId;
-            eventInfo.object = AddRef(obj);
-            eventInfo.path = StringBuf(path);
+            eventInfo.path = frame.storePath(path);
             eventInfo.data = std::move(eventData);
 
+            // link it with the other events of the object
+            auto& objectInfo = frame.objects[objectIndex];
+            if (objectInfo.lastEvent != INDEX_MAX)
+                frame.events[objectInfo.lastEvent].nextEvent = eventIndex;
+            else
+                objectInfo.firstEvent = eventIndex;
+            objectInfo.lastEvent = eventIndex;
+
+            // NOTE: on the (unlikely) hash collision we keep the first event mapped, the other one is just not coalesced
+            if (!eventKeyMapped)
+                frame.eventMap[eventKey] = eventIndex;
+
             //TRACE_INFO("Posted '{}' with path '{}' on object '{}'", eventID, eventPath, objectID);
         }
     }
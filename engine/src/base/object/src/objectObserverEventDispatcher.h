@@ -16,11 +16,14 @@
 #include "base/system/include/mutex.h"
 #include "base/system/include/atomic.h"
 #include "base/containers/include/hashMap.h"
+#include "base/containers/include/inplaceArray.h"
+#include "base/memory/include/linearAllocator.h"
 
 namespace base
 {
 
     /// Global event tracker for object events
+    /// NOTE: events posted during the frame are coalesced per (object, event, path), listeners only get the latest data
     class ObjectObserverEventDispatcher : public ISingleton
     {
         DECLARE_SINGLETON(ObjectObserverEventDispatcher);
@@ -56,27 +59,66 @@ namespace base
         void postEvent(StringID eventID, uint32_t objectId, IObject* obj, StringView<char> path, rtti::DataHolder eventData);
 
     protected:
+        static const uint32_t NUM_LISTENER_SHARDS = 32;
+
         struct PendingEvent
         {
             StringID eventID;
-            uint32_t objectId;
-            ObjectPtr object; // once we agree to call the event we will keep object alive until it executed
-            StringBuf path;
+            uint32_t objectId = 0;
+            uint32_t nextEvent = INDEX_MAX; // next event posted on the same object
+            StringView<char> path; // stored in the frame's path storage
             rtti::DataHolder data;
         };
 
+        struct PendingObject
+        {
+            uint32_t objectId = 0;
+            ObjectPtr object; // once we agree to call the event we will keep object alive until it executed
+            uint32_t firstEvent = INDEX_MAX;
+            uint32_t lastEvent = INDEX_MAX;
+        };
+
+        // all events posted during single frame, memory is kept between the frames
+        struct FrameEvents : public NoCopy
+        {
+            Array<PendingObject> objects; // in order of the first posted event
+            Array<PendingEvent> events;
+            HashMap<uint32_t, uint32_t> objectMap; // object ID -> index in objects
+            HashMap<uint64_t, uint32_t> eventMap; // hash of (object, event, path) -> index in events
+            mem::LinearAllocator pathStorage;
+            uint32_t numStoredPaths = 0;
+
+            FrameEvents();
+
+            void reset();
+            StringView<char> storePath(StringView<char> path);
+        };
+
+        FrameEvents m_frames[2];
+        FrameEvents* m_postFrame = nullptr; // new events are added here
+        FrameEvents* m_dispatchFrame = nullptr; // events that are being dispatched
+        SpinLock m_pendingEventsLock;
+
         struct ObjectInfo
         {
             Array<IObjectObserver*> listeners;
-            ObjectWeakPtr ptr;
         };
 
-        HashMap<uint32_t, ObjectInfo*> m_objects;
-        Mutex m_objectsLock;
+        struct ListenerShard
+        {
+            SpinLock lock;
+            HashMap<uint32_t, ObjectInfo*> objects;
+        };
 
-        Array<PendingEvent> m_pendingEvents;
-        Array<PendingEvent> m_pendingEventsSwap;
-        SpinLock m_pendingEventsLock;
+        ListenerShard m_listenerShards[NUM_LISTENER_SHARDS];
+
+        // held for the whole dispatch, unregistering waits on it so the listener is never deleted while being called
+        Mutex m_dispatchLock;
+        bool m_dispatching = false;
+        uint32_t m_dispatchObjectId = 0;
+        InplaceArray<IObjectObserver*, 16> m_dispatchListeners; // snapshot of the listeners of the object being dispatched
+
+        INLINE ListenerShard& listenerShard(uint32_t objectId) { return m_listenerShards[objectId % NUM_LISTENER_SHARDS]; }
 
         virtual void deinit() override;
     };
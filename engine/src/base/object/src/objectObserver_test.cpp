@@ -0,0 +1,196 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "object.h"
+#include "objectObserver.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/system/include/timedScope.h"
+
+DECLARE_TEST_FILE(ObjectObserver);
+
+using namespace base;
+
+namespace tests
+{
+    class ObserverTestObject : public IObject
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(ObserverTestObject, IObject);
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(ObserverTestObject);
+    RTTI_END_TYPE();
+
+    struct ReceivedEvent
+    {
+        StringID eventID;
+        StringBuf path;
+    };
+
+} // tests
+
+TEST(ObjectObserver, EventsAreCoalescedPerPath)
+{
+    auto obj = CreateSharedPtr<tests::ObserverTestObject>();
+
+    Array<tests::ReceivedEvent> received;
+
+    ObjectObserver observer;
+    observer.bindObject(obj.get());
+    observer.bindCallback([&received](OBJECT_EVENT_FUNC) { received.pushBack({ eventID, StringBuf(eventPath) }); });
+
+    obj->postEvent("OnPropertyChanged"_id, "a");
+    obj->postEvent("OnPropertyChanged"_id, "b");
+    obj->postEvent("OnPropertyChanged"_id, "a");
+    obj->postEvent("OnFullStructureChange"_id);
+    obj->postEvent("OnPropertyChanged"_id, "b");
+    obj->postEvent("OnFullStructureChange"_id);
+
+    IObjectObserver::DispatchPendingEvents();
+
+    // events are delivered once, in order they were first posted
+    ASSERT_EQ(3, received.size());
+    EXPECT_EQ("OnPropertyChanged"_id, received[0].eventID);
+    EXPECT_STREQ("a", received[0].path.c_str());
+    EXPECT_EQ("OnPropertyChanged"_id, received[1].eventID);
+    EXPECT_STREQ("b", received[1].path.c_str());
+    EXPECT_EQ("OnFullStructureChange"_id, received[2].eventID);
+    EXPECT_TRUE(received[2].path.empty());
+
+    // nothing pending any more
+    received.reset();
+    IObjectObserver::DispatchPendingEvents();
+    EXPECT_EQ(0, received.size());
+
+    // new frame, new events
+    obj->postEvent("OnPropertyChanged"_id, "a");
+    IObjectObserver::DispatchPendingEvents();
+    EXPECT_EQ(1, received.size());
+}
+
+TEST(ObjectObserver, EventsAreNotMixedBetweenObjects)
+{
+    auto objA = CreateSharedPtr<tests::ObserverTestObject>();
+    auto objB = CreateSharedPtr<tests::ObserverTestObject>();
+
+    uint32_t numEventsA = 0;
+    uint32_t numEventsB = 0;
+
+    ObjectObserver observerA;
+    observerA.bindObject(objA.get());
+    observerA.bindCallback([&numEventsA](OBJECT_EVENT_FUNC) { numEventsA += 1; });
+
+    ObjectObserver observerB;
+    observerB.bindObject(objB.get());
+    observerB.bindCallback([&numEventsB](OBJECT_EVENT_FUNC) { numEventsB += 1; });
+
+    objA->postEvent("OnPropertyChanged"_id, "value");
+    objB->postEvent("OnPropertyChanged"_id, "value");
+    objB->postEvent("OnPropertyChanged"_id, "other");
+
+    IObjectObserver::DispatchPendingEvents();
+
+    EXPECT_EQ(1, numEventsA);
+    EXPECT_EQ(2, numEventsB);
+}
+
+TEST(ObjectObserver, UnregisterFromCallback)
+{
+    auto obj = CreateSharedPtr<tests::ObserverTestObject>();
+
+    uint32_t numEventsA = 0;
+    uint32_t numEventsB = 0;
+
+    ObjectObserver observerB;
+    observerB.bindObject(obj.get());
+    observerB.bindCallback([&numEventsB](OBJECT_EVENT_FUNC) { numEventsB += 1; });
+
+    // A unbinds both itself and B from within the callback
+    ObjectObserver observerA;
+    observerA.bindObject(obj.get());
+    observerA.bindCallback([&](OBJECT_EVENT_FUNC) { numEventsA += 1; observerA.unbind(); observerB.unbind(); });
+
+    obj->postEvent("OnPropertyChanged"_id, "a");
+    obj->postEvent("OnPropertyChanged"_id, "b");
+
+    IObjectObserver::DispatchPendingEvents();
+
+    // listeners are called in order of registration so B got the first event before A was called
+    EXPECT_EQ(1, numEventsA);
+    EXPECT_EQ(2, numEventsB);
+
+    obj->postEvent("OnPropertyChanged"_id, "a");
+    IObjectObserver::DispatchPendingEvents();
+
+    EXPECT_EQ(1, numEventsA);
+    EXPECT_EQ(2, numEventsB);
+}
+
+TEST(ObjectObserver, DISABLED_BulkEditBenchmark)
+{
+    static const uint32_t NUM_OBJECTS = 10000;
+    static const uint32_t NUM_PROPERTIES = 20;
+    static const uint32_t NUM_EDITS = 10;
+    static const uint32_t NUM_FRAMES = 10;
+
+    // selection of objects with a property panel observing each of them
+    Array<ObjectPtr> objects;
+    Array<ObjectObserver*> observers;
+    objects.reserve(NUM_OBJECTS);
+    observers.reserve(NUM_OBJECTS);
+
+    uint64_t numReceivedEvents = 0;
+    for (uint32_t i = 0; i < NUM_OBJECTS; ++i)
+    {
+        auto obj = CreateSharedPtr<tests::ObserverTestObject>();
+        objects.pushBack(obj);
+
+        auto* observer = MemNew(ObjectObserver);
+        observer->bindObject(obj.get());
+        observer->bindCallback([&numReceivedEvents](OBJECT_EVENT_FUNC) { numReceivedEvents += 1; });
+        observers.pushBack(observer);
+    }
+
+    // property names are built once, the posting is what we measure
+    Array<StringBuf> propertyNames;
+    for (uint32_t i = 0; i < NUM_PROPERTIES; ++i)
+        propertyNames.pushBack(StringBuf(TempString("property{}", i)));
+
+    double postTime = 0.0;
+    double dispatchTime = 0.0;
+    uint64_t numPostedEvents = 0;
+
+    for (uint32_t frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        // multi-selection edit, every property is changed few times (ie. dragging a value)
+        {
+            ScopeTimer timer;
+            for (uint32_t edit = 0; edit < NUM_EDITS; ++edit)
+                for (const auto& obj : objects)
+                    for (const auto& name : propertyNames)
+                        obj->postEvent("OnPropertyChanged"_id, name);
+
+            postTime += timer.timeElapsed();
+            numPostedEvents += NUM_EDITS * NUM_OBJECTS * NUM_PROPERTIES;
+        }
+
+        {
+            ScopeTimer timer;
+            IObjectObserver::DispatchPendingEvents();
+            dispatchTime += timer.timeElapsed();
+        }
+    }
+
+    TRACE_INFO("Posted {} events in {} ({} events/s)", numPostedEvents, TimeInterval(postTime), (uint64_t)(numPostedEvents / std::max(postTime, 0.000001)));
+    TRACE_INFO("Dispatched {} events in {}, {} per frame", numReceivedEvents, TimeInterval(dispatchTime), TimeInterval(dispatchTime / NUM_FRAMES));
+
+    EXPECT_EQ(NUM_FRAMES * NUM_OBJECTS * NUM_PROPERTIES, numReceivedEvents);
+
+    observers.clearPtr();
+}
@@ -14,6 +14,8 @@
 #include <sys/stat.h>
 #include <uuid/uuid.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
 
 namespace base
 {
@@ -148,7 +150,13 @@ namespace base
                 auto ret = ::write(m_handle, data, size);
                 if (ret == -1)
                 {
+                    // pipe is full, try again later
+                    if (errno == EAGAIN)
+                        return 0;
+
                     TRACE_ERROR("Writing end of pipe '{}' lost", name());
+                    ::close(m_handle);
+                    m_handle = -1;
                     return 0;
                 }
 
@@ -313,11 +321,19 @@ namespace base
 
                 while (!pipe->m_requestExit)
                 {
-                    // wait for data
+                    // wait for data, the timeout is there only so we can notice the exit request
+                    pollfd pfd;
+                    pfd.fd = pipe->m_handle;
+                    pfd.events = POLLIN;
+                    pfd.revents = 0;
+                    if (::poll(&pfd, 1, 100) <= 0)
+                        continue;
+
+                    // read what we got
                     auto ret = ::read(pipe->m_handle, asyncBuffer.data(), asyncBuffer.size());
                     if (ret == -1)
                     {
-                        if (errno == EAGAIN)
+                        if (errno == EAGAIN || errno == EINTR)
                             continue;
 
                         TRACE_WARNING("Pipe '{}' abruptly closed: {}", pipe->name(), errno);
@@ -326,7 +342,14 @@ namespace base
 
                     // send to callback
                     if (ret > 0)
+                    {
                         pipe->m_callback->processData(asyncBuffer.data(), ret);
+                    }
+                    else
+                    {
+                        // there's no writer (yet or any more), the poll would return immediately so don't burn the CPU
+                        usleep(10000);
+                    }
                 }
 
                 return nullptr;
@@ -10,11 +10,14 @@
 #include "build.h"
 #include "pipe.h"
 #include "processPOSIX.h"
+#include "base/system/include/thread.h"
+#include "base/system/include/timing.h"
 
 #include <pthread.h>
 #include <spawn.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <signal.h>
 #include <string>
 #include <locale>
 #include <codecvt>
@@ -33,23 +36,65 @@ namespace base
 
             POSIXProcess::POSIXProcess()
                 : m_pid(0)
+                , m_exited(false)
+                , m_exitStatus(0)
             {}
 
             POSIXProcess::~POSIXProcess()
             {
-                terminate();
+                if (!wait(500))
+                    terminate();
 
-                ASSERT_EX(m_pid == 0, "Process not closed correctly");
+                m_pid = 0;
+            }
+
+            void POSIXProcess::updateStatus(bool block) const
+            {
+                if (m_pid == 0 || m_exited)
+                    return;
+
+                // NOTE: without WUNTRACED the state changes only when the process is gone (exited or killed by a signal)
+                int status = 0;
+                auto ret = waitpid(m_pid, &status, block ? 0 : WNOHANG);
+                if (ret == m_pid)
+                {
+                    m_exited = true;
+                    m_exitStatus = status;
+                }
+                else if (ret == -1)
+                {
+                    // not our child any more, nothing more we can learn about it
+                    m_exited = true;
+                    m_exitStatus = -1;
+                }
             }
 
             bool POSIXProcess::wait(uint32_t timeoutMS)
             {
-                return false;
+                NativeTimePoint timeout = NativeTimePoint::Now() + (timeoutMS / 1000.0);
+                for (;;)
+                {
+                    updateStatus(false);
+                    if (m_exited)
+                        return true;
+
+                    if (timeout.reached())
+                        return false;
+
+                    Sleep(1);
+                }
             }
 
             void POSIXProcess::terminate()
             {
-                m_pid = 0;
+                updateStatus(false);
+
+                if (m_pid != 0 && !m_exited)
+                {
+                    TRACE_INFO("Terminating process {}", m_pid);
+                    kill(m_pid, SIGKILL);
+                    updateStatus(true);
+                }
             }
 
             ProcessID POSIXProcess::id() const
@@ -62,11 +107,8 @@ namespace base
                 if (m_pid == 0)
                     return false;
 
-                int status = 0;
-                if (0 == waitpid(m_pid, &status, WNOHANG))
-                    return true;
-
-                return !WIFEXITED(status);
+                updateStatus(false);
+                return !m_exited;
             }
 
             bool POSIXProcess::exitCode(int& outExitCode) const
@@ -74,13 +116,11 @@ namespace base
                 if (m_pid == 0)
                     return false;
 
-                int status = 0;
-                if (0 == waitpid(m_pid, &status, WNOHANG))
-                    return false;
-
-                if (!WIFEXITED(status))
+                updateStatus(false);
+                if (!m_exited || m_exitStatus == -1)
                     return false;
 
+                const auto status = m_exitStatus;
                 if (WIFSIGNALED(status))
                 {
                     outExitCode = -200;
@@ -38,6 +38,12 @@ namespace base
 
             private:
                 pid_t m_pid;
+
+                // the process can be reaped only once, we remember how it ended
+                mutable bool m_exited;
+                mutable int m_exitStatus;
+
+                void updateStatus(bool block) const;
             };
 
         } // prv
@@ -25,8 +25,13 @@ namespace base
         class IDataModelMapper;
         class IDataModelResolver;
 
+        class EncodedObjectState;
+        class StateSnapshotWriter;
+        class StateSnapshotReader;
+
         typedef uint16_t DataMappedID;
         typedef uint32_t QuantizedValue;
+        typedef uint32_t ReplicatedObjectID;
 
     } // replication
 } // base
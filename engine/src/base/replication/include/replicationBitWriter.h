@@ -36,7 +36,7 @@ namespace base
 
             //--
 
-            /// clear data, does not release the memory
+            /// clear data, does not release the memory (but the written part is zeroed so it can be written again)
             void clear();
 
             /// reserve space for at least N bits
@@ -59,6 +59,11 @@ namespace base
             /// write adaptive number, usually an array count/object ID
             void writeAdaptiveNumber(WORD count);
 
+            //--
+
+            /// compute number of bits writeAdaptiveNumber() will use for given value
+            static uint32_t CalcAdaptiveNumberBitCount(WORD value);
+
         private:
             static const uint32_t MAX_INTERNAL_WORDS = 32;
             static const uint32_t WORD_SIZE = sizeof(WORD) * 8;
@@ -150,6 +150,9 @@ namespace base
             // encode from a function call
             void encodeFromFunctionCall(const rtti::FunctionCallingParams& params, IDataModelMapper& mapper, BitWriter& w) const;
 
+            // encode single field of the native data, used to encode object state field by field
+            void encodeField(uint32_t fieldIndex, const void* data, IDataModelMapper& mapper, BitWriter& w) const;
+
             //--
 
             /// decode data with this model using native data layout
@@ -162,6 +165,9 @@ namespace base
             /// NOTE: this function may return false if there are errors in the bit stream, the goal is TO NEVER CRASH
             bool decodeToFunctionCall(rtti::FunctionCallingParams& params, IDataModelResolver& resolve, BitReader& r) const;
 
+            /// decode single field into the native data
+            bool decodeField(uint32_t fieldIndex, void* data, IDataModelResolver& resolve, BitReader& r) const;
+
             //--
 
             // debug dump
@@ -0,0 +1,78 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "replicationBitWriter.h"
+
+namespace base
+{
+    namespace replication
+    {
+
+        //--
+
+        /// state of an object encoded with the data model, each field is encoded separately so states can be compared and delta compressed field by field
+        /// NOTE: fields are encoded with the same packing (quantization) as the messages so the comparison is done on the quantized values - changes below the precision are not sent
+        class BASE_REPLICATION_API EncodedObjectState
+        {
+        public:
+            typedef BitWriter::WORD WORD;
+
+            /// do we have any data ?
+            INLINE bool empty() const { return m_fields.empty(); }
+
+            /// number of encoded fields
+            INLINE uint32_t numFields() const { return m_fields.size(); }
+
+            /// number of bits the field was encoded with
+            INLINE uint32_t fieldBitCount(uint32_t index) const { return m_fields[index].bitCount; }
+
+            //--
+
+            /// clear state, does not release memory
+            void clear();
+
+            /// encode all fields of the native data
+            void encode(const DataModel& model, const void* data, IDataModelMapper& mapper);
+
+            /// decode fields into the native data, if the previously decoded state is provided only the fields that are different are decoded
+            /// NOTE: this function may return false if the data is corrupted
+            bool decode(const DataModel& model, void* data, IDataModelResolver& resolver, const EncodedObjectState* previous = nullptr) const;
+
+            //--
+
+            /// check if given field has the same value in both states
+            bool fieldEquals(uint32_t index, const EncodedObjectState& other) const;
+
+            /// compute number of bits writeDelta() would write for given baseline, returns 0 if nothing changed
+            uint32_t calcDeltaBitCount(const EncodedObjectState* baseline) const;
+
+            /// write the mask of changed fields followed by the fields that are different than in the baseline (all fields if there's no baseline)
+            /// returns number of written fields
+            uint32_t writeDelta(const EncodedObjectState* baseline, BitWriter& w) const;
+
+            /// read changes written with writeDelta() and apply them over the baseline
+            /// NOTE: this function may return false if the data is corrupted or does not match the baseline
+            bool readDelta(const EncodedObjectState* baseline, uint32_t numFields, BitReader& r);
+
+        private:
+            struct FieldInfo
+            {
+                uint32_t firstWord = 0;
+                uint32_t bitCount = 0;
+            };
+
+            Array<FieldInfo> m_fields;
+            Array<WORD> m_words;
+
+            bool isFieldChanged(uint32_t index, const EncodedObjectState* baseline) const;
+        };
+
+        //--
+
+    } // replication
+} // base
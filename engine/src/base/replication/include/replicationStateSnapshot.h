@@ -0,0 +1,207 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "replicationObjectState.h"
+#include "base/containers/include/hashMap.h"
+
+namespace base
+{
+    namespace replication
+    {
+
+        //--
+
+        /// max number of states of a single object the receiving side remembers, the sender never uses a baseline that could be already forgotten
+        static const uint32_t STATE_SNAPSHOT_OBJECT_HISTORY = 16;
+
+        /// max number of snapshots that can wait for the acknowledgment, older snapshots are assumed lost
+        static const uint32_t STATE_SNAPSHOT_MAX_PENDING = 64;
+
+        //--
+
+        /// object to consider for the snapshot
+        struct StateSnapshotObject
+        {
+            ReplicatedObjectID id = 0; // game assigned ID of the object, must be unique
+            const DataModel* model = nullptr; // data model the state was encoded with
+            const EncodedObjectState* state = nullptr; // current state, it's best to encode it once per frame and share it between all connections
+            float priority = 1.0f; // relevancy of the object for the connection, when the bandwidth is limited objects with higher priority are sent more often, 0 - object is not relevant (will be removed on the other side)
+        };
+
+        /// stats for the snapshot writer
+        struct BASE_REPLICATION_API StateSnapshotWriterStats
+        {
+            uint32_t numSnapshots = 0;
+            uint64_t totalBits = 0; // total size of all written snapshots
+
+            uint32_t numObjectsSent = 0; // total number of object updates sent
+            uint32_t numObjectsSentFull = 0; // object updates that were sent without a baseline
+            uint32_t numObjectsUnchanged = 0; // object updates skipped because nothing changed since the acknowledged baseline
+            uint32_t numObjectsDeferred = 0; // object updates that did not fit in the bandwidth budget and were left for later snapshots
+            uint32_t numObjectsRemoved = 0; // object removals sent
+            uint32_t numFieldsSent = 0; // total number of fields sent
+
+            uint32_t numAcknowledged = 0; // snapshots acknowledged by the other side
+            uint32_t numLost = 0; // snapshots that were never acknowledged
+
+            void print(IFormatStream& f) const;
+        };
+
+        /// writer of object state snapshots for a single connection, sends only the fields that changed since the state the other side acknowledged
+        /// NOTE: the acknowledged states of objects are used as the baselines, until a snapshot is acknowledged the changes are sent in every snapshot
+        class BASE_REPLICATION_API StateSnapshotWriter : public NoCopy
+        {
+        public:
+            StateSnapshotWriter();
+            ~StateSnapshotWriter();
+
+            /// get stats
+            INLINE const StateSnapshotWriterStats& stats() const { return m_stats; }
+
+            /// get the sequence number of the last acknowledged snapshot
+            INLINE uint32_t lastAcknowledgedSequence() const { return m_lastAcknowledgedSequence; }
+
+            //--
+
+            /// write snapshot of given objects, objects known to the other side that are not on the list anymore are removed
+            /// objects are written in the order of their accumulated priority until the budget (in bits) is used, rest of the objects waits for the next snapshot with increased priority
+            /// NOTE: budget of 0 means no limit
+            /// returns the sequence number of the written snapshot
+            uint32_t writeSnapshot(const StateSnapshotObject* objects, uint32_t numObjects, uint32_t bitBudget, IDataModelMapper& mapper, BitWriter& w);
+
+            /// other side confirmed receiving given snapshot, object states from it will be used as baselines
+            void acknowledge(uint32_t sequence);
+
+        private:
+            struct ObjectEntry
+            {
+                ReplicatedObjectID id = 0;
+                const DataModel* model = nullptr;
+                uint32_t firstSequence = 0; // snapshot the entry was created for, older snapshots refer to a previous incarnation of the object
+
+                EncodedObjectState baseline; // acknowledged state
+                uint32_t baselineSequence = 0; // 0 if there's no acknowledged state yet
+
+                float accumulatedPriority = 0.0f;
+                uint32_t lastListedSequence = 0; // last snapshot the object was listed for
+                uint32_t removedSequence = 0; // snapshot in which the object was removed
+                uint32_t lastSentSequence = 0; // last snapshot the object's state was sent in
+                uint32_t numStatesInFlight = 0; // sent states that were not yet acknowledged or assumed lost
+                uint32_t numStatesSinceBaseline = 0; // states sent after the baseline, the other side may have any of them in its history
+            };
+
+            struct SentObjectState
+            {
+                ReplicatedObjectID id = 0;
+                EncodedObjectState state;
+                bool removed = false;
+            };
+
+            struct SentSnapshot
+            {
+                uint32_t sequence = 0;
+                Array<SentObjectState> objects;
+            };
+
+            HashMap<ReplicatedObjectID, ObjectEntry*> m_objects;
+            Array<SentSnapshot*> m_pendingSnapshots; // sent but not yet acknowledged, oldest first
+            Array<SentSnapshot*> m_freeSnapshots; // reused to avoid allocating memory for each snapshot
+
+            uint32_t m_nextSequence = 1;
+            uint32_t m_lastAcknowledgedSequence = 0;
+
+            StateSnapshotWriterStats m_stats;
+
+            ObjectEntry* findEntry(ReplicatedObjectID id, uint32_t sequence) const;
+            void retireSnapshot(SentSnapshot* snapshot, bool acknowledged);
+            void removeEntry(ObjectEntry* entry);
+        };
+
+        //--
+
+        /// receiver of the object states
+        class BASE_REPLICATION_API IStateSnapshotTarget : public NoCopy
+        {
+        public:
+            virtual ~IStateSnapshotTarget();
+
+            /// get the native memory of the object the state should be decoded into, object should be created if it does not exist yet
+            /// NOTE: can return null to ignore the object
+            virtual void* objectStateData(ReplicatedObjectID id, const DataModel* model) = 0;
+
+            /// object was removed (or is no longer relevant) on the other side
+            virtual void objectStateRemoved(ReplicatedObjectID id) = 0;
+        };
+
+        /// stats for the snapshot reader
+        struct BASE_REPLICATION_API StateSnapshotReaderStats
+        {
+            uint32_t numSnapshots = 0;
+            uint64_t totalBits = 0;
+
+            uint32_t numObjectsUpdated = 0;
+            uint32_t numObjectsRemoved = 0;
+
+            void print(IFormatStream& f) const;
+        };
+
+        /// reader of object state snapshots for a single connection, keeps the recently received states of objects to be used as baselines
+        class BASE_REPLICATION_API StateSnapshotReader : public NoCopy
+        {
+        public:
+            StateSnapshotReader(const DataModelRepositoryPtr& models);
+            ~StateSnapshotReader();
+
+            /// get stats
+            INLINE const StateSnapshotReaderStats& stats() const { return m_stats; }
+
+            /// get sequence number of last received snapshot
+            INLINE uint32_t lastSequence() const { return m_lastSequence; }
+
+            //--
+
+            /// read snapshot and decode the changed fields into the target objects
+            /// on success the returned sequence number should be acknowledged to the sender
+            /// NOTE: this function may return false if the data is corrupted, the connection should be reset in such case
+            bool readSnapshot(BitReader& r, IDataModelResolver& resolver, IStateSnapshotTarget& target, uint32_t& outSequence);
+
+        private:
+            struct ReceivedState
+            {
+                uint32_t sequence = 0;
+                EncodedObjectState state;
+            };
+
+            struct ObjectEntry
+            {
+                const DataModel* model = nullptr;
+                ReceivedState history[STATE_SNAPSHOT_OBJECT_HISTORY];
+                uint32_t lastIndex = 0; // index of most recent state in the history
+                bool hasHistory = false;
+                bool decoded = false; // target accepted the state at least once, we can decode only the changed fields
+
+                const ReceivedState* findState(uint32_t sequence) const;
+            };
+
+            DataModelRepositoryPtr m_models;
+
+            HashMap<ReplicatedObjectID, ObjectEntry*> m_objects;
+            uint32_t m_lastSequence = 0;
+
+            EncodedObjectState m_tempState; // swapped with the history so we reuse the memory
+
+            StateSnapshotReaderStats m_stats;
+
+            bool readObject(uint32_t sequence, BitReader& r, IDataModelResolver& resolver, IStateSnapshotTarget& target);
+            bool readingError(StringView<char> message) const;
+        };
+
+        //--
+
+    } // replication
+} // base
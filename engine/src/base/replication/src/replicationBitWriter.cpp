@@ -46,6 +46,10 @@ namespace base
 
         void BitWriter::clear()
         {
+            // writing assumes zeros in the buffer
+            if (m_bitPos > 0)
+                memzero(m_blockStart, ((m_bitPos + WORD_SIZE - 1) / WORD_SIZE) * sizeof(WORD));
+
             m_bitIndex = 0;
             m_bitPos = 0;
             m_blockPos = m_blockStart;
@@ -195,6 +199,22 @@ namespace base
             writeBits(value, numBits);
         }
 
+        uint32_t BitWriter::CalcAdaptiveNumberBitCount(WORD value)
+        {
+            uint32_t numBits = 4;
+            uint32_t numPrefixBits = 0;
+            while (numBits < WORD_SIZE)
+            {
+                numPrefixBits += 1;
+                if (value < (((WORD)1) << numBits))
+                    break;
+
+                numBits += numBits < 16 ? 4 : 8;
+            }
+
+            return numPrefixBits + numBits;
+        }
+
         void BitWriter::grow(uint32_t requiredWords)
         {
             if (m_blockPos + requiredWords > m_blockEnd)
@@ -612,6 +612,16 @@ namespace base
             }
         }
 
+        void DataModel::encodeField(uint32_t fieldIndex, const void* data, IDataModelMapper& mapper, BitWriter& w) const
+        {
+            const auto& field = m_fields[fieldIndex];
+            auto fieldData = OffsetPtr(data, field.m_nativeOffset);
+            if (field.m_isArray)
+                encodeArrayFieldData(field, fieldData, mapper, w);
+            else
+                encodeFieldData(field, fieldData, mapper, w);
+        }
+
         bool DataModel::decodeToNativeData(void* data, IDataModelResolver& resolve, BitReader& r) const
         {
             for (auto& field : m_fields)
@@ -663,6 +673,16 @@ namespace base
             return true;
         }
 
+        bool DataModel::decodeField(uint32_t fieldIndex, void* data, IDataModelResolver& resolve, BitReader& r) const
+        {
+            const auto& field = m_fields[fieldIndex];
+            auto fieldData = OffsetPtr(data, field.m_nativeOffset);
+            if (field.m_isArray)
+                return decodeArrayFieldData(field, fieldData, resolve, r);
+            else
+                return decodeFieldData(field, fieldData, resolve, r);
+        }
+
         //--
 
         void DataModelField::print(IFormatStream& f) const
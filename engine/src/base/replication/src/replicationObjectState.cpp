@@ -0,0 +1,227 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "replicationObjectState.h"
+#include "replicationDataModel.h"
+#include "replicationBitWriter.h"
+#include "replicationBitReader.h"
+
+#include "base/containers/include/inplaceArray.h"
+
+namespace base
+{
+    namespace replication
+    {
+
+        //--
+
+        static const uint32_t WORD_BITS = sizeof(EncodedObjectState::WORD) * 8;
+
+        // max size of a single field we accept when reading the delta, protects from allocating crazy amounts of memory on corrupted data
+        static const uint32_t MAX_FIELD_BITS = 1U << 20;
+
+        INLINE static uint32_t CalcWordCount(uint32_t bitCount)
+        {
+            return (bitCount + WORD_BITS - 1) / WORD_BITS;
+        }
+
+        //--
+
+        void EncodedObjectState::clear()
+        {
+            m_fields.reset();
+            m_words.reset();
+        }
+
+        void EncodedObjectState::encode(const DataModel& model, const void* data, IDataModelMapper& mapper)
+        {
+            const auto numFields = model.fields().size();
+            m_fields.reset();
+            m_fields.reserve(numFields);
+
+            BitWriter w;
+            for (uint32_t i = 0; i < numFields; ++i)
+            {
+                auto& info = m_fields.emplaceBack();
+                info.firstWord = w.bitSize() / WORD_BITS;
+
+                model.encodeField(i, data, mapper, w);
+                info.bitCount = w.bitSize() - (info.firstWord * WORD_BITS);
+
+                // each field starts at a word boundary so the fields can be compared and decoded separately
+                if (auto padding = (WORD_BITS - (w.bitSize() % WORD_BITS)) % WORD_BITS)
+                {
+                    w.reserve(padding);
+                    w.writeBits(0, padding);
+                }
+            }
+
+            m_words.reset();
+            m_words.pushBack(w.data(), CalcWordCount(w.bitSize()));
+        }
+
+        bool EncodedObjectState::decode(const DataModel& model, void* data, IDataModelResolver& resolver, const EncodedObjectState* previous) const
+        {
+            if (model.fields().size() != m_fields.size())
+                return false;
+
+            if (previous && previous->numFields() != numFields())
+                previous = nullptr;
+
+            for (uint32_t i = 0; i < m_fields.size(); ++i)
+            {
+                if (previous && fieldEquals(i, *previous))
+                    continue;
+
+                const auto& info = m_fields[i];
+                BitReader r(info.bitCount ? m_words.typedData() + info.firstWord : nullptr, info.bitCount);
+                if (!model.decodeField(i, data, resolver, r))
+                    return false;
+
+                // field must be fully consumed, otherwise the data does not match the model
+                if (r.bitPos() != info.bitCount)
+                    return false;
+            }
+
+            return true;
+        }
+
+        //--
+
+        bool EncodedObjectState::fieldEquals(uint32_t index, const EncodedObjectState& other) const
+        {
+            const auto& a = m_fields[index];
+            const auto& b = other.m_fields[index];
+            if (a.bitCount != b.bitCount)
+                return false;
+
+            // padding bits are always zero so we can compare whole words
+            const auto numWords = CalcWordCount(a.bitCount);
+            return !numWords || 0 == memcmp(m_words.typedData() + a.firstWord, other.m_words.typedData() + b.firstWord, numWords * sizeof(WORD));
+        }
+
+        bool EncodedObjectState::isFieldChanged(uint32_t index, const EncodedObjectState* baseline) const
+        {
+            return !baseline || baseline->numFields() != numFields() || !fieldEquals(index, *baseline);
+        }
+
+        uint32_t EncodedObjectState::calcDeltaBitCount(const EncodedObjectState* baseline) const
+        {
+            bool hasChanges = false;
+            uint32_t bitCount = m_fields.size(); // mask
+
+            for (uint32_t i = 0; i < m_fields.size(); ++i)
+            {
+                if (isFieldChanged(i, baseline))
+                {
+                    const auto fieldBits = m_fields[i].bitCount;
+                    bitCount += BitWriter::CalcAdaptiveNumberBitCount(fieldBits) + fieldBits;
+                    hasChanges = true;
+                }
+            }
+
+            return hasChanges ? bitCount : 0;
+        }
+
+        uint32_t EncodedObjectState::writeDelta(const EncodedObjectState* baseline, BitWriter& w) const
+        {
+            // mask of changed fields
+            w.reserve(m_fields.size());
+            for (uint32_t i = 0; i < m_fields.size(); ++i)
+                w.writeBit(isFieldChanged(i, baseline));
+
+            // changed fields, prefixed with the size so they can be read without the model
+            uint32_t numWrittenFields = 0;
+            for (uint32_t i = 0; i < m_fields.size(); ++i)
+            {
+                if (isFieldChanged(i, baseline))
+                {
+                    const auto& info = m_fields[i];
+                    w.reserve(info.bitCount + 64);
+                    w.writeAdaptiveNumber(info.bitCount);
+
+                    auto bitsLeft = info.bitCount;
+                    auto readPtr = m_words.typedData() + info.firstWord;
+                    while (bitsLeft > 0)
+                    {
+                        const auto numBits = std::min<uint32_t>(bitsLeft, WORD_BITS);
+                        w.writeBits(*readPtr++, numBits);
+                        bitsLeft -= numBits;
+                    }
+
+                    numWrittenFields += 1;
+                }
+            }
+
+            return numWrittenFields;
+        }
+
+        bool EncodedObjectState::readDelta(const EncodedObjectState* baseline, uint32_t numFields, BitReader& r)
+        {
+            ASSERT(baseline != this);
+
+            if (baseline && baseline->numFields() != numFields)
+                return false;
+
+            // mask of changed fields, we can't have unchanged fields without the baseline
+            InplaceArray<bool, 64> changedFields;
+            changedFields.resize(numFields);
+            for (uint32_t i = 0; i < numFields; ++i)
+            {
+                if (!r.readBit(changedFields[i]))
+                    return false;
+
+                if (!changedFields[i] && !baseline)
+                    return false;
+            }
+
+            m_fields.reset();
+            m_fields.reserve(numFields);
+            m_words.reset();
+
+            for (uint32_t i = 0; i < numFields; ++i)
+            {
+                auto& info = m_fields.emplaceBack();
+                info.firstWord = m_words.size();
+
+                if (changedFields[i])
+                {
+                    BitReader::WORD bitCount = 0;
+                    if (!r.readAdaptiveNumber(bitCount))
+                        return false;
+                    if (bitCount > MAX_FIELD_BITS || r.bitPos() + bitCount > r.bitSize())
+                        return false;
+
+                    info.bitCount = bitCount;
+
+                    auto bitsLeft = info.bitCount;
+                    auto writePtr = m_words.allocateUninitialized(CalcWordCount(bitCount));
+                    while (bitsLeft > 0)
+                    {
+                        const auto numBits = std::min<uint32_t>(bitsLeft, WORD_BITS);
+                        if (!r.readBits(numBits, *writePtr++))
+                            return false;
+                        bitsLeft -= numBits;
+                    }
+                }
+                else
+                {
+                    const auto& baselineInfo = baseline->m_fields[i];
+                    info.bitCount = baselineInfo.bitCount;
+
+                    if (const auto numWords = CalcWordCount(info.bitCount))
+                        m_words.pushBack(baseline->m_words.typedData() + baselineInfo.firstWord, numWords);
+                }
+            }
+
+            return true;
+        }
+
+        //--
+
+    } // replication
+} // base
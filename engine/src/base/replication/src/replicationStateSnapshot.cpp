@@ -0,0 +1,475 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "replicationStateSnapshot.h"
+#include "replicationObjectState.h"
+#include "replicationDataModel.h"
+#include "replicationDataModelRepository.h"
+#include "replicationBitWriter.h"
+#include "replicationBitReader.h"
+
+#include "base/containers/include/inplaceArray.h"
+
+namespace base
+{
+    namespace replication
+    {
+
+        //--
+
+        void StateSnapshotWriterStats::print(IFormatStream& f) const
+        {
+            f.appendf("Snapshots: {} ({} acknowledged, {} lost), {}", numSnapshots, numAcknowledged, numLost, MemSize((totalBits + 7) / 8));
+            if (numSnapshots)
+                f.appendf(" ({} per snapshot)", MemSize((totalBits / numSnapshots + 7) / 8));
+            f.appendf("\nObjects sent: {} ({} full, {} fields), {} unchanged, {} deferred, {} removed", numObjectsSent, numObjectsSentFull, numFieldsSent, numObjectsUnchanged, numObjectsDeferred, numObjectsRemoved);
+        }
+
+        void StateSnapshotReaderStats::print(IFormatStream& f) const
+        {
+            f.appendf("Snapshots: {}, {}", numSnapshots, MemSize((totalBits + 7) / 8));
+            f.appendf("\nObjects updated: {}, removed: {}", numObjectsUpdated, numObjectsRemoved);
+        }
+
+        //--
+
+        StateSnapshotWriter::StateSnapshotWriter()
+        {}
+
+        StateSnapshotWriter::~StateSnapshotWriter()
+        {
+            m_pendingSnapshots.clearPtr();
+            m_freeSnapshots.clearPtr();
+            m_objects.clearPtr();
+        }
+
+        StateSnapshotWriter::ObjectEntry* StateSnapshotWriter::findEntry(ReplicatedObjectID id, uint32_t sequence) const
+        {
+            // states sent before the entry was (re)created belong to a previous incarnation of the object
+            ObjectEntry* entry = nullptr;
+            if (m_objects.find(id, entry) && sequence >= entry->firstSequence)
+                return entry;
+            return nullptr;
+        }
+
+        void StateSnapshotWriter::removeEntry(ObjectEntry* entry)
+        {
+            m_objects.remove(entry->id);
+            MemDelete(entry);
+        }
+
+        void StateSnapshotWriter::retireSnapshot(SentSnapshot* snapshot, bool acknowledged)
+        {
+            for (auto& sent : snapshot->objects)
+            {
+                auto entry = findEntry(sent.id, snapshot->sequence);
+                if (!entry)
+                    continue;
+
+                if (sent.removed)
+                {
+                    // object is gone on the other side, we can forget about it
+                    if (acknowledged && entry->removedSequence && snapshot->sequence >= entry->removedSequence)
+                        removeEntry(entry);
+                    continue;
+                }
+
+                if (entry->numStatesInFlight > 0)
+                    entry->numStatesInFlight -= 1;
+
+                // other side has this state, we can use it as a baseline
+                // NOTE: acknowledged snapshot is retired last so the states still in flight are exactly the ones sent after it
+                if (acknowledged && snapshot->sequence > entry->baselineSequence)
+                {
+                    std::swap(entry->baseline, sent.state);
+                    entry->baselineSequence = snapshot->sequence;
+                    entry->numStatesSinceBaseline = entry->numStatesInFlight;
+                }
+            }
+
+            if (acknowledged)
+                m_stats.numAcknowledged += 1;
+            else
+                m_stats.numLost += 1;
+
+            snapshot->objects.reset();
+            m_freeSnapshots.pushBack(snapshot);
+        }
+
+        void StateSnapshotWriter::acknowledge(uint32_t sequence)
+        {
+            // late acknowledgments don't give us anything
+            if (sequence <= m_lastAcknowledgedSequence || sequence >= m_nextSequence)
+                return;
+
+            m_lastAcknowledgedSequence = sequence;
+
+            // all older snapshots that were not acknowledged so far are assumed lost
+            // NOTE: the other side keeps the states in the order they were received so the older states will be forgotten first
+            while (!m_pendingSnapshots.empty() && m_pendingSnapshots[0]->sequence <= sequence)
+            {
+                auto snapshot = m_pendingSnapshots[0];
+                m_pendingSnapshots.erase(0);
+                retireSnapshot(snapshot, snapshot->sequence == sequence);
+            }
+        }
+
+        uint32_t StateSnapshotWriter::writeSnapshot(const StateSnapshotObject* objects, uint32_t numObjects, uint32_t bitBudget, IDataModelMapper& mapper, BitWriter& w)
+        {
+            const auto sequence = m_nextSequence++;
+            const auto startBit = w.bitSize();
+
+            // we waited too long for the acknowledgment, assume the oldest snapshot was lost
+            // NOTE: the states from it still count towards the history of the other side (numStatesSinceBaseline) so the baselines stay valid
+            while (m_pendingSnapshots.size() >= STATE_SNAPSHOT_MAX_PENDING)
+            {
+                auto snapshot = m_pendingSnapshots[0];
+                m_pendingSnapshots.erase(0);
+                retireSnapshot(snapshot, false);
+            }
+
+            SentSnapshot* snapshot = nullptr;
+            if (m_freeSnapshots.empty())
+            {
+                snapshot = MemNew(SentSnapshot);
+            }
+            else
+            {
+                snapshot = m_freeSnapshots.back();
+                m_freeSnapshots.popBack();
+            }
+
+            snapshot->sequence = sequence;
+            m_pendingSnapshots.pushBack(snapshot);
+
+            w.reserve(64);
+            w.writeBits(sequence, 32);
+
+            // collect relevant objects, the longer the object waits the higher the priority gets
+            struct Candidate
+            {
+                ObjectEntry* entry = nullptr;
+                const EncodedObjectState* state = nullptr;
+            };
+
+            InplaceArray<Candidate, 256> candidates;
+            candidates.reserve(numObjects);
+
+            for (uint32_t i = 0; i < numObjects; ++i)
+            {
+                const auto& object = objects[i];
+                if (!object.model || !object.state || object.priority <= 0.0f)
+                    continue;
+
+                ObjectEntry* entry = nullptr;
+                if (!m_objects.find(object.id, entry))
+                {
+                    entry = MemNew(ObjectEntry);
+                    entry->id = object.id;
+                    entry->model = object.model;
+                    entry->firstSequence = sequence;
+                    m_objects[object.id] = entry;
+                }
+                else if (entry->model != object.model || entry->removedSequence != 0)
+                {
+                    // object was removed or changed type, start from scratch
+                    entry->model = object.model;
+                    entry->firstSequence = sequence;
+                    entry->baseline.clear();
+                    entry->baselineSequence = 0;
+                    entry->removedSequence = 0;
+                    entry->numStatesInFlight = 0;
+                    entry->numStatesSinceBaseline = 0;
+                    entry->accumulatedPriority = 0.0f;
+                }
+
+                if (entry->lastListedSequence == sequence)
+                    continue; // listed twice
+
+                entry->lastListedSequence = sequence;
+                entry->accumulatedPriority += object.priority;
+
+                auto& candidate = candidates.emplaceBack();
+                candidate.entry = entry;
+                candidate.state = object.state;
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+                {
+                    return a.entry->accumulatedPriority > b.entry->accumulatedPriority;
+                });
+
+            // remove objects that are no longer listed, removals are sent until acknowledged and they don't count towards the budget
+            InplaceArray<ObjectEntry*, 64> forgottenEntries;
+            for (auto entry : m_objects.values())
+            {
+                if (entry->lastListedSequence == sequence)
+                    continue;
+
+                // the other side never heard about this object
+                // NOTE: a previous incarnation may still exist on the other side if the removal did not get through, in such case we still send the removal
+                if (!entry->lastSentSequence)
+                {
+                    forgottenEntries.pushBack(entry);
+                    continue;
+                }
+
+                if (!entry->removedSequence)
+                    entry->removedSequence = sequence;
+
+                w.reserve(64);
+                w.writeBit(1);
+                w.writeAdaptiveNumber(entry->id);
+                w.writeBit(1); // removed
+
+                auto& sent = snapshot->objects.emplaceBack();
+                sent.id = entry->id;
+                sent.removed = true;
+
+                m_stats.numObjectsRemoved += 1;
+            }
+
+            for (auto entry : forgottenEntries)
+                removeEntry(entry);
+
+            // write objects in the priority order until we run out of budget
+            uint32_t numSentObjects = 0;
+            for (const auto& candidate : candidates)
+            {
+                auto entry = candidate.entry;
+
+                // we can use the acknowledged state as a baseline only if the other side did not forget it yet
+                const EncodedObjectState* baseline = nullptr;
+                if (entry->baselineSequence && (entry->numStatesSinceBaseline + 1) < STATE_SNAPSHOT_OBJECT_HISTORY)
+                    baseline = &entry->baseline;
+
+                // if nothing changed since the acknowledged state and there are no other states in flight there's nothing to send
+                // NOTE: with states in flight we still need to send the (empty) delta so the other side reverts to the baseline values
+                auto deltaBits = candidate.state->calcDeltaBitCount(baseline);
+                if (!deltaBits)
+                {
+                    if (!entry->numStatesSinceBaseline)
+                    {
+                        entry->accumulatedPriority = 0.0f;
+                        m_stats.numObjectsUnchanged += 1;
+                        continue;
+                    }
+
+                    deltaBits = candidate.state->numFields();
+                }
+
+                // compute the full size of the update so we know if it fits in the budget
+                const auto modelNameId = baseline ? 0 : mapper.mapString(entry->model->name().view());
+                const auto headerBits = 3 + BitWriter::CalcAdaptiveNumberBitCount(entry->id)
+                    + BitWriter::CalcAdaptiveNumberBitCount(baseline ? (sequence - entry->baselineSequence) : modelNameId);
+                // NOTE: at least one object is always sent so big objects are not starved
+                if (bitBudget && numSentObjects && (w.bitSize() - startBit) + headerBits + deltaBits + 1 > bitBudget)
+                {
+                    m_stats.numObjectsDeferred += 1;
+                    continue;
+                }
+
+                w.reserve(headerBits);
+                w.writeBit(1);
+                w.writeAdaptiveNumber(entry->id);
+                w.writeBit(0); // not removed
+                w.writeBit(baseline != nullptr);
+                if (baseline)
+                    w.writeAdaptiveNumber(sequence - entry->baselineSequence);
+                else
+                    w.writeAdaptiveNumber(modelNameId);
+
+                m_stats.numFieldsSent += candidate.state->writeDelta(baseline, w);
+                m_stats.numObjectsSent += 1;
+                if (!baseline)
+                    m_stats.numObjectsSentFull += 1;
+
+                // remember what we sent so we can use it as a baseline once it's acknowledged
+                auto& sent = snapshot->objects.emplaceBack();
+                sent.id = entry->id;
+                sent.state = *candidate.state;
+
+                numSentObjects += 1;
+                entry->accumulatedPriority = 0.0f;
+                entry->numStatesInFlight += 1;
+                entry->numStatesSinceBaseline += 1;
+                entry->lastSentSequence = sequence;
+            }
+
+            // end of objects
+            w.reserve(1);
+            w.writeBit(0);
+
+            m_stats.numSnapshots += 1;
+            m_stats.totalBits += w.bitSize() - startBit;
+            return sequence;
+        }
+
+        //--
+
+        IStateSnapshotTarget::~IStateSnapshotTarget()
+        {}
+
+        //--
+
+        const StateSnapshotReader::ReceivedState* StateSnapshotReader::ObjectEntry::findState(uint32_t sequence) const
+        {
+            if (hasHistory && sequence)
+            {
+                for (const auto& entry : history)
+                    if (entry.sequence == sequence)
+                        return &entry;
+            }
+
+            return nullptr;
+        }
+
+        StateSnapshotReader::StateSnapshotReader(const DataModelRepositoryPtr& models)
+            : m_models(models)
+        {}
+
+        StateSnapshotReader::~StateSnapshotReader()
+        {
+            m_objects.clearPtr();
+        }
+
+        bool StateSnapshotReader::readingError(StringView<char> message) const
+        {
+            TRACE_WARNING("StateSnapshotReader: {}", message);
+            return false;
+        }
+
+        bool StateSnapshotReader::readSnapshot(BitReader& r, IDataModelResolver& resolver, IStateSnapshotTarget& target, uint32_t& outSequence)
+        {
+            const auto startBit = r.bitPos();
+
+            BitReader::WORD sequence = 0;
+            if (!r.readBits(32, sequence))
+                return readingError("Missing snapshot header");
+
+            // states are stored in the order they were received, we can't go back
+            if (sequence <= m_lastSequence)
+                return readingError(TempString("Snapshot {} is older than the last received snapshot {}", sequence, m_lastSequence));
+
+            for (;;)
+            {
+                bool hasObject = false;
+                if (!r.readBit(hasObject))
+                    return readingError("Unexpected end of snapshot data");
+
+                if (!hasObject)
+                    break;
+
+                if (!readObject(sequence, r, resolver, target))
+                    return false;
+            }
+
+            m_lastSequence = sequence;
+            m_stats.numSnapshots += 1;
+            m_stats.totalBits += r.bitPos() - startBit;
+
+            outSequence = sequence;
+            return true;
+        }
+
+        bool StateSnapshotReader::readObject(uint32_t sequence, BitReader& r, IDataModelResolver& resolver, IStateSnapshotTarget& target)
+        {
+            BitReader::WORD id = 0;
+            bool removed = false;
+            if (!r.readAdaptiveNumber(id) || !r.readBit(removed))
+                return readingError("Invalid object header");
+
+            ObjectEntry* entry = nullptr;
+            m_objects.find(id, entry);
+
+            if (removed)
+            {
+                // we may get the removal more than once if the acknowledgment did not get through in time
+                if (entry)
+                {
+                    m_objects.remove(id);
+                    MemDelete(entry);
+
+                    target.objectStateRemoved(id);
+                    m_stats.numObjectsRemoved += 1;
+                }
+
+                return true;
+            }
+
+            bool hasBaseline = false;
+            BitReader::WORD baselineInfo = 0;
+            if (!r.readBit(hasBaseline) || !r.readAdaptiveNumber(baselineInfo))
+                return readingError("Invalid object header");
+
+            const EncodedObjectState* baseline = nullptr;
+            if (hasBaseline)
+            {
+                if (!entry)
+                    return readingError(TempString("Baseline for unknown object {}", id));
+
+                auto baselineState = entry->findState(sequence - baselineInfo);
+                if (!baselineState)
+                    return readingError(TempString("Missing baseline {} for object {}", sequence - baselineInfo, id));
+
+                baseline = &baselineState->state;
+            }
+            else
+            {
+                // full state, this is also how new objects are created
+                StringID modelName;
+                if (!resolver.resolveStringID((DataMappedID)baselineInfo, modelName))
+                    return readingError(TempString("Unknown model name for object {}", id));
+
+                auto model = m_models->buildModelForType(RTTI::GetInstance().findType(modelName));
+                if (!model)
+                    return readingError(TempString("Unknown model '{}' for object {}", modelName, id));
+
+                if (!entry)
+                {
+                    entry = MemNew(ObjectEntry);
+                    m_objects[id] = entry;
+                }
+                else if (entry->model != model)
+                {
+                    for (auto& state : entry->history)
+                        state.sequence = 0;
+                    entry->hasHistory = false;
+                    entry->decoded = false;
+                }
+
+                entry->model = model;
+            }
+
+            // reconstruct the full state
+            if (!m_tempState.readDelta(baseline, entry->model->fields().size(), r))
+                return readingError(TempString("Invalid state of object {}", id));
+
+            // apply only the fields that changed since the last state we decoded
+            if (auto data = target.objectStateData(id, entry->model))
+            {
+                const auto* previous = (entry->hasHistory && entry->decoded) ? &entry->history[entry->lastIndex].state : nullptr;
+                if (!m_tempState.decode(*entry->model, data, resolver, previous))
+                    return readingError(TempString("Unable to decode state of object {}", id));
+
+                entry->decoded = true;
+                m_stats.numObjectsUpdated += 1;
+            }
+
+            // store in history, replaces the oldest state
+            const auto index = entry->hasHistory ? (entry->lastIndex + 1) % STATE_SNAPSHOT_OBJECT_HISTORY : 0;
+            std::swap(entry->history[index].state, m_tempState);
+            entry->history[index].sequence = sequence;
+            entry->lastIndex = index;
+            entry->hasHistory = true;
+            return true;
+        }
+
+        //--
+
+    } // replication
+} // base
@@ -0,0 +1,579 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "replicationBitWriter.h"
+#include "replicationBitReader.h"
+#include "replicationDataModel.h"
+#include "replicationDataModelRepository.h"
+#include "replicationRttiExtensions.h"
+#include "replicationObjectState.h"
+#include "replicationStateSnapshot.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/system/include/timedScope.h"
+
+DECLARE_TEST_FILE(StateSnapshotTest);
+
+using namespace base;
+using namespace base::replication;
+
+namespace test
+{
+    //---
+
+    struct TestSnapshotEntity
+    {
+        RTTI_DECLARE_NONVIRTUAL_CLASS(TestSnapshotEntity);
+
+    public:
+        float m_x = 0.0f;
+        float m_y = 0.0f;
+        float m_z = 0.0f;
+        float m_yaw = 0.0f;
+        uint8_t m_health = 100;
+        bool m_alive = true;
+    };
+
+    RTTI_BEGIN_TYPE_STRUCT(TestSnapshotEntity);
+        RTTI_PROPERTY(m_x).metadata<replication::SetupMetadata>("f:16,-1000,1000");
+        RTTI_PROPERTY(m_y).metadata<replication::SetupMetadata>("f:16,-1000,1000");
+        RTTI_PROPERTY(m_z).metadata<replication::SetupMetadata>("f:16,-1000,1000");
+        RTTI_PROPERTY(m_yaw).metadata<replication::SetupMetadata>("f:10,0,360");
+        RTTI_PROPERTY(m_health).metadata<replication::SetupMetadata>("u:7");
+        RTTI_PROPERTY(m_alive).metadata<replication::SetupMetadata>("b");
+    RTTI_END_TYPE();
+
+    //---
+
+    static uint32_t NextRandom(uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)(state >> 33);
+    }
+
+    static float NextRandomFloat(uint64_t& state, float minValue, float maxValue)
+    {
+        return minValue + (maxValue - minValue) * ((NextRandom(state) & 0xFFFF) / 65535.0f);
+    }
+
+    // mapper/resolver for strings only, that's all the snapshots need for the model names
+    class SnapshotKnowledgeBase : public IDataModelResolver, public IDataModelMapper
+    {
+    public:
+        SnapshotKnowledgeBase()
+        {
+            m_strings.pushBack("");
+        }
+
+        virtual DataMappedID mapString(StringView<char> txt) override final
+        {
+            if (txt.empty())
+                return 0;
+
+            DataMappedID id = 0;
+            StringBuf str(txt);
+            if (m_stringMap.find(str, id))
+                return id;
+
+            id = (DataMappedID)m_strings.size();
+            m_strings.pushBack(str);
+            m_stringMap[str] = id;
+            return id;
+        }
+
+        virtual DataMappedID mapPath(StringView<char> path, const char* pathSeparators) override final
+        {
+            return mapString(path);
+        }
+
+        virtual DataMappedID mapObject(const IObject* obj) override final
+        {
+            return 0;
+        }
+
+        virtual bool resolveString(DataMappedID id, IFormatStream& ret) override final
+        {
+            if (id && id < m_strings.size())
+                ret << m_strings[id];
+            return true;
+        }
+
+        virtual bool resolvePath(DataMappedID id, const char* pathSeparator, IFormatStream& ret) override final
+        {
+            return resolveString(id, ret);
+        }
+
+        virtual bool resolveObject(DataMappedID id, ObjectPtr& outPtr) override final
+        {
+            outPtr = ObjectPtr();
+            return true;
+        }
+
+    private:
+        HashMap<StringBuf, DataMappedID> m_stringMap;
+        Array<StringBuf> m_strings;
+    };
+
+    // receiving side, keeps the objects by ID
+    class SnapshotTarget : public IStateSnapshotTarget
+    {
+    public:
+        HashMap<ReplicatedObjectID, TestSnapshotEntity> m_objects;
+        uint32_t m_numRemoved = 0;
+
+        virtual void* objectStateData(ReplicatedObjectID id, const DataModel* model) override final
+        {
+            return &m_objects[id];
+        }
+
+        virtual void objectStateRemoved(ReplicatedObjectID id) override final
+        {
+            m_objects.remove(id);
+            m_numRemoved += 1;
+        }
+    };
+
+    // simulation of a connection, sender and receiver share the knowledge base for simplicity
+    struct SnapshotChannel
+    {
+        SnapshotChannel()
+            : m_models(CreateSharedPtr<DataModelRepository>())
+            , m_reader(m_models)
+        {
+            m_model = m_models->buildModelForType(TestSnapshotEntity::GetStaticClass());
+        }
+
+        void createEntities(uint32_t count, uint64_t& seed)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                auto& entity = m_entities.emplaceBack();
+                entity.m_x = NextRandomFloat(seed, -900.0f, 900.0f);
+                entity.m_y = NextRandomFloat(seed, -900.0f, 900.0f);
+                entity.m_z = NextRandomFloat(seed, -100.0f, 100.0f);
+                entity.m_yaw = NextRandomFloat(seed, 0.0f, 359.0f);
+                entity.m_health = NextRandom(seed) % 100;
+                m_ids.pushBack(100 + i * 3);
+            }
+        }
+
+        void moveEntities(uint32_t count, uint64_t& seed)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                auto& entity = m_entities[NextRandom(seed) % m_entities.size()];
+                entity.m_x = std::clamp(entity.m_x + NextRandomFloat(seed, -5.0f, 5.0f), -999.0f, 999.0f);
+                entity.m_y = std::clamp(entity.m_y + NextRandomFloat(seed, -5.0f, 5.0f), -999.0f, 999.0f);
+                entity.m_yaw = NextRandomFloat(seed, 0.0f, 359.0f);
+            }
+        }
+
+        // encode current states and write the snapshot, returns the snapshot sequence
+        uint32_t write(BitWriter& w, uint32_t bitBudget = 0)
+        {
+            m_states.resize(m_entities.size());
+
+            Array<StateSnapshotObject> objects;
+            objects.reserve(m_entities.size());
+            for (uint32_t i = 0; i < m_entities.size(); ++i)
+            {
+                m_states[i].encode(*m_model, &m_entities[i], m_knowledge);
+
+                auto& object = objects.emplaceBack();
+                object.id = m_ids[i];
+                object.model = m_model;
+                object.state = &m_states[i];
+            }
+
+            return m_writer.writeSnapshot(objects.typedData(), objects.size(), bitBudget, m_knowledge, w);
+        }
+
+        // write snapshot, deliver it and (optionally) acknowledge it
+        uint32_t transfer(bool deliver = true, bool acknowledge = true, uint32_t bitBudget = 0)
+        {
+            BitWriter w;
+            const auto sequence = write(w, bitBudget);
+            m_lastSnapshotBits = w.bitSize();
+
+            if (deliver)
+            {
+                BitReader r(w.data(), w.bitSize());
+
+                uint32_t receivedSequence = 0;
+                EXPECT_TRUE(m_reader.readSnapshot(r, m_knowledge, m_target, receivedSequence));
+                EXPECT_EQ(sequence, receivedSequence);
+                EXPECT_EQ(w.bitSize(), r.bitPos());
+
+                if (acknowledge)
+                    m_writer.acknowledge(receivedSequence);
+            }
+
+            return sequence;
+        }
+
+        void expectInSync() const
+        {
+            EXPECT_EQ(m_entities.size(), m_target.m_objects.size());
+            for (uint32_t i = 0; i < m_entities.size(); ++i)
+            {
+                const TestSnapshotEntity* received = m_target.m_objects.find(m_ids[i]);
+                ASSERT_TRUE(received != nullptr);
+
+                const auto& sent = m_entities[i];
+                EXPECT_NEAR(sent.m_x, received->m_x, 0.1f);
+                EXPECT_NEAR(sent.m_y, received->m_y, 0.1f);
+                EXPECT_NEAR(sent.m_z, received->m_z, 0.1f);
+                EXPECT_NEAR(sent.m_yaw, received->m_yaw, 0.5f);
+                EXPECT_EQ(sent.m_health, received->m_health);
+                EXPECT_EQ(sent.m_alive, received->m_alive);
+            }
+        }
+
+        DataModelRepositoryPtr m_models;
+        const DataModel* m_model = nullptr;
+
+        SnapshotKnowledgeBase m_knowledge;
+        StateSnapshotWriter m_writer;
+        StateSnapshotReader m_reader;
+        SnapshotTarget m_target;
+
+        Array<TestSnapshotEntity> m_entities;
+        Array<ReplicatedObjectID> m_ids;
+        Array<EncodedObjectState> m_states;
+
+        uint32_t m_lastSnapshotBits = 0;
+    };
+
+} // test
+
+TEST(ObjectState, DeltaOfUnchangedStateIsEmpty)
+{
+    auto models = CreateSharedPtr<DataModelRepository>();
+    auto model = models->buildModelForType(test::TestSnapshotEntity::GetStaticClass());
+    ASSERT_TRUE(model);
+    ASSERT_EQ(6, model->fields().size());
+
+    test::SnapshotKnowledgeBase kb;
+    test::TestSnapshotEntity entity;
+    entity.m_x = 10.0f;
+    entity.m_yaw = 45.0f;
+
+    EncodedObjectState a, b;
+    a.encode(*model, &entity, kb);
+    b.encode(*model, &entity, kb);
+    EXPECT_EQ(0, b.calcDeltaBitCount(&a));
+
+    // changes below the quantization precision are not changes
+    entity.m_x += 0.001f;
+    b.encode(*model, &entity, kb);
+    EXPECT_EQ(0, b.calcDeltaBitCount(&a));
+
+    entity.m_health = 5;
+    b.encode(*model, &entity, kb);
+    EXPECT_NE(0, b.calcDeltaBitCount(&a));
+    EXPECT_LT(b.calcDeltaBitCount(&a), b.calcDeltaBitCount(nullptr));
+    EXPECT_FALSE(b.fieldEquals(4, a));
+    EXPECT_TRUE(b.fieldEquals(0, a));
+}
+
+TEST(ObjectState, DeltaRoundTrip)
+{
+    auto models = CreateSharedPtr<DataModelRepository>();
+    auto model = models->buildModelForType(test::TestSnapshotEntity::GetStaticClass());
+
+    test::SnapshotKnowledgeBase kb;
+    test::TestSnapshotEntity entity;
+    entity.m_x = -500.0f;
+    entity.m_y = 300.0f;
+    entity.m_yaw = 90.0f;
+
+    EncodedObjectState baseline;
+    baseline.encode(*model, &entity, kb);
+
+    entity.m_y = 310.0f;
+    entity.m_alive = false;
+
+    EncodedObjectState current;
+    current.encode(*model, &entity, kb);
+
+    BitWriter w;
+    w.reserve(current.calcDeltaBitCount(&baseline));
+    EXPECT_EQ(2, current.writeDelta(&baseline, w));
+    EXPECT_EQ(current.calcDeltaBitCount(&baseline), w.bitSize());
+
+    EncodedObjectState received;
+    BitReader r(w.data(), w.bitSize());
+    ASSERT_TRUE(received.readDelta(&baseline, model->fields().size(), r));
+    EXPECT_EQ(w.bitSize(), r.bitPos());
+    EXPECT_EQ(0, received.calcDeltaBitCount(&current));
+
+    test::TestSnapshotEntity decoded;
+    ASSERT_TRUE(received.decode(*model, &decoded, kb));
+    EXPECT_NEAR(-500.0f, decoded.m_x, 0.1f);
+    EXPECT_NEAR(310.0f, decoded.m_y, 0.1f);
+    EXPECT_NEAR(90.0f, decoded.m_yaw, 0.5f);
+    EXPECT_FALSE(decoded.m_alive);
+}
+
+TEST(ObjectState, DeltaWithoutBaselineRequiresAllFields)
+{
+    auto models = CreateSharedPtr<DataModelRepository>();
+    auto model = models->buildModelForType(test::TestSnapshotEntity::GetStaticClass());
+
+    test::SnapshotKnowledgeBase kb;
+    test::TestSnapshotEntity entity;
+
+    EncodedObjectState a, b;
+    a.encode(*model, &entity, kb);
+    b.encode(*model, &entity, kb);
+
+    BitWriter w;
+    w.reserve(64);
+    b.writeDelta(&a, w); // only the mask
+
+    EncodedObjectState received;
+    BitReader r(w.data(), w.bitSize());
+    EXPECT_FALSE(received.readDelta(nullptr, model->fields().size(), r));
+}
+
+TEST(StateSnapshot, InitialSnapshotCreatesObjects)
+{
+    uint64_t seed = 1;
+    test::SnapshotChannel channel;
+    channel.createEntities(10, seed);
+
+    channel.transfer();
+    channel.expectInSync();
+
+    EXPECT_EQ(10, channel.m_writer.stats().numObjectsSent);
+    EXPECT_EQ(10, channel.m_writer.stats().numObjectsSentFull);
+    EXPECT_EQ(1, channel.m_writer.stats().numAcknowledged);
+}
+
+TEST(StateSnapshot, OnlyChangedObjectsAreSent)
+{
+    uint64_t seed = 2;
+    test::SnapshotChannel channel;
+    channel.createEntities(10, seed);
+
+    channel.transfer();
+    const auto fullBits = channel.m_lastSnapshotBits;
+
+    channel.m_entities[3].m_x += 10.0f;
+    channel.transfer();
+    channel.expectInSync();
+
+    EXPECT_EQ(11, channel.m_writer.stats().numObjectsSent);
+    EXPECT_EQ(9, channel.m_writer.stats().numObjectsUnchanged);
+    EXPECT_EQ(11, channel.m_reader.stats().numObjectsUpdated);
+    EXPECT_LT(channel.m_lastSnapshotBits * 10, fullBits);
+
+    // nothing changed, only the snapshot header is sent
+    channel.transfer();
+    EXPECT_EQ(11, channel.m_writer.stats().numObjectsSent);
+    EXPECT_EQ(33, channel.m_lastSnapshotBits); // sequence + end marker
+}
+
+TEST(StateSnapshot, ChangesAreResentUntilAcknowledged)
+{
+    uint64_t seed = 3;
+    test::SnapshotChannel channel;
+    channel.createEntities(20, seed);
+
+    channel.transfer();
+
+    // acknowledgments are lost, the changes are sent relative to the last acknowledged state
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        channel.moveEntities(2, seed);
+        channel.transfer(true, false);
+        channel.expectInSync();
+    }
+
+    // value reverts to the acknowledged one while changes are in flight, other side still has to get it
+    const auto originalHealth = channel.m_entities[0].m_health;
+    channel.m_entities[0].m_health = originalHealth + 1;
+    channel.transfer(true, false);
+    channel.expectInSync();
+
+    channel.m_entities[0].m_health = originalHealth;
+    channel.transfer(true, false);
+    channel.expectInSync();
+
+    channel.transfer(true, true);
+    channel.expectInSync();
+
+    EXPECT_EQ(20, channel.m_writer.stats().numObjectsSentFull);
+}
+
+TEST(StateSnapshot, LostSnapshots)
+{
+    uint64_t seed = 4;
+    test::SnapshotChannel channel;
+    channel.createEntities(50, seed);
+
+    channel.transfer();
+
+    for (uint32_t i = 0; i < 40; ++i)
+    {
+        channel.moveEntities(5, seed);
+
+        const auto lost = (i % 3) != 0;
+        channel.transfer(!lost, !lost);
+        if (!lost)
+            channel.expectInSync();
+    }
+
+    channel.transfer();
+    channel.expectInSync();
+    EXPECT_EQ(50, channel.m_writer.stats().numObjectsSentFull);
+    EXPECT_NE(0, channel.m_writer.stats().numLost);
+}
+
+TEST(StateSnapshot, AcknowledgmentsNeverArrive)
+{
+    uint64_t seed = 5;
+    test::SnapshotChannel channel;
+    channel.createEntities(10, seed);
+
+    // history of the other side is limited, once we run out of it we must send full states
+    for (uint32_t i = 0; i < 3 * STATE_SNAPSHOT_MAX_PENDING; ++i)
+    {
+        channel.moveEntities(1, seed);
+        channel.transfer(true, false);
+        channel.expectInSync();
+    }
+
+    EXPECT_NE(0, channel.m_writer.stats().numLost);
+}
+
+TEST(StateSnapshot, DelayedAcknowledgment)
+{
+    uint64_t seed = 6;
+    test::SnapshotChannel channel;
+    channel.createEntities(10, seed);
+
+    // acknowledgments arrive few snapshots later, baselines are older than the last received states
+    Array<uint32_t> receivedSequences;
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        channel.moveEntities(3, seed);
+        receivedSequences.pushBack(channel.transfer(true, false));
+        channel.expectInSync();
+
+        if (receivedSequences.size() > 4)
+        {
+            channel.m_writer.acknowledge(receivedSequences[0]);
+            receivedSequences.erase(0);
+        }
+    }
+
+    EXPECT_EQ(10, channel.m_writer.stats().numObjectsSentFull);
+}
+
+TEST(StateSnapshot, RemovedObjects)
+{
+    uint64_t seed = 7;
+    test::SnapshotChannel channel;
+    channel.createEntities(10, seed);
+    channel.transfer();
+
+    channel.m_entities.erase(4);
+    channel.m_ids.erase(4);
+    channel.transfer(true, false);
+    channel.expectInSync();
+    EXPECT_EQ(1, channel.m_target.m_numRemoved);
+
+    // removal is sent again until acknowledged
+    channel.transfer(true, true);
+    channel.expectInSync();
+    EXPECT_EQ(2, channel.m_writer.stats().numObjectsRemoved);
+
+    channel.transfer();
+    EXPECT_EQ(2, channel.m_writer.stats().numObjectsRemoved);
+    EXPECT_EQ(1, channel.m_target.m_numRemoved);
+
+    // object comes back with the same ID
+    channel.createEntities(1, seed);
+    channel.m_ids.back() = 100 + 4 * 3;
+    channel.transfer();
+    channel.expectInSync();
+    EXPECT_EQ(11, channel.m_writer.stats().numObjectsSentFull);
+}
+
+TEST(StateSnapshot, BudgetDefersObjects)
+{
+    uint64_t seed = 8;
+    test::SnapshotChannel channel;
+    channel.createEntities(100, seed);
+
+    const uint32_t budget = 1500;
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        channel.moveEntities(20, seed);
+        channel.transfer(true, true, budget);
+        EXPECT_LE(channel.m_lastSnapshotBits, budget);
+    }
+
+    EXPECT_NE(0, channel.m_writer.stats().numObjectsDeferred);
+
+    // objects waiting the longest get in first so everything gets through eventually
+    for (uint32_t i = 0; i < 50; ++i)
+        channel.transfer(true, true, budget);
+
+    channel.expectInSync();
+}
+
+TEST(StateSnapshot, OldSnapshotIsRejected)
+{
+    uint64_t seed = 9;
+    test::SnapshotChannel channel;
+    channel.createEntities(5, seed);
+
+    BitWriter first;
+    channel.write(first);
+    channel.transfer();
+
+    BitReader r(first.data(), first.bitSize());
+    uint32_t sequence = 0;
+    EXPECT_FALSE(channel.m_reader.readSnapshot(r, channel.m_knowledge, channel.m_target, sequence));
+}
+
+TEST(StateSnapshot, DISABLED_Bandwidth1kEntities)
+{
+    const uint32_t NUM_ENTITIES = 1000;
+    const uint32_t NUM_FRAMES = 600;
+    const uint32_t SNAPSHOTS_PER_SECOND = 20;
+
+    for (uint32_t budget : { 0u, 32000u, 8000u })
+    {
+        uint64_t seed = 10;
+        test::SnapshotChannel channel;
+        channel.createEntities(NUM_ENTITIES, seed);
+
+        uint64_t totalFullBits = 0;
+
+        ScopeTimer timer;
+        for (uint32_t i = 0; i < NUM_FRAMES; ++i)
+        {
+            channel.moveEntities(NUM_ENTITIES / 10, seed);
+            channel.transfer(true, (i % 10) != 0, budget); // some acknowledgments are lost
+
+            for (const auto& state : channel.m_states)
+                totalFullBits += state.calcDeltaBitCount(nullptr);
+        }
+        const auto time = timer.timeElapsed();
+
+        const auto& stats = channel.m_writer.stats();
+        const auto bitsPerSnapshot = stats.totalBits / stats.numSnapshots;
+        const auto fullBitsPerSnapshot = totalFullBits / NUM_FRAMES;
+        TRACE_INFO("Budget {}: {} per snapshot ({}/s at {} Hz), full states would be {} per snapshot ({}/s), {} objects sent, {} deferred, {} unchanged, {} per snapshot to write and read",
+            budget, MemSize(bitsPerSnapshot / 8), MemSize(bitsPerSnapshot * SNAPSHOTS_PER_SECOND / 8), SNAPSHOTS_PER_SECOND,
+            MemSize(fullBitsPerSnapshot / 8), MemSize(fullBitsPerSnapshot * SNAPSHOTS_PER_SECOND / 8),
+            stats.numObjectsSent, stats.numObjectsDeferred, stats.numObjectsUnchanged, TimeInterval(time / NUM_FRAMES));
+    }
+}
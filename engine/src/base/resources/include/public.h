@@ -80,7 +80,8 @@ namespace base
     /// nice helper for async loading of resources if the resource exists it's returned right away without any extra fibers created (it's the major performance win)
     /// if resource does not exist it's queued for loading and internal fiber is created to service it
     /// NOTE: if the resource exists at the moment of the call the callback function is called right away
-    extern BASE_RESOURCES_API void LoadResourceAsync(const res::ResourceKey& key, const std::function<void(const res::BaseReference&)>& funcLoaded);
+    /// NOTE: requests with higher priority are loaded first
+    extern BASE_RESOURCES_API void LoadResourceAsync(const res::ResourceKey& key, const std::function<void(const res::BaseReference&)>& funcLoaded, float priority = 0.0f);
 
     /// load resource from the default depot directory
      /// NOTE: this will yield the current job until the resource is loaded
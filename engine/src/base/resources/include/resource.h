@@ -141,6 +141,11 @@ namespace base
             // NOTE: returns false if there's no well determined streaming distance
             virtual bool calcResourceStreamingDistance(float& outDistance) const;
 
+            // Estimate the memory used by the data of this resource
+            // NOTE: used by the loading service to keep the retained resources within the budget
+            // NOTE: returns 0 if there's no significant data, a minimal cost is assumed in that case
+            virtual uint64_t calcResourceMemorySize() const;
+
             //--
 
             // Bind new metadata
@@ -204,6 +209,18 @@ namespace base
 
         //------
 
+        // Resource's buffers are saved uncompressed in the binary file and memory mapped from it when the resource is loaded from a file on disk
+        // NOTE: the file can't be modified while the loaded resource is alive
+        class BASE_RESOURCES_API ResourceMappedBuffersMetadata : public rtti::IMetadata
+        {
+            RTTI_DECLARE_VIRTUAL_CLASS(ResourceMappedBuffersMetadata, rtti::IMetadata);
+
+        public:
+            ResourceMappedBuffersMetadata();
+        };
+
+        //------
+
         // Resource extension postfix for manifests
         class BASE_RESOURCES_API ResourceManifestExtensionMetadata : public rtti::IMetadata
         {
@@ -304,6 +321,8 @@ namespace base
             INLINE const StringBuf& data() const { return m_data; }
             INLINE uint64_t crc() const { return m_crc; }
 
+            virtual uint64_t calcResourceMemorySize() const override;
+
         private:
             StringBuf m_data;
             uint64_t m_crc;
@@ -326,6 +345,8 @@ namespace base
             INLINE const Buffer& data() const { return m_data; }
             INLINE uint64_t crc() const { return m_crc; }
 
+            virtual uint64_t calcResourceMemorySize() const override;
+
         private:
             Buffer m_data;
             uint64_t m_crc;
@@ -25,6 +25,9 @@ namespace base
             public:
                 BinarySaver();
 
+                // alignment of the buffers saved for mapping (relative to the header), enough for any data used directly from the mapped memory
+                static const uint32_t MAPPED_BUFFER_ALIGNMENT = 16;
+
                 // ISaver
                 virtual bool saveObjects(stream::IBinaryWriter& file, const stream::SavingContext& context) override final;
 
@@ -20,7 +20,22 @@ namespace base
 
         //---
 
+        /// stats of the resource cache
+        struct BASE_RESOURCES_API ResourceCacheStats
+        {
+            uint64_t numRequests = 0; // calls to loadResource/acquireLoadedResource
+            uint64_t numCacheHits = 0; // requests that returned already loaded resource
+            uint64_t numLoads = 0; // resources that were actually loaded
+            uint64_t numJoinedLoads = 0; // requests that waited for the loading started by other request
+            uint64_t numContendedLocks = 0; // times the cache lock was already taken and we had to spin
+
+            void print(IFormatStream& f) const;
+        };
+
+        //---
+
         /// Resource loader with basic caching functionality and multi threaded "gating" 
+        /// NOTE: the cache is split into shards with separate locks so loading from many fibers does not serialize on a single lock
         class BASE_RESOURCES_API IResourceLoaderCached : public IResourceLoader
         {
             RTTI_DECLARE_VIRTUAL_CLASS(IResourceLoaderCached, IResourceLoader);
@@ -39,6 +54,11 @@ namespace base
             /// NOTE: this ONLY returns fully loaded resources (so if the resource is actually being loaded now it's not returned, as the name of the function states)
             virtual ResourceHandle acquireLoadedResource(const ResourceKey& key) override;
 
+            //----
+
+            /// Get stats of the cache (summed over all shards)
+            ResourceCacheStats cacheStats() const;
+
         protected:
             /// Internal interface - load a single resource
             virtual ResourceHandle loadResourceOnce(const ResourceKey& key) CAN_YIELD = 0;
@@ -46,6 +66,15 @@ namespace base
             /// Internal interface - check if internal resource can be used (ie. is still up to date)
             virtual bool validateExistingResource(const ResourceHandle& res, const ResourceKey& key) const;
 
+            /// Get resource from the cache if it's still alive, does not validate it
+            ResourceHandle findLoadedResource(const ResourceKey& key) const;
+
+            /// Check if there's active loading job for given resource
+            bool isResourceLoading(const ResourceKey& key) const;
+
+            /// Replace resource in the cache (ie. after reloading)
+            void replaceLoadedResource(const ResourceKey& key, const ResourceHandle& resource);
+
             //--
         
             struct LoadingJob : public IReferencable
@@ -55,13 +84,23 @@ namespace base
                 ResourceHandle m_loadedResource;
             };
 
-            SpinLock m_lock;
-
             typedef HashMap<ResourceKey, RefWeakPtr<LoadingJob>>    TLoadingJobMap;
-            TLoadingJobMap m_loadingJobs;       // map for active loading jobs
-
             typedef HashMap<ResourceKey, RefWeakPtr<IResource>>    TResourceMap;
-            TResourceMap m_loadedResources;       // map for active loading jobs
+
+            static const uint32_t NUM_CACHE_SHARDS = 32; // shard is selected by the top 5 bits of the key hash
+
+            /// part of the cache, keys are assigned to shards by the path hash
+            TYPE_ALIGN(64, struct) CacheShard
+            {
+                mutable SpinLock m_lock;
+                TLoadingJobMap m_loadingJobs; // map for active loading jobs
+                TResourceMap m_loadedResources; // map for loaded resources
+                ResourceCacheStats m_stats; // updated under the lock
+            };
+
+            CacheShard m_shards[NUM_CACHE_SHARDS];
+
+            CacheShard& shard(const ResourceKey& key) const;
         };
 
         //-----
@@ -18,6 +18,27 @@ namespace base
     {
         //---
 
+        /// stats of the loading service
+        struct BASE_RESOURCES_API LoadingServiceStats
+        {
+            static const uint32_t NUM_LATENCY_BUCKETS = 8;
+
+            uint32_t numQueuedRequests = 0; // async requests waiting to be started
+            uint32_t numLoadingRequests = 0; // async requests being loaded right now
+            uint64_t numCompletedRequests = 0; // async requests finished so far
+            uint64_t numMissedDeadlines = 0; // async requests that finished after their deadline
+            uint64_t latencyHistogram[NUM_LATENCY_BUCKETS]; // time from request to completion, bucket N counts requests below 1ms * 4^N, last bucket counts everything else
+
+            uint32_t numRetainedFiles = 0; // resources kept alive after use
+            uint64_t retainedMemory = 0; // estimated memory of the retained resources
+
+            LoadingServiceStats();
+
+            void print(IFormatStream& f) const;
+        };
+
+        //---
+
         // resource loading service
         class BASE_RESOURCES_API LoadingService : public app::ILocalService
         {
@@ -47,9 +68,20 @@ namespace base
             CAN_YIELD BaseReference loadResource(const ResourceKey& key);
 
             /// nice helper for async loading of resources if the resource exists it's returned right away without any extra fibers created (it's the major performance win)
-            /// if resource does not exist it's queued for loading and internal fiber is created to service it
+            /// if resource does not exist it's queued for loading and serviced by one of the streaming fibers
+            /// requests with higher priority are started first, for the same priority the one with earlier deadline goes first
             /// NOTE: if the resource exists at the moment of the call the callback function is called right away
-            void loadResourceAsync(const ResourceKey& key, const std::function<void(const BaseReference&)>& funcLoaded);
+            /// NOTE: requesting resource that is already queued joins the existing request and raises its priority if needed
+            void loadResourceAsync(const ResourceKey& key, const std::function<void(const BaseReference&)>& funcLoaded, float priority = 0.0f, NativeTimePoint deadline = NativeTimePoint());
+
+            /// change priority and deadline of queued async request (ie. the object moved closer to the camera)
+            /// NOTE: returns false if there's no such request or it was already started
+            bool updateLoadingPriority(const ResourceKey& key, float priority, NativeTimePoint deadline = NativeTimePoint());
+
+            //--
+
+            /// get the stats
+            LoadingServiceStats stats() const;
 
             //--
 
@@ -64,26 +96,53 @@ namespace base
 
             struct AsyncLoadingJob : public IReferencable
             {
+                ResourceKey m_key;
                 BaseReference m_loadedResource;
                 fibers::WaitCounter m_signal;
+                std::function<void(const BaseReference&)> m_funcLoaded;
+
+                float m_priority = 0.0f;
+                NativeTimePoint m_deadline;
+                NativeTimePoint m_requestTime;
+                uint64_t m_sequence = 0; // keeps the order of requests with the same priority
+                bool m_started = false;
             };
 
             HashMap<ResourceKey, RefWeakPtr<AsyncLoadingJob>> m_asyncLoadingJobsMap;
-            SpinLock m_asyncLoadingJobsMapLock;
+            Array<RefPtr<AsyncLoadingJob>> m_asyncPendingJobs; // not started yet, in no particular order
+            uint32_t m_numStreamingFibers = 0;
+            uint64_t m_asyncJobSequence = 0;
+            LoadingServiceStats m_asyncStats; // only the request counters are kept here
+            SpinLock m_asyncLoadingLock;
+
+            RefPtr<AsyncLoadingJob> popBestPendingJob_NoLock();
+            void processAsyncLoadingJobs();
 
             //---
 
             struct RetainedFile
             {
-                NativeTimePoint m_expiration;
                 ResourceHandle m_ptr;
+                uint64_t m_size = 0;
+                uint64_t m_lastUse = 0;
+                NativeTimePoint m_expiration;
+            };
+
+            struct RetainedFileUse
+            {
+                const IResource* m_ptr = nullptr;
+                uint64_t m_lastUse = 0;
             };
 
-            Queue<RetainedFile> m_retainedFiles;
+            HashMap<const IResource*, RetainedFile> m_retainedFiles;
+            Queue<RetainedFileUse> m_retainedFilesUses; // from least to most recently used, entries for files that were used again later are skipped
+            uint64_t m_retainedFilesUseCounter = 0;
+            uint64_t m_retainedFilesMemory = 0;
             SpinLock m_retainedFilesLock;
 
             void addRetainedFile(const ResourceHandle& file);
             void releaseRetainedFiles();
+            void compactRetainedFileUses_NoLock();
 
             //--
         };
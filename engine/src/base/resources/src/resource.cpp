@@ -168,6 +168,11 @@ namespace base
             return false;
         }
 
+        uint64_t IResource::calcResourceMemorySize() const
+        {
+            return 0;
+        }
+
         RefPtr<IResourceLoader> IResource::loader() const
         {
             return m_loader.lock();
@@ -47,6 +47,9 @@ namespace base
                 if (context.m_selectiveLoadingClass == nullptr)
                     runtimeTables.loadBuffers(file, fileTables);
 
+                // the imports were loading in the background, we need them now to resolve the references
+                runtimeTables.waitForImports();
+
                 // load data
                 if (!runtimeTables.loadExports(0, file, context, fileTables, result))
                     return false;
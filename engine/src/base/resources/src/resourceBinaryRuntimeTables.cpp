@@ -17,6 +17,8 @@
 #include "base/object/include/streamBinaryReader.h"
 #include "base/object/include/streamBinaryVersion.h"
 #include "base/object/include/serializationLoader.h"
+#include "base/object/include/objectGlobalRegistry.h"
+#include "base/io/include/ioSystem.h"
 
 extern std::atomic<int> GNumWaitingImportTables;
 
@@ -33,6 +35,22 @@ namespace base
             {
             }
 
+            RuntimeTables::~RuntimeTables()
+            {
+                // the loading fibers are writing directly into the import table
+                waitForImports();
+            }
+
+            void RuntimeTables::waitForImports()
+            {
+                if (!m_importsSignal.empty())
+                {
+                    PC_SCOPE_LVL1(WaitForImports);
+                    Fibers::GetInstance().waitForCounterAndRelease(m_importsSignal);
+                    m_importsSignal = fibers::WaitCounter();
+                }
+            }
+
             void RuntimeTables::resolve(const stream::LoadingContext& context, const FileTables& fileTables)
             {
                 PC_SCOPE_LVL1(ResolveBinaryTables);
@@ -57,6 +75,9 @@ namespace base
             {
                 PC_SCOPE_LVL1(CreateObjects);
 
+                // all exports are created at once, register them in the global registry together
+                ObjectRegistrationBatch registrationBatch;
+
                 bool selectiveLoadingObjectSelected = false;
                 for (uint32_t exportIndex = 0; exportIndex < m_mappedExports.size(); ++exportIndex)
                 {
@@ -473,7 +494,9 @@ namespace base
                     PC_SCOPE_LVL1(LoadImports);
 
                     // create a signal to indicate end of loading
+                    // NOTE: we don't wait here, the objects can be created and the buffers loaded while the imports are loading
                     auto signal = Fibers::GetInstance().createCounter("WaitForImports", resourcesToLoad.size());
+                    m_importsSignal = signal;
 
                     // start a fiber job to load each dependency
                     for (auto i : resourcesToLoad)
@@ -488,12 +511,6 @@ namespace base
                             Fibers::GetInstance().signalCounter(signal);
                         };
                     }
-
-                    // wait
-                    {
-                        PC_SCOPE_LVL1(WaitForImports);
-                        Fibers::GetInstance().waitForCounterAndRelease(signal);
-                    }
                 }
             }
 
@@ -553,23 +570,25 @@ namespace base
 
             void RuntimeTables::resolveBuffers(const stream::LoadingContext& context, const FileTables& fileTables)
             {
+                // mapping is requested only when loading from a file on disk, buffers are not needed at all when loading only selected object
+                if (context.m_mappedBuffersFilePath.empty() || context.m_selectiveLoadingClass != nullptr)
+                    return;
+
                 for (uint32_t i = 0; i < m_mappedBuffers.size(); ++i)
                 {
                     auto& data = fileTables.m_buffers[i];
                     auto& buffer = m_mappedBuffers[i];
 
-                    // if we have the async source specified we may try to handle the async buffers properly
-                    /*if (context.m_asyncFileAccess)
-                    {
-                        // create a proper async access point
-                        buffer.access = IBufferAsyncProxy::CreateFromResourceFile(context.m_asyncFileAccess, data.crc, data.m_dataSizeInMemory, data.m_dataSizeOnDisk);
-                        if (buffer.access == nullptr)
-                        {
-                            TRACE_WARNING("Unable to create async buffer {} access point for file '{}'. Buffer will be loaded into memory.",
-                                i, context.m_asyncFileAccess->description().c_str());
-                        }
-                    }*/
-                }               
+                    // only the buffers stored as they are in memory can be mapped, the rest will be loaded into memory
+                    if (data.m_dataSizeOnDisk != data.m_dataSizeInMemory)
+                        continue;
+
+                    // NOTE: the content is not validated here, the pages are not even read yet
+                    if (auto mappedContent = IO::GetInstance().openMemoryMappedForReading(context.m_mappedBuffersFilePath, data.m_dataOffset, data.m_dataSizeInMemory))
+                        buffer.access = CreateSharedPtr<stream::PreloadedBufferLatentLoader>(mappedContent, data.m_crc);
+                    else
+                        TRACE_WARNING("Unable to map buffer {} from file '{}'. Buffer will be loaded into memory.", i, context.m_mappedBuffersFilePath);
+                }
             }
 
             //---
@@ -64,10 +64,14 @@ namespace base
                 Array< ResolvedBuffers > m_mappedBuffers;        // Mapped and resolved buffers
 
                 RuntimeTables();
+                ~RuntimeTables();
 
                 // resolve content of file tables into runtime form
-                // NOTE: this will wait for all imported resources to be loaded first
-                CAN_YIELD void resolve(const stream::LoadingContext& context, const FileTables& fileTables);
+                // NOTE: imported resources that are not loaded yet are only requested here, call waitForImports() before loading the exports
+                void resolve(const stream::LoadingContext& context, const FileTables& fileTables);
+
+                /// wait for the imported resources requested in resolve() to finish loading
+                CAN_YIELD void waitForImports();
 
                 /// create the objects
                 void createExports(const stream::LoadingContext& context, const FileTables& fileTables);
@@ -96,6 +100,8 @@ namespace base
                 void resolveProperties(const stream::LoadingContext& context, const FileTables& fileTables);
                 void resolveExports(const stream::LoadingContext& context, const FileTables& fileTables);
                 void resolveBuffers(const stream::LoadingContext& context, const FileTables& fileTables);
+
+                fibers::WaitCounter m_importsSignal; // signaled when all requested imports are loaded
             };
 
         } // binary
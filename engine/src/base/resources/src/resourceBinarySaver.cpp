@@ -14,6 +14,7 @@
 
 #include "base/object/include/streamBinaryWriter.h"
 #include "base/object/include/object.h"
+#include "resource.h"
 
 namespace base
 {
@@ -250,8 +251,19 @@ namespace base
                 return true;
             }
 
+            static bool SaveBuffersForMapping(const stream::SavingContext& context)
+            {
+                for (const auto* object : context.m_initialExports)
+                    if (object->cls()->findMetadata<ResourceMappedBuffersMetadata>())
+                        return true;
+                return false;
+            }
+
             bool BinarySaver::writeBuffers(stream::IBinaryWriter& file, const stream::SavingContext& context, const StructureMapper& mapper, FileTablesBuilder& tables, uint64_t headerOffset)
             {
+                // buffers that will be mapped from the file are not compressed and are aligned so they can be used directly from the mapped memory
+                const auto mappedBuffers = SaveBuffersForMapping(context);
+
                 for (uint32_t i = 0; i < mapper.m_buffers.size(); ++i)
                 {
                     auto& buf = mapper.m_buffers[i];
@@ -265,12 +277,21 @@ namespace base
                     // Buffer is not extracted, save it at the end of the file
                     // NOTE: although buffers are not allowed to be bigger than 4GB each the whole file may be bigger than 4GB
                     uint64_t bufferDataOffset = file.pos() - headerOffset;
+                    if (mappedBuffers && (bufferDataOffset & (MAPPED_BUFFER_ALIGNMENT - 1)))
+                    {
+                        const uint8_t padding[MAPPED_BUFFER_ALIGNMENT] = {};
+                        const auto paddingSize = MAPPED_BUFFER_ALIGNMENT - (bufferDataOffset & (MAPPED_BUFFER_ALIGNMENT - 1));
+                        file.write(padding, (uint32_t)paddingSize);
+                        bufferDataOffset += paddingSize;
+                    }
 
                     // compress buffer
                     // TODO: select best compression
                     ASSERT(buf.size != 0);
                     uint64_t compressedSize = 0;
-                    auto compressedData = mem::Compress(mem::CompressionType::LZ4, buf.data.data(), buf.size, compressedSize, POOL_TEMP);
+                    void* compressedData = nullptr;
+                    if (!mappedBuffers)
+                        compressedData = mem::Compress(mem::CompressionType::LZ4, buf.data.data(), buf.size, compressedSize, POOL_TEMP);
 
                     // we expect that the compressed buffer will be at least 90% of the original buffer, otherwise the compression is not worth it
                     auto maximumCompressedSize = (uint64_t)buf.size * 9 / 10;
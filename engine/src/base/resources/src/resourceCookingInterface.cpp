@@ -54,6 +54,14 @@ namespace base
 
         //---
 
+        RTTI_BEGIN_TYPE_CLASS(ResourceMappedBuffersMetadata);
+        RTTI_END_TYPE();
+
+        ResourceMappedBuffersMetadata::ResourceMappedBuffersMetadata()
+        {}
+
+        //---
+
         RTTI_BEGIN_TYPE_CLASS(ResourceDescriptionMetadata);
         RTTI_END_TYPE();
 
@@ -90,6 +98,11 @@ namespace base
 
         RawTextData::~RawTextData()
         {}
+
+        uint64_t RawTextData::calcResourceMemorySize() const
+        {
+            return m_data.length();
+        }
         
         //--
 
@@ -114,6 +127,11 @@ namespace base
         RawBinaryData::~RawBinaryData()
         {}
 
+        uint64_t RawBinaryData::calcResourceMemorySize() const
+        {
+            return m_data.size();
+        }
+
         //--
 
         IResourceCookerInterface::~IResourceCookerInterface()
@@ -10,6 +10,8 @@
 #include "resourceGeneralTextLoader.h"
 #include "resourceLoader.h"
 #include "resourceXMLLoader.h"
+#include "resourceBinaryLoader.h"
+#include "resourceBinaryFileTables.h"
 
 #include "base/containers/include/stringBuilder.h"
 #include "base/containers/include/inplaceArray.h"
@@ -502,6 +504,31 @@ namespace base
 
                 };
 
+                ///--
+
+                enum class FileFormat
+                {
+                    Text,
+                    XML,
+                    Binary, // cooked text resource
+                };
+
+                static FileFormat DetectFileFormat(const char* header, uint32_t headerSize)
+                {
+                    if (headerSize >= 6 && 0 == strncmp(header, "<?xml ", 6))
+                        return FileFormat::XML;
+
+                    uint32_t magic = 0;
+                    if (headerSize >= sizeof(magic))
+                    {
+                        memcpy(&magic, header, sizeof(magic));
+                        if (magic == binary::FileTables::FILE_MAGIC)
+                            return FileFormat::Binary;
+                    }
+
+                    return FileFormat::Text;
+                }
+
             } // prv
             ///--
 
@@ -513,6 +540,25 @@ namespace base
 
             bool TextLoader::extractLoadingDependencies(stream::IBinaryReader& file, bool includeAsync, Array<stream::LoadingDependency>& outDependencies)
             {
+                // peek at the header to determine the format
+                auto initalOffset = file.pos();
+                char header[6];
+                memzero(&header, sizeof(header));
+                file.read(&header, sizeof(header));
+                file.seek(initalOffset);
+
+                const auto format = prv::DetectFileFormat(header, (uint32_t)std::min<uint64_t>(sizeof(header), file.size()));
+                if (format == prv::FileFormat::Binary)
+                {
+                    binary::BinaryLoader binaryLoader;
+                    return binaryLoader.extractLoadingDependencies(file, includeAsync, outDependencies);
+                }
+                else if (format == prv::FileFormat::XML)
+                {
+                    xml::XMLLoader xmlLoader;
+                    return xmlLoader.extractLoadingDependencies(file, includeAsync, outDependencies);
+                }
+
                 // TODO!
                 return false;
             }
@@ -530,13 +576,22 @@ namespace base
                 file.read(&header, sizeof(header));
 
                 // detected XML, send to XML loader
-                if (0 == strncmp(header, "<?xml ", ARRAY_COUNT(header)))
+                const auto format = prv::DetectFileFormat(header, (uint32_t)std::min<uint64_t>(sizeof(header), file.size()));
+                if (format == prv::FileFormat::XML)
                 {
                     file.seek(initalOffset);
                     xml::XMLLoader xmlLoader;
                     return xmlLoader.loadObjects(file, context, result);
                 }
 
+                // cooked text resource, saved in binary format, no parsing needed
+                if (format == prv::FileFormat::Binary)
+                {
+                    file.seek(initalOffset);
+                    binary::BinaryLoader binaryLoader;
+                    return binaryLoader.loadObjects(file, context, result);
+                }
+
                 // create the storage
                 // TODO: Fix abstraction
                 Buffer buffer = Buffer::Create(POOL_TEXT_LOADER, file.size() + 1);
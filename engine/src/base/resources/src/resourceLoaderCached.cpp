@@ -29,16 +29,47 @@ namespace base
         RTTI_BEGIN_TYPE_ABSTRACT_CLASS(IResourceLoaderCached);
         RTTI_END_TYPE();
 
+        void ResourceCacheStats::print(IFormatStream& f) const
+        {
+            f.appendf("{} requests, {} hits, {} loads, {} joined loads, {} contended locks", numRequests, numCacheHits, numLoads, numJoinedLoads, numContendedLocks);
+        }
+
+        //--
+
+        // acquire the lock of the shard, counts the cases we had to spin
+        // NOTE: the counter is updated once we own the lock
+        static INLINE void AcquireShardLock(SpinLock& lock, ResourceCacheStats& stats)
+        {
+            if (!lock.tryAcquire())
+            {
+                lock.acquire();
+                stats.numContendedLocks += 1;
+            }
+        }
+
+        //--
+
         IResourceLoaderCached::~IResourceLoaderCached()
         {
-            for (auto& weakRef : m_loadedResources.values())
+            for (auto& cache : m_shards)
             {
-                auto resource = weakRef.lock();
-                if (resource)
-                    resource->m_loader = nullptr;
+                for (auto& weakRef : cache.m_loadedResources.values())
+                {
+                    auto resource = weakRef.lock();
+                    if (resource)
+                        resource->m_loader = nullptr;
+                }
+
+                cache.m_loadedResources.clear();
             }
+        }
 
-            m_loadedResources.clear();
+        IResourceLoaderCached::CacheShard& IResourceLoaderCached::shard(const ResourceKey& key) const
+        {
+            // use the top bits of the hash, the bottom ones are used by the hash maps inside the shard
+            static_assert(NUM_CACHE_SHARDS == 32, "Shard index is taken from the top 5 bits of the hash");
+            const auto hash = ResourceKey::CalcHash(key);
+            return const_cast<CacheShard&>(m_shards[hash >> 27]);
         }
 
         ResourceHandle IResourceLoaderCached::loadResource(const ResourceKey& key)
@@ -47,30 +78,43 @@ namespace base
             if (key.empty())
                 return nullptr;
 
-            auto scopeLock = CreateLock(m_lock);
+            auto& cache = shard(key);
+            AcquireShardLock(cache.m_lock, cache.m_stats);
+            cache.m_stats.numRequests += 1;
 
             // get the loaded resource, that's the most common case so do it first
-            // NOTE: if this is disabled we will always create the job to process the resource
-            ResourceHandle existingLoadedResource;
+            // NOTE: validation may be costly (ie. checking the files) so it's done outside the lock
             {
                 base::RefWeakPtr<IResource> loadedResourceWeakRef;
-                if (m_loadedResources.find(key, loadedResourceWeakRef))
-                    if (existingLoadedResource = loadedResourceWeakRef.lock())
+                if (cache.m_loadedResources.find(key, loadedResourceWeakRef))
+                {
+                    if (auto existingLoadedResource = loadedResourceWeakRef.lock())
+                    {
+                        cache.m_stats.numCacheHits += 1;
+                        cache.m_lock.release();
+
                         if (validateExistingResource(existingLoadedResource, key))
                             return existingLoadedResource;
+
+                        // resource is no longer valid, we will have to load it again (or join the loading that was started in the mean time)
+                        AcquireShardLock(cache.m_lock, cache.m_stats);
+                        cache.m_stats.numCacheHits -= 1;
+                    }
+                }
             }
 
             // lookup the resource from the loaded list
             // NOTE: there may be different resources loadable from a given file
             {
                 base::RefWeakPtr<LoadingJob> weakJobRef;
-                if (m_loadingJobs.find(key, weakJobRef))
+                if (cache.m_loadingJobs.find(key, weakJobRef))
                 {
                     // get the lock to the loading job
                     auto loadingJob = weakJobRef.lock();
                     if (loadingJob) // there's an active job for this resource key
                     {
-                        scopeLock.release();
+                        cache.m_stats.numJoinedLoads += 1;
+                        cache.m_lock.release();
 
                         // wait for the job to finish
                         Fibers::GetInstance().waitForCounterAndRelease(loadingJob->m_signal);
@@ -85,10 +129,11 @@ namespace base
             auto loadingJob = CreateSharedPtr<LoadingJob>();
             loadingJob->m_key = key;
             loadingJob->m_signal = Fibers::GetInstance().createCounter("LoadingJob", 1);
-            m_loadingJobs[key] = loadingJob;
+            cache.m_loadingJobs[key] = loadingJob;
+            cache.m_stats.numLoads += 1;
 
             // unlock the system so other threads can start other loading jobs or join waiting on the one we just created
-            scopeLock.release();
+            cache.m_lock.release();
 
             // notify anybody interested
             notifyResourceLoading(key);
@@ -99,8 +144,9 @@ namespace base
                 // add for safe keeping so we can return it
                 // NOTE: we may decide to reuse the same resource, but it does not change the logic here
                 {
-                    auto scopeLock2 = CreateLock(m_lock);
-                    m_loadedResources[key] = resource;
+                    AcquireShardLock(cache.m_lock, cache.m_stats);
+                    cache.m_loadedResources[key] = resource;
+                    cache.m_lock.release();
                 }
 
                 // signal the job as finished, this will unblock other threads
@@ -126,19 +172,79 @@ namespace base
             // class and path are required for lookup
             if (!key.empty())
             {
-                auto lock = base::CreateLock(m_lock);
+                auto& cache = shard(key);
+                AcquireShardLock(cache.m_lock, cache.m_stats);
+                cache.m_stats.numRequests += 1;
 
                 // get the loaded resource, that's the most common case so do it first
                 base::RefWeakPtr<IResource> loadedResourceWeakRef;
-                if (m_loadedResources.find(key, loadedResourceWeakRef))
+                if (cache.m_loadedResources.find(key, loadedResourceWeakRef))
+                {
                     if (auto loadedResource = loadedResourceWeakRef.lock())
+                    {
+                        cache.m_stats.numCacheHits += 1;
+                        cache.m_lock.release();
                         return loadedResource;
+                    }
+                }
+
+                cache.m_lock.release();
             }
 
             // not found or loading
             return nullptr;
         }
 
+        ResourceCacheStats IResourceLoaderCached::cacheStats() const
+        {
+            ResourceCacheStats ret;
+
+            for (auto& cache : m_shards)
+            {
+                auto lock = CreateLock(cache.m_lock);
+                ret.numRequests += cache.m_stats.numRequests;
+                ret.numCacheHits += cache.m_stats.numCacheHits;
+                ret.numLoads += cache.m_stats.numLoads;
+                ret.numJoinedLoads += cache.m_stats.numJoinedLoads;
+                ret.numContendedLocks += cache.m_stats.numContendedLocks;
+            }
+
+            return ret;
+        }
+
+        //---
+
+        ResourceHandle IResourceLoaderCached::findLoadedResource(const ResourceKey& key) const
+        {
+            auto& cache = shard(key);
+            auto lock = CreateLock(cache.m_lock);
+
+            base::RefWeakPtr<IResource> loadedResourceWeakRef;
+            if (cache.m_loadedResources.find(key, loadedResourceWeakRef))
+                return loadedResourceWeakRef.lock();
+
+            return nullptr;
+        }
+
+        bool IResourceLoaderCached::isResourceLoading(const ResourceKey& key) const
+        {
+            auto& cache = shard(key);
+            auto lock = CreateLock(cache.m_lock);
+
+            base::RefWeakPtr<LoadingJob> weakJobRef;
+            if (cache.m_loadingJobs.find(key, weakJobRef))
+                return !weakJobRef.expired();
+
+            return false;
+        }
+
+        void IResourceLoaderCached::replaceLoadedResource(const ResourceKey& key, const ResourceHandle& resource)
+        {
+            auto& cache = shard(key);
+            auto lock = CreateLock(cache.m_lock);
+            cache.m_loadedResources[key] = resource;
+        }
+
         //---
 
         bool IResourceLoaderCached::validateExistingResource(const ResourceHandle& res, const ResourceKey& key) const
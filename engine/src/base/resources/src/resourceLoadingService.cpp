@@ -22,12 +22,48 @@ namespace base
         //--
 
         ConfigProperty<uint32_t> cvFileRetentionTime("Loader", "FileRetentionTime", 30);
+        ConfigProperty<uint32_t> cvRetainedMemoryBudget("Loader", "RetainedMemoryBudgetMB", 256);
+        ConfigProperty<uint32_t> cvMaxConcurrentAsyncLoads("Loader", "MaxConcurrentAsyncLoads", 8);
         ConfigProperty<StringBuf> cvDefaultResourceLoaderClass("Loader", "DefaultLoaderClass", "base::cooker::ResourceLoaderCooker");
         ConfigProperty<StringBuf> cvFinalResourceLoaderClass("Loader", "FinalLoaderClass", "base::res::ResourceLoaderFinal");
         LoadingService* GGlobalResourceLoadingService = nullptr;
 
         //--
 
+        // resources that don't report their size are assumed to take at least that much
+        static const uint64_t MIN_RETAINED_FILE_SIZE = 4096;
+
+        static uint64_t RetainedMemoryBudget()
+        {
+            return cvRetainedMemoryBudget.get() * 1024ULL * 1024ULL;
+        }
+
+        //--
+
+        LoadingServiceStats::LoadingServiceStats()
+        {
+            memzero(latencyHistogram, sizeof(latencyHistogram));
+        }
+
+        void LoadingServiceStats::print(IFormatStream& f) const
+        {
+            f.appendf("{} queued, {} loading, {} completed ({} missed deadline), {} retained ({})", 
+                numQueuedRequests, numLoadingRequests, numCompletedRequests, numMissedDeadlines, numRetainedFiles, MemSize(retainedMemory));
+
+            f << ", latency:";
+
+            uint32_t limitMs = 1;
+            for (uint32_t i = 0; i < NUM_LATENCY_BUCKETS; ++i, limitMs *= 4)
+            {
+                if (i < NUM_LATENCY_BUCKETS - 1)
+                    f.appendf(" <{}ms: {}", limitMs, latencyHistogram[i]);
+                else
+                    f.appendf(" more: {}", latencyHistogram[i]);
+            }
+        }
+
+        //--
+
         RTTI_BEGIN_TYPE_CLASS(LoadingService);
             RTTI_METADATA(app::DependsOnServiceMetadata).dependsOn<config::ConfigService>();
         RTTI_END_TYPE();
@@ -98,24 +134,83 @@ namespace base
         {
             if (file)
             {
+                // big files would push everything else out, it's better to load them again if needed
+                const auto size = std::max<uint64_t>(file->calcResourceMemorySize(), MIN_RETAINED_FILE_SIZE);
+                if (size > RetainedMemoryBudget() / 4)
+                    return;
+
                 auto lock = CreateLock(m_retainedFilesLock);
 
-                RetainedFile entry;
-                entry.m_ptr = file;
+                auto& entry = m_retainedFiles[file.get()];
+                if (!entry.m_ptr)
+                {
+                    entry.m_ptr = file;
+                    entry.m_size = size;
+                    m_retainedFilesMemory += size;
+                }
+
+                // move to the most recently used end, the previous use entry will be skipped
+                entry.m_lastUse = ++m_retainedFilesUseCounter;
                 entry.m_expiration = NativeTimePoint::Now() + (double)cvFileRetentionTime.get();
-                m_retainedFiles.push(entry);
+
+                RetainedFileUse use;
+                use.m_ptr = file.get();
+                use.m_lastUse = entry.m_lastUse;
+                m_retainedFilesUses.push(use);
+
+                // files used very often leave a lot of outdated entries
+                if (m_retainedFilesUses.size() > 64 + 4 * m_retainedFiles.size())
+                    compactRetainedFileUses_NoLock();
             }
+        }
 
+        void LoadingService::compactRetainedFileUses_NoLock()
+        {
+            Queue<RetainedFileUse> uses;
+
+            while (!m_retainedFilesUses.empty())
+            {
+                const auto use = m_retainedFilesUses.top();
+                m_retainedFilesUses.pop();
+
+                const auto* entry = m_retainedFiles.find(use.m_ptr);
+                if (entry && entry->m_lastUse == use.m_lastUse)
+                    uses.push(use);
+            }
+
+            m_retainedFilesUses = std::move(uses);
         }
 
         void LoadingService::releaseRetainedFiles()
         {
-            auto lock = CreateLock(m_retainedFilesLock);
-            while (!m_retainedFiles.empty())
+            // released resources are destroyed outside the lock
+            Array<ResourceHandle> releasedFiles;
+
             {
-                if (!m_retainedFiles.top().m_expiration.reached())
-                    break;
-                m_retainedFiles.pop();
+                const auto budget = RetainedMemoryBudget();
+
+                auto lock = CreateLock(m_retainedFilesLock);
+                while (!m_retainedFilesUses.empty())
+                {
+                    const auto use = m_retainedFilesUses.top();
+
+                    // file was used again after this entry was added
+                    auto* entry = m_retainedFiles.find(use.m_ptr);
+                    if (!entry || entry->m_lastUse != use.m_lastUse)
+                    {
+                        m_retainedFilesUses.pop();
+                        continue;
+                    }
+
+                    // the least recently used file is released when it expires or when we are over the budget
+                    if (!entry->m_expiration.reached() && m_retainedFilesMemory <= budget)
+                        break;
+
+                    releasedFiles.pushBack(entry->m_ptr);
+                    m_retainedFilesMemory -= entry->m_size;
+                    m_retainedFiles.remove(use.m_ptr);
+                    m_retainedFilesUses.pop();
+                }
             }
         }
 
@@ -142,7 +237,7 @@ namespace base
 
         //--
 
-        void LoadingService::loadResourceAsync(const ResourceKey& key, const std::function<void(const res::BaseReference&)>& funcLoaded)
+        void LoadingService::loadResourceAsync(const ResourceKey& key, const std::function<void(const res::BaseReference&)>& funcLoaded, float priority, NativeTimePoint deadline)
         {
             // ask the resource loader if it already has the resource
             auto existingResource = m_resourceLoader->acquireLoadedResource(key);
@@ -153,7 +248,7 @@ namespace base
             }
 
             // take the lock
-            auto lock = CreateLock(m_asyncLoadingJobsMapLock);
+            auto lock = CreateLock(m_asyncLoadingLock);
 
             // get the loading job
             {
@@ -164,6 +259,14 @@ namespace base
                     auto validLoadingJob = asyncLoadingJob.lock();
                     if (validLoadingJob)
                     {
+                        // the most urgent of the joined requests decides when the job is started
+                        if (!validLoadingJob->m_started)
+                        {
+                            validLoadingJob->m_priority = std::max(validLoadingJob->m_priority, priority);
+                            if (deadline.valid() && (!validLoadingJob->m_deadline.valid() || deadline < validLoadingJob->m_deadline))
+                                validLoadingJob->m_deadline = deadline;
+                        }
+
                         // wait until the job finishes
                         RunChildFiber("WaitForAsyncResourceLoad") << [validLoadingJob, funcLoaded](FIBER_FUNC)
                         {
@@ -178,21 +281,153 @@ namespace base
 
             // start new async loading job
             auto newAsyncLoadingJob = base::CreateSharedPtr<AsyncLoadingJob>();
+            newAsyncLoadingJob->m_key = key;
             newAsyncLoadingJob->m_signal = Fibers::GetInstance().createCounter("AsyncResourceLoadSignal");
+            newAsyncLoadingJob->m_funcLoaded = funcLoaded;
+            newAsyncLoadingJob->m_priority = priority;
+            newAsyncLoadingJob->m_deadline = deadline;
+            newAsyncLoadingJob->m_requestTime = NativeTimePoint::Now();
+            newAsyncLoadingJob->m_sequence = m_asyncJobSequence++;
             m_asyncLoadingJobsMap[key] = newAsyncLoadingJob;
 
             // notify resource was queued
             //m_depotFileStatusMonitor->notifyFileStatusChanged(res::ResourceKey(path, resClass), FileState::Queued);
 
-            // start loading, NOTE: in the background
-            RunFiber("LoadResourceAsync") << [this, key, newAsyncLoadingJob, funcLoaded](FIBER_FUNC)
+            // queue the job, it will be picked up by one of the streaming fibers
+            m_asyncPendingJobs.pushBack(newAsyncLoadingJob);
+
+            // start another streaming fiber if we are below the limit, NOTE: the loading happens in the background
+            if (m_numStreamingFibers < std::max<uint32_t>(1, cvMaxConcurrentAsyncLoads.get()))
             {
-                auto loadedResource = loadResource(key);
-                funcLoaded(loadedResource);
+                m_numStreamingFibers += 1;
+                RunFiber("ResourceStreaming") << [this](FIBER_FUNC)
+                {
+                    processAsyncLoadingJobs();
+                };
+            }
+        }
+
+        bool LoadingService::updateLoadingPriority(const ResourceKey& key, float priority, NativeTimePoint deadline)
+        {
+            auto lock = CreateLock(m_asyncLoadingLock);
 
-                newAsyncLoadingJob->m_loadedResource = loadedResource;
-                Fibers::GetInstance().signalCounter(newAsyncLoadingJob->m_signal);
+            RefWeakPtr<AsyncLoadingJob> asyncLoadingJob;
+            if (m_asyncLoadingJobsMap.find(key, asyncLoadingJob))
+            {
+                auto validLoadingJob = asyncLoadingJob.lock();
+                if (validLoadingJob && !validLoadingJob->m_started)
+                {
+                    validLoadingJob->m_priority = priority;
+                    validLoadingJob->m_deadline = deadline;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        RefPtr<LoadingService::AsyncLoadingJob> LoadingService::popBestPendingJob_NoLock()
+        {
+            if (m_asyncPendingJobs.empty())
+                return nullptr;
+
+            // higher priority first, then the earlier deadline (no deadline goes last), then the order of requests
+            const auto isMoreUrgent = [](const AsyncLoadingJob& a, const AsyncLoadingJob& b)
+            {
+                if (a.m_priority != b.m_priority)
+                    return a.m_priority > b.m_priority;
+
+                if (a.m_deadline != b.m_deadline)
+                {
+                    if (!a.m_deadline.valid())
+                        return false;
+                    if (!b.m_deadline.valid())
+                        return true;
+                    return a.m_deadline < b.m_deadline;
+                }
+
+                return a.m_sequence < b.m_sequence;
             };
+
+            // NOTE: priorities can change at any time so there's no point in keeping the list sorted, the queue is short anyway
+            uint32_t bestIndex = 0;
+            for (uint32_t i = 1; i < m_asyncPendingJobs.size(); ++i)
+                if (isMoreUrgent(*m_asyncPendingJobs[i], *m_asyncPendingJobs[bestIndex]))
+                    bestIndex = i;
+
+            auto ret = m_asyncPendingJobs[bestIndex];
+            m_asyncPendingJobs.eraseUnordered(bestIndex);
+            return ret;
+        }
+
+        void LoadingService::processAsyncLoadingJobs()
+        {
+            for (;;)
+            {
+                // get the most urgent job, finish the fiber if there's nothing more to do
+                RefPtr<AsyncLoadingJob> job;
+                {
+                    auto lock = CreateLock(m_asyncLoadingLock);
+                    job = popBestPendingJob_NoLock();
+                    if (!job)
+                    {
+                        m_numStreamingFibers -= 1;
+                        return;
+                    }
+
+                    job->m_started = true;
+                    m_asyncStats.numLoadingRequests += 1;
+                }
+
+                auto loadedResource = loadResource(job->m_key);
+                if (job->m_funcLoaded)
+                    job->m_funcLoaded(loadedResource);
+
+                job->m_loadedResource = loadedResource;
+
+                // update stats
+                {
+                    auto lock = CreateLock(m_asyncLoadingLock);
+                    m_asyncStats.numLoadingRequests -= 1;
+                    m_asyncStats.numCompletedRequests += 1;
+
+                    if (job->m_deadline.valid() && job->m_deadline.reached())
+                        m_asyncStats.numMissedDeadlines += 1;
+
+                    const auto latencyMs = job->m_requestTime.timeTillNow().toSeconds() * 1000.0;
+
+                    uint32_t bucket = 0;
+                    double limitMs = 1.0;
+                    while (bucket < LoadingServiceStats::NUM_LATENCY_BUCKETS - 1 && latencyMs >= limitMs)
+                    {
+                        bucket += 1;
+                        limitMs *= 4.0;
+                    }
+
+                    m_asyncStats.latencyHistogram[bucket] += 1;
+                }
+
+                Fibers::GetInstance().signalCounter(job->m_signal);
+            }
+        }
+
+        LoadingServiceStats LoadingService::stats() const
+        {
+            LoadingServiceStats ret;
+
+            {
+                auto lock = CreateLock(m_asyncLoadingLock);
+                ret = m_asyncStats;
+                ret.numQueuedRequests = m_asyncPendingJobs.size();
+            }
+
+            {
+                auto lock = CreateLock(m_retainedFilesLock);
+                ret.numRetainedFiles = m_retainedFiles.size();
+                ret.retainedMemory = m_retainedFilesMemory;
+            }
+
+            return ret;
         }
 
         //--
@@ -210,11 +445,11 @@ namespace base
         return nullptr;
     }
 
-    void LoadResourceAsync(const res::ResourceKey& key, const std::function<void(const res::BaseReference&)>& funcLoaded)
+    void LoadResourceAsync(const res::ResourceKey& key, const std::function<void(const res::BaseReference&)>& funcLoaded, float priority)
     {
         if (res::GGlobalResourceLoadingService)
         {
-            res::GGlobalResourceLoadingService->loadResourceAsync(key, funcLoaded);
+            res::GGlobalResourceLoadingService->loadResourceAsync(key, funcLoaded, priority);
         }
         else
         {
@@ -0,0 +1,335 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/system/include/scopeLock.h"
+#include "base/app/include/configProperty.h"
+
+#include "resource.h"
+#include "resourceLoader.h"
+#include "resourcePath.h"
+#include "resourceLoadingService.h"
+
+DECLARE_TEST_FILE(ResourceLoadingService);
+
+using namespace base;
+
+namespace base
+{
+    namespace res
+    {
+        extern ConfigProperty<uint32_t> cvRetainedMemoryBudget;
+    } // res
+} // base
+
+namespace tests
+{
+    class LoadingServiceTestResource : public res::IResource
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(LoadingServiceTestResource, res::IResource);
+
+    public:
+        uint64_t m_memorySize = 0;
+
+        virtual uint64_t calcResourceMemorySize() const override
+        {
+            return m_memorySize;
+        }
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(LoadingServiceTestResource);
+    RTTI_END_TYPE();
+
+    /// loader that creates empty resources and remembers the order they were requested in
+    class OrderRecordingLoader : public res::IResourceLoader
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(OrderRecordingLoader, res::IResourceLoader);
+
+    public:
+        virtual bool initialize(const app::CommandLine& cmdLine) override
+        {
+            return true;
+        }
+
+        virtual void update() override
+        {
+        }
+
+        virtual res::ResourceHandle acquireLoadedResource(const res::ResourceKey& key) override final
+        {
+            return nullptr;
+        }
+
+        virtual CAN_YIELD res::ResourceHandle loadResource(const res::ResourceKey& key) override final
+        {
+            {
+                auto lock = CreateLock(m_lock);
+                m_loadedPaths.pushBack(StringBuf(key.path().view()));
+            }
+
+            return CreateSharedPtr<LoadingServiceTestResource>();
+        }
+
+        StringBuf loadOrder() const
+        {
+            StringBuilder txt;
+
+            auto lock = CreateLock(m_lock);
+            for (const auto& path : m_loadedPaths)
+            {
+                if (!txt.empty())
+                    txt << ",";
+                txt << path;
+            }
+
+            return txt.toString();
+        }
+
+    private:
+        SpinLock m_lock;
+        Array<StringBuf> m_loadedPaths;
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(OrderRecordingLoader);
+    RTTI_END_TYPE();
+
+    /// gives the test control over when the queued async requests are processed and access to the retained files
+    /// NOTE: not registered in RTTI so it's never created as a real service
+    class LoadingServiceTester : public res::LoadingService
+    {
+    public:
+        LoadingServiceTester(const RefPtr<res::IResourceLoader>& loader)
+        {
+            m_resourceLoader = loader;
+
+            // don't start any streaming fibers, the requests stay in the queue until processQueuedRequests()
+            m_numStreamingFibers = INDEX_MAX;
+        }
+
+        void processQueuedRequests()
+        {
+            m_numStreamingFibers = 1;
+            processAsyncLoadingJobs();
+            m_numStreamingFibers = INDEX_MAX;
+        }
+
+        void retain(const res::ResourceHandle& file)
+        {
+            addRetainedFile(file);
+        }
+
+        void releaseRetained()
+        {
+            releaseRetainedFiles();
+        }
+
+        uint32_t numRetainedFileUses()
+        {
+            auto lock = CreateLock(m_retainedFilesLock);
+            return m_retainedFilesUses.size();
+        }
+    };
+
+    static res::ResourceKey MakeKey(const char* path)
+    {
+        return res::ResourceKey(res::ResourcePath(path), LoadingServiceTestResource::GetStaticClass());
+    }
+
+    static RefPtr<LoadingServiceTestResource> MakeResource(uint64_t memorySize)
+    {
+        auto ret = CreateSharedPtr<LoadingServiceTestResource>();
+        ret->m_memorySize = memorySize;
+        return ret;
+    }
+
+} // tests
+
+struct LoadingServiceFixture : public ::testing::Test
+{
+    RefPtr<tests::OrderRecordingLoader> loader;
+    RefPtr<tests::LoadingServiceTester> service;
+    fibers::WaitCounter callbacksDone;
+
+    virtual void SetUp() override
+    {
+        loader = CreateSharedPtr<tests::OrderRecordingLoader>();
+        service = CreateSharedPtr<tests::LoadingServiceTester>(loader);
+    }
+
+    // queue request, the callback signals the counter prepared with expectCallbacks()
+    void request(const char* path, float priority, NativeTimePoint deadline = NativeTimePoint())
+    {
+        auto signal = callbacksDone;
+        service->loadResourceAsync(tests::MakeKey(path), [signal](const res::BaseReference&) { Fibers::GetInstance().signalCounter(signal); }, priority, deadline);
+    }
+
+    void expectCallbacks(uint32_t count)
+    {
+        callbacksDone = Fibers::GetInstance().createCounter("LoadingServiceTestCallbacks", count);
+    }
+
+    void waitForCallbacks()
+    {
+        Fibers::GetInstance().waitForCounterAndRelease(callbacksDone);
+    }
+};
+
+TEST_F(LoadingServiceFixture, AsyncRequestsStartInPriorityOrder)
+{
+    const auto now = NativeTimePoint::Now();
+
+    expectCallbacks(5);
+    request("a.test", 0.0f);
+    request("b.test", 5.0f);
+    request("c.test", 1.0f);
+    request("d.test", 5.0f, now + 10.0);
+    request("e.test", 5.0f, now + 20.0);
+    EXPECT_EQ(5, service->stats().numQueuedRequests);
+
+    // higher priority first, then the earlier deadline with no deadline last, then the order of requests
+    service->processQueuedRequests();
+    waitForCallbacks();
+
+    EXPECT_STREQ("d.test,e.test,b.test,c.test,a.test", loader->loadOrder().c_str());
+    EXPECT_EQ(0, service->stats().numQueuedRequests);
+    EXPECT_EQ(5, service->stats().numCompletedRequests);
+}
+
+TEST_F(LoadingServiceFixture, SamePriorityStartsInRequestOrder)
+{
+    expectCallbacks(4);
+    request("a.test", 1.0f);
+    request("b.test", 1.0f);
+    request("c.test", 1.0f);
+    request("d.test", 1.0f);
+
+    service->processQueuedRequests();
+    waitForCallbacks();
+
+    EXPECT_STREQ("a.test,b.test,c.test,d.test", loader->loadOrder().c_str());
+}
+
+TEST_F(LoadingServiceFixture, UpdatedPriorityChangesOrder)
+{
+    expectCallbacks(3);
+    request("a.test", 0.0f);
+    request("b.test", 0.0f);
+    request("c.test", 0.0f);
+
+    EXPECT_TRUE(service->updateLoadingPriority(tests::MakeKey("c.test"), 10.0f));
+    EXPECT_TRUE(service->updateLoadingPriority(tests::MakeKey("a.test"), 5.0f));
+    EXPECT_FALSE(service->updateLoadingPriority(tests::MakeKey("missing.test"), 5.0f));
+
+    service->processQueuedRequests();
+    waitForCallbacks();
+
+    EXPECT_STREQ("c.test,a.test,b.test", loader->loadOrder().c_str());
+
+    // started requests can't be changed any more
+    EXPECT_FALSE(service->updateLoadingPriority(tests::MakeKey("b.test"), 5.0f));
+}
+
+TEST_F(LoadingServiceFixture, UpdatedPriorityCanLowerPriority)
+{
+    expectCallbacks(2);
+    request("a.test", 10.0f);
+    request("b.test", 5.0f);
+
+    // unlike joining, the update sets the priority the caller wants
+    EXPECT_TRUE(service->updateLoadingPriority(tests::MakeKey("a.test"), 1.0f));
+
+    service->processQueuedRequests();
+    waitForCallbacks();
+
+    EXPECT_STREQ("b.test,a.test", loader->loadOrder().c_str());
+}
+
+TEST_F(LoadingServiceFixture, JoinedRequestInheritsHigherPriority)
+{
+    const auto now = NativeTimePoint::Now();
+
+    expectCallbacks(6);
+    request("a.test", 0.0f);
+    request("b.test", 1.0f);
+    request("c.test", 1.0f, now + 20.0);
+    request("a.test", 10.0f); // joins, raises the priority
+    request("b.test", 0.0f); // joins, does not lower the priority
+    request("c.test", 1.0f, now + 10.0); // joins, moves the deadline closer
+
+    // joined requests don't create new jobs
+    EXPECT_EQ(3, service->stats().numQueuedRequests);
+
+    service->processQueuedRequests();
+    waitForCallbacks();
+
+    // each file is loaded once, all callbacks are called
+    EXPECT_STREQ("a.test,c.test,b.test", loader->loadOrder().c_str());
+}
+
+TEST_F(LoadingServiceFixture, RetainedFilesEvictedInLRUOrderOverBudget)
+{
+    // files take a fifth of the budget each, six of them don't fit
+    const auto budget = res::cvRetainedMemoryBudget.get() * 1024ULL * 1024ULL;
+    const auto fileSize = budget / 5;
+
+    Array<RefWeakPtr<tests::LoadingServiceTestResource>> files;
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        auto file = tests::MakeResource(fileSize);
+        files.pushBack(file);
+
+        service->retain(file);
+
+        // touch the first file so the second one becomes the least recently used
+        if (i == 3)
+            service->retain(files[0].lock());
+    }
+
+    service->releaseRetained();
+
+    EXPECT_EQ(5, service->stats().numRetainedFiles);
+    EXPECT_EQ(fileSize * 5, service->stats().retainedMemory);
+    EXPECT_FALSE(files[0].expired());
+    EXPECT_TRUE(files[1].expired());
+    for (uint32_t i = 2; i < 6; ++i)
+        EXPECT_FALSE(files[i].expired());
+
+    // within the budget nothing else is released
+    service->releaseRetained();
+    EXPECT_EQ(5, service->stats().numRetainedFiles);
+}
+
+TEST_F(LoadingServiceFixture, BigFilesAreNotRetained)
+{
+    const auto budget = res::cvRetainedMemoryBudget.get() * 1024ULL * 1024ULL;
+
+    auto file = tests::MakeResource(budget / 2);
+    RefWeakPtr<tests::LoadingServiceTestResource> weakFile(file);
+    service->retain(file);
+    file.reset();
+
+    EXPECT_EQ(0, service->stats().numRetainedFiles);
+    EXPECT_TRUE(weakFile.expired());
+}
+
+TEST_F(LoadingServiceFixture, RetainedFileUsesAreCompacted)
+{
+    Array<RefPtr<tests::LoadingServiceTestResource>> files;
+    for (uint32_t i = 0; i < 4; ++i)
+        files.pushBack(tests::MakeResource(0));
+
+    // the same files used over and over again must not grow the use list without limits
+    for (uint32_t i = 0; i < 10000; ++i)
+        service->retain(files[i % files.size()]);
+
+    EXPECT_EQ(4, service->stats().numRetainedFiles);
+    EXPECT_GE(64 + 4 * 4 + 1, service->numRetainedFileUses());
+    EXPECT_LE(4, service->numRetainedFileUses());
+}
@@ -205,6 +205,9 @@ namespace base
                     auto strPtr = (char*)ret + sizeof(ResourcePathData);
                     memcpy(strPtr, buffer, data.length() + 1);
 
+                    // hash of the sanitized path, used by all the hash maps keyed by paths
+                    ret->hash = conformedHash;
+
                     // slice the entries
                     ret->path = StringView<char>(strPtr, strPtr + data.length());
                     ret->dirPart = ret->path.beforeLast("/");
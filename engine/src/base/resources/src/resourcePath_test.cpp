@@ -32,6 +32,21 @@ TEST(ResourcePathTest, PathFileName)
     EXPECT_STREQ("dupa", StringBuf(path.data()->fileStemPart).c_str());
 }
 
+TEST(ResourcePathTest, PathHashMatchesForSamePath)
+{
+    ResourcePath a("engine/textures/lena.png");
+    ResourcePath b("Engine\\Textures\\Lena.png");
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(ResourcePath::CalcHash(a), ResourcePath::CalcHash(b));
+}
+
+TEST(ResourcePathTest, PathHashDiffersForDifferentPaths)
+{
+    ResourcePath a("engine/textures/lena.png");
+    ResourcePath b("engine/textures/lena2.png");
+    EXPECT_NE(ResourcePath::CalcHash(a), ResourcePath::CalcHash(b));
+}
+
 TEST(ResourcePathTest, PathFileNoExtension)
 {
     ResourcePath path("dupa");
@@ -36,6 +36,52 @@ namespace base
     namespace res
     {
 
+        // the file path is known only if the stream reads the file directly, the buffers of the resource may be mapped from it then
+        static ResourceHandle LoadFromStream(StringView<char> contextName, ClassType resourceClass, stream::IBinaryReader& fileStream, IResourceLoader* dependencyLoader, const ObjectPtr parent, const ResourceMountPoint& mountPoint, const io::AbsolutePath* filePath)
+        {
+            // create resource loader
+            auto loader = resourceClass->findMetadataRef<SerializationLoaderMetadata>().createLoader();
+            if (!loader)
+            {
+                TRACE_ERROR("Unable to create resource loader for class '{}'", resourceClass->name());
+                return nullptr;
+            }
+
+            // load the resource
+            stream::LoadingContext context;
+            context.m_parent = parent;
+            context.m_resourceLoader = dependencyLoader;
+            context.m_loadImports = dependencyLoader != nullptr;
+            context.m_contextName = StringBuf(contextName);
+            context.m_baseReferncePath = mountPoint.c_str();
+            if (filePath && resourceClass->findMetadata<ResourceMappedBuffersMetadata>())
+                context.m_mappedBuffersFilePath = *filePath;
+            stream::LoadingResult loadingResult;
+            if (!loader->loadObjects(fileStream, context, loadingResult))
+            {
+                TRACE_ERROR("Unable to deserialize class '{}'", resourceClass->name());
+                return nullptr;
+            }
+
+            // no objects loaded
+            if (loadingResult.m_loadedRootObjects.empty())
+            {
+                TRACE_ERROR("No objects loaded from file");
+                return nullptr;
+            }
+
+            // check class
+            auto loadedResource = rtti_cast<IResource>(loadingResult.m_loadedRootObjects[0]);
+            if (!loadedResource || !loadedResource->is(resourceClass))
+            {
+                TRACE_ERROR("Invalid resource loaded from class '{}'", resourceClass->name());
+                return nullptr;
+            }
+
+            // done, return loaded resource
+            return loadedResource;
+        }
+
         ResourceHandle LoadUncached(const io::AbsolutePath& filePath, IResourceLoader* dependencyLoader, const ObjectPtr parent)
         {
             // get file extension
@@ -76,7 +122,7 @@ namespace base
 
             // load file
             stream::NativeFileReader fileStream(*fileReader);
-            return LoadUncached(filePath.ansi_str().c_str(), resourceClass, fileStream, dependencyLoader, parent);
+            return LoadFromStream(filePath.ansi_str().c_str(), resourceClass, fileStream, dependencyLoader, parent, ResourceMountPoint(), &filePath);
         }
 
         ResourceHandle LoadUncached(StringView<char> contextName, ClassType resourceClass, const void* data, uint64_t dataSize, IResourceLoader* dependencyLoader /*= nullptr*/, ObjectPtr parent /*= nullptr*/, const ResourceMountPoint& mountPoint /*= ResourceMountPoint()*/)
@@ -90,45 +136,7 @@ namespace base
 
         ResourceHandle LoadUncached(StringView<char> contextName, ClassType resourceClass, stream::IBinaryReader& fileStream, IResourceLoader* dependencyLoader, const ObjectPtr parent, const ResourceMountPoint& mountPoint)
         {
-            // create resource loader
-            auto loader = resourceClass->findMetadataRef<SerializationLoaderMetadata>().createLoader();
-            if (!loader)
-            {
-                TRACE_ERROR("Unable to create resource loader for class '{}'", resourceClass->name());
-                return nullptr;
-            }
-
-            // load the resource
-            stream::LoadingContext context;
-            context.m_parent = parent;
-            context.m_resourceLoader = dependencyLoader;
-            context.m_loadImports = dependencyLoader != nullptr;
-            context.m_contextName = StringBuf(contextName);
-            context.m_baseReferncePath = mountPoint.c_str();
-            stream::LoadingResult loadingResult;
-            if (!loader->loadObjects(fileStream, context, loadingResult))
-            {
-                TRACE_ERROR("Unable to deserialize class '{}'", resourceClass->name());
-                return nullptr;
-            }
-
-            // no objects loaded
-            if (loadingResult.m_loadedRootObjects.empty())
-            {
-                TRACE_ERROR("No objects loaded from file");
-                return nullptr;
-            }
-
-            // check class
-            auto loadedResource = rtti_cast<IResource>(loadingResult.m_loadedRootObjects[0]);
-            if (!loadedResource || !loadedResource->is(resourceClass))
-            {
-                TRACE_ERROR("Invalid resource loaded from class '{}'", resourceClass->name());
-                return nullptr;
-            }
-
-            // done, return loaded resource
-            return loadedResource;
+            return LoadFromStream(contextName, resourceClass, fileStream, dependencyLoader, parent, mountPoint, nullptr);
         }
 
         ObjectPtr LoadSelectiveUncached(const io::AbsolutePath& filePath, ClassType selectiveClassLoad)
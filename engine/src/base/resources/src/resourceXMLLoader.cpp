@@ -19,6 +19,7 @@
 #include "base/object/include/memoryReader.h"
 #include "base/xml/include/xmlUtils.h"
 #include "base/xml/include/xmlDocument.h"
+#include "base/xml/include/xmlStreamParser.h"
 #include "base/containers/include/hashSet.h"
 
 namespace base
@@ -36,10 +37,81 @@ namespace base
 
             static mem::PoolID POOL_XML("Engine.XML");
 
+            // collects the resource references without building the XML document
+            class DependencyCollector : public base::xml::IStreamHandler
+            {
+            public:
+                DependencyCollector(bool includeAsync, Array<stream::LoadingDependency>& outDependencies)
+                    : m_includeAsync(includeAsync)
+                    , m_dependencies(outDependencies)
+                {}
+
+                virtual bool onNodeStart(StringView<char> name, const base::xml::StreamAttribute* attributes, uint32_t numAttributes) override final
+                {
+                    if (name != "ref")
+                        return true;
+
+                    StringView<char> path, className, async;
+                    for (uint32_t i = 0; i < numAttributes; ++i)
+                    {
+                        const auto& attr = attributes[i];
+                        if (attr.name == "path")
+                            path = attr.value;
+                        else if (attr.name == "class")
+                            className = attr.value;
+                        else if (attr.name == "async")
+                            async = attr.value;
+                    }
+
+                    const auto isAsync = (async == "true");
+                    if (path.empty() || path == "<none>" || (isAsync && !m_includeAsync))
+                        return true;
+
+                    // get the resource class from the entry, if not found, try to resolve by extension
+                    SpecificClassType<IResource> resourceClass;
+                    if (!className.empty())
+                        resourceClass = RTTI::GetInstance().findClass(StringID(className)).cast<IResource>();
+                    if (!resourceClass)
+                        resourceClass = res::IResource::FindResourceClassByExtension(path.afterFirst("."));
+
+                    if (resourceClass)
+                    {
+                        auto& depInfo = m_dependencies.emplaceBack();
+                        depInfo.async = isAsync;
+                        depInfo.resourceDepotPath = StringBuf(path);
+                        depInfo.resourceClass = resourceClass;
+                    }
+
+                    return true;
+                }
+
+            private:
+                bool m_includeAsync;
+                Array<stream::LoadingDependency>& m_dependencies;
+            };
+
             bool XMLLoader::extractLoadingDependencies(stream::IBinaryReader& file, bool includeAsync, Array<stream::LoadingDependency>& outDependencies)
             {
-                // TODO!
-                return false;
+                PC_SCOPE_LVL1(ExtractLoadingDependenciesXML);
+
+                // load the text, no copies or zero termination is needed as the stream parser works in place
+                const auto dataSize = file.size() - file.pos();
+                auto buffer = Buffer::Create(POOL_XML, dataSize);
+                if (!buffer)
+                {
+                    TRACE_ERROR("Failed to allocate memory for loaded data");
+                    return false;
+                }
+
+                file.read(buffer.data(), dataSize);
+                if (file.isError())
+                {
+                    TRACE_ERROR("Reading XML content form file failed");
+                    return false;
+                }
+
+                DependencyCollector collector(includeAsync, outDependencies);
+                return base::xml::ParseStream(base::xml::ILoadingReporter::GetDefault(), StringView<char>((const char*)buffer.data(), (uint32_t)dataSize), collector);
             }
 
             bool XMLLoader::loadObjects(stream::IBinaryReader& file, const stream::LoadingContext& context, stream::LoadingResult& result)
@@ -48,43 +120,32 @@ namespace base
 
                 // TODO: UTF8 support
 
-                // load the header to determine if this is indeed XML
-                char header[6];
-                memzero(&header, sizeof(header));
-                file.read(&header, sizeof(header));
-
-                // not an xml :)
-                if (0 != strncmp(header, "<?xml ", ARRAY_COUNT(header)))
-                {
-                    TRACE_ERROR("File does not contain XML header");
-                    return false;
-                }
-
-                // create the storage
-                auto dataSize = file.size() + 10;
-                auto buffer = Buffer::Create(POOL_XML, file.size() + 10);
+                // load the whole text, it's parsed in place
+                const auto dataSize = file.size() - file.pos();
+                auto buffer = Buffer::Create(POOL_XML, dataSize);
                 if (!buffer)
                 {
                     TRACE_ERROR("Failed to allocate memory for loaded data");
                     return false;
                 }
 
-                auto bufferPtr = buffer.data();
-
-                // load data
-                memcpy(bufferPtr + 0, header, sizeof(header));
-                file.read(bufferPtr + sizeof(header), dataSize - sizeof(header));
+                file.read(buffer.data(), dataSize);
                 if (file.isError())
                 {
                     TRACE_ERROR("Reading XML content form file failed");
                     return false;
                 }
 
-                // zero terminate the buffer
-                bufferPtr[dataSize] = 0;
+                // not an xml :)
+                const auto text = StringView<char>((const char*)buffer.data(), (uint32_t)dataSize);
+                if (!text.beginsWith("<?xml "))
+                {
+                    TRACE_ERROR("File does not contain XML header");
+                    return false;
+                }
 
                 // load the content
-                auto loader  = prv::LoaderState::LoadContent(buffer, context);
+                auto loader = prv::LoaderState::LoadContent(text, context);
                 if (!loader)
                 {
                     TRACE_ERROR("Internal error loading XML file");
@@ -99,50 +160,6 @@ namespace base
                 return true;
             }
 
-            static void ExtractPathNodes(const base::xml::IDocument& doc, const base::xml::NodeID node, HashSet<res::ResourceKey>& outDependencyPaths)
-            {
-                auto nodeName  = doc.nodeName(node);
-                if (nodeName == "ref")
-                {
-                    auto async  = doc.nodeAttributeOfDefault(node, "async");
-                    if (async != "true")
-                    {
-                        auto path  = doc.nodeAttributeOfDefault(node, "path");
-                        if (!path.empty() && path != "<none>")
-                        {
-                            // get the resource class from the entry
-                            SpecificClassType<IResource> resourceClass = nullptr;
-                            auto className  = doc.nodeAttributeOfDefault(node, "class");
-                            if (!className.empty())
-                                resourceClass = RTTI::GetInstance().findClass(StringID(className)).cast<IResource>();
-
-                            // if not found, try to resolve by extension
-                            if (!resourceClass)
-                            {
-                                auto fileExtension  = path.afterFirst(".");
-                                resourceClass = res::IResource::FindResourceClassByExtension(fileExtension);
-                            }
-
-                            // report dependency
-                            if (resourceClass)
-                            {
-                                res::ResourceKey key(ResourcePath(StringBuf(path)), resourceClass);
-                                outDependencyPaths.insert(key);
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    auto childNode  = doc.nodeFirstChild(node);
-                    while (childNode)
-                    {
-                        ExtractPathNodes(doc, childNode, outDependencyPaths);
-                        childNode = doc.nodeSibling(childNode);
-                    }
-                }
-            }
-
         } // xml
     } // res
 } // base
@@ -9,7 +9,7 @@
 #include "build.h"
 
 #include "base/xml/include/xmlUtils.h"
-#include "base/xml/include/xmlDocument.h"
+#include "base/xml/include/xmlStreamParser.h"
 
 #include "resource.h"
 #include "resourceLoader.h"
@@ -31,6 +31,8 @@ namespace base
                 LoaderState::LoaderState()
                     : m_selectiveLoadingClass(nullptr)
                     , m_selectiveLoadingObjectCreated(false)
+                    , m_content(nullptr)
+                    , m_allObjectsCreated(true)
                 {
                 }
 
@@ -38,36 +40,41 @@ namespace base
                 {
                 }
 
-                LoaderStatePtr LoaderState::LoadContent(const Buffer& xmlData, const stream::LoadingContext& context)
+                LoaderStatePtr LoaderState::LoadContent(StringView<char> xmlText, const stream::LoadingContext& context)
                 {
                     PC_SCOPE_LVL1(LoadContent);
 
-                    // parse document
-                    auto doc = base::xml::LoadDocument(base::xml::ILoadingReporter::GetDefault(), xmlData);
-                    if (!doc)
-                    {
-                        TRACE_ERROR("Failed to parse XML from buffer");
-                        return nullptr;
-                    }
-
-                    // parent all objects to the specified parent object
-                    auto rootObject = context.m_parent;
-
                     auto ret = CreateSharedPtr<LoaderState>();
                     ret->m_objectRegistry = CreateUniquePtr<LoaderObjectRegistry>();
                     ret->m_referenceResolver = CreateUniquePtr<LoaderReferenceResolver>(context.m_resourceLoader);
                     ret->m_selectiveLoadingClass = context.m_selectiveLoadingClass;
                     ret->m_resourceLoader = context.m_resourceLoader;
 
-                    // create the object wrappers, scans the XML
-                    // NOTE: for safety we don't allow to load XMLs with missing object classes         
-                    if (!ret->createObjects(*doc, doc->root(), rootObject, rootObject))
+                    // parent all objects to the specified parent object
+                    ret->m_rootObject = context.m_parent;
+                    ret->m_parentObjects.emplaceBack().object = context.m_parent;
+
+                    // parse the text, the object wrappers are created as the object nodes are found
+                    // NOTE: for safety we don't allow to load XMLs with missing object classes
+                    LoaderContent content(xmlText);
+                    ret->m_content = &content;
+                    if (!base::xml::ParseStream(base::xml::ILoadingReporter::GetDefault(), xmlText, *ret))
+                    {
+                        TRACE_ERROR("Failed to parse XML from buffer");
+                        return nullptr;
+                    }
+
+                    if (!ret->m_allObjectsCreated)
                     {
                         TRACE_WARNING("Some objects were not created during deserialiation");
                     }
 
                     // load the object content
-                    if (!ret->loadObjects(*doc))
+                    const auto valid = ret->loadObjects();
+                    ret->m_content = nullptr;
+                    ret->m_parentObjects.reset();
+
+                    if (!valid)
                     {
                         TRACE_ERROR("Object loading failed");
                         return nullptr;
@@ -77,54 +84,62 @@ namespace base
                     return ret;
                 }
 
-                bool LoaderState::createObjects(const base::xml::IDocument& doc, base::xml::NodeID id, const ObjectPtr& parentObject, const ObjectPtr& rootObject)
+                bool LoaderState::onNodeStart(StringView<char> name, const base::xml::StreamAttribute* attributes, uint32_t numAttributes)
                 {
-                    PC_SCOPE_LVL1(CreateObjects);
-
-                    bool isValid = true;
-
-                    auto childNodeId = doc.nodeFirstChild(id);
-                    while (childNodeId != 0)
+                    auto nodeId = m_content->beginNode(name, attributes, numAttributes);
+                    if (m_content->nodeType(nodeId) != ContentNodeType::Object)
+                        return true;
+
+                    // objects inside the object we failed to create are not created
+                    // NOTE: parent is copied, the stack may grow
+                    const auto parent = m_parentObjects.back();
+                    auto& entry = m_parentObjects.emplaceBack();
+                    entry.canCreateChildren = false;
+                    if (!parent.canCreateChildren)
+                        return true;
+
+                    ObjectPtr createdObject;
+                    if (createSingleObject(nodeId, parent.object, createdObject))
                     {
-                        auto nodeName = doc.nodeName(childNodeId);
-                        if (nodeName == "object")
+                        // create entry in the registry
+                        if (createdObject)
                         {
-                            ObjectPtr createdObject;
-                            if (createSingleObject(doc, childNodeId, parentObject, createdObject))
-                            {
-                                // create entry in the registry
-                                if (createdObject)
-                                {
-                                    auto objectId = doc.nodeAttributeOfDefault(childNodeId, "id");
-                                    bool isRoot = (parentObject == rootObject);
-                                    m_objectRegistry->addObject(createdObject, objectId, childNodeId, isRoot);
-                                }
-
-                                // recurse down the XML but change the parent object so all found sub-objects will be parented to this object
-                                isValid &= createObjects(doc, childNodeId, createdObject, rootObject);
-                            }
-                            else
-                            {
-                                TRACE_ERROR("Failed to create object from node at '{}'", doc.nodeLocationInfo(childNodeId));
-                                isValid = false;
-                            }
-                        }
-                        else
-                        {
-                            // this was not an object node continue exploring
-                            isValid &= createObjects(doc, childNodeId, parentObject, rootObject);
+                            bool isRoot = (parent.object == m_rootObject);
+                            m_objectRegistry->addObject(createdObject, m_content->nodeObjectID(nodeId), nodeId, isRoot);
                         }
 
-                        childNodeId = doc.nodeSibling(childNodeId);
+                        // all found sub-objects will be parented to this object
+                        entry.object = createdObject;
+                        entry.canCreateChildren = true;
+                    }
+                    else
+                    {
+                        TRACE_ERROR("Failed to create object from node at '{}'", m_content->nodeLocationInfo(nodeId));
+                        m_allObjectsCreated = false;
                     }
 
-                    return isValid;
+                    return true;
+                }
+
+                bool LoaderState::onNodeValue(StringView<char> value)
+                {
+                    m_content->nodeValue(value);
+                    return true;
+                }
+
+                bool LoaderState::onNodeEnd(StringView<char> name)
+                {
+                    if (name == "object")
+                        m_parentObjects.popBack();
+
+                    m_content->endNode();
+                    return true;
                 }
 
-                bool LoaderState::createSingleObject(const base::xml::IDocument& doc, base::xml::NodeID objectNodeID, const ObjectPtr& parentObject, ObjectPtr& outCreatedObject)
+                bool LoaderState::createSingleObject(ContentNodeID objectNodeID, const ObjectPtr& parentObject, ObjectPtr& outCreatedObject)
                 {
                     // the "class" filed must be specified for valid objects
-                    auto className = doc.nodeAttributeOfDefault(objectNodeID, "class");
+                    auto className = m_content->nodeKey(objectNodeID);
                     if (className.empty())
                     {
                         TRACE_ERROR("Object node has no class name specified");
@@ -173,7 +188,7 @@ namespace base
                     return true;
                 }
 
-                bool LoaderState::loadObjects(const base::xml::IDocument& doc)
+                bool LoaderState::loadObjects()
                 {
                     PC_SCOPE_LVL1(LoadObjects);
 
@@ -183,22 +198,22 @@ namespace base
                     {
                         if (obj.object)
                         {
-                            isValid &= loadSingleObject(doc, obj.dataNodeID, obj.object);
+                            isValid &= loadSingleObject(obj.dataNodeID, obj.object);
                         }
                     }
 
                     return isValid;
                 }
 
-                bool LoaderState::loadSingleObject(const base::xml::IDocument& doc, base::xml::NodeID objectNodeID, const ObjectPtr& objectPtr)
+                bool LoaderState::loadSingleObject(ContentNodeID objectNodeID, const ObjectPtr& objectPtr)
                 {
-                    prv::TextReader reader(doc, objectNodeID, *m_objectRegistry, *m_referenceResolver);
+                    prv::TextReader reader(*m_content, objectNodeID, *m_objectRegistry, *m_referenceResolver);
 
                     // call internal loading method
                     if (!objectPtr->onReadText(reader))
                     {
                         TRACE_ERROR("Internal loading failed for object '{}' at '{}'",
-                            objectPtr->cls()->name().c_str(), doc.nodeLocationInfo(objectNodeID).c_str());
+                            objectPtr->cls()->name().c_str(), m_content->nodeLocationInfo(objectNodeID).c_str());
                         return false;
                     }
 
@@ -11,9 +11,11 @@
 #include "base/object/include/streamTextReader.h"
 #include "base/object/include/serializationLoader.h"
 #include "base/object/include/streamTextReader.h"
-#include "base/xml/include/public.h"
+#include "base/xml/include/xmlStreamParser.h"
 #include "base/containers/include/hashMap.h"
 #include "base/containers/include/array.h"
+#include "base/containers/include/inplaceArray.h"
+#include "resourceXMLRuntimeLoaderContent.h"
 
 namespace base
 {
@@ -30,15 +32,17 @@ namespace base
                 typedef RefPtr<LoaderState> LoaderStatePtr;
 
                 /// instance of the loader
-                class LoaderState : public IReferencable
+                /// the XML is parsed in one streaming pass, objects are created as soon as their nodes are opened
+                /// NOTE: object content is read after the whole text is parsed since the references may point to objects defined later in the file
+                class LoaderState : public IReferencable, public base::xml::IStreamHandler
                 {
                 public:
                     LoaderState();
                     virtual ~LoaderState();
 
-                    // load objects from given XML data buffer
-                    // the buffer is processed and objects are created
-                    static LoaderStatePtr LoadContent(const Buffer& xmlData, const stream::LoadingContext& context);
+                    // load objects from given XML text
+                    // the text is parsed, objects are created and their content is loaded, the text is not referenced after the call
+                    static LoaderStatePtr LoadContent(StringView<char> xmlText, const stream::LoadingContext& context);
 
                     /// post load all objects
                     void postLoad();
@@ -54,17 +58,31 @@ namespace base
                     res::IResourceLoader* m_resourceLoader;
                     bool m_selectiveLoadingObjectCreated;
 
-                    // create the actual objects and map the ones with IDs to the map
-                    bool createObjects(const base::xml::IDocument& doc, base::xml::NodeID id, const ObjectPtr& parentObject, const ObjectPtr& rootObject);
+                    // state of the parsing, valid only in LoadContent
+                    struct ParentObject
+                    {
+                        ObjectPtr object; // may be null if object was skipped by selective loading
+                        bool canCreateChildren = true; // false if the object failed to be created
+                    };
+
+                    LoaderContent* m_content;
+                    ObjectPtr m_rootObject;
+                    InplaceArray<ParentObject, 16> m_parentObjects;
+                    bool m_allObjectsCreated;
+
+                    // IStreamHandler - record the nodes and create the objects
+                    virtual bool onNodeStart(StringView<char> name, const base::xml::StreamAttribute* attributes, uint32_t numAttributes) override final;
+                    virtual bool onNodeValue(StringView<char> value) override final;
+                    virtual bool onNodeEnd(StringView<char> name) override final;
 
                     // create actual object from node definition
-                    bool createSingleObject(const base::xml::IDocument& doc, base::xml::NodeID objectNodeID, const ObjectPtr& parentObject, ObjectPtr& outCreatedObject);
+                    bool createSingleObject(ContentNodeID objectNodeID, const ObjectPtr& parentObject, ObjectPtr& outCreatedObject);
 
                     // load object content, use the provided resource loader to resolve dependencies
-                    bool loadObjects(const base::xml::IDocument& doc);
+                    bool loadObjects();
 
                     // load particular object
-                    bool loadSingleObject(const base::xml::IDocument& doc, base::xml::NodeID objectNodeID, const ObjectPtr& objectPtr);
+                    bool loadSingleObject(ContentNodeID objectNodeID, const ObjectPtr& objectPtr);
 
                 };
 
@@ -0,0 +1,162 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: resource\serialization\xml\loader #]
+***/
+
+#include "build.h"
+#include "resourceXMLRuntimeLoaderContent.h"
+
+namespace base
+{
+    namespace res
+    {
+        namespace xml
+        {
+            namespace prv
+            {
+
+                LoaderContent::LoaderContent(StringView<char> text)
+                    : m_text(text)
+                    , m_mem(POOL_RESOURCES)
+                {
+                    // the nodes are referenced by index, the first entry is the virtual parent of the root node
+                    m_nodes.reserve(1 + text.length() / 64);
+                    m_nodes.emplaceBack();
+                    m_openNodes.emplaceBack();
+                }
+
+                LoaderContent::~LoaderContent()
+                {}
+
+                StringView<char> LoaderContent::store(StringView<char> txt)
+                {
+                    // values with entities are decoded to parser's scratch memory that is not kept
+                    if (txt.data() >= m_text.data() && txt.data() + txt.length() <= m_text.data() + m_text.length())
+                        return txt;
+
+                    return StringView<char>(m_mem.strcpy(txt.data(), txt.length()), txt.length());
+                }
+
+                ContentNodeID LoaderContent::beginNode(StringView<char> name, const base::xml::StreamAttribute* attributes, uint32_t numAttributes)
+                {
+                    const auto id = (ContentNodeID)m_nodes.size();
+
+                    auto& node = m_nodes.emplaceBack();
+                    node.name = name;
+
+                    StringView<char> keyAttribute;
+                    if (name == "property")
+                    {
+                        node.type = ContentNodeType::Property;
+                        keyAttribute = "name";
+                    }
+                    else if (name == "element")
+                    {
+                        node.type = ContentNodeType::Element;
+                    }
+                    else if (name == "object")
+                    {
+                        node.type = ContentNodeType::Object;
+                        keyAttribute = "class";
+                    }
+                    else if (name == "ref")
+                    {
+                        node.type = ContentNodeType::Ref;
+                        keyAttribute = "path";
+                    }
+
+                    if (node.type != ContentNodeType::Other)
+                    {
+                        for (uint32_t i = 0; i < numAttributes; ++i)
+                        {
+                            const auto& attr = attributes[i];
+                            if (attr.name == "id")
+                                node.objectId = store(attr.value);
+                            else if (!keyAttribute.empty() && attr.name == keyAttribute)
+                                node.key = store(attr.value);
+                        }
+                    }
+
+                    // link with the previous sibling
+                    auto& parent = m_openNodes.back();
+                    if (parent.lastChild)
+                        m_nodes[parent.lastChild].nextSibling = id;
+                    else
+                        m_nodes[parent.id].firstChild = id;
+                    parent.lastChild = id;
+
+                    auto& open = m_openNodes.emplaceBack();
+                    open.id = id;
+                    return id;
+                }
+
+                void LoaderContent::nodeValue(StringView<char> value)
+                {
+                    auto& node = m_nodes[m_openNodes.back().id];
+                    if (node.value.empty())
+                        node.value = store(value);
+                }
+
+                void LoaderContent::endNode()
+                {
+                    ASSERT_EX(m_openNodes.size() > 1, "Node stack corruption");
+                    m_openNodes.popBack();
+                }
+
+                ContentNodeID LoaderContent::nodeFirstChild(ContentNodeID id) const
+                {
+                    return id ? m_nodes[id].firstChild : 0;
+                }
+
+                ContentNodeID LoaderContent::nodeFirstChild(ContentNodeID id, ContentNodeType type) const
+                {
+                    auto childId = nodeFirstChild(id);
+                    while (childId && m_nodes[childId].type != type)
+                        childId = m_nodes[childId].nextSibling;
+                    return childId;
+                }
+
+                ContentNodeID LoaderContent::nodeSibling(ContentNodeID id) const
+                {
+                    if (!id)
+                        return 0;
+
+                    const auto type = m_nodes[id].type;
+                    auto siblingId = m_nodes[id].nextSibling;
+                    while (siblingId && m_nodes[siblingId].type != type)
+                        siblingId = m_nodes[siblingId].nextSibling;
+                    return siblingId;
+                }
+
+                StringBuf LoaderContent::nodeLocationInfo(ContentNodeID id) const
+                {
+                    if (!id)
+                        return StringBuf("unknown");
+
+                    // node names always point into the text
+                    const auto* pos = m_nodes[id].name.data();
+                    uint32_t lineNumber = 1;
+                    uint32_t position = 1;
+                    for (auto ptr = m_text.data(); ptr < pos; ++ptr)
+                    {
+                        if (*ptr == '\n')
+                        {
+                            lineNumber += 1;
+                            position = 1;
+                        }
+                        else
+                        {
+                            position += 1;
+                        }
+                    }
+
+                    return TempString("line {}, pos {}", lineNumber, position);
+                }
+
+            } // prv
+        } // xml
+    } // res
+} // base
@@ -0,0 +1,110 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: resource\serialization\xml\loader #]
+***/
+
+#pragma once
+
+#include "base/xml/include/xmlStreamParser.h"
+#include "base/containers/include/array.h"
+#include "base/containers/include/inplaceArray.h"
+#include "base/memory/include/linearAllocator.h"
+
+namespace base
+{
+    namespace res
+    {
+        namespace xml
+        {
+            namespace prv
+            {
+
+                /// index of the node in the loaded content, 0 is invalid
+                typedef uint32_t ContentNodeID;
+
+                /// type of the node, only the nodes the loader cares about are distinguished
+                enum class ContentNodeType : uint8_t
+                {
+                    Other,
+                    Object, // <object class="" id="">
+                    Property, // <property name="">
+                    Element, // <element>
+                    Ref, // <ref id="" path="">
+                };
+
+                /// flat list of nodes recorded while streaming the XML, only the attributes used by the loader are kept
+                /// NOTE: this is not a document, the strings point directly into the XML text and only the values with entities are copied
+                class LoaderContent : public NoCopy
+                {
+                public:
+                    LoaderContent(StringView<char> text);
+                    ~LoaderContent();
+
+                    //--
+
+                    /// record start of node
+                    ContentNodeID beginNode(StringView<char> name, const base::xml::StreamAttribute* attributes, uint32_t numAttributes);
+
+                    /// record value of the current node, only the first value is kept
+                    void nodeValue(StringView<char> value);
+
+                    /// record end of the current node
+                    void endNode();
+
+                    //--
+
+                    INLINE ContentNodeType nodeType(ContentNodeID id) const { return m_nodes[id].type; }
+                    INLINE StringView<char> nodeName(ContentNodeID id) const { return m_nodes[id].name; }
+                    INLINE StringView<char> nodeValue(ContentNodeID id) const { return m_nodes[id].value; }
+
+                    // "class" of objects, "name" of properties, "path" of refs
+                    INLINE StringView<char> nodeKey(ContentNodeID id) const { return m_nodes[id].key; }
+
+                    // "id" of objects and refs
+                    INLINE StringView<char> nodeObjectID(ContentNodeID id) const { return m_nodes[id].objectId; }
+
+                    // first child node of any type or of given type
+                    ContentNodeID nodeFirstChild(ContentNodeID id) const;
+                    ContentNodeID nodeFirstChild(ContentNodeID id, ContentNodeType type) const;
+
+                    // next sibling node of the same type
+                    ContentNodeID nodeSibling(ContentNodeID id) const;
+
+                    // get the location in the text, the line number is computed only when needed
+                    StringBuf nodeLocationInfo(ContentNodeID id) const;
+
+                private:
+                    struct Node
+                    {
+                        ContentNodeType type = ContentNodeType::Other;
+                        StringView<char> name;
+                        StringView<char> key;
+                        StringView<char> objectId;
+                        StringView<char> value;
+                        ContentNodeID firstChild = 0;
+                        ContentNodeID nextSibling = 0;
+                    };
+
+                    struct OpenNode
+                    {
+                        ContentNodeID id = 0;
+                        ContentNodeID lastChild = 0;
+                    };
+
+                    StringView<char> m_text;
+
+                    Array<Node> m_nodes;
+                    InplaceArray<OpenNode, 32> m_openNodes;
+
+                    mem::LinearAllocator m_mem;
+
+                    StringView<char> store(StringView<char> txt);
+                };
+
+            } // prv
+        } // xml
+    } // res
+} // base
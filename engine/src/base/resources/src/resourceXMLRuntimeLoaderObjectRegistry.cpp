@@ -18,7 +18,7 @@ namespace base
             namespace prv
             {
 
-                void LoaderObjectRegistry::addObject(const ObjectPtr& object, StringView<char> id, base::xml::NodeID nodeID, bool isRoot)
+                void LoaderObjectRegistry::addObject(const ObjectPtr& object, StringView<char> id, ContentNodeID nodeID, bool isRoot)
                 {
                     auto index = m_objects.size();
 
@@ -65,7 +65,7 @@ namespace base
                     return false;
                 }
 
-                bool LoaderObjectRegistry::resolveByNodeID(const base::xml::NodeID id, ObjectPtr& outObject) const
+                bool LoaderObjectRegistry::resolveByNodeID(const ContentNodeID id, ObjectPtr& outObject) const
                 {
                     uint32_t index = 0;
                     if (m_objectNodeMap.find(id, index))
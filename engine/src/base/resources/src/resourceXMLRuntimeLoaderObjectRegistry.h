@@ -8,7 +8,7 @@
 
 #pragma once
 
-#include "base/xml/include/public.h"
+#include "resourceXMLRuntimeLoaderContent.h"
 #include "base/containers/include/hashMap.h"
 #include "base/containers/include/array.h"
 
@@ -25,19 +25,19 @@ namespace base
                 class LoaderObjectRegistry
                 {
                 public:
-                    void addObject(const ObjectPtr& object, StringView<char> id, base::xml::NodeID nodeID, bool isRoot);
+                    void addObject(const ObjectPtr& object, StringView<char> id, ContentNodeID nodeID, bool isRoot);
 
                     void allObjects(Array< ObjectPtr >& outObjects) const;
                     void rootObjects(Array< ObjectPtr >& outObjects) const;
 
                     bool resolveByObjectID(StringView<char> id, ObjectPtr& outObject) const;
-                    bool resolveByNodeID(const base::xml::NodeID id, ObjectPtr& outObject) const;
+                    bool resolveByNodeID(const ContentNodeID id, ObjectPtr& outObject) const;
 
                     struct Object
                     {
                         StringView<char> id; // only if known
                         ClassType classType = nullptr; // resolved object class
-                        base::xml::NodeID dataNodeID; // source node with the object definition
+                        ContentNodeID dataNodeID; // source node with the object definition
                         ObjectPtr object; // created object
                         bool root = false; // is this a root object
                     };
@@ -54,7 +54,7 @@ namespace base
                     typedef HashMap< StringView<char>, uint32_t > TObjectMap;
                     TObjectMap m_objectIdMap;
 
-                    typedef HashMap< base::xml::NodeID, uint32_t > TObjectNodeMap;
+                    typedef HashMap< ContentNodeID, uint32_t > TObjectNodeMap;
                     TObjectNodeMap m_objectNodeMap;
 
                 };
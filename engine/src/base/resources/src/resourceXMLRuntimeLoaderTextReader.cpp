@@ -12,7 +12,7 @@
 #include "resourceXMLRuntimeLoaderReferenceResolver.h"
 #include "resourceXMLRuntimeLoaderTextReader.h"
 
-#include "base/xml/include/xmlDocument.h"
+#include "resourceXMLRuntimeLoaderContent.h"
 
 namespace base
 {
@@ -23,13 +23,13 @@ namespace base
             namespace prv
             {
 
-                TextReader::TextReader(const base::xml::IDocument& doc, base::xml::NodeID objectNodeID, const LoaderObjectRegistry& objectRegistry, LoaderReferenceResolver& referenceResolver)
+                TextReader::TextReader(const LoaderContent& content, ContentNodeID objectNodeID, const LoaderObjectRegistry& objectRegistry, LoaderReferenceResolver& referenceResolver)
                     : m_objectRegistry(&objectRegistry)
                     , m_referenceResolver(&referenceResolver)
-                    , m_doc(&doc)
+                    , m_content(&content)
                 {
                     Node node(objectNodeID, NodeType::Object);
-                    node.nextPropertyId = m_doc->nodeFirstChild(objectNodeID, "property");
+                    node.nextPropertyId = m_content->nodeFirstChild(objectNodeID, ContentNodeType::Property);
                     m_nodeStack.pushBack(node);
                 }
 
@@ -40,11 +40,11 @@ namespace base
 
                 //---
                 
-                void TextReader::pushElement(const base::xml::NodeID itemId, NodeType type)
+                void TextReader::pushElement(const ContentNodeID itemId, NodeType type)
                 {
                     m_nodeStack.pushBack(Node(itemId, type));
-                    m_nodeStack.back().nextPropertyId = m_doc->nodeFirstChild(itemId, "property");
-                    m_nodeStack.back().nextId = m_doc->nodeFirstChild(itemId, "element");
+                    m_nodeStack.back().nextPropertyId = m_content->nodeFirstChild(itemId, ContentNodeType::Property);
+                    m_nodeStack.back().nextId = m_content->nodeFirstChild(itemId, ContentNodeType::Element);
                 }
 
                 bool TextReader::hasErrors() const
@@ -63,7 +63,7 @@ namespace base
 
                     // get next ID for the array element
                     auto itemId = topNode.nextId;
-                    topNode.nextId = m_doc->nodeSibling(itemId, "element");
+                    topNode.nextId = m_content->nodeSibling(itemId);
 
                     // push new context
                     pushElement(itemId, NodeType::ArrayElement);
@@ -87,10 +87,10 @@ namespace base
 
                     // get next ID for the array element
                     auto itemId = topNode.nextPropertyId;
-                    topNode.nextPropertyId = m_doc->nodeSibling(topNode.nextPropertyId, "property");
+                    topNode.nextPropertyId = m_content->nodeSibling(topNode.nextPropertyId);
 
                     // get the name of the property
-                    outPropertyName = m_doc->nodeAttributeOfDefault(itemId, "name");
+                    outPropertyName = m_content->nodeKey(itemId);
 
                     // push new context
                     pushElement(itemId, NodeType::Property);
@@ -114,7 +114,7 @@ namespace base
                     }
 
                     // return the inner value
-                    outValue = m_doc->nodeValue(topNode.id);
+                    outValue = m_content->nodeValue(topNode.id);
                     return true;
                 }
 
@@ -124,22 +124,22 @@ namespace base
                     auto& topNode = this->topNode();
 
                     // null reference
-                    if (m_doc->nodeValue(topNode.id) == "null")
+                    if (m_content->nodeValue(topNode.id) == "null")
                     {
                         outValue = nullptr;
                         return true;
                     }
 
                     // we expect the "ref" or "object" node
-                    auto refNodeId = m_doc->nodeFirstChild(topNode.id);
+                    auto refNodeId = m_content->nodeFirstChild(topNode.id);
                     if (refNodeId == 0)
                     {
-                        TRACE_ERROR("expected ref or object in value at {}", m_doc->nodeLocationInfo(topNode.id));
+                        TRACE_ERROR("expected ref or object in value at {}", m_content->nodeLocationInfo(topNode.id));
                         return false;
                     }
 
                     // resource reference ?
-                    if (!m_doc->nodeAttributeOfDefault(refNodeId, "path").empty())
+                    if (m_content->nodeType(refNodeId) == ContentNodeType::Ref && !m_content->nodeKey(refNodeId).empty())
                     {
                         outValue = nullptr;
                         return false;
@@ -150,11 +150,11 @@ namespace base
                         return true;
 
                     // get the ID of the referenced object
-                    auto refId = m_doc->nodeAttributeOfDefault(refNodeId, "id");
+                    auto refId = m_content->nodeObjectID(refNodeId);
                     if (refId.empty())
                     {
                         TRACE_ERROR("expected ID for the ref node '{}' at {}",
-                            m_doc->nodeName(refNodeId), m_doc->nodeLocationInfo(refNodeId));
+                            m_content->nodeName(refNodeId), m_content->nodeLocationInfo(refNodeId));
                         return false;
                     }
 
@@ -164,7 +164,7 @@ namespace base
 
                     // unresolved object
                     TRACE_WARNING("Unresolved object '{}' in '{}'",
-                        refId, m_doc->nodeLocationInfo(refNodeId));
+                        refId, m_content->nodeLocationInfo(refNodeId));
 
                     outValue = nullptr;
                     return true;
@@ -186,7 +186,7 @@ namespace base
                     }
 
                     // null reference
-                    auto value = m_doc->nodeValue(topNode.id);
+                    auto value = m_content->nodeValue(topNode.id);
                     if (value == "null")
                     {
                         outPath = "";
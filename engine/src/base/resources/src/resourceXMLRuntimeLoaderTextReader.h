@@ -10,6 +10,7 @@
 
 #include "base/object/include/streamTextReader.h"
 #include "base/containers/include/inplaceArray.h"
+#include "resourceXMLRuntimeLoaderContent.h"
 
 namespace base
 {
@@ -27,14 +28,14 @@ namespace base
                 class TextReader : public stream::ITextReader
                 {
                 public:
-                    TextReader(const base::xml::IDocument& doc, base::xml::NodeID objectNode, const LoaderObjectRegistry& objectRegistry, LoaderReferenceResolver& referenceResolver);
+                    TextReader(const LoaderContent& content, ContentNodeID objectNode, const LoaderObjectRegistry& objectRegistry, LoaderReferenceResolver& referenceResolver);
                     virtual ~TextReader();
 
                 private:
                     const LoaderObjectRegistry* m_objectRegistry;
                     LoaderReferenceResolver* m_referenceResolver;
 
-                    const base::xml::IDocument* m_doc;
+                    const LoaderContent* m_content;
 
                     enum class NodeType
                     {
@@ -45,13 +46,13 @@ namespace base
 
                     struct Node
                     {
-                        base::xml::NodeID id;
+                        ContentNodeID id;
                         NodeType type = NodeType::Object;
 
-                        base::xml::NodeID nextId = 0;
-                        base::xml::NodeID nextPropertyId = 0;
+                        ContentNodeID nextId = 0;
+                        ContentNodeID nextPropertyId = 0;
 
-                        INLINE Node(base::xml::NodeID id, NodeType type)
+                        INLINE Node(ContentNodeID id, NodeType type)
                             : id(id), type(type)
                         {}
                     };
@@ -78,7 +79,7 @@ namespace base
                     virtual bool readValue(Buffer& outData) override final;
                     virtual bool readValue(stream::ResourceLoadingPolicy policy, StringBuf& outPath, ClassType& outClass, ObjectPtr& outObject) override final;
 
-                    void pushElement(const base::xml::NodeID nodeId, NodeType type);
+                    void pushElement(const ContentNodeID nodeId, NodeType type);
                 };
 
             } // prv
@@ -16,6 +16,7 @@
 #include "base/object/include/serializationLoader.h"
 #include "base/object/include/streamBinaryVersion.h"
 #include "base/reflection/include/reflectionMacros.h"
+#include "base/containers/include/stringBuilder.h"
 #include "resourceBinaryFileTables.h"
 #include "resourceBinarySaver.h"
 #include "resourceBinaryLoader.h"
@@ -54,6 +55,48 @@ namespace tests
     RTTI_PROPERTY(m_bool);
     RTTI_PROPERTY(m_child);
     RTTI_END_TYPE();
+
+    // large collection of objects, similar to a world layer
+    class TestLayer : public IObject
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(TestLayer, IObject);
+
+    public:
+        Array<RefPtr<TestObject>> m_objects;
+
+        static RefPtr<TestLayer> Create(uint32_t numObjects)
+        {
+            auto layer = CreateSharedPtr<TestLayer>();
+            for (uint32_t i = 0; i < numObjects; ++i)
+            {
+                auto object = CreateSharedPtr<TestObject>();
+                object->parent(layer);
+                object->m_int = i;
+                object->m_float = i * 0.25f;
+                object->m_bool = (i & 1) != 0;
+                object->m_text = TempString("Object{}", i);
+                layer->m_objects.pushBack(object);
+            }
+
+            return layer;
+        }
+    };
+
+    RTTI_BEGIN_TYPE_CLASS(TestLayer);
+    RTTI_PROPERTY(m_objects);
+    RTTI_END_TYPE();
+
+    static ObjectPtr LoadWithTextLoader(const void* data, uint64_t size)
+    {
+        stream::MemoryReader reader(data, size);
+        stream::LoadingContext loadContext;
+        stream::LoadingResult loadResult;
+        res::text::TextLoader loader;
+        if (!loader.loadObjects(reader, loadContext, loadResult) || loadResult.m_loadedRootObjects.empty())
+            return nullptr;
+
+        return loadResult.m_loadedRootObjects[0];
+    }
 }
 
 TEST(Serialization, SaveSimple)
@@ -379,5 +422,73 @@ TEST(Serialization, SaveSimpleTextDeepNotReachable)
     auto txt  = (const char*)writer.data();
 }
 
+TEST(Serialization, TextLoaderLoadsCookedBinary)
+{
+    auto layer = tests::TestLayer::Create(10);
 
+    // cooked text resources are saved in binary format
+    stream::MemoryWriter writer;
+    stream::SavingContext saveContext(layer);
+    res::binary::BinarySaver saver;
+    ASSERT_TRUE(saver.saveObjects(writer, saveContext)) << "Serialization failed";
 
+    // the text loader should detect the binary format on its own
+    auto loadedLayer = rtti_cast<tests::TestLayer>(tests::LoadWithTextLoader(writer.data(), writer.size()));
+    ASSERT_TRUE(!!loadedLayer) << "Loading cooked data with text loader failed";
+    ASSERT_EQ(10, loadedLayer->m_objects.size());
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(!!loadedLayer->m_objects[i]);
+        EXPECT_EQ(layer->m_objects[i]->m_int, loadedLayer->m_objects[i]->m_int);
+        EXPECT_EQ(layer->m_objects[i]->m_float, loadedLayer->m_objects[i]->m_float);
+        EXPECT_EQ(layer->m_objects[i]->m_bool, loadedLayer->m_objects[i]->m_bool);
+        EXPECT_EQ(layer->m_objects[i]->m_text, loadedLayer->m_objects[i]->m_text);
+    }
+}
+
+TEST(Serialization, TextLoaderLoadsXML)
+{
+    // the object is referenced before it's defined, inlined object is referenced back by ID
+    StringBuilder txt;
+    txt << "<?xml version=\"1.0\" standalone=\"yes\"?><document>\n";
+    txt.appendf("<object class=\"{}\">\n", tests::TestLayer::GetStaticClass()->name());
+    txt << "<property name=\"objects\">\n";
+    txt << "<element><ref id=\"[0][1]\" /></element>\n";
+    txt.appendf("<element><object class=\"{}\" id=\"[0][2]\">\n", tests::TestObject::GetStaticClass()->name());
+    txt << "<property name=\"text\">Tom &amp; Jerry</property>\n";
+    txt << "<property name=\"int\">2</property>\n";
+    txt << "<property name=\"child\">null</property>\n";
+    txt << "</object></element>\n";
+    txt << "</property>\n";
+    txt.appendf("<object class=\"{}\" id=\"[0][1]\">\n", tests::TestObject::GetStaticClass()->name());
+    txt << "<property name=\"text\"><![CDATA[<first>]]></property>\n";
+    txt << "<property name=\"int\">1</property>\n";
+    txt << "<property name=\"float\">0.5</property>\n";
+    txt << "<property name=\"bool\">true</property>\n";
+    txt << "<property name=\"child\"><ref id=\"[0][2]\" /></property>\n";
+    txt << "</object>\n";
+    txt << "</object>\n";
+    txt << "</document>\n";
+
+    auto loadedLayer = rtti_cast<tests::TestLayer>(tests::LoadWithTextLoader(txt.c_str(), txt.length()));
+    ASSERT_TRUE(!!loadedLayer) << "Loading XML with text loader failed";
+    ASSERT_EQ(2, loadedLayer->m_objects.size());
+
+    auto first = loadedLayer->m_objects[0];
+    auto second = loadedLayer->m_objects[1];
+    ASSERT_TRUE(!!first);
+    ASSERT_TRUE(!!second);
+
+    EXPECT_STREQ("<first>", first->m_text.c_str());
+    EXPECT_EQ(1, first->m_int);
+    EXPECT_EQ(0.5f, first->m_float);
+    EXPECT_TRUE(first->m_bool);
+    EXPECT_EQ(second, first->m_child);
+    EXPECT_EQ(loadedLayer.get(), first->parent());
+
+    EXPECT_STREQ("Tom & Jerry", second->m_text.c_str());
+    EXPECT_EQ(2, second->m_int);
+    EXPECT_TRUE(!second->m_child);
+    EXPECT_EQ(loadedLayer.get(), second->parent());
+}
@@ -27,12 +27,15 @@ namespace base
         {
             Read,
             Write,
+            ReadWrite,
         };
 
         struct SelectorResult
         {
             SocketType socket = 0;
             bool error = false;
+            bool readable = false; // socket has data to read (or a pending connection)
+            bool writable = false; // socket can accept more data to send
         };
 
         // helper class to facilitate waiting for active socket
@@ -44,6 +47,9 @@ namespace base
             // wait for something to become readable, sets the iterator
             SelectorEvent wait(SelectorOp op, const SocketType* sockets, uint32_t numSockets, uint32_t timeoutMs);
 
+            // wait for something to happen on sockets, each socket has it's own operation we wait for, sets the iterator
+            SelectorEvent wait(const SocketType* sockets, const SelectorOp* ops, uint32_t numSockets, uint32_t timeoutMs);
+
             //--
 
             // iterator to the list of reported sockets
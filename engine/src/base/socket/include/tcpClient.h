@@ -83,6 +83,10 @@ namespace base
                 // send data via connection to server
                 bool send( const void* data, uint32_t dataSize);
 
+                // send data composed from multiple parts (ie. header + payload) with gathered writes, without merging the parts first
+                bool send(std::initializer_list<BlockPart> parts);
+                bool send(const BlockPart* parts, uint32_t numParts);
+
                 // get stats for this client connection
                 void stat(ConnectionStats& outStats) const;
 
@@ -11,9 +11,12 @@
 #include "address.h"
 #include "baseSocket.h"
 #include "tcpSocket.h"
+#include "selector.h"
+#include "blockAllocator.h"
 
 #include "base/system/include/thread.h"
 #include "base/containers/include/hashMap.h"
+#include "base/containers/include/queue.h"
 
 namespace base
 {
@@ -51,6 +54,9 @@ namespace base
             {
                 uint32_t pollTimeout = 50; // timeout for internal poll calls
                 uint32_t recvBufferSize = 8192; // size of the receive buffer (we read data from sockets in batches of this size)
+                uint32_t maxPendingSendSize = 16 << 20; // how much data can be queued for a single connection before sends to it start failing (backpressure)
+                uint32_t maxSendBatchCount = 64; // max number of queued messages written to the socket with a single gathered send
+                bool disconnectOnSendOverflow = false; // close connections that can't keep up with the data instead of just failing the sends
             };
 
             //---
@@ -83,10 +89,15 @@ namespace base
 
                 //--
 
-                // send data via connection, fails only if connection ID is no longer valid
+                // send data via connection, fails if connection ID is no longer valid or the connection has too much data queued already
+                // NOTE: data is written directly if the socket can take it, only the part that did not fit is copied into the connection's send queue, this never blocks on the network
                 // NOTE: data may arrive in different "chunks" than sent, remember about framing
                 bool send(ConnectionID id, const void* data, uint32_t dataSize);
 
+                // send data composed from multiple parts (ie. header + payload) as one message, parts are never interleaved with data sent from other threads
+                bool send(ConnectionID id, std::initializer_list<BlockPart> parts);
+                bool send(ConnectionID id, const BlockPart* parts, uint32_t numParts);
+
                 // disconnect a given connection from server
                 bool disconnect(ConnectionID id);
 
@@ -119,8 +130,17 @@ namespace base
                     ConnectionStats stats; // connection stats
 
                     std::atomic<uint32_t> closeRequest; // we got external request to close this connection
+
+                    SpinLock sendLock; // protects the send queue and the writes to the socket
+                    Queue<Block*> sendQueue; // data waiting to be written to the socket, first block may be partially sent
+                    std::atomic<uint32_t> sendQueueSize; // total size of data in the send queue, if not zero we wait for the socket to become writable
+
+                    Connection();
+                    ~Connection();
                 };
 
+                BlockAllocator m_blockAllocator;
+
                 Array<Connection*> m_activeConnections;
                 HashMap<ConnectionID, Connection*> m_activeConnectionsIDMap;
                 HashMap<SocketType , Connection*> m_activeConnectionsSocketMap;
@@ -132,12 +152,15 @@ namespace base
 
                 void threadFunc();
 
-                void collectActiveConnections(Array<SocketType>& outActiveSockets);
+                void collectActiveConnections(Array<SocketType>& outActiveSockets, Array<SelectorOp>& outActiveSocketOps);
                 void purgeConnection(Connection* connection);
 
+                bool queueData(ConnectionID id, const BlockPart* parts, uint32_t numParts);
+                void flushConnection(Connection* connection);
+
                 void serviceListenerClose();
                 void serviceListenerSocket(SocketType socket);
-                void serviceConnectionSocket(SocketType socket, bool error);
+                void serviceConnectionSocket(const SelectorResult& result);
             };
 
             //---
@@ -25,6 +25,8 @@ namespace base
                 NativeTimePoint startTime;
                 uint64_t totalDataSent = 0;
                 uint64_t totalDataReceived = 0;
+                uint64_t totalDataQueued = 0; // data that could not be sent right away and had to be copied into the send queue
+                uint32_t numBlocksQueued = 0; // number of blocks allocated for the send queue
 
                 void print(IFormatStream& f) const;
             };
@@ -55,6 +57,10 @@ namespace base
 
                 // Send data through the socket
                 int send(const void* data, int size);
+
+                // Send data from multiple memory regions through the socket with a single gathered write
+                // NOTE: like the normal send this may send less data than requested (0 if the socket would block)
+                int send(const BlockPart* parts, uint32_t numParts);
             };
 
             //---
@@ -81,6 +81,8 @@ namespace base
                 uint32_t sendTimeoutMs = Constants::DEFAULT_SEND_TIMEOUT_MS;
                 uint32_t timeoutProbeIntervalMs = Constants::DEFAULT_SELECTOR_TIMEOUT_MS;
                 uint32_t maxMtu = Constants::MAX_MTU;
+                uint32_t receiveBatchSize = 32; // max number of datagrams read from the socket with a single system call
+                uint32_t numReceiveThreads = 1; // number of sockets sharing the port, each with it's own receiving thread, remote peers are distributed between them by the system (if supported)
             };
 
             //--
@@ -134,6 +136,14 @@ namespace base
                 RawSocket m_socket;
                 Address m_address;
 
+                struct ReceiveThread : public NoCopy
+                {
+                    RawSocket socket; // additional socket bound to the same port as the main one, used only for receiving
+                    Thread thread;
+                };
+
+                Array<ReceiveThread*> m_extraReceiveThreads;
+
                 BlockAllocator* m_blockAllocator;
                 bool m_externalBlockAllocator;
 
@@ -150,8 +160,8 @@ namespace base
                     ConnectionID id = 0;
                     uint32_t mtuSize = Constants::DEFAULT_MTU;
                     std::atomic<uint32_t> nextSequenceNumber = 1;
-                    NativeTimePoint timeoutPoint;
-                    NativeTimePoint nextPingPoint;
+                    std::atomic<NativeTimePoint::TValue> timeoutPoint = 0; // refreshed by the receiving threads without the connections lock, see processReceivedPacket
+                    std::atomic<NativeTimePoint::TValue> nextPingPoint = 0;
                     bool connected = false;
                     bool isConnectionInitializer = false;
 
@@ -167,6 +177,20 @@ namespace base
                 HashMap<Address, Connection*> m_activeConnectionsAddressMap;
                 SpinLock m_activeConnectionsLock;
 
+                // lookup for the connections by ID that does not require locking, collisions are resolved via the map
+                // NOTE: connection objects are not deleted until endpoint is closed so it's safe to keep pointers to them
+                static const uint32_t CONNECTION_CACHE_SIZE = 1024;
+                std::atomic<Connection*> m_connectionsIDCache[CONNECTION_CACHE_SIZE];
+
+                // per receiving thread cache of the address -> connection mapping, allows to route packets without locking
+                struct ConnectionAddressCache : public NoCopy
+                {
+                    static const uint32_t SIZE = 256;
+                    Connection* entries[SIZE];
+
+                    ConnectionAddressCache();
+                };
+
                 //--
 
                 struct PendingConnection : public NoCopy
@@ -186,9 +210,10 @@ namespace base
                 void sendPing(Connection* connection);
                 void sendTimeoutDisconnect(Connection* connection);
 
+                void refreshConnectionTimeouts(Connection* connection);
                 void processPendingConnectionsTimeouts();
                 void processGeneralConnectionsTimeouts(Array<Connection*>& tempArray);
-                void processReceivedPacket(Packet* packet);
+                void processReceivedPacket(Packet* packet, ConnectionAddressCache& addressCache);
 
                 void collectConnectionsForPing(Array<Connection*>& outArray);
                 void collectConnectionsTimeouted(Array<Connection*>& outArray);
@@ -203,15 +228,14 @@ namespace base
                 void closeConnection(Connection* connection);
 
                 Connection* findConnection(ConnectionID id);
+                void registerConnection(Connection* connection);
 
                 void rawSend(const void* data, int size, const Address& destinationAddress);
+                void rawSend(const SentDatagram* datagrams, uint32_t numDatagrams);
 
-                bool rawReceive();
-
-                void threadFunc();
-
-
+                bool rawReceive(RawSocket& socket, Array<Block*>& blocks, Array<ReceivedDatagram>& datagrams, ConnectionAddressCache& addressCache);
 
+                void threadFunc(RawSocket& socket, bool mainThread);
             };
 
             //---
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "address.h"
 #include "baseSocket.h"
 
 namespace base
@@ -16,6 +17,23 @@ namespace base
         namespace udp
         {
 
+            // datagram slot for the batched receive
+            struct ReceivedDatagram
+            {
+                void* data = nullptr; // where to write the datagram
+                uint32_t capacity = 0; // size of the memory for the datagram
+                uint32_t size = 0; // size of received datagram
+                Address address; // where the datagram came from
+            };
+
+            // datagram for the batched send
+            struct SentDatagram
+            {
+                const void* data = nullptr;
+                uint32_t size = 0;
+                const Address* address = nullptr; // where to send the datagram
+            };
+
             // Raw UDP socket wrapper
             class BASE_SOCKET_API RawSocket : public BaseSocket
             {
@@ -27,7 +45,8 @@ namespace base
                 //---
 
                 // Open bidirectional datagram socket and bind it to specified address
-                bool open(const Address& address, Address* outLocalAddress = nullptr);
+                // NOTE: shared port allows other sockets to bind to the same address, the system will distribute incoming datagrams between them
+                bool open(const Address& address, Address* outLocalAddress = nullptr, bool sharedPort = false);
 
                 // Receive data from the socket
                 int receive(void* data, int size, Address* outSourceAddress);
@@ -35,11 +54,22 @@ namespace base
                 // Send data through the socket
                 int send(const void* data, int size, const Address& destinationAddress);
 
+                // Receive multiple datagrams with a single system call (if supported), returns number of received datagrams, 0 if there was nothing to receive or -1 on errors
+                int receive(ReceivedDatagram* datagrams, uint32_t maxDatagrams);
+
+                // Send multiple datagrams with a single system call (if supported), returns number of datagrams sent (less than requested if the send buffer got full) or -1 on errors
+                int send(const SentDatagram* datagrams, uint32_t numDatagrams);
+
                 // Set IP-level fragmentation policy
                 bool allowFragmentation(bool allowFragmentation);
 
                 // Set send and receive buffer sizes
                 bool bufferSize(int sendBufferBytes, int receiveBufferBytes);
+
+                //---
+
+                // can we open multiple sockets on the same port and have the datagrams distributed between them
+                static bool SupportsSharedPort();
             };
 
         } // udp
@@ -28,6 +28,16 @@ namespace base
 
         SelectorEvent Selector::wait(SelectorOp op, const SocketType* sockets, uint32_t numSockets, uint32_t timeoutMs)
         {
+            InplaceArray<SelectorOp, 64> ops;
+            ops.resize(numSockets);
+            for (auto& socketOp : ops)
+                socketOp = op;
+
+            return wait(sockets, ops.typedData(), numSockets, timeoutMs);
+        }
+
+        SelectorEvent Selector::wait(const SocketType* sockets, const SelectorOp* ops, uint32_t numSockets, uint32_t timeoutMs)
+        {
 #if defined(PLATFORM_POSIX)
             // prepare memory for the params for poll()
             m_internalData.reset();
@@ -37,7 +47,12 @@ namespace base
             auto pollList  = (pollfd*) m_internalData.allocateUninitialized(sizeof(pollfd) * numSockets);
             for (uint32_t i=0; i<numSockets; ++i)
             {
-                pollList[i].events = (op == SelectorOp::Read) ? POLLIN : POLLOUT;
+                pollList[i].events = 0;
+                if (ops[i] == SelectorOp::Read || ops[i] == SelectorOp::ReadWrite)
+                    pollList[i].events |= POLLIN;
+                if (ops[i] == SelectorOp::Write || ops[i] == SelectorOp::ReadWrite)
+                    pollList[i].events |= POLLOUT;
+
                 pollList[i].fd = sockets[i];
                 pollList[i].revents = 0;
             }
@@ -55,14 +70,16 @@ namespace base
             }
 
             // look for data
-            result.reset();
-            result.reserve(ret);
+            m_result.reset();
+            m_result.reserve(ret);
             for (uint32_t i=0; i<numSockets; ++i)
             {
                 if (pollList[i].revents != 0)
                 {
-                    auto& result = result.emplaceBack();
+                    auto& result = m_result.emplaceBack();
                     result.socket = pollList[i].fd;
+                    result.readable = 0 != (pollList[i].revents & POLLIN);
+                    result.writable = 0 != (pollList[i].revents & POLLOUT);
 
                     if (pollList[i].revents & POLLERR)
                     {
@@ -90,23 +107,39 @@ namespace base
             timeout.tv_usec = (timeoutMs % 1000) * 1000;
 
             m_internalData.reset();
-            m_internalData.reserve(sizeof(fd_set) * 2);
+            m_internalData.reserve(sizeof(fd_set) * 3);
+
+            auto readSocketSet  = (fd_set*) m_internalData.allocateUninitialized(sizeof(fd_set));
+            FD_ZERO(readSocketSet);
 
-            auto socketSet  = (fd_set*) m_internalData.allocateUninitialized(sizeof(fd_set));
-            FD_ZERO(socketSet);
+            auto writeSocketSet  = (fd_set*) m_internalData.allocateUninitialized(sizeof(fd_set));
+            FD_ZERO(writeSocketSet);
 
-			auto errorSocketSet  = (fd_set*)m_internalData.allocateUninitialized(sizeof(fd_set));
-			FD_ZERO(errorSocketSet);
+            auto errorSocketSet  = (fd_set*)m_internalData.allocateUninitialized(sizeof(fd_set));
+            FD_ZERO(errorSocketSet);
 
+            bool hasRead = false;
+            bool hasWrite = false;
             uint32_t maxIndex = 0;
             for (uint32_t i=0; i<numSockets; ++i)
             {
-                FD_SET(sockets[i], socketSet);
-				FD_SET(sockets[i], errorSocketSet);
+                if (ops[i] == SelectorOp::Read || ops[i] == SelectorOp::ReadWrite)
+                {
+                    FD_SET(sockets[i], readSocketSet);
+                    hasRead = true;
+                }
+
+                if (ops[i] == SelectorOp::Write || ops[i] == SelectorOp::ReadWrite)
+                {
+                    FD_SET(sockets[i], writeSocketSet);
+                    hasWrite = true;
+                }
+
+                FD_SET(sockets[i], errorSocketSet);
                 maxIndex = std::max<uint32_t>(sockets[i], maxIndex);
             }
 
-            int result = select((int)maxIndex + 1, (op == SelectorOp::Read) ? socketSet : nullptr, (op == SelectorOp::Write) ? socketSet : nullptr, errorSocketSet, &timeout);
+            int result = select((int)maxIndex + 1, hasRead ? readSocketSet : nullptr, hasWrite ? writeSocketSet : nullptr, errorSocketSet, &timeout);
             if (result < 0)
             {
                 int error = GetSocketError();
@@ -127,23 +160,21 @@ namespace base
 
                 for (uint32_t i=0; i<numSockets; ++i)
                 {
-					if (FD_ISSET(sockets[i], errorSocketSet))
-					{
-						auto& result = m_result.emplaceBack();
-						result.socket = sockets[i];
-						result.error = true;
-						FD_CLR(sockets[i], socketSet);
-					}
-                    else if (FD_ISSET(sockets[i], socketSet))
+                    const bool error = FD_ISSET(sockets[i], errorSocketSet);
+                    const bool readable = hasRead && FD_ISSET(sockets[i], readSocketSet);
+                    const bool writable = hasWrite && FD_ISSET(sockets[i], writeSocketSet);
+
+                    if (error || readable || writable)
                     {
-						auto& result = m_result.emplaceBack();
-						result.socket = sockets[i];
-						result.error = false;
-                        FD_CLR(sockets[i], socketSet);
+                        auto& result = m_result.emplaceBack();
+                        result.socket = sockets[i];
+                        result.error = error;
+                        result.readable = readable;
+                        result.writable = writable;
                     }
                 }
 
-				return SelectorEvent::Ready;
+                return SelectorEvent::Ready;
             }
 #else
             // invalid platform
@@ -136,6 +136,63 @@ namespace base
                 return true;
             }
 
+            bool Client::send(std::initializer_list<BlockPart> parts)
+            {
+                return send(parts.begin(), (uint32_t)parts.size());
+            }
+
+            bool Client::send(const BlockPart* parts, uint32_t numParts)
+            {
+                // don't send shit via dead client connection
+                if (!m_connectedFlag.load())
+                    return false;
+
+                uint32_t dataSize = 0;
+                InplaceArray<BlockPart, 8> pendingParts;
+                for (uint32_t i = 0; i < numParts; ++i)
+                {
+                    pendingParts.pushBack(parts[i]);
+                    dataSize += parts[i].size;
+                }
+
+                // push data and let the system worry
+                uint32_t firstPart = 0;
+                uint32_t sentLeft = 0;
+                for (;;)
+                {
+                    // skip over the parts that were fully sent
+                    while (firstPart < pendingParts.size() && pendingParts[firstPart].size <= sentLeft)
+                        sentLeft -= pendingParts[firstPart++].size;
+
+                    if (firstPart == pendingParts.size())
+                        break;
+
+                    // first part may be sent partially
+                    auto& part = pendingParts[firstPart];
+                    part.dataPtr = (const uint8_t*)part.dataPtr + sentLeft;
+                    part.size -= sentLeft;
+
+                    auto sentSize = m_socket.send(pendingParts.typedData() + firstPart, pendingParts.size() - firstPart);
+                    if (sentSize < 0)
+                    {
+                        TRACE_ERROR("TCP Client: Failed to send {} bytes to {}, closing", dataSize, m_remoteAddress);
+                        m_connectedFlag.exchange(0);
+                        return false;
+                    }
+                    else if (sentSize == 0)
+                    {
+                        Sleep(10);
+                    }
+
+                    sentLeft = (uint32_t)sentSize;
+                }
+
+                // update stats
+                auto lock = base::CreateLock(m_statsLock);
+                m_stats.totalDataSent += dataSize;
+                return true;
+            }
+
             void Client::stat(ConnectionStats& outStats) const
             {
                 auto lock = CreateLock(m_statsLock);
@@ -11,6 +11,7 @@
 
 #include "tcpServer.h"
 #include "tcpSocket.h"
+#include "block.h"
 
 #include "base/system/include/thread.h"
 #include "base/containers/include/inplaceArray.h"
@@ -34,12 +35,31 @@ namespace base
 
                 if (totalDataSent)
                     f.appendf("  Data sent: {} ({}/s)\n", MemSize(totalDataSent), MemSize((double)totalDataSent / aliveTime));
+                if (totalDataQueued)
+                    f.appendf("  Data queued: {} in {} blocks\n", MemSize(totalDataQueued), numBlocksQueued);
                 if (totalDataReceived)
                     f.appendf("  Data recv: {} ({}/s)", MemSize(totalDataReceived), MemSize((double)totalDataReceived / aliveTime));
             }
 
             //--
 
+            Server::Connection::Connection()
+                : closeRequest(0)
+                , sendQueueSize(0)
+            {}
+
+            Server::Connection::~Connection()
+            {
+                // release data that never made it to the socket
+                while (!sendQueue.empty())
+                {
+                    sendQueue.top()->release();
+                    sendQueue.pop();
+                }
+            }
+
+            //--
+
             Server::Server(IServerHandler* handler, const ServerConfig& config /*= ServerConfig()*/)
                 : m_handler(handler)
                 , m_nextConnectionID(1)
@@ -48,6 +68,7 @@ namespace base
                 , m_config(config)
             {
                 m_receciveBuffer.resize(config.recvBufferSize);
+                m_config.maxSendBatchCount = std::clamp<uint32_t>(m_config.maxSendBatchCount, 1, 1024); // IOV_MAX
             }
 
             Server::~Server()
@@ -136,46 +157,154 @@ namespace base
 
             bool Server::send(ConnectionID id, const void* data, uint32_t dataSize)
             {
-                auto lock  = CreateLock(m_activeConnectionsLock);
+                BlockPart part(data, dataSize);
+                return send(id, &part, 1);
+            }
 
+            bool Server::send(ConnectionID id, std::initializer_list<BlockPart> parts)
+            {
+                return send(id, parts.begin(), (uint32_t)parts.size());
+            }
+
+            bool Server::send(ConnectionID id, const BlockPart* parts, uint32_t numParts)
+            {
                 // don't send shit via dead server
                 if (!m_listeningFlag.load())
                     return false;
 
+                return queueData(id, parts, numParts);
+            }
+
+            bool Server::queueData(ConnectionID id, const BlockPart* parts, uint32_t numParts)
+            {
+                auto lock = CreateLock(m_activeConnectionsLock);
+
                 // get target address for connection
                 Connection* connection = nullptr;
                 if (!m_activeConnectionsIDMap.find(id, connection))
                     return false;
 
-                // push data and let the system worry
-                uint32_t sentLeft = dataSize;
-                auto sentPtr  = (const uint8_t*)data;
-                while (sentLeft > 0)
+                // lock the connection before releasing the global lock, connection can only be purged by the server thread while holding both locks
+                auto sendLock = CreateLock(connection->sendLock);
+                lock.release();
+
+                uint32_t dataSize = 0;
+                for (uint32_t i = 0; i < numParts; ++i)
+                    dataSize += parts[i].size;
+
+                // if nothing is waiting in the queue the socket is most likely writable, try to send the data right away directly from the caller's memory
+                // only the part that did not fit in the socket buffer is copied into the send queue
+                uint32_t skipSize = 0;
+                const auto queueSize = connection->sendQueueSize.load();
+                if (queueSize == 0)
                 {
-                    auto sentSize  = connection->rawSocket.send(sentPtr, sentLeft);
+                    if (connection->closeRequest.load())
+                        return false;
+
+                    auto sentSize = connection->rawSocket.send(parts, numParts);
                     if (sentSize < 0)
                     {
-                        TRACE_ERROR("TCP Server: Failed to send {} bytes to {} ({}), closing", dataSize, id, connection->address);
+                        TRACE_ERROR("TCP Server: Failed to send {} to {} ({}), closing", MemSize(dataSize), id, connection->address);
                         connection->closeRequest.exchange(1);
                         return false;
                     }
-                    else if (sentSize != (int) dataSize)
+
+                    connection->stats.totalDataSent += sentSize;
+                    skipSize = (uint32_t)sentSize;
+                    if (skipSize == dataSize)
+                        return true;
+                }
+
+                // respect the limit on the data waiting in the queue, failing the whole message keeps the framing intact
+                else if (queueSize + (uint64_t)dataSize > m_config.maxPendingSendSize)
+                {
+                    if (m_config.disconnectOnSendOverflow)
                     {
-                        TRACE_WARNING("TCP Server: Truncated send ({} -> {}) when sending {} bytes to {} ({})", sentLeft, sentSize, id, connection->address);
-                        Sleep(10);
+                        TRACE_WARNING("TCP Server: Connection {} ({}) can't keep up with sent data ({} queued), closing", id, connection->address, MemSize(queueSize));
+                        connection->closeRequest.exchange(1);
                     }
 
-                    sentPtr += sentSize;
-                    sentLeft -= sentSize;
+                    return false;
                 }
 
-                // update stats
-                connection->stats.totalDataSent += dataSize;
+                // copy the data that was not sent yet into the queue, it will be sent together with the rest of the queue once the server thread sees that the socket is writable
+                const auto queuedSize = dataSize - skipSize;
+                auto block = m_blockAllocator.alloc(queuedSize);
+                auto writePtr = block->data();
+                for (uint32_t i = 0; i < numParts; ++i)
+                {
+                    const auto& part = parts[i];
+                    if (skipSize >= part.size)
+                    {
+                        skipSize -= part.size;
+                        continue;
+                    }
 
-                // data sent
+                    const auto copySize = part.size - skipSize;
+                    memcpy(writePtr, (const uint8_t*)part.dataPtr + skipSize, copySize);
+                    writePtr += copySize;
+                    skipSize = 0;
+                }
+
+                connection->sendQueue.push(block);
+                connection->sendQueueSize += queuedSize;
+                connection->stats.totalDataQueued += queuedSize;
+                connection->stats.numBlocksQueued += 1;
                 return true;
             }
 
+            void Server::flushConnection(Connection* con)
+            {
+                InplaceArray<BlockPart, 64> parts;
+
+                while (!con->sendQueue.empty() && !con->closeRequest.load())
+                {
+                    // gather as many messages as we can into one send
+                    const auto numBlocks = std::min<uint32_t>(con->sendQueue.size(), m_config.maxSendBatchCount);
+                    parts.reset();
+                    for (uint32_t i = 0; i < numBlocks; ++i)
+                    {
+                        auto block = con->sendQueue.peek(i);
+                        parts.emplaceBack(block->data(), block->dataSize());
+                    }
+
+                    auto sentSize = con->rawSocket.send(parts.typedData(), parts.size());
+                    if (sentSize < 0)
+                    {
+                        TRACE_ERROR("TCP Server: Failed to send {} to {} ({}), closing", MemSize(con->sendQueueSize.load()), con->id, con->address);
+                        con->closeRequest.exchange(1);
+                        break;
+                    }
+                    else if (sentSize == 0)
+                    {
+                        // socket is full, wait until it's writable again
+                        break;
+                    }
+
+                    // update stats
+                    con->stats.totalDataSent += sentSize;
+                    con->sendQueueSize -= sentSize;
+
+                    // release sent blocks, the last one may be sent only partially
+                    auto sentLeft = (uint32_t)sentSize;
+                    while (sentLeft > 0)
+                    {
+                        auto block = con->sendQueue.top();
+                        if (block->dataSize() <= sentLeft)
+                        {
+                            sentLeft -= block->dataSize();
+                            block->release();
+                            con->sendQueue.pop();
+                        }
+                        else
+                        {
+                            block->shrink(sentLeft);
+                            sentLeft = 0;
+                        }
+                    }
+                }
+            }
+
             bool Server::disconnect(ConnectionID id)
             {
                 // dead server
@@ -195,6 +324,19 @@ namespace base
                 return true;
             }
 
+            bool Server::stat(ConnectionID id, ConnectionStats& outStats) const
+            {
+                auto lock = CreateLock(m_activeConnectionsLock);
+
+                Connection* connection = nullptr;
+                if (!m_activeConnectionsIDMap.find(id, connection))
+                    return false;
+
+                auto sendLock = CreateLock(connection->sendLock);
+                outStats = connection->stats;
+                return true;
+            }
+
             //--
 
             void Server::serviceListenerSocket(SocketType socket)
@@ -228,13 +370,13 @@ namespace base
                 }
             }
 
-            void Server::serviceConnectionSocket(SocketType socket, bool error)
+            void Server::serviceConnectionSocket(const SelectorResult& result)
             {
                 // find connection for given socket
                 Connection *con = nullptr;
                 {
                     auto lock = CreateLock(m_activeConnectionsLock);
-                    m_activeConnectionsSocketMap.find(socket, con);
+                    m_activeConnectionsSocketMap.find(result.socket, con);
                 }
 
                 // not found
@@ -245,15 +387,22 @@ namespace base
                 }
 
                 // close
-                if (error)
+                if (result.error)
                 {
                     TRACE_ERROR("TCP Server: got error for connection {}", con->address);
                     con->closeRequest.exchange(1);
                     return;
                 }
 
+                // socket can accept more data, send as much of the queue as we can
+                if (result.writable)
+                {
+                    auto sendLock = CreateLock(con->sendLock);
+                    flushConnection(con);
+                }
+
                 // get data
-                while (1)
+                while (result.readable)
                 {
                     auto dataSize = con->rawSocket.receive(m_receciveBuffer.data(), m_receciveBuffer.dataSize());
                     if (dataSize < 0)
@@ -282,6 +431,7 @@ namespace base
                 Selector selector;
 
                 InplaceArray<SocketType, 64> activeSockets;
+                InplaceArray<SelectorOp, 64> activeSocketOps;
 
                 SocketType listenSocket = m_socket.systemSocket();
 
@@ -292,12 +442,14 @@ namespace base
                     // always put the main socket on the list since we are waiting for the connections
                     activeSockets.reset();
                     activeSockets.pushBack(listenSocket);
+                    activeSocketOps.reset();
+                    activeSocketOps.pushBack(SelectorOp::Read);
 
                     // process the list of active connections, get list of sockets to look for
-                    collectActiveConnections(activeSockets);
+                    collectActiveConnections(activeSockets, activeSocketOps);
 
                     // wait for something
-                    switch (selector.wait(SelectorOp::Read, activeSockets.typedData(), activeSockets.size(), 50))
+                    switch (selector.wait(activeSockets.typedData(), activeSocketOps.typedData(), activeSockets.size(), m_config.pollTimeout))
                     {
                         case SelectorEvent::Ready:
                         {
@@ -319,7 +471,7 @@ namespace base
                                 }
                                 else
                                 {
-                                    serviceConnectionSocket(result.socket, result.error);
+                                    serviceConnectionSocket(result);
                                 }
                             }
 
@@ -350,7 +502,7 @@ namespace base
                 }
             }
 
-            void Server::collectActiveConnections(Array<SocketType>& outActiveSockets)
+            void Server::collectActiveConnections(Array<SocketType>& outActiveSockets, Array<SelectorOp>& outActiveSocketOps)
             {
                 auto lock = CreateLock(m_activeConnectionsLock);
 
@@ -366,7 +518,9 @@ namespace base
                     }
                     else
                     {
+                        // wait for the socket to become writable only if we have something to write, otherwise we would spin
                         outActiveSockets.pushBack(con->rawSocket.systemSocket());
+                        outActiveSocketOps.pushBack(con->sendQueueSize.load() ? SelectorOp::ReadWrite : SelectorOp::Read);
                     }
                 }
             }
@@ -388,8 +542,12 @@ namespace base
                 m_activeConnectionsIDMap.remove(con->id);
                 m_activeConnections.remove(con);
 
+                // wait for any sender that is still using the connection, no new ones can get it since it's no longer in the maps
+                auto sendLock = CreateLock(con->sendLock);
+
                 // close handle
                 con->rawSocket.close();
+                sendLock.release();
 
                 // cleanup object
                 MemDelete(con);
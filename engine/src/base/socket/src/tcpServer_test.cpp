@@ -8,9 +8,12 @@
 
 #include "build.h"
 #include "tcpServer.h"
+#include "tcpSocket.h"
 #include "address.h"
 
 #include "base/test/include/gtest/gtest.h"
+#include "base/system/include/thread.h"
+#include "base/system/include/timedScope.h"
 
 DECLARE_TEST_FILE(TcpServerTest);
 
@@ -55,6 +58,129 @@ namespace test
 
         tcp::Server m_server;
     };
+
+    class BroadcastServer : public tcp::IServerHandler
+    {
+    public:
+        BroadcastServer(const tcp::ServerConfig& config)
+            : m_server(this, config)
+        {}
+
+        bool init(Address& outAddress)
+        {
+            static uint16_t nextPort = 21000;
+
+            for (uint32_t i=0; i<100; ++i)
+            {
+                outAddress = Address::Local4(nextPort++);
+                if (m_server.init(outAddress))
+                    return true;
+            }
+
+            return false;
+        }
+
+        Array<ConnectionID> connections() const
+        {
+            auto lock = CreateLock(m_lock);
+            return m_connections;
+        }
+
+        virtual void handleConnectionAccepted(tcp::Server* server, const Address& address, ConnectionID connection) override final
+        {
+            auto lock = CreateLock(m_lock);
+            m_connections.pushBack(connection);
+        }
+
+        virtual void handleConnectionClosed(tcp::Server* server, const Address& address, ConnectionID connection) override final
+        {
+            auto lock = CreateLock(m_lock);
+            m_connections.remove(connection);
+        }
+
+        virtual void handleConnectionData(tcp::Server* server, const Address& address, ConnectionID connection, const void* data, uint32_t dataSize) override final
+        {}
+
+        virtual void handleServerClose(tcp::Server* server) override final
+        {}
+
+        //-
+
+        tcp::Server m_server;
+
+    private:
+        SpinLock m_lock;
+        Array<ConnectionID> m_connections;
+    };
+
+    static Array<ConnectionID> ConnectClients(BroadcastServer& server, tcp::RawSocket* clients, uint32_t numClients, const Address& address)
+    {
+        const auto numExistingConnections = server.connections().size();
+
+        for (uint32_t i=0; i<numClients; ++i)
+            clients[i].connect(address);
+
+        for (uint32_t i=0; i<500; ++i)
+        {
+            auto connections = server.connections();
+            if (connections.size() == numExistingConnections + numClients)
+            {
+                connections.erase(0, numExistingConnections);
+                return connections;
+            }
+
+            Sleep(10);
+        }
+
+        return Array<ConnectionID>();
+    }
+
+    // receive exactly given amount of data on a non blocking socket, gives up after a timeout
+    static bool ReceiveAll(tcp::RawSocket& client, void* data, uint32_t size, double timeout = 30.0)
+    {
+        auto writePtr = (uint8_t*)data;
+        uint32_t received = 0;
+
+        ScopeTimer timer;
+        while (received < size && timer.timeElapsed() < timeout)
+        {
+            auto chunkSize = client.receive(writePtr + received, size - received);
+            if (chunkSize > 0)
+                received += chunkSize;
+            else if (chunkSize == 0)
+                Sleep(1);
+            else
+                break;
+        }
+
+        return received == size;
+    }
+
+    // fill the send queue of a connection whose client is not reading until the server refuses to take more
+    static uint64_t SendUntilRejected(tcp::Server& server, ConnectionID id, uint32_t messageSize, uint64_t& outTotalAccepted)
+    {
+        Array<uint8_t> message;
+        message.resize(messageSize);
+        memset(message.data(), 0xCD, messageSize);
+
+        outTotalAccepted = 0;
+        for (uint32_t i=0; i<16384; ++i)
+        {
+            if (!server.send(id, message.data(), messageSize))
+                return i;
+
+            outTotalAccepted += messageSize;
+        }
+
+        return INDEX_MAX;
+    }
+
+    // byte of the test stream at given offset, it's a sequence of incrementing 32-bit words
+    static INLINE uint8_t StreamByte(uint64_t offset)
+    {
+        const auto word = (uint32_t)(offset / 4);
+        return (uint8_t)(word >> (8 * (offset % 4)));
+    }
 }
 
 TEST(TcpServer, StartupTeardown)
@@ -65,3 +191,329 @@ TEST(TcpServer, StartupTeardown)
         Sleep(100);
     }*/
 }
+
+// send much more than fits in the socket buffers (~32MB) to a client that does not read yet, the rest must be queued and sent in order once the client starts reading
+TEST(TcpServer, PartialWriteContinuesInOrder)
+{
+    static const uint32_t NUM_MESSAGES = 8192;
+    static const uint32_t MESSAGE_SIZE = 4096 + 12; // not a multiple of the word size so messages split the words
+
+    tcp::ServerConfig config;
+    config.maxPendingSendSize = 64 << 20;
+
+    test::BroadcastServer server(config);
+    Address address;
+    ASSERT_TRUE(server.init(address));
+
+    tcp::RawSocket client;
+    const auto connections = test::ConnectClients(server, &client, 1, address);
+    ASSERT_EQ(1, connections.size());
+    client.blocking(false);
+
+    uint64_t offset = 0;
+    uint8_t message[MESSAGE_SIZE];
+    for (uint32_t i=0; i<NUM_MESSAGES; ++i)
+    {
+        for (uint32_t j=0; j<MESSAGE_SIZE; ++j)
+            message[j] = test::StreamByte(offset + j);
+
+        ASSERT_TRUE(server.m_server.send(connections[0], message, MESSAGE_SIZE));
+        offset += MESSAGE_SIZE;
+    }
+
+    // nobody was reading so some of the data had to go through the queue
+    tcp::ConnectionStats stats;
+    ASSERT_TRUE(server.m_server.stat(connections[0], stats));
+    EXPECT_LT(0, stats.totalDataQueued);
+
+    Array<uint8_t> received;
+    received.resize(NUM_MESSAGES * MESSAGE_SIZE);
+    ASSERT_TRUE(test::ReceiveAll(client, received.data(), received.size()));
+
+    for (uint32_t i=0; i<received.size(); ++i)
+    {
+        if (received[i] != test::StreamByte(i))
+        {
+            ADD_FAILURE() << "Stream mismatch at offset " << i;
+            break;
+        }
+    }
+
+    ASSERT_TRUE(server.m_server.stat(connections[0], stats));
+    EXPECT_EQ(offset, stats.totalDataSent);
+}
+
+// data waiting in the queue can't exceed the limit, the messages over the limit are rejected as a whole and the connection stays open
+TEST(TcpServer, SendQueueLimitRejectsMessages)
+{
+    static const uint32_t MESSAGE_SIZE = 16384;
+
+    tcp::ServerConfig config;
+    config.maxPendingSendSize = 256 << 10;
+
+    test::BroadcastServer server(config);
+    Address address;
+    ASSERT_TRUE(server.init(address));
+
+    tcp::RawSocket client;
+    const auto connections = test::ConnectClients(server, &client, 1, address);
+    ASSERT_EQ(1, connections.size());
+    client.blocking(false);
+
+    uint64_t totalAccepted = 0;
+    const auto numAccepted = test::SendUntilRejected(server.m_server, connections[0], MESSAGE_SIZE, totalAccepted);
+    ASSERT_NE(INDEX_MAX, numAccepted);
+
+    // the socket buffers got full before the queue did
+    tcp::ConnectionStats stats;
+    ASSERT_TRUE(server.m_server.stat(connections[0], stats));
+    EXPECT_LT(0, stats.totalDataQueued);
+
+    // connection is still there, we only refused the data
+    Sleep(100);
+    EXPECT_EQ(1, server.connections().size());
+
+    // everything that was accepted gets delivered, and nothing more
+    Array<uint8_t> received;
+    received.resize(totalAccepted);
+    ASSERT_TRUE(test::ReceiveAll(client, received.data(), received.size()));
+
+    uint8_t extra = 0;
+    Sleep(100);
+    EXPECT_EQ(0, client.receive(&extra, 1));
+
+    // once the queue is drained we can send again
+    uint8_t message[MESSAGE_SIZE];
+    memset(message, 0xCD, sizeof(message));
+    EXPECT_TRUE(server.m_server.send(connections[0], message, sizeof(message)));
+    ASSERT_TRUE(test::ReceiveAll(client, received.data(), MESSAGE_SIZE));
+}
+
+// a connection that can't keep up gets closed if the server is configured to do so
+TEST(TcpServer, SendQueueOverflowDisconnects)
+{
+    static const uint32_t MESSAGE_SIZE = 16384;
+
+    tcp::ServerConfig config;
+    config.maxPendingSendSize = 256 << 10;
+    config.disconnectOnSendOverflow = true;
+
+    test::BroadcastServer server(config);
+    Address address;
+    ASSERT_TRUE(server.init(address));
+
+    tcp::RawSocket client;
+    const auto connections = test::ConnectClients(server, &client, 1, address);
+    ASSERT_EQ(1, connections.size());
+    client.blocking(false);
+
+    uint64_t totalAccepted = 0;
+    ASSERT_NE(INDEX_MAX, test::SendUntilRejected(server.m_server, connections[0], MESSAGE_SIZE, totalAccepted));
+
+    // connection should be closed by the server thread
+    ScopeTimer timer;
+    while (!server.connections().empty() && timer.timeElapsed() < 10.0)
+        Sleep(10);
+    EXPECT_TRUE(server.connections().empty());
+
+    // any further sends are refused
+    uint8_t message[MESSAGE_SIZE];
+    memset(message, 0xCD, sizeof(message));
+    EXPECT_FALSE(server.m_server.send(connections[0], message, sizeof(message)));
+
+    // client sees the end of the stream
+    Array<uint8_t> buffer;
+    buffer.resize(65536);
+    int result = 0;
+    while (timer.timeElapsed() < 20.0)
+    {
+        result = client.receive(buffer.data(), buffer.size());
+        if (result < 0)
+            break;
+        else if (result == 0)
+            Sleep(1);
+    }
+    EXPECT_GT(0, result);
+}
+
+// messages sent as multiple parts from different threads at the same time must not interleave in the stream
+TEST(TcpServer, GatheredSendsAreAtomic)
+{
+    static const uint32_t NUM_THREADS = 4;
+    static const uint32_t NUM_MESSAGES = 2000;
+    static const uint32_t MAX_PAYLOAD_SIZE = 3000;
+
+    struct Header
+    {
+        uint32_t thread = 0;
+        uint32_t sequence = 0;
+        uint32_t payloadSize = 0;
+    };
+
+    tcp::ServerConfig config;
+    config.maxPendingSendSize = 64 << 20;
+
+    test::BroadcastServer server(config);
+    Address address;
+    ASSERT_TRUE(server.init(address));
+
+    tcp::RawSocket client;
+    const auto connections = test::ConnectClients(server, &client, 1, address);
+    ASSERT_EQ(1, connections.size());
+    client.blocking(false);
+
+    std::atomic<uint32_t> numFailedSends(0);
+    Thread senderThreads[NUM_THREADS];
+    for (uint32_t i=0; i<NUM_THREADS; ++i)
+    {
+        ThreadSetup setup;
+        setup.m_name = "TCPSenderThread";
+        setup.m_function = [i, &numFailedSends, &server, id = connections[0]]()
+        {
+            uint32_t seed = i + 1;
+
+            uint8_t payload[MAX_PAYLOAD_SIZE];
+            memset(payload, (uint8_t)(i + 1), sizeof(payload));
+
+            for (uint32_t j=0; j<NUM_MESSAGES; ++j)
+            {
+                Header header;
+                header.thread = i;
+                header.sequence = j;
+                seed = seed * 1664525 + 1013904223;
+                header.payloadSize = 1 + (seed >> 8) % MAX_PAYLOAD_SIZE;
+
+                // split the payload in two parts so each message is made of three
+                const auto firstPartSize = header.payloadSize / 2;
+                if (!server.m_server.send(id, { BlockPart(&header, sizeof(header)), BlockPart(payload, firstPartSize), BlockPart(payload + firstPartSize, header.payloadSize - firstPartSize) }))
+                    numFailedSends += 1;
+            }
+        };
+
+        senderThreads[i].init(setup);
+    }
+
+    // read and validate the stream while the senders are running
+    uint32_t nextSequence[NUM_THREADS];
+    memset(nextSequence, 0, sizeof(nextSequence));
+
+    // NOTE: no early returns here, the sender threads must be closed before the test ends
+    uint32_t numReceived = 0;
+    uint8_t payload[MAX_PAYLOAD_SIZE];
+    while (numReceived < NUM_THREADS * NUM_MESSAGES)
+    {
+        Header header;
+        if (!test::ReceiveAll(client, &header, sizeof(header)))
+            break;
+
+        if (header.thread >= NUM_THREADS || header.sequence != nextSequence[header.thread] || header.payloadSize > MAX_PAYLOAD_SIZE)
+            break;
+
+        if (!test::ReceiveAll(client, payload, header.payloadSize))
+            break;
+
+        if (payload[0] != (uint8_t)(header.thread + 1) || memcmp(payload, payload + 1, header.payloadSize - 1) != 0)
+            break;
+
+        nextSequence[header.thread] += 1;
+        numReceived += 1;
+    }
+
+    for (auto& thread : senderThreads)
+        thread.close();
+
+    EXPECT_EQ(NUM_THREADS * NUM_MESSAGES, numReceived);
+    EXPECT_EQ(0, numFailedSends.load());
+}
+
+// broadcast a lot of small messages to readers that keep up and readers that don't read at all
+// the clients that keep up should not be slowed down by the stalled ones
+TEST(TcpServer, DISABLED_SlowReaderBenchmark)
+{
+    static const uint32_t NUM_FAST_CLIENTS = 4;
+    static const uint32_t NUM_SLOW_CLIENTS = 4;
+    static const uint32_t NUM_MESSAGES = 200000;
+    static const uint32_t MESSAGE_SIZE = 200;
+
+    tcp::ServerConfig config;
+    config.maxPendingSendSize = 4 << 20;
+
+    test::BroadcastServer server(config);
+    Address address;
+    ASSERT_TRUE(server.init(address));
+
+    // connect the clients in groups so we know which connection is which
+    tcp::RawSocket fastClients[NUM_FAST_CLIENTS];
+    tcp::RawSocket slowClients[NUM_SLOW_CLIENTS];
+    const auto fastConnections = test::ConnectClients(server, fastClients, NUM_FAST_CLIENTS, address);
+    const auto slowConnections = test::ConnectClients(server, slowClients, NUM_SLOW_CLIENTS, address);
+    ASSERT_EQ(NUM_FAST_CLIENTS, fastConnections.size());
+    ASSERT_EQ(NUM_SLOW_CLIENTS, slowConnections.size());
+
+    // fast clients read everything as soon as it arrives
+    std::atomic<uint64_t> totalReceived(0);
+    std::atomic<uint32_t> stopFlag(0);
+    Thread readerThreads[NUM_FAST_CLIENTS];
+    for (uint32_t i=0; i<NUM_FAST_CLIENTS; ++i)
+    {
+        fastClients[i].blocking(false);
+
+        ThreadSetup setup;
+        setup.m_name = "TCPReaderThread";
+        setup.m_function = [&totalReceived, &stopFlag, &client = fastClients[i]]()
+        {
+            uint8_t buffer[65536];
+            while (!stopFlag.load())
+            {
+                auto size = client.receive(buffer, sizeof(buffer));
+                if (size > 0)
+                    totalReceived += size;
+                else if (size == 0)
+                    Sleep(1);
+                else
+                    break;
+            }
+        };
+
+        readerThreads[i].init(setup);
+    }
+
+    // broadcast
+    uint8_t message[MESSAGE_SIZE];
+    memset(message, 0xAB, sizeof(message));
+
+    uint64_t totalAccepted = 0;
+    uint32_t numRejected = 0;
+
+    ScopeTimer timer;
+    for (uint32_t i=0; i<NUM_MESSAGES; ++i)
+    {
+        for (auto id : fastConnections)
+        {
+            if (server.m_server.send(id, message, sizeof(message)))
+                totalAccepted += sizeof(message);
+            else
+                numRejected += 1;
+        }
+
+        for (auto id : slowConnections)
+            if (!server.m_server.send(id, message, sizeof(message)))
+                numRejected += 1;
+    }
+
+    const auto sendTime = timer.milisecondsElapsed();
+
+    // wait for the fast readers to get everything that was accepted for them
+    while (totalReceived.load() < totalAccepted && timer.milisecondsElapsed() < 60000)
+        Sleep(1);
+
+    const auto totalTime = timer.milisecondsElapsed();
+    stopFlag.exchange(1);
+    for (auto& thread : readerThreads)
+        thread.close();
+
+    EXPECT_EQ(totalAccepted, totalReceived.load());
+    TRACE_INFO("Broadcast {} messages of {} bytes to {} fast and {} stalled clients: sent in {}ms, received in {}ms ({}/s per fast client), {} sends rejected",
+        NUM_MESSAGES, MESSAGE_SIZE, NUM_FAST_CLIENTS, NUM_SLOW_CLIENTS, Prec(sendTime, 1), Prec(totalTime, 1),
+        MemSize((totalReceived.load() / NUM_FAST_CLIENTS) / std::max(totalTime / 1000.0, 0.001)), numRejected);
+}
@@ -10,6 +10,8 @@
 #include "tcpSocket.h"
 #include "address.h"
 
+#include "base/containers/include/inplaceArray.h"
+
 #if defined (PLATFORM_WINDOWS)
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -17,6 +19,7 @@
 typedef int socklen_t;
 #else
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
@@ -340,6 +343,66 @@ namespace base
                 return bytesSent;
             }
 
+            int RawSocket::send(const BlockPart* parts, uint32_t numParts)
+            {
+                if (m_socket == SocketInvalid)
+                {
+                    TRACE_ERROR("send() called on bad socket");
+                    return false;
+                }
+
+    #if defined (PLATFORM_WINDOWS)
+                InplaceArray<WSABUF, 64> buffers;
+                buffers.reserve(numParts);
+                for (uint32_t i = 0; i < numParts; ++i)
+                {
+                    auto& buffer = buffers.emplaceBack();
+                    buffer.buf = (CHAR*)parts[i].dataPtr;
+                    buffer.len = parts[i].size;
+                }
+
+                DWORD bytesSent = 0;
+                if (0 != ::WSASend(m_socket, buffers.typedData(), buffers.size(), &bytesSent, 0, nullptr, nullptr))
+                {
+                    int error = GetSocketError();
+                    if (WouldBlock(error))
+                        return 0;
+
+                    TRACE_ERROR("WSASend() failed with error {}", error);
+                    return -1;
+                }
+
+                return (int)bytesSent;
+    #else
+                InplaceArray<iovec, 64> buffers;
+                buffers.reserve(numParts);
+                for (uint32_t i = 0; i < numParts; ++i)
+                {
+                    auto& buffer = buffers.emplaceBack();
+                    buffer.iov_base = (void*)parts[i].dataPtr;
+                    buffer.iov_len = parts[i].size;
+                }
+
+                msghdr message;
+                memzero(&message, sizeof(message));
+                message.msg_iov = buffers.typedData();
+                message.msg_iovlen = buffers.size();
+
+                int bytesSent = (int)::sendmsg(m_socket, &message, MSG_NOSIGNAL);
+                if (bytesSent < 0)
+                {
+                    int error = GetSocketError();
+                    if (WouldBlock(error))
+                        return 0;
+
+                    TRACE_ERROR("sendmsg() failed with error {}", error);
+                    return -1;
+                }
+
+                return bytesSent;
+    #endif
+            }
+
         } // tcp
     } // socket
 } // base
\ No newline at end of file
@@ -74,21 +74,38 @@ namespace base
                     m_blockAllocator = MemNew(BlockAllocator);
                     m_externalBlockAllocator = false;
                 }
+
+                for (auto& entry : m_connectionsIDCache)
+                    entry.store(nullptr);
             }
 
             Endpoint::~Endpoint()
             {
-                if (m_externalBlockAllocator)
+                if (!m_externalBlockAllocator)
                     MemDelete(m_blockAllocator);
 
                 m_externalBlockAllocator = false;
                 m_blockAllocator = nullptr;
             }
 
+            Endpoint::ConnectionAddressCache::ConnectionAddressCache()
+            {
+                memzero(entries, sizeof(entries));
+            }
+
             bool Endpoint::init(const Address& listenAddress)
             {
+                // we can only have multiple receiving sockets if the system can distribute the datagrams between them
+                auto numReceiveThreads = std::max<uint32_t>(1, m_config.numReceiveThreads);
+                if (numReceiveThreads > 1 && !RawSocket::SupportsSharedPort())
+                {
+                    TRACE_WARNING("UDP Endpoint: Port sharing is not supported, using only one receiving thread");
+                    numReceiveThreads = 1;
+                }
+
                 // open socket
-                if (!m_socket.open(listenAddress))
+                Address localAddress;
+                if (!m_socket.open(listenAddress, &localAddress, numReceiveThreads > 1))
                 {
                     TRACE_ERROR("UDP Endpoint error: Failed to create socket at address '{}'", listenAddress);
                     return false;
@@ -118,9 +135,25 @@ namespace base
                     return false;
                 }*/
 
+                // open additional sockets on the same port (in case it was auto assigned)
+                Address sharedAddress;
+                sharedAddress.set(listenAddress.type(), localAddress.port(), listenAddress.address());
+                for (uint32_t i=1; i<numReceiveThreads; ++i)
+                {
+                    auto receiveThread = MemNew(ReceiveThread);
+                    if (!receiveThread->socket.open(sharedAddress, nullptr, true) || !receiveThread->socket.blocking(false))
+                    {
+                        TRACE_ERROR("UDP Endpoint error: Failed to create additional receiving socket at address '{}'", sharedAddress);
+                        MemDelete(receiveThread);
+                        break;
+                    }
+
+                    m_extraReceiveThreads.pushBack(receiveThread);
+                }
+
                 // Create thread processing the data
                 ThreadSetup setup;
-                setup.m_function = [this]() { threadFunc(); };
+                setup.m_function = [this]() { threadFunc(m_socket, true); };
                 setup.m_priority = ThreadPriority::AboveNormal;
                 setup.m_name = "UDOSocketThread";
 
@@ -129,13 +162,34 @@ namespace base
 
                 // Start selector thread
                 m_thread.init(setup);
+
+                // Start the additional receiving threads
+                for (auto receiveThread : m_extraReceiveThreads)
+                {
+                    ThreadSetup receiveSetup;
+                    receiveSetup.m_function = [this, receiveThread]() { threadFunc(receiveThread->socket, false); };
+                    receiveSetup.m_priority = ThreadPriority::AboveNormal;
+                    receiveSetup.m_name = "UDPReceiveThread";
+                    receiveThread->thread.init(receiveSetup);
+                }
+
                 return true;
             }
 
             void Endpoint::close()
             {
                 m_socket.close();
+                for (auto receiveThread : m_extraReceiveThreads)
+                    receiveThread->socket.close();
+
                 m_thread.close();
+                for (auto receiveThread : m_extraReceiveThreads)
+                    receiveThread->thread.close();
+
+                m_extraReceiveThreads.clearPtr();
+
+                for (auto& entry : m_connectionsIDCache)
+                    entry.store(nullptr);
 
                 {
                     auto lock  = CreateLock(m_pendingConnectionsLock);
@@ -171,8 +225,7 @@ namespace base
                 connection->id = id;
                 connection->mtuSize = m_config.maxMtu;
                 connection->nextSequenceNumber = 1;
-                connection->timeoutPoint = NativeTimePoint::Now() + (m_config.connectionTimeoutMs / 1000.0);
-                connection->nextPingPoint = NativeTimePoint::Now() + (m_config.timeoutProbeIntervalMs / 1000.0);
+                refreshConnectionTimeouts(connection);
                 connection->connected = false; // we are not yet confirmed
                 connection->isConnectionInitializer = true;
                 connection->m_stats = ConnectionStats();
@@ -181,9 +234,7 @@ namespace base
                 // add to connection maps - this allows to receive data
                 {
                     auto lock  = CreateLock(m_activeConnectionsLock);
-                    m_activeConnections.pushBack(connection);
-                    m_activeConnectionsIDMap[id] = connection;
-                    m_activeConnectionsAddressMap[address] = connection;
+                    registerConnection(connection);
                 }
 
                 // create a pending connection entry
@@ -247,7 +298,7 @@ namespace base
                 auto lock = CreateLock(m_activeConnectionsLock);
 
                 for (auto con  : m_activeConnections)
-                    if (con->connected && con->nextPingPoint.reached())
+                    if (con->connected && NativeTimePoint(con->nextPingPoint.load()).reached())
                         outArray.pushBack(con);
             }
 
@@ -258,7 +309,7 @@ namespace base
                 auto lock = CreateLock(m_activeConnectionsLock);
 
                 for (auto con  : m_activeConnections)
-                    if (con->connected && con->timeoutPoint.reached())
+                    if (con->connected && NativeTimePoint(con->timeoutPoint.load()).reached())
                         outArray.pushBack(con);
             }
 
@@ -297,7 +348,7 @@ namespace base
                 if (ret == sizeof(pingHeader))
                 {
                     // compute next timeout point
-                    connection->nextPingPoint = NativeTimePoint::Now() + ((double)m_config.timeoutProbeIntervalMs / 1000.0);
+                    connection->nextPingPoint = (NativeTimePoint::Now() + ((double)m_config.timeoutProbeIntervalMs / 1000.0)).rawValue();
                 }
                 else
                 {
@@ -343,66 +394,95 @@ namespace base
                 m_socket.send(&connectionHeader, sizeof(connectionHeader), request->connection->address);
             }
 
-            bool Endpoint::rawReceive()
+            bool Endpoint::rawReceive(RawSocket& socket, Array<Block*>& blocks, Array<ReceivedDatagram>& datagrams, ConnectionAddressCache& addressCache)
             {
-                // preallocate raw data, it's not a packet yet but reserve enough memory in case it's becoming one
-                auto block = m_blockAllocator->alloc(Constants::MAX_DATAGRAM_SIZE + sizeof(Packet) + alignof(Packet));
-                ASSERT(block != nullptr);
-
-                // receive data
-                Address sourceAddress;
-                auto bytesReceived = m_socket.receive(block->data(), Constants::MAX_DATAGRAM_SIZE, &sourceAddress);
-                if (bytesReceived > 0)
+                for (;;)
                 {
-                    // shrink the block to match the actually received data;
-                    block->shrink(0, bytesReceived);
+                    // make sure all slots have memory to receive into, it's not a packet yet but reserve enough memory in case it's becoming one
+                    for (uint32_t i=0; i<blocks.size(); ++i)
+                    {
+                        if (!blocks[i])
+                        {
+                            blocks[i] = m_blockAllocator->alloc(Constants::MAX_DATAGRAM_SIZE + sizeof(Packet) + alignof(Packet));
+                            ASSERT(blocks[i] != nullptr);
 
-                    // get the memory preallocated for the data structure and build it there
-                    void* packetMemory = OffsetPtr(block->data(), bytesReceived);
-                    auto packet  = new (packetMemory) Packet(block, block->data(), sourceAddress);
+                            datagrams[i].data = blocks[i]->data();
+                            datagrams[i].capacity = Constants::MAX_DATAGRAM_SIZE;
+                        }
+                    }
 
-                    // validate
-                    auto expectedPacketSize = packet->calcTotalSize();
-                    if (expectedPacketSize != bytesReceived)
+                    // receive as much as we can in one go
+                    auto numReceived = socket.receive(datagrams.typedData(), datagrams.size());
+                    if (numReceived < 0)
                     {
-                        TRACE_ERROR("UDP endpoint: unexpected packet size '{}' when proper would be '{}'", bytesReceived, expectedPacketSize);
-                        block->release();
+                        TRACE_ERROR("UDP endpoint: fatal error on reading from socket");
                         return false;
                     }
-                    else
+
+                    for (int i=0; i<numReceived; ++i)
                     {
+                        // take the block out of the slot, it will be owned by the packet now
+                        auto block = blocks[i];
+                        auto bytesReceived = datagrams[i].size;
+                        blocks[i] = nullptr;
+
+                        // discard garbage
+                        if (bytesReceived < sizeof(PacketHeader))
+                        {
+                            TRACE_ERROR("UDP endpoint: datagram too small ({}) from '{}'", bytesReceived, datagrams[i].address);
+                            block->release();
+                            continue;
+                        }
+
+                        // shrink the block to match the actually received data;
+                        block->shrink(0, bytesReceived);
+
+                        // get the memory preallocated for the data structure and build it there
+                        void* packetMemory = OffsetPtr(block->data(), bytesReceived);
+                        auto packet  = new (packetMemory) Packet(block, block->data(), datagrams[i].address);
+
+                        // validate
+                        auto expectedPacketSize = packet->calcTotalSize();
+                        if (expectedPacketSize != bytesReceived)
+                        {
+                            TRACE_ERROR("UDP endpoint: unexpected packet size '{}' when proper would be '{}'", bytesReceived, expectedPacketSize);
+                            block->release();
+                            continue;
+                        }
+
                         // ok, do something with data
-                        processReceivedPacket(packet);
-                        return true;
+                        processReceivedPacket(packet, addressCache);
                     }
-                }
-				else if (bytesReceived == 0)
-				{
-					 // data dropped, eventually we will get a timeout
-					return true;
-				}
-                else // fatal error
-                {
-                    TRACE_ERROR("UDP endpoint: fatal error on reading from socket");
-                    block->release();
-                    return false;
+
+                    // socket drained
+                    if (numReceived < (int)datagrams.size())
+                        return true;
                 }
             }
 
-            void Endpoint::threadFunc()
+            void Endpoint::threadFunc(RawSocket& socket, bool mainThread)
             {
-                ASSERT_EX(m_socket, "Accessing invalid socket, race with close()");
-                auto socket = m_socket.systemSocket();
+                ASSERT_EX(socket, "Accessing invalid socket, race with close()");
+                auto systemSocket = socket.systemSocket();
 
                 Selector selector;
                 InplaceArray<Connection*, 100> tempConnections;
 
+                // preallocated memory for the received datagrams
+                const auto batchSize = std::max<uint32_t>(1, m_config.receiveBatchSize);
+                InplaceArray<Block*, 64> receiveBlocks;
+                InplaceArray<ReceivedDatagram, 64> receiveDatagrams;
+                receiveBlocks.resizeWith(batchSize, nullptr);
+                receiveDatagrams.resize(batchSize);
+
+                ConnectionAddressCache addressCache;
+
                 // loop while we don't have any error
                 bool keepRunning = true;
                 while (keepRunning)
                 {
                     // wait for something
-                    switch (selector.wait(SelectorOp::Read, &socket, 1, m_config.timeoutProbeIntervalMs))
+                    switch (selector.wait(SelectorOp::Read, &systemSocket, 1, m_config.timeoutProbeIntervalMs))
                     {
                         // has data
                         case SelectorEvent::Ready:
@@ -416,7 +496,7 @@ namespace base
                                 }
                                 else
                                 {
-                                    if (!rawReceive())
+                                    if (!rawReceive(socket, receiveBlocks, receiveDatagrams, addressCache))
                                         keepRunning = false;
                                 }
                             }
@@ -426,8 +506,11 @@ namespace base
                         // we are busy, probe waiting connections for timeouts and return
                         case SelectorEvent::Busy:
                         {
-                            processPendingConnectionsTimeouts();
-                            processGeneralConnectionsTimeouts(tempConnections);
+                            if (mainThread)
+                            {
+                                processPendingConnectionsTimeouts();
+                                processGeneralConnectionsTimeouts(tempConnections);
+                            }
                             break;
                         }
 
@@ -441,6 +524,11 @@ namespace base
                     }
                 }
 
+                // release memory that was not used
+                for (auto block : receiveBlocks)
+                    if (block)
+                        block->release();
+
                 TRACE_ERROR("UDP endpoint: finished thread for '{}'", m_address);
             }
 
@@ -534,20 +622,58 @@ namespace base
                     }
                     else
                     {
-                        TRACE_INFO("UDP Endpoint: sent '{}' bytes to '{}'", size, destinationAddress);
+                        TRACE_SPAM("UDP Endpoint: sent '{}' bytes to '{}'", size, destinationAddress);
+                        break;
+                    }
+                }
+            }
+
+            void Endpoint::rawSend(const SentDatagram* datagrams, uint32_t numDatagrams)
+            {
+                while (numDatagrams > 0)
+                {
+                    auto ret = m_socket.send(datagrams, numDatagrams);
+                    if (ret == 0)
+                    {
+                        TRACE_WARNING("UDP Endpoint: sending buffer full");
+                        Sleep(1);
+                        continue;
+                    }
+                    else if (ret < 0)
+                    {
+                        TRACE_WARNING("UDP Endpoint: sending error");
                         break;
                     }
+
+                    datagrams += ret;
+                    numDatagrams -= ret;
                 }
             }
 
+            void Endpoint::registerConnection(Connection* connection)
+            {
+                m_activeConnections.pushBack(connection);
+                m_activeConnectionsIDMap[connection->id] = connection;
+                m_activeConnectionsAddressMap[connection->address] = connection;
+
+                // publish for the lock-less lookup, the connection is fully set up at this point
+                m_connectionsIDCache[connection->id % CONNECTION_CACHE_SIZE].store(connection);
+            }
+
             Endpoint::Connection* Endpoint::findConnection(ConnectionID id)
             {
-                auto lock = CreateLock(m_activeConnectionsLock);
+                // in most cases the connection is in the cache
+                auto con = m_connectionsIDCache[id % CONNECTION_CACHE_SIZE].load();
+                if (!con || con->id != id)
+                {
+                    auto lock = CreateLock(m_activeConnectionsLock);
 
-                Connection* con = nullptr;
-                if (m_activeConnectionsIDMap.find(id, con))
-                    if (con->connected)
-                        return con;
+                    con = nullptr;
+                    m_activeConnectionsIDMap.find(id, con);
+                }
+
+                if (con && con->connected)
+                    return con;
 
                 return nullptr;
             }
@@ -561,7 +687,11 @@ namespace base
 
             bool Endpoint::send(ConnectionID id, const Array<BlockPart>& blocks)
             {
-                uint8_t mtuBuffer[Constants::MAX_MTU];
+                // fragments are sent in batches with a single system call
+                static const uint32_t MAX_SEND_BATCH = 8;
+                uint8_t batchBuffer[MAX_SEND_BATCH][Constants::MAX_MTU];
+                SentDatagram batchDatagrams[MAX_SEND_BATCH];
+                uint32_t batchSize = 0;
 
                 // get target address for connection
                 auto connection  = findConnection(id);
@@ -582,6 +712,7 @@ namespace base
                 {
                     auto left = reader.size() - reader.pos();
                     auto writeSize = std::min<uint32_t>(left, maxDataPacketSize);
+                    auto mtuBuffer = batchBuffer[batchSize];
 
                     // prepare header
                     auto header = (PacketHeader *) (mtuBuffer + 0);
@@ -600,10 +731,20 @@ namespace base
                     auto payload = (DataPacketHeader *) (mtuBuffer + sizeof(PacketHeader) + sizeof(DataPacketHeader));
                     reader.read(payload, writeSize);
 
-                    // send via low level socket
+                    // add to batch
                     auto totalSize = writeSize + sizeof(PacketHeader) + sizeof(DataPacketHeader);
                     ASSERT(totalSize <= Constants::MAX_DATAGRAM_SIZE);
-                    rawSend(mtuBuffer, totalSize, connection->address);
+                    auto& datagram = batchDatagrams[batchSize++];
+                    datagram.data = mtuBuffer;
+                    datagram.size = totalSize;
+                    datagram.address = &connection->address;
+
+                    // send via low level socket
+                    if (batchSize == MAX_SEND_BATCH || reader.pos() == reader.size())
+                    {
+                        rawSend(batchDatagrams, batchSize);
+                        batchSize = 0;
+                    }
 
                     // stats
                     connection->m_stats.numPacketsSent += 1;
@@ -728,7 +869,7 @@ namespace base
                 // new sequence
                 if (header.sequenceNumber > connection->maxReceivedSequenceID)
                 {
-                    TRACE_INFO("Received new seqence {} > {} from '{}'", header.sequenceNumber, connection->maxReceivedSequenceID, connection->address);
+                    TRACE_SPAM("Received new seqence {} > {} from '{}'", header.sequenceNumber, connection->maxReceivedSequenceID, connection->address);
                     connection->maxReceivedSequenceID = header.sequenceNumber;
                     cleanFragments(connection, true);
                 }
@@ -737,7 +878,7 @@ namespace base
                 ASSERT(header.sequenceNumber == connection->maxReceivedSequenceID);
                 if (header.dataSize == header.totalSize)
                 {
-                    TRACE_INFO("Single piece fragment {}, size {}", connection->maxReceivedSequenceID, header.totalSize);
+                    TRACE_SPAM("Single piece fragment {}, size {}", connection->maxReceivedSequenceID, header.totalSize);
                     m_handler->handleConnectionData(this, connection->address, connection->id, packet->mutateToBlock());
 
                     connection->m_stats.numDataPacketsReceived += 1;
@@ -746,7 +887,7 @@ namespace base
                 // multi part
                 else if (header.dataSize < header.totalSize)
                 {
-                    TRACE_INFO("Multi piece fragment {}, size {} of ({}), index {}", connection->maxReceivedSequenceID, header.dataSize, header.totalSize, header.fragmentIndex);
+                    TRACE_SPAM("Multi piece fragment {}, size {} of ({}), index {}", connection->maxReceivedSequenceID, header.dataSize, header.totalSize, header.fragmentIndex);
 
                     // prepare fragment list
                     if (connection->receivedFragments.empty())
@@ -831,11 +972,27 @@ namespace base
                 packet->release();
             }
 
-            void Endpoint::processReceivedPacket(Packet* packet)
+            void Endpoint::refreshConnectionTimeouts(Connection* connection)
             {
-                // NOTE: we may get another connection request even though we already
+                const auto now = NativeTimePoint::Now();
+                connection->timeoutPoint = (now + (m_config.connectionTimeoutMs / 1000.0)).rawValue();
+                connection->nextPingPoint = (now + (m_config.timeoutProbeIntervalMs / 1000.0)).rawValue();
+            }
+
+            void Endpoint::processReceivedPacket(Packet* packet, ConnectionAddressCache& addressCache)
+            {
+                // most packets come from known connections, address -> connection mapping never changes so we can skip the locking for them
                 Connection* connection = nullptr;
+                auto& cachedConnection = addressCache.entries[Address::CalcHash(packet->address()) % ConnectionAddressCache::SIZE];
+                if (cachedConnection && cachedConnection->address == packet->address())
                 {
+                    // we just got a message, update out timeouts, they are atomic so it's safe to do it without the lock
+                    connection = cachedConnection;
+                    refreshConnectionTimeouts(connection);
+                }
+                else
+                {
+                    // NOTE: we may get another connection request even though we already
                     auto lock = CreateLock(m_activeConnectionsLock);
                     if (!m_activeConnectionsAddressMap.find(packet->address(), connection))
                     {
@@ -843,23 +1000,21 @@ namespace base
 
                         // crate connection entry
                         connection = MemNew(Connection);
-                        connection->timeoutPoint = NativeTimePoint::Now() + (m_config.connectionTimeoutMs / 1000.0);
-                        connection->nextPingPoint = NativeTimePoint::Now() + (m_config.timeoutProbeIntervalMs / 1000.0);
+                        refreshConnectionTimeouts(connection);
                         connection->mtuSize = m_config.maxMtu;
                         connection->address = packet->address();
                         connection->id = ++m_nextConnectionID;
                         connection->connected = false; // we are not yet confirmed
 
-                        m_activeConnections.pushBack(connection);
-                        m_activeConnectionsIDMap[connection->id] = connection;
-                        m_activeConnectionsAddressMap[connection->address] = connection;
+                        registerConnection(connection);
                     }
                     else
                     {
                         // we just got a message, update out timeouts
-                        connection->timeoutPoint = NativeTimePoint::Now() + (m_config.connectionTimeoutMs / 1000.0);
-                        connection->nextPingPoint = NativeTimePoint::Now() + (m_config.timeoutProbeIntervalMs / 1000.0);
+                        refreshConnectionTimeouts(connection);
                     }
+
+                    cachedConnection = connection;
                 }
 
                 // stats
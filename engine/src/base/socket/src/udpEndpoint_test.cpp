@@ -22,6 +22,7 @@ using namespace socket;
 
 #include "base/test/include/gtest/gtest.h"
 #include "base/system/include/thread.h"
+#include "base/system/include/timedScope.h"
 
 DECLARE_TEST_FILE(NetEndPoint);
 
@@ -809,3 +810,99 @@ TEST(UDPEndpointTest, Endpoint_Connect_OldSocketReusable)
     closedClientConnectionID = 0;
     closedServerConnectionID = 0;
 }
+
+//--
+
+// minimal handler that only counts the packets, used for measuring the raw throughput
+class CountingEndpoint : public socket::udp::IEndpointHandler
+{
+public:
+    CountingEndpoint(const socket::udp::EndpointConfig& config)
+        : m_endpoint(this, config)
+        , m_connectionID(0)
+        , m_numReceived(0)
+    {
+        m_address = socket::Address::Local4(EndpointTest::m_portBase++);
+    }
+
+    ~CountingEndpoint()
+    {
+        m_endpoint.close();
+    }
+
+    virtual void handleConnectionSucceeded(socket::udp::Endpoint* endpoint, const socket::Address& address, socket::ConnectionID connection) override
+    {
+        m_connectionID = connection;
+    }
+
+    virtual void handleConnectionClosed(socket::udp::Endpoint* endpoint, const socket::Address& address, socket::ConnectionID connection) override
+    {}
+
+    virtual void handleConnectionRequest(socket::udp::Endpoint* endpoint, const socket::Address& address, socket::ConnectionID connection) override
+    {
+        m_connectionID = connection;
+    }
+
+    virtual void handleConnectionData(socket::udp::Endpoint* endpoint, const socket::Address& address, socket::ConnectionID connection, socket::Block* dataPayload) override
+    {
+        m_numReceived += 1;
+        dataPayload->release();
+    }
+
+    virtual void handleEndpointError(socket::udp::Endpoint* endpoint) override
+    {}
+
+    socket::udp::Endpoint m_endpoint;
+    socket::Address m_address;
+
+    std::atomic<socket::ConnectionID> m_connectionID;
+    std::atomic<uint32_t> m_numReceived;
+};
+
+TEST(UDPEndpointTest, DISABLED_Endpoint_PacketsPerSecond)
+{
+    static const uint32_t NUM_PACKETS = 500000;
+    static const uint32_t PACKET_SIZE = 64;
+
+    for (uint32_t batchSize : { 1, 32 })
+    {
+        auto config = GetConfigForTesting();
+        config.receiveBatchSize = batchSize;
+
+        CountingEndpoint serverEndpoint(config);
+        CountingEndpoint clientEndpoint(config);
+        ASSERT_TRUE(serverEndpoint.m_endpoint.init(serverEndpoint.m_address));
+        ASSERT_TRUE(clientEndpoint.m_endpoint.init(clientEndpoint.m_address));
+
+        clientEndpoint.m_endpoint.connect(serverEndpoint.m_address);
+        {
+            Waiter waiter(1000);
+            while ((!serverEndpoint.m_connectionID || !clientEndpoint.m_connectionID) && waiter.wait(10)) {};
+        }
+        ASSERT_NE(0, clientEndpoint.m_connectionID.load());
+
+        uint8_t sendData[PACKET_SIZE];
+        memset(sendData, 0x55, sizeof(sendData));
+
+        ScopeTimer timer;
+        for (uint32_t i=0; i<NUM_PACKETS; ++i)
+            clientEndpoint.m_endpoint.send(clientEndpoint.m_connectionID, socket::BlockPart(sendData, sizeof(sendData)));
+
+        // wait until everything arrives or nothing more arrives (UDP may drop packets)
+        auto lastReceived = serverEndpoint.m_numReceived.load();
+        auto time = timer.timeElapsed();
+        while (lastReceived < NUM_PACKETS)
+        {
+            Sleep(10);
+
+            auto numReceived = serverEndpoint.m_numReceived.load();
+            if (numReceived == lastReceived)
+                break;
+
+            lastReceived = numReceived;
+            time = timer.timeElapsed();
+        }
+
+        TRACE_INFO("Receive batch {}: {} of {} packets received in {} ({} packets/s)", batchSize, lastReceived, NUM_PACKETS, TimeInterval(time), (uint64_t)(lastReceived / std::max(time, 0.001)));
+    }
+}
@@ -10,6 +10,8 @@
 #include "udpSocket.h"
 #include "address.h"
 
+#include "base/containers/include/inplaceArray.h"
+
 #if defined (PLATFORM_WINDOWS)
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -17,6 +19,7 @@
 typedef int socklen_t;
 #else
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
@@ -72,10 +75,41 @@ namespace base
                 }
             }
 
+            static socklen_t addressToSocketAddress(const Address& address, bool ipv6, sockaddr_storage* outAddress)
+            {
+                memzero(outAddress, sizeof(sockaddr_storage));
+
+                if (ipv6)
+                {
+                    auto socketAddress = reinterpret_cast<sockaddr_in6 *>(outAddress);
+                    socketAddress->sin6_family = AF_INET6;
+                    socketAddress->sin6_port = htons(address.port());
+                    addressToNetwork6(address, &socketAddress->sin6_addr);
+                    return sizeof(sockaddr_in6);
+                }
+                else
+                {
+                    auto socketAddress = reinterpret_cast<sockaddr_in *>(outAddress);
+                    socketAddress->sin_family = AF_INET;
+                    socketAddress->sin_port = htons(address.port());
+                    addressToNetwork(address, &socketAddress->sin_addr);
+                    return sizeof(sockaddr_in);
+                }
+            }
+
             RawSocket::RawSocket()
             {}
 
-            bool RawSocket::open(const Address& address, Address* outLocalAddress)
+            bool RawSocket::SupportsSharedPort()
+            {
+    #if defined(SO_REUSEPORT)
+                return true;
+    #else
+                return false;
+    #endif
+            }
+
+            bool RawSocket::open(const Address& address, Address* outLocalAddress, bool sharedPort)
             {
                 m_ipv6 = address.type() == AddressType::AddressIPv6;
                 m_socket = ::socket(m_ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, IPPROTO_UDP);
@@ -86,6 +120,23 @@ namespace base
                     return false;
                 }
 
+                if (sharedPort)
+                {
+    #if defined(SO_REUSEPORT)
+                    int enable = 1;
+                    if (setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0)
+                    {
+                        TRACE_ERROR("Failed to enable port sharing with error {}", GetSocketError());
+                        close();
+                        return false;
+                    }
+    #else
+                    TRACE_ERROR("Port sharing is not supported on this platform");
+                    close();
+                    return false;
+    #endif
+                }
+
                 sockaddr* listenAddress = nullptr;
                 int listenAddressSize = 0;
 
@@ -218,6 +269,125 @@ namespace base
                 return bytesSent;
             }
 
+            int RawSocket::receive(ReceivedDatagram* datagrams, uint32_t maxDatagrams)
+            {
+    #if defined(PLATFORM_LINUX)
+                InplaceArray<mmsghdr, 64> messages;
+                InplaceArray<iovec, 64> buffers;
+                InplaceArray<sockaddr_storage, 64> addresses;
+                messages.resize(maxDatagrams);
+                buffers.resize(maxDatagrams);
+                addresses.resize(maxDatagrams);
+
+                for (uint32_t i=0; i<maxDatagrams; ++i)
+                {
+                    buffers[i].iov_base = datagrams[i].data;
+                    buffers[i].iov_len = datagrams[i].capacity;
+
+                    memzero(&messages[i], sizeof(mmsghdr));
+                    messages[i].msg_hdr.msg_iov = &buffers[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                    messages[i].msg_hdr.msg_name = &addresses[i];
+                    messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+                }
+
+                int numReceived = recvmmsg(m_socket, messages.typedData(), maxDatagrams, MSG_DONTWAIT, nullptr);
+                if (numReceived < 0)
+                {
+                    int error = GetSocketError();
+                    if (WouldBlock(error))
+                        return 0;
+
+                    if (PortUnreachable(error))
+                    {
+                        TRACE_ERROR("Previously sent UDP datagram was dropped by recipient because the port was unreachable");
+                        return 0;
+                    }
+
+                    TRACE_ERROR("recvmmsg() failed with error {}", error);
+                    return -1;
+                }
+
+                for (int i=0; i<numReceived; ++i)
+                {
+                    datagrams[i].size = messages[i].msg_len;
+                    networkToAddress(reinterpret_cast<const sockaddr *>(&addresses[i]), &datagrams[i].address);
+                }
+
+                return numReceived;
+    #else
+                // no batched receive, read one datagram at a time until there's nothing more
+                uint32_t numReceived = 0;
+                while (numReceived < maxDatagrams)
+                {
+                    auto& datagram = datagrams[numReceived];
+                    auto bytesReceived = receive(datagram.data, datagram.capacity, &datagram.address);
+                    if (bytesReceived < 0)
+                        return numReceived ? numReceived : -1;
+                    else if (bytesReceived == 0)
+                        break;
+
+                    datagram.size = bytesReceived;
+                    numReceived += 1;
+                }
+
+                return numReceived;
+    #endif
+            }
+
+            int RawSocket::send(const SentDatagram* datagrams, uint32_t numDatagrams)
+            {
+    #if defined(PLATFORM_LINUX)
+                InplaceArray<mmsghdr, 64> messages;
+                InplaceArray<iovec, 64> buffers;
+                InplaceArray<sockaddr_storage, 64> addresses;
+                messages.resize(numDatagrams);
+                buffers.resize(numDatagrams);
+                addresses.resize(numDatagrams);
+
+                for (uint32_t i=0; i<numDatagrams; ++i)
+                {
+                    buffers[i].iov_base = (void*)datagrams[i].data;
+                    buffers[i].iov_len = datagrams[i].size;
+
+                    memzero(&messages[i], sizeof(mmsghdr));
+                    messages[i].msg_hdr.msg_iov = &buffers[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                    messages[i].msg_hdr.msg_name = &addresses[i];
+                    messages[i].msg_hdr.msg_namelen = addressToSocketAddress(*datagrams[i].address, m_ipv6, &addresses[i]);
+                }
+
+                int numSent = sendmmsg(m_socket, messages.typedData(), numDatagrams, 0);
+                if (numSent < 0)
+                {
+                    int error = GetSocketError();
+                    if (WouldBlock(error))
+                        return 0;
+
+                    TRACE_ERROR("sendmmsg() failed with error {}", error);
+                    return -1;
+                }
+
+                return numSent;
+    #else
+                // no batched send, send one datagram at a time until the buffer is full
+                uint32_t numSent = 0;
+                while (numSent < numDatagrams)
+                {
+                    const auto& datagram = datagrams[numSent];
+                    auto bytesSent = send(datagram.data, datagram.size, *datagram.address);
+                    if (bytesSent < 0)
+                        return numSent ? numSent : -1;
+                    else if (bytesSent == 0)
+                        break;
+
+                    numSent += 1;
+                }
+
+                return numSent;
+    #endif
+            }
+
             bool RawSocket::allowFragmentation(bool allowFragmentation)
             {
     #if defined(PLATFORM_WINDOWS)
@@ -232,7 +402,7 @@ namespace base
     #if defined(IPDONTFRAG)
                 if (!m_ipv6)
                 {
-                    if (setsockopt(rawSocket, IPPROTO_IP, IP_DONTFRAG, &doNotFragment, sizeof(doNotFragment)) != 0)
+                    if (setsockopt(m_socket, IPPROTO_IP, IP_DONTFRAG, &doNotFragment, sizeof(doNotFragment)) != 0)
                     {
                         TRACE_ERROR(TempString("Failed to change IP-level fragmentation policy with error {}", GetSocketError()));
                         return false;
@@ -242,7 +412,7 @@ namespace base
     #if defined(IPV6_DONTFRAG)
                 if (m_ipv6)
                 {
-                    if (setsockopt(rawSocket, IPPROTO_IP, IPV6_DONTFRAG, &doNotFragment, sizeof(doNotFragment)) != 0)
+                    if (setsockopt(m_socket, IPPROTO_IPV6, IPV6_DONTFRAG, &doNotFragment, sizeof(doNotFragment)) != 0)
                     {
                         TRACE_ERROR(TempString("Failed to change IP-level fragmentation policy with error {}", GetSocketError()));
                         return false;
@@ -268,13 +438,13 @@ namespace base
                     return false;
                 }
     #else
-                if (setsockopt(rawSocket, SOL_SOCKET, SO_SNDBUF, &sendBufferBytes, sizeof(sendBufferBytes)) != 0)
+                if (setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, &sendBufferBytes, sizeof(sendBufferBytes)) != 0)
                 {
                     TRACE_ERROR(TempString("Failed to change send buffer size with error {}", GetSocketError()));
                     return false;
                 }
 
-                if (setsockopt(rawSocket, SOL_SOCKET, SO_RCVBUF, &receiveBufferBytes, sizeof(receiveBufferBytes)) != 0)
+                if (setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &receiveBufferBytes, sizeof(receiveBufferBytes)) != 0)
                 {
                     TRACE_ERROR(TempString("Failed to change receive buffer size with error {}", GetSocketError()));
                     return false;
@@ -11,6 +11,8 @@
 #include "address.h"
 #include "udpSocket.h"
 
+#include "base/system/include/thread.h"
+
 DECLARE_TEST_FILE(NewUdpSocket);
 
 using namespace base;
@@ -41,6 +43,73 @@ TEST(Socket, UdpSocket_IPv4SimpleSendReceive_Local)
     ASSERT_EQ(senderAddress, receiveAddress);
 }
 
+TEST(Socket, UdpSocket_IPv4BatchSendReceive_Local)
+{
+    static const uint32_t NUM_DATAGRAMS = 48; // more than a single receive batch below
+    static const uint32_t RECEIVE_BATCH_SIZE = 16;
+    static const uint32_t MAX_DATAGRAM_SIZE = 1024;
+
+    socket::Address senderAddress(socket::Address::Local4(1339));
+    socket::Address receiverAddress(socket::Address::Local4(1340));
+
+    socket::udp::RawSocket sender;
+    ASSERT_TRUE(sender.open(senderAddress));
+
+    socket::udp::RawSocket receiver;
+    ASSERT_TRUE(receiver.open(receiverAddress));
+
+    // each datagram has different size and is filled with its index
+    uint8_t payloads[NUM_DATAGRAMS][MAX_DATAGRAM_SIZE];
+    socket::udp::SentDatagram sent[NUM_DATAGRAMS];
+    for (uint32_t i = 0; i < NUM_DATAGRAMS; ++i)
+    {
+        memset(payloads[i], (uint8_t)(i + 1), MAX_DATAGRAM_SIZE);
+        sent[i].data = payloads[i];
+        sent[i].size = 1 + (i * 37) % MAX_DATAGRAM_SIZE;
+        sent[i].address = &receiverAddress;
+    }
+
+    // send buffer may take less than we asked for
+    uint32_t numSent = 0;
+    for (uint32_t retry = 0; numSent < NUM_DATAGRAMS && retry < 1000; ++retry)
+    {
+        auto count = sender.send(sent + numSent, NUM_DATAGRAMS - numSent);
+        ASSERT_LE(0, count);
+        numSent += count;
+    }
+    ASSERT_EQ(NUM_DATAGRAMS, numSent);
+
+    // receive in batches, datagrams on loopback should arrive complete and in order
+    uint8_t receiveBuffers[RECEIVE_BATCH_SIZE][MAX_DATAGRAM_SIZE];
+    uint32_t numReceived = 0;
+    for (uint32_t retry = 0; numReceived < NUM_DATAGRAMS && retry < 1000; ++retry)
+    {
+        socket::udp::ReceivedDatagram received[RECEIVE_BATCH_SIZE];
+        for (uint32_t i = 0; i < RECEIVE_BATCH_SIZE; ++i)
+        {
+            received[i].data = receiveBuffers[i];
+            received[i].capacity = MAX_DATAGRAM_SIZE;
+        }
+
+        auto count = receiver.receive(received, RECEIVE_BATCH_SIZE);
+        ASSERT_LE(0, count);
+        if (count == 0)
+        {
+            Sleep(1);
+            continue;
+        }
+
+        for (int i = 0; i < count; ++i, ++numReceived)
+        {
+            ASSERT_EQ(sent[numReceived].size, received[i].size);
+            ASSERT_EQ(0, memcmp(payloads[numReceived], received[i].data, received[i].size));
+            ASSERT_EQ(senderAddress, received[i].address);
+        }
+    }
+
+    ASSERT_EQ(NUM_DATAGRAMS, numReceived);
+}
+
 #if !defined(FUCKED_UP_NETSTACK)
 TEST(Network, UdpSocket_IPv6SimpleSendReceive_Local)
 {
@@ -0,0 +1,176 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "base/io/include/ioSystem.h"
+
+namespace base
+{
+    namespace storage
+    {
+
+        ///-------------
+
+        /// type of values stored in a column
+        enum class ColumnType : uint8_t
+        {
+            Int = 0, // int32_t
+            Float = 1, // float
+            Bool = 2, // uint8_t
+            String = 3, // uint32_t offset of the interned string in the string pool
+        };
+
+        /// read only table with typed columns, stored as a single flat blob that is used directly without any parsing
+        /// the blob is usually memory mapped straight from the cooked file so only the pages we touch are ever loaded
+        /// NOTE: the section ranges, the key index and all string references are validated when binding, the values themselves are trusted
+        class BASE_STORAGE_API ColumnTable
+        {
+        public:
+            static const uint32_t FILE_MAGIC = 0x54433456; // 'V4CT'
+            static const uint32_t FILE_VERSION = 1;
+
+#pragma pack(push)
+#pragma pack(4)
+            struct Header
+            {
+                uint32_t magic = FILE_MAGIC;
+                uint32_t version = FILE_VERSION;
+                uint32_t totalSize = 0; // size of the whole blob
+                uint32_t numRows = 0;
+                uint32_t numColumns = 0; // column infos follow the header
+                uint32_t keyColumn = INDEX_MAX; // column with unique values we can look the rows up by, INDEX_MAX if not indexed
+                uint32_t numKeyBuckets = 0; // size of the key index, always a power of two
+                uint32_t keyIndexOffset = 0; // offset to the key index (uint32_t row index per bucket, INDEX_MAX for empty bucket)
+                uint32_t stringPoolOffset = 0; // offset to the interned strings
+                uint32_t stringPoolSize = 0;
+                uint64_t contentHash = 0; // hash of the content, can be used to detect changes
+            };
+
+            struct ColumnInfo
+            {
+                uint32_t nameOffset = 0; // offset of the column name in the string pool
+                uint32_t dataOffset = 0; // offset to the array of numRows values, aligned to 8 bytes
+                ColumnType type = ColumnType::Int;
+                uint8_t padding[3] = { 0,0,0 };
+            };
+#pragma pack(pop)
+
+            //--
+
+            ColumnTable();
+            ColumnTable(const ColumnTable& other) = default;
+            ColumnTable(ColumnTable&& other);
+            ColumnTable& operator=(const ColumnTable& other) = default;
+            ColumnTable& operator=(ColumnTable&& other);
+
+            // is this an empty table ?
+            INLINE bool empty() const { return m_header == nullptr; }
+
+            // get the blob with the data, shared (not copied) when the table is copied
+            INLINE const Buffer& data() const { return m_data; }
+
+            // get number of rows in the table
+            INLINE uint32_t numRows() const { return m_header ? m_header->numRows : 0; }
+
+            // get number of columns in the table
+            INLINE uint32_t numColumns() const { return m_header ? m_header->numColumns : 0; }
+
+            // get the column the rows are indexed by, INDEX_MAX if there's none
+            INLINE uint32_t keyColumn() const { return m_header ? m_header->keyColumn : INDEX_MAX; }
+
+            // get hash of the content in this table
+            INLINE uint64_t contentHash() const { return m_header ? m_header->contentHash : 0; }
+
+            // get type of values in given column
+            INLINE ColumnType columnType(uint32_t column) const { return columnInfo(column).type; }
+
+            // get name of given column
+            INLINE StringView<char> columnName(uint32_t column) const { return pooledString(columnInfo(column).nameOffset); }
+
+            //--
+
+            // find column by name, returns INDEX_MAX if not found
+            uint32_t findColumn(StringView<char> name) const;
+
+            // find row by the value in the key column, returns INDEX_MAX if not found
+            uint32_t findRow(StringView<char> key) const;
+            uint32_t findRow(int key) const;
+
+            //--
+
+            // get the raw typed array of the column values, type must match
+            INLINE const int* intColumn(uint32_t column) const { return (const int*)columnData(column, ColumnType::Int); }
+            INLINE const float* floatColumn(uint32_t column) const { return (const float*)columnData(column, ColumnType::Float); }
+            INLINE const uint8_t* boolColumn(uint32_t column) const { return (const uint8_t*)columnData(column, ColumnType::Bool); }
+            INLINE const uint32_t* stringColumn(uint32_t column) const { return (const uint32_t*)columnData(column, ColumnType::String); }
+
+            // get value from given cell, type of the column must match
+            INLINE int intValue(uint32_t row, uint32_t column) const { return intColumn(column)[checkRow(row)]; }
+            INLINE float floatValue(uint32_t row, uint32_t column) const { return floatColumn(column)[checkRow(row)]; }
+            INLINE bool boolValue(uint32_t row, uint32_t column) const { return 0 != boolColumn(column)[checkRow(row)]; }
+            INLINE StringView<char> stringValue(uint32_t row, uint32_t column) const { return pooledString(stringColumn(column)[checkRow(row)]); }
+
+            // get interned string from the string pool
+            // NOTE: the text is zero terminated and the view is valid as long as the table data is alive
+            INLINE StringView<char> pooledString(uint32_t offset) const
+            {
+                ASSERT_EX(offset + sizeof(uint32_t) <= m_header->stringPoolSize, "String offset outside the pool");
+                auto* entry = (const uint32_t*)(m_stringPool + offset);
+                auto* text = (const char*)(entry + 1);
+                return StringView<char>(text, text + *entry);
+            }
+
+            //--
+
+            // bind table to the cooked blob, the data is not copied
+            // NOTE: fails if the blob is not a valid table, the table is left empty in that case
+            bool bind(const Buffer& data);
+
+            // open cooked table file by memory mapping it, the file content is used directly
+            bool openMapped(io::AbsolutePathView absoluteFilePath);
+
+            // release the data
+            void reset();
+
+            //--
+
+            // hash of the key as used by the key index, stable between runs
+            static uint32_t CalcKeyHash(StringView<char> key);
+            static uint32_t CalcKeyHash(int key);
+
+        private:
+            Buffer m_data;
+
+            const Header* m_header = nullptr;
+            const ColumnInfo* m_columns = nullptr;
+            const uint8_t* m_stringPool = nullptr;
+            const uint32_t* m_keyIndex = nullptr;
+
+            INLINE const ColumnInfo& columnInfo(uint32_t column) const
+            {
+                ASSERT_EX(column < numColumns(), "Invalid column index");
+                return m_columns[column];
+            }
+
+            INLINE const void* columnData(uint32_t column, ColumnType type) const
+            {
+                const auto& info = columnInfo(column);
+                ASSERT_EX(info.type == type, "Column type mismatch");
+                return m_data.data() + info.dataOffset;
+            }
+
+            INLINE uint32_t checkRow(uint32_t row) const
+            {
+                ASSERT_EX(row < m_header->numRows, "Invalid row index");
+                return row;
+            }
+        };
+
+        ///-------------
+
+    } // storage
+} // base
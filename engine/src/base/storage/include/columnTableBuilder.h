@@ -0,0 +1,92 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "columnTable.h"
+#include "base/containers/include/hashMap.h"
+
+namespace base
+{
+    namespace storage
+    {
+
+        ///-------------
+
+        /// helper class to build the cooked blob of the ColumnTable
+        /// NOTE: strings are interned as they are added so repeated values are stored only once
+        class BASE_STORAGE_API ColumnTableBuilder : public NoCopy
+        {
+        public:
+            ColumnTableBuilder();
+
+            // clear existing content, allows to build another table
+            void clear();
+
+            //--
+
+            // get number of rows added so far
+            INLINE uint32_t numRows() const { return m_numRows; }
+
+            // get number of columns
+            INLINE uint32_t numColumns() const { return m_columns.size(); }
+
+            // find column by name, returns INDEX_MAX if not found
+            uint32_t findColumn(StringView<char> name) const;
+
+            //--
+
+            // add a column, all existing rows get the default value (0, false or empty string)
+            // NOTE: fails (returns INDEX_MAX) if the name is already used
+            uint32_t addColumn(StringView<char> name, ColumnType type);
+
+            // set the column the rows will be indexed by, values in it must be unique
+            // NOTE: only Int and String columns can be indexed
+            bool keyColumn(uint32_t column);
+
+            // add a row with default values, returns its index
+            uint32_t addRow();
+
+            // set value in given cell, type of the column must match
+            void intValue(uint32_t row, uint32_t column, int value);
+            void floatValue(uint32_t row, uint32_t column, float value);
+            void boolValue(uint32_t row, uint32_t column, bool value);
+            void stringValue(uint32_t row, uint32_t column, StringView<char> value);
+
+            // set value in given cell from text, the text is parsed according to the type of the column
+            bool textValue(uint32_t row, uint32_t column, StringView<char> text);
+
+            //--
+
+            /// build the cooked blob, returns empty buffer if the table can't be built (ie. duplicated keys)
+            Buffer build() const;
+
+        private:
+            struct Column
+            {
+                uint32_t name = 0; // offset in string pool
+                ColumnType type = ColumnType::Int;
+                Array<uint32_t> values; // raw 32-bit values, strings are stored as offsets in the pool
+            };
+
+            Array<Column> m_columns;
+            uint32_t m_numRows = 0;
+            uint32_t m_keyColumn = INDEX_MAX;
+
+            Array<uint8_t> m_stringPool;
+            HashMap<uint64_t, uint32_t> m_stringMap;
+
+            uint32_t mapString(StringView<char> str);
+            uint32_t& cell(uint32_t row, uint32_t column, ColumnType type);
+            StringView<char> pooledString(uint32_t offset) const;
+
+            bool buildKeyIndex(uint32_t* buckets, uint32_t numBuckets) const;
+        };
+
+        ///-------------
+
+    } // storage
+} // base
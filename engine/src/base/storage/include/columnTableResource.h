@@ -0,0 +1,41 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "columnTable.h"
+#include "base/resources/include/resource.h"
+#include "base/resources/include/bufferAsync.h"
+
+namespace base
+{
+    namespace storage
+    {
+
+        /// resource with cooked column table, the loaded blob is used directly as the table's data
+        /// NOTE: the blob is stored as a buffer of the cooked file, when loaded from a file on disk the table is bound to the mapped range of the file without copying anything
+        class BASE_STORAGE_API ColumnTableResource : public res::IResource
+        {
+            RTTI_DECLARE_VIRTUAL_CLASS(ColumnTableResource, res::IResource);
+
+        public:
+            ColumnTableResource();
+            ColumnTableResource(const Buffer& cookedData);
+
+            // get the table
+            INLINE const ColumnTable& table() const { return m_table; }
+
+            virtual uint64_t calcResourceMemorySize() const override;
+
+        private:
+            res::AsyncBuffer m_data;
+            ColumnTable m_table;
+
+            virtual void onPostLoad() override;
+        };
+
+    } // storage
+} // base
@@ -26,6 +26,13 @@ namespace base
         class TableBuilder;
         class TableEntry;
 
+        class ColumnTable;
+        class ColumnTableBuilder;
+
+        class ColumnTableResource;
+        typedef RefPtr<ColumnTableResource> ColumnTableResourcePtr;
+        typedef res::Ref<ColumnTableResource> ColumnTableResourceRef;
+
         typedef std::function<bool(const TableEntry & child)> TTableArrayIterator;
         typedef std::function<bool(const char * key, const TableEntry& child)> TTableIterator;
 
@@ -0,0 +1,295 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "columnTable.h"
+
+namespace base
+{
+    namespace storage
+    {
+
+        //--
+
+        static_assert(sizeof(ColumnTable::Header) == 48, "Header layout is part of the cooked format");
+        static_assert(sizeof(ColumnTable::ColumnInfo) == 12, "Column layout is part of the cooked format");
+
+        static uint32_t ColumnValueSize(ColumnType type)
+        {
+            switch (type)
+            {
+                case ColumnType::Int: return sizeof(int);
+                case ColumnType::Float: return sizeof(float);
+                case ColumnType::Bool: return sizeof(uint8_t);
+                case ColumnType::String: return sizeof(uint32_t);
+            }
+
+            return 0;
+        }
+
+        static bool ValidRange(uint64_t offset, uint64_t size, uint64_t totalSize)
+        {
+            return (offset <= totalSize) && (size <= totalSize - offset);
+        }
+
+        static bool ValidPooledString(const uint8_t* pool, uint32_t poolSize, uint32_t offset)
+        {
+            // length, text and the zero terminator must all fit in the pool
+            if ((offset & 3) || !ValidRange(offset, sizeof(uint32_t), poolSize))
+                return false;
+
+            const auto length = *(const uint32_t*)(pool + offset);
+            if (!ValidRange(offset + sizeof(uint32_t), length + 1ULL, poolSize))
+                return false;
+
+            return pool[offset + sizeof(uint32_t) + length] == 0;
+        }
+
+        //--
+
+        ColumnTable::ColumnTable()
+        {}
+
+        ColumnTable::ColumnTable(ColumnTable&& other)
+            : m_data(std::move(other.m_data))
+            , m_header(other.m_header)
+            , m_columns(other.m_columns)
+            , m_stringPool(other.m_stringPool)
+            , m_keyIndex(other.m_keyIndex)
+        {
+            other.m_header = nullptr;
+            other.m_columns = nullptr;
+            other.m_stringPool = nullptr;
+            other.m_keyIndex = nullptr;
+        }
+
+        ColumnTable& ColumnTable::operator=(ColumnTable&& other)
+        {
+            if (this != &other)
+            {
+                m_data = std::move(other.m_data);
+                m_header = other.m_header;
+                m_columns = other.m_columns;
+                m_stringPool = other.m_stringPool;
+                m_keyIndex = other.m_keyIndex;
+                other.m_header = nullptr;
+                other.m_columns = nullptr;
+                other.m_stringPool = nullptr;
+                other.m_keyIndex = nullptr;
+            }
+
+            return *this;
+        }
+
+        void ColumnTable::reset()
+        {
+            m_data.reset();
+            m_header = nullptr;
+            m_columns = nullptr;
+            m_stringPool = nullptr;
+            m_keyIndex = nullptr;
+        }
+
+        bool ColumnTable::bind(const Buffer& data)
+        {
+            reset();
+
+            if (data.size() < sizeof(Header))
+            {
+                TRACE_ERROR("Data table blob is too small ({})", data.size());
+                return false;
+            }
+
+            // we are accessing everything in place so the alignment must be preserved
+            if ((uint64_t)data.data() & 7)
+            {
+                TRACE_ERROR("Data table blob is not aligned");
+                return false;
+            }
+
+            const auto* header = (const Header*)data.data();
+            if (header->magic != FILE_MAGIC || header->version != FILE_VERSION)
+            {
+                TRACE_ERROR("Data table blob has invalid header or unsupported version {}", header->version);
+                return false;
+            }
+
+            const auto totalSize = header->totalSize;
+            if (totalSize > data.size() || !ValidRange(sizeof(Header), header->numColumns * (uint64_t)sizeof(ColumnInfo), totalSize))
+            {
+                TRACE_ERROR("Data table blob is truncated, expected {}, got {}", totalSize, data.size());
+                return false;
+            }
+
+            // the string pool always starts with the empty string
+            if (header->stringPoolSize < sizeof(uint32_t) || (header->stringPoolOffset & 3) || !ValidRange(header->stringPoolOffset, header->stringPoolSize, totalSize))
+            {
+                TRACE_ERROR("Data table blob has invalid string pool");
+                return false;
+            }
+
+            // columns
+            const auto* stringPool = data.data() + header->stringPoolOffset;
+            const auto* columns = (const ColumnInfo*)(header + 1);
+            for (uint32_t i = 0; i < header->numColumns; ++i)
+            {
+                const auto& column = columns[i];
+
+                const auto valueSize = ColumnValueSize(column.type);
+                if (!valueSize || (column.dataOffset & 7) || !ValidRange(column.dataOffset, header->numRows * (uint64_t)valueSize, totalSize))
+                {
+                    TRACE_ERROR("Data table blob has invalid column {}", i);
+                    return false;
+                }
+
+                if (!ValidPooledString(stringPool, header->stringPoolSize, column.nameOffset))
+                {
+                    TRACE_ERROR("Data table blob has invalid name of column {}", i);
+                    return false;
+                }
+
+                // string cells are read without any checks later
+                if (column.type == ColumnType::String)
+                {
+                    const auto* values = (const uint32_t*)(data.data() + column.dataOffset);
+                    for (uint32_t j = 0; j < header->numRows; ++j)
+                    {
+                        if (!ValidPooledString(stringPool, header->stringPoolSize, values[j]))
+                        {
+                            TRACE_ERROR("Data table blob has invalid string in row {} of column {}", j, i);
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            // key index
+            if (header->keyColumn != INDEX_MAX)
+            {
+                const auto numBuckets = header->numKeyBuckets;
+                if (header->keyColumn >= header->numColumns || !numBuckets || (numBuckets & (numBuckets - 1)) || (header->keyIndexOffset & 3)
+                    || !ValidRange(header->keyIndexOffset, numBuckets * (uint64_t)sizeof(uint32_t), totalSize))
+                {
+                    TRACE_ERROR("Data table blob has invalid key index");
+                    return false;
+                }
+
+                const auto keyType = columns[header->keyColumn].type;
+                if (keyType != ColumnType::Int && keyType != ColumnType::String)
+                {
+                    TRACE_ERROR("Data table blob has key column of type that can't be indexed");
+                    return false;
+                }
+
+                // the lookup uses the rows from the index directly and stops probing at the first empty bucket, make sure there is one
+                const auto* keyIndex = (const uint32_t*)(data.data() + header->keyIndexOffset);
+                uint32_t numEmptyBuckets = 0;
+                for (uint32_t i = 0; i < numBuckets; ++i)
+                {
+                    if (keyIndex[i] == INDEX_MAX)
+                        numEmptyBuckets += 1;
+                    else if (keyIndex[i] >= header->numRows)
+                    {
+                        TRACE_ERROR("Data table blob has invalid row {} in key index bucket {}", keyIndex[i], i);
+                        return false;
+                    }
+                }
+
+                if (!numEmptyBuckets)
+                {
+                    TRACE_ERROR("Data table blob has full key index");
+                    return false;
+                }
+            }
+
+            m_data = data;
+            m_header = header;
+            m_columns = columns;
+            m_stringPool = stringPool;
+            m_keyIndex = (header->keyColumn != INDEX_MAX) ? (const uint32_t*)(data.data() + header->keyIndexOffset) : nullptr;
+            return true;
+        }
+
+        bool ColumnTable::openMapped(io::AbsolutePathView absoluteFilePath)
+        {
+            auto data = IO::GetInstance().openMemoryMappedForReading(absoluteFilePath);
+            if (!data)
+            {
+                reset();
+                return false;
+            }
+
+            return bind(data);
+        }
+
+        //--
+
+        uint32_t ColumnTable::findColumn(StringView<char> name) const
+        {
+            // tables have few columns, no need for anything fancy
+            for (uint32_t i = 0; i < numColumns(); ++i)
+                if (pooledString(m_columns[i].nameOffset) == name)
+                    return i;
+
+            return INDEX_MAX;
+        }
+
+        uint32_t ColumnTable::findRow(StringView<char> key) const
+        {
+            if (!m_keyIndex || m_columns[m_header->keyColumn].type != ColumnType::String)
+                return INDEX_MAX;
+
+            const auto* values = stringColumn(m_header->keyColumn);
+            const auto mask = m_header->numKeyBuckets - 1;
+
+            auto bucket = CalcKeyHash(key) & mask;
+            while (m_keyIndex[bucket] != INDEX_MAX)
+            {
+                const auto row = m_keyIndex[bucket];
+                if (pooledString(values[row]) == key)
+                    return row;
+                bucket = (bucket + 1) & mask;
+            }
+
+            return INDEX_MAX;
+        }
+
+        uint32_t ColumnTable::findRow(int key) const
+        {
+            if (!m_keyIndex || m_columns[m_header->keyColumn].type != ColumnType::Int)
+                return INDEX_MAX;
+
+            const auto* values = intColumn(m_header->keyColumn);
+            const auto mask = m_header->numKeyBuckets - 1;
+
+            auto bucket = CalcKeyHash(key) & mask;
+            while (m_keyIndex[bucket] != INDEX_MAX)
+            {
+                const auto row = m_keyIndex[bucket];
+                if (values[row] == key)
+                    return row;
+                bucket = (bucket + 1) & mask;
+            }
+
+            return INDEX_MAX;
+        }
+
+        //--
+
+        uint32_t ColumnTable::CalcKeyHash(StringView<char> key)
+        {
+            return FastHash32(key.data(), key.length());
+        }
+
+        uint32_t ColumnTable::CalcKeyHash(int key)
+        {
+            return FastHash32(&key, sizeof(key));
+        }
+
+        //--
+
+    } // storage
+} // base
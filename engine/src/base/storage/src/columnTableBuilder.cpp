@@ -0,0 +1,340 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "columnTable.h"
+#include "columnTableBuilder.h"
+
+#include "base/containers/include/crc.h"
+#include "base/containers/include/inplaceArray.h"
+
+namespace base
+{
+    namespace storage
+    {
+
+        //--
+
+        mem::PoolID POOL_DATA_TABLE("Engine.DataTable");
+
+        static INLINE uint64_t AlignOffset(uint64_t offset, uint32_t alignment)
+        {
+            return (offset + alignment - 1) & ~(uint64_t)(alignment - 1);
+        }
+
+        //--
+
+        ColumnTableBuilder::ColumnTableBuilder()
+        {
+            clear();
+        }
+
+        void ColumnTableBuilder::clear()
+        {
+            m_columns.reset();
+            m_numRows = 0;
+            m_keyColumn = INDEX_MAX;
+            m_stringMap.reset();
+            m_stringPool.reset();
+
+            // empty string is always at offset 0, it's also the default value of string cells
+            m_stringPool.allocateWith(8, 0);
+        }
+
+        uint32_t ColumnTableBuilder::mapString(StringView<char> str)
+        {
+            if (str.empty())
+                return 0;
+
+            const auto strHash = str.calcCRC64();
+
+            uint32_t offset = 0;
+            if (m_stringMap.find(strHash, offset) && pooledString(offset) == str)
+                return offset;
+
+            // length, text with the zero terminator, everything aligned to 4 bytes so the next length can be read directly
+            offset = m_stringPool.size();
+            const auto length = str.length();
+            const auto entrySize = (uint32_t)AlignOffset(sizeof(uint32_t) + length + 1, 4);
+            auto* ptr = m_stringPool.allocateWith(entrySize, 0);
+            memcpy(ptr, &length, sizeof(uint32_t));
+            memcpy(ptr + sizeof(uint32_t), str.data(), str.length());
+
+            // NOTE: on the (unlikely) hash collision we keep the first string mapped, the other one is just not shared
+            if (!m_stringMap.find(strHash))
+                m_stringMap[strHash] = offset;
+
+            return offset;
+        }
+
+        StringView<char> ColumnTableBuilder::pooledString(uint32_t offset) const
+        {
+            auto* entry = (const uint32_t*)(m_stringPool.typedData() + offset);
+            auto* text = (const char*)(entry + 1);
+            return StringView<char>(text, text + *entry);
+        }
+
+        uint32_t& ColumnTableBuilder::cell(uint32_t row, uint32_t column, ColumnType type)
+        {
+            ASSERT_EX(column < m_columns.size(), "Invalid column index");
+            ASSERT_EX(row < m_numRows, "Invalid row index");
+            ASSERT_EX(m_columns[column].type == type, "Column type mismatch");
+            return m_columns[column].values[row];
+        }
+
+        //--
+
+        uint32_t ColumnTableBuilder::findColumn(StringView<char> name) const
+        {
+            for (uint32_t i = 0; i < m_columns.size(); ++i)
+                if (pooledString(m_columns[i].name) == name)
+                    return i;
+
+            return INDEX_MAX;
+        }
+
+        uint32_t ColumnTableBuilder::addColumn(StringView<char> name, ColumnType type)
+        {
+            if (name.empty() || findColumn(name) != INDEX_MAX)
+                return INDEX_MAX;
+
+            auto& column = m_columns.emplaceBack();
+            column.name = mapString(name);
+            column.type = type;
+            column.values.resizeWith(m_numRows, 0);
+            return m_columns.size() - 1;
+        }
+
+        bool ColumnTableBuilder::keyColumn(uint32_t column)
+        {
+            if (column >= m_columns.size())
+                return false;
+
+            const auto type = m_columns[column].type;
+            if (type != ColumnType::Int && type != ColumnType::String)
+                return false;
+
+            m_keyColumn = column;
+            return true;
+        }
+
+        uint32_t ColumnTableBuilder::addRow()
+        {
+            for (auto& column : m_columns)
+                column.values.pushBack(0);
+
+            return m_numRows++;
+        }
+
+        void ColumnTableBuilder::intValue(uint32_t row, uint32_t column, int value)
+        {
+            cell(row, column, ColumnType::Int) = (uint32_t)value;
+        }
+
+        void ColumnTableBuilder::floatValue(uint32_t row, uint32_t column, float value)
+        {
+            memcpy(&cell(row, column, ColumnType::Float), &value, sizeof(float));
+        }
+
+        void ColumnTableBuilder::boolValue(uint32_t row, uint32_t column, bool value)
+        {
+            cell(row, column, ColumnType::Bool) = value ? 1 : 0;
+        }
+
+        void ColumnTableBuilder::stringValue(uint32_t row, uint32_t column, StringView<char> value)
+        {
+            auto offset = mapString(value);
+            cell(row, column, ColumnType::String) = offset;
+        }
+
+        bool ColumnTableBuilder::textValue(uint32_t row, uint32_t column, StringView<char> text)
+        {
+            ASSERT_EX(column < m_columns.size(), "Invalid column index");
+
+            switch (m_columns[column].type)
+            {
+                case ColumnType::Int:
+                {
+                    int value = 0;
+                    if (text.match(value) != MatchResult::OK)
+                        return false;
+                    intValue(row, column, value);
+                    return true;
+                }
+
+                case ColumnType::Float:
+                {
+                    float value = 0.0f;
+                    if (text.match(value) != MatchResult::OK)
+                        return false;
+                    floatValue(row, column, value);
+                    return true;
+                }
+
+                case ColumnType::Bool:
+                {
+                    bool value = false;
+                    if (text == "1")
+                        value = true;
+                    else if (text != "0" && text.match(value) != MatchResult::OK)
+                        return false;
+                    boolValue(row, column, value);
+                    return true;
+                }
+
+                case ColumnType::String:
+                {
+                    stringValue(row, column, text);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        //--
+
+        bool ColumnTableBuilder::buildKeyIndex(uint32_t* buckets, uint32_t numBuckets) const
+        {
+            const auto& column = m_columns[m_keyColumn];
+            const auto mask = numBuckets - 1;
+
+            for (uint32_t i = 0; i < numBuckets; ++i)
+                buckets[i] = INDEX_MAX;
+
+            for (uint32_t row = 0; row < m_numRows; ++row)
+            {
+                const auto value = column.values[row];
+                const auto hash = (column.type == ColumnType::String)
+                    ? ColumnTable::CalcKeyHash(pooledString(value))
+                    : ColumnTable::CalcKeyHash((int)value);
+
+                auto bucket = hash & mask;
+                while (buckets[bucket] != INDEX_MAX)
+                {
+                    // NOTE: strings are compared by text, equal strings may not share the offset after a hash collision in the string map
+                    const auto otherValue = column.values[buckets[bucket]];
+                    const auto duplicated = (column.type == ColumnType::String)
+                        ? (pooledString(otherValue) == pooledString(value))
+                        : (otherValue == value);
+
+                    if (duplicated)
+                    {
+                        if (column.type == ColumnType::String)
+                            TRACE_ERROR("Duplicated key '{}' in rows {} and {}", pooledString(value), buckets[bucket], row);
+                        else
+                            TRACE_ERROR("Duplicated key {} in rows {} and {}", (int)value, buckets[bucket], row);
+                        return false;
+                    }
+
+                    bucket = (bucket + 1) & mask;
+                }
+
+                buckets[bucket] = row;
+            }
+
+            return true;
+        }
+
+        Buffer ColumnTableBuilder::build() const
+        {
+            PC_SCOPE_LVL1(BuildColumnTable);
+
+            // key index is kept at most half full so the probing sequences stay short
+            uint32_t numKeyBuckets = 0;
+            if (m_keyColumn != INDEX_MAX)
+            {
+                numKeyBuckets = 16;
+                while (numKeyBuckets < m_numRows * 2ULL)
+                    numKeyBuckets *= 2;
+            }
+
+            // place the sections, everything is aligned so the values can be accessed in place
+            uint64_t offset = sizeof(ColumnTable::Header) + (m_columns.size() * sizeof(ColumnTable::ColumnInfo));
+
+            InplaceArray<uint64_t, 32> columnOffsets;
+            for (const auto& column : m_columns)
+            {
+                offset = AlignOffset(offset, 8);
+                columnOffsets.pushBack(offset);
+                offset += m_numRows * (uint64_t)((column.type == ColumnType::Bool) ? sizeof(uint8_t) : sizeof(uint32_t));
+            }
+
+            offset = AlignOffset(offset, 8);
+            const auto keyIndexOffset = offset;
+            offset += numKeyBuckets * (uint64_t)sizeof(uint32_t);
+
+            offset = AlignOffset(offset, 8);
+            const auto stringPoolOffset = offset;
+            offset += m_stringPool.size();
+
+            if (offset > 0xFFFFFFF0ULL)
+            {
+                TRACE_ERROR("Data table is too big ({})", MemSize(offset));
+                return nullptr;
+            }
+
+            const auto totalSize = (uint32_t)AlignOffset(offset, 8);
+
+            auto ret = Buffer::CreateZeroInitialized(POOL_DATA_TABLE, totalSize, 16);
+            if (!ret)
+            {
+                TRACE_ERROR("Unable to allocate {} for the data table", MemSize(totalSize));
+                return nullptr;
+            }
+
+            auto* base = ret.data();
+
+            // key index first, it's the only thing that can fail
+            if (numKeyBuckets && !buildKeyIndex((uint32_t*)(base + keyIndexOffset), numKeyBuckets))
+                return nullptr;
+
+            // columns
+            auto* columnInfos = (ColumnTable::ColumnInfo*)(base + sizeof(ColumnTable::Header));
+            for (uint32_t i = 0; i < m_columns.size(); ++i)
+            {
+                const auto& column = m_columns[i];
+
+                auto& info = columnInfos[i];
+                info.nameOffset = column.name;
+                info.dataOffset = (uint32_t)columnOffsets[i];
+                info.type = column.type;
+
+                if (column.type == ColumnType::Bool)
+                {
+                    auto* writePtr = base + info.dataOffset;
+                    for (uint32_t row = 0; row < m_numRows; ++row)
+                        writePtr[row] = (uint8_t)column.values[row];
+                }
+                else
+                {
+                    // int, float and string offsets are stored exactly as we keep them
+                    memcpy(base + info.dataOffset, column.values.data(), m_numRows * sizeof(uint32_t));
+                }
+            }
+
+            // string pool
+            memcpy(base + stringPoolOffset, m_stringPool.data(), m_stringPool.size());
+
+            // header
+            auto* header = new (base) ColumnTable::Header();
+            header->totalSize = totalSize;
+            header->numRows = m_numRows;
+            header->numColumns = m_columns.size();
+            header->keyColumn = numKeyBuckets ? m_keyColumn : INDEX_MAX;
+            header->numKeyBuckets = numKeyBuckets;
+            header->keyIndexOffset = numKeyBuckets ? (uint32_t)keyIndexOffset : 0;
+            header->stringPoolOffset = (uint32_t)stringPoolOffset;
+            header->stringPoolSize = m_stringPool.size();
+            header->contentHash = CRC64().append(base + sizeof(ColumnTable::Header), totalSize - sizeof(ColumnTable::Header)).crc();
+
+            return ret;
+        }
+
+        //--
+
+    } // storage
+} // base
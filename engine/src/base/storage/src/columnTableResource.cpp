@@ -0,0 +1,49 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "columnTableResource.h"
+
+namespace base
+{
+    namespace storage
+    {
+
+        RTTI_BEGIN_TYPE_CLASS(ColumnTableResource);
+            RTTI_METADATA(base::res::ResourceExtensionMetadata).extension("v4table");
+            RTTI_METADATA(base::res::ResourceDescriptionMetadata).description("Cooked Column Table");
+            RTTI_METADATA(base::res::ResourceMappedBuffersMetadata);
+            RTTI_PROPERTY(m_data);
+        RTTI_END_TYPE();
+
+        ColumnTableResource::ColumnTableResource()
+        {}
+
+        ColumnTableResource::ColumnTableResource(const Buffer& cookedData)
+        {
+            m_data.reset(cookedData.data(), range_cast<uint32_t>(cookedData.size()));
+            m_table.bind(m_data.load());
+        }
+
+        uint64_t ColumnTableResource::calcResourceMemorySize() const
+        {
+            // mapped pages are not taken from any pool but they are still memory we are using
+            return m_table.data().size();
+        }
+
+        void ColumnTableResource::onPostLoad()
+        {
+            TBaseClass::onPostLoad();
+
+            // no parsing, the loaded (or mapped) blob is the table
+            if (!m_table.bind(m_data.load()))
+            {
+                TRACE_ERROR("Loaded data is not a valid column table");
+            }
+        }
+
+    } // storage
+} // base
@@ -0,0 +1,462 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/containers/include/stringBuilder.h"
+#include "base/io/include/absolutePath.h"
+#include "base/io/include/utils.h"
+#include "base/memory/include/poolStats.h"
+#include "base/system/include/timedScope.h"
+#include "base/xml/include/xmlDocument.h"
+#include "base/xml/include/xmlUtils.h"
+#include "base/resources/include/resourceUncached.h"
+#include "base/resources/include/resourceBinarySaver.h"
+
+#include "columnTable.h"
+#include "columnTableBuilder.h"
+#include "columnTableResource.h"
+
+DECLARE_TEST_FILE(ColumnTable);
+
+using namespace base;
+
+namespace tests
+{
+    static const char* WeaponNames[] = { "sword", "axe", "bow", "spear", "mace", "dagger" };
+
+    static void BuildWeapons(storage::ColumnTableBuilder& builder, uint32_t numRows)
+    {
+        builder.addColumn("name", storage::ColumnType::String);
+        builder.addColumn("damage", storage::ColumnType::Int);
+        builder.addColumn("weight", storage::ColumnType::Float);
+        builder.addColumn("twoHanded", storage::ColumnType::Bool);
+        builder.addColumn("class", storage::ColumnType::String);
+
+        for (uint32_t i = 0; i < numRows; ++i)
+        {
+            auto row = builder.addRow();
+            builder.stringValue(row, 0, TempString("{}{}", WeaponNames[i % ARRAY_COUNT(WeaponNames)], i));
+            builder.intValue(row, 1, (int)(i * 7) - 100);
+            builder.floatValue(row, 2, 0.5f + i);
+            builder.boolValue(row, 3, (i % 3) == 0);
+            builder.stringValue(row, 4, WeaponNames[i % ARRAY_COUNT(WeaponNames)]);
+        }
+    }
+
+    static uint64_t CalcTrackedMemory()
+    {
+        mem::PoolStatsData stats[256];
+        uint32_t numPools = 0;
+        mem::PoolStats::GetInstance().allStats(ARRAY_COUNT(stats), stats, numPools);
+
+        uint64_t ret = 0;
+        for (uint32_t i = 0; i < numPools; ++i)
+            ret += stats[i].m_totalSize;
+        return ret;
+    }
+
+} // tests
+
+TEST(ColumnTable, EmptyTable)
+{
+    storage::ColumnTable table;
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(0, table.numRows());
+    EXPECT_EQ(0, table.numColumns());
+    EXPECT_EQ(INDEX_MAX, table.findColumn("name"));
+    EXPECT_EQ(INDEX_MAX, table.findRow("sword"));
+}
+
+TEST(ColumnTable, BuildAndRead)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 100);
+
+    auto data = builder.build();
+    ASSERT_TRUE(data);
+
+    storage::ColumnTable table;
+    ASSERT_TRUE(table.bind(data));
+    ASSERT_EQ(100, table.numRows());
+    ASSERT_EQ(5, table.numColumns());
+    EXPECT_EQ(INDEX_MAX, table.keyColumn());
+
+    EXPECT_EQ(StringView<char>("damage"), table.columnName(1));
+    EXPECT_EQ(storage::ColumnType::Float, table.columnType(2));
+    EXPECT_EQ(3, table.findColumn("twoHanded"));
+    EXPECT_EQ(INDEX_MAX, table.findColumn("price"));
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(StringView<char>(TempString("{}{}", tests::WeaponNames[i % 6], i)), table.stringValue(i, 0));
+        EXPECT_EQ((int)(i * 7) - 100, table.intValue(i, 1));
+        EXPECT_EQ(0.5f + i, table.floatValue(i, 2));
+        EXPECT_EQ((i % 3) == 0, table.boolValue(i, 3));
+        EXPECT_EQ(StringView<char>(tests::WeaponNames[i % 6]), table.stringValue(i, 4));
+    }
+}
+
+TEST(ColumnTable, StringsAreInterned)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 60);
+
+    storage::ColumnTable table;
+    ASSERT_TRUE(table.bind(builder.build()));
+
+    // same values share the same place in the pool
+    const auto* classes = table.stringColumn(4);
+    for (uint32_t i = 6; i < 60; ++i)
+        EXPECT_EQ(classes[i % 6], classes[i]);
+}
+
+TEST(ColumnTable, DefaultValues)
+{
+    storage::ColumnTableBuilder builder;
+    builder.addRow();
+    builder.addColumn("text", storage::ColumnType::String);
+    builder.addColumn("number", storage::ColumnType::Int);
+    builder.addRow();
+
+    storage::ColumnTable table;
+    ASSERT_TRUE(table.bind(builder.build()));
+    ASSERT_EQ(2, table.numRows());
+    EXPECT_TRUE(table.stringValue(0, 0).empty());
+    EXPECT_TRUE(table.stringValue(1, 0).empty());
+    EXPECT_EQ(0, table.intValue(0, 1));
+    EXPECT_EQ(0, table.intValue(1, 1));
+}
+
+TEST(ColumnTable, DuplicatedColumnFails)
+{
+    storage::ColumnTableBuilder builder;
+    EXPECT_EQ(0, builder.addColumn("name", storage::ColumnType::String));
+    EXPECT_EQ(INDEX_MAX, builder.addColumn("name", storage::ColumnType::Int));
+    EXPECT_EQ(INDEX_MAX, builder.addColumn("", storage::ColumnType::Int));
+}
+
+TEST(ColumnTable, TextValues)
+{
+    storage::ColumnTableBuilder builder;
+    builder.addColumn("i", storage::ColumnType::Int);
+    builder.addColumn("f", storage::ColumnType::Float);
+    builder.addColumn("b", storage::ColumnType::Bool);
+    builder.addColumn("s", storage::ColumnType::String);
+
+    auto row = builder.addRow();
+    EXPECT_TRUE(builder.textValue(row, 0, "-42"));
+    EXPECT_TRUE(builder.textValue(row, 1, "1.5"));
+    EXPECT_TRUE(builder.textValue(row, 2, "true"));
+    EXPECT_TRUE(builder.textValue(row, 3, "hello"));
+    EXPECT_FALSE(builder.textValue(row, 0, "abc"));
+    EXPECT_FALSE(builder.textValue(row, 2, "maybe"));
+
+    storage::ColumnTable table;
+    ASSERT_TRUE(table.bind(builder.build()));
+    EXPECT_EQ(-42, table.intValue(0, 0));
+    EXPECT_EQ(1.5f, table.floatValue(0, 1));
+    EXPECT_TRUE(table.boolValue(0, 2));
+    EXPECT_EQ(StringView<char>("hello"), table.stringValue(0, 3));
+}
+
+TEST(ColumnTable, FindRowByStringKey)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 1000);
+    ASSERT_TRUE(builder.keyColumn(0));
+
+    storage::ColumnTable table;
+    ASSERT_TRUE(table.bind(builder.build()));
+    EXPECT_EQ(0, table.keyColumn());
+
+    for (uint32_t i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, table.findRow(TempString("{}{}", tests::WeaponNames[i % 6], i)));
+
+    EXPECT_EQ(INDEX_MAX, table.findRow("sword1"));
+    EXPECT_EQ(INDEX_MAX, table.findRow(""));
+    EXPECT_EQ(INDEX_MAX, table.findRow(5)); // wrong key type
+}
+
+TEST(ColumnTable, FindRowByIntKey)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 1000);
+    ASSERT_TRUE(builder.keyColumn(1));
+
+    storage::ColumnTable table;
+    ASSERT_TRUE(table.bind(builder.build()));
+
+    for (uint32_t i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, table.findRow((int)(i * 7) - 100));
+
+    EXPECT_EQ(INDEX_MAX, table.findRow(-99));
+    EXPECT_EQ(INDEX_MAX, table.findRow("sword0")); // wrong key type
+}
+
+TEST(ColumnTable, OnlyIntAndStringColumnsCanBeKeys)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 10);
+    EXPECT_FALSE(builder.keyColumn(2));
+    EXPECT_FALSE(builder.keyColumn(3));
+    EXPECT_FALSE(builder.keyColumn(5));
+}
+
+TEST(ColumnTable, DuplicatedKeyFails)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 10);
+    ASSERT_TRUE(builder.keyColumn(4));
+    EXPECT_FALSE(builder.build());
+}
+
+TEST(ColumnTable, BindRejectsInvalidData)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 10);
+    auto data = builder.build();
+    ASSERT_TRUE(data);
+
+    storage::ColumnTable table;
+
+    auto truncated = Buffer::Create(POOL_TEMP, data.size() - 8, 16, data.data());
+    EXPECT_FALSE(table.bind(truncated));
+    EXPECT_TRUE(table.empty());
+
+    auto corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    ((storage::ColumnTable::Header*)corrupted.data())->magic = 0;
+    EXPECT_FALSE(table.bind(corrupted));
+
+    corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    ((storage::ColumnTable::ColumnInfo*)(corrupted.data() + sizeof(storage::ColumnTable::Header)))->dataOffset = data.size();
+    EXPECT_FALSE(table.bind(corrupted));
+
+    EXPECT_TRUE(table.bind(data));
+}
+
+TEST(ColumnTable, BindRejectsInvalidKeyIndex)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 10);
+    ASSERT_TRUE(builder.keyColumn(0));
+    auto data = builder.build();
+    ASSERT_TRUE(data);
+
+    const auto* header = (const storage::ColumnTable::Header*)data.data();
+    const auto numBuckets = header->numKeyBuckets;
+    ASSERT_NE(0, numBuckets);
+
+    storage::ColumnTable table;
+
+    // row outside of the table
+    auto corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    auto* keyIndex = (uint32_t*)(corrupted.data() + header->keyIndexOffset);
+    for (uint32_t i = 0; i < numBuckets; ++i)
+    {
+        if (keyIndex[i] != INDEX_MAX)
+        {
+            keyIndex[i] = header->numRows;
+            break;
+        }
+    }
+    EXPECT_FALSE(table.bind(corrupted));
+
+    // no empty bucket, the lookup of a missing key would never end
+    corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    keyIndex = (uint32_t*)(corrupted.data() + header->keyIndexOffset);
+    for (uint32_t i = 0; i < numBuckets; ++i)
+        keyIndex[i] = 0;
+    EXPECT_FALSE(table.bind(corrupted));
+
+    EXPECT_TRUE(table.bind(data));
+}
+
+TEST(ColumnTable, BindRejectsInvalidStrings)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 10);
+    auto data = builder.build();
+    ASSERT_TRUE(data);
+
+    const auto* header = (const storage::ColumnTable::Header*)data.data();
+    const auto* columns = (const storage::ColumnTable::ColumnInfo*)(header + 1);
+    ASSERT_EQ(storage::ColumnType::String, columns[0].type);
+
+    storage::ColumnTable table;
+
+    // string cell outside of the pool
+    auto corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    ((uint32_t*)(corrupted.data() + columns[0].dataOffset))[5] = header->stringPoolSize;
+    EXPECT_FALSE(table.bind(corrupted));
+
+    // string cell in the middle of the pooled string
+    corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    ((uint32_t*)(corrupted.data() + columns[0].dataOffset))[5] += 1;
+    EXPECT_FALSE(table.bind(corrupted));
+
+    // pooled string longer than the pool
+    corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    const auto stringOffset = ((const uint32_t*)(data.data() + columns[0].dataOffset))[5];
+    *(uint32_t*)(corrupted.data() + header->stringPoolOffset + stringOffset) = header->stringPoolSize;
+    EXPECT_FALSE(table.bind(corrupted));
+
+    // column name outside of the pool
+    corrupted = Buffer::Create(POOL_TEMP, data.size(), 16, data.data());
+    ((storage::ColumnTable::ColumnInfo*)(corrupted.data() + sizeof(storage::ColumnTable::Header)))[1].nameOffset = header->stringPoolSize - 2;
+    EXPECT_FALSE(table.bind(corrupted));
+
+    EXPECT_TRUE(table.bind(data));
+}
+
+TEST(ColumnTable, OpenMapped)
+{
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, 1000);
+    ASSERT_TRUE(builder.keyColumn(0));
+    auto data = builder.build();
+    ASSERT_TRUE(data);
+
+    auto path = IO::GetInstance().systemPath(io::PathCategory::TempDir).addFile(L"columnTable.v4table");
+    ASSERT_TRUE(io::SaveFileFromBuffer(path, data));
+
+    {
+        storage::ColumnTable table;
+        ASSERT_TRUE(table.openMapped(path.view()));
+        EXPECT_EQ(1000, table.numRows());
+        EXPECT_EQ(data.size(), table.data().size());
+        EXPECT_EQ(777, table.findRow("spear777"));
+        EXPECT_EQ(777 * 7 - 100, table.intValue(777, 1));
+    }
+
+    IO::GetInstance().deleteFile(path);
+}
+
+TEST(ColumnTable, ResourceIsBoundToMappedFile)
+{
+    const uint32_t NUM_ROWS = 100000;
+
+    storage::ColumnTableBuilder builder;
+    tests::BuildWeapons(builder, NUM_ROWS);
+    ASSERT_TRUE(builder.keyColumn(0));
+    auto data = builder.build();
+    ASSERT_TRUE(data);
+
+    auto path = IO::GetInstance().systemPath(io::PathCategory::TempDir).addFile(L"columnTableResource.v4table");
+    {
+        auto resource = CreateSharedPtr<storage::ColumnTableResource>(data);
+        ASSERT_TRUE(res::SaveUncached(path, resource, res::ResourceMountPoint()));
+    }
+
+    {
+        // the blob is not read into memory, only the resource object is allocated
+        const auto memoryBefore = tests::CalcTrackedMemory();
+        auto loaded = rtti_cast<storage::ColumnTableResource>(res::LoadUncached(path, storage::ColumnTableResource::GetStaticClass()));
+        ASSERT_TRUE(loaded);
+        EXPECT_LT(tests::CalcTrackedMemory(), memoryBefore + data.size() / 2);
+
+        const auto& table = loaded->table();
+        ASSERT_EQ(NUM_ROWS, table.numRows());
+        ASSERT_EQ(data.size(), table.data().size());
+        EXPECT_EQ(0, memcmp(data.data(), table.data().data(), data.size()));
+        EXPECT_EQ(0, (uint64_t)table.data().data() & (res::binary::BinarySaver::MAPPED_BUFFER_ALIGNMENT - 1));
+        EXPECT_EQ(777, table.findRow("spear777"));
+        EXPECT_EQ(777 * 7 - 100, table.intValue(777, 1));
+    }
+
+    IO::GetInstance().deleteFile(path);
+}
+
+TEST(ColumnTable, DISABLED_LoadTime1MRows)
+{
+    const uint32_t NUM_ROWS = 1000000;
+    const uint32_t NUM_LOOKUPS = 10000;
+
+    // source data in the XML form we used to load at runtime
+    auto xmlPath = IO::GetInstance().systemPath(io::PathCategory::TempDir).addFile(L"columnTableBenchmark.xml");
+    {
+        StringBuilder txt;
+        txt << "<table key=\"name\">\n";
+        txt << "<column name=\"name\" type=\"string\"/><column name=\"damage\" type=\"int\"/><column name=\"weight\" type=\"float\"/><column name=\"twoHanded\" type=\"bool\"/><column name=\"class\" type=\"string\"/>\n";
+        for (uint32_t i = 0; i < NUM_ROWS; ++i)
+        {
+            const auto* name = tests::WeaponNames[i % ARRAY_COUNT(tests::WeaponNames)];
+            txt.appendf("<row name=\"{}{}\" damage=\"{}\" weight=\"{}\" twoHanded=\"{}\" class=\"{}\"/>\n", name, i, (int)(i * 7) - 100, 0.5f + i, (i % 3) == 0, name);
+        }
+        txt << "</table>\n";
+        ASSERT_TRUE(io::SaveFileFromString(xmlPath, txt.view()));
+    }
+
+    // cooked data
+    auto cookedPath = IO::GetInstance().systemPath(io::PathCategory::TempDir).addFile(L"columnTableBenchmark.v4table");
+    {
+        storage::ColumnTableBuilder builder;
+        tests::BuildWeapons(builder, NUM_ROWS);
+        ASSERT_TRUE(builder.keyColumn(0));
+        ASSERT_TRUE(io::SaveFileFromBuffer(cookedPath, builder.build()));
+    }
+
+    uint64_t xmlFileSize = 0, cookedFileSize = 0;
+    IO::GetInstance().fileSize(xmlPath.view(), xmlFileSize);
+    IO::GetInstance().fileSize(cookedPath.view(), cookedFileSize);
+
+    // XML document
+    {
+        const auto memoryBefore = tests::CalcTrackedMemory();
+
+        ScopeTimer timer;
+        auto doc = xml::LoadDocument(xml::ILoadingReporter::GetDefault(), xmlPath);
+        ASSERT_TRUE(doc);
+        const auto loadTime = timer.timeElapsed();
+
+        const auto memory = tests::CalcTrackedMemory() - memoryBefore;
+        TRACE_INFO("XML ({}): loaded in {}, {} of memory", MemSize(xmlFileSize), TimeInterval(loadTime), MemSize(memory));
+    }
+
+    // cooked data read into memory
+    {
+        const auto memoryBefore = tests::CalcTrackedMemory();
+
+        ScopeTimer timer;
+        storage::ColumnTable table;
+        ASSERT_TRUE(table.bind(IO::GetInstance().loadIntoMemoryForReading(cookedPath.view())));
+        const auto loadTime = timer.timeElapsed();
+
+        const auto memory = tests::CalcTrackedMemory() - memoryBefore;
+        TRACE_INFO("Cooked ({}): read in {}, {} of memory", MemSize(cookedFileSize), TimeInterval(loadTime), MemSize(memory));
+    }
+
+    // cooked data mapped, only the pages we touch are loaded
+    {
+        const auto memoryBefore = tests::CalcTrackedMemory();
+
+        ScopeTimer timer;
+        storage::ColumnTable table;
+        ASSERT_TRUE(table.openMapped(cookedPath.view()));
+        const auto loadTime = timer.timeElapsed();
+
+        ScopeTimer lookupTimer;
+        uint64_t seed = 1;
+        for (uint32_t i = 0; i < NUM_LOOKUPS; ++i)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            const auto rowIndex = (uint32_t)((seed >> 33) % NUM_ROWS);
+            const auto row = table.findRow(TempString("{}{}", tests::WeaponNames[rowIndex % ARRAY_COUNT(tests::WeaponNames)], rowIndex));
+            ASSERT_EQ(rowIndex, row);
+            ASSERT_EQ((int)(rowIndex * 7) - 100, table.intValue(row, 1));
+        }
+        const auto lookupTime = lookupTimer.timeElapsed();
+
+        const auto memory = tests::CalcTrackedMemory() - memoryBefore;
+        TRACE_INFO("Cooked ({}): mapped in {}, {} of memory, {} random lookups in {}", MemSize(cookedFileSize), TimeInterval(loadTime), MemSize(memory), NUM_LOOKUPS, TimeInterval(lookupTime));
+    }
+
+    IO::GetInstance().deleteFile(xmlPath);
+    IO::GetInstance().deleteFile(cookedPath);
+}
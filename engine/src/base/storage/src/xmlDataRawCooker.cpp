@@ -8,6 +8,8 @@
 
 #include "build.h"
 #include "xmlDataDocument.h"
+#include "columnTableBuilder.h"
+#include "columnTableResource.h"
 
 #include "base/io/include/ioFileHandle.h"
 #include "base/io/include/absolutePath.h"
@@ -18,6 +20,7 @@
 #include "base/resources/include/resourceCookingInterface.h"
 #include "base/xml/include/xmlDocument.h"
 #include "base/xml/include/xmlUtils.h"
+#include "base/xml/include/xmlStreamParser.h"
 
 namespace base
 {
@@ -88,5 +91,169 @@ namespace base
 
         ///--
 
+        // loader of the table rows from XML, the file is streamed so we never keep the whole document in memory:
+        // <table key="name">
+        //   <column name="name" type="string"/>
+        //   <column name="damage" type="int"/>
+        //   <row name="sword" damage="10"/>
+        // </table>
+        class XMLColumnTableLoader : public xml::IStreamHandler
+        {
+        public:
+            XMLColumnTableLoader(const StringBuf& contextName, ColumnTableBuilder& builder)
+                : m_contextName(contextName)
+                , m_builder(builder)
+            {}
+
+            virtual bool onNodeStart(StringView<char> name, const xml::StreamAttribute* attributes, uint32_t numAttributes) override
+            {
+                m_depth += 1;
+
+                if (m_depth == 1)
+                {
+                    if (name != "table")
+                        return error(TempString("Expected 'table' as the root node, got '{}'", name));
+
+                    for (uint32_t i = 0; i < numAttributes; ++i)
+                        if (attributes[i].name == "key")
+                            m_keyName = StringBuf(attributes[i].value);
+
+                    return true;
+                }
+
+                if (m_depth > 2)
+                    return error(TempString("Unexpected node '{}'", name));
+
+                if (name == "column")
+                    return parseColumn(attributes, numAttributes);
+                else if (name == "row")
+                    return parseRow(attributes, numAttributes);
+
+                return error(TempString("Unexpected node '{}'", name));
+            }
+
+            virtual bool onNodeEnd(StringView<char> name) override
+            {
+                m_depth -= 1;
+                return true;
+            }
+
+            bool finish()
+            {
+                if (m_keyName.empty())
+                    return true;
+
+                auto keyColumn = m_builder.findColumn(m_keyName);
+                if (keyColumn == INDEX_MAX || !m_builder.keyColumn(keyColumn))
+                    return error(TempString("Key column '{}' does not exist or can't be indexed", m_keyName));
+
+                return true;
+            }
+
+        private:
+            StringBuf m_contextName;
+            ColumnTableBuilder& m_builder;
+
+            StringBuf m_keyName;
+            uint32_t m_depth = 0;
+
+            bool error(StringView<char> text) const
+            {
+                TRACE_ERROR("{}: {}", m_contextName, text);
+                return false;
+            }
+
+            bool parseColumn(const xml::StreamAttribute* attributes, uint32_t numAttributes)
+            {
+                if (m_builder.numRows())
+                    return error("Columns must be defined before rows");
+
+                StringView<char> name, type;
+                for (uint32_t i = 0; i < numAttributes; ++i)
+                {
+                    if (attributes[i].name == "name")
+                        name = attributes[i].value;
+                    else if (attributes[i].name == "type")
+                        type = attributes[i].value;
+                }
+
+                ColumnType columnType = ColumnType::String;
+                if (type == "int")
+                    columnType = ColumnType::Int;
+                else if (type == "float")
+                    columnType = ColumnType::Float;
+                else if (type == "bool")
+                    columnType = ColumnType::Bool;
+                else if (type != "string")
+                    return error(TempString("Unknown type '{}' of column '{}'", type, name));
+
+                if (m_builder.addColumn(name, columnType) == INDEX_MAX)
+                    return error(TempString("Invalid or duplicated column '{}'", name));
+
+                return true;
+            }
+
+            bool parseRow(const xml::StreamAttribute* attributes, uint32_t numAttributes)
+            {
+                auto row = m_builder.addRow();
+
+                for (uint32_t i = 0; i < numAttributes; ++i)
+                {
+                    auto column = m_builder.findColumn(attributes[i].name);
+                    if (column == INDEX_MAX)
+                        return error(TempString("Unknown column '{}' in row {}", attributes[i].name, row));
+
+                    if (!m_builder.textValue(row, column, attributes[i].value))
+                        return error(TempString("Invalid value '{}' of column '{}' in row {}", attributes[i].value, attributes[i].name, row));
+                }
+
+                return true;
+            }
+        };
+
+        // cooker for the column tables defined in XML
+        class XMLColumnTableCooker : public base::res::IResourceCooker
+        {
+            RTTI_DECLARE_VIRTUAL_CLASS(XMLColumnTableCooker, base::res::IResourceCooker);
+
+            virtual base::res::ResourceHandle cook(base::res::IResourceCookerInterface& cooker) const override
+            {
+                auto xmlFilePath = cooker.queryResourcePath().path();
+                auto rawContent = cooker.loadToBuffer(xmlFilePath);
+                if (!rawContent)
+                    return nullptr;
+
+                StringBuf contextName;
+                cooker.queryContextName(xmlFilePath, contextName);
+
+                // stream the rows into the builder
+                ColumnTableBuilder builder;
+                XMLColumnTableLoader loader(contextName, builder);
+                FileLoadingReporter errorReporter(contextName);
+                if (!xml::ParseStream(errorReporter, StringView<char>((const char*)rawContent.data(), (uint32_t)rawContent.size()), loader) || !loader.finish())
+                {
+                    TRACE_ERROR("Failed to load table from '{}'", cooker.queryResourcePath());
+                    return nullptr;
+                }
+
+                // pack into the cooked layout, it will be used directly after loading
+                auto data = builder.build();
+                if (!data)
+                {
+                    TRACE_ERROR("Failed to build table from '{}'", cooker.queryResourcePath());
+                    return nullptr;
+                }
+
+                return base::CreateSharedPtr<ColumnTableResource>(data);
+            }
+        };
+
+        RTTI_BEGIN_TYPE_CLASS(XMLColumnTableCooker);
+            RTTI_METADATA(base::res::ResourceCookedClassMetadata).addClass<ColumnTableResource>();
+            RTTI_METADATA(base::res::ResourceSourceFormatMetadata).addSourceExtension("xtable");
+        RTTI_END_TYPE();
+
+        ///--
+
     } // storage
 } // base
\ No newline at end of file
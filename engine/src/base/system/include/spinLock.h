@@ -23,6 +23,9 @@ namespace base
         void acquire();
         void release();
 
+        // try to acquire the lock without spinning, returns false if it's already taken
+        bool tryAcquire();
+
     private:
         std::atomic<uint32_t> owner = 0;
 
@@ -101,6 +101,17 @@ namespace base
         }
     }
 
+    bool SpinLock::tryAcquire()
+    {
+#if defined(BUILD_FINAL) || defined(BUILD_RELEASE)
+        auto threadID = 1; // don't use thread ID on final builds it's to costly
+#else
+        auto threadID = GetThreadID();
+#endif
+        uint32_t value = 0;
+        return owner.compare_exchange_strong(value, threadID);
+    }
+
     //! Releases the lock on the critical section
     void SpinLock::release()
     {
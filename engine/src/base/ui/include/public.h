@@ -59,9 +59,39 @@ namespace ui
         class Library;
         class IStyleLibraryContentLoader;
 
-        struct ParamTable : public base::IReferencable
+        /// dense index of the style parameter, see RegisterParamSlot
+        typedef uint16_t ParamSlot;
+        static const ParamSlot INVALID_PARAM_SLOT = (ParamSlot)~0;
+
+        /// value of style parameter stored in the flat slot table
+        struct ParamSlotValue
+        {
+            base::Type type = nullptr;
+            const void* data = nullptr;
+        };
+
+        struct BASE_UI_API ParamTable : public base::IReferencable
         {
             base::VariantTable values;
+            uint64_t key = 0; // CRC64 of the values, computed once in compile()
+            base::Array<ParamSlotValue> slots; // values indexed directly by the parameter slot
+
+            /// build the flat slot table and the key from current values
+            /// NOTE: must be called again after values are modified
+            void compile();
+
+            /// get value of parameter by slot, returns null if not defined
+            INLINE const ParamSlotValue* slotValue(ParamSlot slot) const
+            {
+                if (slot < slots.size())
+                {
+                    const auto& val = slots.typedData()[slot];
+                    if (val.data)
+                        return &val;
+                }
+
+                return nullptr;
+            }
         };
     };
 
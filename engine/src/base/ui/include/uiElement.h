@@ -15,6 +15,7 @@
 #include "uiElementLayout.h"
 #include "uiActionTable.h"
 #include "uiEventFunction.h"
+#include "uiStyleParameters.h"
 #include "base/containers/include/hashSet.h"
 
 namespace ui
@@ -222,7 +223,18 @@ namespace ui
 
     //------
 
+    /// reasons for the cached element geometry to be rebuilt
+    enum class ElementGeometryDirtyBit : uint8_t
+    {
+        Style = FLAG(0), // style parameters changed
+        Size = FLAG(1), // size of the draw area changed
+        Content = FLAG(2), // content of the element changed (text, image, custom state)
+    };
+
+    typedef base::DirectFlags<ElementGeometryDirtyBit> ElementGeometryDirtyFlags;
+
     /// generic cached geometry for the widget
+    /// NOTE: geometry is built in local space (relative to the element's draw area) so it can be replayed at different positions (ie. when scrolling) without rebuilding
     struct ElementCachedGeometry : public base::NoCopy
     {
         base::canvas::GeometryPtr shadow = nullptr; // rendered with parent clip rect
@@ -407,6 +419,12 @@ namespace ui
         /// is this an overlay element?
         INLINE bool isOverlay() const { return m_overlay; }
 
+        /// does this element draw content that changes every frame ? windows with such elements visible are always redrawn
+        INLINE bool isContinuousRedraw() const { return m_continuousRedraw; }
+
+        /// was redraw of this element's hierarchy requested ? (valid for root elements)
+        INLINE bool isRedrawRequested() const { return m_redrawRequested; }
+
         //----
 
         /// get visibility state
@@ -490,7 +508,7 @@ namespace ui
         INLINE float opacity() const { return m_opacity; }
 
         /// change opacity
-        void opacity(float val) { m_opacity = std::clamp<float>(val, 0.0f, 1.0f); }
+        void opacity(float val);
 
         /// expand item in all directions
         void expand();
@@ -700,6 +718,75 @@ namespace ui
             return nullptr;
         }
 
+        //---
+
+        /// evaluate style value via compiled parameter reference, local styles take precedence over the common styles
+        /// NOTE: this is the fast path, the value is fetched directly from the flat slot table without searching by name
+        template< typename T >
+        INLINE const T* evalStyleValueIfPresentPtr(const style::ParamRef& param) const
+        {
+            if (m_customLocalStyles)
+            {
+                if (const auto* val = m_customLocalStyles->findVariant(param.name()))
+                {
+                    DEBUG_CHECK(val->type() == base::reflection::GetTypeObject<T>());
+                    return (const T*)val->data();
+                }
+            }
+
+            if (m_cachedStyle.params)
+            {
+                const auto slot = param.slot();
+                if (slot != style::INVALID_PARAM_SLOT)
+                {
+                    if (const auto* val = m_cachedStyle.params->slotValue(slot))
+                    {
+                        DEBUG_CHECK(val->type == base::reflection::GetTypeObject<T>());
+                        return (const T*)val->data;
+                    }
+                }
+                else if (const auto* val = m_cachedStyle.params->values.findVariant(param.name()))
+                {
+                    // no slot was assigned (out of slots), slow path
+                    DEBUG_CHECK(val->type() == base::reflection::GetTypeObject<T>());
+                    return (const T*)val->data();
+                }
+            }
+
+            return nullptr;
+        }
+
+        /// evaluate style value via compiled parameter reference
+        template< typename T >
+        INLINE const T& evalStyleRef(const style::ParamRef& param, const T& defaultValue = T()) const
+        {
+            if (const auto* val = evalStyleValueIfPresentPtr<T>(param))
+                return *val;
+            return defaultValue;
+        }
+
+        /// evaluate style value via compiled parameter reference
+        template< typename T >
+        INLINE T evalStyleValue(const style::ParamRef& param, T defaultValue = T()) const
+        {
+            if (const auto* val = evalStyleValueIfPresentPtr<T>(param))
+                return *val;
+            return defaultValue;
+        }
+
+        /// evaluate style value via compiled parameter reference
+        template< typename T >
+        INLINE bool evalStyleValueIfPresent(const style::ParamRef& param, T& outVal) const
+        {
+            if (const auto* val = evalStyleValueIfPresentPtr<T>(param))
+            {
+                outVal = *val;
+                return true;
+            }
+
+            return false;
+        }
+
         ///---
 
         /// handle primary mouse input (first click)
@@ -1019,6 +1106,19 @@ namespace ui
 
         //---
 
+        /// request redraw of the window this element is in, does not invalidate any cached data
+        /// NOTE: needed only for visual changes that don't go through the style/layout/geometry invalidation, windows with nothing to redraw are not rendered at all
+        void requestRedraw();
+
+        /// mark element as drawing content that changes every frame (custom rendering, 3D viewports, etc)
+        void continuousRedraw(bool flag);
+
+        /// consume the redraw request of this hierarchy, returns true if there was one (valid for root elements)
+        /// NOTE: called when the window is drawn, drawing may request the redraw again (continuous redraw)
+        bool consumeRedrawRequest();
+
+        //---
+
         /// invalidate all cached data, used only during style library reload
         static void InvalidateAllDataEverywhere();
 
@@ -1131,6 +1231,8 @@ namespace ui
         bool m_enabled : 1;
         bool m_overlay : 1;
         bool m_renderOverlayElements : 1;
+        bool m_continuousRedraw : 1;
+        bool m_redrawRequested : 1;
 
         VisibilityState m_visibility = VisibilityState::Visible;
         HitTestState m_hitTest = HitTestState::DisabledLocal;
@@ -1159,6 +1261,7 @@ namespace ui
         // cached rendering geometry
         uint64_t m_cachedGeometryStyleHash = 0; // style for which this geometry was created
         Size m_cachedGeometrySize; // size for which the geometry was cached
+        ElementGeometryDirtyFlags m_cachedGeometryDirty = ElementGeometryDirtyBit::Content; // why the geometry must be rebuilt
         ElementCachedGeometry* m_cachedGeometry = nullptr;
 
         // children of this element
@@ -158,6 +158,9 @@ namespace ui
         // get the current active input action
         INLINE const InputActionPtr& currentInputAction() const { return m_currentInputAction; }
 
+        // number of window redraws skipped because nothing visible changed
+        INLINE uint32_t numSkippedWindowRedraws() const { return m_numSkippedWindowRedraws; }
+
         //---
 
         /// attach window to the system
@@ -239,6 +242,8 @@ namespace ui
             bool popup = false;
             bool activeState = false;
             bool activeStateSeen = false;
+            bool inputReceived = false; // window got input events this frame
+            ElementArea lastRenderedArea; // area the current content of the native window was rendered with
         };
 
         base::Array<WindowPtr> m_windowList; // all windows, in attachment order
@@ -260,6 +265,8 @@ namespace ui
 
         InputActionPtr m_currentInputAction;
 
+        uint32_t m_numSkippedWindowRedraws = 0;
+
         WindowInfo* windowAtPos(Position absolutePosition);
         WindowInfo* windowForElement(IElement* element);
         NativeWindowID nativeWindowForElement(IElement* element);
@@ -271,6 +278,7 @@ namespace ui
         void updateFocusRequest();
         void updateWindowRepresentation(WindowInfo& window);
         void updateWindowState(WindowInfo& window);
+        bool needsRedraw(const WindowInfo& window, const ElementArea& windowArea) const;
 
         void processMouseMovement(const base::input::MouseMovementEvent& evt);
         void processMouseClick(const base::input::MouseClickEvent& evt);
@@ -42,6 +42,12 @@ namespace ui
 
             //--
 
+            /// assign parameter slots to all style parameters used by the selectors
+            static void RegisterParamSlots(const base::Array<SelectorNode>& selectors);
+
+        protected:
+            virtual void onPostLoad() override;
+
         private:
             /// selector nodes, organize selection
             typedef base::Array<SelectorNode> TSelectorNodes;
@@ -13,6 +13,105 @@ namespace ui
 {
     namespace style
     {
+        //--
+
+        /// maximum number of different style parameters we can assign slots to
+        static const uint32_t MAX_PARAM_SLOTS = 1024;
+
+        /// assign (or get existing) dense slot index for style parameter with given name
+        /// NOTE: slots are global and never released, the style library loader registers all parameters it sees
+        extern BASE_UI_API ParamSlot RegisterParamSlot(base::StringID name);
+
+        /// find existing slot for style parameter, returns INVALID_PARAM_SLOT if parameter was never registered
+        extern BASE_UI_API ParamSlot FindParamSlot(base::StringID name);
+
+        /// get number of parameter slots assigned so far, parameter tables are sized to this
+        extern BASE_UI_API uint32_t NumParamSlots();
+
+        //--
+
+        /// compiled reference to a style parameter, resolves the parameter slot once and then allows for direct lookups in the ParamTable
+        /// intended to be declared as static in the code that queries the styles, ex: static const style::ParamRef PARAM_WIDTH("width");
+        /// NOTE: resolving is deferred until first use so it's safe to declare it as a global, it's thread safe (elements are styled on many fibers)
+        /// NOTE: if we ran out of slots the slot is INVALID_PARAM_SLOT and the value is looked up by name
+        class BASE_UI_API ParamRef : public base::NoCopy
+        {
+        public:
+            ParamRef(const char* name);
+
+            /// get name of the parameter
+            INLINE base::StringID name() const { if (!m_resolved.load(std::memory_order_acquire)) resolve(); return m_name; }
+
+            /// get slot of the parameter
+            INLINE ParamSlot slot() const { if (!m_resolved.load(std::memory_order_acquire)) resolve(); return m_slot; }
+
+        private:
+            const char* m_text = nullptr;
+            mutable base::StringID m_name; // written once, before m_resolved is set
+            mutable ParamSlot m_slot = INVALID_PARAM_SLOT; // written once, before m_resolved is set
+            mutable std::atomic<bool> m_resolved = false;
+
+            void resolve() const;
+        };
+
+        //--
+
+        /// well known style parameters queried by the base elements
+        namespace params
+        {
+            extern BASE_UI_API const ParamRef Background;
+            extern BASE_UI_API const ParamRef BorderBottom;
+            extern BASE_UI_API const ParamRef BorderColor;
+            extern BASE_UI_API const ParamRef BorderLeft;
+            extern BASE_UI_API const ParamRef BorderRadius;
+            extern BASE_UI_API const ParamRef BorderRight;
+            extern BASE_UI_API const ParamRef BorderTop;
+            extern BASE_UI_API const ParamRef BorderWidth;
+            extern BASE_UI_API const ParamRef Color;
+            extern BASE_UI_API const ParamRef Content;
+            extern BASE_UI_API const ParamRef Fadeout;
+            extern BASE_UI_API const ParamRef FontFamily;
+            extern BASE_UI_API const ParamRef FontSize;
+            extern BASE_UI_API const ParamRef FontStyle;
+            extern BASE_UI_API const ParamRef FontWeight;
+            extern BASE_UI_API const ParamRef Height;
+            extern BASE_UI_API const ParamRef Highlight;
+            extern BASE_UI_API const ParamRef HorizontalAlign;
+            extern BASE_UI_API const ParamRef Image;
+            extern BASE_UI_API const ParamRef ImageScaleX;
+            extern BASE_UI_API const ParamRef ImageScaleY;
+            extern BASE_UI_API const ParamRef InitialHeight;
+            extern BASE_UI_API const ParamRef InitialWidth;
+            extern BASE_UI_API const ParamRef InnerHorizontalAlign;
+            extern BASE_UI_API const ParamRef InnerVerticalAlign;
+            extern BASE_UI_API const ParamRef MarginBottom;
+            extern BASE_UI_API const ParamRef MarginLeft;
+            extern BASE_UI_API const ParamRef MarginRight;
+            extern BASE_UI_API const ParamRef MarginTop;
+            extern BASE_UI_API const ParamRef MaxHeight;
+            extern BASE_UI_API const ParamRef MaxWidth;
+            extern BASE_UI_API const ParamRef MinHeight;
+            extern BASE_UI_API const ParamRef MinWidth;
+            extern BASE_UI_API const ParamRef Opacity;
+            extern BASE_UI_API const ParamRef Overlay;
+            extern BASE_UI_API const ParamRef PaddingBottom;
+            extern BASE_UI_API const ParamRef PaddingLeft;
+            extern BASE_UI_API const ParamRef PaddingRight;
+            extern BASE_UI_API const ParamRef PaddingTop;
+            extern BASE_UI_API const ParamRef Proportion;
+            extern BASE_UI_API const ParamRef RelativeX;
+            extern BASE_UI_API const ParamRef Selection;
+            extern BASE_UI_API const ParamRef Shadow;
+            extern BASE_UI_API const ParamRef ShadowMargin;
+            extern BASE_UI_API const ParamRef ShadowPadding;
+            extern BASE_UI_API const ParamRef Tooltip;
+            extern BASE_UI_API const ParamRef VerticalAlign;
+            extern BASE_UI_API const ParamRef Width;
+            extern BASE_UI_API const ParamRef WindowAreaType;
+        } // params
+
+        //--
+
 #if 0
         /// internal style parameter index
         typedef uint16_t ParamIndex;
@@ -50,6 +50,7 @@ namespace ui
         hitTest(true);
         allowFocusFromClick(true);
         enableAutoExpand(true, true);
+        continuousRedraw(true);
     }
 
     CanvasArea::~CanvasArea()
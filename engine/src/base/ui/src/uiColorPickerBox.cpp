@@ -125,8 +125,12 @@ namespace ui
 
     void ColorPickerLSBox::hls(const base::Vector3& val)
     {
-        m_value = val;
-        recomputeGeometry(m_rectSize);
+        if (m_value != val)
+        {
+            m_value = val;
+            recomputeGeometry(m_rectSize);
+            requestRedraw();
+        }
     }
 
     void ColorPickerLSBox::renderForeground(const ElementArea& drawArea, base::canvas::Canvas& canvas, float mergedOpacity)
@@ -322,7 +326,11 @@ namespace ui
 
     void ColorPickerHueBar::hue(float h)
     {
-        m_hue = h;
+        if (m_hue != h)
+        {
+            m_hue = h;
+            requestRedraw();
+        }
     }
 
     void ColorPickerHueBar::renderForeground(const ElementArea& drawArea, base::canvas::Canvas& canvas, float mergedOpacity)
@@ -170,6 +170,9 @@ namespace ui
                 m_cursorToggleTime.resetToNow();
                 m_cursorToggleTime += m_cursorToggleInterval;
             }
+
+            // keep blinking the cursor
+            requestRedraw();
         }
     }
 
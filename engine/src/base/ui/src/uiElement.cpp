@@ -122,6 +122,8 @@ namespace ui
         , m_autoExpandY(false)
         , m_overlay(false)
         , m_renderOverlayElements(true)
+        , m_continuousRedraw(false)
+        , m_redrawRequested(true)
     {
     }
 
@@ -706,7 +708,7 @@ namespace ui
 
     bool IElement::handleWindowAreaQuery(const ElementArea& area, const Position& absolutePosition, base::input::AreaType& outAreaType) const
     {
-        if (auto areaType = evalStyleValueIfPresentPtr<base::input::AreaType>("windowAreaType"_id))
+        if (auto areaType = evalStyleValueIfPresentPtr<base::input::AreaType>(style::params::WindowAreaType))
         {
             outAreaType = *areaType;
             return true;
@@ -1192,16 +1194,51 @@ namespace ui
         m_cachedLayoutValid = false;
         invalidateCachedChildrenPlacement();
         requestChildLayoutUpdate();
+        requestRedraw();
     }
 
     void IElement::invalidateGeometry()
     {
-        m_cachedGeometryStyleHash = 0;
-        m_cachedGeometrySize = Size(0, 0);
-
         // do not delete the cached geometry data - we may reuse the buffers
-        /*MemDelete(m_cachedGeometry);
-        m_cachedGeometry = nullptr;*/
+        m_cachedGeometryDirty |= ElementGeometryDirtyBit::Content;
+        requestRedraw();
+    }
+
+    void IElement::requestRedraw()
+    {
+        // the request is stored at the root of the hierarchy (the window)
+        auto* root = this;
+        while (auto* parent = root->parentElement())
+            root = parent;
+
+        root->m_redrawRequested = true;
+    }
+
+    bool IElement::consumeRedrawRequest()
+    {
+        DEBUG_CHECK_EX(!parentElement(), "Redraw requests are stored only at the root elements");
+        const bool requested = m_redrawRequested;
+        m_redrawRequested = false;
+        return requested;
+    }
+
+    void IElement::continuousRedraw(bool flag)
+    {
+        if (m_continuousRedraw != flag)
+        {
+            m_continuousRedraw = flag;
+            requestRedraw();
+        }
+    }
+
+    void IElement::opacity(float val)
+    {
+        val = std::clamp<float>(val, 0.0f, 1.0f);
+        if (m_opacity != val)
+        {
+            m_opacity = val;
+            requestRedraw();
+        }
     }
 
     style::SelectorMatchContext* IElement::styleSelector()
@@ -1216,6 +1253,7 @@ namespace ui
     void IElement::invalidateStyle()
     {
         requestChildStyleUpdate();
+        requestRedraw();
     }
 
     //------
@@ -1346,6 +1384,7 @@ namespace ui
         // refresh the layout and styles of the element
         m_childrenWithDirtyLayout.insert(childElement);
         m_childrenWithDirtyStyle.insert(childElement);
+        requestRedraw();
 
         // overlay child
         if (childElement->m_overlay)
@@ -1377,6 +1416,7 @@ namespace ui
         m_childrenWithDirtyStyle.remove(childElement);
         ASSERT(!m_childrenWithDirtyStyle.contains(childElement));
         ASSERT(!m_childrenWithDirtyLayout.contains(childElement));
+        requestRedraw();
 
         // remove from list
         childElement->parent(nullptr);
@@ -1507,7 +1547,7 @@ namespace ui
             m_cachedStyle.selectorKey = stack.selectorKey();
             if (stack.buildTable(m_cachedStyle.paramsKey, m_cachedStyle.params) || pixelScaleChanged)
             {
-                m_cachedStyle.opacity = evalStyleValue<float>("opacity"_id, 1.0f);
+                m_cachedStyle.opacity = evalStyleValue<float>(style::params::Opacity, 1.0f);
                 invalidateLayout();
                 invalidateGeometry();
             }
@@ -1528,19 +1568,19 @@ namespace ui
 
         // extract padding
         {
-            float left = evalStyleValue<float>("padding-left"_id) * m_cachedStyle.pixelScale;
-            float top = evalStyleValue<float>("padding-top"_id) * m_cachedStyle.pixelScale;
-            float right = evalStyleValue<float>("padding-right"_id) * m_cachedStyle.pixelScale;
-            float bottom = evalStyleValue<float>("padding-bottom"_id) * m_cachedStyle.pixelScale;
+            float left = evalStyleValue<float>(style::params::PaddingLeft) * m_cachedStyle.pixelScale;
+            float top = evalStyleValue<float>(style::params::PaddingTop) * m_cachedStyle.pixelScale;
+            float right = evalStyleValue<float>(style::params::PaddingRight) * m_cachedStyle.pixelScale;
+            float bottom = evalStyleValue<float>(style::params::PaddingBottom) * m_cachedStyle.pixelScale;
             outLayout.m_padding = Offsets(left, top, right, bottom);
         }
 
         // extract margin
         {
-            float left = evalStyleValue<float>("margin-left"_id) * m_cachedStyle.pixelScale;
-            float top = evalStyleValue<float>("margin-top"_id) * m_cachedStyle.pixelScale;
-            float right = evalStyleValue<float>("margin-right"_id) * m_cachedStyle.pixelScale;
-            float bottom = evalStyleValue<float>("margin-bottom"_id) * m_cachedStyle.pixelScale;
+            float left = evalStyleValue<float>(style::params::MarginLeft) * m_cachedStyle.pixelScale;
+            float top = evalStyleValue<float>(style::params::MarginTop) * m_cachedStyle.pixelScale;
+            float right = evalStyleValue<float>(style::params::MarginRight) * m_cachedStyle.pixelScale;
+            float bottom = evalStyleValue<float>(style::params::MarginBottom) * m_cachedStyle.pixelScale;
             outLayout.m_margin = Offsets(left, top, right, bottom);
         }
 
@@ -1549,12 +1589,12 @@ namespace ui
         auto defaultVerticalAlignment = m_autoExpandY ? ElementVerticalLayout::Expand : ElementVerticalLayout::Top;
 
         // extract alignment from styles
-        outLayout.m_verticalAlignment = evalStyleValue("vertical-align"_id, defaultVerticalAlignment);
-        outLayout.m_horizontalAlignment = evalStyleValue("horizontal-align"_id, defaultHorizontalAlignment);
+        outLayout.m_verticalAlignment = evalStyleValue(style::params::VerticalAlign, defaultVerticalAlignment);
+        outLayout.m_horizontalAlignment = evalStyleValue(style::params::HorizontalAlign, defaultHorizontalAlignment);
 
         // extract inner alignment
-        outLayout.m_internalHorizontalAlignment = evalStyleValue("inner-horizontal-align"_id, ElementHorizontalLayout::Left);
-        outLayout.m_internalVerticalAlignment = evalStyleValue("inner-vertical-align"_id, ElementVerticalLayout::Top);
+        outLayout.m_internalHorizontalAlignment = evalStyleValue(style::params::InnerHorizontalAlign, ElementHorizontalLayout::Left);
+        outLayout.m_internalVerticalAlignment = evalStyleValue(style::params::InnerVerticalAlign, ElementVerticalLayout::Top);
 
         ElementVerticalLayout m_internalVerticalAlignment = ElementVerticalLayout::Top;
         ElementHorizontalLayout m_internalHorizontalAlignment = ElementHorizontalLayout::Left;
@@ -1563,11 +1603,11 @@ namespace ui
         if (m_layout == LayoutMode::Columns)
             outLayout.m_horizontalAlignment = ElementHorizontalLayout::Expand;
 
-        outLayout.m_relative.x = evalStyleValue("relative-x"_id, 0.0f) * m_cachedStyle.pixelScale;
-        outLayout.m_relative.y = evalStyleValue("relative-x"_id, 0.0f) * m_cachedStyle.pixelScale;
+        outLayout.m_relative.x = evalStyleValue(style::params::RelativeX, 0.0f) * m_cachedStyle.pixelScale;
+        outLayout.m_relative.y = evalStyleValue(style::params::RelativeX, 0.0f) * m_cachedStyle.pixelScale;
 
         // extract proportion information for sizers
-        outLayout.m_proportion = evalStyleValue("proportion"_id, 0.0f);
+        outLayout.m_proportion = evalStyleValue(style::params::Proportion, 0.0f);
 
         // extract basic size
         computeSize(outLayout.m_innerSize);
@@ -1577,40 +1617,40 @@ namespace ui
             float val = 0.0;
 
             // limit X size
-            if (evalStyleValueIfPresent("width"_id, val))
+            if (evalStyleValueIfPresent(style::params::Width, val))
             {
                 outLayout.m_innerSize.x = val * m_cachedStyle.pixelScale;
             }
             else
             {
-                auto minSize = evalStyleValue<float>("min-width"_id, 0.0f) * m_cachedStyle.pixelScale;
+                auto minSize = evalStyleValue<float>(style::params::MinWidth, 0.0f) * m_cachedStyle.pixelScale;
                 if (outLayout.m_innerSize.x < minSize)
                 {
                     outLayout.m_innerSize.x = minSize;
                 }
                 else
                 {
-                    auto maxSize = evalStyleValue<float>("max-width"_id, FLT_MAX) * m_cachedStyle.pixelScale;
+                    auto maxSize = evalStyleValue<float>(style::params::MaxWidth, FLT_MAX) * m_cachedStyle.pixelScale;
                     if (outLayout.m_innerSize.x > maxSize)
                         outLayout.m_innerSize.x = maxSize;
                 }
             }
 
             // limit Y size
-            if (evalStyleValueIfPresent("height"_id, val))
+            if (evalStyleValueIfPresent(style::params::Height, val))
             {
                 outLayout.m_innerSize.y = val * m_cachedStyle.pixelScale;
             }
             else
             {
-                auto minSize = evalStyleValue<float>("min-height"_id, 0.0f) * m_cachedStyle.pixelScale;
+                auto minSize = evalStyleValue<float>(style::params::MinHeight, 0.0f) * m_cachedStyle.pixelScale;
                 if (outLayout.m_innerSize.y < minSize)
                 {
                     outLayout.m_innerSize.y = minSize;
                 }
                 else
                 {
-                    auto maxSize = evalStyleValue<float>("max-height"_id, FLT_MAX) * m_cachedStyle.pixelScale;
+                    auto maxSize = evalStyleValue<float>(style::params::MaxHeight, FLT_MAX) * m_cachedStyle.pixelScale;
                     if (outLayout.m_innerSize.y > maxSize)
                         outLayout.m_innerSize.y = maxSize;
                 }
@@ -1658,9 +1698,9 @@ namespace ui
 
             if (initial)
             {
-                if (auto initialWidth = evalStyleValueIfPresentPtr<float>("initial-width"_id))
+                if (auto initialWidth = evalStyleValueIfPresentPtr<float>(style::params::InitialWidth))
                     layout.m_innerSize.x = *initialWidth;
-                if (auto initialHeight = evalStyleValueIfPresentPtr<float>("initial-height"_id))
+                if (auto initialHeight = evalStyleValueIfPresentPtr<float>(style::params::InitialHeight))
                     layout.m_innerSize.y = *initialHeight;
             }
 
@@ -1673,7 +1713,7 @@ namespace ui
     void IElement::prepareShadowGeometry(const ElementArea& drawArea, float pixelScale, base::canvas::GeometryBuilder& builder) const
     {
         // draw the dimming rect as big as the clip area
-        if (auto fadeoutPtr = evalStyleValueIfPresentPtr<style::RenderStyle>("fadeout"_id))
+        if (auto fadeoutPtr = evalStyleValueIfPresentPtr<style::RenderStyle>(style::params::Fadeout))
         {
             ElementArea drawRect(-10000.0f, -10000.0f, 20000.0f, 20000.0f);
             auto style = fadeoutPtr->evaluate(pixelScale, drawRect);
@@ -1685,10 +1725,10 @@ namespace ui
         }
 
         // draw the shadow
-        if (auto shadowPtr = evalStyleValueIfPresentPtr<style::RenderStyle>("shadow"_id))
+        if (auto shadowPtr = evalStyleValueIfPresentPtr<style::RenderStyle>(style::params::Shadow))
         {
-            float margin = evalStyleValue<float>("shadow-margin"_id, 0.0f) * pixelScale;
-            float padding = evalStyleValue<float>("shadow-padding"_id, 0.0f) * pixelScale;
+            float margin = evalStyleValue<float>(style::params::ShadowMargin, 0.0f) * pixelScale;
+            float padding = evalStyleValue<float>(style::params::ShadowPadding, 0.0f) * pixelScale;
             if (padding > 0.0f)
             {
                 auto shadowArea = drawArea.extend(padding, padding, padding, padding);
@@ -1709,7 +1749,7 @@ namespace ui
         auto sx = drawArea.size().x - inset * 2.0f;
         auto sy = drawArea.size().y - inset * 2.0f;
 
-        float borderRadius = evalStyleValue<float>("border-radius"_id, 0.0f) * pixelScale;
+        float borderRadius = evalStyleValue<float>(style::params::BorderRadius, 0.0f) * pixelScale;
         if (borderRadius > 0.0f)
             builder.roundedRect(ox, oy, sx, sy, borderRadius);
         else
@@ -1720,9 +1760,9 @@ namespace ui
 
     void IElement::prepareBackgroundGeometry(const ElementArea& drawArea, float pixelScale, base::canvas::GeometryBuilder& builder) const
     {
-        if (auto shadowPtr = evalStyleValueIfPresentPtr<style::RenderStyle>("background"_id))
+        if (auto shadowPtr = evalStyleValueIfPresentPtr<style::RenderStyle>(style::params::Background))
         {
-            float borderWidth = evalStyleValue<float>("border-width"_id, 0.0f) * pixelScale;
+            float borderWidth = evalStyleValue<float>(style::params::BorderWidth, 0.0f) * pixelScale;
 
             auto style = shadowPtr->evaluate(pixelScale, drawArea);
             adjustBackgroundStyle(style, borderWidth);
@@ -1744,11 +1784,11 @@ namespace ui
 
     void IElement::prepareOverlayGeometry(const ElementArea& drawArea, float pixelScale, base::canvas::GeometryBuilder& builder) const
     {
-        if (auto borderStylePtr = evalStyleValueIfPresentPtr<base::Color>("border-color"_id))
+        if (auto borderStylePtr = evalStyleValueIfPresentPtr<base::Color>(style::params::BorderColor))
         {
             if (borderStylePtr->a > 0)
             {
-                float borderWidth = evalStyleValue<float>("border-width"_id, 0.0f) * pixelScale;
+                float borderWidth = evalStyleValue<float>(style::params::BorderWidth, 0.0f) * pixelScale;
                 if (borderWidth > 0.0f)
                 {
                     auto style = base::canvas::SolidColor(*borderStylePtr);
@@ -1762,10 +1802,10 @@ namespace ui
                 }
                 else
                 {
-                    auto borderLeft = evalStyleValue<float>("border-left"_id, 0.0f) * pixelScale;
-                    auto borderTop = evalStyleValue<float>("border-top"_id, 0.0f) * pixelScale;
-                    auto borderRight = evalStyleValue<float>("border-right"_id, 0.0f) * pixelScale;
-                    auto borderBottom = evalStyleValue<float>("border-bottom"_id, 0.0f) * pixelScale;
+                    auto borderLeft = evalStyleValue<float>(style::params::BorderLeft, 0.0f) * pixelScale;
+                    auto borderTop = evalStyleValue<float>(style::params::BorderTop, 0.0f) * pixelScale;
+                    auto borderRight = evalStyleValue<float>(style::params::BorderRight, 0.0f) * pixelScale;
+                    auto borderBottom = evalStyleValue<float>(style::params::BorderBottom, 0.0f) * pixelScale;
                     if (borderLeft > 0.0f || borderTop > 0.0f || borderRight > 0.0f || borderBottom > 0.0f)
                     {
                         auto style = base::canvas::SolidColor(*borderStylePtr);
@@ -1813,7 +1853,7 @@ namespace ui
             }
         }
 
-        if (auto overlayStylePtr = evalStyleValueIfPresentPtr<style::RenderStyle>("overlay"_id))
+        if (auto overlayStylePtr = evalStyleValueIfPresentPtr<style::RenderStyle>(style::params::Overlay))
         {
             auto style = overlayStylePtr->evaluate(pixelScale, drawArea);
 
@@ -1883,6 +1923,9 @@ namespace ui
     }
 
     std::atomic<uint32_t> GStatGeometryRebuild = 0;
+    std::atomic<uint32_t> GStatGeometryRebuildStyle = 0;
+    std::atomic<uint32_t> GStatGeometryRebuildSize = 0;
+    std::atomic<uint32_t> GStatGeometryRebuildContent = 0;
 
     void IElement::rebuildCachedGeometry(const ElementArea& drawArea)
     {
@@ -1932,9 +1975,24 @@ namespace ui
 
     void IElement::prepareCachedGeometry(const ElementArea& drawArea)
     {
-        auto fetchNewGeometry = (m_cachedGeometryStyleHash != m_cachedStyle.paramsKey) || (m_cachedGeometrySize != drawArea.size());
-        if (fetchNewGeometry)
+        // NOTE: position of the element is not part of the key, geometry is placed with a transform so scrolling or moving the element does not rebuild it
+        if (m_cachedGeometryStyleHash != m_cachedStyle.paramsKey)
+            m_cachedGeometryDirty |= ElementGeometryDirtyBit::Style;
+        if (m_cachedGeometrySize != drawArea.size())
+            m_cachedGeometryDirty |= ElementGeometryDirtyBit::Size;
+
+        if (!m_cachedGeometryDirty.empty())
+        {
+            if (m_cachedGeometryDirty.test(ElementGeometryDirtyBit::Style))
+                GStatGeometryRebuildStyle += 1;
+            if (m_cachedGeometryDirty.test(ElementGeometryDirtyBit::Size))
+                GStatGeometryRebuildSize += 1;
+            if (m_cachedGeometryDirty.test(ElementGeometryDirtyBit::Content))
+                GStatGeometryRebuildContent += 1;
+
             rebuildCachedGeometry(drawArea.resetOffset());
+            m_cachedGeometryDirty = ElementGeometryDirtyFlags();
+        }
     }
 
     void IElement::prepareDynamicSizing(const ElementArea& drawArea, const ElementDynamicSizing*& dataPtr) const
@@ -1950,6 +2008,10 @@ namespace ui
     {
         ASSERT(m_visibility != VisibilityState::Hidden);
 
+        // we are being drawn, consume the redraw request
+        if (!parentElement())
+            consumeRedrawRequest();
+
         // calculate opacity for this element and following elements
         auto mergedOpacity = m_opacity * parentMergedOpacity * m_cachedStyle.opacity;
         if (mergedOpacity <= 0.0f)
@@ -1979,6 +2041,10 @@ namespace ui
         // prepare cached geometry
         prepareCachedGeometry(drawArea);
 
+        // content that changes every frame keeps the window dirty
+        if (m_continuousRedraw)
+            requestRedraw();
+
         // draw element shadows - NOTE - drawing with parent clipping rect
         renderShadow(drawArea, canvas, mergedOpacity);
 
@@ -2036,7 +2102,7 @@ namespace ui
 
     ElementPtr IElement::queryTooltipElement(const Position& absolutePosition) const
     {
-        if (auto tooltipStringPtr = evalStyleValueIfPresentPtr<base::StringBuf>("tooltip"_id))
+        if (auto tooltipStringPtr = evalStyleValueIfPresentPtr<base::StringBuf>(style::params::Tooltip))
         {
             auto tooltipText = *tooltipStringPtr;
             if (!tooltipText.empty())
@@ -2188,6 +2254,10 @@ namespace ui
             m_nextTick = m_scheduleTime + m_tickInterval;
         }
 
+        // timers usually change the visual state of the owner
+        if (m_owner)
+            m_owner->requestRedraw();
+
         // call the timer function
         if (func && func(m_name ? m_name : "OnTimer"_id, m_owner, m_owner, base::CreateVariant(timeElapsed)))
             return true;
@@ -2279,9 +2349,12 @@ namespace ui
         auto numStyleUpdate = GStatPrepareStyle.exchange(0);
         auto numLayoutUpdate = GStatComputeLayout.exchange(0);
         auto numGeometryUpdate = GStatGeometryRebuild.exchange(0);
+        auto numGeometryStyle = GStatGeometryRebuildStyle.exchange(0);
+        auto numGeometrySize = GStatGeometryRebuildSize.exchange(0);
+        auto numGeometryContent = GStatGeometryRebuildContent.exchange(0);
         if (numStyleUpdate || numLayoutUpdate || numGeometryUpdate)
         {
-            TRACE_INFO("UI Update: {} style, {} layout, {} geom", numStyleUpdate, numLayoutUpdate, numGeometryUpdate);
+            TRACE_INFO("UI Update: {} style, {} layout, {} geom ({} style, {} size, {} content)", numStyleUpdate, numLayoutUpdate, numGeometryUpdate, numGeometryStyle, numGeometrySize, numGeometryContent);
         }
     }
 
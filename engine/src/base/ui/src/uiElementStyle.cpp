@@ -44,11 +44,11 @@ namespace ui
             libIndex += 1;
         }
 
-        // calculate hash of the generated parameter set
+        // calculate hash of the generated parameter set, the per-table keys are computed once when tables are compiled
         // TODO: could be better - here we don't take into account that some styles may get overridden
         base::CRC64 tableKey;
         for (const auto& table : collectedTables)
-            table->values.calcCRC64(tableKey);
+            tableKey << table->key;
 
         // easy case - we already have data
         if (outTableKey == tableKey.crc())
@@ -75,14 +75,14 @@ namespace ui
     {
         TBaseClass::computeSize(outSize);
 
-        if (const auto* imageStylePtr = evalStyleValueIfPresentPtr<style::ImageReference>("image"_id))
+        if (const auto* imageStylePtr = evalStyleValueIfPresentPtr<style::ImageReference>(style::params::Image))
         {
             if (const auto image = imageStylePtr->image.acquire())
             {
-                float width = image->width() * evalStyleValue<float>("image-scale-x"_id, 1.0f);
-                float height = image->height() * evalStyleValue<float>("image-scale-y"_id, 1.0f);
+                float width = image->width() * evalStyleValue<float>(style::params::ImageScaleX, 1.0f);
+                float height = image->height() * evalStyleValue<float>(style::params::ImageScaleY, 1.0f);
 
-                if (const auto* maxWidthPtr = evalStyleValueIfPresentPtr<float>("max-width"_id))
+                if (const auto* maxWidthPtr = evalStyleValueIfPresentPtr<float>(style::params::MaxWidth))
                 {
                     if (*maxWidthPtr > 0.0f && width > *maxWidthPtr)
                     {
@@ -91,7 +91,7 @@ namespace ui
                     }
                 }
 
-                if (const auto* maxHeightPtr = evalStyleValueIfPresentPtr<float>("max-height"_id))
+                if (const auto* maxHeightPtr = evalStyleValueIfPresentPtr<float>(style::params::MaxHeight))
                 {
                     if (*maxHeightPtr > 0.0f && height > * maxHeightPtr)
                     {
@@ -116,7 +116,7 @@ namespace ui
         TBaseClass::prepareShadowGeometry(drawArea, pixelScale, builder);
 
         // TODO: proper "drop shadow"
-        /*if (const auto* imageStylePtr = evalStyleValueIfPresentPtr<style::RenderStyle>("image"_id))
+        /*if (const auto* imageStylePtr = evalStyleValueIfPresentPtr<style::RenderStyle>(style::params::Image))
         {
             const auto *shadowPos = cachedStyleParams().m_params->typedPtr(params::GShadowPosX);
             if (shadowPos != nullptr)
@@ -147,7 +147,7 @@ namespace ui
     {
         TBaseClass::prepareForegroundGeometry(drawArea, pixelScale, builder);
 
-        if (const auto *imageStylePtr = evalStyleValueIfPresentPtr<style::ImageReference>("image"_id))
+        if (const auto *imageStylePtr = evalStyleValueIfPresentPtr<style::ImageReference>(style::params::Image))
         {
             if (const auto image = imageStylePtr->image.acquire())
             {
@@ -157,7 +157,7 @@ namespace ui
 
                 auto style = base::canvas::ImagePattern(image, imageSettings);
 
-                if (const auto* colorStylePtr = evalStyleValueIfPresentPtr<base::Color>("color"_id))
+                if (const auto* colorStylePtr = evalStyleValueIfPresentPtr<base::Color>(style::params::Color))
                     style.innerColor = style.outerColor = *colorStylePtr;
 
                 float ox = std::max<float>(0.0f, drawArea.size().x - m_imageSize.x) * 0.5f;
@@ -0,0 +1,127 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "uiElement.h"
+#include "uiColorPickerBox.h"
+#include "uiRuler.h"
+
+#include "base/test/include/gtest/gtest.h"
+
+DECLARE_TEST_FILE(UIRedraw);
+
+using namespace ui;
+
+namespace
+{
+    // root with a child, redraw request of the root already consumed (as if the window was just drawn)
+    template< typename T >
+    static base::RefPtr<T> CreateDrawnHierarchy(base::RefPtr<IElement>& outRoot)
+    {
+        outRoot = base::CreateSharedPtr<IElement>();
+        auto child = outRoot->createChild<T>();
+        outRoot->consumeRedrawRequest();
+        return child;
+    }
+
+} // anonymous
+
+TEST(UIRedraw, NewElementRequestsRedraw)
+{
+    auto root = base::CreateSharedPtr<IElement>();
+    EXPECT_TRUE(root->isRedrawRequested());
+    EXPECT_TRUE(root->consumeRedrawRequest());
+    EXPECT_FALSE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, UnchangedWindowIsNotRedrawn)
+{
+    base::RefPtr<IElement> root;
+    auto hue = CreateDrawnHierarchy<ColorPickerHueBar>(root);
+
+    // nothing changed since last draw
+    EXPECT_FALSE(root->isRedrawRequested());
+
+    // setting the same value is not a change
+    hue->hue(hue->hue());
+    EXPECT_FALSE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, RequestIsStoredAtRoot)
+{
+    base::RefPtr<IElement> root;
+    auto hue = CreateDrawnHierarchy<ColorPickerHueBar>(root);
+
+    hue->requestRedraw();
+    EXPECT_TRUE(root->isRedrawRequested());
+    EXPECT_TRUE(root->consumeRedrawRequest());
+    EXPECT_FALSE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, GeometryInvalidationRequestsRedraw)
+{
+    base::RefPtr<IElement> root;
+    auto child = CreateDrawnHierarchy<IElement>(root);
+
+    child->invalidateGeometry();
+    EXPECT_TRUE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, OpacityChangeRequestsRedraw)
+{
+    base::RefPtr<IElement> root;
+    auto child = CreateDrawnHierarchy<IElement>(root);
+
+    child->opacity(0.5f);
+    EXPECT_TRUE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, HueChangeRequestsRedraw)
+{
+    base::RefPtr<IElement> root;
+    auto hue = CreateDrawnHierarchy<ColorPickerHueBar>(root);
+
+    hue->hue(0.5f);
+    EXPECT_TRUE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, ColorChangeRequestsRedraw)
+{
+    base::RefPtr<IElement> root;
+    auto box = CreateDrawnHierarchy<ColorPickerLSBox>(root);
+
+    box->hls(base::Vector3(0.5f, 0.5f, 0.5f));
+    EXPECT_TRUE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, RulerRegionChangeRequestsRedraw)
+{
+    base::RefPtr<IElement> root;
+    auto ruler = CreateDrawnHierarchy<HorizontalRuler>(root);
+
+    ruler->region(10.0f, 20.0f);
+    EXPECT_TRUE(root->consumeRedrawRequest());
+
+    ruler->region(10.0f, 20.0f);
+    EXPECT_FALSE(root->isRedrawRequested());
+
+    ruler->activeRegion(12.0f, 15.0f);
+    EXPECT_TRUE(root->isRedrawRequested());
+}
+
+TEST(UIRedraw, VerticalRulerRegionChangeRequestsRedraw)
+{
+    base::RefPtr<IElement> root;
+    auto ruler = CreateDrawnHierarchy<VerticalRuler>(root);
+
+    ruler->region(10.0f, 20.0f);
+    EXPECT_TRUE(root->consumeRedrawRequest());
+
+    ruler->activeRegion(12.0f, 15.0f);
+    EXPECT_TRUE(root->isRedrawRequested());
+}
@@ -734,8 +734,14 @@ namespace ui
         {
             PC_SCOPE_LVL1(PullInput);
             for (auto& info : m_windows)
+            {
+                info.inputReceived = false;
                 while (auto evt = m_native->windowPullInputEvent(info.nativeId))
+                {
                     inputEvents.pushBack(evt);
+                    info.inputReceived = true;
+                }
+            }
         }
 
         // activation state
@@ -808,6 +814,15 @@ namespace ui
                 ElementArea windowArea;
                 if (m_native->windowGetRenderableArea(info.nativeId, windowArea))
                 {
+                    // nothing changed in the window since last time - keep the content that is already presented
+                    if (!needsRedraw(info, windowArea))
+                    {
+                        m_numSkippedWindowRedraws += 1;
+                        continue;
+                    }
+
+                    info.lastRenderedArea = windowArea;
+
                     if (!info.hitCache)
                         info.hitCache.create();
 
@@ -833,6 +848,7 @@ namespace ui
                 else
                 {
                     info.hitCache.reset();
+                    info.lastRenderedArea = ElementArea();
                 }
             }
         }
@@ -841,6 +857,27 @@ namespace ui
         PrintElementStats();
     }
 
+    bool Renderer::needsRedraw(const WindowInfo& info, const ElementArea& windowArea) const
+    {
+        // content of the window was invalidated
+        if (info.window->isRedrawRequested())
+            return true;
+
+        // native window changed size or position
+        if (!info.hitCache || info.lastRenderedArea.absolutePosition() != windowArea.absolutePosition() || info.lastRenderedArea.size() != windowArea.size())
+            return true;
+
+        // input may change the visual state in a way not tracked by the elements (ie. pressed buttons)
+        if (info.inputReceived)
+            return true;
+
+        // active input actions render directly to the canvas
+        if (m_currentInputAction && m_currentInputAction->element() && m_currentInputAction->element()->findParentWindow() == info.window)
+            return true;
+
+        return false;
+    }
+
     void Renderer::resetTooltip()
     {
         m_lastHoverUpdateTime = base::NativeTimePoint::Now();
@@ -30,14 +30,22 @@ namespace ui
 
     void HorizontalRuler::region(float minVal, float maxVal)
     {
-        m_viewRegionMin = minVal;
-        m_viewRegionMax = maxVal;
+        if (m_viewRegionMin != minVal || m_viewRegionMax != maxVal)
+        {
+            m_viewRegionMin = minVal;
+            m_viewRegionMax = maxVal;
+            requestRedraw();
+        }
     }
 
     void HorizontalRuler::activeRegion(float minVal, float maxVal)
     {
-        m_viewActiveRegionMin = minVal;
-        m_viewActiveRegionMax = maxVal;
+        if (m_viewActiveRegionMin != minVal || m_viewActiveRegionMax != maxVal)
+        {
+            m_viewActiveRegionMin = minVal;
+            m_viewActiveRegionMax = maxVal;
+            requestRedraw();
+        }
     }
 
     void HorizontalRuler::renderBackground(const ElementArea& drawArea, base::canvas::Canvas& canvas, float mergedOpacity)
@@ -163,14 +171,22 @@ namespace ui
 
     void VerticalRuler::region(float minVal, float maxVal)
     {
-        m_viewRegionMin = minVal;
-        m_viewRegionMax = maxVal;
+        if (m_viewRegionMin != minVal || m_viewRegionMax != maxVal)
+        {
+            m_viewRegionMin = minVal;
+            m_viewRegionMax = maxVal;
+            requestRedraw();
+        }
     }
 
     void VerticalRuler::activeRegion(float minVal, float maxVal)
     {
-        m_viewActiveRegionMin = minVal;
-        m_viewActiveRegionMax = maxVal;
+        if (m_viewActiveRegionMin != minVal || m_viewActiveRegionMax != maxVal)
+        {
+            m_viewActiveRegionMin = minVal;
+            m_viewActiveRegionMax = maxVal;
+            requestRedraw();
+        }
     }
 
     void VerticalRuler::renderBackground(const ElementArea& drawArea, base::canvas::Canvas& canvas, float mergedOpacity)
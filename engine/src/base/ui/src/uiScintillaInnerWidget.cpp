@@ -46,6 +46,7 @@ namespace Scintilla
 
         // request dynamic drawing every frame since we don't do any caching here
         hitTest(ui::HitTestState::Enabled);
+        continuousRedraw(true);
 
         // update scrollbars
         m_updateScrollBarsTimer = [this]() { updateScrollbar();  };
@@ -163,6 +163,8 @@ namespace ui
 
             if (m_horizontalScrollBar)
                 m_horizontalScrollBar->scrollPosition(m_scrollOffset.x, false);
+
+            requestRedraw();
         }
 
         if (offset.y != m_scrollOffset.y)
@@ -171,6 +173,8 @@ namespace ui
 
             if (m_verticalScrollBar)
                 m_verticalScrollBar->scrollPosition(m_scrollOffset.y, false);
+
+            requestRedraw();
         }
     }
 
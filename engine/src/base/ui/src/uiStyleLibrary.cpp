@@ -68,6 +68,19 @@ namespace ui
             ParentValueTable(m_values, this);
         }
 
+        void Library::onPostLoad()
+        {
+            TBaseClass::onPostLoad();
+            RegisterParamSlots(m_selectors);
+        }
+
+        void Library::RegisterParamSlots(const base::Array<SelectorNode>& selectors)
+        {
+            for (const auto& selector : selectors)
+                for (const auto& param : selector.parameters())
+                    RegisterParamSlot(param.paramName());
+        }
+
         const SelectorMatch* Library::matchSelectors(const SelectorMatchContext& context) const
         {
             base::ScopeLock<base::SpinLock> lock(m_selectorMapLock);
@@ -148,6 +161,7 @@ namespace ui
                 return m_emptyParams;
 
             // lookup in local cache
+            base::ScopeLock<base::SpinLock> lock(m_paramTableCacheLock);
             ParamTablePtr ret;
             if (m_paramTableCache.find(compoundHash, ret))
                 return ret;
@@ -174,6 +188,8 @@ namespace ui
                 }
             }
 
+            // flatten into slot table, done once per unique combination of selectors
+            ret->compile();
             return ret;
         }
 
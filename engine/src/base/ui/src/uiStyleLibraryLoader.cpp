@@ -1007,8 +1007,11 @@ namespace ui
             base::Array<SelectorNode> selectorNodes;
             tree.extractSelectorNodes(selectorNodes);
 
+            // assign dense slots to all parameters we've seen so the elements can query them without going by name
+            Library::RegisterParamSlots(selectorNodes);
+
             // final stats
-            TRACE_INFO("Compiled {} style variables and {} style selectors", selectorNodes.size(), values.values().size());
+            TRACE_INFO("Compiled {} style variables and {} style selectors ({} parameter slots)", selectorNodes.size(), values.values().size(), NumParamSlots());
 
             // set the output content
             return base::CreateSharedPtr<ui::style::Library>(std::move(selectorNodes), std::move(values.values()));
@@ -9,6 +9,7 @@
 #include "build.h"
 #include "uiStyleParameters.h"
 #include "uiStyleValue.h"
+#include "base/system/include/scopeLock.h"
 #include "base/object/include/streamBinaryWriter.h"
 #include "base/object/include/streamTextWriter.h"
 #include "base/object/include/streamBinaryReader.h"
@@ -19,6 +20,192 @@ namespace ui
     namespace style
     {
 
+        //----
+
+        namespace helper
+        {
+            class ParamSlotRegistry : public base::ISingleton
+            {
+                DECLARE_SINGLETON(ParamSlotRegistry);
+
+            public:
+                ParamSlotRegistry()
+                {
+                    m_slotMap.reserve(256);
+                }
+
+                ParamSlot registerSlot(base::StringID name)
+                {
+                    if (!name)
+                        return INVALID_PARAM_SLOT;
+
+                    auto lock = CreateLock(m_lock);
+
+                    ParamSlot slot = INVALID_PARAM_SLOT;
+                    if (m_slotMap.find(name, slot))
+                        return slot;
+
+                    const auto count = m_numSlots.load();
+                    if (count >= MAX_PARAM_SLOTS)
+                    {
+                        TRACE_ERROR("Out of style parameter slots, parameter '{}' will only be accessible by name", name);
+                        DEBUG_CHECK_EX(false, "Out of style parameter slots, increase MAX_PARAM_SLOTS");
+                        return INVALID_PARAM_SLOT;
+                    }
+
+                    slot = range_cast<ParamSlot>(count);
+                    m_slotMap.set(name, slot);
+                    m_numSlots.store(count + 1);
+                    return slot;
+                }
+
+                ParamSlot findSlot(base::StringID name) const
+                {
+                    auto lock = CreateLock(m_lock);
+
+                    ParamSlot slot = INVALID_PARAM_SLOT;
+                    m_slotMap.find(name, slot);
+                    return slot;
+                }
+
+                INLINE uint32_t numSlots() const
+                {
+                    return m_numSlots.load();
+                }
+
+            private:
+                base::HashMap<base::StringID, ParamSlot> m_slotMap;
+                std::atomic<uint32_t> m_numSlots = 0;
+                mutable base::SpinLock m_lock;
+
+                virtual void deinit() override
+                {
+                    m_slotMap.clear();
+                }
+            };
+
+        } // helper
+
+        ParamSlot RegisterParamSlot(base::StringID name)
+        {
+            return helper::ParamSlotRegistry::GetInstance().registerSlot(name);
+        }
+
+        ParamSlot FindParamSlot(base::StringID name)
+        {
+            return helper::ParamSlotRegistry::GetInstance().findSlot(name);
+        }
+
+        uint32_t NumParamSlots()
+        {
+            return helper::ParamSlotRegistry::GetInstance().numSlots();
+        }
+
+        //----
+
+        ParamRef::ParamRef(const char* name)
+            : m_text(name)
+        {}
+
+        static base::SpinLock GParamRefResolveLock;
+
+        void ParamRef::resolve() const
+        {
+            auto lock = CreateLock(GParamRefResolveLock);
+
+            // other thread may have resolved it while we were waiting
+            if (m_resolved.load(std::memory_order_relaxed))
+                return;
+
+            m_name = base::StringID(m_text);
+            m_slot = RegisterParamSlot(m_name);
+            m_resolved.store(true, std::memory_order_release);
+        }
+
+        //----
+
+        namespace params
+        {
+            const ParamRef Background("background");
+            const ParamRef BorderBottom("border-bottom");
+            const ParamRef BorderColor("border-color");
+            const ParamRef BorderLeft("border-left");
+            const ParamRef BorderRadius("border-radius");
+            const ParamRef BorderRight("border-right");
+            const ParamRef BorderTop("border-top");
+            const ParamRef BorderWidth("border-width");
+            const ParamRef Color("color");
+            const ParamRef Content("content");
+            const ParamRef Fadeout("fadeout");
+            const ParamRef FontFamily("font-family");
+            const ParamRef FontSize("font-size");
+            const ParamRef FontStyle("font-style");
+            const ParamRef FontWeight("font-weight");
+            const ParamRef Height("height");
+            const ParamRef Highlight("highlight");
+            const ParamRef HorizontalAlign("horizontal-align");
+            const ParamRef Image("image");
+            const ParamRef ImageScaleX("image-scale-x");
+            const ParamRef ImageScaleY("image-scale-y");
+            const ParamRef InitialHeight("initial-height");
+            const ParamRef InitialWidth("initial-width");
+            const ParamRef InnerHorizontalAlign("inner-horizontal-align");
+            const ParamRef InnerVerticalAlign("inner-vertical-align");
+            const ParamRef MarginBottom("margin-bottom");
+            const ParamRef MarginLeft("margin-left");
+            const ParamRef MarginRight("margin-right");
+            const ParamRef MarginTop("margin-top");
+            const ParamRef MaxHeight("max-height");
+            const ParamRef MaxWidth("max-width");
+            const ParamRef MinHeight("min-height");
+            const ParamRef MinWidth("min-width");
+            const ParamRef Opacity("opacity");
+            const ParamRef Overlay("overlay");
+            const ParamRef PaddingBottom("padding-bottom");
+            const ParamRef PaddingLeft("padding-left");
+            const ParamRef PaddingRight("padding-right");
+            const ParamRef PaddingTop("padding-top");
+            const ParamRef Proportion("proportion");
+            const ParamRef RelativeX("relative-x");
+            const ParamRef Selection("selection");
+            const ParamRef Shadow("shadow");
+            const ParamRef ShadowMargin("shadow-margin");
+            const ParamRef ShadowPadding("shadow-padding");
+            const ParamRef Tooltip("tooltip");
+            const ParamRef VerticalAlign("vertical-align");
+            const ParamRef Width("width");
+            const ParamRef WindowAreaType("windowAreaType");
+        } // params
+
+        //----
+
+        void ParamTable::compile()
+        {
+            // key of the table, used to quickly check if anything changed
+            base::CRC64 crc;
+            values.calcCRC64(crc);
+            key = crc.crc();
+
+            // flatten the values into the slot table
+            slots.reset();
+            slots.resize(NumParamSlots());
+            for (const auto& entry : values.parameters())
+            {
+                const auto slot = RegisterParamSlot(entry.name);
+                if (slot == INVALID_PARAM_SLOT)
+                    continue;
+
+                if (slot >= slots.size())
+                    slots.resize(slot + 1);
+
+                auto& val = slots[slot];
+                val.type = entry.data.type();
+                val.data = entry.data.data();
+            }
+        }
+
+        //----
+
 #if 0
         //----
 
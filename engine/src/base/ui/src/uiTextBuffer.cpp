@@ -91,19 +91,19 @@ namespace ui
         auto prevFont = m_font;
         auto prevSize = m_fontSize;
 
-        if (auto style = styleOwner->evalStyleValueIfPresentPtr<style::FontFamily>("font-family"_id))
+        if (auto style = styleOwner->evalStyleValueIfPresentPtr<style::FontFamily>(style::params::FontFamily))
         {
             m_font = style->normal;
-            m_fontSize = std::max<uint32_t>(1, std::floorf(styleOwner->evalStyleValue<float>("font-size"_id, 14.0f) * styleOwner->cachedStyleParams().pixelScale));
+            m_fontSize = std::max<uint32_t>(1, std::floorf(styleOwner->evalStyleValue<float>(style::params::FontSize, 14.0f) * styleOwner->cachedStyleParams().pixelScale));
         }
 
-        if (const auto* stylePtr = styleOwner->evalStyleValueIfPresentPtr<base::Color>("color"_id))
+        if (const auto* stylePtr = styleOwner->evalStyleValueIfPresentPtr<base::Color>(style::params::Color))
             m_textColor = *stylePtr;
 
-        if (const auto* stylePtr = styleOwner->evalStyleValueIfPresentPtr<base::Color>("selection"_id))
+        if (const auto* stylePtr = styleOwner->evalStyleValueIfPresentPtr<base::Color>(style::params::Selection))
             m_selectionColor = *stylePtr;
 
-        if (const auto* stylePtr = styleOwner->evalStyleValueIfPresentPtr<base::Color>("highlight"_id))
+        if (const auto* stylePtr = styleOwner->evalStyleValueIfPresentPtr<base::Color>(style::params::Highlight))
             m_hightlightColor = *stylePtr;
 
         if (m_font != prevFont || m_fontSize != prevSize)
@@ -87,7 +87,7 @@ namespace ui
     {
         // get text to process
         auto text = m_text;
-        if (const auto* content = evalStyleValueIfPresentPtr<base::StringBuf>("content"_id))
+        if (const auto* content = evalStyleValueIfPresentPtr<base::StringBuf>(style::params::Content))
             text = *content;
 
         // create the layout data
@@ -99,13 +99,13 @@ namespace ui
 
         // render data
         {
-            const auto bold = style::FontWeight::Bold == evalStyleValue("font-weight"_id, style::FontWeight::Normal);
-            const auto italic = style::FontStyle::Italic == evalStyleValue("font-style"_id, style::FontStyle::Normal);
-            const auto size = std::max<uint32_t>(1, std::floorf(evalStyleValue<float>("font-size"_id, 14.0f) * cachedStyleParams().pixelScale));
-            const auto fonts = evalStyleValue<style::FontFamily>("font-family"_id);
+            const auto bold = style::FontWeight::Bold == evalStyleValue(style::params::FontWeight, style::FontWeight::Normal);
+            const auto italic = style::FontStyle::Italic == evalStyleValue(style::params::FontStyle, style::FontStyle::Normal);
+            const auto size = std::max<uint32_t>(1, std::floorf(evalStyleValue<float>(style::params::FontSize, 14.0f) * cachedStyleParams().pixelScale));
+            const auto fonts = evalStyleValue<style::FontFamily>(style::params::FontFamily);
 
             base::Color color = base::Color::WHITE;
-            if (auto textColorPtr = evalStyleValueIfPresentPtr<base::Color>("color"_id))
+            if (auto textColorPtr = evalStyleValueIfPresentPtr<base::Color>(style::params::Color))
                 color = *textColorPtr;
 
             m_data->render(renderer()->stash(), fonts, cachedStyleParams().pixelScale, size, bold, italic, color, -1.0f, *m_displayData);
@@ -177,7 +177,7 @@ namespace ui
         if (m_highlightStartPos != m_highlightEndPos)
         {
             base::Color highlightColor = base::Color::WHITE;
-            if (auto highlightColorPtr = evalStyleValueIfPresentPtr<style::RenderStyle>("highlight"_id))
+            if (auto highlightColorPtr = evalStyleValueIfPresentPtr<style::RenderStyle>(style::params::Highlight))
                 highlightColor = highlightColorPtr->innerColor;
             if (highlightColor.a > 0)
             {
@@ -88,6 +88,7 @@ namespace ui
         allowFocusFromClick(true);
         renderOverlayElements(false);
         enableAutoExpand(true, true);
+        continuousRedraw(true);
     }
 
     VirtualArea::~VirtualArea()
@@ -217,7 +217,7 @@ namespace ui
 
     void Window::prepareBackgroundGeometry(const ElementArea& drawArea, float pixelScale, base::canvas::GeometryBuilder& builder) const
     {
-        if (auto shadowPtr = evalStyleValueIfPresentPtr<style::RenderStyle>("background"_id))
+        if (auto shadowPtr = evalStyleValueIfPresentPtr<style::RenderStyle>(style::params::Background))
         {
             if (shadowPtr->type == 0)
             {
@@ -0,0 +1,49 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: xml #]
+***/
+
+#pragma once
+
+namespace base
+{
+    namespace xml
+    {
+        class ILoadingReporter;
+
+        //---
+
+        /// attribute of the node reported by the stream parser
+        struct StreamAttribute
+        {
+            StringView<char> name;
+            StringView<char> value; // entities already resolved
+        };
+
+        /// receiver of the XML content parsed in a streaming (SAX) way
+        /// NOTE: all the views passed to the handler are valid only during the call
+        class BASE_XML_API IStreamHandler
+        {
+        public:
+            virtual ~IStreamHandler();
+
+            /// node was opened, return false to stop parsing
+            virtual bool onNodeStart(StringView<char> name, const StreamAttribute* attributes, uint32_t numAttributes) = 0;
+
+            /// text (or CDATA) content of the current node, leading and trailing white spaces are removed, white space only text is not reported
+            virtual bool onNodeValue(StringView<char> value);
+
+            /// node was closed (also called for self closing nodes)
+            virtual bool onNodeEnd(StringView<char> name);
+        };
+
+        // parse the XML text and report the content to the handler without building a document
+        // NOTE: this is much faster and uses less memory than LoadDocument() if the content is only visited once (ie. scanning for dependencies)
+        // returns false if the XML is malformed (errors are reported) or if the handler stopped the parsing
+        extern BASE_XML_API bool ParseStream(ILoadingReporter& ctx, StringView<char> text, IStreamHandler& handler);
+
+    } // xml
+} // base
@@ -0,0 +1,491 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: xml #]
+***/
+
+#include "build.h"
+#include "xmlStreamParser.h"
+#include "xmlUtils.h"
+
+#include "base/containers/include/inplaceArray.h"
+
+namespace base
+{
+    namespace xml
+    {
+
+        //---
+
+        IStreamHandler::~IStreamHandler()
+        {}
+
+        bool IStreamHandler::onNodeValue(StringView<char> value)
+        {
+            return true;
+        }
+
+        bool IStreamHandler::onNodeEnd(StringView<char> name)
+        {
+            return true;
+        }
+
+        //---
+
+        namespace helper
+        {
+            INLINE static bool IsWhiteSpace(char ch)
+            {
+                return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+            }
+
+            INLINE static bool IsNameChar(char ch)
+            {
+                return !IsWhiteSpace(ch) && ch != '/' && ch != '>' && ch != '<' && ch != '=' && ch != '?' && ch != '!' && ch != '\'' && ch != '"' && ch != 0;
+            }
+
+            static void AppendUTF8(Array<char>& out, uint32_t code)
+            {
+                if (code < 0x80)
+                {
+                    out.pushBack((char)code);
+                }
+                else if (code < 0x800)
+                {
+                    out.pushBack((char)(0xC0 | (code >> 6)));
+                    out.pushBack((char)(0x80 | (code & 0x3F)));
+                }
+                else if (code < 0x10000)
+                {
+                    out.pushBack((char)(0xE0 | (code >> 12)));
+                    out.pushBack((char)(0x80 | ((code >> 6) & 0x3F)));
+                    out.pushBack((char)(0x80 | (code & 0x3F)));
+                }
+                else
+                {
+                    out.pushBack((char)(0xF0 | (code >> 18)));
+                    out.pushBack((char)(0x80 | ((code >> 12) & 0x3F)));
+                    out.pushBack((char)(0x80 | ((code >> 6) & 0x3F)));
+                    out.pushBack((char)(0x80 | (code & 0x3F)));
+                }
+            }
+
+            // single pass over the text, nothing is allocated except the scratch memory for the values with entities
+            class StreamParser : public NoCopy
+            {
+            public:
+                StreamParser(ILoadingReporter& ctx, StringView<char> text, IStreamHandler& handler)
+                    : m_ctx(ctx)
+                    , m_handler(handler)
+                    , m_start(text.data())
+                    , m_end(text.data() + text.length())
+                    , m_pos(text.data())
+                {}
+
+                bool parse()
+                {
+                    // skip the UTF-8 BOM
+                    if (m_end - m_pos >= 3 && (uint8_t)m_pos[0] == 0xEF && (uint8_t)m_pos[1] == 0xBB && (uint8_t)m_pos[2] == 0xBF)
+                        m_pos += 3;
+
+                    bool hasRoot = false;
+                    while (m_pos < m_end)
+                    {
+                        if (*m_pos != '<')
+                        {
+                            if (!parseText())
+                                return false;
+                            continue;
+                        }
+
+                        if (startsWith("<?"))
+                        {
+                            if (!skipPast("?>", "unterminated processing instruction"))
+                                return false;
+                        }
+                        else if (startsWith("<!--"))
+                        {
+                            if (!skipPast("-->", "unterminated comment"))
+                                return false;
+                        }
+                        else if (startsWith("<![CDATA["))
+                        {
+                            if (!parseCData())
+                                return false;
+                        }
+                        else if (startsWith("<!"))
+                        {
+                            if (!skipPast(">", "unterminated declaration"))
+                                return false;
+                        }
+                        else if (startsWith("</"))
+                        {
+                            if (!parseNodeEnd())
+                                return false;
+                        }
+                        else
+                        {
+                            if (m_nodeStack.empty() && hasRoot)
+                                return reportError(m_pos, "multiple root nodes");
+
+                            hasRoot = true;
+                            if (!parseNodeStart())
+                                return false;
+                        }
+                    }
+
+                    if (!m_nodeStack.empty())
+                        return reportError(m_end, "unexpected end of data, node is not closed");
+
+                    if (!hasRoot)
+                        return reportError(m_end, "no root node");
+
+                    return true;
+                }
+
+            private:
+                ILoadingReporter& m_ctx;
+                IStreamHandler& m_handler;
+
+                const char* m_start;
+                const char* m_end;
+                const char* m_pos;
+
+                InplaceArray<StringView<char>, 32> m_nodeStack;
+
+                struct RawAttribute
+                {
+                    StringView<char> name;
+                    StringView<char> value;
+                    bool hasEntities = false;
+                };
+
+                InplaceArray<RawAttribute, 16> m_rawAttributes;
+                InplaceArray<StreamAttribute, 16> m_attributes;
+                Array<char> m_scratch;
+
+                //--
+
+                bool reportError(const char* pos, const char* text)
+                {
+                    // line information is computed only when needed
+                    uint32_t line = 1;
+                    uint32_t column = 1;
+                    for (auto ptr = m_start; ptr < pos && ptr < m_end; ++ptr)
+                    {
+                        if (*ptr == '\n')
+                        {
+                            line += 1;
+                            column = 1;
+                        }
+                        else
+                        {
+                            column += 1;
+                        }
+                    }
+
+                    m_ctx.onError(line, column, text);
+                    return false;
+                }
+
+                INLINE bool startsWith(const char* pattern) const
+                {
+                    auto ptr = m_pos;
+                    while (*pattern)
+                    {
+                        if (ptr >= m_end || *ptr != *pattern)
+                            return false;
+                        ++ptr;
+                        ++pattern;
+                    }
+
+                    return true;
+                }
+
+                INLINE void skipWhiteSpaces()
+                {
+                    while (m_pos < m_end && IsWhiteSpace(*m_pos))
+                        ++m_pos;
+                }
+
+                const char* find(const char* from, const char* pattern, uint32_t patternLength) const
+                {
+                    for (auto ptr = from; ptr + patternLength <= m_end; ++ptr)
+                        if (*ptr == *pattern && 0 == memcmp(ptr, pattern, patternLength))
+                            return ptr;
+
+                    return nullptr;
+                }
+
+                bool skipPast(const char* pattern, const char* errorText)
+                {
+                    const auto patternLength = (uint32_t)strlen(pattern);
+                    auto found = find(m_pos, pattern, patternLength);
+                    if (!found)
+                        return reportError(m_pos, errorText);
+
+                    m_pos = found + patternLength;
+                    return true;
+                }
+
+                StringView<char> parseName()
+                {
+                    auto nameStart = m_pos;
+                    while (m_pos < m_end && IsNameChar(*m_pos))
+                        ++m_pos;
+                    return StringView<char>(nameStart, m_pos);
+                }
+
+                //--
+
+                // resolve the entities (&amp; &#123; etc) into the scratch buffer, returns false if the entity is invalid
+                bool decodeEntities(StringView<char> txt, Array<char>& out)
+                {
+                    auto ptr = txt.data();
+                    auto end = txt.data() + txt.length();
+                    while (ptr < end)
+                    {
+                        if (*ptr != '&')
+                        {
+                            out.pushBack(*ptr++);
+                            continue;
+                        }
+
+                        auto entityEnd = ptr + 1;
+                        while (entityEnd < end && *entityEnd != ';' && (entityEnd - ptr) < 12)
+                            ++entityEnd;
+
+                        if (entityEnd >= end || *entityEnd != ';')
+                            return reportError(ptr, "unterminated entity");
+
+                        const auto entity = StringView<char>(ptr + 1, entityEnd);
+                        if (entity == "lt")
+                            out.pushBack('<');
+                        else if (entity == "gt")
+                            out.pushBack('>');
+                        else if (entity == "amp")
+                            out.pushBack('&');
+                        else if (entity == "quot")
+                            out.pushBack('"');
+                        else if (entity == "apos")
+                            out.pushBack('\'');
+                        else if (entity.length() >= 2 && entity.data()[0] == '#')
+                        {
+                            uint32_t code = 0;
+                            const bool hex = (entity.data()[1] == 'x' || entity.data()[1] == 'X');
+                            for (auto ch = entity.data() + (hex ? 2 : 1); ch < entityEnd; ++ch)
+                            {
+                                uint32_t digit = 0;
+                                if (*ch >= '0' && *ch <= '9')
+                                    digit = *ch - '0';
+                                else if (hex && *ch >= 'a' && *ch <= 'f')
+                                    digit = 10 + (*ch - 'a');
+                                else if (hex && *ch >= 'A' && *ch <= 'F')
+                                    digit = 10 + (*ch - 'A');
+                                else
+                                    return reportError(ptr, "invalid character code");
+
+                                code = (code * (hex ? 16 : 10)) + digit;
+                                if (code > 0x10FFFF)
+                                    return reportError(ptr, "invalid character code");
+                            }
+
+                            AppendUTF8(out, code);
+                        }
+                        else
+                        {
+                            return reportError(ptr, "unknown entity");
+                        }
+
+                        ptr = entityEnd + 1;
+                    }
+
+                    return true;
+                }
+
+                bool reportValue(StringView<char> value, bool hasEntities)
+                {
+                    if (!hasEntities)
+                        return m_handler.onNodeValue(value);
+
+                    m_scratch.reset();
+                    if (!decodeEntities(value, m_scratch))
+                        return false;
+
+                    return m_handler.onNodeValue(StringView<char>(m_scratch.typedData(), m_scratch.size()));
+                }
+
+                //--
+
+                bool parseText()
+                {
+                    auto textStart = m_pos;
+                    bool hasEntities = false;
+                    while (m_pos < m_end && *m_pos != '<')
+                    {
+                        hasEntities |= (*m_pos == '&');
+                        ++m_pos;
+                    }
+
+                    const auto text = StringView<char>(textStart, m_pos).trim();
+                    if (text.empty())
+                        return true;
+
+                    if (m_nodeStack.empty())
+                        return reportError(textStart, "text outside of the root node");
+
+                    return reportValue(text, hasEntities);
+                }
+
+                bool parseCData()
+                {
+                    auto dataStart = m_pos + 9; // <![CDATA[
+                    auto dataEnd = find(dataStart, "]]>", 3);
+                    if (!dataEnd)
+                        return reportError(m_pos, "unterminated CDATA");
+
+                    if (m_nodeStack.empty())
+                        return reportError(m_pos, "CDATA outside of the root node");
+
+                    m_pos = dataEnd + 3;
+
+                    const auto text = StringView<char>(dataStart, dataEnd).trim();
+                    return text.empty() || m_handler.onNodeValue(text);
+                }
+
+                bool parseNodeStart()
+                {
+                    auto nodeStart = m_pos;
+                    m_pos += 1; // <
+
+                    auto name = parseName();
+                    if (name.empty())
+                        return reportError(nodeStart, "expected node name");
+
+                    // collect the attributes as they are in the text
+                    m_rawAttributes.reset();
+                    uint32_t entitiesLength = 0;
+                    for (;;)
+                    {
+                        skipWhiteSpaces();
+                        if (m_pos >= m_end)
+                            return reportError(nodeStart, "unterminated node");
+
+                        if (*m_pos == '>' || *m_pos == '/')
+                            break;
+
+                        auto attrStart = m_pos;
+                        auto attrName = parseName();
+                        if (attrName.empty())
+                            return reportError(attrStart, "expected attribute name");
+
+                        skipWhiteSpaces();
+                        if (m_pos >= m_end || *m_pos != '=')
+                            return reportError(m_pos, "expected '=' after attribute name");
+                        ++m_pos;
+
+                        skipWhiteSpaces();
+                        if (m_pos >= m_end || (*m_pos != '"' && *m_pos != '\''))
+                            return reportError(m_pos, "expected quoted attribute value");
+
+                        const auto quote = *m_pos++;
+                        auto valueStart = m_pos;
+                        bool hasEntities = false;
+                        while (m_pos < m_end && *m_pos != quote)
+                        {
+                            hasEntities |= (*m_pos == '&');
+                            ++m_pos;
+                        }
+
+                        if (m_pos >= m_end)
+                            return reportError(valueStart, "unterminated attribute value");
+
+                        auto& attr = m_rawAttributes.emplaceBack();
+                        attr.name = attrName;
+                        attr.value = StringView<char>(valueStart, m_pos);
+                        attr.hasEntities = hasEntities;
+                        if (hasEntities)
+                            entitiesLength += attr.value.length();
+
+                        ++m_pos; // closing quote
+                    }
+
+                    // self closing ?
+                    bool selfClosing = false;
+                    if (*m_pos == '/')
+                    {
+                        ++m_pos;
+                        if (m_pos >= m_end || *m_pos != '>')
+                            return reportError(m_pos, "expected '>' after '/'");
+                        selfClosing = true;
+                    }
+                    ++m_pos; // >
+
+                    // resolve entities, decoded text is never longer than the original so the scratch memory won't move
+                    m_scratch.reset();
+                    m_scratch.reserve(entitiesLength);
+                    m_attributes.reset();
+                    for (const auto& raw : m_rawAttributes)
+                    {
+                        auto& attr = m_attributes.emplaceBack();
+                        attr.name = raw.name;
+
+                        if (raw.hasEntities)
+                        {
+                            const auto offset = m_scratch.size();
+                            if (!decodeEntities(raw.value, m_scratch))
+                                return false;
+                            attr.value = StringView<char>(m_scratch.typedData() + offset, m_scratch.size() - offset);
+                        }
+                        else
+                        {
+                            attr.value = raw.value;
+                        }
+                    }
+
+                    if (!m_handler.onNodeStart(name, m_attributes.typedData(), m_attributes.size()))
+                        return false;
+
+                    if (selfClosing)
+                        return m_handler.onNodeEnd(name);
+
+                    m_nodeStack.pushBack(name);
+                    return true;
+                }
+
+                bool parseNodeEnd()
+                {
+                    auto nodeStart = m_pos;
+                    m_pos += 2; // </
+
+                    auto name = parseName();
+                    skipWhiteSpaces();
+                    if (m_pos >= m_end || *m_pos != '>')
+                        return reportError(nodeStart, "expected '>' after closing node name");
+                    ++m_pos;
+
+                    if (m_nodeStack.empty())
+                        return reportError(nodeStart, "closing node that was not opened");
+
+                    if (m_nodeStack.back() != name)
+                        return reportError(nodeStart, "closing node does not match the opened node");
+
+                    m_nodeStack.popBack();
+                    return m_handler.onNodeEnd(name);
+                }
+            };
+
+        } // helper
+
+        bool ParseStream(ILoadingReporter& ctx, StringView<char> text, IStreamHandler& handler)
+        {
+            helper::StreamParser parser(ctx, text, handler);
+            return parser.parse();
+        }
+
+        //---
+
+    } // xml
+} // base
@@ -11,6 +11,7 @@
 #include "base/test/include/gtest/gtest.h"
 #include "base/xml/include/xmlUtils.h"
 #include "base/xml/include/xmlDocument.h"
+#include "base/xml/include/xmlStreamParser.h"
 
 using namespace base;
 
@@ -120,4 +121,107 @@ TEST(XML, Reparse)
     ASSERT_EQ(std::string(txtA.c_str()), std::string(txtB.c_str()));
 }
 
+//---
 
+namespace test
+{
+    // records the parsed content as text so it's easy to compare
+    class StreamRecorder : public xml::IStreamHandler
+    {
+    public:
+        StringBuilder m_txt;
+        const char* m_stopAtNode = nullptr;
+
+        virtual bool onNodeStart(StringView<char> name, const xml::StreamAttribute* attributes, uint32_t numAttributes) override final
+        {
+            m_txt.appendf("<{}", name);
+            for (uint32_t i = 0; i < numAttributes; ++i)
+                m_txt.appendf(" {}='{}'", attributes[i].name, attributes[i].value);
+            m_txt.append(">");
+            return !m_stopAtNode || name != m_stopAtNode;
+        }
+
+        virtual bool onNodeValue(StringView<char> value) override final
+        {
+            m_txt.appendf("[{}]", value);
+            return true;
+        }
+
+        virtual bool onNodeEnd(StringView<char> name) override final
+        {
+            m_txt.appendf("</{}>", name);
+            return true;
+        }
+    };
+
+    class ErrorCounter : public xml::ILoadingReporter
+    {
+    public:
+        uint32_t m_numErrors = 0;
+        uint32_t m_lastLine = 0;
+
+        virtual void onError(uint32_t line, uint32_t pos, const char* text) override final
+        {
+            m_numErrors += 1;
+            m_lastLine = line;
+        }
+    };
+
+} // test
+
+TEST(XMLStream, ParseSample)
+{
+    test::StreamRecorder recorder;
+    ASSERT_TRUE(xml::ParseStream(xml::ILoadingReporter::GetDefault(), xmlSample, recorder));
+    EXPECT_EQ(std::string("<doc><node x='a' y='b'><test></test></node><node x='a' y='b'><test></test></node></doc>"), std::string(recorder.m_txt.c_str()));
+}
+
+TEST(XMLStream, ValuesAndEntities)
+{
+    const char* txt =
+        "<?xml version=\"1.0\"?>\n"
+        "<!-- comment <node/> -->\n"
+        "<doc a=\"1 &amp; 2\" b='&lt;&#65;&#x42;&gt;'>\n"
+        "  <value>  some &quot;text&quot;  </value>\n"
+        "  <data><![CDATA[<raw & data>]]></data>\n"
+        "</doc>\n";
+
+    test::StreamRecorder recorder;
+    ASSERT_TRUE(xml::ParseStream(xml::ILoadingReporter::GetDefault(), txt, recorder));
+    EXPECT_EQ(std::string("<doc a='1 & 2' b='<AB>'><value>[some \"text\"]</value><data>[<raw & data>]</data></doc>"), std::string(recorder.m_txt.c_str()));
+}
+
+TEST(XMLStream, HandlerCanStopParsing)
+{
+    test::StreamRecorder recorder;
+    recorder.m_stopAtNode = "test";
+    EXPECT_FALSE(xml::ParseStream(xml::ILoadingReporter::GetDefault(), xmlSample, recorder));
+    EXPECT_EQ(std::string("<doc><node x='a' y='b'><test>"), std::string(recorder.m_txt.c_str()));
+}
+
+TEST(XMLStream, MalformedDocuments)
+{
+    const char* txts[] = {
+        "",
+        "<doc>",
+        "<doc><a></b></doc>",
+        "<doc/><doc/>",
+        "<doc a=1/>",
+        "<doc a=\"&unknown;\"/>",
+        "<doc>\n<!-- not closed </doc>",
+        "text<doc/>",
+    };
+
+    for (const auto* txt : txts)
+    {
+        test::StreamRecorder recorder;
+        test::ErrorCounter errors;
+        EXPECT_FALSE(xml::ParseStream(errors, txt, recorder)) << txt;
+        EXPECT_EQ(1, errors.m_numErrors) << txt;
+    }
+
+    test::StreamRecorder recorder;
+    test::ErrorCounter errors;
+    EXPECT_FALSE(xml::ParseStream(errors, "<doc>\n<a>\n</b>\n</doc>", recorder));
+    EXPECT_EQ(3, errors.m_lastLine);
+}
@@ -29,6 +29,12 @@ namespace rendering
             /// render canvas content into current render pass 
             void render(command::CommandWriter& cmd, const base::canvas::Canvas& canvas, const CanvasRenderingParams& params);
 
+            /// record canvas content using multiple fibers, each job records into its own segment of the canvas
+            /// segments are appended to the canvas in the job order so the final draw order is deterministic
+            /// NOTE: the function is called concurrently, it must not touch the canvas directly
+            typedef std::function<void(base::canvas::Canvas& segment, uint32_t jobIndex)> TRecordFunction;
+            void recordParallel(base::canvas::Canvas& canvas, uint32_t numJobs, const TRecordFunction& func);
+
         private:            
             virtual base::app::ServiceInitializationResult onInitializeService(const base::app::CommandLine& cmdLine) override final;
             virtual void onShutdownService() override final;
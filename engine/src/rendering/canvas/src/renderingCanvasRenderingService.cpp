@@ -12,6 +12,8 @@
 #include "renderingCanvasImageCache.h"
 
 #include "base/app/include/localServiceContainer.h"
+#include "base/canvas/include/canvas.h"
+#include "base/fibers/include/fiberSystem.h"
 #include "base/resources/include/resourceLoadingService.h"
 #include "rendering/driver/include/renderingDeviceService.h"
 
@@ -56,6 +58,33 @@ namespace rendering
             m_renderer->render(cmd, canvas, params);
         }
 
+        void CanvasRenderingService::recordParallel(base::canvas::Canvas& canvas, uint32_t numJobs, const TRecordFunction& func)
+        {
+            PC_SCOPE_LVL1(CanvasRecordParallel);
+
+            if (numJobs == 1)
+            {
+                func(canvas, 0);
+                return;
+            }
+
+            // record segments
+            base::Array<base::UniquePtr<base::canvas::Canvas>> segments;
+            segments.resize(numJobs);
+            RunFiberLoop("CanvasRecordSegment", numJobs, -1, [&segments, &canvas, &func](uint32_t index)
+                {
+                    segments[index] = base::CreateUniquePtr<base::canvas::Canvas>(&canvas);
+                    func(*segments[index], index);
+                });
+
+            // merge in order
+            {
+                PC_SCOPE_LVL2(MergeSegments);
+                for (const auto& segment : segments)
+                    canvas.append(*segment);
+            }
+        }
+
         //---
 
     } // canvas
@@ -115,6 +115,8 @@ namespace rendering
 
             bool m_isChildCommandBuffer = false;
             OpBeginPass* m_parentBufferBeginPass = nullptr;
+            uint32_t m_parentBufferPassRts = 0;
+            uint32_t m_parentBufferPassViewports = 0;
 
             volatile uint32_t m_writingThread = 0; // non zero if we are opened for writing
 
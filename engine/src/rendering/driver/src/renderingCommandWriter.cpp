@@ -66,6 +66,8 @@ namespace rendering
             m_currentParameterBindings = std::move(buffer->m_activeParameterBindings);
             m_currentPass = buffer->m_parentBufferBeginPass;
             m_isChildBufferWithParentPass = (buffer->m_parentBufferBeginPass != nullptr);
+            m_currentPassRts = buffer->m_parentBufferPassRts;
+            m_currentPassViewports = buffer->m_parentBufferPassViewports;
 
             // copy command buffer state into writer since writer is usually on stack 
             m_lastCommand = m_writeBuffer->m_lastCommand;
@@ -298,6 +300,8 @@ namespace rendering
             CommandBuffer* ret = CommandBuffer::Alloc();
             ret->m_isChildCommandBuffer = true;
             ret->m_parentBufferBeginPass = m_currentPass;
+            ret->m_parentBufferPassRts = m_currentPass ? m_currentPassRts : 0;
+            ret->m_parentBufferPassViewports = m_currentPass ? m_currentPassViewports : 0;
             if (inheritParameters)
                 ret->m_activeParameterBindings = m_currentParameterBindings;
 
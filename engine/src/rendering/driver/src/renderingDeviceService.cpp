@@ -27,6 +27,7 @@ namespace rendering
     //--
 
     RTTI_BEGIN_TYPE_CLASS(DeviceService);
+        RTTI_METADATA(base::app::ServiceThreadingMetadata).mainThreadInit(); // creates the rendering context and the windows
     RTTI_END_TYPE();
 
     DeviceService::DeviceService()
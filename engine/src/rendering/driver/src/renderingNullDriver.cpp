@@ -36,7 +36,7 @@ namespace rendering
 
     bool NullDriver::supportsAsyncCommandBufferBuilding() const
     {
-        return false;
+        return true; // nothing gets executed, command buffers can be recorded from any thread
     }
 
     bool NullDriver::initialize(const base::app::CommandLine& cmdLine)
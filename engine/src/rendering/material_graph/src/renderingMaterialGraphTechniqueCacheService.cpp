@@ -23,6 +23,7 @@ namespace rendering
     RTTI_BEGIN_TYPE_CLASS(MaterialTechniqueCacheService);
         RTTI_METADATA(base::app::DependsOnServiceMetadata).dependsOn<rendering::DeviceService>();
         RTTI_METADATA(base::app::DependsOnServiceMetadata).dependsOn<base::res::LoadingService>();
+        RTTI_METADATA(base::app::ServiceThreadingMetadata).parallelUpdate();
     RTTI_END_TYPE();
 
     MaterialTechniqueCacheService::MaterialTechniqueCacheService()
@@ -21,6 +21,7 @@ namespace rendering
 
     RTTI_BEGIN_TYPE_CLASS(MeshService);
     RTTI_METADATA(base::app::DependsOnServiceMetadata).dependsOn<rendering::DeviceService>();
+    RTTI_METADATA(base::app::ServiceThreadingMetadata).parallelUpdate();
     RTTI_END_TYPE();
 
     ///----
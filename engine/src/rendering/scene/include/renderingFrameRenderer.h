@@ -45,6 +45,9 @@ namespace rendering
 
             INLINE bool verticalFlip() const { return m_verticalFlip; }
 
+            // can we record parts of the frame into child command buffers on many fibers at once
+            INLINE bool asyncRecording() const { return m_asyncRecording; }
+
             INLINE const FrameParams& frame() const { return m_frame; }
 
             INLINE const FrameSurfaceCache& surfaces() const { return m_surfaces; }
@@ -75,6 +78,7 @@ namespace rendering
 
             bool m_msaa = false;
             bool m_verticalFlip = false;
+            bool m_asyncRecording = false;
 
             base::mem::LinearAllocator m_allocator;
 
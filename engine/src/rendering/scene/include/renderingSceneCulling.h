@@ -55,12 +55,21 @@ namespace rendering
         {
             const IProxy* proxy = nullptr;
             uint8_t cameraMask = 0;
-            uint16_t distance = 0;
+            uint16_t distance = 0; // quantized distance from camera, sqrt scale
+        };
+
+        /// list of visible objects of one type, memory is allocated from the frame arena so it's valid only for the frame it was culled in
+        struct SceneObjectCullingList
+        {
+            SceneObjectCullingEntry* entries = nullptr;
+            uint32_t numEntries = 0;
+
+            INLINE bool empty() const { return numEntries == 0; }
         };
 
         struct SceneObjectCullingResult : public base::NoCopy
         {
-            base::Array<SceneObjectCullingEntry> visibleObjects[(int)ProxyType::MAX];
+            SceneObjectCullingList visibleObjects[(int)ProxyType::MAX];
         };
 
         ///--
@@ -111,6 +120,7 @@ namespace rendering
             base::UniquePtr<ManagedBuffer> m_gpuObjectInfos;
 
             base::StaticStructurePool<SceneObjectInfo> m_objectInfos;
+            uint32_t m_numObjectsOfType[(int)ProxyType::MAX] = {}; // upper bound for the culling results
 
             //--
             
@@ -9,6 +9,8 @@
 #include "build.h"
 #include "renderingSceneFragmentList.h"
 
+#include "base/fibers/include/fiberSystem.h"
+
 namespace rendering
 {
     namespace scene
@@ -25,15 +27,19 @@ namespace rendering
         FragmentDrawList::~FragmentDrawList()
         {}
 
-        void FragmentDrawList::collectFragment(const Fragment* frag, FragmentDrawBucket bucket)
+        void FragmentDrawList::collectFragment(const Fragment* frag, FragmentDrawBucket bucket, uint64_t sortKey)
         {
+            DEBUG_CHECK_EX(!m_sorted, "Fragments can't be collected after the list was sorted");
+
             auto& list = m_lists[(int)bucket];
 
             if (!list.tail || list.tail->count == m_fragmentsPerPage)
             {
-                auto page = (FragmentPage*)m_memory.alloc(sizeof(FragmentPage) + (m_fragmentsPerPage - 1) * sizeof(Fragment*), 8);
+                auto page = (FragmentPage*)m_memory.alloc(sizeof(FragmentPage) + m_fragmentsPerPage * (sizeof(Fragment*) + sizeof(uint64_t)), 8);
                 page->count = 0;
                 page->next = nullptr;
+                page->fragments = (const Fragment**)(page + 1);
+                page->sortKeys = (uint64_t*)(page->fragments + m_fragmentsPerPage);
 
                 if (list.tail)
                     list.tail->next = page;
@@ -42,18 +48,132 @@ namespace rendering
                 list.tail = page;
             }
 
-            list.tail->fragments[list.tail->count++] = frag;
+            list.tail->fragments[list.tail->count] = frag;
+            list.tail->sortKeys[list.tail->count] = sortKey;
+            list.tail->count += 1;
+            list.count += 1;
+        }
+
+        static const uint32_t RADIX_BITS = 8;
+        static const uint32_t RADIX_SIZE = 1U << RADIX_BITS;
+        static const uint32_t RADIX_PASSES = 64 / RADIX_BITS;
+        static const uint32_t MIN_FRAGMENTS_FOR_PARALLEL_SORT = 4096;
+
+        void FragmentDrawList::SortList(FragmentList& list)
+        {
+            PC_SCOPE_LVL2(SortFragmentList);
+
+            // gather entries from all pages
+            auto* src = list.sortBuffers[0];
+            auto* dest = list.sortBuffers[1];
+            {
+                uint32_t index = 0;
+                for (const auto* page = list.head; page; page = page->next)
+                {
+                    for (uint32_t i = 0; i < page->count; ++i, ++index)
+                    {
+                        src[index].sortKey = page->sortKeys[i];
+                        src[index].fragment = page->fragments[i];
+                    }
+                }
+            }
+
+            // build histograms of all digits in one go
+            auto* histograms = list.sortHistograms;
+            memset(histograms, 0, sizeof(uint32_t) * RADIX_SIZE * RADIX_PASSES);
+            for (uint32_t i = 0; i < list.count; ++i)
+            {
+                const auto key = src[i].sortKey;
+                for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass)
+                    histograms[pass * RADIX_SIZE + ((key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1))] += 1;
+            }
+
+            // LSD radix sort, stable so fragments with the same key keep the collection order
+            for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass)
+            {
+                auto* histogram = histograms + pass * RADIX_SIZE;
+                const auto shift = pass * RADIX_BITS;
+
+                // all keys have the same digit, nothing to do in this pass (common for the unused high bits)
+                if (histogram[(src[0].sortKey >> shift) & (RADIX_SIZE - 1)] == list.count)
+                    continue;
+
+                uint32_t offset = 0;
+                for (uint32_t i = 0; i < RADIX_SIZE; ++i)
+                {
+                    const auto count = histogram[i];
+                    histogram[i] = offset;
+                    offset += count;
+                }
+
+                for (uint32_t i = 0; i < list.count; ++i)
+                {
+                    const auto& entry = src[i];
+                    dest[histogram[(entry.sortKey >> shift) & (RADIX_SIZE - 1)]++] = entry;
+                }
+
+                std::swap(src, dest);
+            }
+
+            for (uint32_t i = 0; i < list.count; ++i)
+                list.sortedFragments[i] = src[i].fragment;
+        }
+
+        void FragmentDrawList::sortFragments()
+        {
+            PC_SCOPE_LVL1(SortFragments);
+
+            if (m_sorted)
+                return;
+
+            // allocate the sorting memory up front, the allocator can't be used from the sorting jobs
+            base::InplaceArray<FragmentList*, (int)FragmentDrawBucket::MAX> listsToSort;
+            uint32_t totalFragments = 0;
+            for (auto& list : m_lists)
+            {
+                if (list.count)
+                {
+                    list.sortedFragments = (const Fragment**)m_memory.alloc(sizeof(Fragment*) * list.count, 8);
+                    list.sortBuffers[0] = (FragmentEntry*)m_memory.alloc(sizeof(FragmentEntry) * list.count, 8);
+                    list.sortBuffers[1] = (FragmentEntry*)m_memory.alloc(sizeof(FragmentEntry) * list.count, 8);
+                    list.sortHistograms = (uint32_t*)m_memory.alloc(sizeof(uint32_t) * RADIX_SIZE * RADIX_PASSES, 8);
+                    listsToSort.pushBack(&list);
+                    totalFragments += list.count;
+                }
+            }
+
+            if (listsToSort.size() > 1 && totalFragments >= MIN_FRAGMENTS_FOR_PARALLEL_SORT)
+            {
+                RunFiberLoop("SortFragments", listsToSort.size(), -1, [&listsToSort](uint32_t index)
+                    {
+                        SortList(*listsToSort[index]);
+                    });
+            }
+            else
+            {
+                for (auto* list : listsToSort)
+                    SortList(*list);
+            }
+
+            m_sorted = true;
         }
 
         void FragmentDrawList::iterateFragmentRanges(FragmentDrawBucket bucket, const std::function<void(const Fragment* const*fragments, uint32_t count)>& enumFunc) const
         {
-            const auto* page = m_lists[(int)bucket].head;
+            const auto& list = m_lists[(int)bucket];
+
+            if (m_sorted)
+            {
+                if (list.count)
+                    enumFunc(list.sortedFragments, list.count);
+                return;
+            }
 
-            while (page)
+            // not sorted, report the fragments page by page in the collection order
+            for (const auto* page = list.head; page; page = page->next)
             {
                 if (page->count)
-                    enumFunc(&page->fragments[0], page->count);
-                page = page->next;
+                    enumFunc(page->fragments, page->count);
             }
         }
 
@@ -16,6 +16,30 @@ namespace rendering
     namespace scene
     {
 
+        /// Sort keys for fragments, fragments with the same rendering state end up next to each other after sorting and can be merged into instanced draws
+        /// Opaque layout (MSB to LSB): handler type (8), technique (16), material data (16), geometry (16), quantized distance front-to-back (8)
+        /// Transparent layout (MSB to LSB): quantized distance back-to-front (16), handler type (8), technique (16), material data (16), geometry (8)
+        /// NOTE: bucket is not part of the key as every bucket is sorted separately
+        struct FragmentSortKey
+        {
+            /// hash a state object (technique, material data) into the number of bits available in the key
+            static INLINE uint16_t HashState(const void* ptr)
+            {
+                return (uint16_t)((((uint64_t)ptr >> 4) * 0x9E3779B97F4A7C15ULL) >> 48);
+            }
+
+            /// build the key for given fragment state, the distance is the quantized distance from the culling
+            static INLINE uint64_t Build(FragmentDrawBucket bucket, FragmentHandlerType type, const void* technique, const void* materialData, uint32_t geometry, uint16_t distance)
+            {
+                const uint64_t stateBits = ((uint64_t)HashState(technique) << 16) | HashState(materialData);
+
+                if (bucket == FragmentDrawBucket::Transparent)
+                    return ((uint64_t)(0xFFFF - distance) << 48) | ((uint64_t)type << 40) | (stateBits << 8) | (geometry & 0xFF);
+                else
+                    return ((uint64_t)type << 56) | (stateBits << 24) | ((uint64_t)(geometry & 0xFFFF) << 8) | (distance >> 8);
+            }
+        };
+
         /// Collected list of rendering fragments
         class RENDERING_SCENE_API FragmentDrawList : public base::NoCopy
         {
@@ -43,10 +67,14 @@ namespace rendering
 
             ///--
 
-            /// add fragment to draw list for given pass bit
-            void collectFragment(const Fragment* frag, FragmentDrawBucket bucket);
+            /// add fragment to draw list for given pass bit, fragments are drawn in the order of the sort keys once the list is sorted
+            void collectFragment(const Fragment* frag, FragmentDrawBucket bucket, uint64_t sortKey = 0);
+
+            /// sort fragments in all buckets by their sort keys, order of fragments with the same key is preserved
+            /// NOTE: must be called after all fragments were collected, buckets are sorted in parallel
+            void sortFragments();
 
-            // enumerate all fragments
+            // enumerate all fragments, sorted lists are reported as one range
             void iterateFragmentRanges(FragmentDrawBucket bucket, const std::function<void(const Fragment *const* fragments, uint32_t count)>& enumFunc) const;
 
             ///---
@@ -55,20 +83,35 @@ namespace rendering
             base::mem::LinearAllocator& m_memory;
             uint32_t m_fragmentsPerPage;
 
+            struct FragmentEntry
+            {
+                uint64_t sortKey = 0;
+                const Fragment* fragment = nullptr;
+            };
+
             struct FragmentPage
             {
                 uint32_t count = 0;
                 FragmentPage* next = nullptr;
-                const Fragment* fragments[1];
+                const Fragment** fragments = nullptr; // stored after the page header
+                uint64_t* sortKeys = nullptr; // stored after the fragments
             };
 
             struct FragmentList
             {
                 FragmentPage* head = nullptr;
                 FragmentPage* tail = nullptr;
+                uint32_t count = 0;
+
+                const Fragment** sortedFragments = nullptr; // valid after sorting
+                FragmentEntry* sortBuffers[2] = { nullptr, nullptr };
+                uint32_t* sortHistograms = nullptr;
             };
 
             FragmentList m_lists[(int)FragmentDrawBucket::MAX];
+            bool m_sorted = false;
+
+            static void SortList(FragmentList& list);
         };
 
     } // scene
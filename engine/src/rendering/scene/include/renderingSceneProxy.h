@@ -69,6 +69,11 @@ namespace rendering
                 return false;
             }
 
+            INLINE uint16_t distance() const
+            {
+                return (m_index < m_size) ? m_proxies[m_index].distance : 0;
+            }
+
             INLINE const T* operator->() const
             {
                 if (m_index < m_size)
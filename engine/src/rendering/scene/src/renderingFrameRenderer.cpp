@@ -18,6 +18,7 @@
 #include "renderingSceneFragmentList.h"
 
 #include "base/containers/include/stringBuilder.h"
+#include "base/fibers/include/fiberSystem.h"
 #include "rendering/driver/include/renderingCommandWriter.h"
 #include "rendering/driver/include/renderingCommandBuffer.h"
 #include "rendering/driver/include/renderingDriver.h"
@@ -32,6 +33,8 @@ namespace rendering
 
         base::mem::PoolID POOL_RENDERING_FRAME("Rendeirng.Frame");
 
+        base::ConfigProperty<bool> cvFrameAsyncRecording("Rendering.Frame", "AsyncRecording", true);
+
         //--
 
         FrameRenderer::FrameRenderer(IDriver* device, const FrameParams& frame, const FrameSurfaceCache& surfaces)
@@ -41,6 +44,7 @@ namespace rendering
             , m_allocator(POOL_RENDERING_FRAME)
         {
             m_verticalFlip = true; // FU OpenGl
+            m_asyncRecording = cvFrameAsyncRecording.get() && device && device->supportsAsyncCommandBufferBuilding() && Fibers::GetInstance().workerThreadCount() > 0;
 
             const auto* mainColor = m_surfaces.fetchImage(FrameResource::HDRLinearMainColorRT); // RT = surface only
             m_msaa = mainColor->numSamples() > 1;
@@ -25,6 +25,7 @@ namespace rendering
         //--
 
         RTTI_BEGIN_TYPE_CLASS(FrameRenderingService);
+            RTTI_METADATA(base::app::DependsOnServiceMetadata).dependsOn<DeviceService>();
         RTTI_END_TYPE();
 
         FrameRenderingService::FrameRenderingService()
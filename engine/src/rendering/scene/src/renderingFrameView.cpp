@@ -21,6 +21,11 @@
 #include "renderingFrameViewCamera.h"
 #include "renderingFrameViewPass.h"
 #include "renderingFrameViewPostFX.h"
+#include "renderingSceneStats.h"
+
+#include "base/fibers/include/fiberSystem.h"
+#include "base/system/include/timedScope.h"
+#include "rendering/driver/include/renderingCommandWriter.h"
 
 namespace rendering
 {
@@ -28,6 +33,10 @@ namespace rendering
     {
         //---
 
+        base::ConfigProperty<bool> cvTraceViewStats("Rendering.Scene", "TraceViewStats", false);
+
+        //---
+
         FrameView::FrameView(const FrameRenderer& frame, const FrameViewCamera& camera, base::StringView<char> name)
             : m_renderer(frame)
             , m_camera(camera)
@@ -39,6 +48,13 @@ namespace rendering
 
         FrameView::~FrameView()
         {
+            if (cvTraceViewStats.get())
+            {
+                TRACE_INFO("View '{}': {} mesh fragments, {} draws, {} pipeline switches, {} material switches, {} geometry switches, collect {}ms, record {}ms",
+                    m_name, m_stats.m_numMeshFragments, m_stats.m_numMeshDrawCommands, m_stats.m_numPipelineSwitches, m_stats.m_numMaterialSwitches, m_stats.m_numGeometrySwitches,
+                    Prec(m_stats.m_viewCollectTime, 2), Prec(m_stats.m_viewRenderTime, 2));
+            }
+
             for (auto* scene : m_scenes)
             {
                 scene->drawList->~FragmentDrawList();
@@ -46,6 +62,12 @@ namespace rendering
             }
         }
 
+        void FrameView::mergeStats(const SceneViewStats& stats) const
+        {
+            auto lock = base::CreateLock(m_statsLock);
+            stats.mergeOnto(m_stats);
+        }
+
         void FrameView::collect()
         {
             PC_SCOPE_LVL0(CollectView);
@@ -89,9 +111,12 @@ namespace rendering
                     if (!visibleObjectOfType.empty())
                     {
                         auto* handler = scene->scene->proxyHandlers()[j];
-                        handler->handleProxyFragments(cmd, *this, visibleObjectOfType.typedData(), visibleObjectOfType.size(), *scene->drawList);
+                        handler->handleProxyFragments(cmd, *this, visibleObjectOfType.entries, visibleObjectOfType.numEntries, *scene->drawList);
                     }
                 }
+
+                // order the fragments by state so the draws can be merged
+                scene->drawList->sortFragments();
             }
         }
 
@@ -104,6 +129,9 @@ namespace rendering
             FrameView view(frame, camera, "LitView");
             command::CommandWriterBlock block(cmd, "LitView");
 
+            SceneViewStats timeStats;
+            base::ScopeTimer timer;
+
             // collect visible objects in the view
             view.collect();
 
@@ -112,6 +140,7 @@ namespace rendering
 
             // prepare renderable fragments for the visible objects
             view.generateFragments(cmd);
+            timeStats.m_viewCollectTime = timer.milisecondsElapsed();
 
             // bind the camera setup
             camera.bind(cmd);
@@ -121,8 +150,27 @@ namespace rendering
             const auto& tempDepth = frame.fetchImage(FrameResource::HDRLinearMainDepthRT);
 
             // render passes
-            RenderDepthPrepass(cmd, view, camera, tempDepth);
-            RenderForwardPass(cmd, view, camera, tempDepth, tempColor);
+            // NOTE: passes only read the view so they can be recorded at the same time into child buffers, the buffers are created up front to keep the order of passes
+            if (view.asyncRecording())
+            {
+                command::CommandBuffer* passBuffers[2] = { cmd.opCreateChildCommandBuffer(), cmd.opCreateChildCommandBuffer() };
+                RunFiberLoop("RecordLitViewPasses", 2, -1, [&passBuffers, &view, &camera, &tempDepth, &tempColor](uint32_t index)
+                    {
+                        command::CommandWriter passCmd(passBuffers[index]);
+                        if (index == 0)
+                            RenderDepthPrepass(passCmd, view, camera, tempDepth);
+                        else
+                            RenderForwardPass(passCmd, view, camera, tempDepth, tempColor);
+                    });
+            }
+            else
+            {
+                RenderDepthPrepass(cmd, view, camera, tempDepth);
+                RenderForwardPass(cmd, view, camera, tempDepth, tempColor);
+            }
+
+            timeStats.m_viewRenderTime = timer.milisecondsElapsed() - timeStats.m_viewCollectTime;
+            view.mergeStats(timeStats);
 
             // capture depth as it's not going to change from now on (at least not legally...)
             ResolveMSAADepth(cmd, view, tempDepth, resolvedDepth);
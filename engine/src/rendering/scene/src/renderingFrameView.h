@@ -8,6 +8,7 @@
 
 #include "build.h"
 #include "renderingFrameRenderer.h"
+#include "renderingSceneStats.h"
 
 namespace rendering
 {
@@ -47,6 +48,15 @@ namespace rendering
             // parent frame
             INLINE const FrameParams& frame() const { return m_frame; }
 
+            // rendering stats of this view
+            INLINE const SceneViewStats& stats() const { return m_stats; }
+
+            // merge stats gathered while rendering part of this view, safe to call from many fibers
+            void mergeStats(const SceneViewStats& stats) const;
+
+            // can we record parts of this view on many fibers at once
+            INLINE bool asyncRecording() const { return m_renderer.asyncRecording(); }
+
         private:
             const FrameRenderer& m_renderer;
             const FrameParams& m_frame;
@@ -55,6 +65,9 @@ namespace rendering
             base::InplaceArray<PerSceneData*, 10> m_scenes;
 
             base::StringBuf m_name;
+
+            mutable base::SpinLock m_statsLock;
+            mutable SceneViewStats m_stats;
         };
 
         //--
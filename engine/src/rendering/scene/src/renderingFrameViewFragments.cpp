@@ -23,6 +23,7 @@
 #include "rendering/driver/include/renderingCommandBuffer.h"
 #include "rendering/driver/include/renderingDriver.h"
 #include "rendering/driver/include/renderingShaderLibrary.h"
+#include "base/fibers/include/fiberSystem.h"
 
 namespace rendering
 {
@@ -42,6 +43,8 @@ namespace rendering
 
         static base::res::StaticResource<ShaderLibrary> resDebugGeometryShader("engine/shaders/debug.fx");
 
+        base::ConfigProperty<int> cvAsyncRecordingMinFragmentsPerJob("Rendering.Frame", "AsyncRecordingMinFragmentsPerJob", 512);
+
         //---
 
         struct DebugFragmentData
@@ -164,6 +167,23 @@ namespace rendering
             return true;
         }
 
+        static void RenderFragmentRange(command::CommandWriter& cmd, const FrameView& view, const Scene& scene, const FragmentRenderContext& context, const Fragment* const* fragments, uint32_t count)
+        {
+            uint32_t index = 0;
+            while (index < count)
+            {
+                auto firstHandlerType = fragments[index]->type;
+                auto firstFragmentIndex = index;
+                while (++index < count)
+                    if (fragments[index]->type != firstHandlerType)
+                        break;
+
+
+                if (const auto* handler = scene.fragmentHandlers()[(uint8_t)firstHandlerType])
+                    handler->handleRender(cmd, view, context, fragments + firstFragmentIndex, index - firstFragmentIndex);
+            }
+        }
+
         void RenderViewFragments(command::CommandWriter& cmd, const FrameView& view, const FrameViewCamera& camera, const FragmentRenderContext& context, const std::initializer_list<FragmentDrawBucket>& buckets)
         {
             PC_SCOPE_LVL1(RenderViewFragments);
@@ -183,19 +203,29 @@ namespace rendering
                     {
                         scene->drawList->iterateFragmentRanges(bucket, [&scene, &cmd, &context, &view](const Fragment* const* fragments, uint32_t count)
                             {
-                                uint32_t index = 0;
-                                while (index < count)
+                                // large ranges are split into child command buffers recorded on many fibers, the children are created here so they are executed in the same order as the fragments
+                                const auto minFragmentsPerJob = (uint32_t)std::max<int>(1, cvAsyncRecordingMinFragmentsPerJob.get());
+                                const auto maxJobs = std::max<uint32_t>(1, Fibers::GetInstance().workerThreadCount());
+                                const auto numJobs = view.asyncRecording() ? std::min<uint32_t>(maxJobs, count / minFragmentsPerJob) : 1;
+                                if (numJobs <= 1)
                                 {
-                                    auto firstHandlerType = fragments[index]->type;
-                                    auto firstFragmentIndex = index;
-                                    while (++index < count)
-                                        if (fragments[index]->type != firstHandlerType)
-                                            break;
+                                    RenderFragmentRange(cmd, view, *scene->scene, context, fragments, count);
+                                    return;
+                                }
 
+                                base::InplaceArray<command::CommandBuffer*, 32> childBuffers;
+                                childBuffers.reserve(numJobs);
+                                for (uint32_t i = 0; i < numJobs; ++i)
+                                    childBuffers.pushBack(cmd.opCreateChildCommandBuffer());
 
-                                    if (const auto* handler = scene->scene->fragmentHandlers()[(uint8_t)firstHandlerType])
-                                        handler->handleRender(cmd, view, context, fragments + firstFragmentIndex, index - firstFragmentIndex);
-                                }
+                                RunFiberLoop("RecordViewFragments", numJobs, -1, [&childBuffers, &scene, &context, &view, fragments, count, numJobs](uint32_t jobIndex)
+                                    {
+                                        const auto firstFragment = (uint32_t)(((uint64_t)count * jobIndex) / numJobs);
+                                        const auto lastFragment = (uint32_t)(((uint64_t)count * (jobIndex + 1)) / numJobs);
+
+                                        command::CommandWriter childCmd(childBuffers[jobIndex]);
+                                        RenderFragmentRange(childCmd, view, *scene->scene, context, fragments + firstFragment, lastFragment - firstFragment);
+                                    });
                             });
                     }
                 }
@@ -9,6 +9,8 @@
 #include "build.h"
 #include "renderingSceneCulling.h"
 
+#include "base/memory/include/frameArena.h"
+
 namespace rendering
 {
     namespace scene
@@ -50,6 +52,8 @@ namespace rendering
             auto index = m_objectInfos.emplace(info);
             outIndex = index;
 
+            m_numObjectsOfType[(int)info.proxyType] += 1;
+
             GPUSceneObjectInfo gpuInfo;
             packObjectData(info, gpuInfo);
             TRACE_INFO("Object++: {}, {} total", index, m_objectInfos.occupancy());
@@ -60,6 +64,7 @@ namespace rendering
 
         void SceneObjectRegistry::unregisterObject(ObjectRenderID index)
         {
+            m_numObjectsOfType[(int)objectInfo(index).proxyType] -= 1;
             m_objectInfos.free(index);
 
             TRACE_INFO("Object--: {}, {} total", index, m_objectInfos.occupancy());
@@ -104,17 +109,33 @@ namespace rendering
 
         //--
 
+        // sqrt scale gives more precision close to the camera, covers distances up to 65km
+        static uint16_t QuantizeCullingDistance(float distance)
+        {
+            return (uint16_t)std::clamp<float>(sqrtf(std::max<float>(0.0f, distance)) * 256.0f, 0.0f, 65535.0f);
+        }
+
         void SceneObjectRegistry::cullObjects(const SceneObjectCullingSetup& setup, SceneObjectCullingResult& outResult) const
         {
             PC_SCOPE_LVL1(CullObjects);
 
+            // results are only needed until the fragments are generated, allocate them for the worst case in the frame arena
+            auto& arena = base::mem::FrameArena::GetDefaultArena();
+            for (uint32_t i = 0; i < (uint32_t)ProxyType::MAX; ++i)
+            {
+                auto& list = outResult.visibleObjects[i];
+                list.entries = arena.allocArray<SceneObjectCullingEntry>(m_numObjectsOfType[i]);
+                list.numEntries = 0;
+            }
+
             m_objectInfos.enumerate([&outResult, &setup](const SceneObjectInfo& info, uint32_t index)
                 {
                     // TODO: test bounding box
 
-                    auto& entry = outResult.visibleObjects[(int)info.proxyType].emplaceBack();
+                    auto& list = outResult.visibleObjects[(int)info.proxyType];
+                    auto& entry = list.entries[list.numEntries++];
                     entry.cameraMask = 1;
-                    entry.distance = 0;
+                    entry.distance = QuantizeCullingDistance(info.sceneBounds.center().distance(setup.cameraPosition));
                     entry.proxy = info.proxyPtr;
                     return false;
                 });
@@ -0,0 +1,229 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "renderingSceneFragment.h"
+#include "renderingSceneFragmentList.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/math/include/randomFast.h"
+
+#include <algorithm>
+#include <vector>
+
+DECLARE_TEST_FILE(FragmentList);
+
+using namespace rendering::scene;
+
+namespace
+{
+    // pick two state "objects" whose hashes are ordered, the key only sees the hashes
+    static void PickOrderedStates(const void*& outLow, const void*& outHigh)
+    {
+        static uint64_t objects[64];
+
+        outLow = &objects[0];
+        outHigh = nullptr;
+        for (const auto& obj : objects)
+        {
+            if (FragmentSortKey::HashState(&obj) != FragmentSortKey::HashState(outLow))
+            {
+                outHigh = &obj;
+                break;
+            }
+        }
+
+        ASSERT_NE(nullptr, outHigh);
+        if (FragmentSortKey::HashState(outHigh) < FragmentSortKey::HashState(outLow))
+            std::swap(outLow, outHigh);
+    }
+
+} // anonymous
+
+TEST(FragmentSortKey, OpaqueHandlerTypeTakesPrecedence)
+{
+    const void* low = nullptr;
+    const void* high = nullptr;
+    PickOrderedStates(low, high);
+
+    const auto a = FragmentSortKey::Build(FragmentDrawBucket::Opaque, FragmentHandlerType::None, high, high, 0xFFFF, 0xFFFF);
+    const auto b = FragmentSortKey::Build(FragmentDrawBucket::Opaque, FragmentHandlerType::Mesh, low, low, 0, 0);
+    EXPECT_LT(a, b);
+}
+
+TEST(FragmentSortKey, OpaqueStatePrecedence)
+{
+    const void* low = nullptr;
+    const void* high = nullptr;
+    PickOrderedStates(low, high);
+
+    const auto type = FragmentHandlerType::Mesh;
+
+    // technique is more important than material data
+    EXPECT_LT(FragmentSortKey::Build(FragmentDrawBucket::Opaque, type, low, high, 0xFFFF, 0xFFFF),
+        FragmentSortKey::Build(FragmentDrawBucket::Opaque, type, high, low, 0, 0));
+
+    // material data is more important than geometry
+    EXPECT_LT(FragmentSortKey::Build(FragmentDrawBucket::Opaque, type, low, low, 0xFFFF, 0xFFFF),
+        FragmentSortKey::Build(FragmentDrawBucket::Opaque, type, low, high, 0, 0));
+
+    // geometry is more important than distance
+    EXPECT_LT(FragmentSortKey::Build(FragmentDrawBucket::Opaque, type, low, low, 1, 0xFFFF),
+        FragmentSortKey::Build(FragmentDrawBucket::Opaque, type, low, low, 2, 0));
+}
+
+TEST(FragmentSortKey, OpaqueIsFrontToBack)
+{
+    const void* low = nullptr;
+    const void* high = nullptr;
+    PickOrderedStates(low, high);
+
+    const auto nearKey = FragmentSortKey::Build(FragmentDrawBucket::Opaque, FragmentHandlerType::Mesh, low, low, 5, 0x0100);
+    const auto farKey = FragmentSortKey::Build(FragmentDrawBucket::Opaque, FragmentHandlerType::Mesh, low, low, 5, 0x8000);
+    EXPECT_LT(nearKey, farKey);
+
+    // only the top 8 bits of the distance are used for opaque fragments so the state runs are not broken up
+    const auto nearKey2 = FragmentSortKey::Build(FragmentDrawBucket::Opaque, FragmentHandlerType::Mesh, low, low, 5, 0x01FF);
+    EXPECT_EQ(nearKey, nearKey2);
+}
+
+TEST(FragmentSortKey, TransparentIsBackToFrontBeforeState)
+{
+    const void* low = nullptr;
+    const void* high = nullptr;
+    PickOrderedStates(low, high);
+
+    // far fragment goes first even if it's state would sort after
+    const auto farKey = FragmentSortKey::Build(FragmentDrawBucket::Transparent, FragmentHandlerType::Mesh, high, high, 0xFF, 0x8000);
+    const auto nearKey = FragmentSortKey::Build(FragmentDrawBucket::Transparent, FragmentHandlerType::None, low, low, 0, 0x0100);
+    EXPECT_LT(farKey, nearKey);
+
+    // all 16 bits of the distance are used
+    const auto a = FragmentSortKey::Build(FragmentDrawBucket::Transparent, FragmentHandlerType::Mesh, low, low, 0, 0x0101);
+    const auto b = FragmentSortKey::Build(FragmentDrawBucket::Transparent, FragmentHandlerType::Mesh, low, low, 0, 0x0100);
+    EXPECT_LT(a, b);
+
+    // same distance, sorted by state
+    EXPECT_LT(FragmentSortKey::Build(FragmentDrawBucket::Transparent, FragmentHandlerType::Mesh, low, high, 0, 0x0100),
+        FragmentSortKey::Build(FragmentDrawBucket::Transparent, FragmentHandlerType::Mesh, high, low, 0, 0x0100));
+}
+
+//--
+
+namespace
+{
+    struct TestFragmentEntry
+    {
+        uint64_t key = 0;
+        const Fragment* fragment = nullptr;
+    };
+
+    static void CheckSortMatchesStableSort(const base::Array<uint64_t>& keys)
+    {
+        base::Array<Fragment> fragments;
+        fragments.resize(keys.size());
+
+        base::mem::LinearAllocator memory(POOL_TEMP);
+        FragmentDrawList list(memory);
+
+        std::vector<TestFragmentEntry> expected;
+        for (uint32_t i = 0; i < keys.size(); ++i)
+        {
+            list.collectFragment(&fragments[i], FragmentDrawBucket::Opaque, keys[i]);
+            expected.push_back(TestFragmentEntry{ keys[i], &fragments[i] });
+        }
+
+        std::stable_sort(expected.begin(), expected.end(), [](const TestFragmentEntry& a, const TestFragmentEntry& b) { return a.key < b.key; });
+
+        list.sortFragments();
+
+        uint32_t numReported = 0;
+        list.iterateFragmentRanges(FragmentDrawBucket::Opaque, [&expected, &numReported](const Fragment* const* frags, uint32_t count)
+            {
+                for (uint32_t i = 0; i < count; ++i, ++numReported)
+                {
+                    ASSERT_LT(numReported, expected.size());
+                    EXPECT_EQ(expected[numReported].fragment, frags[i]) << "Different fragment at " << numReported;
+                }
+            });
+
+        EXPECT_EQ(expected.size(), numReported);
+    }
+
+} // anonymous
+
+TEST(FragmentList, UnsortedListKeepsCollectionOrder)
+{
+    Fragment fragments[3];
+
+    base::mem::LinearAllocator memory(POOL_TEMP);
+    FragmentDrawList list(memory);
+    list.collectFragment(&fragments[0], FragmentDrawBucket::Opaque, 3);
+    list.collectFragment(&fragments[1], FragmentDrawBucket::Opaque, 1);
+    list.collectFragment(&fragments[2], FragmentDrawBucket::Opaque, 2);
+
+    base::Array<const Fragment*> reported;
+    list.iterateFragmentRanges(FragmentDrawBucket::Opaque, [&reported](const Fragment* const* frags, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                reported.pushBack(frags[i]);
+        });
+
+    ASSERT_EQ(3, reported.size());
+    EXPECT_EQ(&fragments[0], reported[0]);
+    EXPECT_EQ(&fragments[1], reported[1]);
+    EXPECT_EQ(&fragments[2], reported[2]);
+}
+
+TEST(FragmentList, SortIsStableForEqualKeys)
+{
+    base::Array<uint64_t> keys;
+    for (uint32_t i = 0; i < 1000; ++i)
+        keys.pushBack(i % 3);
+
+    CheckSortMatchesStableSort(keys);
+}
+
+TEST(FragmentList, SortMatchesStableSortForRandomKeys)
+{
+    base::FastGenerator rand;
+    rand.seed(0x1234);
+
+    // few distinct values in every byte of the key so every radix pass is used and there are many equal keys
+    base::Array<uint64_t> keys;
+    for (uint32_t i = 0; i < 3000; ++i)
+    {
+        uint64_t key = 0;
+        for (uint32_t b = 0; b < 8; ++b)
+            key |= (uint64_t)(rand.nextUint32() % 3) << (b * 8);
+        keys.pushBack(key);
+    }
+
+    CheckSortMatchesStableSort(keys);
+}
+
+TEST(FragmentList, SortMatchesStableSortForRealKeys)
+{
+    base::FastGenerator rand;
+    rand.seed(0x1234);
+
+    uint64_t states[16];
+
+    base::Array<uint64_t> keys;
+    for (uint32_t i = 0; i < 3000; ++i)
+    {
+        const auto bucket = (i & 1) ? FragmentDrawBucket::Opaque : FragmentDrawBucket::Transparent;
+        const auto* technique = &states[rand.nextUint32() % 4];
+        const auto* material = &states[4 + rand.nextUint32() % 8];
+        const auto geometry = rand.nextUint32() % 20;
+        const auto distance = (uint16_t)(rand.nextUint32() & 0xFFFF);
+        keys.pushBack(FragmentSortKey::Build(bucket, FragmentHandlerType::Mesh, technique, material, geometry, distance));
+    }
+
+    CheckSortMatchesStableSort(keys);
+}
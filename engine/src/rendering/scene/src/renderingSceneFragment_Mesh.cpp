@@ -12,6 +12,7 @@
 #include "renderingMaterialCache.h"
 #include "renderingFrameFilters.h"
 #include "renderingFrameView.h"
+#include "renderingSceneStats.h"
 
 #include "rendering/mesh/include/renderingMeshService.h"
 #include "rendering/material/include/renderingMaterialRuntimeTechnique.h"
@@ -90,7 +91,17 @@ namespace rendering
             cmd.opBindParametersInline("MeshDrawData"_id, params);
 
             // draw all fragments
-            // TODO: batching etc
+            // NOTE: fragments come sorted by state so runs with the same mesh chunk and material are merged into one instanced draw
+            // and state that did not change between the runs is not set again
+            const MaterialCompiledTechnique* lastState = nullptr;
+            const MaterialDataProxy* lastRenderData = nullptr;
+            MeshChunkRenderID lastMeshChunkId = 0;
+            MaterialTechniqueRenderStates lastRenderStates;
+            bool hasRenderStates = false;
+
+            SceneViewStats stats;
+            stats.m_numMeshFragments = numFragments;
+
             FragmentIterator<Fragment_Mesh> it(fragments, numFragments);
             while (it)
             {
@@ -104,8 +115,8 @@ namespace rendering
                         break;
 
                 const auto drawCount = it.pos() - drawFirstIndex;
-                const auto renderChunkIndexCount = m_meshCache->chunkInfo(renderMeshChunkId).indexCount;
-                const auto renderChunkVertexCount = m_meshCache->chunkInfo(renderMeshChunkId).vertexCount;
+                const auto& chunkInfo = m_meshCache->chunkInfo(renderMeshChunkId);
+                const auto renderChunkIndexCount = chunkInfo.indexCount;
 
                 //cmd.opSetFillState(PolygonMode::Line);
 
@@ -114,28 +125,58 @@ namespace rendering
                 {
                     if (context.allowsCustomRenderStates)
                     {
-                        cmd.opSetCullState(state.renderStates.twoSided ? CullMode::Disabled : CullMode::Back);
-                        cmd.opSetDepthState(state.renderStates.depthTest, state.renderStates.depthWrite);
+                        const auto& rs = state.renderStates;
+                        const auto cullChanged = !hasRenderStates || rs.twoSided != lastRenderStates.twoSided;
+                        const auto depthChanged = !hasRenderStates || rs.depthTest != lastRenderStates.depthTest || rs.depthWrite != lastRenderStates.depthWrite;
+                        const auto multisampleChanged = !hasRenderStates || rs.alphaToCoverage != lastRenderStates.alphaToCoverage;
+
+                        if (cullChanged)
+                            cmd.opSetCullState(rs.twoSided ? CullMode::Disabled : CullMode::Back);
+
+                        if (depthChanged)
+                            cmd.opSetDepthState(rs.depthTest, rs.depthWrite);
 
-                        if (context.msaaCount > 1)
+                        if (multisampleChanged && context.msaaCount > 1)
                         {
                             MultisampleState ms;
                             ms.sampleCount = context.msaaCount;
-                            ms.alphaToCoverageEnable = state.renderStates.alphaToCoverage;
+                            ms.alphaToCoverageEnable = rs.alphaToCoverage;
                             ms.alphaToOneEnable = true;
                             ms.alphaToCoverageDitherEnable = true;
                             cmd.opSetMultisampleState(ms);
                         }
+
+                        lastRenderStates = rs;
+                        hasRenderStates = true;
                     }
 
                     if (renderData->layout() == state.dataLayout)
                     {
-                        cmd.opBindParameters(state.dataLayout->descriptorName(), renderData->upload(cmd));
+                        if (&state != lastState)
+                        {
+                            stats.m_numPipelineSwitches += 1;
+                            lastState = &state;
+                            lastRenderData = nullptr; // descriptor may need a rebind for different technique
+                        }
+
+                        if (renderData != lastRenderData)
+                        {
+                            cmd.opBindParameters(state.dataLayout->descriptorName(), renderData->upload(cmd));
+                            stats.m_numMaterialSwitches += 1;
+                            lastRenderData = renderData;
+                        }
+
+                        if (renderMeshChunkId != lastMeshChunkId)
+                        {
+                            stats.m_numGeometrySwitches += 1;
+                            lastMeshChunkId = renderMeshChunkId;
+                        }
+
                         cmd.opDrawInstanced(state.shader, 0, renderChunkIndexCount, drawFirstIndex, drawCount);
+                        stats.m_numMeshDrawCommands += 1;
+                        stats.m_numMeshDrawTriangles += (renderChunkIndexCount / 3) * drawCount;
                     }
                 }
-
-                //++it;
             }
 
             // restore states
@@ -145,6 +186,8 @@ namespace rendering
                 cmd.opSetDepthState(true, true);
                 cmd.opSetMultisampleState(MultisampleState());
             }
+
+            view.mergeStats(stats);
         }
 
         //--
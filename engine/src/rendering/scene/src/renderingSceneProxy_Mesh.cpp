@@ -187,7 +187,8 @@ namespace rendering
                     frag->meshChunkdId = chunk.meshChunkId;
                     frag->materialData = chunk.materialData;
 
-                    outFragmentList.collectFragment(frag, FragmentDrawBucket::OpaqueNotMoving);
+                    const auto sortKey = FragmentSortKey::Build(FragmentDrawBucket::OpaqueNotMoving, Fragment_Mesh::FRAGMENT_TYPE, frag->materialTemplate, frag->materialData, frag->meshChunkdId, it.distance());
+                    outFragmentList.collectFragment(frag, FragmentDrawBucket::OpaqueNotMoving, sortKey);
                 }
             }
         }
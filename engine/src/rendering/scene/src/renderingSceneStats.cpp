@@ -0,0 +1,53 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: scene #]
+***/
+
+#include "build.h"
+#include "renderingSceneStats.h"
+
+namespace rendering
+{
+    namespace scene
+    {
+        ///--
+
+        void SceneVisStats::mergeOnto(SceneVisStats& outMerged) const
+        {
+            outMerged.m_numTestedProxies += m_numTestedProxies;
+            outMerged.m_numCollectedProxies += m_numCollectedProxies;
+        }
+
+        void SceneViewStats::mergeOnto(SceneViewStats& outMerged) const
+        {
+            m_visStats.mergeOnto(outMerged.m_visStats);
+
+            outMerged.m_numPointLights += m_numPointLights;
+            outMerged.m_numSpotLights += m_numSpotLights;
+            outMerged.m_numAreaLights += m_numAreaLights;
+
+            outMerged.m_numMeshFragments += m_numMeshFragments;
+            outMerged.m_numMeshDrawCommands += m_numMeshDrawCommands;
+            outMerged.m_numMeshDrawTriangles += m_numMeshDrawTriangles;
+
+            outMerged.m_numTerrainFragments += m_numTerrainFragments;
+            outMerged.m_numTerrainDrawCommands += m_numTerrainDrawCommands;
+            outMerged.m_numTerrainDrawTriangles += m_numTerrainDrawTriangles;
+
+            outMerged.m_numMaterialSwitches += m_numMaterialSwitches;
+            outMerged.m_numPipelineSwitches += m_numPipelineSwitches;
+            outMerged.m_numGeometrySwitches += m_numGeometrySwitches;
+            outMerged.m_numVertexFactorySwitches += m_numVertexFactorySwitches;
+
+            outMerged.m_viewCollectTime += m_viewCollectTime;
+            outMerged.m_viewRenderTime += m_viewRenderTime;
+            outMerged.m_viewExecuteTime += m_viewExecuteTime;
+        }
+
+        ///--
+
+    } // scene
+} // rendering
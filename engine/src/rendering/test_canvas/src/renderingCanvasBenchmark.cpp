@@ -0,0 +1,175 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: command #]
+***/
+
+#include "build.h"
+#include "renderingCanvasBenchmark.h"
+
+#include "base/canvas/include/canvas.h"
+#include "base/canvas/include/canvasGeometryBuilder.h"
+#include "base/font/include/fontInputText.h"
+#include "base/font/include/fontGlyphBuffer.h"
+#include "base/system/include/timedScope.h"
+
+#include "rendering/driver/include/renderingDeviceService.h"
+#include "rendering/driver/include/renderingCommandWriter.h"
+#include "rendering/canvas/include/renderingCanvasRenderingService.h"
+
+namespace rendering
+{
+    namespace test
+    {
+        //--
+
+        static const uint32_t NUM_SHAPE_VARIANTS = 64;
+        static const uint32_t NUM_LABEL_VARIANTS = 16;
+        static const uint32_t ITEMS_PER_ROW = 100;
+
+        CanvasStressBenchmark::CanvasStressBenchmark(uint32_t numShapes, uint32_t numLabels)
+            : m_numShapes(numShapes)
+            , m_numLabels(numLabels)
+        {
+            // shapes, mix of convex and concave ones so we get all kinds of batches
+            for (uint32_t i = 0; i < NUM_SHAPE_VARIANTS; ++i)
+            {
+                base::canvas::GeometryBuilder b;
+                b.beginPath();
+
+                switch (i % 4)
+                {
+                    case 0: b.rect(0, 0, 8, 8); break;
+                    case 1: b.roundedRect(0, 0, 8, 8, 2); break;
+                    case 2: b.circle(4, 4, 4); break;
+                    case 3: b.moveTo(0, 0); b.lineTo(8, 0); b.lineTo(4, 4); b.lineTo(8, 8); b.lineTo(0, 8); break;
+                }
+
+                b.fillColor(base::Color((uint8_t)(i * 4), (uint8_t)(255 - i * 4), (uint8_t)(i * 37)));
+                b.fill();
+
+                auto geometry = base::CreateSharedPtr<base::canvas::Geometry>();
+                b.extract(*geometry);
+                m_shapes.pushBack(geometry);
+            }
+
+            // labels, glyphs are generated up front so the recording only places them
+            if (auto font = base::LoadResource<base::font::Font>(base::res::ResourcePath("engine/tests/fonts/aileron_regular.otf")))
+                m_font = font.acquire();
+
+            if (m_font)
+            {
+                for (uint32_t i = 0; i < NUM_LABEL_VARIANTS; ++i)
+                {
+                    base::font::FontStyleParams params;
+                    params.size = 10 + (i % 4);
+
+                    base::font::GlyphBuffer glyphs;
+                    base::font::FontAssemblyParams assemblyParams;
+                    m_font->renderText(params, assemblyParams, base::font::FontInputText(base::TempString("Label {}", i * 1234)), glyphs);
+
+                    base::canvas::GeometryBuilder b;
+                    b.fillColor(base::Color::WHITE);
+                    b.print(glyphs);
+
+                    auto geometry = base::CreateSharedPtr<base::canvas::Geometry>();
+                    b.extract(*geometry);
+                    m_labels.pushBack(geometry);
+                }
+            }
+            else
+            {
+                TRACE_WARNING("Canvas benchmark: no font, running with shapes only");
+                m_numLabels = 0;
+            }
+        }
+
+        void CanvasStressBenchmark::record(base::canvas::Canvas& canvas, uint32_t firstItem, uint32_t numItems) const
+        {
+            const auto lastItem = std::min<uint32_t>(firstItem + numItems, this->numItems());
+            for (uint32_t i = firstItem; i < lastItem; ++i)
+            {
+                const auto x = (float)((i % ITEMS_PER_ROW) * 10);
+                const auto y = (float)((i / ITEMS_PER_ROW) % 100) * 10;
+                canvas.placement(x, y);
+
+                if (i < m_numShapes)
+                    canvas.place(*m_shapes[i % m_shapes.size()]);
+                else
+                    canvas.place(*m_labels[i % m_labels.size()]);
+            }
+        }
+
+        void CanvasStressBenchmark::recordParallel(base::canvas::Canvas& canvas, uint32_t numJobs) const
+        {
+            const auto itemsPerJob = (numItems() + numJobs - 1) / numJobs;
+            base::GetService<CanvasService>()->recordParallel(canvas, numJobs, [this, itemsPerJob](base::canvas::Canvas& segment, uint32_t jobIndex)
+                {
+                    record(segment, jobIndex * itemsPerJob, itemsPerJob);
+                });
+        }
+
+        void CanvasStressBenchmark::submit(const base::canvas::Canvas& canvas) const
+        {
+            command::CommandWriter cmd("CanvasBenchmark");
+
+            canvas::CanvasRenderingParams renderingParams;
+            renderingParams.frameBufferWidth = canvas.width();
+            renderingParams.frameBufferHeight = canvas.height();
+            base::GetService<CanvasService>()->render(cmd, canvas, renderingParams);
+
+            base::GetService<DeviceService>()->device()->submitWork(cmd.release());
+        }
+
+        void CanvasStressBenchmark::run(uint32_t width, uint32_t height, uint32_t numFrames, uint32_t numJobs)
+        {
+            TRACE_INFO("Canvas benchmark: {} shapes, {} labels, {} jobs", m_numShapes, m_numLabels, numJobs);
+
+            // statistics of the generated content
+            {
+                base::canvas::Canvas canvas(width, height);
+                record(canvas, 0, numItems());
+                TRACE_INFO("Canvas benchmark: {} vertices, {} indices, {} params, {} batches", canvas.vertices().size(), canvas.indices().size(), canvas.params().size(), canvas.baches().size());
+            }
+
+            // single threaded recording
+            {
+                base::ScopeTimer timer;
+                for (uint32_t i = 0; i < numFrames; ++i)
+                {
+                    base::canvas::Canvas canvas(width, height);
+                    record(canvas, 0, numItems());
+                }
+                TRACE_INFO("Canvas benchmark: serial recording {}ms per frame", timer.milisecondsElapsed() / numFrames);
+            }
+
+            // parallel recording into segments + merge
+            {
+                base::ScopeTimer timer;
+                for (uint32_t i = 0; i < numFrames; ++i)
+                {
+                    base::canvas::Canvas canvas(width, height);
+                    recordParallel(canvas, numJobs);
+                }
+                TRACE_INFO("Canvas benchmark: parallel recording {}ms per frame", timer.milisecondsElapsed() / numFrames);
+            }
+
+            // full frame - recording and submission to renderer
+            {
+                base::ScopeTimer timer;
+                for (uint32_t i = 0; i < numFrames; ++i)
+                {
+                    base::canvas::Canvas canvas(width, height);
+                    recordParallel(canvas, numJobs);
+                    submit(canvas);
+                }
+                TRACE_INFO("Canvas benchmark: parallel recording and rendering {}ms per frame", timer.milisecondsElapsed() / numFrames);
+            }
+        }
+
+        //--
+
+    } // test
+} // rendering
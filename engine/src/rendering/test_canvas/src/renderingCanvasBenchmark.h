@@ -0,0 +1,53 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: command #]
+***/
+
+#pragma once
+
+#include "base/canvas/include/canvasGeometry.h"
+#include "base/font/include/font.h"
+
+namespace rendering
+{
+    namespace test
+    {
+
+        //--
+
+        /// synthetic canvas with a lot of shapes and glyphs, used to measure the cost of recording and rendering big canvases
+        /// NOTE: does not need any rendering output so it can be run with the Null driver
+        class CanvasStressBenchmark : public base::NoCopy
+        {
+        public:
+            CanvasStressBenchmark(uint32_t numShapes, uint32_t numLabels);
+
+            /// run the benchmark, prints the results to log
+            void run(uint32_t width, uint32_t height, uint32_t numFrames, uint32_t numJobs);
+
+            /// record part of the items into the canvas
+            void record(base::canvas::Canvas& canvas, uint32_t firstItem, uint32_t numItems) const;
+
+            /// total number of items
+            INLINE uint32_t numItems() const { return m_numShapes + m_numLabels; }
+
+        private:
+            uint32_t m_numShapes = 0;
+            uint32_t m_numLabels = 0;
+
+            base::Array<base::canvas::GeometryPtr> m_shapes;
+            base::Array<base::canvas::GeometryPtr> m_labels;
+
+            base::FontPtr m_font;
+
+            void recordParallel(base::canvas::Canvas& canvas, uint32_t numJobs) const;
+            void submit(const base::canvas::Canvas& canvas) const;
+        };
+
+        //--
+
+    } // test
+} // rendering
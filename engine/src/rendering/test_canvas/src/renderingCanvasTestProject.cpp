@@ -9,6 +9,7 @@
 #include "build.h"
 #include "renderingCanvasTest.h"
 #include "renderingCanvasTestProject.h"
+#include "renderingCanvasBenchmark.h"
 
 #include "base/app/include/application.h"
 #include "base/input/include/inputContext.h"
@@ -50,6 +51,15 @@ namespace rendering
 
         bool CanvasTestProject::initialize(const base::app::CommandLine& cmdLine)
         {
+            // synthetic stress benchmark, does not need any output so it can run with "-device=Null", runs once and exits
+            if (cmdLine.hasParam("benchmark"))
+            {
+                CanvasStressBenchmark benchmark(100000, 20000);
+                benchmark.run(1024, 1024, 20, std::max<uint32_t>(1, cmdLine.singleValueInt("jobs", 8)));
+                base::platform::GetLaunchPlatform().requestExit("Benchmark finished");
+                return true;
+            }
+
             // list all test classes
             base::InplaceArray<base::ClassType, 100> testClasses;
             RTTI::GetInstance().enumClasses(ICanvasTest::GetStaticClass(), testClasses);
@@ -159,6 +169,10 @@ namespace rendering
 
         void CanvasTestProject::update()
         {
+            // nothing to do when running benchmark
+            if (!m_renderingWindow)
+                return;
+
             // exit when window closed
             if (m_renderingWindow->windowHasCloseRequest())
             {
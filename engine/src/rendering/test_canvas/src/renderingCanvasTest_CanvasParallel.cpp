@@ -0,0 +1,52 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: command\tests #]
+***/
+
+#include "build.h"
+#include "renderingCanvasTest.h"
+#include "renderingCanvasBenchmark.h"
+
+#include "rendering/canvas/include/renderingCanvasRenderingService.h"
+
+namespace rendering
+{
+    namespace test
+    {
+        /// test of canvas recorded in parallel segments, should look the same as if recorded on one thread
+        class SceneTest_CanvasParallel : public ICanvasTest
+        {
+            RTTI_DECLARE_VIRTUAL_CLASS(SceneTest_CanvasParallel, ICanvasTest);
+
+        public:
+            virtual void initialize() override
+            {
+                m_content.create(8000, 2000);
+            }
+
+            virtual void render(base::canvas::Canvas& c) override
+            {
+                const auto numJobs = 8;
+                const auto itemsPerJob = (m_content->numItems() + numJobs - 1) / numJobs;
+
+                base::GetService<CanvasService>()->recordParallel(c, numJobs, [this, itemsPerJob](base::canvas::Canvas& segment, uint32_t jobIndex)
+                    {
+                        m_content->record(segment, jobIndex * itemsPerJob, itemsPerJob);
+                    });
+            }
+
+        private:
+            base::UniquePtr<CanvasStressBenchmark> m_content;
+        };
+
+        RTTI_BEGIN_TYPE_CLASS(SceneTest_CanvasParallel);
+        RTTI_METADATA(CanvasTestOrderMetadata).order(210);
+        RTTI_END_TYPE();
+
+        //---
+
+    } // test
+} // rendering
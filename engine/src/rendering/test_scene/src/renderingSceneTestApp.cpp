@@ -14,6 +14,8 @@
 #include "base/input/include/inputContext.h"
 #include "base/input/include/inputStructures.h"
 #include "base/canvas/include/canvas.h"
+#include "base/memory/include/poolStats.h"
+#include "base/memory/include/frameArena.h"
 
 #include "rendering/driver/include/renderingDriver.h"
 #include "rendering/driver/include/renderingOutput.h"
@@ -391,10 +393,28 @@ namespace rendering
             cmd.opEndPass();
         }
 
+        static uint32_t CountLastFrameHeapAllocations()
+        {
+            base::mem::PoolStatsData stats[256];
+            uint32_t numPools = 0;
+            base::mem::PoolStats::GetInstance().allStats(ARRAY_COUNT(stats), stats, numPools);
+
+            uint32_t numAllocs = 0;
+            for (uint32_t i = 0; i < numPools; ++i)
+                numAllocs += stats[i].m_lastFrameAllocs;
+            return numAllocs;
+        }
+
         void SceneTestProject::renderCanvas(base::canvas::Canvas& canvas)
         {
             // Local stuff
             {
+                const auto& arenaStats = base::mem::FrameArena::GetDefaultArena().lastFrameStats();
+                canvas.placement(canvas.width() - 20, canvas.height() - 80);
+                Print(canvas,
+                    base::TempString("Heap allocs/frame: {}, frame arena: {} allocs, {} pages", CountLastFrameHeapAllocations(), arenaStats.numAllocations, arenaStats.numPages),
+                    base::Color::WHITE, 16, base::font::FontAlignmentHorizontal::Right);
+
                 canvas.placement(canvas.width() - 20, canvas.height() - 60);
                 Print(canvas,
                     base::TempString("Camera Position: [X={}, Y={}, Z={}]", Prec(m_camera.position().x, 2), Prec(m_camera.position().y, 2), Prec(m_camera.position().z, 2)),
@@ -9,6 +9,7 @@
 #include "build.h"
 #include "uiTestApp.h"
 #include "uiTestWindow.h"
+#include "uiTestBenchmark.h"
 
 #include "base/app/include/application.h"
 #include "base/input/include/inputContext.h"
@@ -54,6 +55,16 @@ namespace rendering
             m_renderer.create(m_dataStash.get(), m_nativeRenderer.get());
             m_lastUpdateTime.resetToNow();
 
+            // synthetic layout benchmark, runs once and exits
+            if (commandline.hasParam("benchmark"))
+            {
+                auto window = base::CreateSharedPtr<LayoutBenchmarkWindow>(50000);
+                m_renderer->attachWindow(window.get());
+                window->run(*m_dataStash, 100);
+                base::platform::GetLaunchPlatform().requestExit("Benchmark finished");
+                return true;
+            }
+
             auto window = base::CreateSharedPtr<TestWindow>();
             m_renderer->attachWindow(window.get());
 
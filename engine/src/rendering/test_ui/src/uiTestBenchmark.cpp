@@ -0,0 +1,108 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: test #]
+***/
+
+#include "build.h"
+#include "uiTestBenchmark.h"
+#include "base/ui/include/uiTextLabel.h"
+#include "base/ui/include/uiStyleParameters.h"
+#include "base/ui/include/uiElementStyle.h"
+#include "base/system/include/timedScope.h"
+
+namespace rendering
+{
+    namespace test
+    {
+        //--
+
+        static const uint32_t ELEMENTS_PER_ROW = 50;
+
+        LayoutBenchmarkWindow::LayoutBenchmarkWindow(uint32_t numElements)
+        {
+            layoutMode(ui::LayoutMode::Vertical);
+
+            createChild<ui::WindowTitleBar>();
+
+            // rows of labels, some of them styled differently so we get a realistic mix of selectors
+            ui::IElement* row = nullptr;
+            for (uint32_t i = 0; i < numElements; ++i)
+            {
+                if ((i % ELEMENTS_PER_ROW) == 0)
+                {
+                    row = createChild<ui::IElement>().get();
+                    row->layoutMode(ui::LayoutMode::Horizontal);
+                    m_numElements += 1;
+                }
+
+                auto label = row->createChild<ui::TextLabel>(base::TempString("{}", i));
+                if ((i % 7) == 0)
+                    label->addStyleClass("bold"_id);
+                if ((i % 13) == 0)
+                    label->customMargins(2, 2, 2, 2);
+
+                m_numElements += 1;
+            }
+        }
+
+        void LayoutBenchmarkWindow::update(ui::DataStash& stash, float pixelScale, bool force)
+        {
+            {
+                ui::StyleStack stack(stash);
+                prepareStyle(stack, pixelScale, force);
+            }
+
+            {
+                bool layoutRecomputed = false;
+                prepareLayout(layoutRecomputed, force, false);
+            }
+        }
+
+        void LayoutBenchmarkWindow::run(ui::DataStash& stash, uint32_t numFrames)
+        {
+            TRACE_INFO("Layout benchmark: {} elements, {} style parameter slots", m_numElements, ui::style::NumParamSlots());
+
+            // initial update, everything is computed from scratch
+            {
+                base::ScopeTimer timer;
+                update(stash, 1.0f, true);
+                TRACE_INFO("Layout benchmark: initial style and layout took {}", timer);
+            }
+
+            // forced update, styles are re-evaluated for all elements but the selectors don't change
+            {
+                base::ScopeTimer timer;
+                for (uint32_t i = 0; i < numFrames; ++i)
+                    update(stash, 1.0f, true);
+                TRACE_INFO("Layout benchmark: forced update {}ms per frame", timer.milisecondsElapsed() / numFrames);
+            }
+
+            // idle update, nothing changes so nothing should be recomputed
+            {
+                base::ScopeTimer timer;
+                for (uint32_t i = 0; i < numFrames; ++i)
+                    update(stash, 1.0f, false);
+                TRACE_INFO("Layout benchmark: idle update {}ms per frame", timer.milisecondsElapsed() / numFrames);
+            }
+
+            // pixel scale change, all styles and layouts must be recomputed
+            {
+                base::ScopeTimer timer;
+                for (uint32_t i = 0; i < numFrames; ++i)
+                    update(stash, (i & 1) ? 1.0f : 1.25f, false);
+                TRACE_INFO("Layout benchmark: rescale update {}ms per frame", timer.milisecondsElapsed() / numFrames);
+            }
+        }
+
+        void LayoutBenchmarkWindow::handleExternalCloseRequest()
+        {
+            requestClose();
+        }
+
+        //--
+
+    } // test
+} // rendering
@@ -0,0 +1,40 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: test #]
+***/
+
+#pragma once
+
+#include "base/ui/include/uiWindow.h"
+
+namespace rendering
+{
+    namespace test
+    {
+
+        //--
+
+        /// synthetic window with a lot of elements, used to measure cost of style and layout updates
+        class LayoutBenchmarkWindow : public ui::Window
+        {
+        public:
+            LayoutBenchmarkWindow(uint32_t numElements);
+
+            /// run the benchmark, the window must be attached to the renderer
+            void run(ui::DataStash& stash, uint32_t numFrames);
+
+            virtual void handleExternalCloseRequest() override;
+
+        private:
+            uint32_t m_numElements = 0;
+
+            void update(ui::DataStash& stash, float pixelScale, bool force);
+        };
+
+        //--
+
+    } // test
+} // rendering
@@ -35,8 +35,9 @@ namespace ui
 
         //--
 
-        // request redraw of the panel
-        void requestRedraw();
+        // request rendering of the panel's scene (and redraw of the window it's in)
+        // NOTE: not named requestRedraw so it does not hide the IElement::requestRedraw that only marks the window dirty
+        void requestRender();
 
         // toggle automatic rendering of the panel
         void autoRender(bool flag);
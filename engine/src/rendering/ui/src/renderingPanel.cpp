@@ -76,6 +76,9 @@ namespace ui
         m_renderRate = cvDefaultRenderingPanelRefreshRate.get();
         m_autoRender = cvDefaultRenderingPanelAutoRender.get();
         m_renderRequest = false;
+
+        // panel content comes from a live rendering, the window can't reuse previous frame
+        continuousRedraw(m_autoRender);
     }
 
     RenderingPanel::~RenderingPanel()
@@ -89,14 +92,16 @@ namespace ui
         m_depthSurface.destroy();
     }
 
-    void RenderingPanel::requestRedraw()
+    void RenderingPanel::requestRender()
     {
         m_renderRequest = true;
+        requestRedraw();
     }
 
     void RenderingPanel::autoRender(bool flag)
     {
         m_autoRender = flag;
+        continuousRedraw(flag);
     }
 
     void RenderingPanel::renderRate(float rate)
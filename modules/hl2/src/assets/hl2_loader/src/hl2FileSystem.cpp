@@ -40,6 +40,12 @@ namespace hl2
             // create file path
             auto& entry = m_openedPackages.emplaceBack();
             entry.m_fullPath = m_rootPath.addFile(srcPackageName);
+
+            // map the whole package, nothing is read until the files are actually accessed
+            entry.m_mappedData = IO::GetInstance().openMemoryMappedForReading(entry.m_fullPath);
+            if (entry.m_mappedData)
+                continue;
+
             entry.m_fileHandle = IO::GetInstance().openForReading(entry.m_fullPath);
             if (!entry.m_fileHandle)
             {
@@ -150,6 +156,20 @@ namespace hl2
         // get entry data
         const auto& entry = m_indexData->files() + fileIndex;
         auto& openedPackage = m_openedPackages[entry->m_packageIndex];
+
+        // files in packages are not compressed so we can read them directly from the mapped memory, no copy is made
+        // NOTE: the reader keeps the whole mapping alive
+        if (openedPackage.m_mappedData)
+        {
+            if ((uint64_t)entry->m_dataOffset + entry->m_dataSize > openedPackage.m_mappedData.size())
+            {
+                TRACE_ERROR("File '{}' can't be loaded because it's outside the archive", rawFilePath);
+                return nullptr;
+            }
+
+            return base::CreateSharedPtr<base::io::MemoryReaderFileHandle>(openedPackage.m_mappedData, entry->m_dataOffset, entry->m_dataSize, base::StringBuf(rawFilePath));
+        }
+
         if (!openedPackage.m_fileHandle)
         {
             TRACE_ERROR("File '{}' can't be loaded because archive is missing", rawFilePath);
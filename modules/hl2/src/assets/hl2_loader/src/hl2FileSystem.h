@@ -44,7 +44,8 @@ namespace hl2
         struct OpenPackage
         {
             base::io::AbsolutePath m_fullPath;
-            base::io::FileHandlePtr m_fileHandle;
+            base::Buffer m_mappedData; // whole package mapped into memory, files are served directly from it
+            base::io::FileHandlePtr m_fileHandle; // used only if the package can't be mapped
             mutable base::Mutex m_lock;
         };
 
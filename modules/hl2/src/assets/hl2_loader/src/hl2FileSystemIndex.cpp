@@ -133,17 +133,108 @@ namespace hl2
 
     ///--
 
+    // header of the baked index, all tables follow in the same blob
+    struct IndexHeader
+    {
+        static const uint32_t MAGIC = 0x45464787;
+
+        uint32_t m_magic = 0;
+        uint32_t m_totalSize = 0;
+        uint32_t m_stringTableOffset = 0;
+        uint32_t m_stringTableSize = 0;
+        uint32_t m_packagesOffset = 0;
+        uint32_t m_numPackages = 0;
+        uint32_t m_filesOffset = 0;
+        uint32_t m_numFiles = 0;
+        uint32_t m_directoriesOffset = 0;
+        uint32_t m_numDirectories = 0;
+        uint32_t m_fileBucketsOffset = 0;
+        uint32_t m_numFileBuckets = 0;
+        uint32_t m_dirBucketsOffset = 0;
+        uint32_t m_numDirBuckets = 0;
+    };
+
+    static INLINE uint64_t AlignOffset(uint64_t offset, uint32_t alignment)
+    {
+        return (offset + alignment - 1) & ~(uint64_t)(alignment - 1);
+    }
+
+    static uint32_t CalcNumBuckets(uint32_t numEntries)
+    {
+        // keep the tables at most half full so the probing sequences stay short
+        uint32_t numBuckets = 16;
+        while (numBuckets < numEntries * 2ULL)
+            numBuckets *= 2;
+        return numBuckets;
+    }
+
+    template< typename T >
+    static void BuildBuckets(const base::Array<T>& entries, uint32_t* buckets, uint32_t numBuckets)
+    {
+        const auto mask = numBuckets - 1;
+
+        for (uint32_t i = 0; i < numBuckets; ++i)
+            buckets[i] = INDEX_MAX;
+
+        for (uint32_t i = 0; i < entries.size(); ++i)
+        {
+            const auto hash = entries[i].m_pathHash;
+
+            auto bucket = (uint32_t)hash & mask;
+            while (buckets[bucket] != INDEX_MAX && entries[buckets[bucket]].m_pathHash != hash)
+                bucket = (bucket + 1) & mask;
+
+            // NOTE: same path added again (ie. from different package) overrides the previous entry
+            buckets[bucket] = i;
+        }
+    }
+
+    static bool ValidateBuckets(uint32_t numEntries, const uint32_t* buckets, uint32_t numBuckets)
+    {
+        // every bucket must point to an entry and there must be at least one empty bucket or the lookups of missing paths would never end
+        bool hasEmptyBucket = false;
+        for (uint32_t i = 0; i < numBuckets; ++i)
+        {
+            if (buckets[i] == INDEX_MAX)
+                hasEmptyBucket = true;
+            else if (buckets[i] >= numEntries)
+                return false;
+        }
+
+        return hasEmptyBucket;
+    }
+
+    template< typename T >
+    static int FindInBuckets(const T* entries, const uint32_t* buckets, uint32_t mask, uint64_t hash)
+    {
+        auto bucket = (uint32_t)hash & mask;
+        while (buckets[bucket] != INDEX_MAX)
+        {
+            const auto index = buckets[bucket];
+            if (entries[index].m_pathHash == hash)
+                return (int)index;
+
+            bucket = (bucket + 1) & mask;
+        }
+
+        return -1;
+    }
+
+    ///--
+
     class FileSystemDataBuilder : public base::NoCopy
     {
     public:
-        FileSystemDataBuilder(FileSystemIndex& data)
-            : m_data(data)
+        FileSystemDataBuilder()
         {
             // empty string
-            data.m_stringTable.reset();
-            data.m_stringTable.pushBack(0);
+            m_stringTable.reserve(1 << 20);
+            m_stringTable.pushBack(0);
 
             // reserve
+            m_packages.reserve(64);
+            m_files.reserve(100000);
+            m_directories.reserve(10000);
             m_lastDirEntries.reserve(10000);
             m_lastFileEntries.reserve(10000);
         }
@@ -156,11 +247,11 @@ namespace hl2
 
             // add to table
             auto length = strlen(str) + 1;
-            auto ptr  = m_data.m_stringTable.allocateUninitialized(length);
+            auto ptr  = m_stringTable.allocateUninitialized(length);
             memcpy(ptr, str, length);
 
             // map for future use
-            auto offset = range_cast<uint32_t>(ptr - m_data.m_stringTable.typedData());
+            auto offset = range_cast<uint32_t>(ptr - m_stringTable.typedData());
             return offset;
         }
 
@@ -184,8 +275,8 @@ namespace hl2
             auto virtualFilePath = base::TempString("{}/{}", virtualDirectoryPath, fileName);
 
             // create package entry
-            auto packageIndex = m_data.m_packages.size();
-            auto& entry = m_data.m_packages.emplaceBack();
+            auto packageIndex = m_packages.size();
+            auto& entry = m_packages.emplaceBack();
             entry.m_name = mapString(virtualFilePath.c_str());
             entry.m_numFiles = 0;
             entry.m_timeStamp = timeStamp.value();
@@ -222,24 +313,24 @@ namespace hl2
                 IO::GetInstance().fileTimeStamp(dirPath, timeStamp);
             }
 
-            auto& entry = m_data.m_packages.emplaceBack();
+            auto& entry = m_packages.emplaceBack();
             entry.m_name = mapString(TempString("{}", packageName));
             entry.m_numFiles = 0;
             entry.m_timeStamp = timeStamp.value();
 
-            return (uint32_t)m_data.m_packages.lastValidIndex();
+            return (uint32_t)m_packages.lastValidIndex();
         }
 
         void buildDirectoryPathString(int dirIndex, base::StringBuilder& str)
         {
             if (dirIndex > 0)
             {
-                auto &dirEntry = m_data.m_directories[dirIndex];
+                auto &dirEntry = m_directories[dirIndex];
 
                 if (dirEntry.m_parent != 0)
                     buildDirectoryPathString(dirEntry.m_parent, str);
 
-                auto name = m_data.m_stringTable.typedData() + dirEntry.m_name;
+                auto name = m_stringTable.typedData() + dirEntry.m_name;
                 str.append(name);
                 str.append("/");
             }
@@ -247,17 +338,17 @@ namespace hl2
 
         void buildFilePathString(int fileIndex, base::StringBuilder& str)
         {
-            auto& fileEntry = m_data.m_files[fileIndex];
+            auto& fileEntry = m_files[fileIndex];
             buildDirectoryPathString(fileEntry.m_parent, str);
 
-            auto name  = m_data.m_stringTable.typedData() + fileEntry.m_name;
+            auto name  = m_stringTable.typedData() + fileEntry.m_name;
             str.append(name);
         }
 
         int mapDirectory(int parent, const char* name)
         {
             // create entry
-            auto& entry = m_data.m_directories.emplaceBack();
+            auto& entry = m_directories.emplaceBack();
             entry.m_name = mapString(name);
             entry.m_parent = parent;
             entry.m_nextDir = -1;
@@ -266,15 +357,15 @@ namespace hl2
             entry.m_pathHash = 0;
 
             // link
-            auto index = m_data.m_directories.lastValidIndex();
-            auto& parentEntry = m_data.m_directories[parent];
+            auto index = m_directories.lastValidIndex();
+            auto& parentEntry = m_directories[parent];
             if (m_lastDirEntries[parent] == -1)
             {
                 parentEntry.m_firstDir = index;
             }
             else
             {
-                auto& lastDirEntry = m_data.m_directories[m_lastDirEntries[parent]];
+                auto& lastDirEntry = m_directories[m_lastDirEntries[parent]];
                 lastDirEntry.m_nextDir = index;
             }
 
@@ -293,7 +384,7 @@ namespace hl2
         int mapFile(int parent, const char* name, uint32_t packageIndex, uint32_t dataOffset, uint32_t dataSize, uint64_t dataCRC)
         {
             // create entry
-            auto& entry = m_data.m_files.emplaceBack();
+            auto& entry = m_files.emplaceBack();
             entry.m_name = mapString(name);
             entry.m_dataSize = dataSize;
             entry.m_dataCRC = dataCRC;
@@ -303,15 +394,15 @@ namespace hl2
             entry.m_parent = parent;
 
             // link
-            auto index = m_data.m_files.lastValidIndex();
-            auto& parentEntry = m_data.m_directories[parent];
+            auto index = m_files.lastValidIndex();
+            auto& parentEntry = m_directories[parent];
             if (m_lastFileEntries[parent] == -1)
             {
                 parentEntry.m_firstFile = index;
             }
             else
             {
-                auto& lastFileEntry = m_data.m_files[m_lastFileEntries[parent]];
+                auto& lastFileEntry = m_files[m_lastFileEntries[parent]];
                 lastFileEntry.m_nextFile = index;
             }
 
@@ -329,12 +420,12 @@ namespace hl2
         int createDirectory(int parent, const char* name)
         {
             // find in existing dirs
-            auto& existingParentDir = m_data.m_directories[parent];
+            auto& existingParentDir = m_directories[parent];
             auto dirIndex = existingParentDir.m_firstDir;
             while (dirIndex != -1)
             {
-                auto& existingChildDir = m_data.m_directories[dirIndex];
-                auto existingChildDirName  = m_data.m_stringTable.typedData() + existingChildDir.m_name;
+                auto& existingChildDir = m_directories[dirIndex];
+                auto existingChildDirName  = m_stringTable.typedData() + existingChildDir.m_name;
                 if (0 == _stricmp(name, existingChildDirName))
                     return dirIndex;
 
@@ -470,7 +561,7 @@ namespace hl2
             archiveMap.resizeWith(100, -1);
 
             // create root directory
-            auto& rootDir = m_data.m_directories.emplaceBack();
+            auto& rootDir = m_directories.emplaceBack();
             rootDir.m_name = 0;
             rootDir.m_parent = -1;
             rootDir.m_firstDir = -1;
@@ -506,7 +597,7 @@ namespace hl2
 
                     // create directory entry
                     auto dirEntryIndex = createPath(path);
-                    const auto& dirEntry = m_data.m_directories[dirEntryIndex];
+                    const auto& dirEntry = m_directories[dirEntryIndex];
 
                     // name part
                     while (pos < end)
@@ -545,7 +636,7 @@ namespace hl2
                         mapFile(dirEntryIndex, base::TempString("{}.{}", name, ext), packageIndex, dataOffset, vpkEntry->uiEntryLength, vpkEntry->uiCRC);
 
                         // count files in the package
-                        auto& packageEntry = m_data.m_packages[packageIndex];
+                        auto& packageEntry = m_packages[packageIndex];
                         packageEntry.m_numFiles += 1;
                         numFiles += 1;
                     }
@@ -654,8 +745,64 @@ namespace hl2
             return true;
         }
 
+        base::Buffer bake() const
+        {
+            // place the tables, everything is aligned so the tables can be used in place when the file is mapped
+            IndexHeader header;
+            header.m_magic = IndexHeader::MAGIC;
+
+            uint64_t offset = sizeof(IndexHeader);
+
+            auto placeTable = [&offset](uint32_t& outOffset, uint64_t dataSize)
+            {
+                offset = AlignOffset(offset, 8);
+                outOffset = (uint32_t)offset;
+                offset += dataSize;
+            };
+
+            header.m_stringTableSize = m_stringTable.size();
+            header.m_numPackages = m_packages.size();
+            header.m_numFiles = m_files.size();
+            header.m_numDirectories = m_directories.size();
+            header.m_numFileBuckets = CalcNumBuckets(m_files.size());
+            header.m_numDirBuckets = CalcNumBuckets(m_directories.size());
+
+            placeTable(header.m_stringTableOffset, m_stringTable.dataSize());
+            placeTable(header.m_packagesOffset, m_packages.dataSize());
+            placeTable(header.m_filesOffset, m_files.dataSize());
+            placeTable(header.m_directoriesOffset, m_directories.dataSize());
+            placeTable(header.m_fileBucketsOffset, header.m_numFileBuckets * (uint64_t)sizeof(uint32_t));
+            placeTable(header.m_dirBucketsOffset, header.m_numDirBuckets * (uint64_t)sizeof(uint32_t));
+
+            if (offset > 0xFFFFFFF0ULL)
+            {
+                TRACE_ERROR("File system index is too big ({})", MemSize(offset));
+                return nullptr;
+            }
+
+            header.m_totalSize = (uint32_t)AlignOffset(offset, 8);
+
+            auto ret = base::Buffer::CreateZeroInitialized(POOL_TEMP, header.m_totalSize, 16);
+            if (!ret)
+                return nullptr;
+
+            auto* base = ret.data();
+            memcpy(base, &header, sizeof(header));
+            memcpy(base + header.m_stringTableOffset, m_stringTable.data(), m_stringTable.dataSize());
+            memcpy(base + header.m_packagesOffset, m_packages.data(), m_packages.dataSize());
+            memcpy(base + header.m_filesOffset, m_files.data(), m_files.dataSize());
+            memcpy(base + header.m_directoriesOffset, m_directories.data(), m_directories.dataSize());
+
+            BuildBuckets(m_files, (uint32_t*)(base + header.m_fileBucketsOffset), header.m_numFileBuckets);
+            BuildBuckets(m_directories, (uint32_t*)(base + header.m_dirBucketsOffset), header.m_numDirBuckets);
+            return ret;
+        }
+
     private:
-        FileSystemIndex& m_data;
+        base::Array<char> m_stringTable;
+        base::Array<FileSystemIndex::PackageInfo> m_packages;
+        base::Array<FileSystemIndex::FileInfo> m_files;
+        base::Array<FileSystemIndex::DirInfo> m_directories;
 
         base::Array<int> m_lastDirEntries;
         base::Array<int> m_lastFileEntries;
@@ -665,82 +812,105 @@ namespace hl2
 
     FileSystemIndex::FileSystemIndex()
     {
-        m_stringTable.reserve(1 << 20);
-        m_packages.reserve(64);
-        m_files.reserve(100000);
-        m_directories.reserve(10000);
     }
 
     FileSystemIndex::~FileSystemIndex()
     {
     }
 
-    struct Header
-    {
-        static const uint32_t MAGIC = 0x45464786;
-        uint32_t m_magic;
-    };
-
-    template< typename T >
-    static bool writeTable(base::io::IFileHandle& file, const base::Array<T>& data)
+    bool FileSystemIndex::bind(const base::Buffer& data)
     {
-        uint32_t dataSize = data.dataSize();
-        if (sizeof(uint32_t) != file.writeSync(&dataSize, sizeof(dataSize)))
+        if (data.size() < sizeof(IndexHeader))
             return false;
-        if (dataSize != file.writeSync(data.data(), dataSize))
+
+        const auto* base = data.data();
+        const auto& header = *(const IndexHeader*)base;
+        if (header.m_magic != IndexHeader::MAGIC || header.m_totalSize != data.size())
             return false;
-        return true;
-    }
 
-    template< typename T >
-    static bool readTable(base::io::IFileHandle& file, base::Array<T>& data)
-    {
-        uint32_t dataSize = 0;
-        if (sizeof(uint32_t) != file.readSync(&dataSize, sizeof(dataSize)))
+        // all tables must be inside the blob
+        auto validTable = [&header](uint32_t offset, uint32_t count, uint32_t elementSize)
+        {
+            return offset >= sizeof(IndexHeader) && (offset + (uint64_t)count * elementSize) <= header.m_totalSize;
+        };
+
+        if (!validTable(header.m_stringTableOffset, header.m_stringTableSize, sizeof(char)) || !header.m_stringTableSize)
             return false;
-        data.resize(dataSize / sizeof(T));
-        if (dataSize != file.readSync(data.data(), dataSize))
+        if (!validTable(header.m_packagesOffset, header.m_numPackages, sizeof(PackageInfo)))
+            return false;
+        if (!validTable(header.m_filesOffset, header.m_numFiles, sizeof(FileInfo)))
+            return false;
+        if (!validTable(header.m_directoriesOffset, header.m_numDirectories, sizeof(DirInfo)))
+            return false;
+        if (!validTable(header.m_fileBucketsOffset, header.m_numFileBuckets, sizeof(uint32_t)) || !header.m_numFileBuckets || (header.m_numFileBuckets & (header.m_numFileBuckets - 1)))
+            return false;
+        if (!validTable(header.m_dirBucketsOffset, header.m_numDirBuckets, sizeof(uint32_t)) || !header.m_numDirBuckets || (header.m_numDirBuckets & (header.m_numDirBuckets - 1)))
             return false;
-        return true;
-    }
 
-    bool FileSystemIndex::load(base::io::IFileHandle& file)
-    {
-        // write header
-        Header header;
-        memset(&header, 0, sizeof(header));
-        if (sizeof(header) != file.readSync(&header, sizeof(header)))
+        // string table must be terminated so the names can't run outside of it
+        if (base[header.m_stringTableOffset + header.m_stringTableSize - 1] != 0)
+            return false;
+
+        const auto* packages = (const PackageInfo*)(base + header.m_packagesOffset);
+        const auto* files = (const FileInfo*)(base + header.m_filesOffset);
+        const auto* directories = (const DirInfo*)(base + header.m_directoriesOffset);
+
+        if (!ValidateBuckets(header.m_numFiles, (const uint32_t*)(base + header.m_fileBucketsOffset), header.m_numFileBuckets))
             return false;
-        if (header.MAGIC != header.m_magic)
+        if (!ValidateBuckets(header.m_numDirectories, (const uint32_t*)(base + header.m_dirBucketsOffset), header.m_numDirBuckets))
             return false;
 
-        // load tables
-        if (!readTable(file, m_stringTable)) return false;
-        if (!readTable(file, m_packages)) return false;
-        if (!readTable(file, m_files)) return false;
-        if (!readTable(file, m_directories)) return false;
-        return true;
-    }
+        for (uint32_t i = 0; i < header.m_numPackages; ++i)
+            if (packages[i].m_name >= header.m_stringTableSize)
+                return false;
 
-    bool FileSystemIndex::save(base::io::IFileHandle& file) const
-    {
-        // write header
-        Header header;
-        header.m_magic = Header::MAGIC;
-        file.writeSync(&header, sizeof(header));
-
-        // write tables
-        if (!writeTable(file, m_stringTable)) return false;
-        if (!writeTable(file, m_packages)) return false;
-        if (!writeTable(file, m_files)) return false;
-        if (!writeTable(file, m_directories)) return false;
+        // entries are always linked to the ones created after them, requiring that also rules out any cycles when walking the lists
+        auto validLink = [](int link, uint32_t index, uint32_t count)
+        {
+            return link == -1 || ((uint32_t)link > index && (uint32_t)link < count);
+        };
+
+        for (uint32_t i = 0; i < header.m_numFiles; ++i)
+        {
+            const auto& file = files[i];
+            if (file.m_name >= header.m_stringTableSize || file.m_packageIndex >= header.m_numPackages || file.m_parent >= header.m_numDirectories)
+                return false;
+            if (!validLink(file.m_nextFile, i, header.m_numFiles))
+                return false;
+        }
+
+        for (uint32_t i = 0; i < header.m_numDirectories; ++i)
+        {
+            const auto& dir = directories[i];
+            if (dir.m_name >= header.m_stringTableSize)
+                return false;
+            if (i ? (dir.m_parent < 0 || (uint32_t)dir.m_parent >= i) : (dir.m_parent != -1))
+                return false;
+            if (!validLink(dir.m_firstDir, i, header.m_numDirectories) || !validLink(dir.m_nextDir, i, header.m_numDirectories))
+                return false;
+            if (dir.m_firstFile != -1 && (dir.m_firstFile < 0 || (uint32_t)dir.m_firstFile >= header.m_numFiles))
+                return false;
+        }
+
+        m_data = data;
+        m_stringTable = (const char*)(base + header.m_stringTableOffset);
+        m_packages = packages;
+        m_files = files;
+        m_directories = directories;
+        m_numPackages = header.m_numPackages;
+        m_numFiles = header.m_numFiles;
+        m_numDirectories = header.m_numDirectories;
+        m_fileBuckets = (const uint32_t*)(base + header.m_fileBucketsOffset);
+        m_dirBuckets = (const uint32_t*)(base + header.m_dirBucketsOffset);
+        m_fileBucketMask = header.m_numFileBuckets - 1;
+        m_dirBucketMask = header.m_numDirBuckets - 1;
         return true;
     }
 
     void FileSystemIndex::dumpTables(base::StringBuilder& str) const
     {
-        str.appendf("HL2FileSystem {} files, {} directories, {} packages\n", m_files.size(), m_directories.size(), m_packages.size());
-        if (!m_directories.empty())
+        str.appendf("HL2FileSystem {} files, {} directories, {} packages\n", m_numFiles, m_numDirectories, m_numPackages);
+        if (m_numDirectories)
             dumpDir(str, 2, 0);
     }
 
@@ -749,7 +919,7 @@ namespace hl2
         auto& dirEntry = m_directories[index];
         str.appendPadding(' ', depth);
 
-        auto name  = m_stringTable.typedData() + dirEntry.m_name;
+        auto name  = m_stringTable + dirEntry.m_name;
         str.appendf("Dir[{}]: {}, hash {}\n", index, name, Hex(dirEntry.m_pathHash));
 
         for (auto childDirIndex = dirEntry.m_firstDir; childDirIndex != -1; )
@@ -762,7 +932,7 @@ namespace hl2
         {
             auto& fileEntry = m_files[fileIndex];
 
-            auto fileName  = m_stringTable.typedData() + fileEntry.m_name;
+            auto fileName  = m_stringTable + fileEntry.m_name;
             str.appendPadding(' ', depth+2);
             str.appendf("File[{}]: {}, hash {}, offset {}, size {}, archive {}, crc {}\n",
                 fileIndex, fileName, Hex(fileEntry.m_pathHash), fileEntry.m_dataOffset, fileEntry.m_dataSize, fileEntry.m_packageIndex, Hex(fileEntry.m_dataCRC));
@@ -774,22 +944,27 @@ namespace hl2
     {
         auto ret = base::CreateUniquePtr<FileSystemIndex>();
 
-        // try to load directly
+        // try to use the cache directly
         auto indexFilePath = contentPath.addFile("boomer.fscache");
+        if (IO::GetInstance().fileExists(indexFilePath))
         {
-            auto indexFileHandle = IO::GetInstance().openForReading(indexFilePath);
-            if (indexFileHandle)
+            base::ScopeTimer timer;
+
+            if (auto indexData = IO::GetInstance().openMemoryMappedForReading(indexFilePath))
             {
-                if (ret->load(*indexFileHandle))
+                if (ret->bind(indexData))
                 {
-                    ret->buildMaps();
+                    TRACE_INFO("Mapped index of {} files in {}", ret->m_numFiles, TimeInterval(timer.timeElapsed()));
                     return ret;
                 }
             }
+
+            TRACE_WARNING("Depot index cache '{}' is not valid, it will be rebuilt", indexFilePath);
         }
 
+        base::Buffer indexData;
         {
-            FileSystemDataBuilder dataBuilder(*ret);
+            FileSystemDataBuilder dataBuilder;
 
             // look for the pack files
             {
@@ -828,13 +1003,23 @@ namespace hl2
                     dataBuilder.processBSPMapFile(packageIndex, fullPath);
                 }
             }
+
+            // build the final tables
+            indexData = dataBuilder.bake();
+        }
+
+        if (!ret->bind(indexData))
+        {
+            TRACE_ERROR("Unable to build depot index for '{}'", contentPath);
+            return nullptr;
         }
 
         // print stats
         uint32_t totalFilesFound = 0;
-        for (auto& packageEntry : ret->m_packages)
+        for (uint32_t i = 0; i < ret->m_numPackages; ++i)
         {
-            auto name  = ret->m_stringTable.typedData() + packageEntry.m_name;
+            const auto& packageEntry = ret->m_packages[i];
+            auto name  = ret->m_stringTable + packageEntry.m_name;
             TRACE_INFO("Found {} files from '{}'", packageEntry.m_numFiles, name);
             totalFilesFound += packageEntry.m_numFiles;
         }
@@ -849,86 +1034,33 @@ namespace hl2
             base::io::SaveFileFromString(indexDumpFilePath, builder.toString());
         }
 
-        // save to file
+        // save to file, it's mapped directly next time
+        if (!base::io::SaveFileFromBuffer(indexFilePath, indexData))
         {
-            auto indexFileHandle = IO::GetInstance().openForWriting(indexFilePath);
-            if (indexFileHandle)
-            {
-                if (!ret->save(*indexFileHandle))
-                {
-                    TRACE_WARNING("Saving depot index cache failed, mounting next time will be slow");
-                }
-            }
+            TRACE_WARNING("Saving depot index cache failed, mounting next time will be slow");
         }
 
         // use what we've gathered
-        ret->buildMaps();
         return ret;
     }
 
-    void FileSystemIndex::buildMaps()
-    {
-        base::ScopeTimer timer;
-
-        // map directories
-        {
-            m_dirMap.reserve(m_directories.size());
-            uint32_t index = 0;
-            for (auto& dir : m_directories)
-            {
-                m_dirMap[dir.m_pathHash] = index;
-                index += 1;
-            }
-        }
-
-        // map files
-        {
-            m_fileMap.reserve(m_files.size());
-            uint32_t index = 0;
-            for (auto& file : m_files)
-            {
-                m_fileMap[file.m_pathHash] = index;
-                index += 1;
-            }
-        }
-
-        TRACE_INFO("Map building took {}", TimeInterval(timer.timeElapsed()));
-    }
-
     int FileSystemIndex::findDirectoryEntry(StringView<char> path) const
     {
-        if (m_directories.empty())
+        if (!m_numDirectories)
             return -1;
 
         if (path.empty())
             return 0;
 
-        uint32_t index = 0;
-        if (m_dirMap.find(path.calcCRC64(), index))
-            return index;
-
-        return -1;
+        return FindInBuckets(m_directories, m_dirBuckets, m_dirBucketMask, path.calcCRC64());
     }
 
     int FileSystemIndex::findFileEntry(StringView<char> path) const
     {
-        if (m_files.empty())
+        if (!m_numFiles)
             return -1;
 
-        uint32_t index = 0;
-        auto pathHash = path.calcCRC64();
-        if (m_fileMap.find(pathHash, index))
-            return index;
-
-        index = 0;
-        for (auto& file : m_files)
-        {
-            if (file.m_pathHash == pathHash)
-                return index;
-            index += 1;
-        }
-
-        return -1;
+        return FindInBuckets(m_files, m_fileBuckets, m_fileBucketMask, path.calcCRC64());
     }
 
-} // hl2
\ No newline at end of file
+} // hl2
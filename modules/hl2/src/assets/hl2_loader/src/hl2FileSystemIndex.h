@@ -17,8 +17,6 @@ namespace HLLib
 namespace hl2
 {
 
-    class FileSystemDataBuilder;
-
     // index file for the HL2 file system, helps with faster loading of the files
     class FileSystemIndex : public base::NoCopy
     {
@@ -59,19 +57,19 @@ namespace hl2
 #pragma pack(pop)
 
         /// get dir table
-        INLINE const DirInfo* directories() const { return m_directories.typedData(); }
+        INLINE const DirInfo* directories() const { return m_directories; }
 
         /// get file table
-        INLINE const FileInfo* files() const { return m_files.typedData(); }
+        INLINE const FileInfo* files() const { return m_files; }
 
         /// get package table
-        INLINE const PackageInfo* packages() const { return m_packages.typedData(); }
+        INLINE const PackageInfo* packages() const { return m_packages; }
 
         /// get number of packages
-        INLINE uint32_t numPackages() const { return m_packages.size(); }
+        INLINE uint32_t numPackages() const { return m_numPackages; }
 
         /// get string table
-        INLINE const char* stringTable() const { return m_stringTable.typedData(); }
+        INLINE const char* stringTable() const { return m_stringTable; }
 
         /// get directory entry for given directory path
         int findDirectoryEntry(StringView<char> path) const;
@@ -82,30 +80,32 @@ namespace hl2
         //--
 
         /// load the file system index from given directory, builds a new one if the current one is not up to date or does not exist
+        /// NOTE: the cache file is memory mapped and used in place, lookup tables are stored in it so nothing is rebuilt on load
         static base::UniquePtr<FileSystemIndex> Load(const base::io::AbsolutePath& contentPath);
 
     private:
-        base::Array<char> m_stringTable;
-        base::Array<PackageInfo> m_packages;
-        base::Array<FileInfo> m_files;
-        base::Array<DirInfo> m_directories;
-
-        //--
-
-        base::HashMap<uint64_t, uint32_t> m_dirMap;
-        base::HashMap<uint64_t, uint32_t> m_fileMap;
+        base::Buffer m_data; // baked index, mapped from the cache file or built in memory
+
+        const char* m_stringTable = nullptr;
+        const PackageInfo* m_packages = nullptr;
+        const FileInfo* m_files = nullptr;
+        const DirInfo* m_directories = nullptr;
+        uint32_t m_numPackages = 0;
+        uint32_t m_numFiles = 0;
+        uint32_t m_numDirectories = 0;
+
+        // open addressing tables of entries indexed by the path hash
+        const uint32_t* m_fileBuckets = nullptr;
+        const uint32_t* m_dirBuckets = nullptr;
+        uint32_t m_fileBucketMask = 0;
+        uint32_t m_dirBucketMask = 0;
 
         //--
 
-        bool load(base::io::IFileHandle& file);
-        bool save(base::io::IFileHandle& file) const;
+        bool bind(const base::Buffer& data);
 
         void dumpTables(base::StringBuilder& str) const;
         void dumpDir(base::StringBuilder& str, uint32_t depth, uint32_t index) const;
-
-        void buildMaps();
-
-        friend class FileSystemDataBuilder;
     };
 
 } // hl2
\ No newline at end of file
@@ -32,10 +32,16 @@ namespace scene
         base::Color m_lineColor;
         base::Color m_fillColor;
 
+        /// get the local space box
+        base::Box calcLocalBox() const;
+
     protected:
         virtual void handleDebugRender(rendering::scene::FrameInfo& frame) const override;
         virtual void handleSceneAttach(Scene* scene) override;
         virtual void handleSceneDetach(Scene* scene) override;
+        virtual void handleTransformUpdate(const base::Matrix& parentToWorld) override;
+
+        void updateSpatialBounds();
     };
 
     //---
@@ -0,0 +1,69 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: scene #]
+*
+***/
+
+#pragma once
+
+#include "sceneRuntimeSystem.h"
+#include "base/containers/include/hashMap.h"
+#include "base/geometry/include/shapeDynamicTree.h"
+
+namespace scene
+{
+
+    //---
+
+    /// result of the spatial query
+    struct SpatialQueryHit
+    {
+        Element* element = nullptr;
+        float distance = 0.0f;
+    };
+
+    // broad phase for the scene queries, keeps world space bounds of the elements in a dynamic tree
+    class SCENE_COMMON_API SpatialQuerySystem : public IRuntimeSystem
+    {
+        RTTI_DECLARE_VIRTUAL_CLASS(SpatialQuerySystem, IRuntimeSystem);
+
+    public:
+        SpatialQuerySystem();
+        virtual ~SpatialQuerySystem();
+
+        /// get the tree, for direct (batched) queries, proxy user data is the Element*
+        INLINE const base::shape::DynamicTree& tree() const { return m_tree; }
+
+        /// register element with given world space bounds or update the bounds if already registered
+        void registerElement(Element* elem, const base::Box& worldBounds);
+
+        /// remove element from the system
+        void unregisterElement(Element* elem);
+
+        ///---
+
+        /// find the closest element which bounds are hit by the ray
+        SpatialQueryHit castRay(const base::Vector3& origin, const base::Vector3& direction, float maxLength = VERY_LARGE_FLOAT) const;
+
+        /// find the closest element which bounds are hit by a moving box
+        SpatialQueryHit castBox(const base::Box& box, const base::Vector3& direction, float maxLength = VERY_LARGE_FLOAT) const;
+
+        /// collect elements which bounds overlap given box
+        void queryOverlap(const base::Box& box, base::Array<Element*>& outElements) const;
+
+        /// find closest hits for many rays at once, queries are spread across fibers
+        void castRays(const base::shape::DynamicTreeRay* rays, uint32_t numRays, SpatialQueryHit* outHits) const;
+
+    protected:
+        base::shape::DynamicTree m_tree;
+        base::HashMap<Element*, uint32_t> m_elementProxies;
+
+        INLINE Element* proxyElement(uint32_t proxy) const { return (Element*)m_tree.userData(proxy); }
+    };
+
+    //---
+
+} // scene
@@ -48,12 +48,34 @@ namespace scene
         // NOTE: always loaded sectors have a streaming box as big as the whole world
         base::Box m_streamingBox;
 
+        // grid cell the sector was packed from, dense cells are split into multiple sectors that share the cell
+        // NOTE: all sectors from the same cell are always rebuilt together
+        base::StringBuf m_cellName;
+
+        // layers that contributed content to this sector (indices into CompiledWorld::sourceLayers())
+        base::Array<uint32_t> m_sourceLayers;
+
         // unsaved sector data
         base::RefPtr<WorldSector> m_unsavedSectorData;
     };
 
     //--
 
+    /// Information about source layer the compiled world was built from
+    struct SCENE_COMMON_API WorldLayerDesc
+    {
+        RTTI_DECLARE_NONVIRTUAL_CLASS(WorldLayerDesc);
+
+    public:
+        // depot path to the layer
+        base::StringBuf m_path;
+
+        // CRC of the layer file at the time the world was compiled, used to detect changes
+        uint64_t m_crc = 0;
+    };
+
+    //--
+
     /// World - group of placed stuff that constitutes the gameplay world
     class SCENE_COMMON_API World : public base::res::ITextResource
     {
@@ -90,16 +112,21 @@ namespace scene
         typedef base::Array<WorldSectorDesc> TSectorInfos;
         INLINE const TSectorInfos& sectors() const { return m_sectors; }
 
+        /// get informations about layers the world was compiled from
+        typedef base::Array<WorldLayerDesc> TLayerInfos;
+        INLINE const TLayerInfos& sourceLayers() const { return m_sourceLayers; }
+
         //--
 
         // set world content
-        void content(const base::RefPtr<WorldParameterContainer>& params, const TSectorInfos& sectors);
+        void content(const base::RefPtr<WorldParameterContainer>& params, const TSectorInfos& sectors, const TLayerInfos& sourceLayers = TLayerInfos());
 
-        // save content of compiled world
+        // save content of compiled world, only the sectors with unsaved data are written (in parallel)
         bool save(base::depot::DepotStructure& loader, const base::StringBuf& worldPath);
 
     private:
         TSectorInfos m_sectors;
+        TLayerInfos m_sourceLayers;
     };
 
     //--
@@ -10,6 +10,7 @@
 * [# dependency: base_app #]
 * [# dependency: base_graph #]
 * [# dependency: base_script #]
+* [# dependency: base_geometry #]
 * [# dependency: rendering_scene #]
 ***/
 
@@ -10,6 +10,7 @@
 #include "build.h"
 #include "sceneDebugBoxComponent.h"
 #include "sceneDebugRenderingSystem.h"
+#include "sceneSpatialQuerySystem.h"
 #include "sceneRuntime.h"
 
 #include "rendering/scene/include/renderingFrameGeometryCanvas.h"
@@ -31,12 +32,8 @@ namespace scene
         , m_fillColor(60,60,60,255)
     {}
 
-    void DebugBoxComponent::handleDebugRender(rendering::scene::FrameInfo& frame) const
+    base::Box DebugBoxComponent::calcLocalBox() const
     {
-        TBaseClass::handleDebugRender(frame);
-
-        rendering::scene::GeometryCanvas dd(frame, localToWorld());
-
         base::Vector3 boxMin, boxMax;
         boxMin.x = -m_width * 0.5f;
         boxMin.y = -m_depth * 0.5f;
@@ -54,6 +51,17 @@ namespace scene
             boxMax.z = m_height * 0.5f;
         }
 
+        return base::Box(boxMin, boxMax);
+    }
+
+    void DebugBoxComponent::handleDebugRender(rendering::scene::FrameInfo& frame) const
+    {
+        TBaseClass::handleDebugRender(frame);
+
+        rendering::scene::GeometryCanvas dd(frame, localToWorld());
+
+        const auto box = calcLocalBox();
+
         if (m_solid && m_fillColor.a > 0)
         {
             if (m_fillColor.a < 255)
@@ -62,14 +70,14 @@ namespace scene
                 dd.mode(rendering::scene::FrameGeometryRenderMode::Solid);
 
             dd.fillColor(m_fillColor);
-            dd.box(boxMin, boxMax, true);
+            dd.box(box.min, box.max, true);
         }
 
         if (m_lineColor.a > 0)
         {
             dd.lineColor(m_lineColor);
             dd.mode(rendering::scene::FrameGeometryRenderMode::Solid);
-            dd.box(boxMin, boxMax, false);
+            dd.box(box.min, box.max, false);
         }
     }
 
@@ -79,6 +87,8 @@ namespace scene
 
         if (auto s = scene->system<DebugRenderingSystem>())
             s->registerElementForDebugRendering(this);
+
+        updateSpatialBounds();
     }
 
     void DebugBoxComponent::handleSceneDetach(Scene* scene)
@@ -87,6 +97,24 @@ namespace scene
 
         if (auto s = scene->system<DebugRenderingSystem>())
             s->unregisterElementForDebugRendering(this);
+
+        if (auto s = scene->system<SpatialQuerySystem>())
+            s->unregisterElement(this);
+    }
+
+    void DebugBoxComponent::handleTransformUpdate(const base::Matrix& parentToWorld)
+    {
+        TBaseClass::handleTransformUpdate(parentToWorld);
+        updateSpatialBounds();
+    }
+
+    void DebugBoxComponent::updateSpatialBounds()
+    {
+        if (isAttached())
+        {
+            if (auto s = scene()->system<SpatialQuerySystem>())
+                s->registerElement(this, localToWorld().transformBox(calcLocalBox()));
+        }
     }
 
     //--
@@ -0,0 +1,184 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "sceneLayer.h"
+#include "sceneWorld.h"
+#include "sceneEntity.h"
+#include "sceneNodeTemplate.h"
+#include "sceneNodeContainer.h"
+#include "sceneDebugBoxComponent.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "base/object/include/memoryWriter.h"
+#include "base/object/include/memoryReader.h"
+#include "base/object/include/serializationSaver.h"
+#include "base/object/include/serializationLoader.h"
+#include "base/system/include/timedScope.h"
+#include "base/resources/include/resourceBinarySaver.h"
+#include "base/resources/src/resourceGeneralTextLoader.h"
+#include "base/resources/src/resourceGeneralTextSaver.h"
+
+DECLARE_TEST_FILE(SceneLayer);
+
+using namespace base;
+
+namespace tests
+{
+    // layer with simple placed content, every node has a static entity with a debug box
+    static scene::LayerPtr CreateLayer(uint32_t numNodes)
+    {
+        auto container = CreateSharedPtr<scene::NodeTemplateContainer>();
+
+        uint32_t seed = 12345;
+        for (uint32_t i = 0; i < numNodes; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            const auto x = ((seed >> 8) & 0xFFFF) / 16.0f;
+            seed = seed * 1103515245 + 12345;
+            const auto y = ((seed >> 8) & 0xFFFF) / 16.0f;
+
+            auto node = CreateSharedPtr<scene::NodeTemplate>();
+            node->name(StringID(TempString("node{}", i)));
+            node->placement(scene::NodeTemplatePlacement(x, y, 0.0f, 0.0f, (float)(i % 360)));
+
+            auto entity = CreateSharedPtr<scene::EntityDataTemplate>();
+            entity->entityClass(scene::StaticEntity::GetStaticClass());
+            node->entityTemplate(entity);
+
+            auto box = CreateSharedPtr<scene::ComponentDataTemplate>();
+            box->componentClass(scene::DebugBoxComponent::GetStaticClass());
+            box->name("box"_id);
+            node->addComponentTemplate(box);
+
+            container->addNode(node, false);
+        }
+
+        auto layer = CreateSharedPtr<scene::Layer>();
+        layer->content(container);
+        return layer;
+    }
+
+    static bool SaveText(const ObjectPtr& object, stream::MemoryWriter& writer)
+    {
+        stream::SavingContext saveContext(object);
+        res::text::TextSaver saver;
+        return saver.saveObjects(writer, saveContext);
+    }
+
+    static bool SaveCooked(const ObjectPtr& object, stream::MemoryWriter& writer)
+    {
+        stream::SavingContext saveContext(object);
+        res::binary::BinarySaver saver;
+        return saver.saveObjects(writer, saveContext);
+    }
+
+    // text resources are always loaded with the text loader, cooked files are detected and handed to the binary loader
+    template< typename T >
+    static RefPtr<T> Load(const stream::MemoryWriter& writer)
+    {
+        stream::MemoryReader reader(writer.data(), writer.size());
+        stream::LoadingContext loadContext;
+        stream::LoadingResult loadResult;
+        res::text::TextLoader loader;
+        if (!loader.loadObjects(reader, loadContext, loadResult) || loadResult.m_loadedRootObjects.empty())
+            return nullptr;
+
+        return rtti_cast<T>(loadResult.m_loadedRootObjects[0]);
+    }
+
+} // tests
+
+TEST(SceneLayer, TextAndCookedLayerLoadTheSameContent)
+{
+    auto layer = tests::CreateLayer(20);
+
+    stream::MemoryWriter textWriter;
+    ASSERT_TRUE(tests::SaveText(layer, textWriter));
+
+    stream::MemoryWriter cookedWriter;
+    ASSERT_TRUE(tests::SaveCooked(layer, cookedWriter));
+
+    for (const auto* writer : { &textWriter, &cookedWriter })
+    {
+        auto loaded = tests::Load<scene::Layer>(*writer);
+        ASSERT_TRUE(!!loaded);
+        ASSERT_TRUE(!!loaded->nodeContainer());
+
+        const auto& nodes = loaded->nodeContainer()->nodes();
+        ASSERT_EQ(20, nodes.size());
+        for (uint32_t i = 0; i < nodes.size(); ++i)
+        {
+            const auto& original = layer->nodeContainer()->nodes()[i].m_data;
+            const auto& node = nodes[i].m_data;
+            ASSERT_TRUE(!!node);
+            EXPECT_EQ(original->name(), node->name());
+            EXPECT_EQ(original->placement(), node->placement());
+            ASSERT_TRUE(!!node->entityTemplate());
+            EXPECT_EQ(1, node->componentTemplates().size());
+        }
+    }
+}
+
+TEST(SceneLayer, DISABLED_WorldLoadingTextVsCooked)
+{
+    const uint32_t NUM_ITERATIONS = 5;
+    const uint32_t NUM_LAYERS = 16;
+
+    auto world = CreateSharedPtr<scene::World>();
+
+    stream::MemoryWriter worldTextWriter;
+    ASSERT_TRUE(tests::SaveText(world, worldTextWriter));
+
+    stream::MemoryWriter worldCookedWriter;
+    ASSERT_TRUE(tests::SaveCooked(world, worldCookedWriter));
+
+    for (uint32_t numNodes : { 100u, 1000u, 10000u })
+    {
+        // all layers of the world have the same amount of content
+        auto layer = tests::CreateLayer(numNodes);
+
+        stream::MemoryWriter textWriter;
+        ASSERT_TRUE(tests::SaveText(layer, textWriter));
+
+        stream::MemoryWriter cookedWriter;
+        ASSERT_TRUE(tests::SaveCooked(layer, cookedWriter));
+
+        // load the world and all of its layers, the way the world is loaded for compilation
+        double textTime = 0.0;
+        double cookedTime = 0.0;
+        for (uint32_t i = 0; i < NUM_ITERATIONS; ++i)
+        {
+            {
+                ScopeTimer timer;
+                ASSERT_TRUE(!!tests::Load<scene::World>(worldTextWriter));
+                for (uint32_t j = 0; j < NUM_LAYERS; ++j)
+                {
+                    auto loaded = tests::Load<scene::Layer>(textWriter);
+                    ASSERT_TRUE(loaded && loaded->nodeContainer()->nodes().size() == numNodes);
+                }
+                textTime += timer.timeElapsed();
+            }
+
+            {
+                ScopeTimer timer;
+                ASSERT_TRUE(!!tests::Load<scene::World>(worldCookedWriter));
+                for (uint32_t j = 0; j < NUM_LAYERS; ++j)
+                {
+                    auto loaded = tests::Load<scene::Layer>(cookedWriter);
+                    ASSERT_TRUE(loaded && loaded->nodeContainer()->nodes().size() == numNodes);
+                }
+                cookedTime += timer.timeElapsed();
+            }
+        }
+
+        TRACE_INFO("World with {} layers of {} nodes: text layer {} loaded in {}, cooked layer {} loaded in {} ({}x faster)",
+            NUM_LAYERS, numNodes, MemSize(textWriter.size()), TimeInterval(textTime / NUM_ITERATIONS),
+            MemSize(cookedWriter.size()), TimeInterval(cookedTime / NUM_ITERATIONS), Prec(textTime / std::max(cookedTime, 0.000001), 1));
+    }
+}
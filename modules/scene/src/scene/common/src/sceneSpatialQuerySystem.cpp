@@ -0,0 +1,120 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: scene #]
+*
+***/
+
+#include "build.h"
+#include "sceneRuntime.h"
+#include "sceneRuntimeSystem.h"
+#include "sceneElement.h"
+#include "sceneSpatialQuerySystem.h"
+
+#include "base/containers/include/frameArray.h"
+
+namespace scene
+{
+
+    ///---
+
+    RTTI_BEGIN_TYPE_CLASS(SpatialQuerySystem);
+        RTTI_METADATA(scene::RuntimeSystemInitializationOrderMetadata).order(0);
+    RTTI_END_TYPE();
+
+    SpatialQuerySystem::SpatialQuerySystem()
+    {}
+
+    SpatialQuerySystem::~SpatialQuerySystem()
+    {}
+
+    void SpatialQuerySystem::registerElement(Element* elem, const base::Box& worldBounds)
+    {
+        uint32_t proxy = INDEX_MAX;
+        if (m_elementProxies.find(elem, proxy))
+        {
+            // use the movement of the bounds as the prediction of where the element goes next
+            const auto displacement = worldBounds.center() - m_tree.box(proxy).center();
+            m_tree.moveProxy(proxy, worldBounds, displacement);
+        }
+        else
+        {
+            m_elementProxies[elem] = m_tree.createProxy(worldBounds, (uint64_t)elem);
+        }
+    }
+
+    void SpatialQuerySystem::unregisterElement(Element* elem)
+    {
+        uint32_t proxy = INDEX_MAX;
+        if (m_elementProxies.find(elem, proxy))
+        {
+            m_tree.destroyProxy(proxy);
+            m_elementProxies.remove(elem);
+        }
+    }
+
+    SpatialQueryHit SpatialQuerySystem::castRay(const base::Vector3& origin, const base::Vector3& direction, float maxLength) const
+    {
+        base::shape::DynamicTreeRay ray;
+        ray.origin = origin;
+        ray.direction = direction;
+        ray.maxLength = maxLength;
+
+        SpatialQueryHit ret;
+
+        const auto hit = m_tree.castRay(ray);
+        if (hit.proxy != INDEX_MAX)
+        {
+            ret.element = proxyElement(hit.proxy);
+            ret.distance = hit.distance;
+        }
+
+        return ret;
+    }
+
+    SpatialQueryHit SpatialQuerySystem::castBox(const base::Box& box, const base::Vector3& direction, float maxLength) const
+    {
+        base::shape::DynamicTreeSweep sweep;
+        sweep.box = box;
+        sweep.direction = direction;
+        sweep.maxLength = maxLength;
+
+        SpatialQueryHit ret;
+
+        const auto hit = m_tree.castBox(sweep);
+        if (hit.proxy != INDEX_MAX)
+        {
+            ret.element = proxyElement(hit.proxy);
+            ret.distance = hit.distance;
+        }
+
+        return ret;
+    }
+
+    void SpatialQuerySystem::queryOverlap(const base::Box& box, base::Array<Element*>& outElements) const
+    {
+        m_tree.queryOverlap(box, [this, &outElements](uint32_t proxy)
+            {
+                outElements.pushBack(proxyElement(proxy));
+                return false;
+            });
+    }
+
+    void SpatialQuerySystem::castRays(const base::shape::DynamicTreeRay* rays, uint32_t numRays, SpatialQueryHit* outHits) const
+    {
+        base::FrameArray<base::shape::DynamicTreeHit> hits(numRays);
+        hits.resize(numRays);
+        m_tree.castRays(rays, numRays, hits.typedData());
+
+        for (uint32_t i = 0; i < numRays; ++i)
+        {
+            outHits[i].element = (hits[i].proxy != INDEX_MAX) ? proxyElement(hits[i].proxy) : nullptr;
+            outHits[i].distance = hits[i].distance;
+        }
+    }
+
+    ///---
+
+} // scene
@@ -43,6 +43,13 @@ namespace scene
         RTTI_PROPERTY(m_alwaysLoaded);
         RTTI_PROPERTY(m_name);
         RTTI_PROPERTY(m_streamingBox);
+        RTTI_PROPERTY(m_cellName);
+        RTTI_PROPERTY(m_sourceLayers);
+    RTTI_END_TYPE();
+
+    RTTI_BEGIN_TYPE_STRUCT(WorldLayerDesc);
+        RTTI_PROPERTY(m_path);
+        RTTI_PROPERTY(m_crc);
     RTTI_END_TYPE();
 
     ///----
@@ -126,13 +133,14 @@ namespace scene
         RTTI_METADATA(base::res::ResourceExtensionMetadata).extension("v4compiled");
         RTTI_METADATA(base::res::ResourceDescriptionMetadata).description("Compiled World");
         RTTI_PROPERTY(m_sectors);
+        RTTI_PROPERTY(m_sourceLayers);
     RTTI_END_TYPE();
 
     CompiledWorld::CompiledWorld()
     {
     }
 
-    void CompiledWorld::content(const base::RefPtr<WorldParameterContainer>& params, const TSectorInfos& sectors)
+    void CompiledWorld::content(const base::RefPtr<WorldParameterContainer>& params, const TSectorInfos& sectors, const TLayerInfos& sourceLayers)
     {
         if (params)
         {
@@ -141,6 +149,7 @@ namespace scene
         }
 
         m_sectors = sectors;
+        m_sourceLayers = sourceLayers;
 
         for (auto& sector : m_sectors)
             if (sector.m_unsavedSectorData)
@@ -163,7 +172,7 @@ namespace scene
             TRACE_WARNING("Failed to serialize content of file '{}'", worldPath);
             return false;
         }
-        else if (loader.storeFileContent(worldPath, buffer))
+        else if (!loader.storeFileContent(worldPath, buffer))
         { 
             TRACE_WARNING("Failed to save content of file '{}'", worldPath);
             return false;
@@ -171,32 +180,45 @@ namespace scene
 
         // get world directory
         auto cookedDirectory = worldPath.stringBeforeLastNoCase("/");
+        auto sectorFileExtension = base::res::IResource::GetResourceExtensionForClass(WorldSector::GetStaticClass());
 
-        // sectors
+        // collect sectors that have new content, sectors reused from previous compilation are already on disk
+        base::Array<WorldSectorDesc*> unsavedSectors;
         for (auto& sector : m_sectors)
-        {
             if (sector.m_unsavedSectorData)
+                unsavedSectors.pushBack(&sector);
+
+        // sectors are independent, serialize and store them in parallel
+        std::atomic<uint32_t> numFailedSectors = 0;
+        RunFiberLoop("SaveWorldSector", unsavedSectors.size(), -1, [&](uint32_t index)
             {
-                auto sectorFileExtension = base::res::IResource::GetResourceExtensionForClass(WorldSector::GetStaticClass());
+                auto& sector = *unsavedSectors[index];
                 base::StringBuf sectorPath = base::TempString("{}/{}.{}", cookedDirectory, sector.m_name, sectorFileExtension);
 
                 auto buffer = base::res::SaveUncachedToBuffer(sector.m_unsavedSectorData, mountPoint);
                 if (!buffer)
                 {
                     TRACE_WARNING("Failed to serialize content of file '{}'", sectorPath);
-                    return false;
+                    ++numFailedSectors;
                 }
-                else if (loader.storeFileContent(sectorPath, buffer))
+                else if (!loader.storeFileContent(sectorPath, buffer))
                 {
-                    TRACE_WARNING("Failed to save content of file '{}'", worldPath);
-                    return false;
+                    TRACE_WARNING("Failed to save content of file '{}'", sectorPath);
+                    ++numFailedSectors;
                 }
+                else
+                {
+                    sector.m_unsavedSectorData.reset();
+                }
+            });
 
-                sector.m_unsavedSectorData.reset();
-            }
+        // all saved ?
+        if (numFailedSectors > 0)
+        {
+            TRACE_ERROR("Failed to save {} of {} sectors of world '{}'", numFailedSectors.load(), unsavedSectors.size(), worldPath);
+            return false;
         }
 
-        // all saved
         return true;
     }
 
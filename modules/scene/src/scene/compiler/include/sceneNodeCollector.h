@@ -12,6 +12,7 @@
 #include "scene/common/include/sceneNodePath.h"
 #include "scene/common/include/sceneNodeTemplate.h"
 #include "scene/common/include/sceneWorld.h"
+#include "base/containers/include/hashSet.h"
 
 namespace scene
 {
@@ -35,6 +36,9 @@ namespace scene
         // node path
         NodePath m_path;
 
+        // index of the layer the node was extracted from (as given to the extraction)
+        uint32_t m_layerIndex = 0;
+
         // child nodes
         base::Array<ExtractedNode*> m_children;
 
@@ -48,37 +52,69 @@ namespace scene
     class SCENE_COMPILER_API NodeCollector : public base::NoCopy
     {
     public:
+        // cells with more nodes are split into multiple sectors so single sector load stays small
+        static const uint32_t MAX_NODES_PER_SECTOR = 4096;
+        static const uint32_t MAX_SECTOR_SPLIT_DEPTH = 8;
+
         NodeCollector();
         ~NodeCollector();
 
         INLINE uint32_t nodeCount() const { return m_allNodes.size(); }
 
-        // extract content
-        void extractNodesFromLayer(const base::res::ResourcePath& path);
+        // extract content of single layer
+        void extractNodesFromLayer(const base::res::ResourcePath& path, uint32_t layerIndex = 0);
 
-        // pack nodes into sectors
-        void pack(base::Array<WorldSectorDesc>& outPackedSectors);
+        // extract content of selected layers, each layer is loaded and extracted on a separate fiber
+        // NOTE: nodes are merged in the order of the layer indices so the result does not depend on the scheduling
+        void extractNodesFromLayers(const base::Array<base::res::ResourcePath>& layerPaths, const base::Array<uint32_t>& layerIndices);
 
-    private:
-        base::Array<scene::PrefabPtr> m_loadedPrefabs;
-        base::Array<scene::LayerPtr> m_loadedLayers;
+        // collect names of the grid cells the nodes from given layer were placed in
+        void collectLayerCells(uint32_t layerIndex, base::HashSet<base::StringBuf>& outCellNames) const;
+
+        // pack nodes into sectors, cells with too many nodes are split into multiple sectors
+        // if the cell filter is given only the listed cells are packed (incremental compilation)
+        void pack(base::Array<WorldSectorDesc>& outPackedSectors, const base::HashSet<base::StringBuf>* cellFilter = nullptr);
 
+    protected:
+        // all extracted nodes, owned by the collector
         base::Array<ExtractedNode*> m_allNodes;
         base::Array<ExtractedNode*> m_rootNodes;
 
+    private:
+        struct ExtractedLayer
+        {
+            uint32_t m_layerIndex = 0;
+            scene::LayerPtr m_layer;
+            base::Array<ExtractedNode*> m_allNodes;
+            base::Array<ExtractedNode*> m_rootNodes;
+        };
+
+        struct PackingCell
+        {
+            base::StringBuf m_name;
+            bool m_alwaysLoaded = false;
+            base::Box m_streamingBox;
+            base::Array<const ExtractedNode*> m_nodes;
+        };
+
+        base::Array<scene::PrefabPtr> m_loadedPrefabs;
+        base::Array<scene::LayerPtr> m_loadedLayers;
+
         //--
 
-        void extractNode(const NodeTemplateContainerPtr& ptr, int nodeIndex, ExtractedNode* parentNode, const NodePath& parentPath);
+        void extractLayer(const base::res::ResourcePath& path, ExtractedLayer& outLayer) const;
+        void extractNode(const NodeTemplateContainerPtr& ptr, int nodeIndex, ExtractedNode* parentNode, const NodePath& parentPath, ExtractedLayer& outLayer) const;
+        void mergeLayer(ExtractedLayer& layer);
 
         uint8_t gridLevelForStreamingDistance(float distance) const;
         base::Point gridCooridinateForPosition(const base::AbsolutePosition& pos, uint8_t gridIndex) const;
         base::Box streamingBox(const base::Point& grid, uint8_t gridIndex) const;
 
-        WorldSectorDesc* alwaysLoadedSector(base::Array<WorldSectorDesc>& outPackedSectors);
-        WorldSectorDesc* gridSector(base::Array<WorldSectorDesc>& outPackedSectors, uint8_t gridIndex, const base::Point& grid);
+        uint64_t cellKeyForNode(const ExtractedNode* node, uint8_t& outGridIndex, base::Point& outGrid) const;
+        base::StringBuf cellName(uint64_t cellKey, uint8_t gridIndex, const base::Point& grid) const;
 
-        void packNode(const ExtractedNode* node, base::Array<WorldSectorDesc>& outPackedSectors);
-        void packNodeIntoSector(const ExtractedNode* node, WorldSectorDesc* sector);
+        void splitCell(const PackingCell& cell, const ExtractedNode** nodes, uint32_t numNodes, uint32_t depth, const base::StringBuf& name, base::Array<WorldSectorDesc>& outPackedSectors, base::Array<base::Array<const ExtractedNode*>>& outSectorNodes) const;
+        void packNodeIntoSector(const ExtractedNode* node, WorldSectorDesc* sector) const;
     };
 
     //--
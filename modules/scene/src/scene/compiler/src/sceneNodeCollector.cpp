@@ -19,6 +19,7 @@
 #include "scene/common/include/sceneNodeContainer.h"
 
 #include "base/containers/include/inplaceArray.h"
+#include "base/containers/include/hashMap.h"
 #include "base/resources/include/resourceLoader.h"
 #include "base/depot/include/depotStructure.h"
 #include "base/app/include/localServiceContainer.h"
@@ -102,7 +103,48 @@ namespace scene
         m_rootNodes.clear();
     }
 
-    void NodeCollector::extractNodesFromLayer(const base::res::ResourcePath& path)
+    void NodeCollector::extractNodesFromLayer(const base::res::ResourcePath& path, uint32_t layerIndex)
+    {
+        ExtractedLayer layer;
+        layer.m_layerIndex = layerIndex;
+        extractLayer(path, layer);
+        mergeLayer(layer);
+    }
+
+    void NodeCollector::extractNodesFromLayers(const base::Array<base::res::ResourcePath>& layerPaths, const base::Array<uint32_t>& layerIndices)
+    {
+        PC_SCOPE_LVL0(ExtractLayers);
+
+        // layers are independent, each one is extracted into a separate list
+        base::Array<ExtractedLayer> layers;
+        layers.resize(layerIndices.size());
+
+        RunFiberLoop("ExtractLayer", layerIndices.size(), -1, [&](uint32_t index)
+            {
+                auto& layer = layers[index];
+                layer.m_layerIndex = layerIndices[index];
+                extractLayer(layerPaths[layer.m_layerIndex], layer);
+            });
+
+        // merge in the order the layers were given
+        for (auto& layer : layers)
+            mergeLayer(layer);
+    }
+
+    void NodeCollector::mergeLayer(ExtractedLayer& layer)
+    {
+        // keep layer alive
+        if (layer.m_layer)
+            m_loadedLayers.pushBack(layer.m_layer);
+
+        m_allNodes.pushBack(layer.m_allNodes.typedData(), layer.m_allNodes.size());
+        m_rootNodes.pushBack(layer.m_rootNodes.typedData(), layer.m_rootNodes.size());
+
+        layer.m_allNodes.reset();
+        layer.m_rootNodes.reset();
+    }
+
+    void NodeCollector::extractLayer(const base::res::ResourcePath& path, ExtractedLayer& outLayer) const
     {
         PC_SCOPE_LVL0(ExtractLayer);
 
@@ -121,7 +163,7 @@ namespace scene
         }
 
         // keep layer alive
-        m_loadedLayers.pushBack(layer);
+        outLayer.m_layer = layer;
 
         // no layer content
         auto layerData = layer->nodeContainer();
@@ -149,12 +191,12 @@ namespace scene
 
         // process the extracted nodes
         for (auto rootIndex : flattenedNodes->rootNodes())
-            extractNode(flattenedNodes, rootIndex, nullptr, layerPath);
+            extractNode(flattenedNodes, rootIndex, nullptr, layerPath, outLayer);
 
-        TRACE_INFO("Extarcted {} final flat entnties from {} nodes", m_allNodes.size(), flattenedNodes->nodes().size());
+        TRACE_INFO("Extarcted {} final flat entnties from {} nodes", outLayer.m_allNodes.size(), flattenedNodes->nodes().size());
     }
 
-    void NodeCollector::extractNode(const NodeTemplateContainerPtr& ptr, int nodeIndex, ExtractedNode* parentNode, const NodePath& parentPath)
+    void NodeCollector::extractNode(const NodeTemplateContainerPtr& ptr, int nodeIndex, ExtractedNode* parentNode, const NodePath& parentPath, ExtractedLayer& outLayer) const
     {
         auto& sourceNode = ptr->nodes()[nodeIndex];
 
@@ -170,16 +212,17 @@ namespace scene
                 retNode->m_parent = parentNode;
                 retNode->m_entity = compiledEntity;
                 retNode->m_path = parentPath[sourceNode.m_data->name()];
-                m_allNodes.pushBack(retNode);
+                retNode->m_layerIndex = outLayer.m_layerIndex;
+                outLayer.m_allNodes.pushBack(retNode);
 
                 if (parentNode)
                     parentNode->m_children.pushBack(retNode);
                 else
-                    m_rootNodes.pushBack(retNode);
+                    outLayer.m_rootNodes.pushBack(retNode);
 
                 // recurse
                 for (auto childNodeIndex : sourceNode.m_children)
-                    extractNode(ptr, childNodeIndex, retNode, retNode->m_path);
+                    extractNode(ptr, childNodeIndex, retNode, retNode->m_path, outLayer);
             }
         }
     }
@@ -189,6 +232,11 @@ namespace scene
     static const uint32_t TOP_LEVEL_GRID_SIZE = 1024;
     static const uint8_t MAX_GRID_LEVELS = 4;
 
+    static const uint64_t ALWAYS_LOADED_CELL_KEY = ~0ULL;
+
+    // number of nodes classified by single job
+    static const uint32_t NODES_PER_PACKING_JOB = 4096;
+
     uint8_t NodeCollector::gridLevelForStreamingDistance(float distance) const
     {
         uint32_t size = TOP_LEVEL_GRID_SIZE;
@@ -232,40 +280,51 @@ namespace scene
         return base::Point(x, y);
     }
 
-    WorldSectorDesc* NodeCollector::alwaysLoadedSector(base::Array<WorldSectorDesc>& outPackedSectors)
+    uint64_t NodeCollector::cellKeyForNode(const ExtractedNode* node, uint8_t& outGridIndex, base::Point& outGrid) const
     {
-        for (auto& entry : outPackedSectors)
-            if (entry.m_alwaysLoaded)
-                return &entry;
+        // put all "always loaded" stuff into the same sector
+        if (node->m_streamingModel == StreamingModel::AlwaysLoaded)
+            return ALWAYS_LOADED_CELL_KEY;
 
-        auto& sector = outPackedSectors.emplaceBack();
-        sector.m_alwaysLoaded = true;
-        sector.m_name = "root";
-        sector.m_streamingBox = base::Box(base::Vector3(-100000.0f, -100000.0f, -100000.0f), base::Vector3(100000.0f, 100000.0f, 100000.0f));
-        sector.m_unsavedSectorData = base::CreateSharedPtr<WorldSector>();
-        
-        return &sector;
+        // calculate the streaming distance
+        float streamingDistance = node->m_streamingOverrideDistance;
+        if (streamingDistance <= 0.0f)
+            streamingDistance = node->m_entity->calculateRequiredStreamingDistance();
+        streamingDistance = std::max<float>(streamingDistance, 5.0f);
+
+        // get grid cell
+        outGridIndex = gridLevelForStreamingDistance(streamingDistance);
+        outGrid = gridCooridinateForPosition(node->m_entity->relativePosition(), outGridIndex);
+
+        // NOTE: 28 bits per coordinate is way more than any world we can place in the top level grid
+        return ((uint64_t)outGridIndex << 56) | ((uint64_t)(outGrid.x & 0xFFFFFFF) << 28) | (uint64_t)(outGrid.y & 0xFFFFFFF);
     }
 
-    WorldSectorDesc* NodeCollector::gridSector(base::Array<WorldSectorDesc>& outPackedSectors, uint8_t gridIndex, const base::Point& grid)
+    base::StringBuf NodeCollector::cellName(uint64_t cellKey, uint8_t gridIndex, const base::Point& grid) const
     {
+        if (cellKey == ALWAYS_LOADED_CELL_KEY)
+            return base::StringBuf("root");
+
         base::TempString name;
         name.appendf("grid{}_{}_{}", gridIndex, grid.x, grid.y);
+        return base::StringBuf(name);
+    }
 
-        for (auto& entry : outPackedSectors)
-            if (entry.m_name == name)
-                return &entry;
-
-        auto& sector = outPackedSectors.emplaceBack();
-        sector.m_alwaysLoaded = false;
-        sector.m_name = name;
-        sector.m_streamingBox = streamingBox(grid, gridIndex);
-        sector.m_unsavedSectorData = base::CreateSharedPtr<WorldSector>();
-
-        return &sector;
+    void NodeCollector::collectLayerCells(uint32_t layerIndex, base::HashSet<base::StringBuf>& outCellNames) const
+    {
+        for (auto node : m_allNodes)
+        {
+            if (node->m_layerIndex == layerIndex && node->m_streamingModel != StreamingModel::Discard)
+            {
+                uint8_t gridIndex = 0;
+                base::Point grid;
+                auto cellKey = cellKeyForNode(node, gridIndex, grid);
+                outCellNames.insert(cellName(cellKey, gridIndex, grid));
+            }
+        }
     }
 
-    void NodeCollector::packNodeIntoSector(const ExtractedNode* node, WorldSectorDesc* sector)
+    void NodeCollector::packNodeIntoSector(const ExtractedNode* node, WorldSectorDesc* sector) const
     {
         if (node->m_entity)
         {
@@ -274,44 +333,128 @@ namespace scene
         }
     }
 
-    void NodeCollector::packNode(const ExtractedNode* node, base::Array<WorldSectorDesc>& outPackedSectors)
+    void NodeCollector::splitCell(const PackingCell& cell, const ExtractedNode** nodes, uint32_t numNodes, uint32_t depth, const base::StringBuf& name, base::Array<WorldSectorDesc>& outPackedSectors, base::Array<base::Array<const ExtractedNode*>>& outSectorNodes) const
     {
-        // skip discarded nodes
-        if (node->m_streamingModel == StreamingModel::Discard)
+        // split dense cells in half along the longer side of the node bounds, splitting at the median keeps the halves balanced
+        // NOTE: the parts keep the streaming box of the whole cell so the content is streamed exactly as before, just in smaller pieces
+        if (!cell.m_alwaysLoaded && numNodes > MAX_NODES_PER_SECTOR && depth < MAX_SECTOR_SPLIT_DEPTH)
+        {
+            base::Box bounds;
+            for (uint32_t i = 0; i < numNodes; ++i)
+                bounds.merge(nodes[i]->m_entity->relativePosition().approximate());
+
+            const auto splitAlongY = (bounds.max.y - bounds.min.y) > (bounds.max.x - bounds.min.x);
+            const auto half = numNodes / 2;
+            std::nth_element(nodes, nodes + half, nodes + numNodes, [splitAlongY](const ExtractedNode* a, const ExtractedNode* b)
+                {
+                    const auto& posA = a->m_entity->relativePosition().approximate();
+                    const auto& posB = b->m_entity->relativePosition().approximate();
+                    return splitAlongY ? (posA.y < posB.y) : (posA.x < posB.x);
+                });
+
+            splitCell(cell, nodes, half, depth + 1, base::StringBuf(base::TempString("{}_0", name)), outPackedSectors, outSectorNodes);
+            splitCell(cell, nodes + half, numNodes - half, depth + 1, base::StringBuf(base::TempString("{}_1", name)), outPackedSectors, outSectorNodes);
             return;
+        }
 
-        // get target sector
-        WorldSectorDesc* targetSector = nullptr;
-        if (node->m_streamingModel == StreamingModel::AlwaysLoaded)
+        auto& sector = outPackedSectors.emplaceBack();
+        sector.m_alwaysLoaded = cell.m_alwaysLoaded;
+        sector.m_name = name;
+        sector.m_cellName = cell.m_name;
+        sector.m_streamingBox = cell.m_streamingBox;
+        sector.m_unsavedSectorData = base::CreateSharedPtr<WorldSector>();
+
+        // remember which layers contributed to the sector so we know what to rebuild when they change
+        for (uint32_t i = 0; i < numNodes; ++i)
+            sector.m_sourceLayers.pushBackUnique(nodes[i]->m_layerIndex);
+        std::sort(sector.m_sourceLayers.begin(), sector.m_sourceLayers.end());
+
+        // entities are added to the sector later
+        outSectorNodes.emplaceBack().pushBack(nodes, numNodes);
+    }
+
+    void NodeCollector::pack(base::Array<WorldSectorDesc>& outPackedSectors, const base::HashSet<base::StringBuf>* cellFilter)
+    {
+        PC_SCOPE_LVL0(PackNodes);
+
+        struct NodePlacement
         {
-            // put all "always loaded" stuff into the same sector
-            targetSector = alwaysLoadedSector(outPackedSectors);
-        }
-        else
+            uint64_t cellKey = 0;
+            uint8_t gridIndex = 0;
+            base::Point grid;
+        };
+
+        // find the target cell of every node, this asks the entities about their streaming distance so it's done in parallel
+        base::Array<NodePlacement> placements;
+        placements.resize(m_allNodes.size());
+
+        const auto numJobs = (m_allNodes.size() + NODES_PER_PACKING_JOB - 1) / NODES_PER_PACKING_JOB;
+        RunFiberLoop("ClassifyNodes", numJobs, -1, [&](uint32_t jobIndex)
+            {
+                const auto firstNode = jobIndex * NODES_PER_PACKING_JOB;
+                const auto lastNode = std::min<uint32_t>(firstNode + NODES_PER_PACKING_JOB, m_allNodes.size());
+                for (uint32_t i = firstNode; i < lastNode; ++i)
+                {
+                    auto node = m_allNodes[i];
+                    if (node->m_streamingModel != StreamingModel::Discard)
+                    {
+                        auto& placement = placements[i];
+                        placement.cellKey = cellKeyForNode(node, placement.gridIndex, placement.grid);
+                    }
+                }
+            });
+
+        // bucket nodes into cells
+        base::Array<PackingCell> cells;
+        base::HashMap<uint64_t, uint32_t> cellMap;
+        for (uint32_t i = 0; i < m_allNodes.size(); ++i)
         {
-            // calculate the streaming distance
-            float streamingDistance = node->m_streamingOverrideDistance;
-            if (streamingDistance <= 0.0f)
-                streamingDistance = node->m_entity->calculateRequiredStreamingDistance();
-            streamingDistance = std::max<float>(streamingDistance, 5.0f);
+            // skip discarded nodes
+            auto node = m_allNodes[i];
+            if (node->m_streamingModel == StreamingModel::Discard)
+                continue;
+
+            const auto& placement = placements[i];
 
-            // get grid sector
-            auto gridIndex = gridLevelForStreamingDistance(streamingDistance);
-            auto grid = gridCooridinateForPosition(node->m_entity->relativePosition(), gridIndex);
+            uint32_t cellIndex = 0;
+            if (!cellMap.find(placement.cellKey, cellIndex))
+            {
+                cellIndex = cells.size();
+                cellMap[placement.cellKey] = cellIndex;
+
+                auto& cell = cells.emplaceBack();
+                cell.m_name = cellName(placement.cellKey, placement.gridIndex, placement.grid);
+                cell.m_alwaysLoaded = (placement.cellKey == ALWAYS_LOADED_CELL_KEY);
 
-            targetSector = gridSector(outPackedSectors, gridIndex, grid);
+                if (cell.m_alwaysLoaded)
+                    cell.m_streamingBox = base::Box(base::Vector3(-100000.0f, -100000.0f, -100000.0f), base::Vector3(100000.0f, 100000.0f, 100000.0f));
+                else
+                    cell.m_streamingBox = streamingBox(placement.grid, placement.gridIndex);
+            }
+
+            cells[cellIndex].m_nodes.pushBack(node);
         }
 
-        // add node to sector
-        packNodeIntoSector(node, targetSector);
-    }
+        // create sectors for the cells, dense cells are split
+        const auto firstNewSector = outPackedSectors.size();
+        base::Array<base::Array<const ExtractedNode*>> sectorNodes;
+        for (auto& cell : cells)
+        {
+            if (cellFilter && !cellFilter->contains(cell.m_name))
+                continue;
 
-    void NodeCollector::pack(base::Array<WorldSectorDesc>& outPackedSectors)
-    {
-        // TODO: better hierarchical approach
+            splitCell(cell, cell.m_nodes.typedData(), cell.m_nodes.size(), 0, cell.m_name, outPackedSectors, sectorNodes);
+        }
+
+        // fill the sectors, each one has different entities so they can be filled in parallel
+        RunFiberLoop("PackSector", sectorNodes.size(), -1, [&](uint32_t index)
+            {
+                auto& sector = outPackedSectors[firstNewSector + index];
+                for (auto node : sectorNodes[index])
+                    packNodeIntoSector(node, &sector);
+            });
 
-        for (auto node  : m_allNodes)
-            packNode(node, outPackedSectors);
+        TRACE_INFO("Packed {} cells into {} sectors", cells.size(), sectorNodes.size());
     }
 
     //--
@@ -0,0 +1,261 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "sceneNodeCollector.h"
+
+#include "base/test/include/gtest/gtest.h"
+#include "scene/common/include/sceneEntity.h"
+
+DECLARE_TEST_FILE(SceneNodeCollector);
+
+using namespace base;
+
+namespace tests
+{
+    // streaming distance that puts the nodes in the top level grid (cells of 1024 units)
+    static const float TOP_LEVEL_STREAMING_DISTANCE = 2000.0f;
+    static const float TOP_LEVEL_CELL_SIZE = 1024.0f;
+
+    /// collector that takes synthetic nodes instead of extracting them from the layers
+    class NodeCollectorTester : public scene::NodeCollector
+    {
+    public:
+        void addNode(float x, float y, uint32_t layerIndex = 0, scene::StreamingModel model = scene::StreamingModel::Auto, float streamingDistance = TOP_LEVEL_STREAMING_DISTANCE)
+        {
+            auto entity = CreateSharedPtr<scene::StaticEntity>();
+            entity->relativePosition(Vector3(x, y, 0.0f));
+
+            auto node = MemNew(scene::ExtractedNode);
+            node->m_entity = entity;
+            node->m_layerIndex = layerIndex;
+            node->m_streamingModel = model;
+            node->m_streamingOverrideDistance = streamingDistance;
+
+            m_allNodes.pushBack(node);
+            m_rootNodes.pushBack(node);
+        }
+    };
+
+    // place nodes in the cell at the center of the world, positions are shuffled so the split has to do the sorting
+    static void AddShuffledNodes(NodeCollectorTester& nodes, uint32_t numNodes, float sizeX, float sizeY)
+    {
+        for (uint32_t i = 0; i < numNodes; ++i)
+        {
+            const auto frac = ((i * 7919ULL) % numNodes) / (float)numNodes;
+            nodes.addNode((frac - 0.5f) * sizeX, (frac - 0.5f) * sizeY);
+        }
+    }
+
+    static Box SectorBounds(const scene::WorldSectorDesc& sector)
+    {
+        Box ret;
+        for (const auto& entity : sector.m_unsavedSectorData->m_entities)
+            ret.merge(entity->relativePosition());
+        return ret;
+    }
+
+    static const scene::WorldSectorDesc* FindSector(const Array<scene::WorldSectorDesc>& sectors, const char* name)
+    {
+        for (const auto& sector : sectors)
+            if (sector.m_name == StringView<char>(name))
+                return &sector;
+        return nullptr;
+    }
+
+} // tests
+
+TEST(SceneNodeCollector, SmallCellIsNotSplit)
+{
+    tests::NodeCollectorTester nodes;
+    for (uint32_t i = 0; i < 100; ++i)
+        nodes.addNode(i - 50.0f, 0.0f, (i % 3) * 2);
+
+    Array<scene::WorldSectorDesc> sectors;
+    nodes.pack(sectors);
+
+    ASSERT_EQ(1, sectors.size());
+    EXPECT_STREQ("grid0_0_0", sectors[0].m_name.c_str());
+    EXPECT_STREQ("grid0_0_0", sectors[0].m_cellName.c_str());
+    EXPECT_FALSE(sectors[0].m_alwaysLoaded);
+    EXPECT_EQ(100, sectors[0].m_unsavedSectorData->m_entities.size());
+
+    // source layers are listed once, sorted
+    ASSERT_EQ(3, sectors[0].m_sourceLayers.size());
+    EXPECT_EQ(0, sectors[0].m_sourceLayers[0]);
+    EXPECT_EQ(2, sectors[0].m_sourceLayers[1]);
+    EXPECT_EQ(4, sectors[0].m_sourceLayers[2]);
+}
+
+TEST(SceneNodeCollector, DenseCellIsSplitAtMedianAlongLongerAxis)
+{
+    // three times over the limit, each half is still over the limit so the cell ends up in four sectors
+    const uint32_t maxNodes = scene::NodeCollector::MAX_NODES_PER_SECTOR;
+    const uint32_t numNodes = maxNodes * 3;
+
+    tests::NodeCollectorTester nodes;
+    tests::AddShuffledNodes(nodes, numNodes, 800.0f, 10.0f);
+
+    Array<scene::WorldSectorDesc> sectors;
+    nodes.pack(sectors);
+
+    // parts are named after the halves they were split into, in order along the split axis
+    const char* names[] = { "grid0_0_0_0_0", "grid0_0_0_0_1", "grid0_0_0_1_0", "grid0_0_0_1_1" };
+    ASSERT_EQ(ARRAY_COUNT(names), sectors.size());
+
+    Box previousBounds;
+    for (int i = 0; i < ARRAY_COUNT(names); ++i)
+    {
+        const auto& sector = sectors[i];
+        EXPECT_STREQ(names[i], sector.m_name.c_str());
+        EXPECT_STREQ("grid0_0_0", sector.m_cellName.c_str());
+        EXPECT_EQ(numNodes / 4, sector.m_unsavedSectorData->m_entities.size()) << names[i];
+
+        // parts keep the streaming box of the whole cell
+        EXPECT_EQ(sectors[0].m_streamingBox, sector.m_streamingBox);
+
+        // parts don't overlap along the longer axis
+        const auto bounds = tests::SectorBounds(sector);
+        if (i > 0)
+            EXPECT_LT(previousBounds.max.x, bounds.min.x) << names[i];
+        previousBounds = bounds;
+    }
+}
+
+TEST(SceneNodeCollector, DenseCellIsSplitAlongY)
+{
+    const uint32_t maxNodes = scene::NodeCollector::MAX_NODES_PER_SECTOR;
+    const uint32_t numNodes = maxNodes + 1;
+
+    tests::NodeCollectorTester nodes;
+    tests::AddShuffledNodes(nodes, numNodes, 10.0f, 800.0f);
+
+    Array<scene::WorldSectorDesc> sectors;
+    nodes.pack(sectors);
+
+    // split once, the odd node goes to the second half
+    ASSERT_EQ(2, sectors.size());
+    EXPECT_STREQ("grid0_0_0_0", sectors[0].m_name.c_str());
+    EXPECT_STREQ("grid0_0_0_1", sectors[1].m_name.c_str());
+    EXPECT_EQ(numNodes / 2, sectors[0].m_unsavedSectorData->m_entities.size());
+    EXPECT_EQ(numNodes - numNodes / 2, sectors[1].m_unsavedSectorData->m_entities.size());
+    EXPECT_LT(tests::SectorBounds(sectors[0]).max.y, tests::SectorBounds(sectors[1]).min.y);
+}
+
+TEST(SceneNodeCollector, CellAtLimitIsNotSplit)
+{
+    const uint32_t maxNodes = scene::NodeCollector::MAX_NODES_PER_SECTOR;
+
+    tests::NodeCollectorTester nodes;
+    tests::AddShuffledNodes(nodes, maxNodes, 800.0f, 10.0f);
+
+    Array<scene::WorldSectorDesc> sectors;
+    nodes.pack(sectors);
+
+    ASSERT_EQ(1, sectors.size());
+    EXPECT_STREQ("grid0_0_0", sectors[0].m_name.c_str());
+    EXPECT_EQ(maxNodes, sectors[0].m_unsavedSectorData->m_entities.size());
+}
+
+TEST(SceneNodeCollector, AlwaysLoadedCellIsNotSplit)
+{
+    const uint32_t maxNodes = scene::NodeCollector::MAX_NODES_PER_SECTOR;
+
+    tests::NodeCollectorTester nodes;
+    for (uint32_t i = 0; i <= maxNodes; ++i)
+        nodes.addNode((float)i, 0.0f, 0, scene::StreamingModel::AlwaysLoaded);
+
+    Array<scene::WorldSectorDesc> sectors;
+    nodes.pack(sectors);
+
+    ASSERT_EQ(1, sectors.size());
+    EXPECT_STREQ("root", sectors[0].m_name.c_str());
+    EXPECT_TRUE(sectors[0].m_alwaysLoaded);
+    EXPECT_EQ(maxNodes + 1, sectors[0].m_unsavedSectorData->m_entities.size());
+}
+
+TEST(SceneNodeCollector, CellFilterPacksOnlyListedCells)
+{
+    tests::NodeCollectorTester nodes;
+    nodes.addNode(0.0f, 0.0f);
+    nodes.addNode(tests::TOP_LEVEL_CELL_SIZE * 2.0f, 0.0f);
+    nodes.addNode(0.0f, -tests::TOP_LEVEL_CELL_SIZE);
+    nodes.addNode(0.0f, 0.0f, 0, scene::StreamingModel::Discard);
+
+    HashSet<StringBuf> filter;
+    filter.insert(StringBuf("grid0_2_0"));
+    filter.insert(StringBuf("grid0_0_-1"));
+
+    // sectors are appended after the ones already in the list
+    Array<scene::WorldSectorDesc> sectors;
+    sectors.emplaceBack().m_name = StringBuf("reused");
+    nodes.pack(sectors, &filter);
+
+    ASSERT_EQ(3, sectors.size());
+    EXPECT_STREQ("reused", sectors[0].m_name.c_str());
+    EXPECT_EQ(nullptr, tests::FindSector(sectors, "grid0_0_0"));
+    ASSERT_NE(nullptr, tests::FindSector(sectors, "grid0_2_0"));
+    ASSERT_NE(nullptr, tests::FindSector(sectors, "grid0_0_-1"));
+    EXPECT_EQ(1, tests::FindSector(sectors, "grid0_2_0")->m_unsavedSectorData->m_entities.size());
+    EXPECT_EQ(1, tests::FindSector(sectors, "grid0_0_-1")->m_unsavedSectorData->m_entities.size());
+}
+
+TEST(SceneNodeCollector, CollectLayerCells)
+{
+    tests::NodeCollectorTester nodes;
+    nodes.addNode(0.0f, 0.0f, 0);
+    nodes.addNode(tests::TOP_LEVEL_CELL_SIZE, 0.0f, 0);
+    nodes.addNode(tests::TOP_LEVEL_CELL_SIZE * 3.0f, 0.0f, 0, scene::StreamingModel::Discard);
+    nodes.addNode(0.0f, 0.0f, 0, scene::StreamingModel::AlwaysLoaded);
+    nodes.addNode(0.0f, tests::TOP_LEVEL_CELL_SIZE, 1);
+
+    HashSet<StringBuf> cells;
+    nodes.collectLayerCells(0, cells);
+
+    // discarded nodes are not placed anywhere
+    EXPECT_EQ(3, cells.size());
+    EXPECT_TRUE(cells.contains(StringBuf("grid0_0_0")));
+    EXPECT_TRUE(cells.contains(StringBuf("grid0_1_0")));
+    EXPECT_TRUE(cells.contains(StringBuf("root")));
+    EXPECT_FALSE(cells.contains(StringBuf("grid0_3_0")));
+    EXPECT_FALSE(cells.contains(StringBuf("grid0_0_1")));
+}
+
+TEST(SceneNodeCollector, DISABLED_PackLargeNodeCount)
+{
+    for (uint32_t numNodes : { 100000u, 1000000u })
+    {
+        // nodes spread over 16x16 top level cells with a dense town in the middle, streaming distances cover all grid levels
+        tests::NodeCollectorTester nodes;
+        uint32_t seed = 12345;
+        for (uint32_t i = 0; i < numNodes; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            const auto fx = ((seed >> 8) & 0xFFFF) / 65536.0f;
+            seed = seed * 1103515245 + 12345;
+            const auto fy = ((seed >> 8) & 0xFFFF) / 65536.0f;
+
+            const auto extent = (i % 4) ? (tests::TOP_LEVEL_CELL_SIZE * 16.0f) : 200.0f;
+            const auto distance = (float)(50 << (i % 6));
+            nodes.addNode((fx - 0.5f) * extent, (fy - 0.5f) * extent, i % 64, scene::StreamingModel::Auto, distance);
+        }
+
+        Array<scene::WorldSectorDesc> sectors;
+
+        ScopeTimer timer;
+        nodes.pack(sectors);
+        const auto packTime = timer.timeElapsed();
+
+        uint32_t numPacked = 0;
+        for (const auto& sector : sectors)
+            numPacked += sector.m_unsavedSectorData->m_entities.size();
+        EXPECT_EQ(numNodes, numPacked);
+
+        TRACE_INFO("Packed {} nodes into {} sectors in {}", numNodes, sectors.size(), TimeInterval(packTime));
+    }
+}
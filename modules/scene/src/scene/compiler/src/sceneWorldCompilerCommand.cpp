@@ -8,53 +8,56 @@
 
 #include "build.h"
 
-#include "base/app/include/localServiceContainer.h"
+#include "base/app/include/command.h"
 #include "base/app/include/commandline.h"
 #include "base/app/include/localServiceContainer.h"
 #include "base/io/include/ioSystem.h"
 #include "base/io/include/absolutePath.h"
 #include "base/io/include/absolutePathBuilder.h"
-//#include "base/depot/include/depotStructure.h"
+#include "base/depot/include/depotStructure.h"
+#include "base/resources/include/resourceLoadingService.h"
+#include "base/resources/include/resourceUncached.h"
+#include "base/containers/include/hashMap.h"
+#include "base/containers/include/hashSet.h"
 
 #include "scene/common/include/sceneWorld.h"
 #include "scene/common/include/sceneLayer.h"
 
 #include "sceneNodeCollector.h"
+#include "sceneWorldIncremental.h"
 
 namespace scene
 {
 
-#if 0
     //--
 
+    /// compiles the world into streamable sectors
+    /// layers are extracted and sectors are saved in parallel, with -incremental only the cells affected by changed layers are rebuilt
+    /// usage: bcc compileWorld -worldPath=<depot path to world file to compile> [-incremental]
     class WorldCompiler : public base::app::ICommand
     {
         RTTI_DECLARE_VIRTUAL_CLASS(WorldCompiler, base::app::ICommand);
 
     public:
-        WorldCompiler()
-        {
-            name = "WorldCompiler"_id;
-        }
-
-        virtual void printHelp() const override final
-        {
-            TRACE_INFO("Command: WorldCompiler");
-            TRACE_INFO("Version: 0.1");
-            TRACE_INFO("Arguments:");
-            TRACE_INFO("  -worldPath=<depot path to world file to compile>");
-        }
-
-        virtual int execute(const base::app::CommandLine& commandLine) override final
+        virtual bool run(const base::app::CommandLine& commandLine) override final
         {
             base::ScopeTimer timer;
 
             // get the path to the world
-            auto worldDepotPath = commandLine.singleValue("worldPath");
+            const auto& worldDepotPath = commandLine.singleValue("worldPath");
             if (worldDepotPath.empty())
             {
                 TRACE_ERROR("Missing path to world file (-worldPath)");
-                return -2;
+                return false;
+            }
+
+            // we need the depot to list the layers and to save the output
+            auto loadingService = base::GetService<base::res::LoadingService>();
+            auto* depot = (loadingService && loadingService->loader()) ? loadingService->loader()->queryUncookedDepot() : nullptr;
+            if (!depot)
+            {
+                TRACE_ERROR("Resource loading service does not have uncooked depot attached, world can't be compiled");
+                return false;
             }
 
             // load the world
@@ -62,64 +65,193 @@ namespace scene
             if (!world)
             {
                 TRACE_ERROR("Unable to load world from '{}'", worldDepotPath);
-                return -4;
+                return false;
             }
 
             // print world name
             TRACE_INFO("Started to process world '{}'", worldDepotPath);
 
-            base::depot::DepotStructure loader;
-            if (!loader.initialize(commandLine))
-            { 
-                TRACE_ERROR("Cannot initialize depot at given depot path");
-                return -5;
-            }
-
             // list all layers
             base::Array<base::res::ResourcePath> worldLayerPaths;
-            world->collectLayerPaths(loader, worldLayerPaths);
-            TRACE_INFO("Found {} layers in world '{}", worldLayerPaths.size(), worldDepotPath);
+            world->collectLayerPaths(*depot, worldLayerPaths);
+            TRACE_INFO("Found {} layers in world '{}'", worldLayerPaths.size(), worldDepotPath);
 
-            // extract nodes
-            NodeCollector nodes;
+            // get the CRC of each layer, used to detect what changed since the last compilation
+            CompiledWorld::TLayerInfos layerInfos;
             {
                 base::ScopeTimer timer;
 
-                for (auto& path : worldLayerPaths)
-                    nodes.extractNodesFromLayer(path);
+                layerInfos.resize(worldLayerPaths.size());
+                RunFiberLoop("QueryLayerCRC", worldLayerPaths.size(), -1, [&](uint32_t index)
+                    {
+                        auto& info = layerInfos[index];
+                        info.m_path = base::StringBuf(worldLayerPaths[index].path());
+                        if (!depot->queryFileInfo(info.m_path, &info.m_crc, nullptr, nullptr))
+                            TRACE_WARNING("Unable to compute CRC of layer '{}', it will be always rebuilt", info.m_path);
+                    });
 
-                TRACE_INFO("Extracted {} nodes in {}", nodes.nodeCount(), TimeInterval(timer.timeElapsed()));
+                TRACE_INFO("Computed CRC of {} layers in {}", layerInfos.size(), TimeInterval(timer.timeElapsed()));
             }
 
-            // compile sectors
-            base::Array<WorldSectorDesc> cookedSectors;
+            // get the path to cooked data for the world
+            auto worldCookedPath = base::StringBuf(base::TempString("{}/cooked/{}.{}", worldDepotPath.stringBeforeLast("/"),
+                worldDepotPath.stringAfterLast("/").stringBeforeLast("."), base::res::IResource::GetResourceExtensionForClass(CompiledWorld::GetStaticClass())));
+            TRACE_INFO("Output path for cooked world: '{}'", worldCookedPath);
+
+            // load the results of previous compilation, without them we can only rebuild everything
+            base::RefPtr<CompiledWorld> previousWorld;
+            if (commandLine.hasParam("incremental"))
             {
-                base::ScopeTimer timer;
-                nodes.pack(cookedSectors);
-                TRACE_INFO("Packed {} nodes into {} sectors in {}", nodes.nodeCount(), cookedSectors.size(), TimeInterval(timer.timeElapsed()));
+                previousWorld = loadPreviousCompilation(*depot, worldCookedPath);
+                if (!previousWorld)
+                    TRACE_WARNING("No valid previous compilation of '{}' found, world will be fully rebuilt", worldDepotPath);
             }
 
-            // get the path to cooked data for the world
-            auto worldCookedPath = base::StringBuf(base::TempString("{}/cooked/", worldDepotPath.stringBeforeLast("/")));
-            TRACE_INFO("Output path for cooked world: '{}'", worldCookedPath);
+            // compile
+            CompiledWorld::TSectorInfos cookedSectors;
+            if (previousWorld)
+                compileIncremental(*previousWorld, worldLayerPaths, layerInfos, cookedSectors);
+            else
+                compileFull(worldLayerPaths, cookedSectors);
 
             // create the cooked world resource
             auto cookedWorld = base::CreateSharedPtr<CompiledWorld>();
-            cookedWorld->content(world->parameters(), cookedSectors);
+            cookedWorld->content(world->parameters(), cookedSectors, layerInfos);
 
             // save cooked world
-            if (!cookedWorld->save(loader, worldCookedPath))
             {
-                TRACE_ERROR("Failed to save content of cooked world");
-                return -4;
+                base::ScopeTimer timer;
+
+                if (!cookedWorld->save(*depot, worldCookedPath))
+                {
+                    TRACE_ERROR("Failed to save content of cooked world");
+                    return false;
+                }
+
+                TRACE_INFO("Saved cooked world in {}", TimeInterval(timer.timeElapsed()));
             }
 
             // done
             TRACE_INFO("All processing done in {}", TimeInterval(timer.timeElapsed()));
-            return 0;
+            return true;
+        }
+
+    private:
+        base::RefPtr<CompiledWorld> loadPreviousCompilation(base::depot::DepotStructure& depot, const base::StringBuf& worldCookedPath) const
+        {
+            base::io::AbsolutePath absolutePath;
+            if (!depot.queryFileAbsolutePath(worldCookedPath, absolutePath) || !IO::GetInstance().fileExists(absolutePath))
+                return nullptr;
+
+            // we only need the sector and layer tables, the sector content stays on disk
+            auto loaded = base::rtti_cast<CompiledWorld>(base::res::LoadUncached(absolutePath, CompiledWorld::GetStaticClass()));
+            if (!loaded)
+                return nullptr;
+
+            // worlds compiled before the layers were tracked can't be updated
+            if (loaded->sourceLayers().empty() && !loaded->sectors().empty())
+                return nullptr;
+
+            return loaded;
+        }
+
+        void compileFull(const base::Array<base::res::ResourcePath>& layerPaths, CompiledWorld::TSectorInfos& outSectors) const
+        {
+            base::Array<uint32_t> allLayers;
+            allLayers.reserve(layerPaths.size());
+            for (uint32_t i = 0; i < layerPaths.size(); ++i)
+                allLayers.pushBack(i);
+
+            // extract nodes
+            NodeCollector nodes;
+            {
+                base::ScopeTimer timer;
+                nodes.extractNodesFromLayers(layerPaths, allLayers);
+                TRACE_INFO("Extracted {} nodes from {} layers in {}", nodes.nodeCount(), allLayers.size(), TimeInterval(timer.timeElapsed()));
+            }
+
+            // compile sectors
+            {
+                base::ScopeTimer timer;
+                nodes.pack(outSectors);
+                TRACE_INFO("Packed {} nodes into {} sectors in {}", nodes.nodeCount(), outSectors.size(), TimeInterval(timer.timeElapsed()));
+            }
+        }
+
+        void compileIncremental(const CompiledWorld& previousWorld, const base::Array<base::res::ResourcePath>& layerPaths, const CompiledWorld::TLayerInfos& layerInfos, CompiledWorld::TSectorInfos& outSectors) const
+        {
+            base::ScopeTimer timer;
+
+            // map layers from previous compilation to current ones
+            helper::IncrementalLayerMapping layerMapping;
+            helper::MapPreviousLayers(previousWorld.sourceLayers(), layerInfos, layerMapping);
+
+            // cells that had content from layers that changed or were removed have to be rebuilt
+            base::HashSet<base::StringBuf> dirtyCells;
+            helper::CollectDirtyCells(previousWorld.sectors(), layerMapping, dirtyCells);
+
+            // extract the changed layers, cells they place content in have to be rebuilt as well
+            NodeCollector nodes;
+            base::Array<bool> layerExtracted;
+            layerExtracted.resizeWith(layerInfos.size(), false);
+
+            base::Array<uint32_t> changedLayers;
+            {
+                for (uint32_t i = 0; i < layerInfos.size(); ++i)
+                    if (layerMapping.m_layerChanged[i])
+                        changedLayers.pushBack(i);
+
+                nodes.extractNodesFromLayers(layerPaths, changedLayers);
+
+                for (auto layerIndex : changedLayers)
+                {
+                    nodes.collectLayerCells(layerIndex, dirtyCells);
+                    layerExtracted[layerIndex] = true;
+                }
+
+                TRACE_INFO("Found {} changed layers (of {}), {} cells need to be rebuilt", changedLayers.size(), layerInfos.size(), dirtyCells.size());
+            }
+
+            // rebuilt cells need the full content so extract the unchanged layers that also contributed to them
+            // NOTE: unchanged layers end up in the same cells as before so this does not make any more cells dirty
+            {
+                base::Array<uint32_t> sharingLayers;
+                helper::CollectSharingLayers(previousWorld.sectors(), dirtyCells, layerMapping, layerExtracted, sharingLayers);
+
+                nodes.extractNodesFromLayers(layerPaths, sharingLayers);
+                TRACE_INFO("Extracted {} nodes from {} changed and {} unchanged layers", nodes.nodeCount(), changedLayers.size(), sharingLayers.size());
+            }
+
+            // keep the sectors from clean cells, their content is already saved
+            uint32_t numReusedSectors = 0;
+            for (const auto& sector : previousWorld.sectors())
+            {
+                if (dirtyCells.contains(sector.m_cellName))
+                    continue;
+
+                auto& reusedSector = outSectors.emplaceBack(sector);
+                reusedSector.m_unsavedSectorData.reset();
+                for (auto& layerIndex : reusedSector.m_sourceLayers)
+                    layerIndex = layerMapping.m_previousToCurrentLayer[layerIndex];
+
+                numReusedSectors += 1;
+            }
+
+            // repack only the dirty cells
+            {
+                base::ScopeTimer timer;
+                nodes.pack(outSectors, &dirtyCells);
+                TRACE_INFO("Packed {} nodes into {} new sectors in {}", nodes.nodeCount(), outSectors.size() - numReusedSectors, TimeInterval(timer.timeElapsed()));
+            }
+
+            TRACE_INFO("Incremental compilation reused {} sectors and rebuilt {} cells in {}", numReusedSectors, dirtyCells.size(), TimeInterval(timer.timeElapsed()));
         }
     };
 
-#endif
+    RTTI_BEGIN_TYPE_CLASS(WorldCompiler);
+        RTTI_METADATA(base::app::CommandNameMetadata).name("compileWorld");
+    RTTI_END_TYPE();
+
+    //--
 
 } // scene
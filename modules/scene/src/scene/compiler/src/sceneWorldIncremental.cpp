@@ -0,0 +1,84 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: scene\build #]
+***/
+
+#include "build.h"
+#include "sceneWorldIncremental.h"
+
+#include "base/containers/include/hashMap.h"
+
+namespace scene
+{
+    namespace helper
+    {
+        //--
+
+        void MapPreviousLayers(const CompiledWorld::TLayerInfos& previousLayers, const CompiledWorld::TLayerInfos& currentLayers, IncrementalLayerMapping& outMapping)
+        {
+            base::HashMap<base::StringBuf, uint32_t> currentLayerMap;
+            for (uint32_t i = 0; i < currentLayers.size(); ++i)
+                currentLayerMap[currentLayers[i].m_path] = i;
+
+            outMapping.m_previousToCurrentLayer.reset();
+            outMapping.m_previousToCurrentLayer.resizeWith(previousLayers.size(), INDEX_MAX);
+
+            outMapping.m_layerChanged.reset();
+            outMapping.m_layerChanged.resizeWith(currentLayers.size(), true);
+
+            for (uint32_t i = 0; i < previousLayers.size(); ++i)
+            {
+                const auto& previousLayer = previousLayers[i];
+
+                uint32_t currentIndex = INDEX_MAX;
+                if (currentLayerMap.find(previousLayer.m_path, currentIndex))
+                {
+                    outMapping.m_previousToCurrentLayer[i] = currentIndex;
+                    if (previousLayer.m_crc != 0 && previousLayer.m_crc == currentLayers[currentIndex].m_crc)
+                        outMapping.m_layerChanged[currentIndex] = false;
+                }
+            }
+        }
+
+        void CollectDirtyCells(const CompiledWorld::TSectorInfos& previousSectors, const IncrementalLayerMapping& mapping, base::HashSet<base::StringBuf>& outDirtyCells)
+        {
+            for (const auto& sector : previousSectors)
+            {
+                for (auto previousLayerIndex : sector.m_sourceLayers)
+                {
+                    auto currentIndex = mapping.currentLayer(previousLayerIndex);
+                    if (currentIndex == INDEX_MAX || mapping.m_layerChanged[currentIndex])
+                    {
+                        outDirtyCells.insert(sector.m_cellName);
+                        break;
+                    }
+                }
+            }
+        }
+
+        void CollectSharingLayers(const CompiledWorld::TSectorInfos& previousSectors, const base::HashSet<base::StringBuf>& dirtyCells, const IncrementalLayerMapping& mapping, base::Array<bool>& layerExtracted, base::Array<uint32_t>& outSharingLayers)
+        {
+            for (const auto& sector : previousSectors)
+            {
+                if (!dirtyCells.contains(sector.m_cellName))
+                    continue;
+
+                for (auto previousLayerIndex : sector.m_sourceLayers)
+                {
+                    auto currentIndex = mapping.currentLayer(previousLayerIndex);
+                    if (currentIndex != INDEX_MAX && !layerExtracted[currentIndex])
+                    {
+                        layerExtracted[currentIndex] = true;
+                        outSharingLayers.pushBack(currentIndex);
+                    }
+                }
+            }
+        }
+
+        //--
+
+    } // helper
+} // scene
@@ -0,0 +1,51 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: scene\build #]
+***/
+
+#pragma once
+
+#include "scene/common/include/sceneWorld.h"
+#include "base/containers/include/hashSet.h"
+
+namespace scene
+{
+    namespace helper
+    {
+        //--
+
+        /// how the layers of the previous compilation map to the current layers
+        struct IncrementalLayerMapping
+        {
+            // index of the current layer for each layer from previous compilation, INDEX_MAX if the layer was removed
+            base::Array<uint32_t> m_previousToCurrentLayer;
+
+            // for each current layer, true if it's new or its content changed since the previous compilation
+            base::Array<bool> m_layerChanged;
+
+            // get current index of layer from previous compilation, INDEX_MAX if it was removed
+            INLINE uint32_t currentLayer(uint32_t previousLayerIndex) const
+            {
+                return (previousLayerIndex < m_previousToCurrentLayer.size()) ? m_previousToCurrentLayer[previousLayerIndex] : INDEX_MAX;
+            }
+        };
+
+        /// map layers from previous compilation to current ones, a layer is unchanged only if it still exists and has the same CRC
+        /// NOTE: layers without CRC are always considered changed
+        extern void MapPreviousLayers(const CompiledWorld::TLayerInfos& previousLayers, const CompiledWorld::TLayerInfos& currentLayers, IncrementalLayerMapping& outMapping);
+
+        /// collect cells that had content from layers that changed or were removed, they have to be rebuilt
+        /// NOTE: cells the changed layers place their content in now are not known until the layers are extracted (see NodeCollector::collectLayerCells)
+        extern void CollectDirtyCells(const CompiledWorld::TSectorInfos& previousSectors, const IncrementalLayerMapping& mapping, base::HashSet<base::StringBuf>& outDirtyCells);
+
+        /// collect the unchanged layers that contributed to the dirty cells, rebuilt cells need their full content
+        /// layers already marked in the extracted list are skipped, the returned layers are marked as extracted
+        extern void CollectSharingLayers(const CompiledWorld::TSectorInfos& previousSectors, const base::HashSet<base::StringBuf>& dirtyCells, const IncrementalLayerMapping& mapping, base::Array<bool>& layerExtracted, base::Array<uint32_t>& outSharingLayers);
+
+        //--
+
+    } // helper
+} // scene
@@ -0,0 +1,183 @@
+/***
+* Boomer Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: tests #]
+***/
+
+#include "build.h"
+#include "sceneWorldIncremental.h"
+
+#include "base/test/include/gtest/gtest.h"
+
+DECLARE_TEST_FILE(SceneWorldIncremental);
+
+using namespace base;
+
+namespace tests
+{
+    static void AddLayer(scene::CompiledWorld::TLayerInfos& layers, const char* path, uint64_t crc)
+    {
+        auto& layer = layers.emplaceBack();
+        layer.m_path = StringBuf(path);
+        layer.m_crc = crc;
+    }
+
+    static void AddSector(scene::CompiledWorld::TSectorInfos& sectors, const char* cellName, std::initializer_list<uint32_t> sourceLayers)
+    {
+        auto& sector = sectors.emplaceBack();
+        sector.m_name = StringBuf(cellName);
+        sector.m_cellName = StringBuf(cellName);
+        for (auto layerIndex : sourceLayers)
+            sector.m_sourceLayers.pushBack(layerIndex);
+    }
+
+    /// layers of the previous compilation and the ones we have now
+    /// previous: 0-changed.layer, 1-shared.layer, 2-removed.layer, 3-clean.layer, 4-nocrc.layer
+    /// current (reordered): 0-clean.layer, 1-shared.layer, 2-changed.layer, 3-added.layer, 4-nocrc.layer
+    struct IncrementalSetup
+    {
+        scene::CompiledWorld::TLayerInfos previousLayers;
+        scene::CompiledWorld::TLayerInfos currentLayers;
+        scene::CompiledWorld::TSectorInfos previousSectors;
+
+        IncrementalSetup()
+        {
+            AddLayer(previousLayers, "layers/changed.layer", 100);
+            AddLayer(previousLayers, "layers/shared.layer", 200);
+            AddLayer(previousLayers, "layers/removed.layer", 300);
+            AddLayer(previousLayers, "layers/clean.layer", 400);
+            AddLayer(previousLayers, "layers/nocrc.layer", 0);
+
+            AddLayer(currentLayers, "layers/clean.layer", 400);
+            AddLayer(currentLayers, "layers/shared.layer", 200);
+            AddLayer(currentLayers, "layers/changed.layer", 101);
+            AddLayer(currentLayers, "layers/added.layer", 500);
+            AddLayer(currentLayers, "layers/nocrc.layer", 0);
+
+            AddSector(previousSectors, "grid0_0_0", { 0, 1 }); // changed layer shares the cell with unchanged one
+            AddSector(previousSectors, "grid0_1_0", { 2 }); // removed layer
+            AddSector(previousSectors, "grid0_2_0", { 1, 3 }); // only unchanged layers
+            AddSector(previousSectors, "grid0_3_0", { 3 }); // only unchanged layer
+        }
+    };
+
+} // tests
+
+TEST(SceneWorldIncremental, MapPreviousLayers)
+{
+    tests::IncrementalSetup setup;
+
+    scene::helper::IncrementalLayerMapping mapping;
+    scene::helper::MapPreviousLayers(setup.previousLayers, setup.currentLayers, mapping);
+
+    ASSERT_EQ(5, mapping.m_previousToCurrentLayer.size());
+    EXPECT_EQ(2, mapping.currentLayer(0));
+    EXPECT_EQ(1, mapping.currentLayer(1));
+    EXPECT_EQ(INDEX_MAX, mapping.currentLayer(2));
+    EXPECT_EQ(0, mapping.currentLayer(3));
+    EXPECT_EQ(4, mapping.currentLayer(4));
+    EXPECT_EQ(INDEX_MAX, mapping.currentLayer(5));
+
+    // layer is unchanged only if it existed before with the same CRC, layers without CRC can't be trusted
+    ASSERT_EQ(5, mapping.m_layerChanged.size());
+    EXPECT_FALSE(mapping.m_layerChanged[0]);
+    EXPECT_FALSE(mapping.m_layerChanged[1]);
+    EXPECT_TRUE(mapping.m_layerChanged[2]);
+    EXPECT_TRUE(mapping.m_layerChanged[3]);
+    EXPECT_TRUE(mapping.m_layerChanged[4]);
+}
+
+TEST(SceneWorldIncremental, ChangedAndRemovedLayersMakeCellsDirty)
+{
+    tests::IncrementalSetup setup;
+
+    scene::helper::IncrementalLayerMapping mapping;
+    scene::helper::MapPreviousLayers(setup.previousLayers, setup.currentLayers, mapping);
+
+    HashSet<StringBuf> dirtyCells;
+    scene::helper::CollectDirtyCells(setup.previousSectors, mapping, dirtyCells);
+
+    EXPECT_EQ(2, dirtyCells.size());
+    EXPECT_TRUE(dirtyCells.contains(StringBuf("grid0_0_0")));
+    EXPECT_TRUE(dirtyCells.contains(StringBuf("grid0_1_0")));
+    EXPECT_FALSE(dirtyCells.contains(StringBuf("grid0_2_0")));
+    EXPECT_FALSE(dirtyCells.contains(StringBuf("grid0_3_0")));
+}
+
+TEST(SceneWorldIncremental, AllSectorsOfDirtyCellAreDirty)
+{
+    tests::IncrementalSetup setup;
+
+    // dense cell split into sectors, only one of them has content from the changed layer
+    tests::AddSector(setup.previousSectors, "grid0_5_0", { 3 });
+    tests::AddSector(setup.previousSectors, "grid0_5_0", { 0 });
+
+    scene::helper::IncrementalLayerMapping mapping;
+    scene::helper::MapPreviousLayers(setup.previousLayers, setup.currentLayers, mapping);
+
+    HashSet<StringBuf> dirtyCells;
+    scene::helper::CollectDirtyCells(setup.previousSectors, mapping, dirtyCells);
+
+    EXPECT_TRUE(dirtyCells.contains(StringBuf("grid0_5_0")));
+
+    // the unchanged layer from the other sector of the cell has to be extracted
+    Array<bool> layerExtracted;
+    layerExtracted.resizeWith(setup.currentLayers.size(), false);
+
+    Array<uint32_t> sharingLayers;
+    scene::helper::CollectSharingLayers(setup.previousSectors, dirtyCells, mapping, layerExtracted, sharingLayers);
+
+    EXPECT_TRUE(sharingLayers.contains(0));
+}
+
+TEST(SceneWorldIncremental, UnchangedLayerSharingDirtyCellIsExtracted)
+{
+    tests::IncrementalSetup setup;
+
+    scene::helper::IncrementalLayerMapping mapping;
+    scene::helper::MapPreviousLayers(setup.previousLayers, setup.currentLayers, mapping);
+
+    HashSet<StringBuf> dirtyCells;
+    scene::helper::CollectDirtyCells(setup.previousSectors, mapping, dirtyCells);
+
+    // changed layers are extracted first
+    Array<bool> layerExtracted;
+    layerExtracted.resizeWith(setup.currentLayers.size(), false);
+    for (uint32_t i = 0; i < mapping.m_layerChanged.size(); ++i)
+        layerExtracted[i] = mapping.m_layerChanged[i];
+
+    Array<uint32_t> sharingLayers;
+    scene::helper::CollectSharingLayers(setup.previousSectors, dirtyCells, mapping, layerExtracted, sharingLayers);
+
+    // only the unchanged layer that had content in the dirty cell is needed, the clean layer is not touched
+    ASSERT_EQ(1, sharingLayers.size());
+    EXPECT_EQ(1, sharingLayers[0]);
+    EXPECT_TRUE(layerExtracted[1]);
+    EXPECT_FALSE(layerExtracted[0]);
+
+    // layers are returned only once
+    sharingLayers.reset();
+    scene::helper::CollectSharingLayers(setup.previousSectors, dirtyCells, mapping, layerExtracted, sharingLayers);
+    EXPECT_TRUE(sharingLayers.empty());
+}
+
+TEST(SceneWorldIncremental, NothingChanged)
+{
+    tests::IncrementalSetup setup;
+
+    // compare the previous compilation with itself, only the layer without CRC is dirty
+    scene::helper::IncrementalLayerMapping mapping;
+    scene::helper::MapPreviousLayers(setup.previousLayers, setup.previousLayers, mapping);
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(i, mapping.currentLayer(i));
+        EXPECT_FALSE(mapping.m_layerChanged[i]);
+    }
+
+    HashSet<StringBuf> dirtyCells;
+    scene::helper::CollectDirtyCells(setup.previousSectors, mapping, dirtyCells);
+    EXPECT_EQ(0, dirtyCells.size());
+}
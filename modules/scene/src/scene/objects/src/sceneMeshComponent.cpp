@@ -20,6 +20,7 @@
 #include "scene/common/include/sceneRuntime.h"
 #include "scene/common/include/sceneNodeTemplate.h"
 #include "scene/common/include/sceneEntity.h"
+#include "scene/common/include/sceneSpatialQuerySystem.h"
 #include "base/geometry/include/mesh.h"
 
 namespace scene
@@ -93,17 +94,24 @@ namespace scene
         {
             rs->unregisterRenderable(this);
         }
+
+        if (auto ss = scene->system<SpatialQuerySystem>())
+        {
+            ss->unregisterElement(this);
+        }
     }
 
     void MeshComponent::updateRenderable()
     {
         if (isAttached())
         {
+            auto bounds = localToWorld().transformBox(m_localBounds);
+
             if (auto rs = scene()->system<RenderingSystem>())
-            {
-                auto bounds = localToWorld().transformBox(m_localBounds);
                 rs->registerRenderable(this, bounds, 0.0f);
-            }
+
+            if (auto ss = scene()->system<SpatialQuerySystem>())
+                ss->registerElement(this, bounds);
         }
     }
 
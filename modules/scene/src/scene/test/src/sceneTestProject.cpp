@@ -30,6 +30,8 @@
 #include "scene/compiler/include/sceneNodeCollector.h"
 #include "rendering/driver/include/renderingOutput.h"
 #include "base/app/include/launcherPlatform.h"
+#include "base/memory/include/poolStats.h"
+#include "base/memory/include/frameArena.h"
 
 namespace scene
 {
@@ -441,6 +443,18 @@ namespace scene
             }
         }
 
+        static uint32_t CountLastFrameHeapAllocations()
+        {
+            base::mem::PoolStatsData stats[256];
+            uint32_t numPools = 0;
+            base::mem::PoolStats::GetInstance().allStats(ARRAY_COUNT(stats), stats, numPools);
+
+            uint32_t numAllocs = 0;
+            for (uint32_t i = 0; i < numPools; ++i)
+                numAllocs += stats[i].m_lastFrameAllocs;
+            return numAllocs;
+        }
+
         void SceneTestProject::drawDebugInfo(rendering::scene::FrameInfo& frame) const
         {
             rendering::scene::ScreenCanvas dd(frame);
@@ -468,6 +482,10 @@ namespace scene
                 dd.lineColor(base::Color::RED);
                 dd.text(20, 38, base::TempString("Failed to load"));
             }
+
+            const auto& arenaStats = base::mem::FrameArena::GetDefaultArena().lastFrameStats();
+            dd.lineColor(base::Color::WHITE);
+            dd.text(20, 56, base::TempString("Heap allocs/frame: {}, frame arena: {} allocs, {} pages", CountLastFrameHeapAllocations(), arenaStats.numAllocations, arenaStats.numPages));
         }
 
         void SceneTestProject::drawGrid(rendering::scene::FrameInfo& frame) const